@@ -18,7 +18,7 @@ px4_add_board(
 		pwm_out_sim
 		#telemetry # all available telemetry drivers
 		tone_alarm_sim
-		#uavcan
+		uavcan # tests only, on a vcan interface
 
 	MODULES
 		attitude_estimator_q
@@ -0,0 +1,120 @@
+
+px4_add_board(
+	PLATFORM posix
+	VENDOR px4
+	MODEL sitl
+	LABEL multiprocess
+	TESTING
+
+	DRIVERS
+		#barometer # all available barometer drivers
+		batt_smbus
+		camera_trigger
+		differential_pressure # all available differential pressure drivers
+		distance_sensor # all available distance sensor drivers
+		gps
+		#imu # all available imu drivers
+		#magnetometer # all available magnetometer drivers
+		pwm_out_sim
+		#telemetry # all available telemetry drivers
+		tone_alarm_sim
+		#uavcan
+
+	MODULES
+		attitude_estimator_q
+		camera_feedback
+		commander
+		dataman
+		ekf2
+		events
+		fw_att_control
+		fw_pos_control_l1
+		gnd_att_control
+		gnd_pos_control
+		land_detector
+		landing_target_estimator
+		load_mon
+		local_position_estimator
+		logger
+		mavlink
+		mc_att_control
+		mc_pos_control
+		muorb/posix_shm
+		navigator
+		position_estimator_inav
+		replay
+		sensors
+		simulator
+		vmount
+		vtol_att_control
+		wind_estimator
+
+	SYSTEMCMDS
+		#bl_update
+		#config
+		#dumpfile
+		dyn
+		esc_calib
+		#hardfault_log
+		led_control
+		mixer
+		motor_ramp
+		#mtd
+		#nshterm
+		param
+		perf
+		pwm
+		reboot
+		sd_bench
+		shutdown
+		tests # tests and test runner
+		top
+		topic_listener
+		tune_control
+		ver
+
+	EXAMPLES
+		bottle_drop # OBC challenge
+		dyn_hello # dynamically loading modules example
+		fixedwing_control # Tutorial code from https://px4.io/dev/example_fixedwing_control
+		hello
+		#hwtest # Hardware test
+		px4_mavlink_debug # Tutorial code from https://px4.io/dev/debug_values
+		px4_simple_app # Tutorial code from https://px4.io/dev/px4_simple_app
+		rover_steering_control # Rover example app
+		segway
+	)
+
+set(config_sitl_viewer jmavsim CACHE STRING "viewer for sitl")
+set_property(CACHE config_sitl_viewer PROPERTY STRINGS "jmavsim;none")
+
+set(config_sitl_debugger disable CACHE STRING "debugger for sitl")
+set_property(CACHE config_sitl_debugger PROPERTY STRINGS "disable;gdb;lldb")
+
+# If the environment variable 'replay' is defined, we are building with replay
+# support. In this case, we enable the orb publisher rules.
+set(REPLAY_FILE "$ENV{replay}")
+if(REPLAY_FILE)
+	message("Building with uorb publisher rules support")
+	add_definitions(-DORB_USE_PUBLISHER_RULES)
+endif()
+
+# Modules run in several PX4 processes that share topics over the
+# muorb_shm channel. The lockstep clock is per process, so it is disabled.
+#
+# init.d-posix/rcS starts 'muorb_shm start -b <instance>' right after
+# 'uorb start': the channel must run before any module advertises or
+# subscribes, topics advertised before are not shared. rcS then starts ekf2,
+# mavlink and logger in processes of their own (rc.multiprocess,
+# rc.multiprocess_module). These load the parameters saved at startup,
+# parameter changes are not shared. The vehicle post script runs in the
+# mavlink process, so it can only configure mavlink.
+#
+# Up to RING_LENGTH (4) publishers of a topic write at the same time without
+# waiting, more wait for a ring slot or drop the sample ('not shared' in
+# 'muorb_shm status'). Only the first instance of multi-instance topics is
+# shared, so topics with several publishers (e.g. vehicle_command from
+# mavlink and commander) are best kept to one instance.
+add_definitions(-DORB_COMMUNICATOR)
+
+set(ENABLE_LOCKSTEP_SCHEDULER no)
@@ -79,8 +79,33 @@ uint16_t const crc16_table[256] = {
 	0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
 };
 
-Transport_node::Transport_node(): rx_buff_pos(0)
+/** Slicing tables for the CRC-16, crc16_slice_table[k][i] is the CRC of byte i followed by k zero bytes */
+static uint16_t crc16_slice_table[4][256];
+
+static void init_crc16_slice_table()
 {
+	static bool initialized = false;
+
+	if (initialized) {
+		return;
+	}
+
+	for (int i = 0; i < 256; ++i) {
+		uint16_t crc = crc16_table[i];
+		crc16_slice_table[0][i] = crc;
+
+		for (int k = 1; k < 4; ++k) {
+			crc = (crc >> 8) ^ crc16_table[crc & 0xff];
+			crc16_slice_table[k][i] = crc;
+		}
+	}
+
+	initialized = true;
+}
+
+Transport_node::Transport_node()
+{
+	init_crc16_slice_table();
 }
 
 Transport_node::~Transport_node()
@@ -92,9 +117,16 @@ uint16_t Transport_node::crc16_byte(uint16_t crc, const uint8_t data)
 	return (crc >> 8) ^ crc16_table[(crc ^ data) & 0xff];
 }
 
-uint16_t Transport_node::crc16(uint8_t const *buffer, size_t len)
+uint16_t Transport_node::crc16(uint8_t const *buffer, size_t len, uint16_t crc)
 {
-	uint16_t crc = 0;
+	// Four bytes per step using the slicing tables
+	while (len >= 4) {
+		crc ^= (uint16_t)buffer[0] | ((uint16_t)buffer[1] << 8);
+		crc = crc16_slice_table[3][crc & 0xff] ^ crc16_slice_table[2][crc >> 8] ^
+		      crc16_slice_table[1][buffer[2]] ^ crc16_slice_table[0][buffer[3]];
+		buffer += 4;
+		len -= 4;
+	}
 
 	while (len--) {
 		crc = crc16_byte(crc, *buffer++);
@@ -103,97 +135,190 @@ uint16_t Transport_node::crc16(uint8_t const *buffer, size_t len)
 	return crc;
 }
 
-ssize_t Transport_node::read(uint8_t *topic_ID, char out_buffer[], size_t buffer_len)
+void Transport_node::rx_copy(uint32_t pos, void *dst, size_t len) const
 {
-	if (nullptr == out_buffer || nullptr == topic_ID || !fds_OK()) {
+	const uint32_t offset = pos & (RX_BUFFER_SIZE - 1);
+	const size_t first = (len < RX_BUFFER_SIZE - offset) ? len : RX_BUFFER_SIZE - offset;
+
+	memcpy(dst, rx_buffer + offset, first);
+	memcpy((char *)dst + first, rx_buffer, len - first);
+}
+
+uint16_t Transport_node::rx_crc16(uint32_t pos, size_t len)
+{
+	const uint32_t offset = pos & (RX_BUFFER_SIZE - 1);
+	const size_t first = (len < RX_BUFFER_SIZE - offset) ? len : RX_BUFFER_SIZE - offset;
+
+	uint16_t crc = crc16((uint8_t *)rx_buffer + offset, first);
+	return crc16((uint8_t *)rx_buffer, len - first, crc);
+}
+
+ssize_t Transport_node::read_batch_entry(uint8_t *topic_ID, char out_buffer[], size_t buffer_len)
+{
+	// The batch frame already passed the CRC check, only its layout needs to be validated
+	uint32_t len = 0;
+
+	if (rx_batch_remaining >= BATCH_ENTRY_HEADER_LENGTH) {
+		len = ((uint32_t)rx_at(rx_batch_pos + 1) << 8) | rx_at(rx_batch_pos + 2);
+	}
+
+	if (rx_batch_remaining < BATCH_ENTRY_HEADER_LENGTH || BATCH_ENTRY_HEADER_LENGTH + len > rx_batch_remaining) {
+		PX4_ERR("Malformed batch, dropping %u bytes", (unsigned)rx_batch_remaining);
+		rx_head = rx_batch_pos + rx_batch_remaining;
+		rx_batch_remaining = 0;
 		return -1;
 	}
 
-	*topic_ID = 255;
+	ssize_t ret;
 
-	ssize_t len = node_read((void *)(rx_buffer + rx_buff_pos), sizeof(rx_buffer) - rx_buff_pos);
+	if (buffer_len < len) {
+		ret = -EMSGSIZE;
 
-	if (len <= 0) {
-		int errsv = errno;
+	} else {
+		*topic_ID = rx_at(rx_batch_pos);
+		rx_copy(rx_batch_pos + BATCH_ENTRY_HEADER_LENGTH, out_buffer, len);
+		ret = BATCH_ENTRY_HEADER_LENGTH + len;
+	}
 
-		if (errsv && EAGAIN != errsv && ETIMEDOUT != errsv) {
-			PX4_ERR("Read fail %d", errsv);
-		}
+	rx_batch_pos += BATCH_ENTRY_HEADER_LENGTH + len;
+	rx_batch_remaining -= BATCH_ENTRY_HEADER_LENGTH + len;
 
-		return len;
+	if (rx_batch_remaining == 0) {
+		// the whole batch is consumed, release it from the ring buffer
+		rx_head = rx_batch_pos;
 	}
 
-	rx_buff_pos += len;
+	return ret;
+}
 
-	// We read some
-	size_t header_size = sizeof(struct Header);
+ssize_t Transport_node::parse_frame(uint8_t *topic_ID, char out_buffer[], size_t buffer_len)
+{
+	const size_t header_size = sizeof(struct Header);
 
-	// but not enough
-	if (rx_buff_pos < header_size) {
-		return 0;
-	}
+	/*
+	 * [>,>,>,topic_ID,seq,payload_length_H,payload_length_L,CRCHigh,CRCLow,payloadStart, ... ,payloadEnd]
+	 */
+	while (rx_tail - rx_head >= header_size) {
+		// Skip everything up to the next start marker
+		if (rx_at(rx_head) != '>' || rx_at(rx_head + 1) != '>' || rx_at(rx_head + 2) != '>') {
+			++rx_head;
+			++bytes_dropped;
+			continue;
+		}
+
+		struct Header header;
+		rx_copy(rx_head, &header, header_size);
+		uint32_t payload_len = ((uint32_t)header.payload_len_h << 8) | header.payload_len_l;
 
-	uint32_t msg_start_pos = 0;
+		// The frame can never fit the ring buffer, this is not a valid start marker
+		if (header_size + payload_len > RX_BUFFER_SIZE) {
+			++rx_head;
+			++bytes_dropped;
+			continue;
+		}
 
-	for (msg_start_pos = 0; msg_start_pos <= rx_buff_pos - header_size; ++msg_start_pos) {
-		if ('>' == rx_buffer[msg_start_pos] && memcmp(rx_buffer + msg_start_pos, ">>>", 3) == 0) {
-			break;
+		// We do not have a complete message yet
+		if (rx_tail - rx_head < header_size + payload_len) {
+			return 0;
 		}
+
+		uint16_t read_crc = ((uint16_t)header.crc_h << 8) | header.crc_l;
+		uint16_t calc_crc = rx_crc16(rx_head + header_size, payload_len);
+
+		if (read_crc != calc_crc) {
+			PX4_ERR("Bad CRC %u != %u", read_crc, calc_crc);
+			PX4_ERR("                                 (↓ %lu)", (unsigned long)(header_size + payload_len));
+			// discard message from rx_buffer
+			rx_head += header_size + payload_len;
+			++crc_errors;
+			return -1;
+		}
+
+		++frames_read;
+
+		if (header.topic_ID == BATCH_TOPIC_ID) {
+			// the batch stays in the ring buffer until all of its topics have been read
+			rx_batch_pos = rx_head + header_size;
+			rx_batch_remaining = payload_len;
+
+			if (rx_batch_remaining == 0) {
+				rx_head = rx_batch_pos;
+				return 0;
+			}
+
+			return read_batch_entry(topic_ID, out_buffer, buffer_len);
+		}
+
+		ssize_t len;
+
+		// The message won't fit the buffer.
+		if (buffer_len < payload_len) {
+			len = -EMSGSIZE;
+
+		} else {
+			// copy message to outbuffer and set other return values
+			rx_copy(rx_head + header_size, out_buffer, payload_len);
+			*topic_ID = header.topic_ID;
+			len = payload_len + header_size;
+		}
+
+		// discard message from rx_buffer
+		rx_head += header_size + payload_len;
+
+		return len;
 	}
 
-	// Start not found
-	if (msg_start_pos > rx_buff_pos - header_size) {
-		PX4_INFO("                                 (↓↓ %u)", msg_start_pos);
-		// All we've checked so far is garbage, drop it - but save unchecked bytes
-		memmove(rx_buffer, rx_buffer + msg_start_pos, rx_buff_pos - msg_start_pos);
-		rx_buff_pos = rx_buff_pos - msg_start_pos;
+	return 0;
+}
+
+ssize_t Transport_node::read(uint8_t *topic_ID, char out_buffer[], size_t buffer_len)
+{
+	if (nullptr == out_buffer || nullptr == topic_ID || !fds_OK()) {
 		return -1;
 	}
 
-	/*
-	 * [>,>,>,topic_ID,seq,payload_length_H,payload_length_L,CRCHigh,CRCLow,payloadStart, ... ,payloadEnd]
-	 */
+	*topic_ID = 255;
 
-	struct Header *header = (struct Header *)&rx_buffer[msg_start_pos];
-	uint32_t payload_len = ((uint32_t)header->payload_len_h << 8) | header->payload_len_l;
+	// Topics left over from a batch frame come first
+	if (rx_batch_remaining > 0) {
+		return read_batch_entry(topic_ID, out_buffer, buffer_len);
+	}
 
-	// The message won't fit the buffer.
-	if (buffer_len < header_size + payload_len) {
-		return -EMSGSIZE;
+	// Then complete frames already in the buffer
+	ssize_t len = parse_frame(topic_ID, out_buffer, buffer_len);
+
+	if (len != 0) {
+		return len;
 	}
 
-	// We do not have a complete message yet
-	if (msg_start_pos + header_size + payload_len > rx_buff_pos) {
-		// If there's garbage at the beginning, drop it
-		if (msg_start_pos > 0) {
-			PX4_INFO("                                 (↓ %u)", msg_start_pos);
-			memmove(rx_buffer, rx_buffer + msg_start_pos, rx_buff_pos - msg_start_pos);
-			rx_buff_pos -= msg_start_pos;
-		}
+	// Start at the beginning of the buffer when it is empty, so a whole datagram fits
+	if (rx_head == rx_tail) {
+		rx_head = rx_tail = 0;
+	}
+
+	const uint32_t offset = rx_tail & (RX_BUFFER_SIZE - 1);
+	const uint32_t free_space = RX_BUFFER_SIZE - (rx_tail - rx_head);
+	const uint32_t contiguous = (free_space < RX_BUFFER_SIZE - offset) ? free_space : RX_BUFFER_SIZE - offset;
 
+	if (contiguous == 0) {
 		return 0;
 	}
 
-	uint16_t read_crc = ((uint16_t)header->crc_h << 8) | header->crc_l;
-	uint16_t calc_crc = crc16((uint8_t *)rx_buffer + msg_start_pos + header_size, payload_len);
+	len = node_read((void *)(rx_buffer + offset), contiguous);
 
-	if (read_crc != calc_crc) {
-		PX4_ERR("Bad CRC %u != %u", read_crc, calc_crc);
-		PX4_ERR("                                 (↓ %lu)", (unsigned long)(header_size + payload_len));
-		len = -1;
+	if (len <= 0) {
+		int errsv = errno;
 
-	} else {
-		// copy message to outbuffer and set other return values
-		memmove(out_buffer, rx_buffer + msg_start_pos + header_size, payload_len);
-		*topic_ID = header->topic_ID;
-		len = payload_len + header_size;
+		if (errsv && EAGAIN != errsv && ETIMEDOUT != errsv) {
+			PX4_ERR("Read fail %d", errsv);
+		}
+
+		return len;
 	}
 
-	// discard message from rx_buffer
-	rx_buff_pos -= header_size + payload_len;
-	memmove(rx_buffer, rx_buffer + msg_start_pos + header_size + payload_len, rx_buff_pos);
+	rx_tail += len;
 
-	return len;
+	return parse_frame(topic_ID, out_buffer, buffer_len);
 }
 
 ssize_t Transport_node::get_header_length()
@@ -207,7 +332,7 @@ ssize_t Transport_node::write(const uint8_t topic_ID, char buffer[], size_t leng
 		return -1;
 	}
 
-	static struct Header header = {
+	struct Header header = {
 		.marker = {'>', '>', '>'},
 		.topic_ID = 0u,
 		.seq = 0u,
@@ -218,14 +343,12 @@ ssize_t Transport_node::write(const uint8_t topic_ID, char buffer[], size_t leng
 
 	};
 
-	static uint8_t seq = 0;
-
 	// [>,>,>,topic_ID,seq,payload_length,CRCHigh,CRCLow,payload_start, ... ,payload_end]
 
 	uint16_t crc = crc16((uint8_t *)&buffer[sizeof(header)], length);
 
 	header.topic_ID = topic_ID;
-	header.seq = seq++;
+	header.seq = tx_seq++;
 	header.payload_len_h = (length >> 8) & 0xff;
 	header.payload_len_l = length & 0xff;
 	header.crc_h = (crc >> 8) & 0xff;
@@ -238,6 +361,7 @@ ssize_t Transport_node::write(const uint8_t topic_ID, char buffer[], size_t leng
 	if (len != ssize_t(length + sizeof(header))) {
 		goto err;
 	}
+	++frames_written;
 	return len + sizeof(header);
 
 err:
@@ -248,6 +372,70 @@ err:
 	return len;
 }
 
+ssize_t Transport_node::write_batched(const uint8_t topic_ID, char buffer[], size_t length)
+{
+	const size_t entry_len = BATCH_ENTRY_HEADER_LENGTH + length;
+
+	// Too big for a batch, send it on its own
+	if (entry_len > BATCH_PAYLOAD_SIZE) {
+		if (0 > flush()) {
+			return -1;
+		}
+
+		return write(topic_ID, buffer, length);
+	}
+
+	if (tx_batch_len + entry_len > BATCH_PAYLOAD_SIZE && 0 > flush()) {
+		return -1;
+	}
+
+	// [topic_ID,length_H,length_L,payload_start, ... ,payload_end]
+	char *entry = &tx_batch[sizeof(struct Header) + tx_batch_len];
+	entry[0] = topic_ID;
+	entry[1] = (length >> 8) & 0xff;
+	entry[2] = length & 0xff;
+	memcpy(&entry[BATCH_ENTRY_HEADER_LENGTH], &buffer[sizeof(struct Header)], length);
+
+	tx_batch_len += entry_len;
+	++tx_batch_count;
+
+	return entry_len;
+}
+
+ssize_t Transport_node::flush()
+{
+	if (tx_batch_count == 0) {
+		return 0;
+	}
+
+	ssize_t len;
+
+	if (tx_batch_count == 1) {
+		// A single topic does not need the batch framing: move the header into the entry header's place
+		const uint8_t topic_ID = tx_batch[sizeof(struct Header)];
+		len = write(topic_ID, &tx_batch[BATCH_ENTRY_HEADER_LENGTH], tx_batch_len - BATCH_ENTRY_HEADER_LENGTH);
+
+	} else {
+		len = write(BATCH_TOPIC_ID, tx_batch, tx_batch_len);
+
+		if (len > 0) {
+			++batches_written;
+		}
+	}
+
+	tx_batch_len = 0;
+	tx_batch_count = 0;
+
+	return len;
+}
+
+void Transport_node::print_status()
+{
+	PX4_INFO("frames read: %u, written: %u (%u batches)", (unsigned)frames_read, (unsigned)frames_written,
+		 (unsigned)batches_written);
+	PX4_INFO("CRC errors: %u, bytes dropped: %u", (unsigned)crc_errors, (unsigned)bytes_dropped);
+}
+
 UART_node::UART_node(const char *_uart_name, uint32_t _baudrate, uint32_t _poll_ms):
 	uart_fd(-1),
 	baudrate(_baudrate),
@@ -44,6 +44,16 @@ public:
 
 	virtual int init() {return 0;}
 	virtual uint8_t close() {return 0;}
+
+	/**
+	 * read the next topic
+	 * Complete frames are parsed in place in the receive ring buffer, received data is only
+	 * copied once into out_buffer. Batched frames are returned one topic per call.
+	 * @param topic_ID topic ID of the returned data, 255 if nothing was returned
+	 * @param out_buffer buffer for the serialized topic data
+	 * @param buffer_len size of out_buffer
+	 * @return length read on success (including framing), 0 if no complete topic is available, <0 on error
+	 */
 	ssize_t read(uint8_t *topic_ID, char out_buffer[], size_t buffer_len);
 
 	/**
@@ -60,19 +70,58 @@ public:
 	 */
 	ssize_t write(const uint8_t topic_ID, char buffer[], size_t length);
 
+	/**
+	 * queue a buffer to be sent in a batch frame together with other topics
+	 * The batch is written by flush(), or when the next topic does not fit anymore.
+	 * @param topic_ID
+	 * @param buffer buffer with the same layout as for write()
+	 * @param length buffer length excluding header length
+	 * @return queued length on success, <0 on error
+	 */
+	ssize_t write_batched(const uint8_t topic_ID, char buffer[], size_t length);
+
+	/**
+	 * write all topics queued by write_batched() as a single frame
+	 * @return length written, 0 if nothing was queued, <0 on error
+	 */
+	ssize_t flush();
+
 	/** Get the Length of struct Header to make headroom for the size of struct Header along with payload */
 	ssize_t get_header_length();
 
+	/** Print transport statistics */
+	void print_status();
+
+	/** topic ID of a frame carrying several topics, each as [topic_ID, length_H, length_L, payload] */
+	static constexpr uint8_t BATCH_TOPIC_ID = 254;
+
 protected:
 	virtual ssize_t node_read(void *buffer, size_t len) = 0;
 	virtual ssize_t node_write(void *buffer, size_t len) = 0;
 	virtual bool fds_OK() = 0;
 	uint16_t crc16_byte(uint16_t crc, const uint8_t data);
-	uint16_t crc16(uint8_t const *buffer, size_t len);
+	uint16_t crc16(uint8_t const *buffer, size_t len, uint16_t crc = 0);
 
 protected:
-	uint32_t rx_buff_pos;
-	char rx_buffer[1024] = {};
+	static constexpr uint32_t RX_BUFFER_SIZE = 1024; ///< must be a power of 2
+	static constexpr size_t BATCH_ENTRY_HEADER_LENGTH = 3;
+	static constexpr size_t BATCH_PAYLOAD_SIZE = 512;
+
+	/* receive ring buffer, rx_head and rx_tail are free running indices */
+	char rx_buffer[RX_BUFFER_SIZE] = {};
+	uint32_t rx_head{0};
+	uint32_t rx_tail{0};
+
+	/* remaining topics of the batch frame at rx_head */
+	uint32_t rx_batch_pos{0};
+	uint32_t rx_batch_remaining{0};
+
+	/* statistics */
+	uint32_t frames_read{0};
+	uint32_t frames_written{0};
+	uint32_t batches_written{0};
+	uint32_t crc_errors{0};
+	uint32_t bytes_dropped{0};
 
 private:
 	struct __attribute__((packed)) Header {
@@ -84,6 +133,19 @@ private:
 		uint8_t crc_h;
 		uint8_t crc_l;
 	};
+
+	ssize_t parse_frame(uint8_t *topic_ID, char out_buffer[], size_t buffer_len);
+	ssize_t read_batch_entry(uint8_t *topic_ID, char out_buffer[], size_t buffer_len);
+	uint8_t rx_at(uint32_t pos) const { return (uint8_t)rx_buffer[pos & (RX_BUFFER_SIZE - 1)]; }
+	void rx_copy(uint32_t pos, void *dst, size_t len) const;
+	uint16_t rx_crc16(uint32_t pos, size_t len);
+
+	uint8_t tx_seq{0};
+
+	/* batch frame being assembled, with headroom for the frame header */
+	char tx_batch[sizeof(Header) + BATCH_PAYLOAD_SIZE] = {};
+	size_t tx_batch_len{0};
+	unsigned tx_batch_count{0};
 };
 
 class UART_node: public Transport_node
@@ -206,6 +206,41 @@ def add_padding_bytes(fields, search_path):
     return (struct_size, num_padding_bytes)
 
 
+def compact_layout(fields, search_path, layout=None):
+    """
+    Get the field layout for the compact logger encoding (see lib/ulog_compact)
+    as list of bytes, one per field in memory order: the size in bytes in the
+    lower 7 bits, and the high bit set for scalar integers of at least 2 bytes
+    (these are delta/varint encoded). Nested types are flattened and larger
+    fields are split into chunks of at most 127 bytes.
+    fields must be sorted and padded (see add_padding_bytes())
+    """
+    if layout is None:
+        layout = []
+    for field in fields:
+        if field.is_header:
+            continue
+        array_size = 1
+        if field.is_array:
+            array_size = field.array_len
+        if field.is_builtin:
+            size = sizeof_field_type(field)
+            if not field.is_array and size >= 2 and bare_name(field.type) in \
+                    ['int16', 'int32', 'int64', 'uint16', 'uint32', 'uint64']:
+                layout.append(0x80 | size)
+            else:
+                size *= array_size
+                while size > 0:
+                    layout.append(min(size, 0x7f))
+                    size -= 0x7f
+        else:
+            children_fields = get_children_fields(field.base_type, search_path)
+            add_padding_bytes(children_fields, search_path)
+            for i in range(array_size):
+                compact_layout(children_fields, search_path, layout)
+    return layout
+
+
 def convert_type(spec_type):
     """
     Convert from msg type to C type
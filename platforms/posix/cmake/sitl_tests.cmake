@@ -23,13 +23,21 @@ set(tests
 	microbench_matrix
 	microbench_uorb
 	mixer
+	obstacle_map
 	param
 	parameters
+	path
 	perf
+	px4io_protocol
 	rc
 	servo
 	sf0x
 	sleep
+	startup_script
+	survey_pattern
+	temperature_compensation
+	trajectory
+	ulog_compact
 	uorb
 	versioning
 	)
@@ -74,6 +74,7 @@
 #include "px4_daemon/client.h"
 #include "px4_daemon/server.h"
 #include "px4_daemon/pxh.h"
+#include "px4_daemon/startup_script.h"
 
 #define MODULE_NAME "px4"
 
@@ -100,7 +101,8 @@ static void register_sig_handler();
 static void set_cpu_scaling();
 static int create_symlinks_if_needed(std::string &data_path);
 static int create_dirs();
-static int run_startup_script(const std::string &commands_file, const std::string &absolute_binary_path, int instance);
+static int run_startup_script(const std::string &commands_file, const std::string &absolute_binary_path, int instance,
+			      bool use_shell);
 static std::string get_absolute_binary_path(const std::string &argv0);
 static void wait_to_exit();
 static bool is_already_running(int instance);
@@ -182,12 +184,13 @@ int main(int argc, char **argv)
 		std::string commands_file = "etc/init.d/rcS";
 		std::string test_data_path;
 		int instance = 0;
+		bool use_shell = false;
 
 		int myoptind = 1;
 		int ch;
 		const char *myoptarg = nullptr;
 
-		while ((ch = px4_getopt(argc, argv, "hdt:s:i:", &myoptind, &myoptarg)) != EOF) {
+		while ((ch = px4_getopt(argc, argv, "hdet:s:i:", &myoptind, &myoptarg)) != EOF) {
 			switch (ch) {
 			case 'h':
 				print_usage();
@@ -197,6 +200,10 @@ int main(int argc, char **argv)
 				pxh_off = true;
 				break;
 
+			case 'e':
+				use_shell = true;
+				break;
+
 			case 't':
 				test_data_path = myoptarg;
 				break;
@@ -273,7 +280,7 @@ int main(int argc, char **argv)
 		px4::init_once();
 		px4::init(argc, argv, "px4");
 
-		ret = run_startup_script(commands_file, absolute_binary_path, instance);
+		ret = run_startup_script(commands_file, absolute_binary_path, instance, use_shell);
 
 		// We now block here until we need to exit.
 		if (pxh_off) {
@@ -478,12 +485,8 @@ std::string get_absolute_binary_path(const std::string &argv0)
 }
 
 int run_startup_script(const std::string &commands_file, const std::string &absolute_binary_path,
-		       int instance)
+		       int instance, bool use_shell)
 {
-	std::string shell_command("/bin/sh ");
-
-	shell_command += commands_file + ' ' + std::to_string(instance);
-
 	// Update the PATH variable to include the absolute_binary_path
 	// (required for the px4-alias.sh script and px4-* commands).
 	// They must be within the same directory as the px4 binary
@@ -520,10 +523,42 @@ int run_startup_script(const std::string &commands_file, const std::string &abso
 	}
 
 
-	PX4_INFO("Calling startup script: %s", shell_command.c_str());
-
 	int ret = 0;
 
+	if (!use_shell) {
+		// run the PX4 commands directly in this process instead of a px4-<cmd> client process each
+		px4_daemon::StartupScript startup_script(commands_file, instance);
+
+		if (startup_script.load()) {
+			PX4_INFO("Running startup script: %s", commands_file.c_str());
+
+			ret = startup_script.run();
+
+			if (ret == 0) {
+				PX4_INFO("Startup script returned successfully");
+
+			} else {
+				PX4_ERR("Startup script returned with return value: %d", ret);
+			}
+
+			startup_script.print_timeline_summary();
+
+			if (startup_script.write_timeline("boot_timeline.txt") != 0) {
+				PX4_WARN("failed to write boot_timeline.txt");
+			}
+
+			return ret;
+		}
+
+		PX4_WARN("Startup script not supported in-process, falling back to /bin/sh");
+	}
+
+	std::string shell_command("/bin/sh ");
+
+	shell_command += commands_file + ' ' + std::to_string(instance);
+
+	PX4_INFO("Calling startup script: %s", shell_command.c_str());
+
 	if (!shell_command.empty()) {
 		ret = system(shell_command.c_str());
 
@@ -552,7 +587,7 @@ void print_usage()
 {
 	printf("Usage for Server/daemon process: \n");
 	printf("\n");
-	printf("    px4 [-h|-d] [-s <startup_file>] [-t <test_data_directory>] [<rootfs_directory>] [-i <instance>]\n");
+	printf("    px4 [-h|-d|-e] [-s <startup_file>] [-t <test_data_directory>] [<rootfs_directory>] [-i <instance>]\n");
 	printf("\n");
 	printf("    -s <startup_file>  shell script to be used as startup (default=etc/init.d/rcS)\n");
 	printf("    <rootfs_directory> directory where startup files and mixers are located,\n");
@@ -560,6 +595,7 @@ void print_usage()
 	printf("    -i <instance>      px4 instance id to run multiple instances [0...N], default=0\n");
 	printf("    -h                 help/usage information\n");
 	printf("    -d                 daemon mode, don't start pxh shell\n");
+	printf("    -e                 run the startup file with /bin/sh instead of in-process\n");
 	printf("\n");
 	printf("Usage for client: \n");
 	printf("\n");
@@ -0,0 +1,1945 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file startup_script.cpp
+ *
+ * In-process executor for the POSIX startup scripts.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <errno.h>
+#include <fnmatch.h>
+#include <glob.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <px4_log.h>
+
+#include "server.h"
+#include "startup_script.h"
+
+namespace px4_daemon
+{
+
+/* maximum nesting of sourced scripts */
+static constexpr int MAX_DEPTH = 16;
+
+/* number of commands listed in the timeline summary */
+static constexpr size_t SUMMARY_COMMANDS = 10;
+
+static bool is_name_start(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool is_name_char(char c)
+{
+	return is_name_start(c) || (c >= '0' && c <= '9');
+}
+
+static bool is_glob_char(char c)
+{
+	return c == '*' || c == '?' || c == '[';
+}
+
+static bool is_blank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool is_operator(char c)
+{
+	return c == ';' || c == '&' || c == '|' || c == '(' || c == ')' || c == '<' || c == '>' || c == '\n';
+}
+
+static bool is_number(const std::string &s)
+{
+	return !s.empty() && std::all_of(s.begin(), s.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+static std::string find_in_path(const char *name)
+{
+	const char *path = getenv("PATH");
+	std::stringstream directories(path ? path : "");
+	std::string directory;
+
+	while (std::getline(directories, directory, ':')) {
+		const std::string file = directory + "/" + name;
+
+		if (access(file.c_str(), R_OK) == 0) {
+			return file;
+		}
+	}
+
+	return "";
+}
+
+static std::string quote(const std::string &s)
+{
+	std::string quoted = "'";
+
+	for (char c : s) {
+		if (c == '\'') {
+			quoted += "'\\''";
+
+		} else {
+			quoted += c;
+		}
+	}
+
+	return quoted + "'";
+}
+
+static size_t skip_parens(const std::string &text, size_t i);
+
+/* i points to the opening quote, returns the index after the closing one or npos */
+static size_t skip_double_quoted(const std::string &text, size_t i)
+{
+	for (i++; i < text.size(); i++) {
+		if (text[i] == '\\') {
+			i++;
+
+		} else if (text[i] == '"') {
+			return i + 1;
+
+		} else if (text[i] == '$' && i + 1 < text.size() && text[i + 1] == '(') {
+			i = skip_parens(text, i + 1);
+
+			if (i == std::string::npos) {
+				return i;
+			}
+
+			i--;
+
+		} else if (text[i] == '`') {
+			return std::string::npos;
+		}
+	}
+
+	return std::string::npos;
+}
+
+/* i points to the opening parenthesis, returns the index after the matching one or npos */
+static size_t skip_parens(const std::string &text, size_t i)
+{
+	int depth = 0;
+
+	while (i < text.size()) {
+		const char c = text[i];
+
+		if (c == '(') {
+			depth++;
+			i++;
+
+		} else if (c == ')') {
+			i++;
+
+			if (--depth == 0) {
+				return i;
+			}
+
+		} else if (c == '\'') {
+			i = text.find('\'', i + 1);
+
+			if (i == std::string::npos) {
+				return i;
+			}
+
+			i++;
+
+		} else if (c == '"') {
+			i = skip_double_quoted(text, i);
+
+			if (i == std::string::npos) {
+				return i;
+			}
+
+		} else if (c == '\\') {
+			i += 2;
+
+		} else {
+			i++;
+		}
+	}
+
+	return std::string::npos;
+}
+
+/* integer arithmetic for $((...)): + - * / % and parentheses on numbers and variables */
+class Arithmetic
+{
+public:
+	Arithmetic(const std::string &expression, const std::map<std::string, std::string> &variables) :
+		_expr(expression), _variables(variables) {}
+
+	bool evaluate(long &result)
+	{
+		result = sum();
+		skip_blanks();
+		return _ok && _pos == _expr.size();
+	}
+
+private:
+	void skip_blanks()
+	{
+		while (_pos < _expr.size() && (is_blank(_expr[_pos]) || _expr[_pos] == '\n')) {
+			_pos++;
+		}
+	}
+
+	long sum()
+	{
+		long value = product();
+
+		while (_ok) {
+			skip_blanks();
+
+			if (_pos < _expr.size() && (_expr[_pos] == '+' || _expr[_pos] == '-')) {
+				const char op = _expr[_pos++];
+				const long rhs = product();
+				value = (op == '+') ? value + rhs : value - rhs;
+
+			} else {
+				break;
+			}
+		}
+
+		return value;
+	}
+
+	long product()
+	{
+		long value = factor();
+
+		while (_ok) {
+			skip_blanks();
+
+			if (_pos < _expr.size() && (_expr[_pos] == '*' || _expr[_pos] == '/' || _expr[_pos] == '%')) {
+				const char op = _expr[_pos++];
+				const long rhs = factor();
+
+				if (op == '*') {
+					value *= rhs;
+
+				} else if (rhs == 0) {
+					_ok = false;
+
+				} else {
+					value = (op == '/') ? value / rhs : value % rhs;
+				}
+
+			} else {
+				break;
+			}
+		}
+
+		return value;
+	}
+
+	long factor()
+	{
+		skip_blanks();
+
+		if (_pos >= _expr.size()) {
+			_ok = false;
+			return 0;
+		}
+
+		const char c = _expr[_pos];
+
+		if (c == '(') {
+			_pos++;
+			const long value = sum();
+			skip_blanks();
+
+			if (_pos >= _expr.size() || _expr[_pos] != ')') {
+				_ok = false;
+				return 0;
+			}
+
+			_pos++;
+			return value;
+		}
+
+		if (c == '-' || c == '+') {
+			_pos++;
+			const long value = factor();
+			return (c == '-') ? -value : value;
+		}
+
+		if (c >= '0' && c <= '9') {
+			char *end = nullptr;
+			const long value = strtol(_expr.c_str() + _pos, &end, 0);
+			_pos = end - _expr.c_str();
+			return value;
+		}
+
+		if (c == '$') {
+			_pos++;
+		}
+
+		const size_t start = _pos;
+
+		while (_pos < _expr.size() && is_name_char(_expr[_pos])) {
+			_pos++;
+		}
+
+		if (_pos == start) {
+			_ok = false;
+			return 0;
+		}
+
+		const std::string name = _expr.substr(start, _pos - start);
+		const auto it = _variables.find(name);
+		const char *value = (it != _variables.end()) ? it->second.c_str() : getenv(name.c_str());
+
+		return value ? strtol(value, nullptr, 0) : 0;
+	}
+
+	const std::string _expr;
+	const std::map<std::string, std::string> &_variables;
+	size_t _pos{0};
+	bool _ok{true};
+};
+
+/* evaluation of test / [ expressions, returns true if the expression holds */
+class TestExpression
+{
+public:
+	TestExpression(const std::vector<std::string> &args) : _args(args) {}
+
+	/* @return 0 if true, 1 if false, 2 on syntax error */
+	int evaluate()
+	{
+		if (_args.empty()) {
+			return 1;
+		}
+
+		const bool result = disjunction();
+
+		if (!_ok || _pos != _args.size()) {
+			return 2;
+		}
+
+		return result ? 0 : 1;
+	}
+
+private:
+	bool disjunction()
+	{
+		bool result = conjunction();
+
+		while (_ok && _pos < _args.size() && _args[_pos] == "-o") {
+			_pos++;
+			result = conjunction() || result;
+		}
+
+		return result;
+	}
+
+	bool conjunction()
+	{
+		bool result = negation();
+
+		while (_ok && _pos < _args.size() && _args[_pos] == "-a") {
+			_pos++;
+			result = negation() && result;
+		}
+
+		return result;
+	}
+
+	bool negation()
+	{
+		if (_pos < _args.size() && _args[_pos] == "!" && _pos + 1 < _args.size()) {
+			_pos++;
+			return !negation();
+		}
+
+		return primary();
+	}
+
+	static bool is_binary(const std::string &op)
+	{
+		return op == "=" || op == "==" || op == "!=" || op == "-eq" || op == "-ne" ||
+		       op == "-lt" || op == "-le" || op == "-gt" || op == "-ge";
+	}
+
+	static bool is_unary(const std::string &op)
+	{
+		return op == "-f" || op == "-e" || op == "-d" || op == "-r" || op == "-w" ||
+		       op == "-x" || op == "-s" || op == "-z" || op == "-n";
+	}
+
+	bool primary()
+	{
+		if (_pos >= _args.size()) {
+			_ok = false;
+			return false;
+		}
+
+		if (_pos + 2 < _args.size() && is_binary(_args[_pos + 1])) {
+			const std::string &lhs = _args[_pos];
+			const std::string &op = _args[_pos + 1];
+			const std::string &rhs = _args[_pos + 2];
+			_pos += 3;
+
+			if (op == "=" || op == "==") {
+				return lhs == rhs;
+			}
+
+			if (op == "!=") {
+				return lhs != rhs;
+			}
+
+			const long a = strtol(lhs.c_str(), nullptr, 10);
+			const long b = strtol(rhs.c_str(), nullptr, 10);
+
+			if (op == "-eq") { return a == b; }
+
+			if (op == "-ne") { return a != b; }
+
+			if (op == "-lt") { return a < b; }
+
+			if (op == "-le") { return a <= b; }
+
+			if (op == "-gt") { return a > b; }
+
+			return a >= b;
+		}
+
+		if (_pos + 1 < _args.size() && is_unary(_args[_pos])) {
+			const std::string &op = _args[_pos];
+			const std::string &arg = _args[_pos + 1];
+			_pos += 2;
+
+			if (op == "-z") { return arg.empty(); }
+
+			if (op == "-n") { return !arg.empty(); }
+
+			struct stat st;
+
+			if (stat(arg.c_str(), &st) != 0) {
+				return false;
+			}
+
+			if (op == "-f") { return S_ISREG(st.st_mode); }
+
+			if (op == "-d") { return S_ISDIR(st.st_mode); }
+
+			if (op == "-s") { return st.st_size > 0; }
+
+			if (op == "-r") { return access(arg.c_str(), R_OK) == 0; }
+
+			if (op == "-w") { return access(arg.c_str(), W_OK) == 0; }
+
+			if (op == "-x") { return access(arg.c_str(), X_OK) == 0; }
+
+			return true;
+		}
+
+		return !_args[_pos++].empty();
+	}
+
+	const std::vector<std::string> &_args;
+	size_t _pos{0};
+	bool _ok{true};
+};
+
+StartupScript::StartupScript(const std::string &path, int instance) :
+	_path(path),
+	_instance(instance),
+	_alias_script(find_in_path("px4-alias.sh"))
+{
+	pthread_mutex_init(&_timeline_mutex, nullptr);
+	init_app_map(_apps);
+
+	// px4-alias.sh sets this from the script argument
+	_variables["px4_instance"] = std::to_string(instance);
+}
+
+StartupScript::~StartupScript()
+{
+	wait_background();
+	pthread_mutex_destroy(&_timeline_mutex);
+}
+
+bool StartupScript::load()
+{
+	_root = parse(_path);
+	return _root != nullptr;
+}
+
+int StartupScript::run()
+{
+	if (!_root) {
+		return -1;
+	}
+
+	_start = std::chrono::steady_clock::now();
+	_status = 0;
+	_exit = false;
+
+	int ret = execute(*_root);
+
+	wait_background();
+
+	return ret;
+}
+
+/* parsing */
+
+bool StartupScript::tokenize(const std::string &text, const std::string &file, std::vector<Token> &tokens)
+{
+	int line = 1;
+	size_t i = 0;
+	const size_t n = text.size();
+	size_t word_end = std::string::npos;
+
+	// here-documents whose body starts on the next line
+	struct HereDocument {
+		size_t token;
+		std::string delimiter;
+		bool strip_tabs;
+	};
+
+	std::vector<HereDocument> here_documents;
+
+	// returns the end of the word starting at pos, or npos on error
+	auto scan_word = [&](size_t pos) {
+		while (pos < n && !is_blank(text[pos]) && !is_operator(text[pos])) {
+			if (text[pos] == '\\') {
+				pos += 2;
+
+			} else if (text[pos] == '\'') {
+				pos = text.find('\'', pos + 1);
+
+				if (pos != std::string::npos) {
+					pos++;
+				}
+
+			} else if (text[pos] == '"') {
+				pos = skip_double_quoted(text, pos);
+
+			} else if (text[pos] == '$' && pos + 1 < n && text[pos + 1] == '(') {
+				pos = skip_parens(text, pos + 1);
+
+			} else if (text[pos] == '$' && pos + 1 < n && text[pos + 1] == '{') {
+				pos = text.find('}', pos);
+
+				if (pos != std::string::npos) {
+					pos++;
+				}
+
+			} else if (text[pos] == '`') {
+				PX4_ERR("%s:%i: backquote command substitution is not supported", file.c_str(), line);
+				return std::string::npos;
+
+			} else {
+				pos++;
+			}
+
+			if (pos == std::string::npos) {
+				PX4_ERR("%s:%i: unterminated quote or substitution", file.c_str(), line);
+				return std::string::npos;
+			}
+		}
+
+		return std::min(pos, n);
+	};
+
+	while (i < n) {
+		const char c = text[i];
+
+		if (is_blank(c)) {
+			i++;
+			continue;
+		}
+
+		if (c == '\\' && i + 1 < n && text[i + 1] == '\n') {
+			i += 2;
+			line++;
+			continue;
+		}
+
+		if (c == '#') {
+			while (i < n && text[i] != '\n') {
+				i++;
+			}
+
+			continue;
+		}
+
+		const char next = (i + 1 < n) ? text[i + 1] : '\0';
+
+		switch (c) {
+		case '\n':
+			tokens.push_back({Token::NEWLINE, "", line++});
+			i++;
+
+			// the body (up to and including the delimiter line) is appended to the redirection
+			for (const HereDocument &here : here_documents) {
+				std::string body;
+
+				while (true) {
+					if (i >= n) {
+						PX4_ERR("%s:%i: unterminated here-document", file.c_str(), line);
+						return false;
+					}
+
+					const size_t end = std::min(text.find('\n', i), n);
+					std::string content = text.substr(i, end - i);
+					body += content + "\n";
+					i = std::min(end + 1, n);
+					line++;
+
+					if (here.strip_tabs) {
+						content.erase(0, content.find_first_not_of('\t'));
+					}
+
+					if (content == here.delimiter) {
+						break;
+					}
+				}
+
+				tokens[here.token].text += "\n" + body;
+			}
+
+			here_documents.clear();
+			continue;
+
+		case ';':
+			tokens.push_back({(next == ';') ? Token::DSEMI : Token::SEMI, "", line});
+			i += (next == ';') ? 2 : 1;
+			continue;
+
+		case '&':
+			tokens.push_back({(next == '&') ? Token::AND_IF : Token::AMP, "", line});
+			i += (next == '&') ? 2 : 1;
+			continue;
+
+		case '|':
+			tokens.push_back({(next == '|') ? Token::OR_IF : Token::PIPE, "", line});
+			i += (next == '|') ? 2 : 1;
+			continue;
+
+		case '(':
+			tokens.push_back({Token::LPAREN, "", line});
+			i++;
+			continue;
+
+		case ')':
+			tokens.push_back({Token::RPAREN, "", line});
+			i++;
+			continue;
+
+		case '<':
+		case '>': {
+				// a redirection token holds the operator and its target, e.g. '2>&1' or '<<EOF'
+				std::string redirection(1, c);
+				size_t pos = i + 1;
+
+				if (next == c || next == '&' || (c == '>' && next == '|') ||
+				    (c == '<' && next == '>')) {
+					redirection += next;
+					pos++;
+				}
+
+				const bool here_document = (redirection == "<<");
+				const bool strip_tabs = here_document && pos < n && text[pos] == '-';
+
+				if (strip_tabs) {
+					redirection += '-';
+					pos++;
+				}
+
+				// a number directly in front is the file descriptor
+				if (!tokens.empty() && tokens.back().type == Token::WORD && word_end == i &&
+				    is_number(tokens.back().text)) {
+					redirection = tokens.back().text + redirection;
+					tokens.pop_back();
+				}
+
+				while (pos < n && is_blank(text[pos])) {
+					pos++;
+				}
+
+				const size_t target = pos;
+				pos = scan_word(pos);
+
+				if (pos == std::string::npos) {
+					return false;
+				}
+
+				if (pos == target) {
+					PX4_ERR("%s:%i: missing redirection target", file.c_str(), line);
+					return false;
+				}
+
+				const std::string word = text.substr(target, pos - target);
+
+				if (here_document) {
+					std::string delimiter;
+
+					for (char d : word) {
+						if (d != '\'' && d != '"' && d != '\\') {
+							delimiter += d;
+						}
+					}
+
+					here_documents.push_back({tokens.size(), delimiter, strip_tabs});
+				}
+
+				tokens.push_back({Token::REDIRECT, redirection + word, line});
+				i = pos;
+				continue;
+			}
+		}
+
+		const size_t start = i;
+		i = scan_word(i);
+
+		if (i == std::string::npos) {
+			return false;
+		}
+
+		tokens.push_back({Token::WORD, text.substr(start, i - start), line});
+		line += std::count(text.begin() + start, text.begin() + i, '\n');
+		word_end = i;
+	}
+
+	if (!here_documents.empty()) {
+		PX4_ERR("%s:%i: unterminated here-document", file.c_str(), line);
+		return false;
+	}
+
+	tokens.push_back({Token::END, "", line});
+	return true;
+}
+
+std::unique_ptr<StartupScript::Node> StartupScript::parse(const std::string &path)
+{
+	std::ifstream file(path);
+
+	if (!file.is_open()) {
+		PX4_ERR("cannot open %s", path.c_str());
+		return nullptr;
+	}
+
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+
+	std::vector<Token> tokens;
+
+	if (!tokenize(buffer.str(), path, tokens)) {
+		return nullptr;
+	}
+
+	_tokens = std::move(tokens);
+	_token = 0;
+	_parse_file = path;
+
+	std::unique_ptr<Node> root = parse_list({});
+
+	if (root && _tokens[_token].type != Token::END) {
+		parse_error("unexpected token");
+		root.reset();
+	}
+
+	_tokens.clear();
+	return root;
+}
+
+bool StartupScript::at_reserved(const char *word) const
+{
+	const Token &t = _tokens[_token];
+	return t.type == Token::WORD && t.text == word;
+}
+
+bool StartupScript::expect_reserved(const char *word)
+{
+	if (!at_reserved(word)) {
+		char what[32];
+		snprintf(what, sizeof(what), "expected '%s'", word);
+		return parse_error(what);
+	}
+
+	_token++;
+	return true;
+}
+
+void StartupScript::skip_newlines()
+{
+	while (_tokens[_token].type == Token::NEWLINE) {
+		_token++;
+	}
+}
+
+bool StartupScript::parse_error(const char *what)
+{
+	PX4_ERR("%s:%i: %s", _parse_file.c_str(), _tokens[_token].line, what);
+	return false;
+}
+
+std::unique_ptr<StartupScript::Node> StartupScript::parse_list(const std::vector<const char *> &terminators)
+{
+	std::unique_ptr<Node> sequence(new Node(Node::SEQUENCE, _tokens[_token].line));
+
+	while (true) {
+		while (_tokens[_token].type == Token::NEWLINE || _tokens[_token].type == Token::SEMI) {
+			_token++;
+		}
+
+		const Token &t = _tokens[_token];
+
+		if (t.type == Token::END || t.type == Token::DSEMI || t.type == Token::RPAREN) {
+			break;
+		}
+
+		if (std::any_of(terminators.begin(), terminators.end(), [this](const char *w) { return at_reserved(w); })) {
+			break;
+		}
+
+		std::unique_ptr<Node> node = parse_and_or();
+
+		if (!node) {
+			return nullptr;
+		}
+
+		if (_tokens[_token].type == Token::AMP) {
+			node->background = true;
+			_token++;
+		}
+
+		sequence->children.push_back(std::move(node));
+	}
+
+	return sequence;
+}
+
+std::unique_ptr<StartupScript::Node> StartupScript::parse_and_or()
+{
+	std::unique_ptr<Node> left = parse_pipeline();
+
+	while (left && (_tokens[_token].type == Token::AND_IF || _tokens[_token].type == Token::OR_IF)) {
+		std::unique_ptr<Node> node(new Node(_tokens[_token].type == Token::AND_IF ? Node::AND : Node::OR,
+						    _tokens[_token].line));
+		_token++;
+		skip_newlines();
+
+		std::unique_ptr<Node> right = parse_pipeline();
+
+		if (!right) {
+			return nullptr;
+		}
+
+		node->children.push_back(std::move(left));
+		node->children.push_back(std::move(right));
+		left = std::move(node);
+	}
+
+	return left;
+}
+
+std::unique_ptr<StartupScript::Node> StartupScript::parse_pipeline()
+{
+	std::unique_ptr<Node> node;
+
+	if (at_reserved("!")) {
+		node.reset(new Node(Node::NOT, _tokens[_token].line));
+		_token++;
+
+		std::unique_ptr<Node> child = parse_command();
+
+		if (!child) {
+			return nullptr;
+		}
+
+		node->children.push_back(std::move(child));
+
+	} else {
+		node = parse_command();
+	}
+
+	if (node && _tokens[_token].type == Token::PIPE) {
+		parse_error("pipes are not supported");
+		return nullptr;
+	}
+
+	return node;
+}
+
+std::unique_ptr<StartupScript::Node> StartupScript::parse_command()
+{
+	const Token &t = _tokens[_token];
+
+	if (t.type != Token::WORD && t.type != Token::REDIRECT) {
+		parse_error("expected a command");
+		return nullptr;
+	}
+
+	if (t.text == "if") {
+		return parse_if();
+
+	} else if (t.text == "for") {
+		return parse_for();
+
+	} else if (t.text == "case") {
+		return parse_case();
+	}
+
+	static const char *unsupported[] = {"while", "until", "function", "{", "}"};
+	static const char *misplaced[] = {"then", "elif", "else", "fi", "do", "done", "esac", "in"};
+
+	for (const char *word : unsupported) {
+		if (t.text == word) {
+			parse_error("unsupported shell construct");
+			return nullptr;
+		}
+	}
+
+	for (const char *word : misplaced) {
+		if (t.text == word) {
+			parse_error("unexpected reserved word");
+			return nullptr;
+		}
+	}
+
+	std::unique_ptr<Node> node(new Node(Node::COMMAND, t.line));
+	std::string here_documents;
+
+	while (_tokens[_token].type == Token::WORD || _tokens[_token].type == Token::REDIRECT) {
+		const Token &word = _tokens[_token++];
+		const size_t newline = word.text.find('\n');
+
+		if (word.type == Token::REDIRECT) {
+			node->type = Node::SHELL;
+
+			if (newline != std::string::npos) {
+				here_documents += word.text.substr(newline + 1);
+			}
+		}
+
+		node->words.push_back(word.text.substr(0, newline));
+	}
+
+	if (node->type == Node::SHELL) {
+		std::string command;
+
+		for (const std::string &word : node->words) {
+			command += (command.empty() ? "" : " ") + word;
+		}
+
+		node->words.assign(1, here_documents.empty() ? command : command + "\n" + here_documents);
+	}
+
+	if (_tokens[_token].type == Token::LPAREN) {
+		parse_error("functions and subshells are not supported");
+		return nullptr;
+	}
+
+	return node;
+}
+
+std::unique_ptr<StartupScript::Node> StartupScript::parse_if()
+{
+	std::unique_ptr<Node> node(new Node(Node::IF, _tokens[_token].line));
+	_token++;
+
+	while (true) {
+		std::unique_ptr<Node> condition = parse_list({"then"});
+
+		if (!condition || !expect_reserved("then")) {
+			return nullptr;
+		}
+
+		std::unique_ptr<Node> body = parse_list({"elif", "else", "fi"});
+
+		if (!body) {
+			return nullptr;
+		}
+
+		node->children.push_back(std::move(condition));
+		node->children.push_back(std::move(body));
+
+		if (at_reserved("elif")) {
+			_token++;
+			continue;
+		}
+
+		if (at_reserved("else")) {
+			_token++;
+			std::unique_ptr<Node> otherwise = parse_list({"fi"});
+
+			if (!otherwise) {
+				return nullptr;
+			}
+
+			node->children.push_back(std::move(otherwise));
+		}
+
+		if (!expect_reserved("fi")) {
+			return nullptr;
+		}
+
+		return node;
+	}
+}
+
+std::unique_ptr<StartupScript::Node> StartupScript::parse_for()
+{
+	std::unique_ptr<Node> node(new Node(Node::FOR, _tokens[_token].line));
+	_token++;
+
+	const Token &name = _tokens[_token];
+
+	if (name.type != Token::WORD || name.text.empty() || !is_name_start(name.text[0]) ||
+	    !std::all_of(name.text.begin(), name.text.end(), is_name_char)) {
+		parse_error("expected a variable name");
+		return nullptr;
+	}
+
+	node->words.push_back(name.text);
+	_token++;
+
+	if (!expect_reserved("in")) {
+		return nullptr;
+	}
+
+	while (_tokens[_token].type == Token::WORD) {
+		node->words.push_back(_tokens[_token].text);
+		_token++;
+	}
+
+	if (_tokens[_token].type == Token::SEMI) {
+		_token++;
+	}
+
+	skip_newlines();
+
+	if (!expect_reserved("do")) {
+		return nullptr;
+	}
+
+	std::unique_ptr<Node> body = parse_list({"done"});
+
+	if (!body || !expect_reserved("done")) {
+		return nullptr;
+	}
+
+	node->children.push_back(std::move(body));
+	return node;
+}
+
+std::unique_ptr<StartupScript::Node> StartupScript::parse_case()
+{
+	std::unique_ptr<Node> node(new Node(Node::CASE, _tokens[_token].line));
+	_token++;
+
+	if (_tokens[_token].type != Token::WORD) {
+		parse_error("expected a word");
+		return nullptr;
+	}
+
+	node->words.push_back(_tokens[_token].text);
+	_token++;
+	skip_newlines();
+
+	if (!expect_reserved("in")) {
+		return nullptr;
+	}
+
+	skip_newlines();
+
+	while (!at_reserved("esac")) {
+		if (_tokens[_token].type == Token::LPAREN) {
+			_token++;
+		}
+
+		std::vector<std::string> patterns;
+
+		while (true) {
+			if (_tokens[_token].type != Token::WORD) {
+				parse_error("expected a pattern");
+				return nullptr;
+			}
+
+			patterns.push_back(_tokens[_token].text);
+			_token++;
+
+			if (_tokens[_token].type != Token::PIPE) {
+				break;
+			}
+
+			_token++;
+		}
+
+		if (_tokens[_token].type != Token::RPAREN) {
+			parse_error("expected ')'");
+			return nullptr;
+		}
+
+		_token++;
+
+		std::unique_ptr<Node> body = parse_list({"esac"});
+
+		if (!body) {
+			return nullptr;
+		}
+
+		node->patterns.push_back(std::move(patterns));
+		node->children.push_back(std::move(body));
+
+		if (_tokens[_token].type == Token::DSEMI) {
+			_token++;
+		}
+
+		skip_newlines();
+	}
+
+	_token++;
+	return node;
+}
+
+/* expansion */
+
+std::string StartupScript::lookup(const std::string &name) const
+{
+	const auto it = _variables.find(name);
+
+	if (it != _variables.end()) {
+		return it->second;
+	}
+
+	const char *value = getenv(name.c_str());
+	return value ? value : "";
+}
+
+bool StartupScript::expand_dollar(const std::string &raw, size_t &pos, std::string &value)
+{
+	const size_t n = raw.size();
+	const char next = (pos + 1 < n) ? raw[pos + 1] : '\0';
+
+	if (next == '(') {
+		const size_t end = skip_parens(raw, pos + 1);
+
+		if (end == std::string::npos) {
+			return false;
+		}
+
+		const std::string inner = raw.substr(pos + 2, end - 1 - (pos + 2));
+		pos = end;
+
+		if (inner.size() >= 2 && inner.front() == '(' && inner.back() == ')') {
+			long result = 0;
+			Arithmetic arithmetic(inner.substr(1, inner.size() - 2), _variables);
+
+			if (!arithmetic.evaluate(result)) {
+				PX4_ERR("invalid arithmetic expression: %s", inner.c_str());
+				return false;
+			}
+
+			value = std::to_string(result);
+			return true;
+		}
+
+		return command_substitution(inner, value);
+	}
+
+	if (next == '{') {
+		const size_t end = raw.find('}', pos);
+
+		if (end == std::string::npos) {
+			return false;
+		}
+
+		value = lookup(raw.substr(pos + 2, end - pos - 2));
+		pos = end + 1;
+		return true;
+	}
+
+	if (is_name_start(next)) {
+		size_t end = pos + 1;
+
+		while (end < n && is_name_char(raw[end])) {
+			end++;
+		}
+
+		value = lookup(raw.substr(pos + 1, end - pos - 1));
+		pos = end;
+		return true;
+	}
+
+	pos += 2;
+
+	switch (next) {
+	case '0':
+		value = _path;
+		break;
+
+	case '1':
+		value = std::to_string(_instance);
+		break;
+
+	case '?':
+		value = std::to_string(_status);
+		break;
+
+	case '#':
+		value = "1";
+		break;
+
+	case '$':
+		value = std::to_string(getpid());
+		break;
+
+	default:
+		if (next >= '2' && next <= '9') {
+			value = "";
+
+		} else {
+			// not an expansion, a literal '$'
+			value = "$";
+			pos--;
+		}
+	}
+
+	return true;
+}
+
+bool StartupScript::expand_word(const std::string &raw, std::vector<Field> &fields, bool split)
+{
+	Field current;
+	bool have = false;
+
+	auto append = [&current, &have](const std::string & s, bool quoted) {
+		for (char c : s) {
+			if (quoted && (is_glob_char(c) || c == '\\')) {
+				current.pattern += '\\';
+
+			} else if (!quoted && is_glob_char(c)) {
+				current.glob = true;
+			}
+
+			current.text += c;
+			current.pattern += c;
+		}
+
+		have = have || quoted || !s.empty();
+	};
+
+	auto append_split = [&](const std::string & s) {
+		if (!split) {
+			append(s, false);
+			return;
+		}
+
+		for (char c : s) {
+			if (c == ' ' || c == '\t' || c == '\n') {
+				if (have) {
+					fields.push_back(current);
+					current = Field();
+					have = false;
+				}
+
+			} else {
+				append(std::string(1, c), false);
+			}
+		}
+	};
+
+	size_t i = 0;
+
+	while (i < raw.size()) {
+		const char c = raw[i];
+
+		if (c == '\'') {
+			const size_t end = raw.find('\'', i + 1);
+
+			if (end == std::string::npos) {
+				return false;
+			}
+
+			append(raw.substr(i + 1, end - i - 1), true);
+			current.quoted = true;
+			i = end + 1;
+
+		} else if (c == '"') {
+			current.quoted = true;
+			have = true;
+			i++;
+
+			while (i < raw.size() && raw[i] != '"') {
+				if (raw[i] == '\\' && i + 1 < raw.size() && strchr("$`\"\\\n", raw[i + 1])) {
+					append(std::string(1, raw[i + 1]), true);
+					i += 2;
+
+				} else if (raw[i] == '$') {
+					std::string value;
+
+					if (!expand_dollar(raw, i, value)) {
+						return false;
+					}
+
+					append(value, true);
+
+				} else {
+					append(std::string(1, raw[i]), true);
+					i++;
+				}
+			}
+
+			i++;
+
+		} else if (c == '\\') {
+			if (i + 1 < raw.size()) {
+				append(std::string(1, raw[i + 1]), true);
+			}
+
+			i += 2;
+
+		} else if (c == '$') {
+			std::string value;
+
+			if (!expand_dollar(raw, i, value)) {
+				return false;
+			}
+
+			append_split(value);
+
+		} else {
+			append(std::string(1, c), false);
+			i++;
+		}
+	}
+
+	if (have) {
+		fields.push_back(current);
+	}
+
+	return true;
+}
+
+bool StartupScript::expand_words(const std::vector<std::string> &raw, std::vector<std::string> &argv)
+{
+	for (const std::string &word : raw) {
+		std::vector<Field> fields;
+
+		if (!expand_word(word, fields, true)) {
+			PX4_ERR("failed to expand '%s'", word.c_str());
+			return false;
+		}
+
+		for (const Field &field : fields) {
+			glob_t matches;
+
+			if (field.glob && glob(field.pattern.c_str(), 0, nullptr, &matches) == 0) {
+				for (size_t i = 0; i < matches.gl_pathc; i++) {
+					argv.push_back(matches.gl_pathv[i]);
+				}
+
+				globfree(&matches);
+
+			} else {
+				// like sh, a pattern without matches stays as it is
+				argv.push_back(field.text);
+			}
+		}
+	}
+
+	return true;
+}
+
+std::string StartupScript::expand_single(const std::string &raw)
+{
+	std::vector<Field> fields;
+	expand_word(raw, fields, false);
+	return fields.empty() ? "" : fields[0].text;
+}
+
+bool StartupScript::command_substitution(const std::string &command, std::string &output)
+{
+	output.clear();
+
+	// a single PX4 command runs in-process with its output captured
+	std::vector<Token> tokens;
+	std::vector<std::string> words;
+
+	if (Server::is_running() && tokenize(command, _path, tokens)) {
+		size_t i = 0;
+
+		while (i < tokens.size() && tokens[i].type == Token::WORD) {
+			words.push_back(tokens[i++].text);
+		}
+
+		while (i < tokens.size() && tokens[i].type == Token::NEWLINE) {
+			i++;
+		}
+
+		if (i + 1 != tokens.size()) {
+			words.clear();
+		}
+	}
+
+	std::vector<std::string> argv;
+
+	if (!words.empty() && expand_words(words, argv) && !argv.empty() && _apps.find(argv[0]) != _apps.end()) {
+		char *buffer = nullptr;
+		size_t size = 0;
+		FILE *out = open_memstream(&buffer, &size);
+
+		if (out == nullptr) {
+			return false;
+		}
+
+		Server::CmdThreadSpecificData data{out, false};
+		void *previous = pthread_getspecific(Server::get_pthread_key());
+		pthread_setspecific(Server::get_pthread_key(), &data);
+
+		const uint64_t start = now_us();
+		_status = run_app(_apps[argv[0]], argv);
+		add_timeline(argv, start, _status, false);
+
+		pthread_setspecific(Server::get_pthread_key(), previous);
+		fclose(out);
+
+		output.assign(buffer, size);
+		free(buffer);
+
+	} else {
+		// anything else is a regular subshell
+		FILE *pipe = popen(shell_command(command).c_str(), "r");
+
+		if (pipe == nullptr) {
+			return false;
+		}
+
+		char buffer[256];
+		size_t n;
+
+		while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+			output.append(buffer, n);
+		}
+
+		const int ret = pclose(pipe);
+		_status = (ret != -1 && WIFEXITED(ret)) ? WEXITSTATUS(ret) : 1;
+	}
+
+	while (!output.empty() && output.back() == '\n') {
+		output.pop_back();
+	}
+
+	return true;
+}
+
+std::string StartupScript::shell_exports() const
+{
+	std::string exports;
+
+	for (const auto &variable : _variables) {
+		exports += "export " + variable.first + "=" + quote(variable.second) + "; ";
+	}
+
+	return exports;
+}
+
+std::string StartupScript::shell_command(const std::string &script) const
+{
+	// the script variables are exported and PX4 commands are reached through the px4-alias.sh aliases
+	const std::string aliases = _alias_script.empty() ? "" : ". " + quote(_alias_script) + "\n";
+
+	// $? of the previous command
+	const std::string status = (_status == 0) ? "" : "(exit " + std::to_string(_status) + ")\n";
+
+	return shell_exports() + "/bin/sh -c " + quote(aliases + status + script) + " " + quote(_path) + " " +
+	       std::to_string(_instance);
+}
+
+/* execution */
+
+int StartupScript::execute(const Node &node)
+{
+	if (_exit) {
+		return _status;
+	}
+
+	switch (node.type) {
+	case Node::COMMAND:
+		_status = execute_command(node);
+		break;
+
+	case Node::SEQUENCE:
+		for (const auto &child : node.children) {
+			if (_exit) {
+				break;
+			}
+
+			_status = execute(*child);
+		}
+
+		break;
+
+	case Node::AND:
+		_status = execute(*node.children[0]);
+
+		if (_status == 0 && !_exit) {
+			_status = execute(*node.children[1]);
+		}
+
+		break;
+
+	case Node::OR:
+		_status = execute(*node.children[0]);
+
+		if (_status != 0 && !_exit) {
+			_status = execute(*node.children[1]);
+		}
+
+		break;
+
+	case Node::NOT:
+		_status = (execute(*node.children[0]) == 0) ? 1 : 0;
+		break;
+
+	case Node::IF:
+		_status = execute_if(node);
+		break;
+
+	case Node::FOR:
+		_status = execute_for(node);
+		break;
+
+	case Node::CASE:
+		_status = execute_case(node);
+		break;
+
+	case Node::SHELL:
+		_status = execute_shell(node);
+		break;
+	}
+
+	return _status;
+}
+
+int StartupScript::execute_command(const Node &node)
+{
+	// NAME=value assignments (only if the whole command consists of them)
+	const bool assignments = std::all_of(node.words.begin(), node.words.end(), [](const std::string & word) {
+		size_t eq = word.find('=');
+		return eq != std::string::npos && eq > 0 && is_name_start(word[0]) &&
+		       std::all_of(word.begin(), word.begin() + eq, is_name_char);
+	});
+
+	if (assignments) {
+		_status = 0;
+
+		for (const std::string &word : node.words) {
+			const size_t eq = word.find('=');
+			_variables[word.substr(0, eq)] = expand_single(word.substr(eq + 1));
+		}
+
+		return _status;
+	}
+
+	std::vector<std::string> argv;
+
+	if (!expand_words(node.words, argv)) {
+		return 1;
+	}
+
+	if (argv.empty()) {
+		return 0;
+	}
+
+	return run_argv(argv, node.background);
+}
+
+int StartupScript::execute_if(const Node &node)
+{
+	const size_t branches = node.children.size() / 2;
+
+	for (size_t i = 0; i < branches && !_exit; i++) {
+		if (execute(*node.children[2 * i]) == 0) {
+			return execute(*node.children[2 * i + 1]);
+		}
+	}
+
+	if (node.children.size() % 2 == 1 && !_exit) {
+		return execute(*node.children.back());
+	}
+
+	return 0;
+}
+
+int StartupScript::execute_for(const Node &node)
+{
+	std::vector<std::string> items;
+
+	if (!expand_words(std::vector<std::string>(node.words.begin() + 1, node.words.end()), items)) {
+		return 1;
+	}
+
+	int ret = 0;
+
+	for (const std::string &item : items) {
+		if (_exit) {
+			break;
+		}
+
+		_variables[node.words[0]] = item;
+		ret = execute(*node.children[0]);
+	}
+
+	return ret;
+}
+
+int StartupScript::execute_case(const Node &node)
+{
+	const std::string subject = expand_single(node.words[0]);
+
+	for (size_t i = 0; i < node.patterns.size(); i++) {
+		for (const std::string &raw : node.patterns[i]) {
+			std::vector<Field> fields;
+			expand_word(raw, fields, false);
+
+			const std::string pattern = fields.empty() ? "" : fields[0].pattern;
+
+			if (fnmatch(pattern.c_str(), subject.c_str(), 0) == 0) {
+				return execute(*node.children[i]);
+			}
+		}
+	}
+
+	return 0;
+}
+
+int StartupScript::execute_shell(const Node &node)
+{
+	const std::string &script = node.words[0];
+	const uint64_t start = now_us();
+
+	// runs synchronously, also if started with '&'
+	const int ret = run_shell(script);
+	add_timeline({script.substr(0, script.find('\n'))}, start, ret, false);
+
+	return ret;
+}
+
+int StartupScript::run_argv(std::vector<std::string> &argv, bool background)
+{
+	const std::string &command = argv[0];
+
+	if (command == "set") {
+		// NuttX style 'set <name> <value>', as mapped by px4-alias.sh
+		if (argv.size() >= 2) {
+			_variables[argv[1]] = (argv.size() >= 3) ? argv[2] : "";
+		}
+
+		return 0;
+
+	} else if (command == "unset") {
+		for (size_t i = 1; i < argv.size(); i++) {
+			_variables.erase(argv[i]);
+		}
+
+		return 0;
+
+	} else if (command == "echo") {
+		std::string line;
+
+		for (size_t i = 1; i < argv.size(); i++) {
+			line += (i > 1 ? " " : "") + argv[i];
+		}
+
+		printf("%s\n", line.c_str());
+		return 0;
+
+	} else if (command == "exit") {
+		_exit = true;
+		_status = (argv.size() >= 2) ? atoi(argv[1].c_str()) : _status;
+		return _status;
+
+	} else if (command == "sh" || command == ".") {
+		if (argv.size() < 2) {
+			PX4_ERR("%s: missing script", command.c_str());
+			return 1;
+		}
+
+		return source(argv[1]);
+
+	} else if (command == "wait") {
+		wait_background();
+		return 0;
+
+	} else if (command == "[" || command == "test") {
+		std::vector<std::string> args(argv.begin() + 1, argv.end());
+
+		if (command == "[") {
+			if (args.empty() || args.back() != "]") {
+				PX4_ERR("[: missing ]");
+				return 2;
+			}
+
+			args.pop_back();
+		}
+
+		return TestExpression(args).evaluate();
+
+	} else if (command == "true" || command == ":") {
+		return 0;
+
+	} else if (command == "false") {
+		return 1;
+	}
+
+	const auto app = _apps.find(command);
+	const uint64_t start = now_us();
+	int ret;
+
+	if (app == _apps.end()) {
+		ret = run_external(argv);
+
+	} else if (background) {
+		BackgroundCommand *bg = new BackgroundCommand{this, argv, app->second, start, {}};
+
+		if (pthread_create(&bg->thread, nullptr, background_trampoline, bg) == 0) {
+			_background.push_back(bg);
+			return 0;
+		}
+
+		// cannot run it in parallel, run it here instead
+		delete bg;
+		ret = run_app(app->second, argv);
+
+	} else {
+		ret = run_app(app->second, argv);
+	}
+
+	add_timeline(argv, start, ret, false);
+	return ret;
+}
+
+int StartupScript::run_app(px4_main_t main, std::vector<std::string> &argv)
+{
+	// argv[argc] needs to be a nullptr
+	std::vector<char *> args;
+
+	for (std::string &arg : argv) {
+		args.push_back(&arg[0]);
+	}
+
+	args.push_back(nullptr);
+
+	return main(argv.size(), args.data());
+}
+
+int StartupScript::run_external(const std::vector<std::string> &argv)
+{
+	std::string command = shell_exports();
+
+	for (const std::string &arg : argv) {
+		command += quote(arg) + " ";
+	}
+
+	const int ret = system(command.c_str());
+
+	if (ret == -1 || !WIFEXITED(ret)) {
+		return 1;
+	}
+
+	return WEXITSTATUS(ret);
+}
+
+int StartupScript::run_shell(const std::string &script)
+{
+	const int ret = system(shell_command(script).c_str());
+
+	if (ret == -1 || !WIFEXITED(ret)) {
+		return 1;
+	}
+
+	return WEXITSTATUS(ret);
+}
+
+int StartupScript::source(const std::string &path)
+{
+	// the commands are already resolved in-process
+	if (path == "px4-alias.sh") {
+		return 0;
+	}
+
+	if (_depth >= MAX_DEPTH) {
+		PX4_ERR("%s: scripts nested too deep", path.c_str());
+		return 1;
+	}
+
+	// like the sh() function in px4-alias.sh, script paths are relative to the rootfs
+	size_t first = path.find_first_not_of('/');
+	const std::string file = (first == std::string::npos) ? path : path.substr(first);
+
+	if (access(file.c_str(), R_OK) != 0) {
+		PX4_ERR("cannot open %s", file.c_str());
+		return 1;
+	}
+
+	std::unique_ptr<Node> script = parse(file);
+
+	if (!script) {
+		// run by a child shell, variables it sets do not reach this script
+		PX4_WARN("%s: not supported in-process, running it with /bin/sh", file.c_str());
+
+		const uint64_t start = now_us();
+		const int ret = run_shell(". " + quote("./" + file));
+		add_timeline({"sh", file}, start, ret, false);
+
+		return ret;
+	}
+
+	_depth++;
+	const int ret = execute(*script);
+	_depth--;
+
+	return ret;
+}
+
+void *StartupScript::background_trampoline(void *arg)
+{
+	BackgroundCommand *bg = (BackgroundCommand *)arg;
+
+	const int ret = bg->script->run_app(bg->main, bg->argv);
+	bg->script->add_timeline(bg->argv, bg->start_us, ret, true);
+
+	return nullptr;
+}
+
+void StartupScript::wait_background()
+{
+	for (BackgroundCommand *bg : _background) {
+		pthread_join(bg->thread, nullptr);
+		delete bg;
+	}
+
+	_background.clear();
+}
+
+/* timeline */
+
+uint64_t StartupScript::now_us() const
+{
+	// wall clock, hrt does not advance in lockstep before the simulator connects
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+}
+
+void StartupScript::add_timeline(const std::vector<std::string> &argv, uint64_t start_us, int ret, bool background)
+{
+	std::string command;
+
+	for (const std::string &arg : argv) {
+		command += (command.empty() ? "" : " ") + arg;
+	}
+
+	const uint64_t duration = now_us() - start_us;
+
+	pthread_mutex_lock(&_timeline_mutex);
+	_timeline.push_back({command, start_us, duration, ret, background});
+	pthread_mutex_unlock(&_timeline_mutex);
+}
+
+void StartupScript::print_timeline_summary() const
+{
+	if (_timeline.empty()) {
+		return;
+	}
+
+	uint64_t end = 0;
+	uint64_t busy = 0;
+	unsigned parallel = 0;
+
+	for (const TimelineEntry &entry : _timeline) {
+		end = std::max(end, entry.start_us + entry.duration_us);
+		busy += entry.duration_us;
+		parallel += entry.background ? 1 : 0;
+	}
+
+	PX4_INFO("Startup: %zu commands (%u in parallel) in %.1f ms, %.1f ms spent in commands",
+		 _timeline.size(), parallel, end / 1e3, busy / 1e3);
+
+	std::vector<const TimelineEntry *> slowest;
+
+	for (const TimelineEntry &entry : _timeline) {
+		slowest.push_back(&entry);
+	}
+
+	std::sort(slowest.begin(), slowest.end(), [](const TimelineEntry * a, const TimelineEntry * b) {
+		return a->duration_us > b->duration_us;
+	});
+
+	slowest.resize(std::min(slowest.size(), SUMMARY_COMMANDS));
+
+	for (const TimelineEntry *entry : slowest) {
+		PX4_INFO_RAW("  %8.1f ms  %s%s\n", entry->duration_us / 1e3, entry->command.c_str(), entry->background ? " &" : "");
+	}
+}
+
+int StartupScript::write_timeline(const std::string &path) const
+{
+	FILE *file = fopen(path.c_str(), "w");
+
+	if (file == nullptr) {
+		return -errno;
+	}
+
+	std::vector<TimelineEntry> timeline = _timeline;
+
+	std::sort(timeline.begin(), timeline.end(), [](const TimelineEntry & a, const TimelineEntry & b) {
+		return a.start_us < b.start_us;
+	});
+
+	fprintf(file, "# start [ms]  duration [ms]  return  command\n");
+
+	for (const TimelineEntry &entry : timeline) {
+		fprintf(file, "%12.3f  %13.3f  %6i  %s%s\n", entry.start_us / 1e3, entry.duration_us / 1e3, entry.ret,
+			entry.command.c_str(), entry.background ? " &" : "");
+	}
+
+	fclose(file);
+	return 0;
+}
+
+} // namespace px4_daemon
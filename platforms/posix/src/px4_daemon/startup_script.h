@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file startup_script.h
+ *
+ * In-process executor for the POSIX startup scripts (rcS).
+ *
+ * Running the startup script through /bin/sh means every PX4 command is a
+ * separate px4-<cmd> client process talking to the server over a socket.
+ * This executor instead interprets the subset of sh used by the startup
+ * scripts directly inside the px4 process and calls the module mains.
+ *
+ * Supported are simple commands, variables (including 'set'/'unset'),
+ * quoting, $VAR/${VAR}, $((arithmetic)), $(command substitution), if/elif/else,
+ * for and case, '!', '&&', '||', 'test'/'[', 'sh'/'.' (sourced, like
+ * px4-alias.sh does), 'exit' and 'echo'. PX4 commands followed by '&' run
+ * in parallel until the next 'wait'. Anything else that is not a PX4 command
+ * is handed to /bin/sh.
+ *
+ * Commands with redirections or here-documents are run as a whole by /bin/sh,
+ * with the script variables exported and the px4-alias.sh aliases loaded. So
+ * is a sourced script that uses unsupported syntax (e.g. pipes outside of
+ * command substitution, or while loops). Both run synchronously, even if
+ * followed by '&', and variables they set are not seen by the calling script.
+ * A top-level script with unsupported syntax fails to load and the caller
+ * runs it with /bin/sh instead.
+ *
+ * Every command is timed and the resulting boot timeline can be printed.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include <platforms/posix/apps.h>
+
+namespace px4_daemon
+{
+
+class StartupScript
+{
+public:
+	StartupScript(const std::string &path, int instance);
+	~StartupScript();
+
+	/**
+	 * Read and parse the script.
+	 *
+	 * @return true if the script only uses supported syntax
+	 */
+	bool load();
+
+	/**
+	 * Run the loaded script. Returns once all commands, including the ones
+	 * started in the background, have finished.
+	 *
+	 * @return exit status of the script
+	 */
+	int run();
+
+	/**
+	 * Print a summary of the boot timeline (total time and slowest commands).
+	 */
+	void print_timeline_summary() const;
+
+	/**
+	 * Write the time of every command to a file.
+	 *
+	 * @return 0 on success
+	 */
+	int write_timeline(const std::string &path) const;
+
+private:
+	struct Node {
+		enum Type {
+			COMMAND,	///< words: raw words
+			SEQUENCE,	///< children run in order
+			AND,		///< children[1] runs if children[0] succeeded
+			OR,		///< children[1] runs if children[0] failed
+			NOT,		///< negates children[0]
+			IF,		///< children: condition, body, [condition, body]..., [else body]
+			FOR,		///< words: name, raw items, children[0]: body
+			CASE,		///< words: raw subject, patterns[i] selects children[i]
+			SHELL		///< words[0]: command with redirections and here-documents, run by /bin/sh
+		};
+
+		Type type;
+		int line{0};
+		bool background{false};
+		std::vector<std::string> words;
+		std::vector<std::vector<std::string>> patterns;
+		std::vector<std::unique_ptr<Node>> children;
+
+		Node(Type t, int l) : type(t), line(l) {}
+	};
+
+	struct Token {
+		enum Type { WORD, REDIRECT, NEWLINE, SEMI, DSEMI, AMP, AND_IF, OR_IF, PIPE, LPAREN, RPAREN, END };
+
+		Type type;
+		std::string text;
+		int line;
+	};
+
+	struct TimelineEntry {
+		std::string command;
+		uint64_t start_us;
+		uint64_t duration_us;
+		int ret;
+		bool background;
+	};
+
+	struct BackgroundCommand {
+		StartupScript *script;
+		std::vector<std::string> argv;
+		px4_main_t main;
+		uint64_t start_us;
+		pthread_t thread;
+	};
+
+	/* parsing */
+	bool tokenize(const std::string &text, const std::string &file, std::vector<Token> &tokens);
+	std::unique_ptr<Node> parse(const std::string &path);
+	std::unique_ptr<Node> parse_list(const std::vector<const char *> &terminators);
+	std::unique_ptr<Node> parse_and_or();
+	std::unique_ptr<Node> parse_pipeline();
+	std::unique_ptr<Node> parse_command();
+	std::unique_ptr<Node> parse_if();
+	std::unique_ptr<Node> parse_for();
+	std::unique_ptr<Node> parse_case();
+	bool at_reserved(const char *word) const;
+	bool expect_reserved(const char *word);
+	void skip_newlines();
+	bool parse_error(const char *what);
+
+	/* expansion */
+	struct Field {
+		std::string text;
+		std::string pattern; ///< text with quoted glob characters escaped
+		bool quoted{false};
+		bool glob{false};
+	};
+
+	bool expand_word(const std::string &raw, std::vector<Field> &fields, bool split);
+	bool expand_dollar(const std::string &raw, size_t &pos, std::string &value);
+	bool expand_words(const std::vector<std::string> &raw, std::vector<std::string> &argv);
+	std::string expand_single(const std::string &raw);
+	bool command_substitution(const std::string &command, std::string &output);
+	std::string lookup(const std::string &name) const;
+
+	/* execution */
+	int execute(const Node &node);
+	int execute_command(const Node &node);
+	int execute_if(const Node &node);
+	int execute_for(const Node &node);
+	int execute_case(const Node &node);
+	int execute_shell(const Node &node);
+	int run_argv(std::vector<std::string> &argv, bool background);
+	int run_app(px4_main_t main, std::vector<std::string> &argv);
+	int run_external(const std::vector<std::string> &argv);
+	int run_shell(const std::string &script);
+	int source(const std::string &path);
+	void wait_background();
+	static void *background_trampoline(void *arg);
+
+	uint64_t now_us() const;
+	void add_timeline(const std::vector<std::string> &argv, uint64_t start_us, int ret, bool background);
+	std::string shell_exports() const;
+	std::string shell_command(const std::string &script) const;
+
+	std::string _path;
+	int _instance;
+	std::string _alias_script; ///< px4-alias.sh, if found in the PATH
+	std::unique_ptr<Node> _root;
+
+	std::vector<Token> _tokens;
+	size_t _token{0};
+	std::string _parse_file;
+
+	std::map<std::string, std::string> _variables;
+	int _status{0};
+	bool _exit{false};
+	int _depth{0};
+
+	apps_map_type _apps;
+	std::vector<BackgroundCommand *> _background;
+
+	std::chrono::steady_clock::time_point _start;
+	std::vector<TimelineEntry> _timeline;
+	pthread_mutex_t _timeline_mutex;
+};
+
+} // namespace px4_daemon
@@ -52,6 +52,7 @@
 #include <lib/mixer/mixer_load.h>
 #include <parameters/param.h>
 #include <pwm_limit/pwm_limit.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 
 #include "common.h"
@@ -214,7 +215,7 @@ void task_main(int argc, char *argv[])
 {
 	_is_running = true;
 
-	_perf_control_latency = perf_alloc(PC_ELAPSED, "linux_pwm_out control latency");
+	_perf_control_latency = perf_alloc(PC_HISTOGRAM, "linux_pwm_out control latency");
 
 	// Set up mixer
 	if (initialize_mixer(_mixer_filename) < 0) {
@@ -406,6 +407,7 @@ void task_main(int argc, char *argv[])
 
 				if (required && (timestamp_sample > 0)) {
 					perf_set_elapsed(_perf_control_latency, _outputs.timestamp - timestamp_sample);
+					latency_trace_record(LATENCY_TRACE_ACTUATOR_OUTPUTS, timestamp_sample);
 					break;
 				}
 			}
@@ -40,7 +40,7 @@
 
 PWMSim::PWMSim() :
 	CDev(PWM_OUTPUT0_DEVICE_PATH),
-	_perf_control_latency(perf_alloc(PC_ELAPSED, "pwm_out_sim control latency"))
+	_perf_control_latency(perf_alloc(PC_HISTOGRAM, "pwm_out_sim control latency"))
 {
 	for (unsigned i = 0; i < MAX_ACTUATORS; i++) {
 		_pwm_min[i] = PWM_SIM_PWM_MIN_MAGIC;
@@ -304,6 +304,7 @@ PWMSim::run()
 
 				if (required && (timestamp_sample > 0)) {
 					perf_set_elapsed(_perf_control_latency, _actuator_outputs.timestamp - timestamp_sample);
+					latency_trace_record(LATENCY_TRACE_ACTUATOR_OUTPUTS, timestamp_sample);
 					break;
 				}
 			}
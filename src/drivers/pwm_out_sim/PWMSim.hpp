@@ -40,6 +40,7 @@
 #include <drivers/drv_mixer.h>
 #include <drivers/drv_pwm_output.h>
 #include <lib/mixer/mixer.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <px4_common.h>
 #include <px4_config.h>
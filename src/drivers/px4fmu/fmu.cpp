@@ -54,6 +54,7 @@
 #include <lib/cdev/CDev.hpp>
 #include <lib/mixer/mixer.h>
 #include <parameters/param.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <pwm_limit/pwm_limit.h>
 #include <uORB/topics/actuator_armed.h>
@@ -323,7 +324,7 @@ PX4FMU::PX4FMU(bool run_as_task) :
 	_thr_mdl_fac(0.0f),
 	_airmode(Mixer::Airmode::disabled),
 	_motor_ordering(MotorOrdering::PX4),
-	_perf_control_latency(perf_alloc(PC_ELAPSED, "fmu control latency"))
+	_perf_control_latency(perf_alloc(PC_HISTOGRAM, "fmu control latency"))
 {
 	for (unsigned i = 0; i < _max_actuators; i++) {
 		_min_pwm[i] = PWM_DEFAULT_MIN;
@@ -1251,6 +1252,7 @@ PX4FMU::cycle()
 
 					if (required && (timestamp_sample > 0)) {
 						perf_set_elapsed(_perf_control_latency, actuator_outputs.timestamp - timestamp_sample);
+						latency_trace_record(LATENCY_TRACE_ACTUATOR_OUTPUTS, timestamp_sample);
 						break;
 					}
 				}
@@ -69,6 +69,7 @@
 #include <rc/dsm.h>
 
 #include <lib/mixer/mixer.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <systemlib/err.h>
 #include <parameters/param.h>
@@ -104,6 +105,7 @@
 #define UPDATE_INTERVAL_MIN		2			// 2 ms	-> 500 Hz
 #define ORB_CHECK_INTERVAL		200000		// 200 ms -> 5 Hz
 #define IO_POLL_INTERVAL		20000		// 20 ms -> 50 Hz
+#define RC_PUBLISH_INTERVAL		100000		// republish unchanged R/C input at 10 Hz
 
 /**
  * The PX4IO class.
@@ -235,6 +237,8 @@ private:
 	bool			_rc_handling_disabled;	///< If set, IO does not evaluate, but only forward the RC values
 	unsigned		_rc_chan_count;		///< Internal copy of the last seen number of RC channels
 	uint64_t		_rc_last_valid;		///< last valid timestamp
+	input_rc_s		_rc_published;		///< last published R/C input
+	bool			_cycle_page;		///< IO serves PX4IO_PAGE_CYCLE
 
 	volatile int		_task;			///< worker task id
 	volatile bool		_task_should_exit;	///< worker terminate flag
@@ -244,6 +248,13 @@ private:
 	perf_counter_t		_perf_update;		///< local performance counter for status updates
 	perf_counter_t		_perf_write;		///< local performance counter for PWM control writes
 	perf_counter_t		_perf_sample_latency;	///< total system latency (based on passed-through timestamp)
+	perf_counter_t		_perf_transactions;	///< register transactions with IO
+	perf_counter_t		_perf_bytes;		///< bytes moved over the link, both directions
+	uint64_t		_bytes;			///< running total behind _perf_bytes
+
+	hrt_abstime		_link_stats_time;	///< last time link rates were printed
+	uint64_t		_link_stats_transactions;	///< transactions at _link_stats_time
+	uint64_t		_link_stats_bytes;	///< bytes at _link_stats_time
 
 	/* cached IO state */
 	uint16_t		_status;		///< Various IO status flags
@@ -323,6 +334,14 @@ private:
 	 */
 	int			io_get_status();
 
+	/**
+	 * Fetch and publish everything IO reports per cycle.
+	 *
+	 * Uses a single PX4IO_PAGE_CYCLE transaction if IO supports it,
+	 * otherwise reads the status, R/C and servo pages one by one.
+	 */
+	int			io_get_cycle();
+
 	/**
 	 * Disable RC input handling
 	 */
@@ -332,19 +351,35 @@ private:
 	 * Fetch RC inputs from IO.
 	 *
 	 * @param input_rc	Input structure to populate.
+	 * @param prefetched	Raw R/C page registers up to PX4IO_P_CYCLE_RAW_RC_CHANNELS
+	 *			channels if already read, nullptr to read them from IO.
 	 * @return		OK if data was returned.
 	 */
-	int			io_get_raw_rc_input(input_rc_s &input_rc);
+	int			io_get_raw_rc_input(input_rc_s &input_rc, const uint16_t *prefetched = nullptr);
 
 	/**
 	 * Fetch and publish raw RC input data.
+	 *
+	 * Unchanged input is only republished every RC_PUBLISH_INTERVAL.
+	 *
+	 * @param prefetched	See io_get_raw_rc_input().
 	 */
-	int			io_publish_raw_rc();
+	int			io_publish_raw_rc(const uint16_t *prefetched = nullptr);
 
 	/**
 	 * Fetch and publish the PWM servo outputs.
+	 *
+	 * @param servos	Servo page registers if already read, nullptr to read them from IO.
+	 * @param mixer		Mixer status register, only used together with servos.
+	 */
+	int			io_publish_pwm_outputs(const uint16_t *servos = nullptr, uint16_t mixer = 0);
+
+	/**
+	 * Account a register transaction in the link perf counters.
+	 *
+	 * @param bytes		Bytes moved over the link in both directions.
 	 */
-	int			io_publish_pwm_outputs();
+	void			io_count_transaction(unsigned bytes);
 
 	/**
 	 * write register(s)
@@ -463,12 +498,20 @@ PX4IO::PX4IO(device::Device *interface) :
 	_rc_handling_disabled(false),
 	_rc_chan_count(0),
 	_rc_last_valid(0),
+	_rc_published{},
+	_cycle_page(false),
 	_task(-1),
 	_task_should_exit(false),
 	_mavlink_log_pub(nullptr),
 	_perf_update(perf_alloc(PC_ELAPSED, "io update")),
 	_perf_write(perf_alloc(PC_ELAPSED, "io write")),
-	_perf_sample_latency(perf_alloc(PC_ELAPSED, "io control latency")),
+	_perf_sample_latency(perf_alloc(PC_HISTOGRAM, "io control latency")),
+	_perf_transactions(perf_alloc(PC_COUNT, "io transactions")),
+	_perf_bytes(perf_alloc(PC_COUNT, "io bytes")),
+	_bytes(0),
+	_link_stats_time(0),
+	_link_stats_transactions(0),
+	_link_stats_bytes(0),
 	_status(0),
 	_alarms(0),
 	_last_written_arming_s(0),
@@ -529,6 +572,8 @@ PX4IO::~PX4IO()
 	perf_free(_perf_update);
 	perf_free(_perf_write);
 	perf_free(_perf_sample_latency);
+	perf_free(_perf_transactions);
+	perf_free(_perf_bytes);
 
 	g_dev = nullptr;
 }
@@ -654,6 +699,13 @@ PX4IO::init()
 		_max_rc_input = input_rc_s::RC_INPUT_MAX_CHANNELS;
 	}
 
+	/* IO firmware predating the cycle page rejects the read */
+	uint16_t cycle[PX4IO_P_CYCLE_COUNT];
+	_cycle_page = (_max_actuators <= PX4IO_P_CYCLE_SERVO_COUNT) &&
+		      (PX4IO_P_CYCLE_COUNT <= _max_transfer / sizeof(cycle[0])) &&
+		      (io_reg_get(PX4IO_PAGE_CYCLE, 0, cycle, PX4IO_P_CYCLE_COUNT) == OK);
+	_link_stats_time = hrt_absolute_time();
+
 	param_get(param_find("RC_RSSI_PWM_CHAN"), &_rssi_pwm_chan);
 	param_get(param_find("RC_RSSI_PWM_MAX"), &_rssi_pwm_max);
 	param_get(param_find("RC_RSSI_PWM_MIN"), &_rssi_pwm_min);
@@ -951,14 +1003,8 @@ PX4IO::task_main()
 			/* run at 50-250Hz */
 			poll_last = now;
 
-			/* pull status and alarms from IO */
-			io_get_status();
-
-			/* get raw R/C input from IO */
-			io_publish_raw_rc();
-
-			/* fetch PWM outputs from IO */
-			io_publish_pwm_outputs();
+			/* pull status, alarms, R/C input and PWM outputs from IO */
+			io_get_cycle();
 
 			/* check updates on uORB topics and handle it */
 			bool updated = false;
@@ -1343,7 +1389,13 @@ PX4IO::io_set_control_state(unsigned group)
 
 	if (!_test_fmu_fail) {
 		/* copy values to registers in IO */
-		return io_reg_set(PX4IO_PAGE_CONTROLS, group * PX4IO_PROTOCOL_MAX_CONTROL_COUNT, regs, _max_controls);
+		int ret = io_reg_set(PX4IO_PAGE_CONTROLS, group * PX4IO_PROTOCOL_MAX_CONTROL_COUNT, regs, _max_controls);
+
+		if (ret == OK && group == 0 && changed) {
+			latency_trace_record(LATENCY_TRACE_ACTUATOR_OUTPUTS, controls.timestamp_sample);
+		}
+
+		return ret;
 
 	} else {
 		return OK;
@@ -1743,7 +1795,41 @@ PX4IO::io_get_status()
 }
 
 int
-PX4IO::io_get_raw_rc_input(input_rc_s &input_rc)
+PX4IO::io_get_cycle()
+{
+	if (!_cycle_page) {
+		int ret = io_get_status();
+
+		if (ret != OK) {
+			return ret;
+		}
+
+		/* get raw R/C input from IO */
+		io_publish_raw_rc();
+
+		/* fetch PWM outputs from IO */
+		return io_publish_pwm_outputs();
+	}
+
+	uint16_t regs[PX4IO_P_CYCLE_COUNT];
+	int ret = io_reg_get(PX4IO_PAGE_CYCLE, 0, regs, PX4IO_P_CYCLE_COUNT);
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	io_handle_status(regs[PX4IO_P_CYCLE_FLAGS]);
+	io_handle_alarms(regs[PX4IO_P_CYCLE_ALARMS]);
+	io_handle_vservo(regs[PX4IO_P_CYCLE_VSERVO], regs[PX4IO_P_CYCLE_VRSSI]);
+
+	/* the status flags have to be handled first, R/C publication depends on them */
+	io_publish_raw_rc(&regs[PX4IO_P_CYCLE_RAW_RC]);
+
+	return io_publish_pwm_outputs(&regs[PX4IO_P_CYCLE_SERVOS], regs[PX4IO_P_CYCLE_MIXER]);
+}
+
+int
+PX4IO::io_get_raw_rc_input(input_rc_s &input_rc, const uint16_t *prefetched)
 {
 	uint32_t channel_count;
 	int	ret;
@@ -1759,10 +1845,18 @@ PX4IO::io_get_raw_rc_input(input_rc_s &input_rc)
 	 *
 	 * This should be the common case (9 channel R/C control being a reasonable upper bound).
 	 */
-	ret = io_reg_get(PX4IO_PAGE_RAW_RC_INPUT, PX4IO_P_RAW_RC_COUNT, &regs[0], prolog + 9);
+	static_assert(PX4IO_P_CYCLE_RAW_RC_CHANNELS == 9, "cycle page must carry the common case channels");
 
-	if (ret != OK) {
-		return ret;
+	if (prefetched != nullptr) {
+		memcpy(&regs[0], prefetched, (prolog + 9) * sizeof(regs[0]));
+		ret = OK;
+
+	} else {
+		ret = io_reg_get(PX4IO_PAGE_RAW_RC_INPUT, PX4IO_P_RAW_RC_COUNT, &regs[0], prolog + 9);
+
+		if (ret != OK) {
+			return ret;
+		}
 	}
 
 	/*
@@ -1846,7 +1940,7 @@ PX4IO::io_get_raw_rc_input(input_rc_s &input_rc)
 }
 
 int
-PX4IO::io_publish_raw_rc()
+PX4IO::io_publish_raw_rc(const uint16_t *prefetched)
 {
 
 	/* fetch values from IO */
@@ -1855,7 +1949,7 @@ PX4IO::io_publish_raw_rc()
 	/* set the RC status flag ORDER MATTERS! */
 	rc_val.rc_lost = !(_status & PX4IO_P_STATUS_FLAGS_RC_OK);
 
-	int ret = io_get_raw_rc_input(rc_val);
+	int ret = io_get_raw_rc_input(rc_val, prefetched);
 
 	if (ret != OK) {
 		return ret;
@@ -1884,20 +1978,40 @@ PX4IO::io_publish_raw_rc()
 		}
 	}
 
+	/* IO does not count frames, so compare the content to detect new input */
+	if (_to_input_rc != nullptr &&
+	    rc_val.timestamp < _rc_published.timestamp + RC_PUBLISH_INTERVAL &&
+	    rc_val.input_source == _rc_published.input_source &&
+	    rc_val.channel_count == _rc_published.channel_count &&
+	    rc_val.rc_lost == _rc_published.rc_lost &&
+	    rc_val.rc_failsafe == _rc_published.rc_failsafe &&
+	    rc_val.rssi == _rc_published.rssi &&
+	    memcmp(rc_val.values, _rc_published.values, rc_val.channel_count * sizeof(rc_val.values[0])) == 0) {
+		return OK;
+	}
+
 	int instance = 0;
 	orb_publish_auto(ORB_ID(input_rc), &_to_input_rc, &rc_val, &instance, ORB_PRIO_HIGH);
+	_rc_published = rc_val;
 	return OK;
 }
 
 int
-PX4IO::io_publish_pwm_outputs()
+PX4IO::io_publish_pwm_outputs(const uint16_t *servos, uint16_t mixer)
 {
 	/* get servo values from IO */
 	uint16_t ctl[_max_actuators];
-	int ret = io_reg_get(PX4IO_PAGE_SERVOS, 0, ctl, _max_actuators);
+	int ret = OK;
 
-	if (ret != OK) {
-		return ret;
+	if (servos != nullptr) {
+		memcpy(ctl, servos, sizeof(ctl));
+
+	} else {
+		ret = io_reg_get(PX4IO_PAGE_SERVOS, 0, ctl, _max_actuators);
+
+		if (ret != OK) {
+			return ret;
+		}
 	}
 
 	actuator_outputs_s outputs = {};
@@ -1914,10 +2028,16 @@ PX4IO::io_publish_pwm_outputs()
 
 	/* get mixer status flags from IO */
 	MultirotorMixer::saturation_status saturation_status;
-	ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_MIXER, &saturation_status.value, 1);
 
-	if (ret != OK) {
-		return ret;
+	if (servos != nullptr) {
+		saturation_status.value = mixer;
+
+	} else {
+		ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_MIXER, &saturation_status.value, 1);
+
+		if (ret != OK) {
+			return ret;
+		}
 	}
 
 	/* publish mixer status */
@@ -1932,6 +2052,14 @@ PX4IO::io_publish_pwm_outputs()
 	return OK;
 }
 
+void
+PX4IO::io_count_transaction(unsigned bytes)
+{
+	perf_count(_perf_transactions);
+	_bytes += bytes;
+	perf_set_count(_perf_bytes, _bytes);
+}
+
 int
 PX4IO::io_reg_set(uint8_t page, uint8_t offset, const uint16_t *values, unsigned num_values)
 {
@@ -1943,6 +2071,9 @@ PX4IO::io_reg_set(uint8_t page, uint8_t offset, const uint16_t *values, unsigned
 
 	int ret =  _interface->write((page << 8) | offset, (void *)values, num_values);
 
+	/* request carries the registers, the reply only the header */
+	io_count_transaction(4 + 2 * num_values + 4);
+
 	if (ret != (int)num_values) {
 		PX4_DEBUG("io_reg_set(%hhu,%hhu,%u): error %d", page, offset, num_values, ret);
 		return -1;
@@ -1968,6 +2099,9 @@ PX4IO::io_reg_get(uint8_t page, uint8_t offset, uint16_t *values, unsigned num_v
 
 	int ret = _interface->read((page << 8) | offset, reinterpret_cast<void *>(values), num_values);
 
+	/* request and reply are both sized for the requested registers */
+	io_count_transaction(2 * (4 + 2 * num_values));
+
 	if (ret != (int)num_values) {
 		PX4_DEBUG("io_reg_get(%hhu,%hhu,%u): data error %d", page, offset, num_values, ret);
 		return -1;
@@ -2169,6 +2303,22 @@ PX4IO::mixer_send(const char *buf, unsigned buflen, unsigned retries)
 void
 PX4IO::print_status(bool extended_status)
 {
+	/* link load since the last status print, before the reads below add to it */
+	const hrt_abstime now = hrt_absolute_time();
+	const uint64_t transactions = perf_event_count(_perf_transactions);
+
+	if (_link_stats_time != 0 && now > _link_stats_time) {
+		const float dt = (now - _link_stats_time) * 1e-6f;
+		printf("link %.1f transactions/s %.1f bytes/s%s\n",
+		       (double)((transactions - _link_stats_transactions) / dt),
+		       (double)((_bytes - _link_stats_bytes) / dt),
+		       _cycle_page ? " (cycle page)" : "");
+	}
+
+	_link_stats_time = now;
+	_link_stats_transactions = transactions;
+	_link_stats_bytes = _bytes;
+
 	/* basic configuration */
 	printf("protocol %u hardware %u bootloader %u buffer %uB crc 0x%04x%04x\n",
 	       io_reg_get(PX4IO_PAGE_CONFIG, PX4IO_P_CONFIG_PROTOCOL_VERSION),
@@ -449,12 +449,44 @@ RCInput::cycle()
 						fill_rc_in(_raw_rc_count, _raw_rc_values, cycle_timestamp,
 							   false, false, frame_drops, dsm_rssi);
 						_rc_scan_locked = true;
+
+					} else if (!_rc_scan_locked) {
+						// ST24 and SUMD use the same serial configuration as DSM, so detect them
+						// in parallel on the same bytes and hand over once one of them locks
+						uint8_t st24_rssi = RC_INPUT_RSSI_MAX;
+						uint8_t sumd_rssi = RC_INPUT_RSSI_MAX;
+						uint8_t lost_count, rx_count;
+						bool sumd_failsafe;
+
+						if (st24_parse(&_rcs_buf[0], newBytes, &st24_rssi, &lost_count,
+							       &_raw_rc_count, _raw_rc_values, input_rc_s::RC_INPUT_MAX_CHANNELS)) {
+							// stay in the current scan window, the port is already configured
+							_rc_scan_state = RC_SCAN_ST24;
+
+							if (lost_count == 0) {
+								rc_updated = true;
+								_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_ST24;
+								fill_rc_in(_raw_rc_count, _raw_rc_values, cycle_timestamp,
+									   false, false, frame_drops, st24_rssi);
+								_rc_scan_locked = true;
+							}
+
+						} else if (sumd_parse(&_rcs_buf[0], newBytes, &sumd_rssi, &rx_count,
+								      &_raw_rc_count, _raw_rc_values, input_rc_s::RC_INPUT_MAX_CHANNELS, &sumd_failsafe)) {
+							// stay in the current scan window, the port is already configured
+							_rc_scan_state = RC_SCAN_SUMD;
+							rc_updated = true;
+							_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_SUMD;
+							fill_rc_in(_raw_rc_count, _raw_rc_values, cycle_timestamp,
+								   false, sumd_failsafe, frame_drops, sumd_rssi);
+							_rc_scan_locked = true;
+						}
 					}
 				}
 
 			} else {
-				// Scan the next protocol
-				set_rc_scan_state(RC_SCAN_ST24);
+				// Scan the next protocol, ST24 and SUMD have been covered by the DSM scan
+				set_rc_scan_state(RC_SCAN_PPM);
 			}
 
 			break;
@@ -471,16 +503,12 @@ RCInput::cycle()
 
 				if (newBytes > 0) {
 					// parse new data
-					uint8_t st24_rssi, lost_count;
+					uint8_t st24_rssi = RC_INPUT_RSSI_MAX;
+					uint8_t lost_count;
 
-					rc_updated = false;
-
-					for (unsigned i = 0; i < (unsigned)newBytes; i++) {
-						/* set updated flag if one complete packet was parsed */
-						st24_rssi = RC_INPUT_RSSI_MAX;
-						rc_updated = (OK == st24_decode(_rcs_buf[i], &st24_rssi, &lost_count,
-										&_raw_rc_count, _raw_rc_values, input_rc_s::RC_INPUT_MAX_CHANNELS));
-					}
+					/* set updated flag if one complete packet was parsed */
+					rc_updated = st24_parse(&_rcs_buf[0], newBytes, &st24_rssi, &lost_count,
+								&_raw_rc_count, _raw_rc_values, input_rc_s::RC_INPUT_MAX_CHANNELS);
 
 					// The st24 will keep outputting RC channels and RSSI even if RC has been lost.
 					// The only way to detect RC loss is therefore to look at the lost_count.
@@ -502,7 +530,7 @@ RCInput::cycle()
 
 			} else {
 				// Scan the next protocol
-				set_rc_scan_state(RC_SCAN_SUMD);
+				set_rc_scan_state(RC_SCAN_PPM);
 			}
 
 			break;
@@ -519,17 +547,13 @@ RCInput::cycle()
 
 				if (newBytes > 0) {
 					// parse new data
-					uint8_t sumd_rssi, rx_count;
+					uint8_t sumd_rssi = RC_INPUT_RSSI_MAX;
+					uint8_t rx_count;
 					bool sumd_failsafe;
 
-					rc_updated = false;
-
-					for (unsigned i = 0; i < (unsigned)newBytes; i++) {
-						/* set updated flag if one complete packet was parsed */
-						sumd_rssi = RC_INPUT_RSSI_MAX;
-						rc_updated = (OK == sumd_decode(_rcs_buf[i], &sumd_rssi, &rx_count,
-										&_raw_rc_count, _raw_rc_values, input_rc_s::RC_INPUT_MAX_CHANNELS, &sumd_failsafe));
-					}
+					/* set updated flag if one complete packet was parsed */
+					rc_updated = sumd_parse(&_rcs_buf[0], newBytes, &sumd_rssi, &rx_count,
+								&_raw_rc_count, _raw_rc_values, input_rc_s::RC_INPUT_MAX_CHANNELS, &sumd_failsafe);
 
 					if (rc_updated) {
 						// we have a new SUMD frame. Publish it.
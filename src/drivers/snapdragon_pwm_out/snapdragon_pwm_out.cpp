@@ -52,6 +52,7 @@
 #include <mixer/mixer_load.h>
 #include <mixer/mixer_multirotor_normalized.generated.h>
 #include <parameters/param.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <pwm_limit/pwm_limit.h>
 #include <dev_fs_lib_pwm.h>
@@ -366,7 +367,7 @@ void task_main(int argc, char *argv[])
 	// set max min pwm
 	pwm_limit_init(&_pwm_limit);
 
-	_perf_control_latency = perf_alloc(PC_ELAPSED, "snapdragon_pwm_out control latency");
+	_perf_control_latency = perf_alloc(PC_HISTOGRAM, "snapdragon_pwm_out control latency");
 
 	_is_running = true;
 
@@ -467,6 +468,7 @@ void task_main(int argc, char *argv[])
 
 			if (required && (timestamp_sample > 0)) {
 				perf_set_elapsed(_perf_control_latency, _outputs.timestamp - timestamp_sample);
+				latency_trace_record(LATENCY_TRACE_ACTUATOR_OUTPUTS, timestamp_sample);
 				break;
 			}
 		}
@@ -45,6 +45,7 @@
 
 #include <lib/mathlib/mathlib.h>
 #include <lib/cdev/CDev.hpp>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <px4_module_params.h>
 #include <uORB/uORB.h>
@@ -157,7 +158,7 @@ const uint8_t TAP_ESC::_device_dir_map[TAP_ESC_MAX_MOTOR_NUM] = ESC_DIR;
 TAP_ESC::TAP_ESC(char const *const device, uint8_t channels_count):
 	CDev(TAP_ESC_DEVICE_PATH),
 	ModuleParams(nullptr),
-	_perf_control_latency(perf_alloc(PC_ELAPSED, "tap_esc control latency")),
+	_perf_control_latency(perf_alloc(PC_HISTOGRAM, "tap_esc control latency")),
 	_channels_count(channels_count)
 {
 	strncpy(_device, device, sizeof(_device));
@@ -586,6 +587,7 @@ void TAP_ESC::cycle()
 
 			if (required && (timestamp_sample > 0)) {
 				perf_set_elapsed(_perf_control_latency, _outputs.timestamp - timestamp_sample);
+				latency_trace_record(LATENCY_TRACE_ACTUATOR_OUTPUTS, timestamp_sample);
 				break;
 			}
 		}
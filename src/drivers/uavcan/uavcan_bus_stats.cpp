@@ -0,0 +1,126 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file uavcan_bus_stats.cpp
+ */
+
+#include "uavcan_bus_stats.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+void UavcanBusStats::attach(uavcan::IRxFrameListener *listener)
+{
+	_forward = listener;
+	_node.getDispatcher().installRxFrameListener(this);
+}
+
+void UavcanBusStats::handleRxFrame(const uavcan::CanRxFrame &frame, uavcan::CanIOFlags flags)
+{
+	if (_forward != nullptr) {
+		_forward->handleRxFrame(frame, flags);
+	}
+
+	if ((flags & uavcan::CanIOFlagLoopback) || !frame.isExtended() || frame.isErrorFrame()) {
+		return;
+	}
+
+	/* the source node ID is in the lowest 7 bits of the CAN ID, 0 for anonymous transfers */
+	const uint8_t node_id = frame.id & uavcan::NodeID::Max;
+
+	if (_slots[node_id] == NoSlot) {
+		if (_num_nodes >= MaxNodes) {
+			_untracked_frames++;
+			return;
+		}
+
+		_slots[node_id] = _num_nodes;
+		_stats[_num_nodes] = {};
+		_stats[_num_nodes].node_id = node_id;
+		_num_nodes++;
+	}
+
+	NodeStats &s = _stats[_slots[node_id]];
+	s.frames++;
+	s.bits += FrameOverheadBits + 8 * frame.dlc;
+
+	if (!frame.ts_mono.isZero()) {
+		const int64_t latency = (_node.getMonotonicTime() - frame.ts_mono).toUSec();
+
+		if (latency > 0) {
+			s.latency_sum_us += latency;
+			s.latency_max_us = uavcan::max<uint32_t>(s.latency_max_us, latency);
+		}
+	}
+}
+
+void UavcanBusStats::reset()
+{
+	memset(_slots, NoSlot, sizeof(_slots));
+	_num_nodes = 0;
+	_untracked_frames = 0;
+	_start = _node.getMonotonicTime();
+}
+
+uint32_t UavcanBusStats::frames(uint8_t node_id) const
+{
+	if (node_id > uavcan::NodeID::Max || _slots[node_id] == NoSlot) {
+		return 0;
+	}
+
+	return _stats[_slots[node_id]].frames;
+}
+
+void UavcanBusStats::print_status() const
+{
+	const float dt = (_node.getMonotonicTime() - _start).toUSec() * 1e-6f;
+
+	if (dt <= 0.f) {
+		return;
+	}
+
+	std::printf("Bus statistics over %.1f s (Node ID, frames/s, kbit/s, load %%, latency avg/max us):\n", (double)dt);
+
+	for (unsigned i = 0; i < _num_nodes; i++) {
+		const NodeStats &s = _stats[i];
+		std::printf("\t% 3d %8.1f %8.1f %6.2f %6u %6u\n", int(s.node_id),
+			    (double)(s.frames / dt), (double)(s.bits / dt * 1e-3f),
+			    (double)(100.f * s.bits / (dt * _bitrate)),
+			    unsigned(s.frames > 0 ? s.latency_sum_us / s.frames : 0), unsigned(s.latency_max_us));
+	}
+
+	if (_untracked_frames > 0) {
+		std::printf("\tframes from untracked nodes: %u\n", unsigned(_untracked_frames));
+	}
+}
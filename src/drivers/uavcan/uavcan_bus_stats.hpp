@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file uavcan_bus_stats.hpp
+ *
+ * Per source node bus statistics, collected from the frames seen by the
+ * dispatcher of the main node.
+ */
+
+#pragma once
+
+#include <uavcan/uavcan.hpp>
+
+class UavcanBusStats : public uavcan::IRxFrameListener, uavcan::Noncopyable
+{
+public:
+	UavcanBusStats(uavcan::INode &node) : _node(node) { reset(); }
+
+	/**
+	 * Install as the RX listener of the node, forwarding every frame to
+	 * listener first (nullptr for none). The dispatcher only takes one RX
+	 * listener: listeners that would otherwise replace this one (e.g. the
+	 * server sub-node driver) are chained here instead. Has to be called
+	 * again whenever something else installed or removed the listener.
+	 */
+	void attach(uavcan::IRxFrameListener *listener);
+
+	void set_bitrate(uint32_t bitrate) { _bitrate = bitrate; }
+
+	void handleRxFrame(const uavcan::CanRxFrame &frame, uavcan::CanIOFlags flags) override;
+
+	void reset();
+
+	void print_status() const;
+
+	/** frames received from node_id since the last reset */
+	uint32_t frames(uint8_t node_id) const;
+
+private:
+	static constexpr unsigned MaxNodes = 32;	///< distinct source nodes tracked
+	static constexpr uint8_t NoSlot = 0xff;
+
+	/* extended data frame without bit stuffing: 67 bits of overhead */
+	static constexpr unsigned FrameOverheadBits = 67;
+
+	struct NodeStats {
+		uint32_t frames;
+		uint32_t bits;
+		uint64_t latency_sum_us;	///< RX timestamp to dispatch
+		uint32_t latency_max_us;
+		uint8_t node_id;
+	};
+
+	uavcan::INode			&_node;
+	uavcan::IRxFrameListener	*_forward{nullptr};
+	uint32_t			_bitrate{1000000};
+
+	uavcan::MonotonicTime		_start;
+	uint8_t				_slots[uavcan::NodeID::Max + 1];
+	NodeStats			_stats[MaxNodes];
+	unsigned			_num_nodes{0};
+	uint32_t			_untracked_frames{0};
+};
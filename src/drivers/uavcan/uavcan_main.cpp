@@ -85,7 +85,9 @@ UavcanNode::UavcanNode(uavcan::ICanDriver &can_driver, uavcan::ISystemClock &sys
 	_time_sync_master(_node),
 	_time_sync_slave(_node),
 	_node_status_monitor(_node),
-	_perf_control_latency(perf_alloc(PC_ELAPSED, "uavcan control latency")),
+	_bus_stats(_node),
+	_perf_control_latency(perf_alloc(PC_HISTOGRAM, "uavcan control latency")),
+	_perf_spin(perf_alloc(PC_ELAPSED, "uavcan spin")),
 	_master_timer(_node),
 	_setget_response(0)
 {
@@ -167,6 +169,7 @@ UavcanNode::~UavcanNode()
 	}
 
 	perf_free(_perf_control_latency);
+	perf_free(_perf_spin);
 }
 
 int UavcanNode::getHardwareVersion(uavcan::protocol::HardwareVersion &hwver)
@@ -443,6 +446,8 @@ int UavcanNode::start_fw_server()
 
 		rv = UavcanServers::start(_node);
 
+		uavcan::IRxFrameListener *listener = nullptr;
+
 		if (rv >= 0) {
 			/*
 			 * Set our pointer to to the injector
@@ -451,7 +456,15 @@ int UavcanNode::start_fw_server()
 			 *  would require a dynamic cast and rtti is not enabled.
 			 */
 			UavcanServers::instance()->attachITxQueueInjector(&_tx_injector);
+			UavcanServers::instance()->attachIRxFrameListener(&listener);
 		}
+
+		/*
+		 * Starting the servers replaced the bus statistics as RX listener, and a failed
+		 * start removed the servers listener again: reinstall the statistics either way,
+		 * chained in front of the servers if they are running.
+		 */
+		_bus_stats.attach(listener);
 	}
 
 	_fw_server_action = None;
@@ -492,6 +505,9 @@ int UavcanNode::stop_fw_server()
 		_tx_injector = nullptr;
 
 		rv = _servers->stop();
+
+		/* stopping the servers removes the RX listener */
+		_bus_stats.attach(nullptr);
 	}
 
 	_fw_server_action = None;
@@ -566,6 +582,8 @@ int UavcanNode::start(uavcan::NodeID node_id, uint32_t bitrate)
 		return -1;
 	}
 
+	_instance->_bus_stats.set_bitrate(bitrate);
+
 	const int node_init_res = _instance->init(node_id);
 
 	if (node_init_res < 0) {
@@ -673,7 +691,9 @@ int UavcanNode::init(uavcan::NodeID node_id)
 
 void UavcanNode::node_spin_once()
 {
+	perf_begin(_perf_spin);
 	const int spin_res = _node.spinOnce();
+	perf_end(_perf_spin);
 
 	if (spin_res < 0) {
 		PX4_ERR("node spin error %i", spin_res);
@@ -685,6 +705,19 @@ void UavcanNode::node_spin_once()
 	}
 }
 
+int UavcanNode::poll_timeout_ms()
+{
+	// Wake up in time for the next libuavcan timer, RX/TX readiness and actuator updates wake us anyway
+	const uavcan::MonotonicTime deadline = _node.getScheduler().getDeadlineScheduler().getEarliestDeadline();
+	const int64_t remaining_us = (deadline - _node.getMonotonicTime()).toUSec();
+
+	if (remaining_us <= 0) {
+		return 0;
+	}
+
+	return uavcan::min<int64_t>((remaining_us + 999) / 1000, PollTimeoutMs);
+}
+
 /*
   add a fd to the list of polled events. This assumes you want
   POLLIN for now.
@@ -747,6 +780,108 @@ void UavcanNode::handle_time_sync(const uavcan::TimerEvent &)
 
 
 
+bool UavcanNode::update_outputs()
+{
+	bool new_output = false;
+
+	// get controls for required topics
+	bool controls_updated = false;
+
+	for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+		if (_control_subs[i] >= 0) {
+			if (_poll_fds[_poll_ids[i]].revents & POLLIN) {
+				controls_updated = true;
+				orb_copy(_control_topics[i], _control_subs[i], &_controls[i]);
+			}
+		}
+	}
+
+	/*
+	  see if we have any direct actuator updates
+	 */
+	if (_actuator_direct_sub != -1 &&
+	    (_poll_fds[_actuator_direct_poll_fd_num].revents & POLLIN) &&
+	    orb_copy(ORB_ID(actuator_direct), _actuator_direct_sub, &_actuator_direct) == OK &&
+	    !_test_in_progress) {
+		if (_actuator_direct.nvalues > actuator_outputs_s::NUM_ACTUATOR_OUTPUTS) {
+			_actuator_direct.nvalues = actuator_outputs_s::NUM_ACTUATOR_OUTPUTS;
+		}
+
+		memcpy(&_outputs.output[0], &_actuator_direct.values[0],
+		       _actuator_direct.nvalues * sizeof(float));
+		_outputs.noutputs = _actuator_direct.nvalues;
+		new_output = true;
+	}
+
+	// can we mix?
+	if (_test_in_progress) {
+		memset(&_outputs, 0, sizeof(_outputs));
+
+		if (_test_motor.motor_number < actuator_outputs_s::NUM_ACTUATOR_OUTPUTS) {
+			_outputs.output[_test_motor.motor_number] = _test_motor.value * 2.0f - 1.0f;
+			_outputs.noutputs = _test_motor.motor_number + 1;
+		}
+
+		new_output = true;
+
+	} else if (controls_updated && (_mixers != nullptr)) {
+
+		// XXX one output group has 8 outputs max,
+		// but this driver could well serve multiple groups.
+		unsigned num_outputs_max = 8;
+
+		_mixers->set_airmode(_airmode);
+
+		// Do mixing
+		_outputs.noutputs = _mixers->mix(&_outputs.output[0], num_outputs_max);
+
+		new_output = true;
+	}
+
+	if (new_output) {
+		// iterate actuators, checking for valid values
+		for (uint8_t i = 0; i < _outputs.noutputs; i++) {
+			// last resort: catch NaN, INF and out-of-band errors
+			if (!isfinite(_outputs.output[i])) {
+				/*
+				 * Value is NaN, INF or out of band - set to the minimum value.
+				 * This will be clearly visible on the servo status and will limit the risk of accidentally
+				 * spinning motors. It would be deadly in flight.
+				 */
+				_outputs.output[i] = -1.0f;
+			}
+
+			// never go below min
+			if (_outputs.output[i] < -1.0f) {
+				_outputs.output[i] = -1.0f;
+			}
+
+			// never go above max
+			if (_outputs.output[i] > 1.0f) {
+				_outputs.output[i] = 1.0f;
+			}
+		}
+
+		// Output to the bus
+		_esc_controller.update_outputs(_outputs.output, _outputs.noutputs);
+		_outputs.timestamp = hrt_absolute_time();
+
+		// use first valid timestamp_sample for latency tracking
+		for (int i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+			const bool required = _groups_required & (1 << i);
+			const hrt_abstime &timestamp_sample = _controls[i].timestamp_sample;
+
+			if (required && (timestamp_sample > 0)) {
+				perf_set_elapsed(_perf_control_latency, _outputs.timestamp - timestamp_sample);
+				latency_trace_record(LATENCY_TRACE_ACTUATOR_OUTPUTS, timestamp_sample);
+				break;
+			}
+		}
+	}
+
+	return new_output;
+}
+
 int UavcanNode::run()
 {
 	(void)pthread_mutex_lock(&_node_mutex);
@@ -782,6 +917,9 @@ int UavcanNode::run()
 
 	_node_status_monitor.start();
 
+	_bus_stats.reset();
+	_bus_stats.attach(nullptr);
+
 	const int busevent_fd = ::open(UAVCAN_DRIVER::BusEvent::DevName, 0);
 
 	if (busevent_fd < 0) {
@@ -855,115 +993,22 @@ int UavcanNode::run()
 		// Mutex is unlocked while the thread is blocked on IO multiplexing
 		(void)pthread_mutex_unlock(&_node_mutex);
 
-		const int poll_ret = ::poll(_poll_fds, _poll_fds_num, PollTimeoutMs);
+		const int poll_ret = ::poll(_poll_fds, _poll_fds_num, poll_timeout_ms());
 
 		(void)pthread_mutex_lock(&_node_mutex);
 
-		node_spin_once();  // Non-blocking
-
-		bool new_output = false;
-
 		// this would be bad...
 		if (poll_ret < 0) {
 			PX4_ERR("poll error %d", errno);
+			node_spin_once();
 			continue;
-
-		} else {
-			// get controls for required topics
-			bool controls_updated = false;
-
-			for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
-				if (_control_subs[i] >= 0) {
-					if (_poll_fds[_poll_ids[i]].revents & POLLIN) {
-						controls_updated = true;
-						orb_copy(_control_topics[i], _control_subs[i], &_controls[i]);
-					}
-				}
-			}
-
-			/*
-			  see if we have any direct actuator updates
-			 */
-			if (_actuator_direct_sub != -1 &&
-			    (_poll_fds[_actuator_direct_poll_fd_num].revents & POLLIN) &&
-			    orb_copy(ORB_ID(actuator_direct), _actuator_direct_sub, &_actuator_direct) == OK &&
-			    !_test_in_progress) {
-				if (_actuator_direct.nvalues > actuator_outputs_s::NUM_ACTUATOR_OUTPUTS) {
-					_actuator_direct.nvalues = actuator_outputs_s::NUM_ACTUATOR_OUTPUTS;
-				}
-
-				memcpy(&_outputs.output[0], &_actuator_direct.values[0],
-				       _actuator_direct.nvalues * sizeof(float));
-				_outputs.noutputs = _actuator_direct.nvalues;
-				new_output = true;
-			}
-
-			// can we mix?
-			if (_test_in_progress) {
-				memset(&_outputs, 0, sizeof(_outputs));
-
-				if (_test_motor.motor_number < actuator_outputs_s::NUM_ACTUATOR_OUTPUTS) {
-					_outputs.output[_test_motor.motor_number] = _test_motor.value * 2.0f - 1.0f;
-					_outputs.noutputs = _test_motor.motor_number + 1;
-				}
-
-				new_output = true;
-
-			} else if (controls_updated && (_mixers != nullptr)) {
-
-				// XXX one output group has 8 outputs max,
-				// but this driver could well serve multiple groups.
-				unsigned num_outputs_max = 8;
-
-				_mixers->set_airmode(_airmode);
-
-				// Do mixing
-				_outputs.noutputs = _mixers->mix(&_outputs.output[0], num_outputs_max);
-
-				new_output = true;
-			}
 		}
 
-		if (new_output) {
-			// iterate actuators, checking for valid values
-			for (uint8_t i = 0; i < _outputs.noutputs; i++) {
-				// last resort: catch NaN, INF and out-of-band errors
-				if (!isfinite(_outputs.output[i])) {
-					/*
-					 * Value is NaN, INF or out of band - set to the minimum value.
-					 * This will be clearly visible on the servo status and will limit the risk of accidentally
-					 * spinning motors. It would be deadly in flight.
-					 */
-					_outputs.output[i] = -1.0f;
-				}
-
-				// never go below min
-				if (_outputs.output[i] < -1.0f) {
-					_outputs.output[i] = -1.0f;
-				}
-
-				// never go above max
-				if (_outputs.output[i] > 1.0f) {
-					_outputs.output[i] = 1.0f;
-				}
-			}
-
-			// Output to the bus
-			_esc_controller.update_outputs(_outputs.output, _outputs.noutputs);
-			_outputs.timestamp = hrt_absolute_time();
-
-			// use first valid timestamp_sample for latency tracking
-			for (int i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
-				const bool required = _groups_required & (1 << i);
-				const hrt_abstime &timestamp_sample = _controls[i].timestamp_sample;
-
-				if (required && (timestamp_sample > 0)) {
-					perf_set_elapsed(_perf_control_latency, _outputs.timestamp - timestamp_sample);
-					break;
-				}
-			}
-		}
+		// Mix and send before spinning, so the ESC command does not wait for the RX backlog of a busy bus
+		update_outputs();
 
+		// Handle RX, timers and whatever is left in the TX queue
+		node_spin_once();
 
 		// Check motor test state
 		bool updated = false;
@@ -1204,6 +1249,8 @@ UavcanNode::print_info()
 		printf("\tTX frames: %llu\n", iface_perf_cnt.frames_tx);
 	}
 
+	_bus_stats.print_status();
+
 	// ESC mixer status
 	printf("ESC actuators control groups: sub: %u / req: %u / fds: %u\n",
 	       (unsigned)_groups_subscribed, (unsigned)_groups_required, _poll_fds_num);
@@ -54,6 +54,7 @@
 #include <uavcan/protocol/RestartNode.hpp>
 
 #include <drivers/device/device.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 
 #include <uORB/topics/actuator_controls.h>
@@ -66,6 +67,7 @@
 #include "actuators/hardpoint.hpp"
 #include "sensors/sensor_bridge.hpp"
 
+#include "uavcan_bus_stats.hpp"
 #include "uavcan_servers.hpp"
 #include "allocator.hpp"
 
@@ -145,6 +147,8 @@ private:
 	void		fill_node_info();
 	int		init(uavcan::NodeID node_id);
 	void		node_spin_once();
+	int		poll_timeout_ms();			///< time until the next libuavcan deadline, capped at PollTimeoutMs
+	bool		update_outputs();			///< mix and send pending actuator updates, true if sent
 	int		run();
 	int		add_poll_fd(int fd);			///< add a fd to poll list, returning index into _poll_fds[]
 	int		start_fw_server();
@@ -188,6 +192,7 @@ private:
 	uavcan::GlobalTimeSyncMaster	_time_sync_master;
 	uavcan::GlobalTimeSyncSlave	_time_sync_slave;
 	uavcan::NodeStatusMonitor	_node_status_monitor;
+	UavcanBusStats			_bus_stats;
 
 	List<IUavcanSensorBridge *>	_sensor_bridges;		///< List of active sensor bridges
 
@@ -209,6 +214,7 @@ private:
 	actuator_outputs_s		_outputs = {};
 
 	perf_counter_t			_perf_control_latency;
+	perf_counter_t			_perf_spin;
 
 	Mixer::Airmode 			_airmode = Mixer::Airmode::disabled;
 
@@ -103,6 +103,12 @@ public:
 	 */
 	void attachITxQueueInjector(ITxQueueInjector **injector) {*injector = &_vdriver;}
 
+	/*
+	 * Same work around for the RX side, so the main node can chain the
+	 * virtual driver behind its own RX listener.
+	 */
+	void attachIRxFrameListener(uavcan::IRxFrameListener **listener) {*listener = &_vdriver;}
+
 	void requestCheckAllNodesFirmwareAndUpdate() { _check_fw = true; }
 
 	bool guessIfAllDynamicNodesAreAllocated() { return _server_instance.guessIfAllDynamicNodesAreAllocated(); }
@@ -0,0 +1,389 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file UavcanTest.cpp
+ * Bus statistics and RX listener chaining tests on a SocketCAN interface.
+ *
+ * Needs a virtual CAN interface, set up with:
+ *   ip link add dev vcan0 type vcan && ip link set up vcan0
+ */
+
+#include <unit_test.h>
+
+#include "../uavcan_bus_stats.hpp"
+
+#include <uavcan/uavcan.hpp>
+
+#include <errno.h>
+#include <net/if.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+static constexpr const char *CanIfaceName = "vcan0";
+
+static int open_can_socket(const char *name)
+{
+	const int fd = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	ifreq ifr{};
+	strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+
+	sockaddr_can addr{};
+	addr.can_family = AF_CAN;
+
+	if (::ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+		::close(fd);
+		return -1;
+	}
+
+	addr.can_ifindex = ifr.ifr_ifindex;
+
+	if (::bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+		::close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+class SystemClock : public uavcan::ISystemClock
+{
+public:
+	uavcan::MonotonicTime getMonotonic() const override { return uavcan::MonotonicTime::fromUSec(now(CLOCK_MONOTONIC)); }
+	uavcan::UtcTime getUtc() const override { return uavcan::UtcTime::fromUSec(now(CLOCK_REALTIME)); }
+	void adjustUtc(uavcan::UtcDuration) override {}
+
+private:
+	static uint64_t now(clockid_t clock_id)
+	{
+		timespec ts{};
+		clock_gettime(clock_id, &ts);
+		return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+	}
+};
+
+/* minimal single interface SocketCAN driver */
+class SocketCanDriver : public uavcan::ICanDriver, public uavcan::ICanIface
+{
+public:
+	SocketCanDriver(const uavcan::ISystemClock &clock) : _clock(clock) {}
+	~SocketCanDriver() { close(); }
+
+	bool open(const char *name)
+	{
+		_fd = open_can_socket(name);
+		return _fd >= 0;
+	}
+
+	void close()
+	{
+		if (_fd >= 0) {
+			::close(_fd);
+			_fd = -1;
+		}
+	}
+
+	uavcan::ICanIface *getIface(uint8_t iface_index) override { return (iface_index == 0) ? this : nullptr; }
+	uint8_t getNumIfaces() const override { return 1; }
+
+	int16_t select(uavcan::CanSelectMasks &inout_masks, const uavcan::CanFrame * (&)[uavcan::MaxCanIfaces],
+		       uavcan::MonotonicTime blocking_deadline) override
+	{
+		pollfd fds{};
+		fds.fd = _fd;
+		fds.events = ((inout_masks.read & 1) ? POLLIN : 0) | ((inout_masks.write & 1) ? POLLOUT : 0);
+
+		const int64_t timeout_ms = (blocking_deadline - _clock.getMonotonic()).toMSec();
+		const int ret = ::poll(&fds, 1, timeout_ms > 0 ? (int)timeout_ms : 0);
+
+		if (ret < 0) {
+			return -uavcan::ErrDriver;
+		}
+
+		inout_masks.read = (fds.revents & POLLIN) ? 1 : 0;
+		inout_masks.write = (fds.revents & POLLOUT) ? 1 : 0;
+		return ret;
+	}
+
+	int16_t send(const uavcan::CanFrame &frame, uavcan::MonotonicTime, uavcan::CanIOFlags) override
+	{
+		// uavcan and SocketCAN use the same EFF/RTR/ERR flag bits in the ID
+		can_frame socket_frame{};
+		socket_frame.can_id = frame.id;
+		socket_frame.can_dlc = frame.dlc;
+		memcpy(socket_frame.data, frame.data, frame.dlc);
+
+		if (::send(_fd, &socket_frame, sizeof(socket_frame), MSG_DONTWAIT) < 0) {
+			return (errno == EAGAIN || errno == ENOBUFS) ? 0 : -uavcan::ErrDriver;
+		}
+
+		return 1;
+	}
+
+	int16_t receive(uavcan::CanFrame &out_frame, uavcan::MonotonicTime &out_ts_monotonic,
+			uavcan::UtcTime &out_ts_utc, uavcan::CanIOFlags &out_flags) override
+	{
+		can_frame socket_frame{};
+		const ssize_t ret = ::recv(_fd, &socket_frame, sizeof(socket_frame), MSG_DONTWAIT);
+
+		if (ret < 0) {
+			return (errno == EAGAIN) ? 0 : -uavcan::ErrDriver;
+		}
+
+		if (ret != sizeof(socket_frame)) {
+			return -uavcan::ErrDriver;
+		}
+
+		out_frame = uavcan::CanFrame(socket_frame.can_id, socket_frame.data, socket_frame.can_dlc);
+		out_ts_monotonic = _clock.getMonotonic();
+		out_ts_utc = _clock.getUtc();
+		out_flags = 0;
+		return 1;
+	}
+
+	int16_t configureFilters(const uavcan::CanFilterConfig *, uint16_t) override { return -uavcan::ErrDriver; }
+	uint16_t getNumFilters() const override { return 0; }
+	uint64_t getErrorCount() const override { return 0; }
+
+private:
+	const uavcan::ISystemClock &_clock;
+	int _fd{-1};
+};
+
+/*
+ * Stands in for UavcanServers, which cannot be built on Linux: init() installs
+ * the listener of the server sub-node (after which it may still fail), and the
+ * destructor removes it again.
+ */
+class TestServer : public uavcan::IRxFrameListener
+{
+public:
+	TestServer(uavcan::INode &node, bool fail) : _node(node), _fail(fail) {}
+	virtual ~TestServer() { _node.getDispatcher().removeRxFrameListener(); }
+
+	int init()
+	{
+		_node.getDispatcher().installRxFrameListener(this);
+		return _fail ? -1 : 0;
+	}
+
+	void handleRxFrame(const uavcan::CanRxFrame &, uavcan::CanIOFlags) override { frames++; }
+
+	uint32_t frames{0};
+
+private:
+	uavcan::INode &_node;
+	const bool _fail;
+};
+
+class UavcanTest : public UnitTest
+{
+public:
+	UavcanTest() = default;
+	virtual ~UavcanTest();
+
+	virtual bool run_tests();
+
+private:
+	static constexpr uint8_t NodeId = 10;
+	static constexpr uint8_t RemoteNodeId = 42;
+
+	bool busStatsTest();
+	bool serverStartFailedTest();
+	bool serverRunningTest();
+
+	bool init();
+
+	/* start and stop as UavcanNode::start_fw_server() and stop_fw_server() do */
+	int start_server(bool fail);
+	void stop_server();
+
+	/* broadcast NodeStatus frames from the remote node and process them */
+	bool receive(unsigned count);
+
+	SystemClock _clock;
+	SocketCanDriver _driver{_clock};
+	uavcan::Node<16384> _node{_driver, _clock};
+	UavcanBusStats _bus_stats{_node};
+	TestServer *_server{nullptr};
+
+	int _remote_fd{-1};
+	uint8_t _transfer_id{0};
+	bool _initialized{false};
+};
+
+UavcanTest::~UavcanTest()
+{
+	stop_server();
+
+	if (_remote_fd >= 0) {
+		::close(_remote_fd);
+	}
+}
+
+bool UavcanTest::init()
+{
+	if (_initialized) {
+		return true;
+	}
+
+	_remote_fd = open_can_socket(CanIfaceName);
+
+	if (_remote_fd < 0 || !_driver.open(CanIfaceName)) {
+		PX4_ERR("failed to open %s (%s), set it up with: ip link add dev %s type vcan && ip link set up %s",
+			CanIfaceName, strerror(errno), CanIfaceName, CanIfaceName);
+		return false;
+	}
+
+	_node.setNodeID(NodeId);
+	_node.setName("org.pixhawk.test");
+
+	if (_node.start() < 0) {
+		PX4_ERR("node start failed");
+		return false;
+	}
+
+	_bus_stats.reset();
+	_bus_stats.attach(nullptr);
+	_initialized = true;
+	return true;
+}
+
+int UavcanTest::start_server(bool fail)
+{
+	_server = new TestServer(_node, fail);
+
+	const int ret = _server->init();
+
+	if (ret < 0) {
+		delete _server;
+		_server = nullptr;
+	}
+
+	_bus_stats.attach(_server);
+	return ret;
+}
+
+void UavcanTest::stop_server()
+{
+	if (_server != nullptr) {
+		delete _server;
+		_server = nullptr;
+		_bus_stats.attach(nullptr);
+	}
+}
+
+bool UavcanTest::receive(unsigned count)
+{
+	for (unsigned i = 0; i < count; i++) {
+		// single frame uavcan.protocol.NodeStatus broadcast, priority 16
+		can_frame frame{};
+		frame.can_id = CAN_EFF_FLAG | (16u << 24) | (341u << 8) | RemoteNodeId;
+		frame.can_dlc = 8;
+		frame.data[7] = 0xc0 | (_transfer_id++ & 0x1f);	// start and end of transfer
+
+		if (::write(_remote_fd, &frame, sizeof(frame)) != sizeof(frame)) {
+			PX4_ERR("write failed (%s)", strerror(errno));
+			return false;
+		}
+	}
+
+	return _node.spin(uavcan::MonotonicDuration::fromMSec(50)) >= 0;
+}
+
+bool UavcanTest::busStatsTest()
+{
+	ut_assert_true(init());
+
+	const uint32_t frames = _bus_stats.frames(RemoteNodeId);
+	ut_assert_true(receive(3));
+	ut_compare("frames counted", _bus_stats.frames(RemoteNodeId), frames + 3);
+
+	return true;
+}
+
+bool UavcanTest::serverStartFailedTest()
+{
+	ut_assert_true(init());
+
+	ut_assert("server start fails", start_server(true) < 0);
+
+	// the failed server removed its listener, the statistics must be installed again
+	const uint32_t frames = _bus_stats.frames(RemoteNodeId);
+	ut_assert_true(receive(3));
+	ut_compare("frames counted after a failed server start", _bus_stats.frames(RemoteNodeId), frames + 3);
+
+	return true;
+}
+
+bool UavcanTest::serverRunningTest()
+{
+	ut_assert_true(init());
+
+	ut_assert("server starts", start_server(false) == 0);
+
+	const uint32_t frames = _bus_stats.frames(RemoteNodeId);
+	ut_assert_true(receive(3));
+	ut_compare("frames counted with the server running", _bus_stats.frames(RemoteNodeId), frames + 3);
+	ut_assert("frames forwarded to the server", _server->frames >= 3);
+
+	stop_server();
+
+	ut_assert_true(receive(3));
+	ut_compare("frames counted after the server stopped", _bus_stats.frames(RemoteNodeId), frames + 6);
+
+	return true;
+}
+
+bool UavcanTest::run_tests()
+{
+	ut_run_test(busStatsTest);
+	ut_run_test(serverStartFailedTest);
+	ut_run_test(serverRunningTest);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test_c(uavcan_tests_main, UavcanTest)
@@ -47,6 +47,7 @@
 #include <string.h>
 #include <math.h>
 
+#include <drivers/drv_hrt.h>
 #include <uORB/uORB.h>
 #include <uORB/topics/sensor_combined.h>
 #include <uORB/topics/vehicle_attitude.h>
@@ -110,6 +111,8 @@ int px4_simple_app_main(int argc, char *argv[])
 				/* set att and publish this information for other apps
 				 the following does not have any meaning, it's just an example
 				*/
+				att.timestamp = hrt_absolute_time();
+				att.timestamp_sample = raw.timestamp;
 				att.q[0] = raw.accelerometer_m_s2[0];
 				att.q[1] = raw.accelerometer_m_s2[1];
 				att.q[2] = raw.accelerometer_m_s2[2];
@@ -66,6 +66,12 @@ bool CollisionPrevention::initializeSubscriptions(SubscriptionArray &subscriptio
 		return false;
 	}
 
+	for (unsigned i = 0; i < ORB_MULTI_MAX_INSTANCES; i++) {
+		if (!subscription_array.get(ORB_ID(distance_sensor), _sub_distance_sensor[i], i)) {
+			return false;
+		}
+	}
+
 	return true;
 }
 
@@ -105,25 +111,48 @@ void CollisionPrevention::publish_constraints(const Vector2f &original_setpoint,
 	}
 }
 
-void CollisionPrevention::update_range_constraints()
+void CollisionPrevention::update_obstacle_map(const Vector2f &curr_pos, const float yaw)
 {
+	_obstacle_map.setPosition(curr_pos);
+
+	// fuse only the messages which are new since the last cycle
 	const obstacle_distance_s &obstacle_distance = _sub_obstacle_distance->get();
 
-	if (hrt_elapsed_time(&obstacle_distance.timestamp) < RANGE_STREAM_TIMEOUT_US) {
-		float max_detection_distance = obstacle_distance.max_distance / 100.0f; //convert to meters
+	if (obstacle_distance.timestamp > _obstacle_distance_timestamp) {
+		_obstacle_map.addObstacleDistance(obstacle_distance);
+		_obstacle_distance_timestamp = obstacle_distance.timestamp;
+	}
 
-		int distances_array_size = sizeof(obstacle_distance.distances) / sizeof(obstacle_distance.distances[0]);
+	for (unsigned i = 0; i < ORB_MULTI_MAX_INSTANCES; i++) {
+		const distance_sensor_s &distance_sensor = _sub_distance_sensor[i]->get();
 
-		for (int i = 0; i < distances_array_size; i++) {
-			//determine if distance bin is valid and contains a valid distance measurement
-			if (obstacle_distance.distances[i] < obstacle_distance.max_distance &&
-			    obstacle_distance.distances[i] > obstacle_distance.min_distance && i * obstacle_distance.increment < 360) {
-				float distance = obstacle_distance.distances[i] / 100.0f; //convert to meters
-				float angle = math::radians((float)i * obstacle_distance.increment);
+		if (distance_sensor.timestamp > _distance_sensor_timestamp[i]) {
+			_obstacle_map.addDistanceSensor(distance_sensor, yaw);
+			_distance_sensor_timestamp[i] = distance_sensor.timestamp;
+		}
+	}
+
+	_obstacle_map.expire(hrt_absolute_time(), RANGE_STREAM_TIMEOUT_US);
+}
+
+void CollisionPrevention::update_range_constraints()
+{
+	const hrt_abstime last_update = _obstacle_map.lastUpdate();
+
+	if (last_update != 0 && hrt_elapsed_time(&last_update) < RANGE_STREAM_TIMEOUT_US) {
+		for (int i = 0; i < ObstacleMap::BIN_COUNT; i++) {
+			//determine if the bin contains an obstacle
+			if (_obstacle_map.isObstacle(i)) {
+				if (_obstacle_map.maxDistance(i) <= MPC_COL_PREV_D.get()
+				    && _last_range_message + MESSAGE_THROTTLE_US < hrt_absolute_time()) {
+					mavlink_log_critical(&_mavlink_log_pub, "Range sensor too short for MPC_COL_PREV_D, stopping");
+					_last_range_message = hrt_absolute_time();
+				}
 
 				//calculate normalized velocity reductions
-				float vel_lim_x = (max_detection_distance - distance) / (max_detection_distance - MPC_COL_PREV_D.get()) * cos(angle);
-				float vel_lim_y = (max_detection_distance - distance) / (max_detection_distance - MPC_COL_PREV_D.get()) * sin(angle);
+				float vel_lim = _obstacle_map.velocityReduction(i, MPC_COL_PREV_D.get());
+				float vel_lim_x = vel_lim * _obstacle_map.binNorth(i);
+				float vel_lim_y = vel_lim * _obstacle_map.binEast(i);
 
 				if (vel_lim_x > 0 && vel_lim_x > _move_constraints_x_normalized(1)) { _move_constraints_x_normalized(1) = vel_lim_x; }
 
@@ -141,11 +170,13 @@ void CollisionPrevention::update_range_constraints()
 	}
 }
 
-void CollisionPrevention::modifySetpoint(Vector2f &original_setpoint, const float max_speed)
+void CollisionPrevention::modifySetpoint(Vector2f &original_setpoint, const float max_speed, const Vector2f &curr_pos,
+		const float yaw)
 {
 	reset_constraints();
 
 	//calculate movement constraints based on range data
+	update_obstacle_map(curr_pos, yaw);
 	update_range_constraints();
 	_move_constraints_x = _move_constraints_x_normalized;
 	_move_constraints_y = _move_constraints_y_normalized;
@@ -45,6 +45,7 @@
 #include <float.h>
 #include <matrix/matrix/math.hpp>
 #include <uORB/topics/obstacle_distance.h>
+#include <uORB/topics/distance_sensor.h>
 #include <uORB/topics/collision_constraints.h>
 #include <mathlib/mathlib.h>
 #include <drivers/drv_hrt.h>
@@ -53,6 +54,8 @@
 #include <systemlib/mavlink_log.h>
 #include <lib/FlightTasks/tasks/FlightTask/SubscriptionArray.hpp>
 
+#include "ObstacleMap.hpp"
+
 class CollisionPrevention : public ModuleParams
 {
 public:
@@ -68,7 +71,15 @@ public:
 
 	bool is_active() { return MPC_COL_PREV_D.get() > 0; }
 
-	void modifySetpoint(matrix::Vector2f &original_setpoint, const float max_speed);
+	/**
+	 * Limit the velocity setpoint towards obstacles
+	 * @param original_setpoint velocity setpoint north/east, modified in place
+	 * @param max_speed maximum horizontal speed
+	 * @param curr_pos current local position north/east
+	 * @param yaw current vehicle heading, used for the body fixed distance sensors
+	 */
+	void modifySetpoint(matrix::Vector2f &original_setpoint, const float max_speed,
+			    const matrix::Vector2f &curr_pos, const float yaw);
 
 private:
 
@@ -78,11 +89,18 @@ private:
 	orb_advert_t _mavlink_log_pub{nullptr};	 	/**< Mavlink log uORB handle */
 
 	uORB::Subscription<obstacle_distance_s> *_sub_obstacle_distance{nullptr}; /**< obstacle distances received form a range sensor */
+	uORB::Subscription<distance_sensor_s> *_sub_distance_sensor[ORB_MULTI_MAX_INSTANCES] {}; /**< range sensors */
+
+	hrt_abstime _obstacle_distance_timestamp{0};	/**< last obstacle_distance fused into the map */
+	hrt_abstime _distance_sensor_timestamp[ORB_MULTI_MAX_INSTANCES] {};
+
+	ObstacleMap _obstacle_map;	/**< obstacles around the vehicle fused from all range sources */
 
 	static constexpr uint64_t RANGE_STREAM_TIMEOUT_US = 500000;
 	static constexpr uint64_t MESSAGE_THROTTLE_US = 5000000;
 
 	hrt_abstime _last_message;
+	hrt_abstime _last_range_message{0};	/**< last warning about a sensor range too short to brake */
 
 	matrix::Vector2f _move_constraints_x_normalized;
 	matrix::Vector2f _move_constraints_y_normalized;
@@ -95,6 +113,8 @@ private:
 
 	void update();
 
+	void update_obstacle_map(const matrix::Vector2f &curr_pos, const float yaw);
+
 	void update_range_constraints();
 
 	void reset_constraints();
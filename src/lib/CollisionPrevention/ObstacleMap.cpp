@@ -0,0 +1,268 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file ObstacleMap.cpp
+ */
+
+#include "ObstacleMap.hpp"
+
+#include <float.h>
+#include <mathlib/mathlib.h>
+#include <px4_defines.h>
+
+using namespace matrix;
+
+ObstacleMap::ObstacleMap()
+{
+	for (int i = 0; i < BIN_COUNT; i++) {
+		const float angle = math::radians(i * BIN_SIZE);
+		_bin_north[i] = cosf(angle);
+		_bin_east[i] = sinf(angle);
+	}
+
+	reset();
+}
+
+void ObstacleMap::reset()
+{
+	for (int i = 0; i < BIN_COUNT; i++) {
+		clearBin(i);
+	}
+
+	_position_valid = false;
+	_last_update = 0;
+}
+
+int ObstacleMap::bin(float bearing)
+{
+	const int i = (int)(math::degrees(wrap_2pi(bearing)) / BIN_SIZE + 0.5f);
+	return i % BIN_COUNT;
+}
+
+void ObstacleMap::clearBin(int bin)
+{
+	_distance[bin] = FLT_MAX;
+	_max_distance[bin] = 0.f;
+	_timestamp[bin] = 0;
+}
+
+void ObstacleMap::setBin(int bin, float distance, float max_distance, hrt_abstime timestamp)
+{
+	_last_update = math::max(_last_update, timestamp);
+
+	// a recent closer obstacle, possibly seen by another source, is kept
+	if (isObstacle(bin) && timestamp < _timestamp[bin] + FUSION_WINDOW_US && _distance[bin] <= distance) {
+		return;
+	}
+
+	_timestamp[bin] = timestamp;
+	_max_distance[bin] = max_distance;
+
+	if (distance < max_distance) {
+		_distance[bin] = distance;
+		_obstacle[bin] = _position + Vector2f(_bin_north[bin], _bin_east[bin]) * distance;
+
+	} else {
+		_distance[bin] = FLT_MAX;
+	}
+}
+
+void ObstacleMap::placeObstacle(int bin, const Obstacle &obstacle, float distance)
+{
+	if (isObstacle(bin)) {
+		// two obstacles in the same bin: keep the closer one
+		if (distance >= _distance[bin]) {
+			return;
+		}
+
+	} else if (_timestamp[bin] > obstacle.timestamp) {
+		// the bin has been measured free after the obstacle was seen
+		return;
+	}
+
+	_distance[bin] = distance;
+	_max_distance[bin] = obstacle.max_distance;
+	_obstacle[bin] = obstacle.position;
+	_timestamp[bin] = obstacle.timestamp;
+}
+
+ObstacleMap::Obstacle ObstacleMap::takeObstacle(int bin)
+{
+	const Obstacle obstacle{_obstacle[bin], _max_distance[bin], _timestamp[bin]};
+	clearBin(bin);
+	return obstacle;
+}
+
+void ObstacleMap::setPosition(const Vector2f &position)
+{
+	if (!PX4_ISFINITE(position(0)) || !PX4_ISFINITE(position(1))) {
+		return;
+	}
+
+	if (!_position_valid) {
+		_position = position;
+		_position_valid = true;
+		return;
+	}
+
+	if ((position - _position).norm() < MIN_SHIFT) {
+		return;
+	}
+
+	_position = position;
+
+	// Move every obstacle to the bin of its bearing from the new position. An obstacle which has to move
+	// is carried along the chain of obstacles it displaces, so no second copy of the map is needed.
+	bool placed[BIN_COUNT] {};
+
+	for (int i = 0; i < BIN_COUNT; i++) {
+		if (!isObstacle(i) || placed[i]) {
+			continue;
+		}
+
+		Vector2f offset = _obstacle[i] - _position;
+		int target = bin(atan2f(offset(1), offset(0)));
+
+		if (target == i) {
+			_distance[i] = offset.norm();
+			placed[i] = true;
+			continue;
+		}
+
+		Obstacle carry = takeObstacle(i);
+
+		while (true) {
+			if (isObstacle(target) && !placed[target]) {
+				const Vector2f offset_next = _obstacle[target] - _position;
+				const int target_next = bin(atan2f(offset_next(1), offset_next(0)));
+
+				if (target_next != target) {
+					Obstacle next = takeObstacle(target);
+					placeObstacle(target, carry, offset.norm());
+					placed[target] = true;
+
+					carry = next;
+					offset = offset_next;
+					target = target_next;
+					continue;
+				}
+
+				_distance[target] = offset_next.norm();
+			}
+
+			placeObstacle(target, carry, offset.norm());
+			placed[target] = true;
+			break;
+		}
+	}
+}
+
+void ObstacleMap::addObstacleDistance(const obstacle_distance_s &obstacle_distance)
+{
+	if (obstacle_distance.increment == 0) {
+		return;
+	}
+
+	const float increment = obstacle_distance.increment;
+	const float max_distance = obstacle_distance.max_distance / 100.f; // convert to meters
+	const int distances_array_size = sizeof(obstacle_distance.distances) / sizeof(obstacle_distance.distances[0]);
+
+	for (int i = 0; i < distances_array_size && i * obstacle_distance.increment < 360; i++) {
+		// unknown or below the minimum range
+		if (obstacle_distance.distances[i] == UINT16_MAX
+		    || obstacle_distance.distances[i] <= obstacle_distance.min_distance) {
+			continue;
+		}
+
+		const float distance = obstacle_distance.distances[i] / 100.f;
+
+		// the bins with their center inside the sector of the element
+		const float sector_start = (i - 0.5f) * increment / BIN_SIZE;
+		const int first = (int)ceilf(sector_start);
+		const int last = math::max((int)ceilf(sector_start + increment / BIN_SIZE) - 1, first);
+
+		for (int j = first; j <= last; j++) {
+			setBin((j + BIN_COUNT) % BIN_COUNT, distance, max_distance, obstacle_distance.timestamp);
+		}
+	}
+}
+
+void ObstacleMap::addDistanceSensor(const distance_sensor_s &distance_sensor, float yaw)
+{
+	// orientations up to 7 are MAV_SENSOR_ROTATION_YAW_45 steps, the others face up or down
+	float direction;
+
+	if (distance_sensor.orientation <= 7) {
+		direction = distance_sensor.orientation * M_PI_4_F;
+
+	} else if (distance_sensor.orientation == distance_sensor_s::ROTATION_BACKWARD_FACING) {
+		direction = M_PI_F;
+
+	} else {
+		return;
+	}
+
+	if (distance_sensor.signal_quality == 0 || distance_sensor.current_distance <= distance_sensor.min_distance
+	    || !PX4_ISFINITE(yaw)) {
+		return;
+	}
+
+	setBin(bin(yaw + direction), distance_sensor.current_distance, distance_sensor.max_distance,
+	       distance_sensor.timestamp);
+}
+
+void ObstacleMap::expire(hrt_abstime now, hrt_abstime timeout)
+{
+	for (int i = 0; i < BIN_COUNT; i++) {
+		if (_timestamp[i] != 0 && now > _timestamp[i] + timeout) {
+			clearBin(i);
+		}
+	}
+}
+
+float ObstacleMap::velocityReduction(int bin, float min_distance) const
+{
+	if (!isObstacle(bin)) {
+		return 0.f;
+	}
+
+	const float braking_range = _max_distance[bin] - min_distance;
+
+	if (braking_range <= FLT_EPSILON) {
+		// every obstacle the sensor sees is already inside min_distance
+		return 1.f;
+	}
+
+	return math::constrain((_max_distance[bin] - _distance[bin]) / braking_range, 0.f, 1.f);
+}
@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file ObstacleMap.hpp
+ *
+ * Polar map of the obstacles around the vehicle.
+ *
+ * The map has one bin per 5 degrees of bearing, bin 0 pointing north, and keeps the
+ * closest obstacle seen in each bin. Measurements of all range sources are fused into
+ * the same bins: a newer measurement replaces the older one unless that one is a closer
+ * obstacle seen only a moment ago, and bins that are not measured again within a timeout
+ * are cleared. The obstacles are stored as local positions, so when the vehicle moves
+ * they are sorted into the bins as seen from the new position instead of being dropped.
+ *
+ * The bins are stored as separate arrays, so computing the constraints only runs over
+ * the distances and the precomputed bin directions.
+ */
+
+#pragma once
+
+#include <drivers/drv_hrt.h>
+#include <matrix/matrix/math.hpp>
+#include <uORB/topics/distance_sensor.h>
+#include <uORB/topics/obstacle_distance.h>
+
+class ObstacleMap
+{
+public:
+	static constexpr int BIN_COUNT = 72;
+	static constexpr float BIN_SIZE = 360.f / BIN_COUNT;	///< [deg]
+
+	ObstacleMap();
+	~ObstacleMap() = default;
+
+	void reset();
+
+	/**
+	 * Move the map to the current vehicle position, needs to be called before adding measurements.
+	 * @param position local position north/east [m]
+	 */
+	void setPosition(const matrix::Vector2f &position);
+
+	/**
+	 * Fuse an obstacle_distance message, its first element points north.
+	 */
+	void addObstacleDistance(const obstacle_distance_s &obstacle_distance);
+
+	/**
+	 * Fuse a horizontal distance sensor. Sensors facing up or down are ignored.
+	 * @param yaw vehicle heading [rad]
+	 */
+	void addDistanceSensor(const distance_sensor_s &distance_sensor, float yaw);
+
+	/**
+	 * Clear the bins which have not been measured for longer than timeout.
+	 */
+	void expire(hrt_abstime now, hrt_abstime timeout);
+
+	/** time of the latest measurement of any source */
+	hrt_abstime lastUpdate() const { return _last_update; }
+
+	bool isObstacle(int bin) const { return _distance[bin] < _max_distance[bin]; }
+
+	/** distance to the closest obstacle in the bin [m] */
+	float distance(int bin) const { return _distance[bin]; }
+
+	/** maximum range of the sensor which measured the bin [m] */
+	float maxDistance(int bin) const { return _max_distance[bin]; }
+
+	/**
+	 * Normalized velocity reduction towards the obstacle in a bin, from 0 at the maximum range of
+	 * the sensor to 1 (stop) at min_distance. A sensor which cannot see beyond min_distance leaves
+	 * no range to brake in, any obstacle it sees then stops the vehicle right away.
+	 * @param min_distance distance to keep to obstacles [m]
+	 */
+	float velocityReduction(int bin, float min_distance) const;
+
+	/** north and east component of the unit vector along the bin center */
+	float binNorth(int bin) const { return _bin_north[bin]; }
+	float binEast(int bin) const { return _bin_east[bin]; }
+
+	/** bin containing the bearing [rad] */
+	static int bin(float bearing);
+
+private:
+	struct Obstacle {
+		matrix::Vector2f position;
+		float max_distance;
+		hrt_abstime timestamp;
+	};
+
+	/**
+	 * Set a bin to an obstacle at distance, or to free if distance is not below max_distance.
+	 * A closer obstacle measured less than FUSION_WINDOW_US before is kept.
+	 */
+	void setBin(int bin, float distance, float max_distance, hrt_abstime timestamp);
+	void clearBin(int bin);
+
+	/** move an obstacle into a bin unless the bin has a closer obstacle or was measured free since */
+	void placeObstacle(int bin, const Obstacle &obstacle, float distance);
+	Obstacle takeObstacle(int bin);
+
+	static constexpr float MIN_SHIFT = 0.05f;	///< vehicle movement below which the bins are not updated [m]
+	static constexpr hrt_abstime FUSION_WINDOW_US = 100000;
+
+	float _distance[BIN_COUNT];
+	float _max_distance[BIN_COUNT];
+	matrix::Vector2f _obstacle[BIN_COUNT];		///< local position of the obstacle
+	hrt_abstime _timestamp[BIN_COUNT];
+
+	float _bin_north[BIN_COUNT];
+	float _bin_east[BIN_COUNT];
+
+	matrix::Vector2f _position;
+	bool _position_valid{false};
+	hrt_abstime _last_update{0};
+};
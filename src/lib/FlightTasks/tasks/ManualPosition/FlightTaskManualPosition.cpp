@@ -134,7 +134,7 @@ void FlightTaskManualPosition::_scaleSticks()
 
 	// collision prevention
 	if (_collision_prevention.is_active()) {
-		_collision_prevention.modifySetpoint(vel_sp_xy, _constraints.speed_xy);
+		_collision_prevention.modifySetpoint(vel_sp_xy, _constraints.speed_xy, Vector2f(_position), _yaw);
 	}
 
 	_velocity_setpoint(0) = vel_sp_xy(0);
@@ -0,0 +1,279 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file Path.cpp
+ */
+
+#include "Path.hpp"
+
+#include <mathlib/mathlib.h>
+#include <px4_defines.h>
+
+#include <math.h>
+
+using matrix::Vector2f;
+using matrix::wrap_pi;
+
+namespace path
+{
+
+// segments shorter than this are dropped, and turns smaller than this are not rounded
+static constexpr float MIN_LENGTH = 0.01f;
+static constexpr float MIN_TURN_ANGLE = 0.001f;
+
+static float cross(const Vector2f &a, const Vector2f &b)
+{
+	return a(0) * b(1) - a(1) * b(0);
+}
+
+void
+Path::reset()
+{
+	_segment_count = 0;
+	_current = 0;
+
+	for (int i = 0; i < MAX_WAYPOINTS; i++) {
+		_turn_distance[i] = 0.f;
+	}
+}
+
+float
+Path::length() const
+{
+	if (_segment_count == 0) {
+		return 0.f;
+	}
+
+	const Segment &last = _segments[_segment_count - 1];
+	return last.s_start + last.length;
+}
+
+bool
+Path::build(const Vector2f waypoints[], int count, float turn_radius)
+{
+	reset();
+
+	if (count < 2 || count > MAX_WAYPOINTS || !(turn_radius >= 0.f)) {
+		return false;
+	}
+
+	Vector2f leg_dir[MAX_WAYPOINTS - 1];
+	float leg_length[MAX_WAYPOINTS - 1];
+
+	for (int i = 0; i < count - 1; i++) {
+		const Vector2f leg = waypoints[i + 1] - waypoints[i];
+		leg_length[i] = leg.norm();
+
+		if (!(leg_length[i] > MIN_LENGTH)) {
+			return false;
+		}
+
+		leg_dir[i] = leg / leg_length[i];
+	}
+
+	Vector2f cursor = waypoints[0];
+
+	for (int i = 1; i < count - 1; i++) {
+		const Vector2f &in = leg_dir[i - 1];
+		const Vector2f &out = leg_dir[i];
+		const float turn = atan2f(cross(in, out), in * out);
+		const float tan_half = tanf(fabsf(turn) * 0.5f);
+
+		if (fabsf(turn) < MIN_TURN_ANGLE || !PX4_ISFINITE(tan_half)) {
+			// straight on, or reversing on the same line which cannot be rounded
+			addLine(cursor, waypoints[i]);
+			cursor = waypoints[i];
+			continue;
+		}
+
+		// tangent points of the arc, at most half way along the legs so neighbouring corners do not overlap
+		const float distance = fminf(turn_radius * tan_half, 0.5f * fminf(leg_length[i - 1], leg_length[i]));
+		const float radius = distance / tan_half;
+		const float direction = turn > 0.f ? 1.f : -1.f;
+
+		const Vector2f arc_start = waypoints[i] - in * distance;
+		const Vector2f arc_end = waypoints[i] + out * distance;
+		const Vector2f center = arc_start + Vector2f(-in(1), in(0)) * (direction * radius);
+
+		addLine(cursor, arc_start);
+		addArc(arc_start, arc_end, center, radius, direction, fabsf(turn));
+
+		_turn_distance[i] = distance;
+		cursor = arc_end;
+	}
+
+	addLine(cursor, waypoints[count - 1]);
+
+	return _segment_count > 0;
+}
+
+void
+Path::addLine(const Vector2f &start, const Vector2f &end)
+{
+	const Vector2f line = end - start;
+	const float line_length = line.norm();
+
+	if (line_length < MIN_LENGTH || _segment_count >= MAX_SEGMENTS) {
+		return;
+	}
+
+	Segment &segment = _segments[_segment_count];
+	segment.start = start;
+	segment.end = end;
+	segment.tangent = line / line_length;
+	segment.center = Vector2f();
+	segment.radius = 0.f;
+	segment.direction = 0.f;
+	segment.angle_start = 0.f;
+	segment.length = line_length;
+	segment.s_start = length();
+
+	_segment_count++;
+}
+
+void
+Path::addArc(const Vector2f &start, const Vector2f &end, const Vector2f &center, float radius, float direction,
+	     float angle)
+{
+	if (radius * angle < MIN_LENGTH || _segment_count >= MAX_SEGMENTS) {
+		return;
+	}
+
+	const Vector2f from_center = start - center;
+
+	Segment &segment = _segments[_segment_count];
+	segment.start = start;
+	segment.end = end;
+	segment.tangent = Vector2f();
+	segment.center = center;
+	segment.radius = radius;
+	segment.direction = direction;
+	segment.angle_start = atan2f(from_center(1), from_center(0));
+	segment.length = radius * angle;
+	segment.s_start = length();
+
+	_segment_count++;
+}
+
+Path::Projection
+Path::projectOnSegment(int i, const Vector2f &position) const
+{
+	const Segment &segment = _segments[i];
+	Projection projection{};
+	projection.segment = i;
+
+	if (segment.radius > 0.f) {
+		const Vector2f from_center = position - segment.center;
+		const float arc_angle = segment.length / segment.radius;
+
+		// angle travelled along the arc, wrapped around the middle of the arc
+		const float angle = segment.direction * (atan2f(from_center(1), from_center(0)) - segment.angle_start);
+		const float along = math::constrain(wrap_pi(angle - 0.5f * arc_angle) + 0.5f * arc_angle, 0.f, arc_angle);
+
+		const float bearing = segment.angle_start + segment.direction * along;
+		const Vector2f radial(cosf(bearing), sinf(bearing));
+
+		projection.point = segment.center + radial * segment.radius;
+		projection.tangent = Vector2f(-radial(1), radial(0)) * segment.direction;
+		projection.s = segment.s_start + along * segment.radius;
+		projection.crosstrack = segment.direction * (segment.radius - from_center.norm());
+
+	} else {
+		const Vector2f from_start = position - segment.start;
+		const float along = math::constrain(from_start * segment.tangent, 0.f, segment.length);
+
+		projection.point = segment.start + segment.tangent * along;
+		projection.tangent = segment.tangent;
+		projection.s = segment.s_start + along;
+		projection.crosstrack = cross(segment.tangent, from_start);
+	}
+
+	return projection;
+}
+
+Path::Projection
+Path::project(const Vector2f &position)
+{
+	if (_segment_count == 0) {
+		return Projection{};
+	}
+
+	Projection projection = projectOnSegment(_current, position);
+
+	// move on once the end of the segment is passed, usually at most one step per cycle
+	while (_current < _segment_count - 1) {
+		const Segment &segment = _segments[_current];
+
+		if (projection.s < segment.s_start + segment.length - MIN_LENGTH) {
+			break;
+		}
+
+		_current++;
+		projection = projectOnSegment(_current, position);
+	}
+
+	return projection;
+}
+
+Vector2f
+Path::position(float s) const
+{
+	if (_segment_count == 0) {
+		return Vector2f();
+	}
+
+	s = math::constrain(s, 0.f, length());
+
+	int i = _current;
+
+	while (i > 0 && s < _segments[i].s_start) {
+		i--;
+	}
+
+	while (i < _segment_count - 1 && s > _segments[i].s_start + _segments[i].length) {
+		i++;
+	}
+
+	const Segment &segment = _segments[i];
+	const float along = s - segment.s_start;
+
+	if (segment.radius > 0.f) {
+		const float bearing = segment.angle_start + segment.direction * along / segment.radius;
+		return segment.center + Vector2f(cosf(bearing), sinf(bearing)) * segment.radius;
+	}
+
+	return segment.start + segment.tangent * along;
+}
+
+} // namespace path
@@ -0,0 +1,129 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file Path.hpp
+ *
+ * Arc length parameterised lateral path through a short window of waypoints.
+ *
+ * The corners between the straight legs are replaced by tangent circular arcs of the
+ * turn radius (the single turn case of a Dubins path), so a vehicle with a limited bank
+ * angle can follow the path without overshooting the corners. The path is only built
+ * when the waypoints change. Projecting the vehicle position starts at the segment of
+ * the previous projection and only moves forward, so tracking costs constant time per
+ * control cycle.
+ *
+ * All positions are in a local north/east frame in meters.
+ */
+
+#pragma once
+
+#include <matrix/math.hpp>
+
+namespace path
+{
+
+class Path
+{
+public:
+	static constexpr int MAX_WAYPOINTS = 4;
+	static constexpr int MAX_SEGMENTS = 2 * MAX_WAYPOINTS - 3;	///< legs plus corner arcs
+
+	struct Segment {
+		matrix::Vector2f start;
+		matrix::Vector2f end;
+		matrix::Vector2f tangent;	///< unit direction of a line
+		matrix::Vector2f center;	///< center of an arc
+		float radius;			///< radius of an arc, 0 for a line
+		float direction;		///< 1 for a clockwise (right) turn, -1 for a counter-clockwise turn
+		float angle_start;		///< angle of the arc start around the center, from north
+		float length;
+		float s_start;			///< arc length of the path at the start of the segment
+	};
+
+	struct Projection {
+		matrix::Vector2f point;		///< closest point on the path
+		matrix::Vector2f tangent;	///< unit tangent of the path at point
+		float s;			///< arc length of point
+		float crosstrack;		///< distance to the path, positive right of it
+		int segment;
+	};
+
+	Path() = default;
+	~Path() = default;
+
+	/**
+	 * Build the path through the waypoints.
+	 * @param waypoints local positions [m], consecutive waypoints must not coincide
+	 * @param count number of waypoints, 2..MAX_WAYPOINTS
+	 * @param turn_radius radius of the corner arcs [m], reduced where the legs are too short
+	 * @return false if the path could not be built
+	 */
+	bool build(const matrix::Vector2f waypoints[], int count, float turn_radius);
+
+	void reset();
+
+	bool valid() const { return _segment_count > 0; }
+
+	float length() const;
+
+	int segmentCount() const { return _segment_count; }
+	const Segment &segment(int i) const { return _segments[i]; }
+
+	/** distance between the start of the corner arc and the waypoint, 0 if the path does not turn there */
+	float turnDistance(int waypoint) const { return _turn_distance[waypoint]; }
+
+	/**
+	 * Closest point on the path, searching forward from the last projection.
+	 */
+	Projection project(const matrix::Vector2f &position);
+
+	/**
+	 * Point on the path at arc length s, clipped to the ends of the path.
+	 */
+	matrix::Vector2f position(float s) const;
+
+private:
+	void addLine(const matrix::Vector2f &start, const matrix::Vector2f &end);
+	void addArc(const matrix::Vector2f &start, const matrix::Vector2f &end, const matrix::Vector2f &center,
+		    float radius, float direction, float angle);
+
+	Projection projectOnSegment(int i, const matrix::Vector2f &position) const;
+
+	Segment _segments[MAX_SEGMENTS] {};
+	float _turn_distance[MAX_WAYPOINTS] {};
+	int _segment_count{0};
+	int _current{0};		///< segment of the last projection
+};
+
+} // namespace path
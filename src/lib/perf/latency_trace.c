@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file latency_trace.c
+ *
+ * End-to-end latency tracing from a sensor sample to the actuator outputs.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "latency_trace.h"
+
+#ifdef __PX4_QURT
+// There is presumably no dprintf on QURT. Therefore use the usual output to mini-dm.
+#define dprintf(_fd, _text, ...) ((_fd) == 1 ? PX4_INFO((_text), ##__VA_ARGS__) : (void)(_fd))
+#endif
+
+/* histogram bucket upper bounds [us] */
+__EXPORT const uint16_t latency_trace_buckets[LATENCY_TRACE_BUCKET_COUNT] = { 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
+
+static const char *const latency_trace_stage_names[LATENCY_TRACE_STAGE_COUNT] = {
+	"sensor_combined",
+	"vehicle_attitude",
+	"actuator_controls",
+	"actuator_outputs",
+};
+
+/**
+ * Histogram of one stage.
+ */
+struct latency_trace_histogram {
+	uint32_t		counters[LATENCY_TRACE_BUCKET_COUNT + 1]; /**< last one is the overflow bucket */
+	uint64_t		event_count;
+	uint64_t		time_total;
+	uint32_t		time_most;
+};
+
+// Each stage is normally recorded from a single thread, so the counters are not protected.
+// Concurrent readers can see a slightly inconsistent histogram, which is acceptable for
+// monitoring purposes (same as for the perf counters).
+static struct latency_trace_histogram latency_trace_histograms[LATENCY_TRACE_STAGE_COUNT];
+
+void
+latency_trace_record(enum latency_trace_stage stage, hrt_abstime timestamp_sample)
+{
+	if ((unsigned)stage >= LATENCY_TRACE_STAGE_COUNT || timestamp_sample == 0) {
+		return;
+	}
+
+	const hrt_abstime now = hrt_absolute_time();
+
+	if (now < timestamp_sample) {
+		return;
+	}
+
+	const uint32_t latency = (uint32_t)(now - timestamp_sample);
+	struct latency_trace_histogram *hist = &latency_trace_histograms[stage];
+
+	unsigned index = 0;
+
+	while (index < LATENCY_TRACE_BUCKET_COUNT && latency > latency_trace_buckets[index]) {
+		++index;
+	}
+
+	hist->counters[index]++;
+	hist->event_count++;
+	hist->time_total += latency;
+
+	if (latency > hist->time_most) {
+		hist->time_most = latency;
+	}
+}
+
+int
+latency_trace_print_buffer(char *buffer, int length, enum latency_trace_stage stage)
+{
+	if ((unsigned)stage >= LATENCY_TRACE_STAGE_COUNT || length <= 0) {
+		return 0;
+	}
+
+	const struct latency_trace_histogram *hist = &latency_trace_histograms[stage];
+
+	int num_written = snprintf(buffer, length, "%s: %llu events, %.2fus avg, max %luus, buckets [us]:",
+				   latency_trace_stage_names[stage],
+				   (unsigned long long)hist->event_count,
+				   (hist->event_count == 0) ? 0 : (double)hist->time_total / (double)hist->event_count,
+				   (unsigned long)hist->time_most);
+
+	for (int i = 0; i <= LATENCY_TRACE_BUCKET_COUNT && num_written < length; i++) {
+		if (i < LATENCY_TRACE_BUCKET_COUNT) {
+			num_written += snprintf(buffer + num_written, length - num_written, " %u:%lu",
+						latency_trace_buckets[i], (unsigned long)hist->counters[i]);
+
+		} else {
+			num_written += snprintf(buffer + num_written, length - num_written, " >%u:%lu",
+						latency_trace_buckets[i - 1], (unsigned long)hist->counters[i]);
+		}
+	}
+
+	buffer[length - 1] = 0; // ensure 0-termination
+	return num_written;
+}
+
+void
+latency_trace_print(int fd)
+{
+	for (int stage = 0; stage < LATENCY_TRACE_STAGE_COUNT; stage++) {
+		const struct latency_trace_histogram *hist = &latency_trace_histograms[stage];
+
+		dprintf(fd, "%s: %llu events, %.2fus avg, max %luus\n",
+			latency_trace_stage_names[stage],
+			(unsigned long long)hist->event_count,
+			(hist->event_count == 0) ? 0 : (double)hist->time_total / (double)hist->event_count,
+			(unsigned long)hist->time_most);
+
+		dprintf(fd, "  bucket [us] : events\n");
+
+		for (int i = 0; i < LATENCY_TRACE_BUCKET_COUNT; i++) {
+			dprintf(fd, "        %5u : %lu\n", latency_trace_buckets[i], (unsigned long)hist->counters[i]);
+		}
+
+		// print the overflow bucket value
+		dprintf(fd, "       >%5u : %lu\n", latency_trace_buckets[LATENCY_TRACE_BUCKET_COUNT - 1],
+			(unsigned long)hist->counters[LATENCY_TRACE_BUCKET_COUNT]);
+	}
+}
+
+void
+latency_trace_reset(void)
+{
+	memset(latency_trace_histograms, 0, sizeof(latency_trace_histograms));
+}
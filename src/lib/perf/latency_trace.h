@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file latency_trace.h
+ * End-to-end latency tracing from a sensor sample to the actuator outputs.
+ *
+ * Every stage of the control path (sensors -> estimator -> controller -> output driver)
+ * records the age of the sample its output is based on (the sample-origin timestamp
+ * carried in sensor_combined.timestamp, vehicle_attitude.timestamp_sample and
+ * actuator_controls.timestamp_sample) into a per-stage histogram.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <px4_defines.h>
+#include <drivers/drv_hrt.h>
+
+#define LATENCY_TRACE_BUCKET_COUNT 8
+
+/**
+ * Stages of the sensor to actuator path.
+ */
+enum latency_trace_stage {
+	LATENCY_TRACE_SENSOR_COMBINED,		/**< sensors publishes sensor_combined */
+	LATENCY_TRACE_VEHICLE_ATTITUDE,		/**< estimator publishes vehicle_attitude */
+	LATENCY_TRACE_ACTUATOR_CONTROLS,	/**< attitude controller publishes actuator_controls */
+	LATENCY_TRACE_ACTUATOR_OUTPUTS,		/**< output driver has written the outputs */
+	LATENCY_TRACE_STAGE_COUNT
+};
+
+__BEGIN_DECLS
+
+extern const uint16_t latency_trace_buckets[LATENCY_TRACE_BUCKET_COUNT];
+
+/**
+ * Record the latency of a stage.
+ *
+ * @param stage			The stage that has just finished processing the sample.
+ * @param timestamp_sample	Sample-origin timestamp the output of the stage is based on.
+ *				A value of 0 is ignored.
+ */
+__EXPORT extern void		latency_trace_record(enum latency_trace_stage stage, hrt_abstime timestamp_sample);
+
+/**
+ * Print the latency histograms of all stages.
+ *
+ * @param fd			File descriptor to print to - e.g. 1 for stdout
+ */
+__EXPORT extern void		latency_trace_print(int fd);
+
+/**
+ * Print the latency histogram of one stage to a buffer.
+ *
+ * @param buffer		buffer to write to
+ * @param length		buffer length
+ * @param stage			The stage to print.
+ * @return			number of bytes written
+ */
+__EXPORT extern int		latency_trace_print_buffer(char *buffer, int length, enum latency_trace_stage stage);
+
+/**
+ * Reset the latency histograms of all stages.
+ */
+__EXPORT extern void		latency_trace_reset(void);
+
+__END_DECLS
@@ -44,9 +44,13 @@
 #include <drivers/drv_hrt.h>
 #include <math.h>
 #include <pthread.h>
+#include <stdbool.h>
+#include <unistd.h>
 #include <systemlib/err.h>
+#include <px4_micro_hal.h>
 
 #include "perf_counter.h"
+#include "latency_trace.h"
 
 /* latency histogram */
 __EXPORT const uint16_t latency_bucket_count = LATENCY_BUCKET_COUNT;
@@ -105,6 +109,32 @@ struct perf_ctr_interval {
 	float			M2;
 };
 
+/**
+ * Per-thread shard of a PC_HISTOGRAM counter.
+ *
+ * A shard is claimed by a thread on its first update and afterwards only written by
+ * that thread, so no locking is needed. Readers merge all shards. If more threads
+ * than shards update the same counter, the remaining threads share the last shard,
+ * which is then updated atomically (the begin/end pairing is not exact in that case,
+ * as the threads share time_start).
+ */
+struct perf_histogram_shard {
+	uint32_t		owner;		/**< id of the owning thread, 0 if unused */
+	uint32_t		event_count;
+	uint64_t		time_start;
+	uint64_t		time_total;
+	uint32_t		time_most;
+	uint32_t		buckets[PERF_HISTOGRAM_BUCKET_COUNT];
+};
+
+/**
+ * PC_HISTOGRAM counter.
+ */
+struct perf_ctr_histogram {
+	struct perf_ctr_header	hdr;
+	struct perf_histogram_shard shards[PERF_HISTOGRAM_SHARD_COUNT];
+};
+
 /**
  * List of all known counters.
  */
@@ -120,6 +150,8 @@ pthread_mutex_t perf_counters_mutex = PTHREAD_MUTEX_INITIALIZER;
 // (especially the 64bit values which are in general not atomically updated).
 // The same holds for shared perf counters (perf_alloc_once), that can be updated
 // concurrently (this affects the 'ctrl_latency' counter).
+// PC_HISTOGRAM counters do not have this problem for updates, as each thread
+// writes to its own shard.
 
 
 perf_counter_t
@@ -141,6 +173,10 @@ perf_alloc(enum perf_counter_type type, const char *name)
 
 		break;
 
+	case PC_HISTOGRAM:
+		ctr = (perf_counter_t)calloc(sizeof(struct perf_ctr_histogram), 1);
+		break;
+
 	default:
 		break;
 	}
@@ -198,6 +234,174 @@ perf_free(perf_counter_t handle)
 	free(handle);
 }
 
+/**
+ * Get a non-zero id of the calling thread.
+ */
+static inline uint32_t
+perf_thread_id(void)
+{
+#if defined(__PX4_NUTTX)
+	return (uint32_t)getpid() + 1;
+#else
+	// numbered on first use: a hash of pthread_self() can give two threads the same shard
+	static uint32_t next_id = 0;
+	static __thread uint32_t id = 0;
+
+	if (id == 0) {
+		id = __atomic_add_fetch(&next_id, 1, __ATOMIC_RELAXED);
+	}
+
+	return id;
+#endif
+}
+
+/**
+ * Get the shard of the calling thread, claiming a free one if needed.
+ *
+ * @param shared	set to true if all shards are owned by other threads, in which
+ *			case the last shard is returned and must be updated atomically.
+ */
+static struct perf_histogram_shard *
+perf_histogram_get_shard(struct perf_ctr_histogram *pch, bool *shared)
+{
+	const uint32_t self = perf_thread_id();
+
+	for (int i = 0; i < PERF_HISTOGRAM_SHARD_COUNT; i++) {
+		struct perf_histogram_shard *shard = &pch->shards[i];
+		uint32_t owner = __atomic_load_n(&shard->owner, __ATOMIC_ACQUIRE);
+
+		if (owner == 0) {
+			// try to claim it (another thread might be faster)
+			__atomic_compare_exchange_n(&shard->owner, &owner, self, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+			owner = __atomic_load_n(&shard->owner, __ATOMIC_ACQUIRE);
+		}
+
+		if (owner == self) {
+			*shared = false;
+			return shard;
+		}
+	}
+
+	*shared = true;
+	return &pch->shards[PERF_HISTOGRAM_SHARD_COUNT - 1];
+}
+
+static inline unsigned
+perf_histogram_bucket(uint32_t elapsed)
+{
+	if (elapsed == 0) {
+		return 0;
+	}
+
+	const unsigned bucket = 32 - __builtin_clz(elapsed);
+	return (bucket < PERF_HISTOGRAM_BUCKET_COUNT) ? bucket : PERF_HISTOGRAM_BUCKET_COUNT - 1;
+}
+
+static void
+perf_histogram_record(struct perf_histogram_shard *shard, bool shared, int64_t elapsed)
+{
+	if (elapsed < 0) {
+		return;
+	}
+
+	const uint32_t elapsed_us = (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed;
+	const unsigned bucket = perf_histogram_bucket(elapsed_us);
+
+	if (shared) {
+		__atomic_fetch_add(&shard->buckets[bucket], 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&shard->event_count, 1, __ATOMIC_RELAXED);
+
+#if defined(__PX4_NUTTX)
+		// no 64 bit atomics on Cortex-M
+		irqstate_t flags = px4_enter_critical_section();
+		shard->time_total += elapsed_us;
+		px4_leave_critical_section(flags);
+#else
+		__atomic_fetch_add(&shard->time_total, elapsed_us, __ATOMIC_RELAXED);
+#endif
+
+		uint32_t most = __atomic_load_n(&shard->time_most, __ATOMIC_RELAXED);
+
+		while (elapsed_us > most && !__atomic_compare_exchange_n(&shard->time_most, &most, elapsed_us, true,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		}
+
+	} else {
+		shard->buckets[bucket]++;
+		shard->event_count++;
+		shard->time_total += elapsed_us;
+
+		if (elapsed_us > shard->time_most) {
+			shard->time_most = elapsed_us;
+		}
+	}
+}
+
+/**
+ * Merge all shards of a PC_HISTOGRAM counter (the owner field of the result is unused).
+ */
+static void
+perf_histogram_merge(const struct perf_ctr_histogram *pch, struct perf_histogram_shard *merged)
+{
+	memset(merged, 0, sizeof(*merged));
+
+	for (int i = 0; i < PERF_HISTOGRAM_SHARD_COUNT; i++) {
+		const struct perf_histogram_shard *shard = &pch->shards[i];
+
+		merged->event_count += shard->event_count;
+		merged->time_total += shard->time_total;
+
+		if (shard->time_most > merged->time_most) {
+			merged->time_most = shard->time_most;
+		}
+
+		for (int b = 0; b < PERF_HISTOGRAM_BUCKET_COUNT; b++) {
+			merged->buckets[b] += shard->buckets[b];
+		}
+	}
+}
+
+static uint32_t
+perf_histogram_merged_percentile(const struct perf_histogram_shard *merged, float percentile)
+{
+	uint32_t bucket_events = 0;
+
+	for (int b = 0; b < PERF_HISTOGRAM_BUCKET_COUNT; b++) {
+		bucket_events += merged->buckets[b];
+	}
+
+	if (bucket_events == 0) {
+		return 0;
+	}
+
+	const float target = percentile * bucket_events;
+	uint32_t cumulative = 0;
+
+	for (int b = 0; b < PERF_HISTOGRAM_BUCKET_COUNT; b++) {
+		const uint32_t count = merged->buckets[b];
+
+		if (count > 0 && cumulative + count >= target) {
+			const uint32_t lower = (b == 0) ? 0 : (1u << (b - 1));
+			uint32_t upper = (b == PERF_HISTOGRAM_BUCKET_COUNT - 1) ? merged->time_most : (1u << b);
+
+			if (upper > merged->time_most) {
+				upper = merged->time_most;
+			}
+
+			if (upper < lower) {
+				upper = lower;
+			}
+
+			const float fraction = (target - cumulative) / count;
+			return lower + (uint32_t)(fraction * (upper - lower));
+		}
+
+		cumulative += count;
+	}
+
+	return merged->time_most;
+}
+
 void
 perf_count(perf_counter_t handle)
 {
@@ -269,6 +473,13 @@ perf_begin(perf_counter_t handle)
 		((struct perf_ctr_elapsed *)handle)->time_start = hrt_absolute_time();
 		break;
 
+	case PC_HISTOGRAM: {
+			bool shared;
+			struct perf_histogram_shard *shard = perf_histogram_get_shard((struct perf_ctr_histogram *)handle, &shared);
+			shard->time_start = hrt_absolute_time();
+			break;
+		}
+
 	default:
 		break;
 	}
@@ -314,6 +525,17 @@ perf_end(perf_counter_t handle)
 		}
 		break;
 
+	case PC_HISTOGRAM: {
+			bool shared;
+			struct perf_histogram_shard *shard = perf_histogram_get_shard((struct perf_ctr_histogram *)handle, &shared);
+
+			if (shard->time_start != 0) {
+				perf_histogram_record(shard, shared, hrt_absolute_time() - shard->time_start);
+				shard->time_start = 0;
+			}
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -355,6 +577,13 @@ perf_set_elapsed(perf_counter_t handle, int64_t elapsed)
 		}
 		break;
 
+	case PC_HISTOGRAM: {
+			bool shared;
+			struct perf_histogram_shard *shard = perf_histogram_get_shard((struct perf_ctr_histogram *)handle, &shared);
+			perf_histogram_record(shard, shared, elapsed);
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -394,6 +623,13 @@ perf_cancel(perf_counter_t handle)
 		}
 		break;
 
+	case PC_HISTOGRAM: {
+			bool shared;
+			struct perf_histogram_shard *shard = perf_histogram_get_shard((struct perf_ctr_histogram *)handle, &shared);
+			shard->time_start = 0;
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -433,6 +669,22 @@ perf_reset(perf_counter_t handle)
 			pci->time_most = 0;
 			break;
 		}
+
+	case PC_HISTOGRAM: {
+			struct perf_ctr_histogram *pch = (struct perf_ctr_histogram *)handle;
+
+			// keep the shard owners, so that threads keep their shard
+			for (int i = 0; i < PERF_HISTOGRAM_SHARD_COUNT; i++) {
+				struct perf_histogram_shard *shard = &pch->shards[i];
+				shard->event_count = 0;
+				shard->time_start = 0;
+				shard->time_total = 0;
+				shard->time_most = 0;
+				memset(shard->buckets, 0, sizeof(shard->buckets));
+			}
+
+			break;
+		}
 	}
 }
 
@@ -488,6 +740,22 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 			break;
 		}
 
+	case PC_HISTOGRAM: {
+			struct perf_histogram_shard merged;
+			perf_histogram_merge((struct perf_ctr_histogram *)handle, &merged);
+
+			dprintf(fd, "%s: %llu events, %lluus elapsed, %.2fus avg, max %lluus, p50 %luus p99 %luus p99.9 %luus\n",
+				handle->name,
+				(unsigned long long)merged.event_count,
+				(unsigned long long)merged.time_total,
+				(merged.event_count == 0) ? 0 : (double)merged.time_total / (double)merged.event_count,
+				(unsigned long long)merged.time_most,
+				(unsigned long)perf_histogram_merged_percentile(&merged, 0.5f),
+				(unsigned long)perf_histogram_merged_percentile(&merged, 0.99f),
+				(unsigned long)perf_histogram_merged_percentile(&merged, 0.999f));
+			break;
+		}
+
 	default:
 		break;
 	}
@@ -538,6 +806,23 @@ perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle)
 			break;
 		}
 
+	case PC_HISTOGRAM: {
+			struct perf_histogram_shard merged;
+			perf_histogram_merge((struct perf_ctr_histogram *)handle, &merged);
+
+			num_written = snprintf(buffer, length,
+					       "%s: %llu events, %lluus elapsed, %.2fus avg, max %lluus, p50 %luus p99 %luus p99.9 %luus",
+					       handle->name,
+					       (unsigned long long)merged.event_count,
+					       (unsigned long long)merged.time_total,
+					       (merged.event_count == 0) ? 0 : (double)merged.time_total / (double)merged.event_count,
+					       (unsigned long long)merged.time_most,
+					       (unsigned long)perf_histogram_merged_percentile(&merged, 0.5f),
+					       (unsigned long)perf_histogram_merged_percentile(&merged, 0.99f),
+					       (unsigned long)perf_histogram_merged_percentile(&merged, 0.999f));
+			break;
+		}
+
 	default:
 		break;
 	}
@@ -567,6 +852,12 @@ perf_event_count(perf_counter_t handle)
 			return pci->event_count;
 		}
 
+	case PC_HISTOGRAM: {
+			struct perf_histogram_shard merged;
+			perf_histogram_merge((struct perf_ctr_histogram *)handle, &merged);
+			return merged.event_count;
+		}
+
 	default:
 		break;
 	}
@@ -574,6 +865,19 @@ perf_event_count(perf_counter_t handle)
 	return 0;
 }
 
+uint32_t
+perf_histogram_percentile(perf_counter_t handle, float percentile)
+{
+	if (handle == NULL || handle->type != PC_HISTOGRAM) {
+		return 0;
+	}
+
+	struct perf_histogram_shard merged;
+	perf_histogram_merge((struct perf_ctr_histogram *)handle, &merged);
+
+	return perf_histogram_merged_percentile(&merged, percentile);
+}
+
 void
 perf_iterate_all(perf_callback cb, void *user)
 {
@@ -631,4 +935,6 @@ perf_reset_all(void)
 	for (int i = 0; i <= latency_bucket_count; i++) {
 		latency_counters[i] = 0;
 	}
+
+	latency_trace_reset();
 }
@@ -44,6 +44,9 @@
 
 #define LATENCY_BUCKET_COUNT 8
 
+#define PERF_HISTOGRAM_BUCKET_COUNT 24	/**< log2 buckets: [0, 1us), [1us, 2us), [2us, 4us), ..., [2^22us, inf) */
+#define PERF_HISTOGRAM_SHARD_COUNT 4	/**< number of per-thread shards of a PC_HISTOGRAM counter */
+
 extern const uint16_t latency_bucket_count;
 extern const uint16_t latency_buckets[LATENCY_BUCKET_COUNT];
 extern uint32_t latency_counters[LATENCY_BUCKET_COUNT + 1];
@@ -54,7 +57,9 @@ extern uint32_t latency_counters[LATENCY_BUCKET_COUNT + 1];
 enum perf_counter_type {
 	PC_COUNT,		/**< count the number of times an event occurs */
 	PC_ELAPSED,		/**< measure the time elapsed performing an event */
-	PC_INTERVAL		/**< measure the interval between instances of an event */
+	PC_INTERVAL,		/**< measure the interval between instances of an event */
+	PC_HISTOGRAM		/**< measure the time elapsed performing an event into a log2 histogram,
+				     with per-thread shards so that updates are lock-free */
 };
 
 struct perf_ctr_header;
@@ -216,10 +221,22 @@ __EXPORT extern void	perf_iterate_all(perf_callback cb, void *user);
 __EXPORT extern void		perf_print_latency(int fd);
 
 /**
- * Reset all of the performance counters.
+ * Reset all of the performance counters (including the latency trace histograms).
  */
 __EXPORT extern void		perf_reset_all(void);
 
+/**
+ * Get a percentile of a PC_HISTOGRAM counter.
+ *
+ * The shards of all threads are merged and the value is linearly interpolated
+ * within the log2 bucket containing the percentile.
+ *
+ * @param handle		The counter returned from perf_alloc.
+ * @param percentile		Percentile in [0, 1], e.g. 0.99 for p99.
+ * @return			The elapsed time at the percentile in us, 0 if there are no events.
+ */
+__EXPORT extern uint32_t	perf_histogram_percentile(perf_counter_t handle, float percentile);
+
 /**
  * Return current event_count
  *
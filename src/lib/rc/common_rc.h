@@ -13,10 +13,18 @@
 typedef  struct rc_decode_buf_ {
 	union {
 		crsf_frame_t crsf_frame;
-		dsm_decode_t dsm;
 		sbus_frame_t sbus_frame;
-		ReceiverFcPacket _strxpacket;
-		ReceiverFcPacketHoTT _hottrxpacket;
+
+		/*
+		 * DSM, ST24 and SUMD share the same serial configuration and are
+		 * fed the same bytes while autodetecting, so they must not share
+		 * their receive buffers with each other.
+		 */
+		struct {
+			dsm_decode_t dsm;
+			ReceiverFcPacket _strxpacket;
+			ReceiverFcPacketHoTT _hottrxpacket;
+		};
 	};
 } rc_decode_buf_t;
 #pragma pack(pop)
@@ -3,6 +3,7 @@
 #include <systemlib/err.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -36,6 +37,14 @@ private:
 	bool sbus2Test();
 	bool st24Test();
 	bool sumdTest();
+	bool sbusDecodeTest();
+	bool fuzzTest();
+	bool throughputTest();
+
+	/* encode 16 11 bit channel values into a S.bus frame */
+	static void sbusEncode(const uint16_t *raw, uint8_t *frame);
+	/* reference scaling of the original floating point S.bus decoder */
+	static uint16_t sbusScale(uint16_t raw) { return (uint16_t)(raw * 0.625f + .5f) + 874; }
 };
 
 bool RCTest::run_tests()
@@ -46,6 +55,9 @@ bool RCTest::run_tests()
 	ut_run_test(sbus2Test);
 	ut_run_test(st24Test);
 	ut_run_test(sumdTest);
+	ut_run_test(sbusDecodeTest);
+	ut_run_test(fuzzTest);
+	ut_run_test(throughputTest);
 
 	return (_tests_failed == 0);
 }
@@ -415,6 +427,206 @@ bool RCTest::sumdTest()
 }
 
 
+void RCTest::sbusEncode(const uint16_t *raw, uint8_t *frame)
+{
+	memset(frame, 0, SBUS_FRAME_SIZE);
+	frame[0] = 0x0f;
+
+	for (unsigned i = 0; i < 16; i++) {
+		for (unsigned bit = 0; bit < 11; bit++) {
+			if (raw[i] & (1 << bit)) {
+				unsigned pos = 11 * i + bit;
+				frame[1 + pos / 8] |= 1 << (pos % 8);
+			}
+		}
+	}
+
+	/* flags (no failsafe, no frame lost) and S.bus 1 end marker */
+	frame[23] = 0;
+	frame[24] = 0;
+}
+
+bool RCTest::sbusDecodeTest()
+{
+	uint8_t frame[SBUS_FRAME_SIZE];
+	uint16_t raw[16];
+	uint16_t rc_values[18];
+	uint16_t num_values = 0;
+	bool sbus_failsafe = false;
+	bool sbus_frame_drop = false;
+	unsigned sbus_frame_drops = 0;
+
+	srand(1234);
+
+	for (unsigned n = 0; n < 1000; n++) {
+
+		for (unsigned i = 0; i < 16; i++) {
+			raw[i] = rand() & 0x7ff;
+		}
+
+		sbusEncode(raw, frame);
+
+		// feed the frame a few times in uneven chunks so the parser has to (re)sync on it
+		bool result = false;
+
+		for (unsigned rep = 0; rep < 3; rep++) {
+			unsigned offset = 0;
+
+			while (offset < SBUS_FRAME_SIZE) {
+				unsigned len = 1 + (rand() % 10);
+
+				if (len > SBUS_FRAME_SIZE - offset) {
+					len = SBUS_FRAME_SIZE - offset;
+				}
+
+				result = sbus_parse(hrt_absolute_time(), &frame[offset], len, rc_values, &num_values,
+						    &sbus_failsafe, &sbus_frame_drop, &sbus_frame_drops, 18);
+				offset += len;
+			}
+		}
+
+		ut_test(result);
+		ut_compare("num_values", num_values, 18);
+		ut_test(!sbus_failsafe && !sbus_frame_drop);
+
+		for (unsigned i = 0; i < 16; i++) {
+			if (rc_values[i] != sbusScale(raw[i])) {
+				PX4_ERR("frame %u, channel %u: raw %u", n, i, raw[i]);
+				ut_compare("decoded channel", rc_values[i], sbusScale(raw[i]));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool RCTest::fuzzTest()
+{
+	// random buffers in random chunk sizes through every parser, they must neither crash nor
+	// report more channels than asked for or values outside of what the protocols can encode
+	const unsigned iterations = 20000;
+	uint8_t buf[SBUS_BUFFER_SIZE * 2];
+	uint16_t rc_values[32];
+	uint16_t num_values = 0;
+	bool failsafe, frame_drop, dsm_11_bit;
+	unsigned frame_drops;
+	int8_t dsm_rssi;
+	uint8_t rssi, count;
+
+	srand(4321);
+	dsm_proto_init();
+
+	for (unsigned n = 0; n < iterations; n++) {
+		unsigned len = rand() % sizeof(buf);
+
+		for (unsigned i = 0; i < len; i++) {
+			buf[i] = rand();
+		}
+
+		// bias towards the protocol start bytes so the state machines get past sync
+		if (len > 0) {
+			const uint8_t starts[] = { 0x0f, 0x55, 0xa8, 0xc8 };
+			buf[rand() % len] = starts[rand() % sizeof(starts)];
+		}
+
+		const hrt_abstime now = hrt_absolute_time();
+		num_values = 0;
+
+		if (sbus_parse(now, buf, len, rc_values, &num_values, &failsafe, &frame_drop, &frame_drops, 16)) {
+			ut_test(num_values <= 16);
+
+			for (unsigned i = 0; i < num_values; i++) {
+				ut_test(rc_values[i] >= 874 && rc_values[i] <= 2153);
+			}
+		}
+
+		num_values = 0;
+
+		if (dsm_parse(now, buf, len, rc_values, &num_values, &dsm_11_bit, &frame_drops, &dsm_rssi, 12)) {
+			ut_test(num_values <= 12);
+		}
+
+		num_values = 0;
+
+		if (st24_parse(buf, len, &rssi, &count, &num_values, rc_values, 12)) {
+			ut_test(num_values <= 12);
+		}
+
+		num_values = 0;
+
+		if (sumd_parse(buf, len, &rssi, &count, &num_values, rc_values, 16, &failsafe)) {
+			ut_test(num_values <= 16);
+		}
+
+		num_values = 0;
+
+		if (crsf_parse(now, buf, len, rc_values, &num_values, 16)) {
+			ut_test(num_values <= 16);
+		}
+	}
+
+	return true;
+}
+
+bool RCTest::throughputTest()
+{
+	// S.bus frames back to back in UART sized chunks, the common case on a locked link
+	const unsigned frames = 10000;
+	const unsigned chunk = 16;
+	uint8_t stream[SBUS_FRAME_SIZE * 8];
+	uint16_t raw[16];
+	uint16_t rc_values[18];
+	uint16_t num_values = 0;
+	bool sbus_failsafe, sbus_frame_drop;
+	unsigned sbus_frame_drops = 0;
+
+	for (unsigned f = 0; f < 8; f++) {
+		for (unsigned i = 0; i < 16; i++) {
+			raw[i] = (f * 16 + i) * 13;
+		}
+
+		sbusEncode(raw, &stream[f * SBUS_FRAME_SIZE]);
+	}
+
+	unsigned decoded = 0;
+	hrt_abstime start = hrt_absolute_time();
+
+	for (unsigned n = 0; n < frames / 8; n++) {
+		for (unsigned offset = 0; offset < sizeof(stream); offset += chunk) {
+			unsigned len = (sizeof(stream) - offset < chunk) ? sizeof(stream) - offset : chunk;
+
+			if (sbus_parse(start, &stream[offset], len, rc_values, &num_values,
+				       &sbus_failsafe, &sbus_frame_drop, &sbus_frame_drops, 18)) {
+				decoded++;
+			}
+		}
+	}
+
+	hrt_abstime elapsed = hrt_elapsed_time(&start);
+
+	PX4_INFO("sbus: %u frames in %llu us (%.3f us/frame)", decoded, (unsigned long long)elapsed,
+		 (double)elapsed / (double)frames);
+
+	// everything after the first frame is decoded, the first one may be needed to sync
+	ut_test(decoded >= frames - 1);
+
+	// the same amount of bytes through the serial parsers that share the DSM port
+	const unsigned bytes = frames * SBUS_FRAME_SIZE;
+	uint8_t rssi, count;
+	bool failsafe;
+	start = hrt_absolute_time();
+
+	for (unsigned n = 0; n < bytes / sizeof(stream); n++) {
+		st24_parse(stream, sizeof(stream), &rssi, &count, &num_values, rc_values, 18);
+		sumd_parse(stream, sizeof(stream), &rssi, &count, &num_values, rc_values, 18, &failsafe);
+	}
+
+	elapsed = hrt_elapsed_time(&start);
+
+	PX4_INFO("st24 + sumd: %u bytes in %llu us", bytes, (unsigned long long)elapsed);
+
+	return true;
+}
 
 ut_declare_test_c(rc_tests_main, RCTest)
 
@@ -100,6 +100,10 @@ using namespace time_literals;
 #define SBUS_SCALE_FACTOR ((SBUS_TARGET_MAX - SBUS_TARGET_MIN) / (SBUS_RANGE_MAX - SBUS_RANGE_MIN))
 #define SBUS_SCALE_OFFSET (int)(SBUS_TARGET_MIN - (SBUS_SCALE_FACTOR * SBUS_RANGE_MIN + 0.5f))
 
+/* integer ratio of SBUS_SCALE_FACTOR, used on the decode path */
+#define SBUS_SCALE_NUM 5
+#define SBUS_SCALE_DEN 8
+
 static hrt_abstime last_rx_time;
 static hrt_abstime last_txframe_time = 0;
 
@@ -386,8 +390,16 @@ sbus_parse(uint64_t now, uint8_t *frame, unsigned len, uint16_t *values,
 		switch (sbus_decode_state) {
 		case SBUS2_DECODE_STATE_DESYNC:
 
-			/* we are de-synced and only interested in the frame marker */
-			if (frame[d] == SBUS_START_SYMBOL) {
+			/* we are de-synced and only interested in the frame marker, skip ahead to it */
+			{
+				const uint8_t *marker = (const uint8_t *)memchr(&frame[d], SBUS_START_SYMBOL, len - d);
+
+				if (marker == nullptr) {
+					d = len;
+					break;
+				}
+
+				d = marker - frame;
 				sbus_decode_state = SBUS2_DECODE_STATE_SBUS_START;
 				partial_frame_count = 0;
 				sbus_frame[partial_frame_count++] = frame[d];
@@ -401,7 +413,16 @@ sbus_parse(uint64_t now, uint8_t *frame, unsigned len, uint16_t *values,
 
 		/* fall through */
 		case SBUS2_DECODE_STATE_SBUS2_SYNC: {
-				sbus_frame[partial_frame_count++] = frame[d];
+				/* copy as much of the frame as this buffer holds in one go */
+				unsigned n = SBUS_FRAME_SIZE - partial_frame_count;
+
+				if (n > len - d) {
+					n = len - d;
+				}
+
+				memcpy(&sbus_frame[partial_frame_count], &frame[d], n);
+				partial_frame_count += n;
+				d += n - 1;
 
 				/* decode whatever we got and expect */
 				if (partial_frame_count < SBUS_FRAME_SIZE) {
@@ -545,40 +566,15 @@ sbus_parse(uint64_t now, uint8_t *frame, unsigned len, uint16_t *values,
 }
 
 /*
- * S.bus decoder matrix.
- *
- * Each channel value can come from up to 3 input bytes. Each row in the
- * matrix describes up to three bytes, and each entry gives:
- *
- * - byte offset in the data portion of the frame
- * - right shift applied to the data byte
- * - mask for the data byte
- * - left shift applied to the result into the channel value
+ * S.bus channel data is a little-endian bit stream of 16 11-bit values
+ * starting at frame byte 1. Channel n starts at bit 11 * n, so every value
+ * is contained in the three bytes starting at byte (11 * n) / 8 and can be
+ * extracted with a single shift and mask. The pattern repeats every 8
+ * channels (11 bytes), the tables hold byte offset and shift for one period.
+ * The last channel reads one byte into the flags, which is masked off.
  */
-struct sbus_bit_pick {
-	uint8_t byte;
-	uint8_t rshift;
-	uint8_t mask;
-	uint8_t lshift;
-};
-static const struct sbus_bit_pick sbus_decoder[SBUS_INPUT_CHANNELS][3] = {
-	/*  0 */ { { 0, 0, 0xff, 0}, { 1, 0, 0x07, 8}, { 0, 0, 0x00,  0} },
-	/*  1 */ { { 1, 3, 0x1f, 0}, { 2, 0, 0x3f, 5}, { 0, 0, 0x00,  0} },
-	/*  2 */ { { 2, 6, 0x03, 0}, { 3, 0, 0xff, 2}, { 4, 0, 0x01, 10} },
-	/*  3 */ { { 4, 1, 0x7f, 0}, { 5, 0, 0x0f, 7}, { 0, 0, 0x00,  0} },
-	/*  4 */ { { 5, 4, 0x0f, 0}, { 6, 0, 0x7f, 4}, { 0, 0, 0x00,  0} },
-	/*  5 */ { { 6, 7, 0x01, 0}, { 7, 0, 0xff, 1}, { 8, 0, 0x03,  9} },
-	/*  6 */ { { 8, 2, 0x3f, 0}, { 9, 0, 0x1f, 6}, { 0, 0, 0x00,  0} },
-	/*  7 */ { { 9, 5, 0x07, 0}, {10, 0, 0xff, 3}, { 0, 0, 0x00,  0} },
-	/*  8 */ { {11, 0, 0xff, 0}, {12, 0, 0x07, 8}, { 0, 0, 0x00,  0} },
-	/*  9 */ { {12, 3, 0x1f, 0}, {13, 0, 0x3f, 5}, { 0, 0, 0x00,  0} },
-	/* 10 */ { {13, 6, 0x03, 0}, {14, 0, 0xff, 2}, {15, 0, 0x01, 10} },
-	/* 11 */ { {15, 1, 0x7f, 0}, {16, 0, 0x0f, 7}, { 0, 0, 0x00,  0} },
-	/* 12 */ { {16, 4, 0x0f, 0}, {17, 0, 0x7f, 4}, { 0, 0, 0x00,  0} },
-	/* 13 */ { {17, 7, 0x01, 0}, {18, 0, 0xff, 1}, {19, 0, 0x03,  9} },
-	/* 14 */ { {19, 2, 0x3f, 0}, {20, 0, 0x1f, 6}, { 0, 0, 0x00,  0} },
-	/* 15 */ { {20, 5, 0x07, 0}, {21, 0, 0xff, 3}, { 0, 0, 0x00,  0} }
-};
+static const uint8_t sbus_channel_shift[8] = { 0, 3, 6, 1, 4, 7, 2, 5 };
+static const uint8_t sbus_channel_byte[8] = { 0, 1, 2, 4, 5, 6, 8, 9 };
 
 bool
 sbus_decode(uint64_t frame_time, uint8_t *frame, uint16_t *values, uint16_t *num_values,
@@ -640,26 +636,13 @@ sbus_decode(uint64_t frame_time, uint8_t *frame, uint16_t *values, uint16_t *num
 	unsigned chancount = (max_values > SBUS_INPUT_CHANNELS) ?
 			     SBUS_INPUT_CHANNELS : max_values;
 
-	/* use the decoder matrix to extract channel data */
+	/* extract channel data */
 	for (unsigned channel = 0; channel < chancount; channel++) {
-		unsigned value = 0;
-
-		for (unsigned pick = 0; pick < 3; pick++) {
-			const struct sbus_bit_pick *decode = &sbus_decoder[channel][pick];
-
-			if (decode->mask != 0) {
-				unsigned piece = frame[1 + decode->byte];
-				piece >>= decode->rshift;
-				piece &= decode->mask;
-				piece <<= decode->lshift;
-
-				value |= piece;
-			}
-		}
-
+		const uint8_t *p = &frame[1 + (channel >> 3) * 11 + sbus_channel_byte[channel & 7]];
+		unsigned value = ((p[0] | (p[1] << 8) | (p[2] << 16)) >> sbus_channel_shift[channel & 7]) & 0x7ff;
 
-		/* convert 0-2048 values to 1000-2000 ppm encoding in a not too sloppy fashion */
-		values[channel] = (uint16_t)(value * SBUS_SCALE_FACTOR + .5f) + SBUS_SCALE_OFFSET;
+		/* convert 0-2048 values to 1000-2000 ppm encoding, exact integer form of the scale factor */
+		values[channel] = (uint16_t)(((value * SBUS_SCALE_NUM + SBUS_SCALE_DEN / 2) / SBUS_SCALE_DEN) + SBUS_SCALE_OFFSET);
 	}
 
 	/* decode switch channels if data fields are wide enough */
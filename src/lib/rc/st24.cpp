@@ -41,6 +41,7 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include "st24.h"
 #include "common_rc.h"
 
@@ -123,8 +124,9 @@ int st24_decode(uint8_t byte, uint8_t *rssi, uint8_t *lost_count, uint16_t *chan
 
 	case ST24_DECODE_STATE_GOT_STX2:
 
-		/* ensure no data overflow failure or hack is possible */
-		if ((unsigned)byte <= sizeof(_rxpacket.length) + sizeof(_rxpacket.type) + sizeof(_rxpacket.st24_data)) {
+		/* ensure no data overflow failure or hack is possible, a packet holds at least type, one data byte and crc */
+		if ((unsigned)byte >= 3 &&
+		    (unsigned)byte <= sizeof(_rxpacket.length) + sizeof(_rxpacket.type) + sizeof(_rxpacket.st24_data)) {
 			_rxpacket.length = byte;
 			_rxlen = 0;
 			_decode_state = ST24_DECODE_STATE_GOT_LEN;
@@ -245,3 +247,27 @@ int st24_decode(uint8_t byte, uint8_t *rssi, uint8_t *lost_count, uint16_t *chan
 
 	return ret;
 }
+
+bool st24_parse(const uint8_t *frame, unsigned len, uint8_t *rssi, uint8_t *lost_count, uint16_t *channel_count,
+		uint16_t *channels, uint16_t max_chan_count)
+{
+	bool decoded = false;
+
+	for (unsigned i = 0; i < len; i++) {
+
+		/* while out of sync only the start byte is of interest, skip ahead to it */
+		if (_decode_state == ST24_DECODE_STATE_UNSYNCED) {
+			const uint8_t *stx = (const uint8_t *)memchr(&frame[i], ST24_STX1, len - i);
+
+			if (stx == nullptr) {
+				break;
+			}
+
+			i = stx - frame;
+		}
+
+		decoded |= (st24_decode(frame[i], rssi, lost_count, channel_count, channels, max_chan_count) == 0);
+	}
+
+	return decoded;
+}
@@ -41,6 +41,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 __BEGIN_DECLS
@@ -169,4 +170,16 @@ uint8_t st24_common_crc8(uint8_t *ptr, uint8_t len);
 __EXPORT int st24_decode(uint8_t byte, uint8_t *rssi, uint8_t *lost_count, uint16_t *channel_count,
 			 uint16_t *channels, uint16_t max_chan_count);
 
+/**
+ * Decoder for a buffer of ST24 bytes
+ *
+ * Runs st24_decode() over the whole buffer, skipping bytes that cannot start a packet.
+ *
+ * @param frame bytes to decode
+ * @param len number of bytes in frame
+ * @return true if at least one channel packet was decoded, the outputs then hold the last one
+ */
+__EXPORT bool st24_parse(const uint8_t *frame, unsigned len, uint8_t *rssi, uint8_t *lost_count,
+			 uint16_t *channel_count, uint16_t *channels, uint16_t max_chan_count);
+
 __END_DECLS
@@ -41,6 +41,7 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include "sumd.h"
 #include "common_rc.h"
 
@@ -365,3 +366,27 @@ int sumd_decode(uint8_t byte, uint8_t *rssi, uint8_t *rx_count, uint16_t *channe
 
 	return ret;
 }
+
+bool sumd_parse(const uint8_t *frame, unsigned len, uint8_t *rssi, uint8_t *rx_count, uint16_t *channel_count,
+		uint16_t *channels, uint16_t max_chan_count, bool *failsafe)
+{
+	bool decoded = false;
+
+	for (unsigned i = 0; i < len; i++) {
+
+		/* while out of sync only the header byte is of interest, skip ahead to it */
+		if (_decode_state == SUMD_DECODE_STATE_UNSYNCED) {
+			const uint8_t *header = (const uint8_t *)memchr(&frame[i], SUMD_HEADER_ID, len - i);
+
+			if (header == nullptr) {
+				break;
+			}
+
+			i = header - frame;
+		}
+
+		decoded |= (sumd_decode(frame[i], rssi, rx_count, channel_count, channels, max_chan_count, failsafe) == 0);
+	}
+
+	return decoded;
+}
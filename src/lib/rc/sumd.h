@@ -105,5 +105,17 @@ __EXPORT int sumd_decode(uint8_t byte, uint8_t *rssi, uint8_t *rx_count, uint16_
 __EXPORT int sumd_decode(uint8_t byte, uint8_t *rssi, uint8_t *rx_count, uint16_t *channel_count,
 			 uint16_t *channels, uint16_t max_chan_count, bool *failsafe);
 
+/**
+ * Decoder for a buffer of SUMD/SUMH bytes
+ *
+ * Runs sumd_decode() over the whole buffer, skipping bytes that cannot start a packet.
+ *
+ * @param frame bytes to decode
+ * @param len number of bytes in frame
+ * @return true if at least one packet was decoded, the outputs then hold the last one
+ */
+__EXPORT bool sumd_parse(const uint8_t *frame, unsigned len, uint8_t *rssi, uint8_t *rx_count,
+			 uint16_t *channel_count, uint16_t *channels, uint16_t max_chan_count, bool *failsafe);
+
 
 __END_DECLS
@@ -0,0 +1,283 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file JerkLimitedTrajectory.cpp
+ */
+
+#include "JerkLimitedTrajectory.hpp"
+
+#include <float.h>
+#include <mathlib/mathlib.h>
+#include <px4_defines.h>
+
+using namespace matrix;
+
+namespace trajectory
+{
+
+void JerkLimitedTrajectory::reset()
+{
+	_leg_count = 0;
+	_waypoint_count = 0;
+}
+
+bool JerkLimitedTrajectory::validLimits(const Limits &limits)
+{
+	return limits.jerk > FLT_EPSILON && limits.accel > FLT_EPSILON && limits.velocity > FLT_EPSILON;
+}
+
+JerkLimitedTrajectory::Limits JerkLimitedTrajectory::lineLimits(const Vector3f &direction) const
+{
+	Limits limits{FLT_MAX, FLT_MAX, FLT_MAX};
+
+	const float horizontal = sqrtf(direction(0) * direction(0) + direction(1) * direction(1));
+	const float vertical = fabsf(direction(2));
+
+	// a line limit of l / |u| keeps the axis below l
+	if (horizontal > FLT_EPSILON) {
+		limits.jerk = _limits_xy.jerk / horizontal;
+		limits.accel = _limits_xy.accel / horizontal;
+		limits.velocity = _limits_xy.velocity / horizontal;
+	}
+
+	if (vertical > FLT_EPSILON) {
+		const Limits &limits_z = (direction(2) < 0.f) ? _limits_up : _limits_down;
+		limits.jerk = math::min(limits.jerk, limits_z.jerk / vertical);
+		limits.accel = math::min(limits.accel, limits_z.accel / vertical);
+		limits.velocity = math::min(limits.velocity, limits_z.velocity / vertical);
+	}
+
+	return limits;
+}
+
+JerkLimitedTrajectory::Profile JerkLimitedTrajectory::computeProfile(float distance, const Limits &limits)
+{
+	Profile profile{};
+
+	if (distance < FLT_EPSILON) {
+		return profile;
+	}
+
+	const float jerk = limits.jerk;
+	const float accel = limits.accel;
+	const float vel = limits.velocity;
+
+	profile.jerk = jerk;
+	profile.distance = distance;
+
+	// accelerate to the maximum velocity, the acceleration limit is only reached if v * j > a^2
+	float t_jerk = accel / jerk;
+	float t_accel = 0.f;
+
+	if (vel * jerk < accel * accel) {
+		t_jerk = sqrtf(vel / jerk);
+
+	} else {
+		t_accel = vel / accel - t_jerk;
+	}
+
+	// distance to accelerate to the maximum velocity and to brake again
+	const float distance_accel = vel * (2.f * t_jerk + t_accel);
+
+	if (distance >= distance_accel) {
+		profile.t_jerk = t_jerk;
+		profile.t_accel = t_accel;
+		profile.t_cruise = (distance - distance_accel) / vel;
+		return profile;
+	}
+
+	// the maximum velocity is not reached, the peak velocity v solves v^2 / a + v * a / j = distance
+	t_jerk = accel / jerk;
+	const float vel_peak = 0.5f * accel * (sqrtf(t_jerk * t_jerk + 4.f * distance / accel) - t_jerk);
+
+	if (vel_peak >= accel * t_jerk) {
+		profile.t_jerk = t_jerk;
+		profile.t_accel = vel_peak / accel - t_jerk;
+
+	} else {
+		// neither the velocity nor the acceleration limit is reached: distance = 2 * j * t_jerk^3
+		profile.t_jerk = cbrtf(0.5f * distance / jerk);
+	}
+
+	return profile;
+}
+
+void JerkLimitedTrajectory::evaluate(const Profile &profile, float duration, float t, float &jerk, float &accel,
+				     float &vel, float &pos)
+{
+	jerk = 0.f;
+	accel = 0.f;
+	vel = 0.f;
+	pos = 0.f;
+
+	const float profile_duration = profile.duration();
+
+	if (profile_duration < FLT_EPSILON || t >= duration) {
+		pos = profile.distance;
+		return;
+	}
+
+	// a profile stretched by 1 / scale runs through the same positions with scaled derivatives
+	const float scale = profile_duration / duration;
+	float tau = t * scale;
+
+	const float phase_duration[7] = {profile.t_jerk, profile.t_accel, profile.t_jerk, profile.t_cruise,
+					 profile.t_jerk, profile.t_accel, profile.t_jerk
+					};
+	const float phase_jerk[7] = {profile.jerk, 0.f, -profile.jerk, 0.f, -profile.jerk, 0.f, profile.jerk};
+
+	for (int i = 0; i < 7; i++) {
+		const float dt = math::min(tau, phase_duration[i]);
+		const float j = phase_jerk[i];
+
+		pos += (vel + (0.5f * accel + j * dt / 6.f) * dt) * dt;
+		vel += (accel + 0.5f * j * dt) * dt;
+		accel += j * dt;
+		tau -= dt;
+
+		if (tau <= 0.f) {
+			jerk = j;
+			break;
+		}
+	}
+
+	jerk *= scale * scale * scale;
+	accel *= scale * scale;
+	vel *= scale;
+}
+
+bool JerkLimitedTrajectory::plan(const Waypoint waypoints[], int count)
+{
+	reset();
+
+	if (count < 1 || count > MAX_WAYPOINTS || !validLimits(_limits_xy) || !validLimits(_limits_up)
+	    || !validLimits(_limits_down) || !validLimits(_limits_yaw)) {
+		return false;
+	}
+
+	float yaw = waypoints[0].yaw;
+	float t_start = 0.f;
+
+	for (int i = 0; i < count - 1; i++) {
+		Leg &leg = _legs[i];
+		const Vector3f line = waypoints[i + 1].position - waypoints[i].position;
+		const float length = line.norm();
+		const float yaw_target = waypoints[i + 1].yaw;
+
+		leg.start = waypoints[i].position;
+		leg.direction = (length > FLT_EPSILON) ? line / length : Vector3f();
+		leg.translation = computeProfile(length, lineLimits(leg.direction));
+
+		// without a previous heading the vehicle turns to the first one immediately
+		leg.yaw_start = PX4_ISFINITE(yaw) ? yaw : yaw_target;
+		float yaw_change = 0.f;
+
+		if (PX4_ISFINITE(yaw) && PX4_ISFINITE(yaw_target)) {
+			yaw_change = wrap_pi(yaw_target - yaw);
+		}
+
+		leg.yaw_direction = (yaw_change < 0.f) ? -1.f : 1.f;
+		leg.heading = computeProfile(fabsf(yaw_change), _limits_yaw);
+
+		leg.t_start = t_start;
+		leg.duration = math::max(leg.translation.duration(), leg.heading.duration());
+		t_start += leg.duration;
+
+		if (PX4_ISFINITE(yaw_target)) {
+			yaw = yaw_target;
+		}
+	}
+
+	_last.position = waypoints[count - 1].position;
+	_last.yaw = yaw;
+	_leg_count = count - 1;
+	_waypoint_count = count;
+	return true;
+}
+
+float JerkLimitedTrajectory::duration() const
+{
+	if (_leg_count == 0) {
+		return 0.f;
+	}
+
+	const Leg &leg = _legs[_leg_count - 1];
+	return leg.t_start + leg.duration;
+}
+
+float JerkLimitedTrajectory::arrivalTime(int waypoint) const
+{
+	if (waypoint <= 0 || _leg_count == 0) {
+		return 0.f;
+	}
+
+	const Leg &leg = _legs[math::min(waypoint, _leg_count) - 1];
+	return leg.t_start + leg.duration;
+}
+
+void JerkLimitedTrajectory::sample(float t, State &state) const
+{
+	state.velocity.zero();
+	state.acceleration.zero();
+	state.jerk.zero();
+	state.yaw_rate = 0.f;
+
+	if (t >= duration()) {
+		state.position = _last.position;
+		state.yaw = _last.yaw;
+		return;
+	}
+
+	int i = 0;
+
+	while (i < _leg_count - 1 && t >= _legs[i + 1].t_start) {
+		i++;
+	}
+
+	const Leg &leg = _legs[i];
+	const float t_leg = math::max(t - leg.t_start, 0.f);
+	float jerk, accel, vel, pos;
+
+	evaluate(leg.translation, leg.duration, t_leg, jerk, accel, vel, pos);
+	state.position = leg.start + leg.direction * pos;
+	state.velocity = leg.direction * vel;
+	state.acceleration = leg.direction * accel;
+	state.jerk = leg.direction * jerk;
+
+	evaluate(leg.heading, leg.duration, t_leg, jerk, accel, vel, pos);
+	state.yaw = PX4_ISFINITE(leg.yaw_start) ? wrap_pi(leg.yaw_start + leg.yaw_direction * pos) : NAN;
+	state.yaw_rate = leg.yaw_direction * vel;
+}
+
+} // namespace trajectory
@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file JerkLimitedTrajectory.hpp
+ *
+ * Time parameterised, jerk limited trajectory through a sequence of waypoints.
+ *
+ * Every leg is flown along the straight line between two waypoints and comes to rest
+ * at its end. The motion along the line is the time optimal rest to rest profile with
+ * seven phases of constant jerk, solved in closed form from the jerk, acceleration and
+ * velocity limits of the line direction. Because all three axes follow the same scalar
+ * profile along the line they are synchronized by construction. The heading uses its own
+ * profile, which is stretched in time to the duration of the slower of the two.
+ *
+ * The whole sequence is computed once when the waypoints change, afterwards the setpoints
+ * at any time, including lookahead points in the future, are evaluated without integrating
+ * state from one control cycle to the next.
+ *
+ * Positions are in a local NED frame in meters, headings in radians.
+ */
+
+#pragma once
+
+#include <matrix/math.hpp>
+
+namespace trajectory
+{
+
+class JerkLimitedTrajectory
+{
+public:
+	static constexpr int MAX_WAYPOINTS = 8;
+	static constexpr int MAX_LEGS = MAX_WAYPOINTS - 1;
+
+	struct Limits {
+		float jerk;
+		float accel;
+		float velocity;
+	};
+
+	struct Waypoint {
+		matrix::Vector3f position;
+		float yaw;			///< NAN to keep the previous heading
+	};
+
+	struct State {
+		matrix::Vector3f position;
+		matrix::Vector3f velocity;
+		matrix::Vector3f acceleration;
+		matrix::Vector3f jerk;
+		float yaw;			///< NAN if no waypoint defines a heading
+		float yaw_rate;
+	};
+
+	JerkLimitedTrajectory() = default;
+	~JerkLimitedTrajectory() = default;
+
+	/* Limits are applied by the next plan() call */
+	void setHorizontalLimits(const Limits &limits) { _limits_xy = limits; }
+	void setVerticalLimits(const Limits &up, const Limits &down) { _limits_up = up; _limits_down = down; }
+	void setYawLimits(const Limits &limits) { _limits_yaw = limits; }
+
+	/**
+	 * Compute the trajectory starting at rest at the first waypoint.
+	 * @param waypoints local positions and headings
+	 * @param count number of waypoints, 1..MAX_WAYPOINTS
+	 * @return false if the trajectory could not be computed
+	 */
+	bool plan(const Waypoint waypoints[], int count);
+
+	void reset();
+
+	bool valid() const { return _waypoint_count > 0; }
+
+	/** total time from the first to the last waypoint [s] */
+	float duration() const;
+
+	/** time at which the waypoint is reached [s] */
+	float arrivalTime(int waypoint) const;
+
+	/**
+	 * Evaluate the setpoints at time t after the start, t is clipped to [0, duration()].
+	 */
+	void sample(float t, State &state) const;
+
+private:
+
+	/** Rest to rest motion along a single axis: jerk phases of t_jerk, acceleration phases of t_accel */
+	struct Profile {
+		float jerk;
+		float t_jerk;
+		float t_accel;
+		float t_cruise;
+		float distance;
+
+		float duration() const { return 4.f * t_jerk + 2.f * t_accel + t_cruise; }
+	};
+
+	struct Leg {
+		matrix::Vector3f start;
+		matrix::Vector3f direction;	///< unit vector from start to end, zero if only the heading changes
+		Profile translation;
+		Profile heading;
+		float yaw_start;
+		float yaw_direction;		///< 1 to turn clockwise, -1 otherwise
+		float t_start;
+		float duration;
+	};
+
+	static Profile computeProfile(float distance, const Limits &limits);
+
+	/**
+	 * Evaluate a profile stretched to the given duration.
+	 */
+	static void evaluate(const Profile &profile, float duration, float t, float &jerk, float &accel, float &vel,
+			     float &pos);
+
+	static bool validLimits(const Limits &limits);
+
+	/** limits along a line in the given unit direction, respecting the limits of every axis */
+	Limits lineLimits(const matrix::Vector3f &direction) const;
+
+	Limits _limits_xy{5.f, 3.f, 5.f};
+	Limits _limits_up{5.f, 3.f, 3.f};
+	Limits _limits_down{5.f, 3.f, 1.f};
+	Limits _limits_yaw{10.f, 2.f, 0.8f};
+
+	Leg _legs[MAX_LEGS] {};
+	Waypoint _last {};		///< final waypoint, where the vehicle is held after the last leg
+	int _leg_count{0};
+	int _waypoint_count{0};
+};
+
+} // namespace trajectory
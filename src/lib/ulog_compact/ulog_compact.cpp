@@ -0,0 +1,186 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file ulog_compact.cpp
+ */
+
+#include "ulog_compact.h"
+
+#include <string.h>
+
+namespace ulog_compact
+{
+
+static inline uint64_t read_uint(const uint8_t *data, int size)
+{
+	uint64_t value = 0;
+
+	for (int i = 0; i < size; ++i) {
+		value |= (uint64_t)data[i] << (8 * i);
+	}
+
+	return value;
+}
+
+static inline void write_uint(uint8_t *data, int size, uint64_t value)
+{
+	for (int i = 0; i < size; ++i) {
+		data[i] = (uint8_t)(value >> (8 * i));
+	}
+}
+
+size_t layout_size(const uint8_t *layout)
+{
+	size_t size = 0;
+
+	for (; *layout; ++layout) {
+		size += *layout & LAYOUT_SIZE_MASK;
+	}
+
+	return size;
+}
+
+size_t encode(const uint8_t *layout, const uint8_t *previous, const uint8_t *sample, uint8_t *buffer,
+	      size_t max_length)
+{
+	const size_t num_fields = strlen((const char *)layout);
+	const size_t mask_length = (num_fields + 7) / 8;
+
+	if (mask_length > max_length) {
+		return 0;
+	}
+
+	uint8_t *mask = buffer;
+	memset(mask, 0, mask_length);
+	size_t length = mask_length;
+	size_t offset = 0;
+
+	for (size_t i = 0; i < num_fields; ++i) {
+		const int size = layout[i] & LAYOUT_SIZE_MASK;
+
+		if (memcmp(previous + offset, sample + offset, size) != 0) {
+			mask[i / 8] |= 1 << (i % 8);
+
+			if (layout[i] & LAYOUT_VARINT) {
+				// difference with the wrap-around of the field type, sign extended and zigzag encoded
+				uint64_t delta = read_uint(sample + offset, size) - read_uint(previous + offset, size);
+
+				if (size < 8) {
+					const int shift = 64 - 8 * size;
+					delta = (uint64_t)((int64_t)(delta << shift) >> shift);
+				}
+
+				uint64_t zigzag = (delta << 1) ^ (uint64_t)((int64_t)delta >> 63);
+
+				do {
+					if (length >= max_length) {
+						return 0;
+					}
+
+					buffer[length++] = (uint8_t)(zigzag & 0x7f) | (zigzag > 0x7f ? 0x80 : 0);
+					zigzag >>= 7;
+				} while (zigzag);
+
+			} else {
+				if (length + size > max_length) {
+					return 0;
+				}
+
+				memcpy(buffer + length, sample + offset, size);
+				length += size;
+			}
+		}
+
+		offset += size;
+	}
+
+	return length;
+}
+
+bool decode(const uint8_t *layout, const uint8_t *data, size_t length, uint8_t *sample, size_t sample_size)
+{
+	const size_t num_fields = strlen((const char *)layout);
+	const size_t mask_length = (num_fields + 7) / 8;
+
+	if (mask_length > length) {
+		return false;
+	}
+
+	const uint8_t *mask = data;
+	size_t pos = mask_length;
+	size_t offset = 0;
+
+	for (size_t i = 0; i < num_fields; ++i) {
+		const int size = layout[i] & LAYOUT_SIZE_MASK;
+
+		if (offset + size > sample_size) {
+			return false;
+		}
+
+		if (mask[i / 8] & (1 << (i % 8))) {
+			if (layout[i] & LAYOUT_VARINT) {
+				uint64_t zigzag = 0;
+				int shift = 0;
+				uint8_t byte;
+
+				do {
+					if (pos >= length || shift > 63) {
+						return false;
+					}
+
+					byte = data[pos++];
+					zigzag |= (uint64_t)(byte & 0x7f) << shift;
+					shift += 7;
+				} while (byte & 0x80);
+
+				const uint64_t delta = (zigzag >> 1) ^ (0 - (zigzag & 1));
+				write_uint(sample + offset, size, read_uint(sample + offset, size) + delta);
+
+			} else {
+				if (pos + size > length) {
+					return false;
+				}
+
+				memcpy(sample + offset, data + pos, size);
+				pos += size;
+			}
+		}
+
+		offset += size;
+	}
+
+	return pos == length && offset == sample_size;
+}
+
+} // namespace ulog_compact
@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file ulog_compact.h
+ *
+ * Compact (delta) encoding of ULog data messages.
+ *
+ * A sample is encoded relative to the previous sample of the same topic instance:
+ * a bit mask of the changed fields, followed by the changed fields in order.
+ * Integer fields of 2 bytes or more are written as zigzag varint of the difference
+ * to the previous value, all other fields as raw bytes.
+ *
+ * The field layout is generated for each topic (see orb_metadata::o_layout): one byte per field
+ * in memory order, with the size in bytes in the lower 7 bits and LAYOUT_VARINT set for varint
+ * encoded integers. It is terminated with 0 and covers exactly o_size_no_padding bytes.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ulog_compact
+{
+
+static constexpr uint8_t LAYOUT_VARINT = 0x80;
+static constexpr uint8_t LAYOUT_SIZE_MASK = 0x7f;
+
+/**
+ * Get the number of bytes covered by a layout (must be equal to the sample size)
+ */
+size_t layout_size(const uint8_t *layout);
+
+/**
+ * Encode a sample relative to the previous one.
+ * @param layout field layout of the topic
+ * @param previous previous sample
+ * @param sample sample to encode
+ * @param buffer output buffer
+ * @param max_length maximum number of bytes to write to buffer
+ * @return encoded length, 0 if the encoding does not fit into max_length bytes
+ */
+size_t encode(const uint8_t *layout, const uint8_t *previous, const uint8_t *sample, uint8_t *buffer,
+	      size_t max_length);
+
+/**
+ * Decode a sample.
+ * @param layout field layout of the topic
+ * @param data encoded data
+ * @param length length of data
+ * @param sample contains the previous sample, and is updated in place to the decoded one
+ * @param sample_size size of sample
+ * @return true on success, false if data does not match the layout (sample is then undefined)
+ */
+bool decode(const uint8_t *layout, const uint8_t *data, size_t length, uint8_t *sample, size_t sample_size);
+
+} // namespace ulog_compact
@@ -51,6 +51,7 @@
 #include <px4_tasks.h>
 #include <systemlib/err.h>
 #include <parameters/param.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/sensor_combined.h>
@@ -448,6 +449,7 @@ void AttitudeEstimatorQ::task_main()
 		if (update(dt)) {
 			vehicle_attitude_s att = {};
 			att.timestamp = sensors.timestamp;
+			att.timestamp_sample = sensors.timestamp;
 			att.rollspeed = _rates(0);
 			att.pitchspeed = _rates(1);
 			att.yawspeed = _rates(2);
@@ -456,6 +458,7 @@ void AttitudeEstimatorQ::task_main()
 			/* the instance count is not used here */
 			int att_inst;
 			orb_publish_auto(ORB_ID(vehicle_attitude), &_att_pub, &att, &att_inst, ORB_PRIO_HIGH);
+			latency_trace_record(LATENCY_TRACE_VEHICLE_ATTITUDE, att.timestamp_sample);
 		}
 	}
 
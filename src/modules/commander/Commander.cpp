@@ -57,6 +57,7 @@
 #include "PreflightCheck.h"
 #include "px4_custom_mode.h"
 #include "rc_calibration.h"
+#include "SensorHealthMonitor.hpp"
 #include "state_machine_helper.h"
 #include "health_flag_helper.h"
 
@@ -216,7 +217,14 @@ void print_reject_arm(const char *msg);
 
 void print_status();
 
-transition_result_t arm_disarm(bool arm, orb_advert_t *mavlink_log_pub, const char *armedBy);
+transition_result_t arm_disarm(bool arm, orb_advert_t *mavlink_log_pub, const char *armedBy,
+			       Preflight::SensorHealthMonitor &sensor_health);
+
+/**
+ * Arm or disarm from the shell. The sensor health monitor of the commander belongs to its task,
+ * so this uses a short-lived one of its own.
+ */
+static transition_result_t arm_disarm_command_line(bool arm);
 
 /**
  * Loop that runs at a lower rate and priority for calibration and parameter tasks.
@@ -387,8 +395,18 @@ int commander_main(int argc, char *argv[])
 	}
 
 	if (!strcmp(argv[1], "check")) {
-		bool preflight_check_res = Commander::preflight_check(true);
+		// not the monitor of the commander task, see arm_disarm_command_line()
+		Preflight::SensorHealthMonitor *sensor_health = new Preflight::SensorHealthMonitor();
+
+		if (sensor_health == nullptr) {
+			PX4_ERR("alloc failed");
+			return 1;
+		}
+
+		sensor_health->update();
+		bool preflight_check_res = Commander::preflight_check(*sensor_health, true);
 		PX4_INFO("Preflight check: %s", preflight_check_res ? "OK" : "FAILED");
+		delete sensor_health;
 
 		bool prearm_check_res = prearm_check(&mavlink_log_pub, status_flags, safety, arm_requirements);
 		PX4_INFO("Prearm check: %s", prearm_check_res ? "OK" : "FAILED");
@@ -397,7 +415,7 @@ int commander_main(int argc, char *argv[])
 	}
 
 	if (!strcmp(argv[1], "arm")) {
-		if (TRANSITION_CHANGED != arm_disarm(true, &mavlink_log_pub, "command line")) {
+		if (TRANSITION_CHANGED != arm_disarm_command_line(true)) {
 			PX4_ERR("arming failed");
 		}
 
@@ -405,7 +423,7 @@ int commander_main(int argc, char *argv[])
 	}
 
 	if (!strcmp(argv[1], "disarm")) {
-		if (TRANSITION_DENIED == arm_disarm(false, &mavlink_log_pub, "command line")) {
+		if (TRANSITION_DENIED == arm_disarm_command_line(false)) {
 			PX4_ERR("rejected disarm");
 		}
 
@@ -419,7 +437,7 @@ int commander_main(int argc, char *argv[])
 		/* see if we got a home position */
 		if (status_flags.condition_local_position_valid) {
 
-			if (TRANSITION_DENIED != arm_disarm(true, &mavlink_log_pub, "command line")) {
+			if (TRANSITION_DENIED != arm_disarm_command_line(true)) {
 				ret = send_vehicle_command(vehicle_command_s::VEHICLE_CMD_NAV_TAKEOFF);
 
 			} else {
@@ -537,7 +555,8 @@ void print_status()
 	PX4_INFO("arming: %s", arming_state_names[status.arming_state]);
 }
 
-transition_result_t arm_disarm(bool arm, orb_advert_t *mavlink_log_pub_local, const char *armedBy)
+transition_result_t arm_disarm(bool arm, orb_advert_t *mavlink_log_pub_local, const char *armedBy,
+			       Preflight::SensorHealthMonitor &sensor_health)
 {
 	transition_result_t arming_res = TRANSITION_NOT_CHANGED;
 
@@ -551,7 +570,8 @@ transition_result_t arm_disarm(bool arm, orb_advert_t *mavlink_log_pub_local, co
 					     mavlink_log_pub_local,
 					     &status_flags,
 					     arm_requirements,
-					     hrt_elapsed_time(&commander_boot_timestamp));
+					     hrt_elapsed_time(&commander_boot_timestamp),
+					     &sensor_health);
 
 	if (arming_res == TRANSITION_CHANGED) {
 		mavlink_log_info(mavlink_log_pub_local, "%s by %s", arm ? "ARMED" : "DISARMED", armedBy);
@@ -563,6 +583,22 @@ transition_result_t arm_disarm(bool arm, orb_advert_t *mavlink_log_pub_local, co
 	return arming_res;
 }
 
+transition_result_t arm_disarm_command_line(bool arm)
+{
+	Preflight::SensorHealthMonitor *sensor_health = new Preflight::SensorHealthMonitor();
+
+	if (sensor_health == nullptr) {
+		PX4_ERR("alloc failed");
+		return TRANSITION_DENIED;
+	}
+
+	sensor_health->update();
+	transition_result_t arming_res = arm_disarm(arm, &mavlink_log_pub, "command line", *sensor_health);
+	delete sensor_health;
+
+	return arming_res;
+}
+
 Commander::Commander() :
 	ModuleParams(nullptr),
 	_failure_detector(this)
@@ -792,7 +828,8 @@ Commander::handle_command(vehicle_status_s *status_local, const vehicle_command_
 					}
 				}
 
-				transition_result_t arming_res = arm_disarm(cmd_arms, &mavlink_log_pub, "arm/disarm component command");
+				transition_result_t arming_res = arm_disarm(cmd_arms, &mavlink_log_pub, "arm/disarm component command",
+							 _sensor_health_monitor);
 
 				if (arming_res == TRANSITION_DENIED) {
 					cmd_result = vehicle_command_s::VEHICLE_CMD_RESULT_TEMPORARILY_REJECTED;
@@ -996,7 +1033,8 @@ Commander::handle_command(vehicle_status_s *status_local, const vehicle_command_
 					// switch to AUTO_MISSION and ARM
 					if ((TRANSITION_DENIED != main_state_transition(*status_local, commander_state_s::MAIN_STATE_AUTO_MISSION, status_flags,
 							&internal_state))
-					    && (TRANSITION_DENIED != arm_disarm(true, &mavlink_log_pub, "mission start command"))) {
+					    && (TRANSITION_DENIED != arm_disarm(true, &mavlink_log_pub, "mission start command",
+							_sensor_health_monitor))) {
 
 						cmd_result = vehicle_command_s::VEHICLE_CMD_RESULT_ACCEPTED;
 
@@ -1429,13 +1467,15 @@ Commander::run()
 	(void)pthread_attr_setschedparam(&commander_low_prio_attr, &param);
 #endif
 
-	pthread_create(&commander_low_prio_thread, &commander_low_prio_attr, commander_low_prio_loop, nullptr);
+	pthread_create(&commander_low_prio_thread, &commander_low_prio_attr, commander_low_prio_loop,
+		       &_sensor_health_monitor);
 	pthread_attr_destroy(&commander_low_prio_attr);
 
 	arm_auth_init(&mavlink_log_pub, &status.system_id);
 
 	// run preflight immediately to find all relevant parameters, but don't report
-	preflight_check(false);
+	_sensor_health_monitor.update();
+	preflight_check(_sensor_health_monitor, false);
 
 	while (!should_exit()) {
 
@@ -1650,7 +1690,8 @@ Commander::run()
 
 					if (TRANSITION_CHANGED == arming_state_transition(&status, safety, vehicle_status_s::ARMING_STATE_STANDBY,
 							&armed, true /* fRunPreArmChecks */, &mavlink_log_pub,
-							&status_flags, arm_requirements, hrt_elapsed_time(&commander_boot_timestamp))
+							&status_flags, arm_requirements, hrt_elapsed_time(&commander_boot_timestamp),
+							&_sensor_health_monitor)
 					   ) {
 						status_changed = true;
 					}
@@ -1766,7 +1807,7 @@ Commander::run()
 		}
 
 		if (auto_disarm_hysteresis.get_state()) {
-			arm_disarm(false, &mavlink_log_pub, "auto disarm on land");
+			arm_disarm(false, &mavlink_log_pub, "auto disarm on land", _sensor_health_monitor);
 		}
 
 		if (!warning_action_on) {
@@ -1805,7 +1846,8 @@ Commander::run()
 
 			arming_ret = arming_state_transition(&status, safety, vehicle_status_s::ARMING_STATE_STANDBY, &armed,
 							     true /* fRunPreArmChecks */, &mavlink_log_pub, &status_flags,
-							     arm_requirements, hrt_elapsed_time(&commander_boot_timestamp));
+							     arm_requirements, hrt_elapsed_time(&commander_boot_timestamp),
+							     &_sensor_health_monitor);
 
 			if (arming_ret == TRANSITION_DENIED) {
 				/* do not complain if not allowed into standby */
@@ -2049,7 +2091,8 @@ Commander::run()
 				} else if ((stick_off_counter == rc_arm_hyst && stick_on_counter < rc_arm_hyst) || arm_switch_to_disarm_transition) {
 					arming_ret = arming_state_transition(&status, safety, vehicle_status_s::ARMING_STATE_STANDBY, &armed,
 									     true /* fRunPreArmChecks */,
-									     &mavlink_log_pub, &status_flags, arm_requirements, hrt_elapsed_time(&commander_boot_timestamp));
+									     &mavlink_log_pub, &status_flags, arm_requirements, hrt_elapsed_time(&commander_boot_timestamp),
+									     &_sensor_health_monitor);
 				}
 
 				stick_off_counter++;
@@ -2099,7 +2142,8 @@ Commander::run()
 					} else if (status.arming_state == vehicle_status_s::ARMING_STATE_STANDBY) {
 						arming_ret = arming_state_transition(&status, safety, vehicle_status_s::ARMING_STATE_ARMED, &armed,
 										     !in_arming_grace_period /* fRunPreArmChecks */,
-										     &mavlink_log_pub, &status_flags, arm_requirements, hrt_elapsed_time(&commander_boot_timestamp));
+										     &mavlink_log_pub, &status_flags, arm_requirements, hrt_elapsed_time(&commander_boot_timestamp),
+										     &_sensor_health_monitor);
 
 						if (arming_ret != TRANSITION_CHANGED) {
 							px4_usleep(100000);
@@ -2438,6 +2482,9 @@ Commander::run()
 			failsafe_old = status.failsafe;
 		}
 
+		/* keep the sensor state of the preflight checks current, publishes sensor_health */
+		_sensor_health_monitor.update();
+
 		/* publish states (armed, control_mode, vehicle_status, commander_state, vehicle_status_flags) at 1 Hz or immediately when changed */
 		if (hrt_elapsed_time(&status.timestamp) >= 1_s || status_changed || nav_state_changed) {
 
@@ -3529,6 +3576,9 @@ void *commander_low_prio_loop(void *arg)
 	/* Set thread name */
 	px4_prctl(PR_SET_NAME, "commander_low_prio", px4_getpid());
 
+	/* owned by the commander task */
+	Preflight::SensorHealthMonitor &sensor_health = *static_cast<Preflight::SensorHealthMonitor *>(arg);
+
 	/* Subscribe to command topic */
 	int cmd_sub = orb_subscribe(ORB_ID(vehicle_command));
 
@@ -3607,7 +3657,7 @@ void *commander_low_prio_loop(void *arg)
 					/* try to go to INIT/PREFLIGHT arming state */
 					if (TRANSITION_DENIED == arming_state_transition(&status, safety, vehicle_status_s::ARMING_STATE_INIT, &armed,
 							false /* fRunPreArmChecks */, &mavlink_log_pub, &status_flags,
-							arm_requirements, hrt_elapsed_time(&commander_boot_timestamp))) {
+							arm_requirements, hrt_elapsed_time(&commander_boot_timestamp), &sensor_health)) {
 
 						answer_command(cmd, vehicle_command_s::VEHICLE_CMD_RESULT_DENIED, command_ack_pub);
 						break;
@@ -3691,11 +3741,12 @@ void *commander_low_prio_loop(void *arg)
 					if (calib_ret == OK) {
 						tune_positive(true);
 
-						Commander::preflight_check(false);
+						Commander::preflight_check(sensor_health, false);
 
 						arming_state_transition(&status, safety, vehicle_status_s::ARMING_STATE_STANDBY, &armed,
 									false /* fRunPreArmChecks */,
-									&mavlink_log_pub, &status_flags, arm_requirements, hrt_elapsed_time(&commander_boot_timestamp));
+									&mavlink_log_pub, &status_flags, arm_requirements, hrt_elapsed_time(&commander_boot_timestamp),
+									&sensor_health);
 
 					} else {
 						tune_negative(true);
@@ -3864,12 +3915,12 @@ void Commander::mission_init()
 	}
 }
 
-bool Commander::preflight_check(bool report)
+bool Commander::preflight_check(Preflight::SensorHealthMonitor &sensor_health, bool report)
 {
 	const bool checkGNSS = (arm_requirements & ARM_REQ_GPS_BIT);
 
-	bool success = Preflight::preflightCheck(&mavlink_log_pub, status, status_flags, checkGNSS, report, false,
-			hrt_elapsed_time(&commander_boot_timestamp));
+	bool success = Preflight::preflightCheck(&mavlink_log_pub, sensor_health, status, status_flags, checkGNSS, report,
+			false, hrt_elapsed_time(&commander_boot_timestamp));
 
 	if (success) {
 		status_flags.condition_system_sensors_initialized = true;
@@ -3908,7 +3959,7 @@ void Commander::poll_telemetry_status()
 				/* flag the checks as reported for this link when we actually report them */
 				_telemetry[i].preflight_checks_reported = status_flags.condition_system_hotplug_timeout;
 
-				preflight_check(true);
+				preflight_check(_sensor_health_monitor, true);
 
 				// Provide feedback on mission state
 				const mission_result_s &mission_result = _mission_result_sub.get();
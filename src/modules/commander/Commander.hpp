@@ -34,6 +34,7 @@
 #ifndef COMMANDER_HPP_
 #define COMMANDER_HPP_
 
+#include "SensorHealthMonitor.hpp"
 #include "state_machine_helper.h"
 #include "failure_detector/FailureDetector.hpp"
 
@@ -93,7 +94,7 @@ public:
 	void enable_hil();
 
 	// TODO: only temporarily static until low priority thread is removed
-	static bool preflight_check(bool report);
+	static bool preflight_check(Preflight::SensorHealthMonitor &sensor_health, bool report);
 
 private:
 
@@ -190,6 +191,9 @@ private:
 
 	void battery_status_check();
 
+	/** owned and updated by the commander task, the low priority thread only reads it */
+	Preflight::SensorHealthMonitor _sensor_health_monitor;
+
 	// Subscriptions
 	Subscription<estimator_status_s>		_estimator_status_sub{ORB_ID(estimator_status)};
 	Subscription<iridiumsbd_status_s> 		_iridiumsbd_status_sub{ORB_ID(iridiumsbd_status)};
@@ -41,75 +41,29 @@
 */
 
 #include "PreflightCheck.h"
+#include "SensorHealthMonitor.hpp"
 #include "health_flag_helper.h"
 #include "rc_check.h"
 
-#include <parameters/param.h>
 #include <systemlib/mavlink_log.h>
-#include <uORB/Subscription.hpp>
-#include <uORB/topics/airspeed.h>
-#include <uORB/topics/differential_pressure.h>
-#include <uORB/topics/estimator_status.h>
-#include <uORB/topics/sensor_accel.h>
-#include <uORB/topics/sensor_baro.h>
-#include <uORB/topics/sensor_gyro.h>
-#include <uORB/topics/sensor_mag.h>
-#include <uORB/topics/sensor_preflight.h>
 #include <uORB/topics/subsystem_info.h>
-#include <uORB/topics/system_power.h>
 
 using namespace time_literals;
 
 namespace Preflight
 {
 
-static bool check_calibration(const char *param_template, int32_t device_id)
+static bool magnometerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
+			    const SensorHealthMonitor &monitor, unsigned instance, bool optional, int32_t &device_id,
+			    bool report_fail)
 {
-	bool calibration_found = false;
-
-	char s[20];
-	int instance = 0;
-
-	/* old style transition: check param values */
-	while (!calibration_found) {
-		sprintf(s, param_template, instance);
-		const param_t parm = param_find_no_notification(s);
-
-		/* if the calibration param is not present, abort */
-		if (parm == PARAM_INVALID) {
-			break;
-		}
-
-		/* if param get succeeds */
-		int32_t calibration_devid = -1;
-
-		if (param_get(parm, &calibration_devid) == PX4_OK) {
-
-			/* if the devid matches, exit early */
-			if (device_id == calibration_devid) {
-				calibration_found = true;
-				break;
-			}
-		}
-
-		instance++;
-	}
-
-	return calibration_found;
-}
-
-static bool magnometerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, unsigned instance, bool optional,
-			    int32_t &device_id, bool report_fail)
-{
-	const bool exists = (orb_exists(ORB_ID(sensor_mag), instance) == PX4_OK);
+	const bool exists = monitor.exists(SensorHealthMonitor::SENSOR_MAG, instance);
 	bool calibration_valid = false;
 	bool mag_valid = false;
 
 	if (exists) {
 
-		uORB::Subscription<sensor_mag_s> magnetometer{ORB_ID(sensor_mag), 0, instance};
-
-		mag_valid = (hrt_elapsed_time(&magnetometer.get().timestamp) < 1_s);
+		mag_valid = monitor.dataValid(SensorHealthMonitor::SENSOR_MAG, instance);
 
 		if (!mag_valid) {
 			if (report_fail) {
@@ -117,9 +71,9 @@ static bool magnometerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &sta
 			}
 		}
 
-		device_id = magnetometer.get().device_id;
+		device_id = monitor.deviceId(SensorHealthMonitor::SENSOR_MAG, instance);
 
-		calibration_valid = check_calibration("CAL_MAG%u_ID", device_id);
+		calibration_valid = monitor.calibrated(SensorHealthMonitor::SENSOR_MAG, instance);
 
 		if (!calibration_valid) {
 			if (report_fail) {
@@ -145,83 +99,71 @@ static bool magnometerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &sta
 	return success;
 }
 
-static bool imuConsistencyCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, bool report_status)
+static bool imuConsistencyCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
+				const SensorHealthMonitor &monitor, bool report_status)
 {
-	bool success = true; // start with a pass and change to a fail if any test fails
-	float test_limit = 1.0f; // pass limit re-used for each test
+	// Get sensor_preflight data if available, pass if not
+	const sensor_preflight_s *sensors = monitor.sensorPreflight();
 
-	// Get sensor_preflight data if available and exit with a fail recorded if not
-	int sensors_sub = orb_subscribe(ORB_ID(sensor_preflight));
-	sensor_preflight_s sensors = {};
-
-	if (orb_copy(ORB_ID(sensor_preflight), sensors_sub, &sensors) != PX4_OK) {
-		goto out;
+	if (sensors == nullptr) {
+		return true;
 	}
 
 	// Use the difference between IMU's to detect a bad calibration.
 	// If a single IMU is fitted, the value being checked will be zero so this check will always pass.
-	param_get(param_find("COM_ARM_IMU_ACC"), &test_limit);
+	float test_limit = monitor.limits().imu_acc;
 
-	if (sensors.accel_inconsistency_m_s_s > test_limit) {
+	if (sensors->accel_inconsistency_m_s_s > test_limit) {
 		if (report_status) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Accels inconsistent - Check Cal");
 			set_health_flags_healthy(subsystem_info_s::SUBSYSTEM_TYPE_ACC, false, status);
 			set_health_flags_healthy(subsystem_info_s::SUBSYSTEM_TYPE_ACC2, false, status);
 		}
 
-		success = false;
-		goto out;
+		return false;
 
-	} else if (sensors.accel_inconsistency_m_s_s > test_limit * 0.8f) {
+	} else if (sensors->accel_inconsistency_m_s_s > test_limit * 0.8f) {
 		if (report_status) {
 			mavlink_log_info(mavlink_log_pub, "Preflight Advice: Accels inconsistent - Check Cal");
 		}
 	}
 
 	// Fail if gyro difference greater than 5 deg/sec and notify if greater than 2.5 deg/sec
-	param_get(param_find("COM_ARM_IMU_GYR"), &test_limit);
+	test_limit = monitor.limits().imu_gyr;
 
-	if (sensors.gyro_inconsistency_rad_s > test_limit) {
+	if (sensors->gyro_inconsistency_rad_s > test_limit) {
 		if (report_status) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Gyros inconsistent - Check Cal");
 			set_health_flags_healthy(subsystem_info_s::SUBSYSTEM_TYPE_GYRO, false, status);
 			set_health_flags_healthy(subsystem_info_s::SUBSYSTEM_TYPE_GYRO2, false, status);
 		}
 
-		success = false;
-		goto out;
+		return false;
 
-	} else if (sensors.gyro_inconsistency_rad_s > test_limit * 0.5f) {
+	} else if (sensors->gyro_inconsistency_rad_s > test_limit * 0.5f) {
 		if (report_status) {
 			mavlink_log_info(mavlink_log_pub, "Preflight Advice: Gyros inconsistent - Check Cal");
 		}
 	}
 
-out:
-	orb_unsubscribe(sensors_sub);
-	return success;
+	return true;
 }
 
 // return false if the magnetomer measurements are inconsistent
-static bool magConsistencyCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, bool report_status)
+static bool magConsistencyCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
+				const SensorHealthMonitor &monitor, bool report_status)
 {
 	// get the sensor preflight data
-	int sensors_sub = orb_subscribe(ORB_ID(sensor_preflight));
-	struct sensor_preflight_s sensors = {};
+	const sensor_preflight_s *sensors = monitor.sensorPreflight();
 
-	if (orb_copy(ORB_ID(sensor_preflight), sensors_sub, &sensors) != 0) {
+	if (sensors == nullptr) {
 		// can happen if not advertised (yet)
 		return true;
 	}
 
-	orb_unsubscribe(sensors_sub);
-
 	// Use the difference between sensors to detect a bad calibration, orientation or magnetic interference.
 	// If a single sensor is fitted, the value being checked will be zero so this check will always pass.
-	float test_limit;
-	param_get(param_find("COM_ARM_MAG"), &test_limit);
-
-	if (sensors.mag_inconsistency_ga > test_limit) {
+	if (sensors->mag_inconsistency_ga > monitor.limits().mag) {
 		if (report_status) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Compass Sensors inconsistent");
 			set_health_flags_healthy(subsystem_info_s::SUBSYSTEM_TYPE_MAG, false, status);
@@ -234,18 +176,17 @@ static bool magConsistencyCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s
 	return true;
 }
 
-static bool accelerometerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, unsigned instance,
-			       bool optional, bool dynamic, int32_t &device_id, bool report_fail)
+static bool accelerometerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
+			       const SensorHealthMonitor &monitor, unsigned instance, bool optional, bool dynamic,
+			       int32_t &device_id, bool report_fail)
 {
-	const bool exists = (orb_exists(ORB_ID(sensor_accel), instance) == PX4_OK);
+	const bool exists = monitor.exists(SensorHealthMonitor::SENSOR_ACCEL, instance);
 	bool calibration_valid = false;
 	bool accel_valid = true;
 
 	if (exists) {
 
-		uORB::Subscription<sensor_accel_s> accel{ORB_ID(sensor_accel), 0, instance};
-
-		accel_valid = (hrt_elapsed_time(&accel.get().timestamp) < 1_s);
+		accel_valid = monitor.dataValid(SensorHealthMonitor::SENSOR_ACCEL, instance);
 
 		if (!accel_valid) {
 			if (report_fail) {
@@ -253,9 +194,9 @@ static bool accelerometerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &
 			}
 		}
 
-		device_id = accel.get().device_id;
+		device_id = monitor.deviceId(SensorHealthMonitor::SENSOR_ACCEL, instance);
 
-		calibration_valid = check_calibration("CAL_ACC%u_ID", device_id);
+		calibration_valid = monitor.calibrated(SensorHealthMonitor::SENSOR_ACCEL, instance);
 
 		if (!calibration_valid) {
 			if (report_fail) {
@@ -265,9 +206,7 @@ static bool accelerometerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &
 		} else {
 
 			if (dynamic) {
-				const float accel_magnitude = sqrtf(accel.get().x * accel.get().x
-								    + accel.get().y * accel.get().y
-								    + accel.get().z * accel.get().z);
+				const float accel_magnitude = monitor.accelMagnitude(instance);
 
 				if (accel_magnitude < 4.0f || accel_magnitude > 15.0f /* m/s^2 */) {
 					if (report_fail) {
@@ -298,18 +237,16 @@ static bool accelerometerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &
 	return success;
 }
 
-static bool gyroCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, unsigned instance, bool optional,
-		      int32_t &device_id, bool report_fail)
+static bool gyroCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, const SensorHealthMonitor &monitor,
+		      unsigned instance, bool optional, int32_t &device_id, bool report_fail)
 {
-	const bool exists = (orb_exists(ORB_ID(sensor_gyro), instance) == PX4_OK);
+	const bool exists = monitor.exists(SensorHealthMonitor::SENSOR_GYRO, instance);
 	bool calibration_valid = false;
 	bool gyro_valid = false;
 
 	if (exists) {
 
-		uORB::Subscription<sensor_gyro_s> gyro{ORB_ID(sensor_gyro), 0, instance};
-
-		gyro_valid = (hrt_elapsed_time(&gyro.get().timestamp) < 1_s);
+		gyro_valid = monitor.dataValid(SensorHealthMonitor::SENSOR_GYRO, instance);
 
 		if (!gyro_valid) {
 			if (report_fail) {
@@ -317,9 +254,9 @@ static bool gyroCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, u
 			}
 		}
 
-		device_id = gyro.get().device_id;
+		device_id = monitor.deviceId(SensorHealthMonitor::SENSOR_GYRO, instance);
 
-		calibration_valid = check_calibration("CAL_GYRO%u_ID", device_id);
+		calibration_valid = monitor.calibrated(SensorHealthMonitor::SENSOR_GYRO, instance);
 
 		if (!calibration_valid) {
 			if (report_fail) {
@@ -343,16 +280,14 @@ static bool gyroCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, u
 	return calibration_valid && gyro_valid;
 }
 
-static bool baroCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, unsigned instance, bool optional,
-		      int32_t &device_id, bool report_fail)
+static bool baroCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, const SensorHealthMonitor &monitor,
+		      unsigned instance, bool optional, int32_t &device_id, bool report_fail)
 {
-	const bool exists = (orb_exists(ORB_ID(sensor_baro), instance) == PX4_OK);
+	const bool exists = monitor.exists(SensorHealthMonitor::SENSOR_BARO, instance);
 	bool baro_valid = false;
 
 	if (exists) {
-		uORB::Subscription<sensor_baro_s> baro{ORB_ID(sensor_baro), 0, instance};
-
-		baro_valid = (hrt_elapsed_time(&baro.get().timestamp) < 1_s);
+		baro_valid = monitor.dataValid(SensorHealthMonitor::SENSOR_BARO, instance);
 
 		if (!baro_valid) {
 			if (report_fail) {
@@ -374,20 +309,16 @@ static bool baroCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, u
 	return baro_valid;
 }
 
-static bool airspeedCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, bool optional, bool report_fail,
-			  bool prearm)
+static bool airspeedCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
+			  const SensorHealthMonitor &monitor, bool optional, bool report_fail, bool prearm)
 {
 	bool present = true;
 	bool success = true;
 
-	int fd_airspeed = orb_subscribe(ORB_ID(airspeed));
-	airspeed_s airspeed = {};
-
-	int fd_diffpres = orb_subscribe(ORB_ID(differential_pressure));
-	differential_pressure_s differential_pressure = {};
+	const airspeed_s *airspeed = monitor.airspeed();
+	const differential_pressure_s *differential_pressure = monitor.differentialPressure();
 
-	if ((orb_copy(ORB_ID(differential_pressure), fd_diffpres, &differential_pressure) != PX4_OK) ||
-	    (hrt_elapsed_time(&differential_pressure.timestamp) > 1_s)) {
+	if ((differential_pressure == nullptr) || (hrt_elapsed_time(&differential_pressure->timestamp) > 1_s)) {
 		if (report_fail && !optional) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Airspeed Sensor missing");
 		}
@@ -397,8 +328,7 @@ static bool airspeedCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &statu
 		goto out;
 	}
 
-	if ((orb_copy(ORB_ID(airspeed), fd_airspeed, &airspeed) != PX4_OK) ||
-	    (hrt_elapsed_time(&airspeed.timestamp) > 1_s)) {
+	if ((airspeed == nullptr) || (hrt_elapsed_time(&airspeed->timestamp) > 1_s)) {
 		if (report_fail && !optional) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Airspeed Sensor missing");
 		}
@@ -414,7 +344,7 @@ static bool airspeedCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &statu
 	 * for a pre-arm check, as then the cover is off and the natural airflow in the field
 	 * will ensure there is not zero noise.
 	 */
-	if (prearm && fabsf(airspeed.confidence) < 0.95f) {
+	if (prearm && fabsf(airspeed->confidence) < 0.95f) {
 		if (report_fail) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Airspeed Sensor stuck");
 		}
@@ -429,7 +359,7 @@ static bool airspeedCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &statu
 	 * Negative and positive offsets are considered. Do not check anymore while arming because pitot cover
 	 * might have been removed.
 	 */
-	if (fabsf(differential_pressure.differential_pressure_filtered_pa) > 15.0f && !prearm) {
+	if (fabsf(differential_pressure->differential_pressure_filtered_pa) > 15.0f && !prearm) {
 		if (report_fail) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: check Airspeed Cal or Pitot");
 		}
@@ -442,13 +372,11 @@ static bool airspeedCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &statu
 out:
 	set_health_flags(subsystem_info_s::SUBSYSTEM_TYPE_DIFFPRESSURE, present, !optional, success, status);
 
-	orb_unsubscribe(fd_airspeed);
-	orb_unsubscribe(fd_diffpres);
-
 	return success;
 }
 
-static bool powerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, bool report_fail, bool prearm)
+static bool powerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status, const SensorHealthMonitor &monitor,
+		       bool report_fail, bool prearm)
 {
 	bool success = true;
 
@@ -457,16 +385,14 @@ static bool powerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 		return true;
 
 	} else {
-		int system_power_sub = orb_subscribe(ORB_ID(system_power));
+		const system_power_s *system_power = monitor.systemPower();
 
-		system_power_s system_power;
+		if (system_power != nullptr) {
 
-		if (orb_copy(ORB_ID(system_power), system_power_sub, &system_power) == PX4_OK) {
-
-			if (hrt_elapsed_time(&system_power.timestamp) < 200_ms) {
+			if (hrt_elapsed_time(&system_power->timestamp) < 200_ms) {
 
 				/* copy avionics voltage */
-				float avionics_power_rail_voltage = system_power.voltage5v_v;
+				float avionics_power_rail_voltage = system_power->voltage5v_v;
 
 				// avionics rail
 				// Check avionics rail voltages
@@ -490,15 +416,13 @@ static bool powerCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 				}
 			}
 		}
-
-		orb_unsubscribe(system_power_sub);
 	}
 
 	return success;
 }
 
-static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_status, bool optional, bool report_fail,
-		      bool enforce_gps_required)
+static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_status,
+		      const SensorHealthMonitor &monitor, bool optional, bool report_fail, bool enforce_gps_required)
 {
 	bool success = true; // start with a pass and change to a fail if any test fails
 	bool present = true;
@@ -508,16 +432,15 @@ static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_s
 	bool gps_present = true;
 
 	// Get estimator status data if available and exit with a fail recorded if not
-	int sub = orb_subscribe(ORB_ID(estimator_status));
-	estimator_status_s status;
+	const estimator_status_s *status = monitor.estimatorStatus();
 
-	if (orb_copy(ORB_ID(estimator_status), sub, &status) != PX4_OK) {
+	if (status == nullptr) {
 		present = false;
 		goto out;
 	}
 
 	// Check if preflight check performed by estimator has failed
-	if (status.pre_flt_fail) {
+	if (status->pre_flt_fail) {
 		if (report_fail) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Position unknown");
 		}
@@ -527,9 +450,9 @@ static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_s
 	}
 
 	// check vertical position innovation test ratio
-	param_get(param_find("COM_ARM_EKF_HGT"), &test_limit);
+	test_limit = monitor.limits().ekf_hgt;
 
-	if (status.hgt_test_ratio > test_limit) {
+	if (status->hgt_test_ratio > test_limit) {
 		if (report_fail) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Height estimate Error");
 		}
@@ -539,9 +462,9 @@ static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_s
 	}
 
 	// check velocity innovation test ratio
-	param_get(param_find("COM_ARM_EKF_VEL"), &test_limit);
+	test_limit = monitor.limits().ekf_vel;
 
-	if (status.vel_test_ratio > test_limit) {
+	if (status->vel_test_ratio > test_limit) {
 		if (report_fail) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Velocity estimate Error");
 		}
@@ -551,9 +474,9 @@ static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_s
 	}
 
 	// check horizontal position innovation test ratio
-	param_get(param_find("COM_ARM_EKF_POS"), &test_limit);
+	test_limit = monitor.limits().ekf_pos;
 
-	if (status.pos_test_ratio > test_limit) {
+	if (status->pos_test_ratio > test_limit) {
 		if (report_fail) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Horizontal estimate Pos Error");
 		}
@@ -563,9 +486,9 @@ static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_s
 	}
 
 	// check magnetometer innovation test ratio
-	param_get(param_find("COM_ARM_EKF_YAW"), &test_limit);
+	test_limit = monitor.limits().ekf_yaw;
 
-	if (status.mag_test_ratio > test_limit) {
+	if (status->mag_test_ratio > test_limit) {
 		if (report_fail) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: Yaw estimate Error");
 		}
@@ -575,10 +498,10 @@ static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_s
 	}
 
 	// check accelerometer delta velocity bias estimates
-	param_get(param_find("COM_ARM_EKF_AB"), &test_limit);
+	test_limit = monitor.limits().ekf_ab;
 
-	if (fabsf(status.states[13]) > test_limit || fabsf(status.states[14]) > test_limit
-	    || fabsf(status.states[15]) > test_limit) {
+	if (fabsf(status->states[13]) > test_limit || fabsf(status->states[14]) > test_limit
+	    || fabsf(status->states[15]) > test_limit) {
 		if (report_fail) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: High Accelerometer Bias");
 		}
@@ -588,10 +511,10 @@ static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_s
 	}
 
 	// check gyro delta angle bias estimates
-	param_get(param_find("COM_ARM_EKF_GB"), &test_limit);
+	test_limit = monitor.limits().ekf_gb;
 
-	if (fabsf(status.states[10]) > test_limit || fabsf(status.states[11]) > test_limit
-	    || fabsf(status.states[12]) > test_limit) {
+	if (fabsf(status->states[10]) > test_limit || fabsf(status->states[11]) > test_limit
+	    || fabsf(status->states[12]) > test_limit) {
 		if (report_fail) {
 			mavlink_log_critical(mavlink_log_pub, "Preflight Fail: High Gyro Bias");
 		}
@@ -602,8 +525,8 @@ static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_s
 
 	// If GPS aiding is required, declare fault condition if the required GPS quality checks are failing
 	if (enforce_gps_required || report_fail) {
-		const bool ekf_gps_fusion = status.control_mode_flags & (1 << estimator_status_s::CS_GPS);
-		const bool ekf_gps_check_fail = status.gps_check_fail_flags > 0;
+		const bool ekf_gps_fusion = status->control_mode_flags & (1 << estimator_status_s::CS_GPS);
+		const bool ekf_gps_check_fail = status->gps_check_fail_flags > 0;
 
 		gps_success = ekf_gps_fusion; // default to success if gps data is fused
 
@@ -612,34 +535,34 @@ static bool ekf2Check(orb_advert_t *mavlink_log_pub, vehicle_status_s &vehicle_s
 				// Only report the first failure to avoid spamming
 				const char *message = nullptr;
 
-				if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_GPS_FIX)) {
+				if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_GPS_FIX)) {
 					message = "Preflight%s: GPS fix too low";
 
-				} else if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MIN_SAT_COUNT)) {
+				} else if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MIN_SAT_COUNT)) {
 					message = "Preflight%s: not enough GPS Satellites";
 
-				} else if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MIN_GDOP)) {
+				} else if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MIN_GDOP)) {
 					message = "Preflight%s: GPS GDoP too low";
 
-				} else if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_HORZ_ERR)) {
+				} else if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_HORZ_ERR)) {
 					message = "Preflight%s: GPS Horizontal Pos Error too high";
 
-				} else if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_VERT_ERR)) {
+				} else if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_VERT_ERR)) {
 					message = "Preflight%s: GPS Vertical Pos Error too high";
 
-				} else if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_SPD_ERR)) {
+				} else if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_SPD_ERR)) {
 					message = "Preflight%s: GPS Speed Accuracy too low";
 
-				} else if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_HORZ_DRIFT)) {
+				} else if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_HORZ_DRIFT)) {
 					message = "Preflight%s: GPS Horizontal Pos Drift too high";
 
-				} else if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_VERT_DRIFT)) {
+				} else if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_VERT_DRIFT)) {
 					message = "Preflight%s: GPS Vertical Pos Drift too high";
 
-				} else if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_HORZ_SPD_ERR)) {
+				} else if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_HORZ_SPD_ERR)) {
 					message = "Preflight%s: GPS Hor Speed Drift too high";
 
-				} else if (status.gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_VERT_SPD_ERR)) {
+				} else if (status->gps_check_fail_flags & (1 << estimator_status_s::GPS_CHECK_FAIL_MAX_VERT_SPD_ERR)) {
 					message = "Preflight%s: GPS Vert Speed Drift too high";
 
 				} else {
@@ -677,12 +600,10 @@ out:
 	set_health_flags(subsystem_info_s::SUBSYSTEM_TYPE_AHRS, present, !optional, success && present, vehicle_status);
 	set_health_flags(subsystem_info_s::SUBSYSTEM_TYPE_GPS, gps_present, enforce_gps_required, gps_success, vehicle_status);
 
-	orb_unsubscribe(sub);
-
 	return success;
 }
 
-bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
+bool preflightCheck(orb_advert_t *mavlink_log_pub, SensorHealthMonitor &monitor, vehicle_status_s &status,
 		    vehicle_status_flags_s &status_flags, bool checkGNSS, bool reportFailures, bool prearm,
 		    const hrt_abstime &time_since_boot)
 {
@@ -709,17 +630,17 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 	reportFailures = (reportFailures && status_flags.condition_system_hotplug_timeout
 			  && !status_flags.condition_calibration_enabled);
 
+	// the owner may update it concurrently (commander loop vs. low priority thread)
+	monitor.lock();
+
 	bool failed = false;
 
 	/* ---- MAG ---- */
 	if (checkSensors) {
 		bool prime_found = false;
 
-		int32_t prime_id = -1;
-		param_get(param_find("CAL_MAG_PRIME"), &prime_id);
-
-		int32_t sys_has_mag = 1;
-		param_get(param_find("SYS_HAS_MAG"), &sys_has_mag);
+		const int32_t prime_id = monitor.limits().prime_id[SensorHealthMonitor::SENSOR_MAG];
+		const int32_t sys_has_mag = monitor.limits().sys_has_mag;
 
 		bool mag_fail_reported = false;
 
@@ -730,7 +651,7 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 
 			int32_t device_id = -1;
 
-			if (magnometerCheck(mavlink_log_pub, status, i, !required, device_id, report_fail)) {
+			if (magnometerCheck(mavlink_log_pub, status, monitor, i, !required, device_id, report_fail)) {
 
 				if ((prime_id > 0) && (device_id == prime_id)) {
 					prime_found = true;
@@ -756,7 +677,7 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 			}
 
 			/* mag consistency checks (need to be performed after the individual checks) */
-			if (!magConsistencyCheck(mavlink_log_pub, status, (reportFailures && !failed))) {
+			if (!magConsistencyCheck(mavlink_log_pub, status, monitor, (reportFailures && !failed))) {
 				failed = true;
 			}
 		}
@@ -765,8 +686,7 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 	/* ---- ACCEL ---- */
 	if (checkSensors) {
 		bool prime_found = false;
-		int32_t prime_id = -1;
-		param_get(param_find("CAL_ACC_PRIME"), &prime_id);
+		const int32_t prime_id = monitor.limits().prime_id[SensorHealthMonitor::SENSOR_ACCEL];
 
 		bool accel_fail_reported = false;
 
@@ -777,7 +697,8 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 
 			int32_t device_id = -1;
 
-			if (accelerometerCheck(mavlink_log_pub, status, i, !required, checkDynamic, device_id, report_fail)) {
+			if (accelerometerCheck(mavlink_log_pub, status, monitor, i, !required, checkDynamic, device_id,
+					       report_fail)) {
 
 				if ((prime_id > 0) && (device_id == prime_id)) {
 					prime_found = true;
@@ -805,8 +726,7 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 	/* ---- GYRO ---- */
 	if (checkSensors) {
 		bool prime_found = false;
-		int32_t prime_id = -1;
-		param_get(param_find("CAL_GYRO_PRIME"), &prime_id);
+		const int32_t prime_id = monitor.limits().prime_id[SensorHealthMonitor::SENSOR_GYRO];
 
 		bool gyro_fail_reported = false;
 
@@ -817,7 +737,7 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 
 			int32_t device_id = -1;
 
-			if (gyroCheck(mavlink_log_pub, status, i, !required, device_id, report_fail)) {
+			if (gyroCheck(mavlink_log_pub, status, monitor, i, !required, device_id, report_fail)) {
 
 				if ((prime_id > 0) && (device_id == prime_id)) {
 					prime_found = true;
@@ -846,11 +766,8 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 	if (checkSensors) {
 		bool prime_found = false;
 
-		int32_t prime_id = -1;
-		param_get(param_find("CAL_BARO_PRIME"), &prime_id);
-
-		int32_t sys_has_baro = 1;
-		param_get(param_find("SYS_HAS_BARO"), &sys_has_baro);
+		const int32_t prime_id = monitor.limits().prime_id[SensorHealthMonitor::SENSOR_BARO];
+		const int32_t sys_has_baro = monitor.limits().sys_has_baro;
 
 		bool baro_fail_reported = false;
 
@@ -861,7 +778,7 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 
 			int32_t device_id = -1;
 
-			if (baroCheck(mavlink_log_pub, status, i, !required, device_id, report_fail)) {
+			if (baroCheck(mavlink_log_pub, status, monitor, i, !required, device_id, report_fail)) {
 				if ((prime_id > 0) && (device_id == prime_id)) {
 					prime_found = true;
 				}
@@ -889,17 +806,17 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 	/* ---- IMU CONSISTENCY ---- */
 	// To be performed after the individual sensor checks have completed
 	if (checkSensors) {
-		if (!imuConsistencyCheck(mavlink_log_pub, status, (reportFailures && !failed))) {
+		if (!imuConsistencyCheck(mavlink_log_pub, status, monitor, (reportFailures && !failed))) {
 			failed = true;
 		}
 	}
 
 	/* ---- AIRSPEED ---- */
 	if (checkAirspeed) {
-		int32_t optional = 0;
-		param_get(param_find("FW_ARSP_MODE"), &optional);
+		const bool optional = (monitor.limits().airspeed_mode != 0);
 
-		if (!airspeedCheck(mavlink_log_pub, status, (bool)optional, reportFailures && !failed, prearm) && !(bool)optional) {
+		if (!airspeedCheck(mavlink_log_pub, status, monitor, optional, reportFailures && !failed, prearm)
+		    && !optional) {
 			failed = true;
 		}
 	}
@@ -926,25 +843,25 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
 
 	/* ---- SYSTEM POWER ---- */
 	if (checkPower) {
-		if (!powerCheck(mavlink_log_pub, status, (reportFailures && !failed), prearm)) {
+		if (!powerCheck(mavlink_log_pub, status, monitor, (reportFailures && !failed), prearm)) {
 			failed = true;
 		}
 	}
 
 	/* ---- Navigation EKF ---- */
 	// only check EKF2 data if EKF2 is selected as the estimator and GNSS checking is enabled
-	int32_t estimator_type;
-	param_get(param_find("SYS_MC_EST_GROUP"), &estimator_type);
-
-	if (estimator_type == 2) {
+	if (monitor.limits().estimator_group == 2) {
 		// don't report ekf failures for the first 10 seconds to allow time for the filter to start
 		bool report_ekf_fail = (time_since_boot > 10_s);
 
-		if (!ekf2Check(mavlink_log_pub, status, false, reportFailures && report_ekf_fail && !failed, checkGNSS)) {
+		if (!ekf2Check(mavlink_log_pub, status, monitor, false, reportFailures && report_ekf_fail && !failed,
+			       checkGNSS)) {
 			failed = true;
 		}
 	}
 
+	monitor.unlock();
+
 	/* Report status */
 	return !failed;
 }
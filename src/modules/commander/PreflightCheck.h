@@ -47,6 +47,9 @@
 
 namespace Preflight
 {
+
+class SensorHealthMonitor;
+
 /**
 * Runs a preflight check on all sensors to see if they are properly calibrated and healthy
 *
@@ -55,6 +58,8 @@ namespace Preflight
 *
 * @param mavlink_log_pub
 *   Mavlink output orb handle reference for feedback when a sensor fails
+* @param monitor
+*   Sensor state, updated by the task that owns it. Only read here, under its lock.
 * @param checkMag
 *   true if the magneteometer should be checked
 * @param checkAcc
@@ -72,7 +77,7 @@ namespace Preflight
 * @param checkPower
 *   true if the system power should be checked
 **/
-bool preflightCheck(orb_advert_t *mavlink_log_pub, vehicle_status_s &status,
+bool preflightCheck(orb_advert_t *mavlink_log_pub, SensorHealthMonitor &monitor, vehicle_status_s &status,
 		    vehicle_status_flags_s &status_flags, bool checkGNSS, bool reportFailures, bool prearm,
 		    const hrt_abstime &time_since_boot);
 
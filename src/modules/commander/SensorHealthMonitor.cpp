@@ -0,0 +1,334 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file SensorHealthMonitor.cpp
+ */
+
+#include "SensorHealthMonitor.hpp"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_baro.h>
+#include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_mag.h>
+
+using namespace time_literals;
+
+namespace Preflight
+{
+
+static const orb_metadata *sensor_topic(SensorHealthMonitor::SensorType type)
+{
+	switch (type) {
+	case SensorHealthMonitor::SENSOR_ACCEL:
+		return ORB_ID(sensor_accel);
+
+	case SensorHealthMonitor::SENSOR_GYRO:
+		return ORB_ID(sensor_gyro);
+
+	case SensorHealthMonitor::SENSOR_MAG:
+		return ORB_ID(sensor_mag);
+
+	default:
+		return ORB_ID(sensor_baro);
+	}
+}
+
+SensorHealthMonitor::SensorHealthMonitor()
+{
+	pthread_mutex_init(&_mutex, nullptr);
+
+	// calibration parameters: no notification, only the ones that are used are marked
+	static const char *const calibration_templates[SENSOR_TYPE_COUNT] = {"CAL_ACC%u_ID", "CAL_GYRO%u_ID", "CAL_MAG%u_ID", nullptr};
+
+	for (int type = 0; type < SENSOR_TYPE_COUNT; type++) {
+		for (unsigned i = 0; i < MAX_CALIBRATIONS; i++) {
+			_calibration_handles[type][i] = PARAM_INVALID;
+
+			if (calibration_templates[type] != nullptr) {
+				char name[20];
+				snprintf(name, sizeof(name), calibration_templates[type], i);
+				_calibration_handles[type][i] = param_find_no_notification(name);
+			}
+
+			if (_calibration_handles[type][i] == PARAM_INVALID) {
+				break;
+			}
+		}
+	}
+
+	_param_handles.imu_acc = param_find("COM_ARM_IMU_ACC");
+	_param_handles.imu_gyr = param_find("COM_ARM_IMU_GYR");
+	_param_handles.mag = param_find("COM_ARM_MAG");
+	_param_handles.ekf_hgt = param_find("COM_ARM_EKF_HGT");
+	_param_handles.ekf_vel = param_find("COM_ARM_EKF_VEL");
+	_param_handles.ekf_pos = param_find("COM_ARM_EKF_POS");
+	_param_handles.ekf_yaw = param_find("COM_ARM_EKF_YAW");
+	_param_handles.ekf_ab = param_find("COM_ARM_EKF_AB");
+	_param_handles.ekf_gb = param_find("COM_ARM_EKF_GB");
+	_param_handles.prime_id[SENSOR_ACCEL] = param_find("CAL_ACC_PRIME");
+	_param_handles.prime_id[SENSOR_GYRO] = param_find("CAL_GYRO_PRIME");
+	_param_handles.prime_id[SENSOR_MAG] = param_find("CAL_MAG_PRIME");
+	_param_handles.prime_id[SENSOR_BARO] = param_find("CAL_BARO_PRIME");
+	_param_handles.sys_has_mag = param_find("SYS_HAS_MAG");
+	_param_handles.sys_has_baro = param_find("SYS_HAS_BARO");
+	_param_handles.airspeed_mode = param_find("FW_ARSP_MODE");
+	_param_handles.estimator_group = param_find("SYS_MC_EST_GROUP");
+
+	updateParams();
+}
+
+SensorHealthMonitor::~SensorHealthMonitor()
+{
+	for (int type = 0; type < SENSOR_TYPE_COUNT; type++) {
+		for (unsigned instance = 0; instance < MAX_INSTANCES; instance++) {
+			if (_sensors[type][instance].handle >= 0) {
+				orb_unsubscribe(_sensors[type][instance].handle);
+			}
+		}
+	}
+
+	if (_sensor_health_pub != nullptr) {
+		orb_unadvertise(_sensor_health_pub);
+	}
+
+	pthread_mutex_destroy(&_mutex);
+}
+
+void SensorHealthMonitor::updateParams()
+{
+	// param_get() leaves the default if the parameter does not exist in this build
+	param_get(_param_handles.imu_acc, &_limits.imu_acc);
+	param_get(_param_handles.imu_gyr, &_limits.imu_gyr);
+	param_get(_param_handles.mag, &_limits.mag);
+	param_get(_param_handles.ekf_hgt, &_limits.ekf_hgt);
+	param_get(_param_handles.ekf_vel, &_limits.ekf_vel);
+	param_get(_param_handles.ekf_pos, &_limits.ekf_pos);
+	param_get(_param_handles.ekf_yaw, &_limits.ekf_yaw);
+	param_get(_param_handles.ekf_ab, &_limits.ekf_ab);
+	param_get(_param_handles.ekf_gb, &_limits.ekf_gb);
+
+	for (int type = 0; type < SENSOR_TYPE_COUNT; type++) {
+		param_get(_param_handles.prime_id[type], &_limits.prime_id[type]);
+	}
+
+	param_get(_param_handles.sys_has_mag, &_limits.sys_has_mag);
+	param_get(_param_handles.sys_has_baro, &_limits.sys_has_baro);
+	param_get(_param_handles.airspeed_mode, &_limits.airspeed_mode);
+	param_get(_param_handles.estimator_group, &_limits.estimator_group);
+}
+
+bool SensorHealthMonitor::checkCalibration(SensorType type, int32_t device_id) const
+{
+	if (type == SENSOR_BARO) {
+		// there is no barometer calibration yet
+		return true;
+	}
+
+	for (unsigned i = 0; i < MAX_CALIBRATIONS && _calibration_handles[type][i] != PARAM_INVALID; i++) {
+		int32_t calibration_device_id = -1;
+
+		if (param_get(_calibration_handles[type][i], &calibration_device_id) == PX4_OK && calibration_device_id == device_id) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool SensorHealthMonitor::updateSensor(SensorType type, unsigned instance)
+{
+	Sensor &sensor = _sensors[type][instance];
+
+	if (sensor.handle < 0) {
+		// instances appear once (hotplug at boot), until then only probe
+		if (orb_exists(sensor_topic(type), instance) != PX4_OK) {
+			return false;
+		}
+
+		sensor.handle = orb_subscribe_multi(sensor_topic(type), instance);
+
+		if (sensor.handle < 0) {
+			return false;
+		}
+
+	} else {
+		bool updated = false;
+
+		if (orb_check(sensor.handle, &updated) != PX4_OK || !updated) {
+			return false;
+		}
+	}
+
+	const int32_t previous_device_id = sensor.device_id;
+
+	switch (type) {
+	case SENSOR_ACCEL: {
+			sensor_accel_s accel;
+
+			if (orb_copy(ORB_ID(sensor_accel), sensor.handle, &accel) == PX4_OK) {
+				sensor.timestamp = accel.timestamp;
+				sensor.device_id = accel.device_id;
+				sensor.accel_magnitude = sqrtf(accel.x * accel.x + accel.y * accel.y + accel.z * accel.z);
+			}
+		}
+		break;
+
+	case SENSOR_GYRO: {
+			sensor_gyro_s gyro;
+
+			if (orb_copy(ORB_ID(sensor_gyro), sensor.handle, &gyro) == PX4_OK) {
+				sensor.timestamp = gyro.timestamp;
+				sensor.device_id = gyro.device_id;
+			}
+		}
+		break;
+
+	case SENSOR_MAG: {
+			sensor_mag_s mag;
+
+			if (orb_copy(ORB_ID(sensor_mag), sensor.handle, &mag) == PX4_OK) {
+				sensor.timestamp = mag.timestamp;
+				sensor.device_id = mag.device_id;
+			}
+		}
+		break;
+
+	default: {
+			sensor_baro_s baro;
+
+			if (orb_copy(ORB_ID(sensor_baro), sensor.handle, &baro) == PX4_OK) {
+				sensor.timestamp = baro.timestamp;
+				sensor.device_id = baro.device_id;
+			}
+		}
+		break;
+	}
+
+	return sensor.device_id != previous_device_id;
+}
+
+void SensorHealthMonitor::update()
+{
+	lock();
+
+	const bool params_updated = _parameter_update_sub.update();
+
+	if (params_updated) {
+		updateParams();
+	}
+
+	for (int type = 0; type < SENSOR_TYPE_COUNT; type++) {
+		for (unsigned instance = 0; instance < MAX_INSTANCES; instance++) {
+			Sensor &sensor = _sensors[type][instance];
+
+			if (updateSensor((SensorType)type, instance) || (params_updated && sensor.handle >= 0)) {
+				sensor.calibrated = checkCalibration((SensorType)type, sensor.device_id);
+			}
+		}
+	}
+
+	_sensor_preflight_sub.update();
+	_estimator_status_sub.update();
+	_airspeed_sub.update();
+	_differential_pressure_sub.update();
+	_system_power_sub.update();
+
+	publish();
+
+	unlock();
+}
+
+void SensorHealthMonitor::publish()
+{
+	sensor_health_s health{};
+
+	uint32_t *device_ids[SENSOR_TYPE_COUNT] = {health.accel_device_id, health.gyro_device_id, health.mag_device_id, health.baro_device_id};
+	uint8_t *present[SENSOR_TYPE_COUNT] = {&health.accel_present, &health.gyro_present, &health.mag_present, &health.baro_present};
+	uint8_t *valid[SENSOR_TYPE_COUNT] = {&health.accel_valid, &health.gyro_valid, &health.mag_valid, &health.baro_valid};
+	uint8_t *calibrated[SENSOR_TYPE_COUNT] = {&health.accel_calibrated, &health.gyro_calibrated, &health.mag_calibrated, nullptr};
+	bool *prime_found[SENSOR_TYPE_COUNT] = {&health.accel_prime_found, &health.gyro_prime_found, &health.mag_prime_found, nullptr};
+
+	for (int type = 0; type < SENSOR_TYPE_COUNT; type++) {
+		for (unsigned instance = 0; instance < MAX_INSTANCES; instance++) {
+			if (!exists((SensorType)type, instance)) {
+				continue;
+			}
+
+			const Sensor &sensor = _sensors[type][instance];
+			const bool data_valid = dataValid((SensorType)type, instance);
+
+			device_ids[type][instance] = sensor.device_id;
+			*present[type] |= 1 << instance;
+			*valid[type] |= data_valid << instance;
+
+			if (calibrated[type]) {
+				*calibrated[type] |= sensor.calibrated << instance;
+			}
+
+			if (prime_found[type] && data_valid && sensor.calibrated && _limits.prime_id[type] > 0
+			    && sensor.device_id == _limits.prime_id[type]) {
+				*prime_found[type] = true;
+			}
+		}
+	}
+
+	const sensor_preflight_s *preflight = sensorPreflight();
+	health.imu_consistent = (preflight == nullptr) || (preflight->accel_inconsistency_m_s_s <= _limits.imu_acc
+				&& preflight->gyro_inconsistency_rad_s <= _limits.imu_gyr);
+	health.mag_consistent = (preflight == nullptr) || (preflight->mag_inconsistency_ga <= _limits.mag);
+
+	// publish on change, at least at 1 Hz
+	const hrt_abstime now = hrt_absolute_time();
+	health.timestamp = _sensor_health.timestamp;
+
+	if (memcmp(&health, &_sensor_health, sizeof(health)) == 0 && now < _sensor_health.timestamp + 1_s) {
+		return;
+	}
+
+	health.timestamp = now;
+	_sensor_health = health;
+
+	if (_sensor_health_pub == nullptr) {
+		_sensor_health_pub = orb_advertise(ORB_ID(sensor_health), &_sensor_health);
+
+	} else {
+		orb_publish(ORB_ID(sensor_health), _sensor_health_pub, &_sensor_health);
+	}
+}
+
+} // namespace Preflight
@@ -0,0 +1,208 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file SensorHealthMonitor.hpp
+ *
+ * Sensor state for the preflight checks, maintained incrementally.
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include <drivers/drv_hrt.h>
+#include <parameters/param.h>
+#include <uORB/Subscription.hpp>
+#include <uORB/topics/airspeed.h>
+#include <uORB/topics/differential_pressure.h>
+#include <uORB/topics/estimator_status.h>
+#include <uORB/topics/parameter_update.h>
+#include <uORB/topics/sensor_health.h>
+#include <uORB/topics/sensor_preflight.h>
+#include <uORB/topics/system_power.h>
+
+namespace Preflight
+{
+
+/**
+ * Keeps everything the preflight checks read, so that a check is a lookup.
+ *
+ * Parameter handles are resolved and topics are subscribed once. update() copies
+ * new samples and only re-evaluates the calibration of a sensor when its device id
+ * or the parameters change. The state is published as sensor_health.
+ *
+ * The subscriptions belong to the task that creates and updates the monitor (the
+ * commander loop). Other threads of that task only read the state while holding lock(),
+ * other tasks, e.g. 'commander check' from the shell, use an instance of their own.
+ */
+class SensorHealthMonitor
+{
+public:
+	enum SensorType {
+		SENSOR_ACCEL = 0,
+		SENSOR_GYRO,
+		SENSOR_MAG,
+		SENSOR_BARO,
+		SENSOR_TYPE_COUNT
+	};
+
+	static constexpr unsigned MAX_INSTANCES = sensor_health_s::MAX_INSTANCES;
+
+	/** cached parameters */
+	struct Limits {
+		float imu_acc{1.f};		///< COM_ARM_IMU_ACC
+		float imu_gyr{1.f};		///< COM_ARM_IMU_GYR
+		float mag{1.f};			///< COM_ARM_MAG
+		float ekf_hgt{1.f};		///< COM_ARM_EKF_HGT
+		float ekf_vel{1.f};		///< COM_ARM_EKF_VEL
+		float ekf_pos{1.f};		///< COM_ARM_EKF_POS
+		float ekf_yaw{1.f};		///< COM_ARM_EKF_YAW
+		float ekf_ab{1.f};		///< COM_ARM_EKF_AB
+		float ekf_gb{1.f};		///< COM_ARM_EKF_GB
+		int32_t prime_id[SENSOR_TYPE_COUNT] {-1, -1, -1, -1}; ///< CAL_xxx_PRIME
+		int32_t sys_has_mag{1};
+		int32_t sys_has_baro{1};
+		int32_t airspeed_mode{0};	///< FW_ARSP_MODE
+		int32_t estimator_group{2};	///< SYS_MC_EST_GROUP
+	};
+
+	SensorHealthMonitor();
+	~SensorHealthMonitor();
+
+	// no copy, assignment, move, move assignment
+	SensorHealthMonitor(const SensorHealthMonitor &) = delete;
+	SensorHealthMonitor &operator=(const SensorHealthMonitor &) = delete;
+	SensorHealthMonitor(SensorHealthMonitor &&) = delete;
+	SensorHealthMonitor &operator=(SensorHealthMonitor &&) = delete;
+
+	/**
+	 * Copy new samples and parameters and publish sensor_health if it changed.
+	 * Cheap if nothing changed, called every commander cycle and only from there.
+	 */
+	void update();
+
+	/** hold while reading the state */
+	void lock() { pthread_mutex_lock(&_mutex); }
+	void unlock() { pthread_mutex_unlock(&_mutex); }
+
+	/** the sensor instance is published */
+	bool exists(SensorType type, unsigned instance) const { return _sensors[type][instance].handle >= 0; }
+
+	/** the last sample is not older than 1 s */
+	bool dataValid(SensorType type, unsigned instance) const
+	{
+		return hrt_elapsed_time(&_sensors[type][instance].timestamp) < 1000 * 1000;
+	}
+
+	/** the device id is in the calibration parameters (always true for barometers) */
+	bool calibrated(SensorType type, unsigned instance) const { return _sensors[type][instance].calibrated; }
+
+	int32_t deviceId(SensorType type, unsigned instance) const { return _sensors[type][instance].device_id; }
+
+	/** magnitude of the last accelerometer sample [m/s^2] */
+	float accelMagnitude(unsigned instance) const { return _sensors[SENSOR_ACCEL][instance].accel_magnitude; }
+
+	const Limits &limits() const { return _limits; }
+
+	/** @return nullptr if the topic was never published */
+	const sensor_preflight_s *sensorPreflight() const { return published(_sensor_preflight_sub); }
+	const estimator_status_s *estimatorStatus() const { return published(_estimator_status_sub); }
+	const airspeed_s *airspeed() const { return published(_airspeed_sub); }
+	const differential_pressure_s *differentialPressure() const { return published(_differential_pressure_sub); }
+	const system_power_s *systemPower() const { return published(_system_power_sub); }
+
+private:
+	static constexpr unsigned MAX_CALIBRATIONS = 4;
+
+	struct Sensor {
+		int handle{-1};			///< subscribed once the instance is published
+		hrt_abstime timestamp{0};	///< of the last sample
+		int32_t device_id{-1};
+		bool calibrated{false};
+		float accel_magnitude{0.f};
+	};
+
+	template<typename T>
+	static const T *published(const uORB::Subscription<T> &sub)
+	{
+		return sub.get().timestamp != 0 ? &sub.get() : nullptr;
+	}
+
+	void updateParams();
+
+	/** copy a new sample, return true if the device id changed */
+	bool updateSensor(SensorType type, unsigned instance);
+
+	bool checkCalibration(SensorType type, int32_t device_id) const;
+
+	void publish();
+
+	Sensor _sensors[SENSOR_TYPE_COUNT][MAX_INSTANCES] {};
+
+	/** CAL_xxxN_ID handles, PARAM_INVALID terminated */
+	param_t _calibration_handles[SENSOR_TYPE_COUNT][MAX_CALIBRATIONS];
+
+	Limits _limits{};
+
+	struct ParamHandles {
+		param_t imu_acc;
+		param_t imu_gyr;
+		param_t mag;
+		param_t ekf_hgt;
+		param_t ekf_vel;
+		param_t ekf_pos;
+		param_t ekf_yaw;
+		param_t ekf_ab;
+		param_t ekf_gb;
+		param_t prime_id[SENSOR_TYPE_COUNT];
+		param_t sys_has_mag;
+		param_t sys_has_baro;
+		param_t airspeed_mode;
+		param_t estimator_group;
+	} _param_handles{};
+
+	uORB::Subscription<parameter_update_s> _parameter_update_sub{ORB_ID(parameter_update)};
+	uORB::Subscription<sensor_preflight_s> _sensor_preflight_sub{ORB_ID(sensor_preflight)};
+	uORB::Subscription<estimator_status_s> _estimator_status_sub{ORB_ID(estimator_status)};
+	uORB::Subscription<airspeed_s> _airspeed_sub{ORB_ID(airspeed)};
+	uORB::Subscription<differential_pressure_s> _differential_pressure_sub{ORB_ID(differential_pressure)};
+	uORB::Subscription<system_power_s> _system_power_sub{ORB_ID(system_power)};
+
+	orb_advert_t _sensor_health_pub{nullptr};
+	sensor_health_s _sensor_health{};
+
+	pthread_mutex_t _mutex;
+};
+
+} // namespace Preflight
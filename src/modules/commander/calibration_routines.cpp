@@ -243,19 +243,29 @@ int ellipsoid_fit_least_squares(const float x[], const float y[], const float z[
 {
 	float _fitness = 1.0e30f, _sphere_lambda = 1.0f, _ellipsoid_lambda = 1.0f;
 
+	// an accepted step improving the fitness by less than delta ends the iteration, delta = 0 runs max_iterations times
 	for (int i = 0; i < max_iterations; i++) {
-		run_lm_sphere_fit(x, y, z, _fitness, _sphere_lambda,
-				  size, offset_x, offset_y, offset_z,
-				  sphere_radius, diag_x, diag_y, diag_z, offdiag_x, offdiag_y, offdiag_z);
+		const float fitness = _fitness;
 
+		if (run_lm_sphere_fit(x, y, z, _fitness, _sphere_lambda,
+				      size, offset_x, offset_y, offset_z,
+				      sphere_radius, diag_x, diag_y, diag_z, offdiag_x, offdiag_y, offdiag_z) == 0
+		    && fitness - _fitness < delta) {
+			break;
+		}
 	}
 
 	_fitness = 1.0e30f;
 
 	for (int i = 0; i < max_iterations; i++) {
-		run_lm_ellipsoid_fit(x, y, z, _fitness, _ellipsoid_lambda,
-				     size, offset_x, offset_y, offset_z,
-				     sphere_radius, diag_x, diag_y, diag_z, offdiag_x, offdiag_y, offdiag_z);
+		const float fitness = _fitness;
+
+		if (run_lm_ellipsoid_fit(x, y, z, _fitness, _ellipsoid_lambda,
+					 size, offset_x, offset_y, offset_z,
+					 sphere_radius, diag_x, diag_y, diag_z, offdiag_x, offdiag_y, offdiag_z) == 0
+		    && fitness - _fitness < delta) {
+			break;
+		}
 	}
 
 	return 0;
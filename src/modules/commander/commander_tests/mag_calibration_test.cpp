@@ -0,0 +1,243 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mag_calibration_test.cpp
+ * Magnetometer calibration sample storage and fit tests.
+ *
+ * Compares the hashed sample rejection and the seeded fit against the exhaustive
+ * distance check and the unseeded fit on synthetic datasets.
+ *
+ * The datasets are generated rather than recorded: with known hard and soft iron
+ * the fits can also be checked against the true offsets, and the samples are the
+ * same on every run without shipping log excerpts with the tests.
+ */
+
+#include "mag_calibration_test.h"
+
+#include "../calibration_routines.h"
+#include "../mag_calibration_samples.h"
+
+#include <drivers/drv_hrt.h>
+#include <unit_test.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+class MagCalibrationTest : public UnitTest
+{
+public:
+	MagCalibrationTest() = default;
+	virtual ~MagCalibrationTest() = default;
+
+	virtual bool run_tests();
+
+private:
+	static constexpr unsigned max_count = 240;
+
+	struct Dataset {
+		float offset[3];
+		float scale[3];
+		float noise;
+	};
+
+	struct Fit {
+		float offset[3];
+		float radius;
+		float diag[3];
+		float offdiag[3];
+	};
+
+	bool rejectionTest();
+	bool fitAccuracyTest();
+
+	float random(float min, float max);
+	void sample(const Dataset &dataset, float &x, float &y, float &z);
+	static bool reject_exhaustive(float sx, float sy, float sz, const float x[], const float y[], const float z[],
+				      unsigned count, float min_distance);
+
+	uint32_t _seed{1};
+};
+
+float MagCalibrationTest::random(float min, float max)
+{
+	// deterministic LCG, the datasets have to be the same on every run
+	_seed = _seed * 1664525u + 1013904223u;
+	return min + (max - min) * (float)(_seed >> 8) / (float)(1u << 24);
+}
+
+void MagCalibrationTest::sample(const Dataset &dataset, float &x, float &y, float &z)
+{
+	// point on the earth field sphere, distorted by the soft and hard iron of the dataset
+	float v[3];
+	float norm;
+
+	do {
+		v[0] = random(-1.0f, 1.0f);
+		v[1] = random(-1.0f, 1.0f);
+		v[2] = random(-1.0f, 1.0f);
+		norm = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	} while (norm < 0.1f || norm > 1.0f);
+
+	const float field = 0.5f;
+	x = dataset.scale[0] * field * v[0] / norm + dataset.offset[0] + random(-dataset.noise, dataset.noise);
+	y = dataset.scale[1] * field * v[1] / norm + dataset.offset[1] + random(-dataset.noise, dataset.noise);
+	z = dataset.scale[2] * field * v[2] / norm + dataset.offset[2] + random(-dataset.noise, dataset.noise);
+}
+
+bool MagCalibrationTest::reject_exhaustive(float sx, float sy, float sz, const float x[], const float y[],
+		const float z[], unsigned count, float min_distance)
+{
+	for (unsigned i = 0; i < count; i++) {
+		const float dx = sx - x[i];
+		const float dy = sy - y[i];
+		const float dz = sz - z[i];
+
+		if (sqrtf(dx * dx + dy * dy + dz * dz) < min_distance) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool MagCalibrationTest::rejectionTest()
+{
+	// a large minimum distance to get many rejections
+	const float min_distance = 0.08f;
+	const Dataset dataset{{0.1f, -0.05f, 0.2f}, {1.0f, 1.0f, 1.0f}, 0.01f};
+
+	MagCalibrationSamples samples;
+	ut_assert_true(samples.init(max_count, min_distance));
+
+	float x[max_count];
+	float y[max_count];
+	float z[max_count];
+	unsigned count = 0;
+
+	for (unsigned i = 0; i < 20 * max_count && count < max_count; i++) {
+		float sx, sy, sz;
+		sample(dataset, sx, sy, sz);
+
+		const bool rejected = reject_exhaustive(sx, sy, sz, x, y, z, count, min_distance);
+		ut_compare("hashed and exhaustive rejection match", samples.is_close(sx, sy, sz), rejected);
+
+		if (!rejected) {
+			ut_assert_true(samples.add(sx, sy, sz));
+			x[count] = sx;
+			y[count] = sy;
+			z[count] = sz;
+			count++;
+		}
+	}
+
+	ut_compare("same samples stored", samples.count(), count);
+
+	return true;
+}
+
+bool MagCalibrationTest::fitAccuracyTest()
+{
+	const Dataset datasets[] = {
+		{{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}, 0.002f},
+		{{0.3f, -0.2f, 0.15f}, {1.0f, 1.0f, 1.0f}, 0.005f},
+		{{-0.4f, 0.25f, -0.6f}, {1.1f, 0.9f, 1.05f}, 0.005f},
+		{{0.8f, 0.6f, -0.3f}, {0.85f, 1.2f, 1.0f}, 0.01f},
+	};
+
+	// same minimum distance as the calibration routine
+	const float min_distance = fabsf(5.4f * 0.2f / sqrtf(max_count)) / 3.0f;
+
+	for (const Dataset &dataset : datasets) {
+		MagCalibrationSamples samples;
+		ut_assert_true(samples.init(max_count, min_distance));
+
+		for (unsigned i = 0; i < 20 * max_count && samples.count() < max_count; i++) {
+			float sx, sy, sz;
+			sample(dataset, sx, sy, sz);
+
+			if (!samples.is_close(sx, sy, sz)) {
+				samples.add(sx, sy, sz);
+			}
+		}
+
+		ut_assert_true(samples.count() > max_count / 2);
+
+		// fit as done before: unseeded, all iterations
+		Fit reference{{0.0f, 0.0f, 0.0f}, 0.2f, {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+		hrt_abstime start = hrt_absolute_time();
+		ellipsoid_fit_least_squares(samples.x(), samples.y(), samples.z(), samples.count(), 100, 0.0f,
+					    &reference.offset[0], &reference.offset[1], &reference.offset[2], &reference.radius,
+					    &reference.diag[0], &reference.diag[1], &reference.diag[2],
+					    &reference.offdiag[0], &reference.offdiag[1], &reference.offdiag[2]);
+		const hrt_abstime reference_time = hrt_elapsed_time(&start);
+
+		// fit as done now: seeded with the accumulated linear fit, stopping on convergence
+		Fit fit{{0.0f, 0.0f, 0.0f}, 0.2f, {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+		start = hrt_absolute_time();
+		ut_assert_true(samples.sphere_fit(&fit.offset[0], &fit.offset[1], &fit.offset[2], &fit.radius));
+		ellipsoid_fit_least_squares(samples.x(), samples.y(), samples.z(), samples.count(), 100, 1e-7f,
+					    &fit.offset[0], &fit.offset[1], &fit.offset[2], &fit.radius,
+					    &fit.diag[0], &fit.diag[1], &fit.diag[2],
+					    &fit.offdiag[0], &fit.offdiag[1], &fit.offdiag[2]);
+		const hrt_abstime fit_time = hrt_elapsed_time(&start);
+
+		PX4_INFO("offset %.3f %.3f %.3f: reference %.4f %.4f %.4f (%llu us), seeded %.4f %.4f %.4f (%llu us)",
+			 (double)dataset.offset[0], (double)dataset.offset[1], (double)dataset.offset[2],
+			 (double)reference.offset[0], (double)reference.offset[1], (double)reference.offset[2],
+			 (unsigned long long)reference_time,
+			 (double)fit.offset[0], (double)fit.offset[1], (double)fit.offset[2],
+			 (unsigned long long)fit_time);
+
+		for (int i = 0; i < 3; i++) {
+			// the seeded fit has to be at least as close to the true offset as the reference, within the noise
+			const float reference_error = fabsf(reference.offset[i] - dataset.offset[i]);
+			const float fit_error = fabsf(fit.offset[i] - dataset.offset[i]);
+			ut_assert("offset error not larger than reference", fit_error <= reference_error + dataset.noise);
+			// both converge to the same minimum: within 0.1 mG
+			ut_assert("offset matches reference", fabsf(fit.offset[i] - reference.offset[i]) < 1e-4f);
+		}
+	}
+
+	return true;
+}
+
+bool MagCalibrationTest::run_tests()
+{
+	ut_run_test(rejectionTest);
+	ut_run_test(fitAccuracyTest);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test(magCalibrationTest, MagCalibrationTest)
@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file sensor_health_test.cpp
+ * Sensor health monitor of the preflight checks: sensor instances appearing,
+ * stale data and calibration changes.
+ */
+
+#include "sensor_health_test.h"
+
+#include "../SensorHealthMonitor.hpp"
+
+#include <drivers/drv_hrt.h>
+#include <parameters/param.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/sensor_accel.h>
+#include <unit_test.h>
+
+using namespace time_literals;
+using Preflight::SensorHealthMonitor;
+
+class SensorHealthTest : public UnitTest
+{
+public:
+	SensorHealthTest() = default;
+	virtual ~SensorHealthTest() = default;
+
+	virtual bool run_tests();
+
+private:
+	/** not used by any real sensor */
+	static constexpr int32_t test_device_id = 0x7fff01;
+
+	bool newInstanceTest();
+	bool calibrationTest();
+
+	/** publish an accelerometer sample on a new instance, returns the instance or -1 */
+	static int advertiseAccel(orb_advert_t &pub, hrt_abstime timestamp);
+};
+
+int SensorHealthTest::advertiseAccel(orb_advert_t &pub, hrt_abstime timestamp)
+{
+	sensor_accel_s accel{};
+	accel.timestamp = timestamp;
+	accel.device_id = test_device_id;
+	accel.x = 3.f;
+	accel.z = -4.f;
+
+	int instance = -1;
+	pub = orb_advertise_multi(ORB_ID(sensor_accel), &accel, &instance, ORB_PRIO_MIN);
+
+	if (pub == nullptr || instance < 0 || instance >= (int)SensorHealthMonitor::MAX_INSTANCES) {
+		return -1;
+	}
+
+	return instance;
+}
+
+bool SensorHealthTest::newInstanceTest()
+{
+	SensorHealthMonitor monitor;
+	monitor.update();
+
+	orb_advert_t pub = nullptr;
+	const int instance = advertiseAccel(pub, hrt_absolute_time());
+	ut_assert("accel instance advertised", instance >= 0);
+
+	const bool existed = monitor.exists(SensorHealthMonitor::SENSOR_ACCEL, instance);
+	monitor.update();
+
+	const bool exists = monitor.exists(SensorHealthMonitor::SENSOR_ACCEL, instance);
+	const bool valid = monitor.dataValid(SensorHealthMonitor::SENSOR_ACCEL, instance);
+	const bool calibrated = monitor.calibrated(SensorHealthMonitor::SENSOR_ACCEL, instance);
+	const int32_t device_id = monitor.deviceId(SensorHealthMonitor::SENSOR_ACCEL, instance);
+	const float magnitude = monitor.accelMagnitude(instance);
+
+	// a sample older than 1 s is not valid anymore
+	sensor_accel_s accel{};
+	accel.timestamp = hrt_absolute_time() - 2_s;
+	accel.device_id = test_device_id;
+	orb_publish(ORB_ID(sensor_accel), pub, &accel);
+	monitor.update();
+	const bool stale_valid = monitor.dataValid(SensorHealthMonitor::SENSOR_ACCEL, instance);
+
+	orb_unadvertise(pub);
+
+	ut_assert_false(existed);
+	ut_assert_true(exists);
+	ut_assert_true(valid);
+	ut_assert("test device id is not calibrated", !calibrated);
+	ut_compare("device id", device_id, test_device_id);
+	ut_compare_float("accel magnitude", magnitude, 5.f, 3);
+	ut_assert_false(stale_valid);
+	return true;
+}
+
+bool SensorHealthTest::calibrationTest()
+{
+	const param_t cal_acc0_id = param_find("CAL_ACC0_ID");
+	ut_assert("CAL_ACC0_ID exists", cal_acc0_id != PARAM_INVALID);
+
+	int32_t original_id = 0;
+	param_get(cal_acc0_id, &original_id);
+
+	SensorHealthMonitor monitor;
+
+	orb_advert_t pub = nullptr;
+	const int instance = advertiseAccel(pub, hrt_absolute_time());
+	ut_assert("accel instance advertised", instance >= 0);
+
+	monitor.update();
+	const bool calibrated_before = monitor.calibrated(SensorHealthMonitor::SENSOR_ACCEL, instance);
+
+	// the calibration is re-evaluated on parameter_update, without a new sample
+	int32_t id = test_device_id;
+	param_set(cal_acc0_id, &id);
+	monitor.update();
+	const bool calibrated = monitor.calibrated(SensorHealthMonitor::SENSOR_ACCEL, instance);
+
+	param_set(cal_acc0_id, &original_id);
+	monitor.update();
+	const bool calibrated_after = monitor.calibrated(SensorHealthMonitor::SENSOR_ACCEL, instance);
+
+	orb_unadvertise(pub);
+
+	ut_assert_false(calibrated_before);
+	ut_assert_true(calibrated);
+	ut_assert_false(calibrated_after);
+	return true;
+}
+
+bool SensorHealthTest::run_tests()
+{
+	ut_run_test(newInstanceTest);
+	ut_run_test(calibrationTest);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test(sensorHealthTest, SensorHealthTest)
@@ -305,7 +305,8 @@ bool StateMachineHelperTest::armingStateTransitionTest()
 					     nullptr /* no mavlink_log_pub */,
 					     &status_flags,
 					     (check_gps ? ARM_REQ_GPS_BIT : 0),
-					     2e6 /* 2 seconds after boot, everything should be checked */
+					     2e6 /* 2 seconds after boot, everything should be checked */,
+					     nullptr /* no pre-arm checks */
 								    );
 
 		// Validate result of transition
@@ -41,6 +41,7 @@
 #include "commander_helper.h"
 #include "calibration_routines.h"
 #include "calibration_messages.h"
+#include "mag_calibration_samples.h"
 
 #include <px4_defines.h>
 #include <px4_posix.h>
@@ -88,11 +89,8 @@ typedef struct  {
 	unsigned int	calibration_points_perside;
 	unsigned int	calibration_interval_perside_seconds;
 	uint64_t	calibration_interval_perside_useconds;
-	unsigned int	calibration_counter_total[max_mags];
 	bool		side_data_collected[detect_orientation_side_count];
-	float		*x[max_mags];
-	float		*y[max_mags];
-	float		*z[max_mags];
+	MagCalibrationSamples	samples[max_mags];
 } mag_worker_data_t;
 
 
@@ -267,25 +265,6 @@ int do_mag_calibration(orb_advert_t *mavlink_log_pub)
 	return result;
 }
 
-static bool reject_sample(float sx, float sy, float sz, float x[], float y[], float z[], unsigned count,
-			  unsigned max_count)
-{
-	float min_sample_dist = fabsf(5.4f * mag_sphere_radius / sqrtf(max_count)) / 3.0f;
-
-	for (size_t i = 0; i < count; i++) {
-		float dx = sx - x[i];
-		float dy = sy - y[i];
-		float dz = sz - z[i];
-		float dist = sqrtf(dx * dx + dy * dy + dz * dz);
-
-		if (dist < min_sample_dist) {
-			return true;
-		}
-	}
-
-	return false;
-}
-
 static unsigned progress_percentage(mag_worker_data_t *worker_data)
 {
 	return 100 * ((float)worker_data->done_count) / calibration_sides;
@@ -453,39 +432,27 @@ static calibrate_return mag_calibration_worker(detect_orientation_return orienta
 
 		if (poll_ret > 0) {
 
-			int prev_count[max_mags];
+			struct mag_report mag[max_mags];
 			bool rejected = false;
 
 			for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
 
-				prev_count[cur_mag] = worker_data->calibration_counter_total[cur_mag];
-
 				if (worker_data->sub_mag[cur_mag] >= 0) {
-					struct mag_report mag;
-
-					orb_copy(ORB_ID(sensor_mag), worker_data->sub_mag[cur_mag], &mag);
+					orb_copy(ORB_ID(sensor_mag), worker_data->sub_mag[cur_mag], &mag[cur_mag]);
 
 					// Check if this measurement is good to go in
-					rejected = rejected || reject_sample(mag.x, mag.y, mag.z,
-									     worker_data->x[cur_mag], worker_data->y[cur_mag], worker_data->z[cur_mag],
-									     worker_data->calibration_counter_total[cur_mag],
-									     calibration_sides * worker_data->calibration_points_perside);
-
-					worker_data->x[cur_mag][worker_data->calibration_counter_total[cur_mag]] = mag.x;
-					worker_data->y[cur_mag][worker_data->calibration_counter_total[cur_mag]] = mag.y;
-					worker_data->z[cur_mag][worker_data->calibration_counter_total[cur_mag]] = mag.z;
-					worker_data->calibration_counter_total[cur_mag]++;
+					rejected = rejected || worker_data->samples[cur_mag].is_close(mag[cur_mag].x, mag[cur_mag].y, mag[cur_mag].z);
 				}
 			}
 
-			// Keep calibration of all mags in lockstep
-			if (rejected) {
-				// Reset counts, since one of the mags rejected the measurement
+			// Keep calibration of all mags in lockstep, only store the measurement if no mag rejected it
+			if (!rejected) {
 				for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
-					worker_data->calibration_counter_total[cur_mag] = prev_count[cur_mag];
+					if (worker_data->sub_mag[cur_mag] >= 0) {
+						worker_data->samples[cur_mag].add(mag[cur_mag].x, mag[cur_mag].y, mag[cur_mag].z);
+					}
 				}
 
-			} else {
 				calibration_counter_side++;
 
 				unsigned new_progress = progress_percentage(worker_data) +
@@ -566,16 +533,13 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 	for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
 		// Initialize to no subscription
 		worker_data.sub_mag[cur_mag] = -1;
-
-		// Initialize to no memory allocated
-		worker_data.x[cur_mag] = nullptr;
-		worker_data.y[cur_mag] = nullptr;
-		worker_data.z[cur_mag] = nullptr;
-		worker_data.calibration_counter_total[cur_mag] = 0;
 	}
 
 	const unsigned int calibration_points_maxcount = calibration_sides * worker_data.calibration_points_perside;
 
+	// Minimum distance between two samples to get them spread out over the sphere
+	const float min_sample_dist = fabsf(5.4f * mag_sphere_radius / sqrtf(calibration_points_maxcount)) / 3.0f;
+
 	char str[30];
 
 	// Get actual mag count and alloate only as much memory as needed
@@ -587,11 +551,7 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 	}
 
 	for (size_t cur_mag = 0; cur_mag < orb_mag_count && cur_mag < max_mags; cur_mag++) {
-		worker_data.x[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-		worker_data.y[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-		worker_data.z[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-
-		if (worker_data.x[cur_mag] == nullptr || worker_data.y[cur_mag] == nullptr || worker_data.z[cur_mag] == nullptr) {
+		if (!worker_data.samples[cur_mag].init(calibration_points_maxcount, min_sample_dist)) {
 			calibration_log_critical(mavlink_log_pub, "ERROR: out of memory");
 			result = calibrate_return_error;
 		}
@@ -725,10 +685,13 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 		for (unsigned cur_mag = 0; cur_mag < max_mags; cur_mag++) {
 			if (device_ids[cur_mag] != 0) {
 				// Mag in this slot is available and we should have values for it to calibrate
+				const MagCalibrationSamples &samples = worker_data.samples[cur_mag];
 
-				ellipsoid_fit_least_squares(worker_data.x[cur_mag], worker_data.y[cur_mag], worker_data.z[cur_mag],
-							    worker_data.calibration_counter_total[cur_mag],
-							    100, 0.0f,
+				// Start the iterative fit at the linear sphere fit accumulated while collecting
+				samples.sphere_fit(&sphere_x[cur_mag], &sphere_y[cur_mag], &sphere_z[cur_mag], &sphere_radius[cur_mag]);
+
+				ellipsoid_fit_least_squares(samples.x(), samples.y(), samples.z(), samples.count(),
+							    100, 1e-7f,
 							    &sphere_x[cur_mag], &sphere_y[cur_mag], &sphere_z[cur_mag],
 							    &sphere_radius[cur_mag],
 							    &diag_x[cur_mag], &diag_y[cur_mag], &diag_z[cur_mag],
@@ -755,16 +718,16 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 		// printf("RAW DATA:\n--------------------\n");
 		// for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
 
-		// 	if (worker_data.calibration_counter_total[cur_mag] == 0) {
+		// 	if (worker_data.samples[cur_mag].count() == 0) {
 		// 		continue;
 		// 	}
 
-		// 	printf("RAW: MAG %u with %u samples:\n", (unsigned)cur_mag, (unsigned)worker_data.calibration_counter_total[cur_mag]);
+		// 	printf("RAW: MAG %u with %u samples:\n", (unsigned)cur_mag, worker_data.samples[cur_mag].count());
 
-		// 	for (size_t i = 0; i < worker_data.calibration_counter_total[cur_mag]; i++) {
-		// 		float x = worker_data.x[cur_mag][i];
-		// 		float y = worker_data.y[cur_mag][i];
-		// 		float z = worker_data.z[cur_mag][i];
+		// 	for (size_t i = 0; i < worker_data.samples[cur_mag].count(); i++) {
+		// 		float x = worker_data.samples[cur_mag].x()[i];
+		// 		float y = worker_data.samples[cur_mag].y()[i];
+		// 		float z = worker_data.samples[cur_mag].z()[i];
 		// 		printf("%8.4f, %8.4f, %8.4f\n", (double)x, (double)y, (double)z);
 		// 	}
 
@@ -774,16 +737,16 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 		// printf("CALIBRATED DATA:\n--------------------\n");
 		// for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
 
-		// 	if (worker_data.calibration_counter_total[cur_mag] == 0) {
+		// 	if (worker_data.samples[cur_mag].count() == 0) {
 		// 		continue;
 		// 	}
 
-		// 	printf("Calibrated: MAG %u with %u samples:\n", (unsigned)cur_mag, (unsigned)worker_data.calibration_counter_total[cur_mag]);
+		// 	printf("Calibrated: MAG %u with %u samples:\n", (unsigned)cur_mag, worker_data.samples[cur_mag].count());
 
-		// 	for (size_t i = 0; i < worker_data.calibration_counter_total[cur_mag]; i++) {
-		// 		float x = worker_data.x[cur_mag][i] - sphere_x[cur_mag];
-		// 		float y = worker_data.y[cur_mag][i] - sphere_y[cur_mag];
-		// 		float z = worker_data.z[cur_mag][i] - sphere_z[cur_mag];
+		// 	for (size_t i = 0; i < worker_data.samples[cur_mag].count(); i++) {
+		// 		float x = worker_data.samples[cur_mag].x()[i] - sphere_x[cur_mag];
+		// 		float y = worker_data.samples[cur_mag].y()[i] - sphere_y[cur_mag];
+		// 		float z = worker_data.samples[cur_mag].z()[i] - sphere_z[cur_mag];
 		// 		printf("%8.4f, %8.4f, %8.4f\n", (double)x, (double)y, (double)z);
 		// 	}
 
@@ -792,13 +755,6 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 		// }
 	}
 
-	// Data points are no longer needed
-	for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
-		free(worker_data.x[cur_mag]);
-		free(worker_data.y[cur_mag]);
-		free(worker_data.z[cur_mag]);
-	}
-
 	if (result == calibrate_return_ok) {
 
 		for (unsigned cur_mag = 0; cur_mag < max_mags; cur_mag++) {
@@ -0,0 +1,217 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mag_calibration_samples.cpp
+ * Sample storage for the magnetometer calibration.
+ */
+
+#include "mag_calibration_samples.h"
+
+#include <px4_defines.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <matrix/math.hpp>
+
+MagCalibrationSamples::~MagCalibrationSamples()
+{
+	free(_x);
+	free(_y);
+	free(_z);
+	free(_next);
+	free(_buckets);
+}
+
+bool
+MagCalibrationSamples::init(unsigned max_count, float min_distance)
+{
+	if (max_count == 0 || max_count >= END || !(min_distance > 0.0f)) {
+		return false;
+	}
+
+	// at least twice as many buckets as samples keeps the chains short
+	unsigned num_buckets = 16;
+
+	while (num_buckets < 2 * max_count) {
+		num_buckets *= 2;
+	}
+
+	_x = reinterpret_cast<float *>(malloc(sizeof(float) * max_count));
+	_y = reinterpret_cast<float *>(malloc(sizeof(float) * max_count));
+	_z = reinterpret_cast<float *>(malloc(sizeof(float) * max_count));
+	_next = reinterpret_cast<uint16_t *>(malloc(sizeof(uint16_t) * max_count));
+	_buckets = reinterpret_cast<uint16_t *>(malloc(sizeof(uint16_t) * num_buckets));
+
+	if (_x == nullptr || _y == nullptr || _z == nullptr || _next == nullptr || _buckets == nullptr) {
+		return false;
+	}
+
+	_max_count = max_count;
+	_bucket_mask = num_buckets - 1;
+	_min_distance = min_distance;
+	_voxel_scale = 1.0f / min_distance;
+
+	clear();
+
+	return true;
+}
+
+void
+MagCalibrationSamples::clear()
+{
+	_count = 0;
+
+	if (_buckets != nullptr) {
+		for (unsigned i = 0; i <= _bucket_mask; i++) {
+			_buckets[i] = END;
+		}
+	}
+
+	memset(_ata, 0, sizeof(_ata));
+	memset(_atb, 0, sizeof(_atb));
+}
+
+int32_t
+MagCalibrationSamples::voxel(float v) const
+{
+	const float f = floorf(v * _voxel_scale);
+
+	// also maps NaN to voxel 0, such samples never compare as close
+	return (f > -1e6f && f < 1e6f) ? (int32_t)f : 0;
+}
+
+unsigned
+MagCalibrationSamples::bucket(int32_t vx, int32_t vy, int32_t vz) const
+{
+	const uint32_t h = ((uint32_t)vx * 73856093u) ^ ((uint32_t)vy * 19349663u) ^ ((uint32_t)vz * 83492791u);
+	return h & _bucket_mask;
+}
+
+bool
+MagCalibrationSamples::is_close(float x, float y, float z) const
+{
+	const int32_t vx = voxel(x);
+	const int32_t vy = voxel(y);
+	const int32_t vz = voxel(z);
+
+	const float min_distance_sq = _min_distance * _min_distance;
+
+	// with the voxel size equal to the minimum distance any close sample is in a neighbouring voxel
+	for (int32_t dx = -1; dx <= 1; dx++) {
+		for (int32_t dy = -1; dy <= 1; dy++) {
+			for (int32_t dz = -1; dz <= 1; dz++) {
+				for (uint16_t i = _buckets[bucket(vx + dx, vy + dy, vz + dz)]; i != END; i = _next[i]) {
+					const float ex = x - _x[i];
+					const float ey = y - _y[i];
+					const float ez = z - _z[i];
+
+					if (ex * ex + ey * ey + ez * ez < min_distance_sq) {
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+bool
+MagCalibrationSamples::add(float x, float y, float z)
+{
+	if (_count >= _max_count) {
+		return false;
+	}
+
+	const unsigned b = bucket(voxel(x), voxel(y), voxel(z));
+
+	_x[_count] = x;
+	_y[_count] = y;
+	_z[_count] = z;
+	_next[_count] = _buckets[b];
+	_buckets[b] = _count;
+	_count++;
+
+	const float row[4] = {2.0f * x, 2.0f * y, 2.0f * z, 1.0f};
+	const float rhs = x * x + y * y + z * z;
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = i; j < 4; j++) {
+			_ata[i][j] += row[i] * row[j];
+		}
+
+		_atb[i] += row[i] * rhs;
+	}
+
+	return true;
+}
+
+bool
+MagCalibrationSamples::sphere_fit(float *offset_x, float *offset_y, float *offset_z, float *sphere_radius) const
+{
+	if (_count < 4) {
+		return false;
+	}
+
+	matrix::SquareMatrix<float, 4> ata;
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = i; j < 4; j++) {
+			ata(i, j) = _ata[i][j];
+			ata(j, i) = _ata[i][j];
+		}
+	}
+
+	matrix::SquareMatrix<float, 4> ata_inv;
+
+	if (!ata.I(ata_inv)) {
+		return false;
+	}
+
+	const matrix::Vector<float, 4> solution = ata_inv * matrix::Vector<float, 4>(_atb);
+
+	const float radius_sq = solution(3) + solution(0) * solution(0) + solution(1) * solution(1) + solution(2) * solution(2);
+
+	if (!PX4_ISFINITE(radius_sq) || radius_sq <= 0.0f) {
+		return false;
+	}
+
+	*offset_x = solution(0);
+	*offset_y = solution(1);
+	*offset_z = solution(2);
+	*sphere_radius = sqrtf(radius_sq);
+
+	return true;
+}
@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mag_calibration_samples.h
+ * Sample storage for the magnetometer calibration.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Samples of one magnetometer collected during calibration.
+ *
+ * The samples are indexed by a voxel hash with the minimum sample distance as voxel size,
+ * so the distance check of a new sample only visits the 27 neighbouring voxels instead of
+ * all previous samples. The normal equations of the linear sphere fit are accumulated with
+ * every added sample, which gives a starting point for the iterative fit without an extra
+ * pass over the data.
+ */
+class MagCalibrationSamples
+{
+public:
+	MagCalibrationSamples() = default;
+	~MagCalibrationSamples();
+
+	// no copy, assignment, move, move assignment
+	MagCalibrationSamples(const MagCalibrationSamples &) = delete;
+	MagCalibrationSamples &operator=(const MagCalibrationSamples &) = delete;
+	MagCalibrationSamples(MagCalibrationSamples &&) = delete;
+	MagCalibrationSamples &operator=(MagCalibrationSamples &&) = delete;
+
+	/**
+	 * Allocate the storage.
+	 *
+	 * @param max_count maximum number of samples
+	 * @param min_distance minimum distance between two accepted samples
+	 * @return true on success
+	 */
+	bool init(unsigned max_count, float min_distance);
+
+	/**
+	 * @return true if a stored sample is closer than the minimum distance
+	 */
+	bool is_close(float x, float y, float z) const;
+
+	/**
+	 * Store a sample.
+	 *
+	 * @return false if the storage is full
+	 */
+	bool add(float x, float y, float z);
+
+	/**
+	 * Remove all samples.
+	 */
+	void clear();
+
+	unsigned count() const { return _count; }
+
+	const float *x() const { return _x; }
+	const float *y() const { return _y; }
+	const float *z() const { return _z; }
+
+	/**
+	 * Solve the accumulated linear least-squares sphere fit.
+	 *
+	 * @return true if the fit is well defined
+	 */
+	bool sphere_fit(float *offset_x, float *offset_y, float *offset_z, float *sphere_radius) const;
+
+private:
+	static constexpr uint16_t END = UINT16_MAX;
+
+	unsigned bucket(int32_t vx, int32_t vy, int32_t vz) const;
+	int32_t voxel(float v) const;
+
+	float *_x{nullptr};
+	float *_y{nullptr};
+	float *_z{nullptr};
+	uint16_t *_next{nullptr};	///< next sample in the same hash bucket
+	uint16_t *_buckets{nullptr};	///< first sample of each hash bucket
+
+	unsigned _count{0};
+	unsigned _max_count{0};
+	unsigned _bucket_mask{0};
+
+	float _min_distance{0.0f};
+	float _voxel_scale{0.0f};
+
+	/* normal equations of |p|^2 = 2 p.c + d with c the center and d = r^2 - |c|^2 */
+	float _ata[4][4] {};
+	float _atb[4] {};
+};
@@ -52,6 +52,11 @@
 #include <uORB/topics/commander_state.h>
 #include <uORB/topics/vehicle_status_flags.h>
 
+namespace Preflight
+{
+class SensorHealthMonitor;
+}
+
 typedef enum {
 	TRANSITION_DENIED = -1,
 	TRANSITION_NOT_CHANGED = 0,
@@ -79,10 +84,14 @@ extern const char *const arming_state_names[];
 
 bool is_safe(const safety_s &safety, const actuator_armed_s &armed);
 
+/**
+ * @param sensor_health sensor state for the pre-arm checks, may be nullptr if fRunPreArmChecks is false
+ */
 transition_result_t
 arming_state_transition(vehicle_status_s *status, const safety_s &safety, const arming_state_t new_arming_state,
 			actuator_armed_s *armed, const bool fRunPreArmChecks, orb_advert_t *mavlink_log_pub,
-			vehicle_status_flags_s *status_flags, const uint8_t arm_requirements, const hrt_abstime &time_since_boot);
+			vehicle_status_flags_s *status_flags, const uint8_t arm_requirements, const hrt_abstime &time_since_boot,
+			Preflight::SensorHealthMonitor *sensor_health);
 
 transition_result_t
 main_state_transition(const vehicle_status_s &status, const main_state_t new_main_state,
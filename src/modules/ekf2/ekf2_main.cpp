@@ -43,6 +43,7 @@
 #include <drivers/drv_hrt.h>
 #include <lib/ecl/EKF/ekf.h>
 #include <lib/mathlib/mathlib.h>
+#include <lib/perf/latency_trace.h>
 #include <lib/perf/perf_counter.h>
 #include <px4_defines.h>
 #include <px4_module.h>
@@ -1798,6 +1799,7 @@ bool Ekf2::publish_attitude(const sensor_combined_s &sensors, const hrt_abstime
 		// generate vehicle attitude quaternion data
 		vehicle_attitude_s att;
 		att.timestamp = now;
+		att.timestamp_sample = sensors.timestamp;
 
 		const Quatf q{_ekf.calculate_quaternion()};
 		q.copyTo(att.q);
@@ -1813,6 +1815,7 @@ bool Ekf2::publish_attitude(const sensor_combined_s &sensors, const hrt_abstime
 
 		int instance;
 		orb_publish_auto(ORB_ID(vehicle_attitude), &_att_pub, &att, &instance, ORB_PRIO_HIGH);
+		latency_trace_record(LATENCY_TRACE_VEHICLE_ATTITUDE, att.timestamp_sample);
 
 		return true;
 
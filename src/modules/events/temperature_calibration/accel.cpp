@@ -159,17 +159,23 @@ int TemperatureCalibrationAccel::update_sensor_instance(PerSensorData &data, int
 
 	//update linear fit matrices
 	double relative_temperature = (double)data.sensor_sample_filt[3] - (double)data.ref_temp;
-	data.P[0].update(relative_temperature, (double)data.sensor_sample_filt[0]);
-	data.P[1].update(relative_temperature, (double)data.sensor_sample_filt[1]);
-	data.P[2].update(relative_temperature, (double)data.sensor_sample_filt[2]);
+	double samples[3];
+
+	for (int axis = 0; axis < 3; axis++) { samples[axis] = (double)data.sensor_sample_filt[axis]; }
+
+	data.P.update(relative_temperature, samples);
 
 	return 1;
 }
 
 int TemperatureCalibrationAccel::finish()
 {
+	int fit_result = PX4_OK;
+
 	for (unsigned uorb_index = 0; uorb_index < _num_sensor_instances; uorb_index++) {
-		finish_sensor_instance(_data[uorb_index], uorb_index);
+		if (finish_sensor_instance(_data[uorb_index], uorb_index) != PX4_OK) {
+			fit_result = PX4_ERROR;
+		}
 	}
 
 	int32_t enabled = 1;
@@ -179,7 +185,7 @@ int TemperatureCalibrationAccel::finish()
 		PX4_ERR("unable to reset TC_A_ENABLE (%i)", result);
 	}
 
-	return result;
+	return result == PX4_OK ? fit_result : result;
 }
 
 int TemperatureCalibrationAccel::finish_sensor_instance(PerSensorData &data, int sensor_index)
@@ -189,17 +195,21 @@ int TemperatureCalibrationAccel::finish_sensor_instance(PerSensorData &data, int
 	}
 
 	double res[3][4] = {};
-	data.P[0].fit(res[0]);
+
+	if (!data.P.fit(0, res[0]) || !data.P.fit(1, res[1]) || !data.P.fit(2, res[2])) {
+		PX4_ERR("Accel %d: temperature range too small for the fit", sensor_index);
+		data.tempcal_complete = true;
+		return PX4_ERROR;
+	}
+
 	res[0][3] = 0.0; // normalise the correction to be zero at the reference temperature
 	PX4_INFO("Result Accel %d Axis 0: %.20f %.20f %.20f %.20f", sensor_index, (double)res[0][0], (double)res[0][1],
 		 (double)res[0][2],
 		 (double)res[0][3]);
-	data.P[1].fit(res[1]);
 	res[1][3] = 0.0; // normalise the correction to be zero at the reference temperature
 	PX4_INFO("Result Accel %d Axis 1: %.20f %.20f %.20f %.20f", sensor_index, (double)res[1][0], (double)res[1][1],
 		 (double)res[1][2],
 		 (double)res[1][3]);
-	data.P[2].fit(res[2]);
 	res[2][3] = 0.0; // normalise the correction to be zero at the reference temperature
 	PX4_INFO("Result Accel %d Axis 2: %.20f %.20f %.20f %.20f", sensor_index, (double)res[2][0], (double)res[2][1],
 		 (double)res[2][2],
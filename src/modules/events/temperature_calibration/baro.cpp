@@ -146,15 +146,20 @@ int TemperatureCalibrationBaro::update_sensor_instance(PerSensorData &data, int
 
 	//update linear fit matrices
 	double relative_temperature = (double)data.sensor_sample_filt[1] - (double)data.ref_temp;
-	data.P[0].update(relative_temperature, (double)data.sensor_sample_filt[0]);
+	const double sample = (double)data.sensor_sample_filt[0];
+	data.P.update(relative_temperature, &sample);
 
 	return 1;
 }
 
 int TemperatureCalibrationBaro::finish()
 {
+	int fit_result = PX4_OK;
+
 	for (unsigned uorb_index = 0; uorb_index < _num_sensor_instances; uorb_index++) {
-		finish_sensor_instance(_data[uorb_index], uorb_index);
+		if (finish_sensor_instance(_data[uorb_index], uorb_index) != PX4_OK) {
+			fit_result = PX4_ERROR;
+		}
 	}
 
 	int32_t enabled = 1;
@@ -164,7 +169,7 @@ int TemperatureCalibrationBaro::finish()
 		PX4_ERR("unable to reset TC_B_ENABLE (%i)", result);
 	}
 
-	return result;
+	return result == PX4_OK ? fit_result : result;
 }
 
 int TemperatureCalibrationBaro::finish_sensor_instance(PerSensorData &data, int sensor_index)
@@ -174,7 +179,13 @@ int TemperatureCalibrationBaro::finish_sensor_instance(PerSensorData &data, int
 	}
 
 	double res[POLYFIT_ORDER + 1] = {};
-	data.P[0].fit(res);
+
+	if (!data.P.fit(0, res)) {
+		PX4_ERR("Baro %d: temperature range too small for the fit", sensor_index);
+		data.tempcal_complete = true;
+		return PX4_ERROR;
+	}
+
 	res[POLYFIT_ORDER] =
 		0.0; // normalise the correction to be zero at the reference temperature by setting the X^0 coefficient to zero
 	PX4_INFO("Result baro %u %.20f %.20f %.20f %.20f %.20f %.20f", sensor_index, (double)res[0],
@@ -167,7 +167,7 @@ protected:
 
 	struct PerSensorData {
 		float sensor_sample_filt[Dim + 1]; ///< last value is the temperature
-		polyfitter < PolyfitOrder + 1 > P[Dim];
+		polyfitter < PolyfitOrder + 1, Dim > P; ///< fit of each axis against the temperature
 		unsigned hot_soak_sat = 0; /**< counter that increments every time the sensor temperature reduces
 									from the last reading */
 		uint32_t device_id = 0; ///< ID for the sensor being calibrated
@@ -80,6 +80,15 @@ and VTY = transpose(V)*Y =
 |∑(i=0..m)yi*xi^n|
 |__            __|
 
+VTV only depends on the 2n+1 power sums ∑xi^k, which are shared between all the measurement axes that are
+fitted against the same x (e.g. the X/Y/Z axes of a sensor against its temperature). So only these sums and
+the n+1 sums ∑yi*xi^k per axis are accumulated, which makes an update O(n) and the memory use independent of m.
+
+VTV is symmetric positive definite if the x values are spread enough for the requested order. The solution is
+computed with a Cholesky decomposition after scaling x to [-1, 1], which keeps VTV well conditioned for the high
+powers. A (nearly) singular VTV, e.g. if the temperature barely changed during the calibration, is reported as
+failure instead of returning meaningless coefficients.
+
 */
 
 /*
@@ -112,92 +121,123 @@ Author: Siddharth Bharat Purohit
 #define PF_DEBUG(fmt, ...)
 #endif
 
-template<int _forder>
+/**
+ * Least squares fit of _dim polynomials with _forder coefficients against the same variable x.
+ * The coefficients are returned highest order first.
+ */
+template<int _forder, int _dim = 1>
 class polyfitter
 {
 public:
 	polyfitter() {}
 
-	void update(double x, double y)
-	{
-		update_VTV(x);
-		update_VTY(x, y);
-	}
-
-	bool fit(double res[])
+	/**
+	 * add a sample
+	 * @param x independent variable
+	 * @param y measurement of each axis (length _dim)
+	 */
+	void update(double x, const double y[])
 	{
-		//Do inverse of VTV
-		matrix::SquareMatrix<double, _forder> IVTV;
-
-		IVTV = _VTV.I();
+		double temp = 1.0;
 
-		for (int i = 0; i < _forder; i++) {
-			for (int j = 0; j < _forder; j++) {
-				PF_DEBUG("%.10f ", (double)IVTV(i, j));
+		for (int k = 0; k < 2 * _forder - 1; k++) {
+			if (k < _forder) {
+				for (int axis = 0; axis < _dim; axis++) {
+					_sum_xy[axis][k] += y[axis] * temp;
+				}
 			}
 
-			PF_DEBUG("\n");
+			_sum_x[k] += temp;
+			temp *= x;
 		}
 
-		for (int i = 0; i < _forder; i++) {
-			res[i] = 0.0;
+		if (fabs(x) > _x_abs_max) {
+			_x_abs_max = fabs(x);
+		}
+	}
 
-			for (int j = 0; j < _forder; j++) {
-				res[i] += IVTV(i, j) * (double)_VTY(j);
-			}
+	/**
+	 * solve for the coefficients of one axis
+	 * @param axis measurement axis index
+	 * @param res returned coefficients (length _forder), highest order first
+	 * @return false if there are not enough samples or x did not vary enough for the polynomial order
+	 */
+	bool fit(int axis, double res[]) const
+	{
+		if (axis < 0 || axis >= _dim || _sum_x[0] < _forder || _x_abs_max < DBL_EPSILON) {
+			return false;
+		}
+
+		// normal equations in u = x / _x_abs_max: VTV(i, j) = ∑u^(i+j), VTY(i) = ∑y*u^i
+		double scale[2 * _forder - 1];
+		scale[0] = 1.0;
 
-			PF_DEBUG("%.10f ", res[i]);
+		for (int k = 1; k < 2 * _forder - 1; k++) {
+			scale[k] = scale[k - 1] / _x_abs_max;
 		}
 
-		return true;
-	}
+		// Cholesky decomposition VTV = L*L^T, in place in the lower triangle
+		double L[_forder][_forder];
 
-private:
-	matrix::SquareMatrix<double, _forder> _VTV;
-	matrix::Vector<double, _forder> _VTY;
+		for (int i = 0; i < _forder; i++) {
+			for (int j = 0; j <= i; j++) {
+				double sum = _sum_x[i + j] * scale[i + j];
 
-	void update_VTY(double x, double y)
-	{
-		double temp = 1.0;
-		PF_DEBUG("O %.6f\n", (double)x);
+				for (int k = 0; k < j; k++) {
+					sum -= L[i][k] * L[j][k];
+				}
 
-		for (int i = _forder - 1; i >= 0; i--) {
-			_VTY(i) += y * temp;
-			temp *= x;
-			PF_DEBUG("%.6f ", (double)_VTY(i));
-		}
+				if (i == j) {
+					// pivot relative to the diagonal element, which is at most the number of samples
+					if (sum <= _sum_x[2 * i] * scale[2 * i] * 1e-12) {
+						PF_DEBUG("polyfit: singular at %d\n", i);
+						return false;
+					}
 
-		PF_DEBUG("\n");
-	}
+					L[i][i] = sqrt(sum);
 
-	void update_VTV(double x)
-	{
-		double temp = 1.0;
-		int8_t z;
+				} else {
+					L[i][j] = sum / L[j][j];
+				}
+			}
+		}
+
+		// forward substitution L*z = VTY, then back substitution L^T*c = z
+		double c[_forder];
 
 		for (int i = 0; i < _forder; i++) {
-			for (int j = 0; j < _forder; j++) {
-				PF_DEBUG("%.10f ", (double)_VTV(i, j));
+			double sum = _sum_xy[axis][i] * scale[i];
+
+			for (int k = 0; k < i; k++) {
+				sum -= L[i][k] * c[k];
 			}
 
-			PF_DEBUG("\n");
+			c[i] = sum / L[i][i];
 		}
 
-		for (int i = 2 * _forder - 2; i >= 0; i--) {
-			if (i < _forder) {
-				z = 0.0f;
+		for (int i = _forder - 1; i >= 0; i--) {
+			double sum = c[i];
 
-			} else {
-				z = i - _forder + 1;
+			for (int k = i + 1; k < _forder; k++) {
+				sum -= L[k][i] * c[k];
 			}
 
-			for (int j = i - z; j >= z; j--) {
-				int row = j;
-				int col = i - j;
-				_VTV(row, col) += (double)temp;
-			}
+			c[i] = sum / L[i][i];
+		}
 
-			temp *= x;
+		// undo the scaling of x and return the highest order first
+		for (int i = 0; i < _forder; i++) {
+			res[_forder - 1 - i] = c[i] * scale[i];
+			PF_DEBUG("%.10f ", res[_forder - 1 - i]);
 		}
+
+		PF_DEBUG("\n");
+
+		return true;
 	}
+
+private:
+	double _sum_x[2 * _forder - 1] {}; ///< ∑x^k, k = 0..2*(_forder-1)
+	double _sum_xy[_dim][_forder] {}; ///< ∑y*x^k for each axis, k = 0.._forder-1
+	double _x_abs_max{0.0};
 };
@@ -884,9 +884,9 @@ void FixedwingAttitudeControl::run()
 
 			/* lazily publish the setpoint only once available */
 			_actuators.timestamp = hrt_absolute_time();
-			_actuators.timestamp_sample = _att.timestamp;
+			_actuators.timestamp_sample = _att.timestamp_sample;
 			_actuators_airframe.timestamp = hrt_absolute_time();
-			_actuators_airframe.timestamp_sample = _att.timestamp;
+			_actuators_airframe.timestamp_sample = _att.timestamp_sample;
 
 			/* Only publish if any of the proper modes are enabled */
 			if (_vcontrol_mode.flag_control_rates_enabled ||
@@ -900,6 +900,8 @@ void FixedwingAttitudeControl::run()
 					_actuators_0_pub = orb_advertise(_actuators_id, &_actuators);
 				}
 
+				latency_trace_record(LATENCY_TRACE_ACTUATOR_CONTROLS, _actuators.timestamp_sample);
+
 				if (_actuators_2_pub != nullptr) {
 					/* publish the actuator controls*/
 					orb_publish(ORB_ID(actuator_controls_2), _actuators_2_pub, &_actuators_airframe);
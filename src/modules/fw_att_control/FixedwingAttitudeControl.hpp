@@ -45,6 +45,7 @@
 #include <px4_posix.h>
 #include <px4_tasks.h>
 #include <parameters/param.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <uORB/Subscription.hpp>
 #include <uORB/topics/actuator_controls.h>
@@ -40,6 +40,8 @@ FixedwingPositionControl::FixedwingPositionControl() :
 	_sub_airspeed(ORB_ID(airspeed)),
 	_sub_sensors(ORB_ID(sensor_bias)),
 	_loop_perf(perf_alloc(PC_ELAPSED, "fw_l1_control")),
+	_path_build_perf(perf_alloc(PC_ELAPSED, "fw_l1_control: path build")),
+	_path_track_perf(perf_alloc(PC_ELAPSED, "fw_l1_control: path track")),
 	_launchDetector(this),
 	_runway_takeoff(this)
 {
@@ -62,6 +64,7 @@ FixedwingPositionControl::FixedwingPositionControl() :
 	_parameter_handles.throttle_cruise = param_find("FW_THR_CRUISE");
 	_parameter_handles.throttle_alt_scale = param_find("FW_THR_ALT_SCL");
 	_parameter_handles.throttle_land_max = param_find("FW_THR_LND_MAX");
+	_parameter_handles.path_enabled = param_find("FW_PATH_EN");
 	_parameter_handles.man_roll_max_deg = param_find("FW_MAN_R_MAX");
 	_parameter_handles.man_pitch_max_deg = param_find("FW_MAN_P_MAX");
 	_parameter_handles.rollsp_offset_deg = param_find("FW_RSP_OFF");
@@ -111,6 +114,8 @@ FixedwingPositionControl::FixedwingPositionControl() :
 FixedwingPositionControl::~FixedwingPositionControl()
 {
 	perf_free(_loop_perf);
+	perf_free(_path_build_perf);
+	perf_free(_path_track_perf);
 }
 
 int
@@ -132,6 +137,16 @@ FixedwingPositionControl::parameters_update()
 	param_get(_parameter_handles.throttle_alt_scale, &(_parameters.throttle_alt_scale));
 	param_get(_parameter_handles.throttle_land_max, &(_parameters.throttle_land_max));
 
+	const int32_t path_enabled = _parameters.path_enabled;
+	param_get(_parameter_handles.path_enabled, &(_parameters.path_enabled));
+
+	if (_parameters.path_enabled != path_enabled) {
+		// restart the cross track error statistics to compare with and without path
+		_xtrack_sq_sum = 0.0f;
+		_xtrack_max = 0.0f;
+		_xtrack_count = 0;
+	}
+
 	param_get(_parameter_handles.man_roll_max_deg, &_parameters.man_roll_max_rad);
 	_parameters.man_roll_max_rad = radians(_parameters.man_roll_max_rad);
 	param_get(_parameter_handles.man_pitch_max_deg, &_parameters.man_pitch_max_rad);
@@ -177,8 +192,8 @@ FixedwingPositionControl::parameters_update()
 		_l1_control.set_l1_period(v);
 	}
 
-	if (param_get(_parameter_handles.roll_limit, &v) == PX4_OK) {
-		_l1_control.set_l1_roll_limit(radians(v));
+	if (param_get(_parameter_handles.roll_limit, &(_parameters.roll_limit)) == PX4_OK) {
+		_l1_control.set_l1_roll_limit(radians(_parameters.roll_limit));
 	}
 
 	if (param_get(_parameter_handles.roll_slew_deg_sec, &v) == PX4_OK) {
@@ -604,13 +619,18 @@ FixedwingPositionControl::status_publish()
 	pos_ctrl_status.nav_bearing = _l1_control.nav_bearing();
 
 	pos_ctrl_status.target_bearing = _l1_control.target_bearing();
-	pos_ctrl_status.xtrack_error = _l1_control.crosstrack_error();
+	pos_ctrl_status.xtrack_error = _path_active ? _path_crosstrack : _l1_control.crosstrack_error();
 
 	pos_ctrl_status.wp_dist = get_distance_to_next_waypoint(_global_pos.lat, _global_pos.lon,
 				  _pos_sp_triplet.current.lat, _pos_sp_triplet.current.lon);
 
 	pos_ctrl_status.acceptance_radius = _l1_control.switch_distance(500.0f);
 
+	if (_path_active) {
+		// switch to the next waypoint at the latest where the corner arc starts, the path keeps the corner
+		pos_ctrl_status.acceptance_radius = max(pos_ctrl_status.acceptance_radius, _path.turnDistance(_path_curr_wp));
+	}
+
 	pos_ctrl_status.yaw_acceptance = NAN;
 
 	pos_ctrl_status.timestamp = hrt_absolute_time();
@@ -808,6 +828,14 @@ FixedwingPositionControl::control_position(const Vector2f &curr_pos, const Vecto
 
 	_l1_control.set_dt(dt);
 
+	if (!_path_active) {
+		// start over when coming back, the vehicle might be anywhere along the path
+		_path_wp_count = 0;
+		_path.reset();
+	}
+
+	_path_active = false;
+
 	/* only run position controller in fixed-wing mode and during transitions for VTOL */
 	if (_vehicle_status.is_rotary_wing && !_vehicle_status.in_transition_mode) {
 		_control_mode_current = FW_POSCTRL_MODE_OTHER;
@@ -923,10 +951,23 @@ FixedwingPositionControl::control_position(const Vector2f &curr_pos, const Vecto
 
 		} else if (pos_sp_curr.type == position_setpoint_s::SETPOINT_TYPE_POSITION) {
 			/* waypoint is a plain navigation waypoint */
-			_l1_control.navigate_waypoints(prev_wp, curr_wp, curr_pos, nav_speed_2d);
+			if (update_path(ground_speed, pos_sp_prev, pos_sp_curr, pos_sp_next)) {
+				navigate_path(curr_pos, nav_speed_2d);
+
+			} else {
+				_l1_control.navigate_waypoints(prev_wp, curr_wp, curr_pos, nav_speed_2d);
+			}
+
 			_att_sp.roll_body = _l1_control.get_roll_setpoint();
 			_att_sp.yaw_body = _l1_control.nav_bearing();
 
+			if (pos_sp_prev.valid) {
+				const float xtrack = _path_active ? _path_crosstrack : _l1_control.crosstrack_error();
+				_xtrack_sq_sum += xtrack * xtrack;
+				_xtrack_max = max(_xtrack_max, fabsf(xtrack));
+				_xtrack_count++;
+			}
+
 			tecs_update_pitch_throttle(pos_sp_curr.alt,
 						   calculate_target_airspeed(mission_airspeed),
 						   radians(_parameters.pitch_limit_min) - _parameters.pitchsp_offset_rad,
@@ -1242,6 +1283,100 @@ FixedwingPositionControl::control_position(const Vector2f &curr_pos, const Vecto
 	return setpoint;
 }
 
+bool
+FixedwingPositionControl::update_path(const Vector2f &ground_speed, const position_setpoint_s &pos_sp_prev,
+				      const position_setpoint_s &pos_sp_curr, const position_setpoint_s &pos_sp_next)
+{
+	// only between plain waypoints, landing approaches and loiters keep their own geometry
+	if (_parameters.path_enabled == 0 || !pos_sp_prev.valid || !pos_sp_next.valid ||
+	    (pos_sp_next.type != position_setpoint_s::SETPOINT_TYPE_POSITION &&
+	     pos_sp_next.type != position_setpoint_s::SETPOINT_TYPE_LOITER)) {
+		return false;
+	}
+
+	const int n = _path_wp_count;
+
+	// setpoints are passed on unchanged, anything within about a millimeter is the same waypoint
+	auto same_waypoint = [this](int i, const position_setpoint_s &setpoint) {
+		return fabs(_path_lat[i] - setpoint.lat) < 1e-8 && fabs(_path_lon[i] - setpoint.lon) < 1e-8;
+	};
+
+	if (n >= 3 && same_waypoint(n - 3, pos_sp_prev) && same_waypoint(n - 2, pos_sp_curr)
+	    && same_waypoint(n - 1, pos_sp_next)) {
+		// setpoints unchanged, keep tracking
+		_path_active = _path.valid();
+		return _path_active;
+	}
+
+	int count = 0;
+
+	if (n >= 3 && same_waypoint(n - 2, pos_sp_prev) && same_waypoint(n - 1, pos_sp_curr)) {
+		// moved on by one waypoint: keep the corner just switched at, the vehicle is still turning there
+		_path_lat[0] = _path_lat[n - 3];
+		_path_lon[0] = _path_lon[n - 3];
+		count = 1;
+	}
+
+	const position_setpoint_s *setpoints[3] = {&pos_sp_prev, &pos_sp_curr, &pos_sp_next};
+
+	for (const position_setpoint_s *setpoint : setpoints) {
+		_path_lat[count] = setpoint->lat;
+		_path_lon[count] = setpoint->lon;
+		count++;
+	}
+
+	_path_wp_count = count;
+	_path_curr_wp = count - 2;
+
+	perf_begin(_path_build_perf);
+
+	map_projection_init(&_path_ref, _path_lat[0], _path_lon[0]);
+
+	Vector2f waypoints[path::Path::MAX_WAYPOINTS];
+
+	for (int i = 0; i < count; i++) {
+		map_projection_project(&_path_ref, _path_lat[i], _path_lon[i], &waypoints[i](0), &waypoints[i](1));
+	}
+
+	// tightest turn at the current speed, with bank angle reserve for wind and tracking errors
+	const float speed = max(_parameters.airspeed_trim * _eas2tas, ground_speed.length());
+	const float turn_radius = speed * speed / (CONSTANTS_ONE_G * tanf(0.75f * radians(_parameters.roll_limit)));
+
+	_path_active = _path.build(waypoints, count, turn_radius);
+
+	perf_end(_path_build_perf);
+
+	return _path_active;
+}
+
+void
+FixedwingPositionControl::navigate_path(const Vector2f &curr_pos, const Vector2f &nav_speed_2d)
+{
+	perf_begin(_path_track_perf);
+
+	Vector2f position;
+	map_projection_project(&_path_ref, _global_pos.lat, _global_pos.lon, &position(0), &position(1));
+
+	const path::Path::Projection projection = _path.project(position);
+
+	// L1 follows the chord from the closest point on the path to the point one L1 distance further along it
+	const Vector2f lookahead = _path.position(projection.s + _l1_control.switch_distance(500.0f));
+
+	double lat_closest = 0.0;
+	double lon_closest = 0.0;
+	double lat_lookahead = 0.0;
+	double lon_lookahead = 0.0;
+	map_projection_reproject(&_path_ref, projection.point(0), projection.point(1), &lat_closest, &lon_closest);
+	map_projection_reproject(&_path_ref, lookahead(0), lookahead(1), &lat_lookahead, &lon_lookahead);
+
+	_l1_control.navigate_waypoints(Vector2f((float)lat_closest, (float)lon_closest),
+				       Vector2f((float)lat_lookahead, (float)lon_lookahead), curr_pos, nav_speed_2d);
+
+	_path_crosstrack = projection.crosstrack;
+
+	perf_end(_path_track_perf);
+}
+
 void
 FixedwingPositionControl::control_takeoff(const Vector2f &curr_pos, const Vector2f &ground_speed,
 		const position_setpoint_s &pos_sp_prev, const position_setpoint_s &pos_sp_curr)
@@ -2091,6 +2226,15 @@ int FixedwingPositionControl::print_status()
 {
 	PX4_INFO("Running");
 
+	perf_print_counter(_loop_perf);
+	perf_print_counter(_path_build_perf);
+	perf_print_counter(_path_track_perf);
+
+	if (_xtrack_count > 0) {
+		PX4_INFO("waypoint cross track error (%s): rms %.2f m, max %.2f m", _parameters.path_enabled ? "path" : "L1",
+			 (double)sqrtf(_xtrack_sq_sum / _xtrack_count), (double)_xtrack_max);
+	}
+
 	return 0;
 }
 
@@ -59,6 +59,7 @@
 #include <lib/ecl/tecs/tecs.h>
 #include <lib/landing_slope/Landingslope.hpp>
 #include <lib/mathlib/mathlib.h>
+#include <lib/path/Path.hpp>
 #include <lib/perf/perf_counter.h>
 #include <px4_config.h>
 #include <px4_defines.h>
@@ -258,6 +259,24 @@ private:
 	ECL_L1_Pos_Controller	_l1_control;
 	TECS			_tecs;
 
+	/* precomputed path through the upcoming waypoints */
+	path::Path _path;
+	map_projection_reference_s _path_ref{};
+	double _path_lat[path::Path::MAX_WAYPOINTS] {};
+	double _path_lon[path::Path::MAX_WAYPOINTS] {};
+	int _path_wp_count{0};
+	int _path_curr_wp{0};					///< index of the current setpoint in the path waypoints
+	bool _path_active{false};				///< the path was followed in this iteration
+	float _path_crosstrack{0.0f};
+
+	perf_counter_t	_path_build_perf;
+	perf_counter_t	_path_track_perf;
+
+	/* cross track error statistics of waypoint navigation */
+	float _xtrack_sq_sum{0.0f};
+	float _xtrack_max{0.0f};
+	uint32_t _xtrack_count{0};
+
 	enum FW_POSCTRL_MODE {
 		FW_POSCTRL_MODE_AUTO,
 		FW_POSCTRL_MODE_POSITION,
@@ -294,6 +313,9 @@ private:
 
 		float throttle_land_max;
 
+		float roll_limit;
+		int32_t path_enabled;
+
 		float land_heading_hold_horizontal_distance;
 		float land_flare_pitch_min_deg;
 		float land_flare_pitch_max_deg;
@@ -355,6 +377,8 @@ private:
 
 		param_t throttle_land_max;
 
+		param_t path_enabled;
+
 		param_t land_slope_angle;
 		param_t land_H1_virt;
 		param_t land_flare_alt_relative;
@@ -439,6 +463,19 @@ private:
 
 	float		get_demanded_airspeed();
 	float		calculate_target_airspeed(float airspeed_demand);
+	/**
+	 * Update the precomputed path through the previous, current and next setpoint
+	 *
+	 * @return true if the path can be followed
+	 */
+	bool		update_path(const Vector2f &ground_speed, const position_setpoint_s &pos_sp_prev,
+				    const position_setpoint_s &pos_sp_curr, const position_setpoint_s &pos_sp_next);
+
+	/**
+	 * Follow the precomputed path with L1
+	 */
+	void		navigate_path(const Vector2f &curr_pos, const Vector2f &nav_speed_2d);
+
 	void		calculate_gndspeed_undershoot(const Vector2f &curr_pos, const Vector2f &ground_speed,
 			const position_setpoint_s &pos_sp_prev, const position_setpoint_s &pos_sp_curr);
 
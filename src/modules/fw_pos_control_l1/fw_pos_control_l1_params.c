@@ -85,6 +85,19 @@ PARAM_DEFINE_FLOAT(FW_L1_DAMPING, 0.75f);
  */
 PARAM_DEFINE_FLOAT(FW_L1_R_SLEW_MAX, 90.0f);
 
+/**
+ * Rounded corners between mission waypoints
+ *
+ * If enabled, the path through the previous, current and next waypoint is
+ * precomputed with circular arcs at the corners, sized for the trim airspeed
+ * and 75% of the roll limit. L1 follows this path instead of the straight legs,
+ * which avoids overshooting sharp corners.
+ *
+ * @boolean
+ * @group FW L1 Control
+ */
+PARAM_DEFINE_INT32(FW_PATH_EN, 0);
+
 /**
  * Cruise throttle
  *
@@ -323,7 +323,7 @@ GroundRoverAttitudeControl::task_main()
 
 			/* lazily publish the setpoint only once available */
 			_actuators.timestamp = hrt_absolute_time();
-			_actuators.timestamp_sample = _att.timestamp;
+			_actuators.timestamp_sample = _att.timestamp_sample;
 
 			/* Only publish if any of the proper modes are enabled */
 			if (_vcontrol_mode.flag_control_attitude_enabled ||
@@ -336,6 +336,8 @@ GroundRoverAttitudeControl::task_main()
 				} else {
 					_actuators_0_pub = orb_advertise(ORB_ID_VEHICLE_ATTITUDE_CONTROLS, &_actuators);
 				}
+
+				latency_trace_record(LATENCY_TRACE_ACTUATOR_CONTROLS, _actuators.timestamp_sample);
 			}
 		}
 
@@ -51,6 +51,7 @@
 #include <matrix/math.hpp>
 #include <parameters/param.h>
 #include <pid/pid.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <uORB/topics/actuator_controls.h>
 #include <uORB/topics/battery_status.h>
@@ -41,6 +41,7 @@
 
 #include <drivers/drv_hrt.h>
 #include <lib/perf/perf_counter.h>
+#include <modules/uORB/uORBManager.hpp>
 #include <px4_config.h>
 #include <px4_defines.h>
 #include <px4_module.h>
@@ -49,8 +50,14 @@
 #include <systemlib/cpuload.h>
 #include <uORB/topics/cpuload.h>
 #include <uORB/topics/task_stack_info.h>
+#include <uORB/topics/task_cpu_load.h>
+#include <uORB/topics/uorb_topic_stats.h>
 #include <uORB/uORB.h>
 
+#ifdef __PX4_LINUX
+#include <systemlib/thread_load_linux.h>
+#endif
+
 #if defined(__PX4_NUTTX) && !defined(CONFIG_SCHED_INSTRUMENTATION)
 #  error load_mon support requires CONFIG_SCHED_INSTRUMENTATION
 #endif
@@ -101,6 +108,11 @@ private:
 	/** Calculate the memory usage */
 	float _ram_used();
 
+	/** Publish the statistics of the topics with the highest memory bandwidth */
+	void _uorb_stats();
+
+	orb_advert_t _uorb_topic_stats_pub{nullptr};
+
 #ifdef __PX4_NUTTX
 	/* Calculate stack usage */
 	void _stack_usage();
@@ -109,6 +121,21 @@ private:
 	orb_advert_t _task_stack_info_pub{nullptr};
 #endif
 
+#ifdef __PX4_LINUX
+	/* Calculate the per-thread CPU and scheduling statistics */
+	void _thread_load();
+
+	system_cpu_time_s _last_cpu_time{};
+
+	/* per-thread samples, members to keep them off the work queue stack */
+	thread_load_s _threads[THREAD_LOAD_MAX_THREADS] {};
+	thread_load_s _last_threads[THREAD_LOAD_MAX_THREADS] {};
+	int _last_thread_count{0};
+	uint64_t _last_thread_sample_time{0};
+
+	orb_advert_t _task_cpu_load_pub{nullptr};
+#endif
+
 	DEFINE_PARAMETERS(
 		(ParamBool<px4::params::SYS_STCK_EN>) _stack_check_enabled
 	)
@@ -167,6 +194,11 @@ LoadMon::cycle_trampoline(void *arg)
 void LoadMon::_cycle()
 {
 	_cpuload();
+	_uorb_stats();
+
+#ifdef __PX4_LINUX
+	_thread_load();
+#endif
 
 #ifdef __PX4_NUTTX
 
@@ -187,6 +219,31 @@ void LoadMon::_cycle()
 
 void LoadMon::_cpuload()
 {
+#ifdef __PX4_LINUX
+	system_cpu_time_s cpu_time;
+
+	if (thread_load_sample_system(&cpu_time) != 0) {
+		return;
+	}
+
+	if (_last_cpu_time.total == 0) {
+		/* Just get the time in the first iteration */
+		_last_cpu_time = cpu_time;
+		return;
+	}
+
+	const uint64_t interval_total = cpu_time.total - _last_cpu_time.total;
+	const uint64_t interval_idle = cpu_time.idle - _last_cpu_time.idle;
+	_last_cpu_time = cpu_time;
+
+	if (interval_total == 0) {
+		return;
+	}
+
+	cpuload_s cpuload = {};
+	cpuload.load = 1.0f - (float)interval_idle / (float)interval_total;
+#else
+
 	if (_last_idle_time == 0) {
 		/* Just get the time in the first iteration */
 		_last_idle_time = system_load.tasks[0].total_runtime;
@@ -203,6 +260,7 @@ void LoadMon::_cpuload()
 
 	cpuload_s cpuload = {};
 	cpuload.load = 1.0f - (float)interval_idletime / (float)interval;
+#endif
 	cpuload.ram_usage = _ram_used();
 	cpuload.timestamp = hrt_absolute_time();
 
@@ -232,11 +290,53 @@ float LoadMon::_ram_used()
 
 	return (float)mem.uordblks / mem.arena;
 
+#elif defined(__PX4_LINUX)
+	const float ram_usage = thread_load_ram_usage();
+	return ram_usage > 0.0f ? ram_usage : 0.0f;
+
 #else
 	return 0.0f;
 #endif
 }
 
+void LoadMon::_uorb_stats()
+{
+	uORB::DeviceMaster *device_master = uORB::Manager::get_instance()->get_device_master();
+
+	if (device_master == nullptr) {
+		return;
+	}
+
+	uORB::DeviceMaster::TopicStatistics statistics[uorb_topic_stats_s::MAX_REPORTED_TOPICS];
+	const int num_statistics = device_master->sampleStatistics(statistics, uorb_topic_stats_s::MAX_REPORTED_TOPICS);
+
+	for (int i = 0; i < num_statistics; i++) {
+		const uORB::DeviceMaster::TopicStatistics &s = statistics[i];
+
+		uorb_topic_stats_s uorb_topic_stats = {};
+		strncpy((char *)uorb_topic_stats.topic_name, s.meta->o_name, uorb_topic_stats_s::MAX_TOPIC_NAME_LEN - 1);
+		uorb_topic_stats.instance = s.instance;
+		uorb_topic_stats.queue_size = s.queue_size;
+		uorb_topic_stats.subscribers = s.subscribers;
+		uorb_topic_stats.message_size = s.meta->o_size;
+		uorb_topic_stats.publish_rate = s.publish_rate;
+		uorb_topic_stats.copy_rate = s.copy_rate;
+		uorb_topic_stats.bytes_per_second = s.bytes_per_second;
+		uorb_topic_stats.reader_lag_mean = s.reader_lag_mean;
+		uorb_topic_stats.reader_lag_max = s.reader_lag_max;
+		uorb_topic_stats.copy_time_ns = s.copy_time_ns;
+		uorb_topic_stats.timestamp = hrt_absolute_time();
+
+		if (_uorb_topic_stats_pub == nullptr) {
+			_uorb_topic_stats_pub = orb_advertise_queue(ORB_ID(uorb_topic_stats), &uorb_topic_stats,
+						uorb_topic_stats_s::MAX_REPORTED_TOPICS);
+
+		} else {
+			orb_publish(ORB_ID(uorb_topic_stats), _uorb_topic_stats_pub, &uorb_topic_stats);
+		}
+	}
+}
+
 #ifdef __PX4_NUTTX
 void LoadMon::_stack_usage()
 {
@@ -325,9 +425,65 @@ void LoadMon::_stack_usage()
 }
 #endif
 
+#ifdef __PX4_LINUX
+void LoadMon::_thread_load()
+{
+	const int thread_count = thread_load_sample(_threads, THREAD_LOAD_MAX_THREADS);
+
+	if (thread_count < 0) {
+		return;
+	}
+
+	// procfs times are in real time, while hrt might be in lockstep
+	const uint64_t interval_us = _last_cpu_time.timestamp - _last_thread_sample_time;
+	_last_thread_sample_time = _last_cpu_time.timestamp;
+
+	for (int i = 0; i < thread_count && _last_thread_count > 0 && interval_us > 0; i++) {
+		const thread_load_s &thread = _threads[i];
+		const thread_load_s *last = nullptr;
+
+		for (int j = 0; j < _last_thread_count; j++) {
+			if (_last_threads[j].tid == thread.tid) {
+				last = &_last_threads[j];
+				break;
+			}
+		}
+
+		if (last == nullptr) {
+			// new thread, report it in the next cycle
+			continue;
+		}
+
+		task_cpu_load_s task_cpu_load = {};
+		strncpy((char *)task_cpu_load.task_name, thread.name, task_cpu_load_s::MAX_REPORT_TASK_NAME_LEN);
+		task_cpu_load.tid = thread.tid;
+		task_cpu_load.load = (float)(thread.run_time_us - last->run_time_us) / interval_us;
+		task_cpu_load.run_queue_delay = (float)(thread.wait_time_us - last->wait_time_us) / interval_us;
+		task_cpu_load.ctx_switches_voluntary = thread.ctx_switches_voluntary - last->ctx_switches_voluntary;
+		task_cpu_load.ctx_switches_involuntary = thread.ctx_switches_involuntary - last->ctx_switches_involuntary;
+		task_cpu_load.priority = thread.priority;
+		task_cpu_load.last_cpu = thread.last_cpu;
+		task_cpu_load.timestamp = hrt_absolute_time();
+
+		if (_task_cpu_load_pub == nullptr) {
+			_task_cpu_load_pub = orb_advertise_queue(ORB_ID(task_cpu_load), &task_cpu_load, THREAD_LOAD_MAX_THREADS);
+
+		} else {
+			orb_publish(ORB_ID(task_cpu_load), _task_cpu_load_pub, &task_cpu_load);
+		}
+	}
+
+	memcpy(_last_threads, _threads, thread_count * sizeof(thread_load_s));
+	_last_thread_count = thread_count;
+}
+#endif
+
 int LoadMon::print_status()
 {
 	PX4_INFO("running");
+#ifdef __PX4_LINUX
+	PX4_INFO("threads: %i", _last_thread_count);
+#endif
 	perf_print_counter(_stack_perf);
 	return 0;
 }
@@ -346,6 +502,13 @@ usage and publish the `cpuload` topic.
 
 On NuttX it also checks the stack usage of each process and if it falls below 300 bytes, a warning is output,
 which will also appear in the log file.
+
+On Linux the load is read from procfs, and in addition the CPU time, run-queue delay, context switches and the
+last used CPU of each thread are published as `task_cpu_load` (requires a kernel with CONFIG_SCHEDSTATS for the
+run-queue delay).
+
+The uORB topics that moved the most data during the last second are published as `uorb_topic_stats`, with
+their publication and copy rates, memory bandwidth, subscriber lag and publication copy time.
 )DESCR_STR");
 
 	PRINT_MODULE_USAGE_NAME("load_mon", "system");
@@ -59,8 +59,10 @@
 #include <px4_sem.h>
 #include <px4_shutdown.h>
 #include <px4_tasks.h>
+#include <perf/latency_trace.h>
 #include <systemlib/mavlink_log.h>
 #include <replay/definitions.hpp>
+#include <ulog_compact/ulog_compact.h>
 #include <version/version.h>
 
 //#define DBGPRINT //write status output every few seconds
@@ -452,6 +454,16 @@ Logger::~Logger()
 	if (_msg_buffer) {
 		delete[](_msg_buffer);
 	}
+
+	if (_compact_states) {
+		for (size_t i = 0; i < _subscriptions.size() * ORB_MULTI_MAX_INSTANCES; i++) {
+			delete[](_compact_states[i].sample);
+		}
+
+		delete[](_compact_states);
+	}
+
+	delete[](_compact_buffer);
 }
 
 bool Logger::request_stop_static()
@@ -638,11 +650,14 @@ void Logger::add_default_topics()
 	add_topic("radio_status");
 	add_topic("rate_ctrl_status", 30);
 	add_topic("sensor_combined", 100);
+	add_topic("sensor_health");
 	add_topic("sensor_preflight", 200);
 	add_topic("system_power", 500);
+	add_topic("task_cpu_load");
 	add_topic("tecs_status", 200);
 	add_topic("trajectory_setpoint", 200);
 	add_topic("telemetry_status");
+	add_topic("uorb_topic_stats");
 	add_topic("vehicle_air_data", 200);
 	add_topic("vehicle_attitude", 30);
 	add_topic("vehicle_attitude_setpoint", 100);
@@ -992,6 +1007,25 @@ void Logger::run()
 		}
 	}
 
+	int32_t compact_data = 0;
+	param_t compact_data_param = param_find("SDLOG_COMPACT");
+
+	if (compact_data_param != PARAM_INVALID) {
+		param_get(compact_data_param, &compact_data);
+	}
+
+	if (compact_data && !_compact_states) {
+		// the sample buffers are allocated on first use, only for the instances that are logged
+		_compact_states = new CompactState[_subscriptions.size() * ORB_MULTI_MAX_INSTANCES];
+		_compact_buffer = new uint8_t[_msg_buffer_len];
+
+		if (!_compact_states || !_compact_buffer) {
+			PX4_ERR("failed to alloc compact encoding buffers");
+			delete[](_compact_states);
+			_compact_states = nullptr;
+		}
+	}
+
 
 	if (!_writer.init()) {
 		PX4_ERR("writer init failed");
@@ -1122,7 +1156,7 @@ void Logger::run()
 						//PX4_INFO("topic: %s, size = %zu, out_size = %zu", sub.metadata->o_name, sub.metadata->o_size, msg_size);
 
 						// full log
-						if (write_message(LogType::Full, _msg_buffer, msg_size)) {
+						if (write_data_message(sub_idx, instance, msg_size)) {
 
 #ifdef DBGPRINT
 							total_bytes += msg_size;
@@ -1386,6 +1420,63 @@ void Logger::handle_vehicle_command_update(int vehicle_command_sub, orb_advert_t
 	}
 }
 
+bool Logger::write_data_message(int sub_idx, int instance, size_t msg_size)
+{
+	if (!_compact_states) {
+		return write_message(LogType::Full, _msg_buffer, msg_size);
+	}
+
+	const orb_metadata *meta = _subscriptions[sub_idx].metadata;
+	CompactState &state = _compact_states[sub_idx * ORB_MULTI_MAX_INSTANCES + instance];
+	const uint8_t *sample = _msg_buffer + sizeof(ulog_message_data_header_s);
+	const size_t sample_size = meta->o_size_no_padding;
+
+	// the MAVLink stream gets the same messages, but it may drop them, so the receiver could not decode deltas
+	const bool streaming = _writer.is_started(LogType::Full, LogWriter::BackendMavlink);
+
+	if (state.valid && !streaming && meta->o_layout && hrt_elapsed_time(&state.keyframe_time) < COMPACT_KEYFRAME_INTERVAL) {
+		const size_t length = ulog_compact::encode(meta->o_layout, state.sample, sample,
+				      _compact_buffer + sizeof(ulog_message_data_compact_header_s), sample_size - 1);
+
+		if (length > 0) {
+			ulog_message_data_compact_header_s header;
+			header.msg_size = sizeof(header) - ULOG_MSG_HEADER_LEN + length;
+			header.msg_id = _subscriptions[sub_idx].msg_ids[instance];
+			memcpy(_compact_buffer, &header, sizeof(header));
+
+			if (!write_message(LogType::Full, _compact_buffer, sizeof(header) + length)) {
+				// keep the state: the decoder did not get this sample either
+				return false;
+			}
+
+			memcpy(state.sample, sample, sample_size);
+			return true;
+		}
+	}
+
+	if (!write_message(LogType::Full, _msg_buffer, msg_size)) {
+		return false;
+	}
+
+	if (streaming || !meta->o_layout) {
+		state.valid = false;
+		return true;
+	}
+
+	if (!state.sample) {
+		state.sample = new uint8_t[sample_size];
+
+		if (!state.sample) {
+			return true;
+		}
+	}
+
+	memcpy(state.sample, sample, sample_size);
+	state.keyframe_time = hrt_absolute_time();
+	state.valid = true;
+	return true;
+}
+
 bool Logger::write_message(LogType type, void *ptr, size_t size)
 {
 	Statistics &stats = _statistics[(int)type];
@@ -1568,10 +1659,17 @@ void Logger::start_log_file(LogType type)
 		mavlink_log_info(&_mavlink_log_pub, "[logger] file: %s", file_name);
 	}
 
+	if (type == LogType::Full && _compact_states) {
+		// a new file starts with uncompressed samples
+		for (size_t i = 0; i < _subscriptions.size() * ORB_MULTI_MAX_INSTANCES; i++) {
+			_compact_states[i].valid = false;
+		}
+	}
+
 	_writer.start_log_file(type, file_name);
 	_writer.select_write_backend(LogWriter::BackendFile);
 	_writer.set_need_reliable_transfer(true);
-	write_header(type);
+	write_header(type, type == LogType::Full && _compact_states);
 	write_version(type);
 	write_formats(type);
 	if (type == LogType::Full) {
@@ -1675,6 +1773,16 @@ void Logger::write_perf_data(bool preflight)
 
 	// write the perf counters
 	perf_iterate_all(perf_iterate_callback, &callback_data);
+
+	// write the sensor to actuator latency histograms
+	const int buffer_length = 256;
+	char buffer[buffer_length];
+	const char *trace_name = preflight ? "perf_latency_trace_preflight" : "perf_latency_trace_postflight";
+
+	for (int stage = 0; stage < LATENCY_TRACE_STAGE_COUNT; ++stage) {
+		latency_trace_print_buffer(buffer, buffer_length, (latency_trace_stage)stage);
+		write_info_multiple(LogType::Full, trace_name, buffer, stage != 0);
+	}
 }
 
 
@@ -1984,7 +2092,7 @@ void Logger::write_info_template(LogType type, const char *name, T value, const
 	_writer.unlock();
 }
 
-void Logger::write_header(LogType type)
+void Logger::write_header(LogType type, bool compact_data)
 {
 	ulog_file_header_s header = {};
 	header.magic[0] = 'U';
@@ -2005,6 +2113,10 @@ void Logger::write_header(LogType type)
 	flag_bits.msg_size = sizeof(flag_bits) - ULOG_MSG_HEADER_LEN;
 	flag_bits.msg_type = static_cast<uint8_t>(ULogMessageType::FLAG_BITS);
 
+	if (compact_data) {
+		flag_bits.incompat_flags[0] |= ULOG_INCOMPAT_FLAG0_DATA_COMPACT_MASK;
+	}
+
 	write_message(type, &flag_bits, sizeof(flag_bits));
 
 	_writer.unlock();
@@ -244,8 +244,9 @@ private:
 
 	/**
 	 * write the file header with file magic and timestamp.
+	 * @param compact_data set the flag that the log contains compact data messages
 	 */
-	void write_header(LogType type);
+	void write_header(LogType type, bool compact_data = false);
 
 	/// Array to store written formats (add some more for nested definitions)
 	using WrittenFormats = Array < const orb_metadata *, MAX_TOPICS_NUM + 10 >;
@@ -255,7 +256,7 @@ private:
 	void write_formats(LogType type);
 
 	/**
-	 * write performance counters
+	 * write performance counters and latency trace histograms
 	 * @param preflight preflight if true, postflight otherwise
 	 */
 	void write_perf_data(bool preflight);
@@ -300,6 +301,13 @@ private:
 	 */
 	bool write_message(LogType type, void *ptr, size_t size);
 
+	/**
+	 * Write the data message in _msg_buffer to the full log, in compact form if enabled and smaller.
+	 * Must be called with _writer.lock() held.
+	 * @return true if data written, false otherwise (on overflow)
+	 */
+	bool write_data_message(int sub_idx, int instance, size_t msg_size);
+
 	/**
 	 * Parse a file containing a list of uORB topics to log, calling add_topic for each
 	 * @param fname name of file
@@ -367,6 +375,17 @@ private:
 	uint8_t						*_msg_buffer{nullptr};
 	int						_msg_buffer_len{0};
 
+	static constexpr hrt_abstime COMPACT_KEYFRAME_INTERVAL = 5000000; ///< max time between uncompressed samples [us]
+
+	struct CompactState {
+		uint8_t *sample{nullptr};			///< last sample written to the full log file
+		hrt_abstime keyframe_time{0};			///< time of the last uncompressed sample
+		bool valid{false};				///< if false, the next sample is written uncompressed
+	};
+
+	CompactState					*_compact_states{nullptr}; ///< per subscription and instance, null if disabled
+	uint8_t						*_compact_buffer{nullptr}; ///< output buffer of the compact encoding
+
 	LogFileName					_file_name[(int)LogType::Count];
 
 	bool						_was_armed{false};
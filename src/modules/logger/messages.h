@@ -36,6 +36,7 @@
 enum class ULogMessageType : uint8_t {
 	FORMAT = 'F',
 	DATA = 'D',
+	DATA_COMPACT = 'd', ///< data encoded relative to the previous sample (see lib/ulog_compact)
 	INFO = 'I',
 	INFO_MULTIPLE = 'M',
 	PARAMETER = 'P',
@@ -107,6 +108,13 @@ struct ulog_message_data_header_s {
 	uint16_t msg_id;
 };
 
+struct ulog_message_data_compact_header_s {
+	uint16_t msg_size; //size of message - ULOG_MSG_HEADER_LEN
+	uint8_t msg_type = static_cast<uint8_t>(ULogMessageType::DATA_COMPACT);
+
+	uint16_t msg_id;
+};
+
 struct ulog_message_info_header_s {
 	uint16_t msg_size; //size of message - ULOG_MSG_HEADER_LEN
 	uint8_t msg_type = static_cast<uint8_t>(ULogMessageType::INFO);
@@ -143,6 +151,7 @@ struct ulog_message_parameter_header_s {
 
 
 #define ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK (1<<0)
+#define ULOG_INCOMPAT_FLAG0_DATA_COMPACT_MASK (1<<1) ///< the log contains DATA_COMPACT messages
 
 struct ulog_message_flag_bits_s {
 	uint16_t msg_size;
@@ -152,3 +152,20 @@ PARAM_DEFINE_INT32(SDLOG_DIRS_MAX, 0);
  * @group SD Logging
  */
 PARAM_DEFINE_INT32(SDLOG_UUID, 1);
+
+/**
+ * Compact log encoding
+ *
+ * If enabled, samples of the full log file are written relative to the previous sample
+ * of the same topic when that is smaller (only the changed fields, integers as varint deltas).
+ * This reduces the log size mostly for slowly changing topics. An uncompressed sample is
+ * still written every 5 seconds for each topic.
+ *
+ * The log can only be read by tools that support the compact data messages.
+ * MAVLink log streaming always uses the uncompressed format.
+ *
+ * @boolean
+ * @reboot_required true
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_COMPACT, 0);
@@ -0,0 +1,264 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_frame_parser.cpp
+ * Frame level MAVLink parser working on whole receive buffers.
+ */
+
+#include "mavlink_frame_parser.h"
+
+#include <string.h>
+
+size_t
+MavlinkFrameParser::push(const uint8_t *buf, size_t len)
+{
+	if (_tail + len > BUFFER_SIZE) {
+		compact();
+	}
+
+	const size_t space = BUFFER_SIZE - _tail;
+
+	if (len > space) {
+		len = space;
+	}
+
+	memcpy(&_buf[_tail], buf, len);
+	_tail += len;
+
+	return len;
+}
+
+void
+MavlinkFrameParser::compact()
+{
+	if (_head > 0) {
+		memmove(_buf, &_buf[_head], _tail - _head);
+		_tail -= _head;
+		_head = 0;
+	}
+}
+
+int
+MavlinkFrameParser::frame_size() const
+{
+	const uint8_t *frame = &_buf[_head];
+	const size_t available = _tail - _head;
+
+	if (frame[0] == MAVLINK_STX_MAVLINK1) {
+		if (available < HEADER_LEN_V1) {
+			return 0;
+		}
+
+		return HEADER_LEN_V1 + frame[1] + CHECKSUM_LEN;
+	}
+
+	if (available < HEADER_LEN_V2) {
+		return 0;
+	}
+
+	const uint8_t incompat_flags = frame[2];
+
+	if (incompat_flags & ~MAVLINK_IFLAG_SIGNED) {
+		/* unknown incompatibility flag, we cannot parse this frame */
+		return -1;
+	}
+
+	int size = HEADER_LEN_V2 + frame[1] + CHECKSUM_LEN;
+
+	if (incompat_flags & MAVLINK_IFLAG_SIGNED) {
+		size += MAVLINK_SIGNATURE_BLOCK_LEN;
+	}
+
+	return size;
+}
+
+unsigned
+MavlinkFrameParser::bytes_missing() const
+{
+	if (_head == _tail) {
+		return 0;
+	}
+
+	const uint8_t stx = _buf[_head];
+
+	if (stx != MAVLINK_STX && stx != MAVLINK_STX_MAVLINK1) {
+		return 0;
+	}
+
+	const size_t available = _tail - _head;
+	const int size = frame_size();
+
+	if (size == 0) {
+		/* header incomplete, at least the rest of the header is needed */
+		return (stx == MAVLINK_STX ? HEADER_LEN_V2 : HEADER_LEN_V1) - available;
+	}
+
+	if (size > 0 && (size_t)size > available) {
+		return size - available;
+	}
+
+	return 0;
+}
+
+bool
+MavlinkFrameParser::parse(mavlink_message_t *msg, mavlink_status_t *status)
+{
+	while (_head < _tail) {
+
+		/* skip everything up to the next start marker */
+		const uint8_t *begin = &_buf[_head];
+		const uint8_t *end = &_buf[_tail];
+		const uint8_t *stx = begin;
+
+		while (stx < end && *stx != MAVLINK_STX && *stx != MAVLINK_STX_MAVLINK1) {
+			++stx;
+		}
+
+		if (stx != begin) {
+			_bytes_dropped += stx - begin;
+			_head += stx - begin;
+			continue;
+		}
+
+		const int size = frame_size();
+
+		if (size == 0 || (size > 0 && (size_t)size > (size_t)(_tail - _head))) {
+			/* wait for the rest of the frame */
+			break;
+		}
+
+		const uint8_t *frame = &_buf[_head];
+
+		if (size < 0) {
+			/* not a frame start, resync on the next byte */
+			_bytes_dropped++;
+			_head++;
+			continue;
+		}
+
+		const bool mavlink1 = (frame[0] == MAVLINK_STX_MAVLINK1);
+		const size_t header_len = mavlink1 ? HEADER_LEN_V1 : HEADER_LEN_V2;
+		const uint8_t payload_len = frame[1];
+		const uint32_t msgid = mavlink1 ? frame[5] : (frame[7] | (frame[8] << 8) | ((uint32_t)frame[9] << 16));
+
+		/* checksum over the whole frame excluding STX, seeded with the message specific extra CRC */
+		const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(msgid);
+		uint16_t checksum = crc_calculate(&frame[1], header_len - 1 + payload_len);
+		crc_accumulate(entry ? entry->crc_extra : 0, &checksum);
+
+		const uint8_t *ck = &frame[header_len + payload_len];
+
+		if (ck[0] != (uint8_t)(checksum & 0xFF) || ck[1] != (uint8_t)(checksum >> 8)) {
+			/* corrupt frame or a start marker inside payload data, resync on the next byte */
+			_crc_errors++;
+			_bytes_dropped++;
+			_head++;
+
+			if (status != nullptr) {
+				status->parse_error++;
+				status->msg_received = MAVLINK_FRAMING_INCOMPLETE;
+			}
+
+			continue;
+		}
+
+		msg->magic = frame[0];
+		msg->len = payload_len;
+
+		if (mavlink1) {
+			msg->incompat_flags = 0;
+			msg->compat_flags = 0;
+			msg->seq = frame[2];
+			msg->sysid = frame[3];
+			msg->compid = frame[4];
+
+		} else {
+			msg->incompat_flags = frame[2];
+			msg->compat_flags = frame[3];
+			msg->seq = frame[4];
+			msg->sysid = frame[5];
+			msg->compid = frame[6];
+		}
+
+		msg->msgid = msgid;
+
+		uint8_t *payload = (uint8_t *)_MAV_PAYLOAD_NON_CONST(msg);
+		memcpy(payload, &frame[header_len], payload_len);
+
+		/* zero-fill truncated MAVLink 2 payloads up to the full message length */
+		const uint8_t max_len = entry ? entry->max_msg_len : MAVLINK_MAX_PAYLOAD_LEN;
+
+		if (payload_len < max_len) {
+			memset(&payload[payload_len], 0, max_len - payload_len);
+		}
+
+		msg->checksum = checksum;
+		msg->ck[0] = ck[0];
+		msg->ck[1] = ck[1];
+
+		if (msg->incompat_flags & MAVLINK_IFLAG_SIGNED) {
+			memcpy(msg->signature, &ck[CHECKSUM_LEN], MAVLINK_SIGNATURE_BLOCK_LEN);
+		}
+
+		_head += size;
+
+		if (status != nullptr) {
+			if (mavlink1) {
+				status->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+
+			} else {
+				status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+			}
+
+			status->msg_received = MAVLINK_FRAMING_OK;
+			status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+			status->packet_idx = 0;
+			status->current_rx_seq = msg->seq;
+
+			/* initial condition: if no packet has been received so far, drop count is undefined */
+			if (status->packet_rx_success_count == 0) {
+				status->packet_rx_drop_count = 0;
+			}
+
+			status->packet_rx_success_count++;
+		}
+
+		return true;
+	}
+
+	/* everything left is an incomplete frame, move it to the front to make space for the next read */
+	compact();
+
+	return false;
+}
@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_frame_parser.h
+ * Frame level MAVLink parser working on whole receive buffers.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mavlink_bridge_header.h"
+
+/**
+ * MAVLink v1/v2 frame parser.
+ *
+ * Received bytes are appended to a window which is then scanned for start
+ * markers. Complete frames are validated with a single CRC pass and decoded
+ * in one go, instead of running the mavlink_parse_char() state machine for
+ * every byte. The tail of a frame that is not yet complete stays in the
+ * window until the next read delivers the rest.
+ *
+ * Message signatures are copied but not verified, the same as
+ * mavlink_parse_char() does when no signing is configured on the channel.
+ */
+class MavlinkFrameParser
+{
+public:
+	MavlinkFrameParser() = default;
+	~MavlinkFrameParser() = default;
+
+	/**
+	 * Append received bytes to the parse window.
+	 *
+	 * @return number of bytes consumed, less than len if the window is full.
+	 *         Call parse() until it returns false to make space again.
+	 */
+	size_t push(const uint8_t *buf, size_t len);
+
+	/**
+	 * Extract the next valid frame from the parse window.
+	 *
+	 * @param msg decoded message
+	 * @param status channel status, updated the same way as by mavlink_parse_char()
+	 * @return true if a message was decoded, false if more data is required
+	 */
+	bool parse(mavlink_message_t *msg, mavlink_status_t *status);
+
+	/**
+	 * Number of bytes still required to complete the frame at the start of
+	 * the window, 0 if there is no partial frame.
+	 */
+	unsigned bytes_missing() const;
+
+	/**
+	 * Drop all buffered data.
+	 */
+	void reset() { _head = _tail = 0; }
+
+	uint32_t crc_errors() const { return _crc_errors; }
+	uint32_t bytes_dropped() const { return _bytes_dropped; }
+
+	static constexpr size_t HEADER_LEN_V1 = 6;	///< STX, len, seq, sysid, compid, msgid
+	static constexpr size_t HEADER_LEN_V2 = 10;	///< STX, len, incompat, compat, seq, sysid, compid, msgid (3 bytes)
+	static constexpr size_t CHECKSUM_LEN = 2;
+
+private:
+	/**
+	 * Size of the frame starting at the window head.
+	 *
+	 * @return frame size in bytes, 0 if the header is not complete yet
+	 *         or -1 if the start marker does not begin a valid header
+	 */
+	int frame_size() const;
+
+	void compact();
+
+	static constexpr size_t BUFFER_SIZE = 2 * MAVLINK_MAX_PACKET_LEN;
+
+	uint8_t _buf[BUFFER_SIZE];
+	size_t _head{0};	///< first unparsed byte
+	size_t _tail{0};	///< end of valid data
+
+	uint32_t _crc_errors{0};
+	uint32_t _bytes_dropped{0};
+};
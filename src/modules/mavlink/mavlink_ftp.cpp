@@ -41,6 +41,7 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <cstring>
+#include <stdlib.h>
 
 #include "mavlink_ftp.h"
 #include "mavlink_main.h"
@@ -51,12 +52,20 @@ constexpr const char MavlinkFTP::_root_dir[];
 MavlinkFTP::MavlinkFTP(Mavlink *mavlink) :
 	_mavlink(mavlink)
 {
-	// initialize session
-	_session_info.fd = -1;
+	// initialize sessions
+	for (uint8_t i = 0; i < kMaxSessions; i++) {
+		_session_info[i].fd = -1;
+	}
 }
 
 MavlinkFTP::~MavlinkFTP()
 {
+	for (uint8_t i = 0; i < kMaxSessions; i++) {
+		_close_session(_session_info[i]);
+	}
+
+	_invalidate_crc32_cache();
+
 	if (_work_buffer1) {
 		delete[] _work_buffer1;
 	}
@@ -69,12 +78,23 @@ MavlinkFTP::~MavlinkFTP()
 unsigned
 MavlinkFTP::get_size()
 {
-	if (_session_info.stream_download) {
-		return MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
-
-	} else {
-		return 0;
+	for (uint8_t i = 0; i < kMaxSessions; i++) {
+		if (_session_info[i].stream_download) {
+			return MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+		}
 	}
+
+	return 0;
+}
+
+unsigned
+MavlinkFTP::_get_free_tx_buf()
+{
+#ifdef MAVLINK_FTP_UNIT_TEST
+	return _ut_free_tx_buf;
+#else
+	return _mavlink->get_free_tx_buf();
+#endif
 }
 
 #ifdef MAVLINK_FTP_UNIT_TEST
@@ -501,13 +521,21 @@ MavlinkFTP::_workList(PayloadHeader *payload, bool list_hidden)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 {
-	if (_session_info.fd >= 0) {
+	uint8_t session_index = 0;
+
+	while (session_index < kMaxSessions && _session_info[session_index].fd >= 0) {
+		session_index++;
+	}
+
+	if (session_index == kMaxSessions) {
 		PX4_ERR("FTP: Open failed - out of sessions\n");
 		return kErrNoSessionsAvailable;
 	}
 
 	strncpy(_work_buffer1, _root_dir, _work_buffer1_len);
 	strncpy(_work_buffer1 + _root_dir_len, _data_as_cstring(payload), _work_buffer1_len - _root_dir_len);
+	// ensure termination
+	_work_buffer1[_work_buffer1_len - 1] = '\0';
 
 #ifdef MAVLINK_FTP_DEBUG
 	PX4_INFO("FTP: open '%s'", _work_buffer1);
@@ -528,6 +556,10 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 
 	fileSize = st.st_size;
 
+	if (oflag & O_WRONLY) {
+		_invalidate_crc32_cache();
+	}
+
 	// Set mode to 666 incase oflag has O_CREAT
 	int fd = ::open(_work_buffer1, oflag, PX4_O_MODE_666);
 
@@ -535,11 +567,19 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 		return kErrFailErrno;
 	}
 
-	_session_info.fd = fd;
-	_session_info.file_size = fileSize;
-	_session_info.stream_download = false;
-
-	payload->session = 0;
+	SessionInfo &session = _session_info[session_index];
+	session.fd = fd;
+	session.writing = oflag & O_WRONLY;
+	session.file_size = fileSize;
+	session.path = strdup(_work_buffer1);
+	session.buffer_length = 0;
+	session.crc32 = 0;
+	session.crc32_length = 0;
+	// only uploads keep a CRC32: a file written by others can change without changing size or mtime
+	session.crc32_valid = session.writing && session.path != nullptr;
+	session.stream_download = false;
+
+	payload->session = session_index;
 	payload->size = sizeof(uint32_t);
 	std::memcpy(payload->data, &fileSize, payload->size);
 
@@ -550,7 +590,9 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workRead(PayloadHeader *payload)
 {
-	if (payload->session != 0 || _session_info.fd < 0) {
+	SessionInfo *session = _get_session(payload->session);
+
+	if (!session) {
 		return kErrInvalidSession;
 	}
 
@@ -559,17 +601,12 @@ MavlinkFTP::_workRead(PayloadHeader *payload)
 #endif
 
 	// We have to test seek past EOF ourselves, lseek will allow seek past EOF
-	if (payload->offset >= _session_info.file_size) {
+	if (payload->offset >= session->file_size) {
 		PX4_ERR("request past EOF");
 		return kErrEOF;
 	}
 
-	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-		PX4_ERR("seek fail");
-		return kErrFailErrno;
-	}
-
-	int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+	int bytes_read = _session_read(*session, payload->offset, &payload->data[0], kMaxDataLength);
 
 	if (bytes_read < 0) {
 		// Negative return indicates error other than eof
@@ -586,19 +623,21 @@ MavlinkFTP::_workRead(PayloadHeader *payload)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workBurst(PayloadHeader *payload, uint8_t target_system_id)
 {
-	if (payload->session != 0 && _session_info.fd < 0) {
+	SessionInfo *session = _get_session(payload->session);
+
+	if (!session) {
 		return kErrInvalidSession;
 	}
 
 #ifdef MAVLINK_FTP_DEBUG
-	PX4_INFO("FTP: burst offset:%d", payload->offset);
+	PX4_INFO("FTP: burst session:%d offset:%d", payload->session, payload->offset);
 #endif
 	// Setup for streaming sends
-	_session_info.stream_download = true;
-	_session_info.stream_offset = payload->offset;
-	_session_info.stream_chunk_transmitted = 0;
-	_session_info.stream_seq_number = payload->seq_number + 1;
-	_session_info.stream_target_system_id = target_system_id;
+	session->stream_download = true;
+	session->stream_offset = payload->offset;
+	session->stream_chunk_transmitted = 0;
+	session->stream_seq_number = payload->seq_number + 1;
+	session->stream_target_system_id = target_system_id;
 
 	return kErrNone;
 }
@@ -607,24 +646,51 @@ MavlinkFTP::_workBurst(PayloadHeader *payload, uint8_t target_system_id)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workWrite(PayloadHeader *payload)
 {
-	if (payload->session != 0 && _session_info.fd < 0) {
+	SessionInfo *session = _get_session(payload->session);
+
+	if (!session) {
 		return kErrInvalidSession;
 	}
 
-	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-		// Unable to see to the specified location
-		PX4_ERR("seek fail");
-		return kErrFailErrno;
+	// Writes are accepted at any offset in any order, so that the client can have several writes in flight and
+	// only resend the ones which were not acked. Contiguous writes are collected in the session buffer and written
+	// as one block, a write error of buffered data is reported with the write that triggers the flush.
+	if (session->buffer_length > 0 && (payload->offset != session->buffer_offset + session->buffer_length
+					   || session->buffer_length + payload->size > kSessionBufferSize)) {
+		if (_session_flush(*session) != 0) {
+			return kErrFailErrno;
+		}
 	}
 
-	int bytes_written = ::write(_session_info.fd, &payload->data[0], payload->size);
+	int bytes_written;
 
-	if (bytes_written < 0) {
-		// Negative return indicates error other than eof
-		PX4_ERR("write fail %d", bytes_written);
-		return kErrFailErrno;
+	if (session->writing && _ensure_session_buffer(*session)) {
+		if (session->buffer_length == 0) {
+			session->buffer_offset = payload->offset;
+		}
+
+		memcpy(&session->buffer[session->buffer_length], &payload->data[0], payload->size);
+		session->buffer_length += payload->size;
+		bytes_written = payload->size;
+
+	} else {
+		if (lseek(session->fd, payload->offset, SEEK_SET) < 0) {
+			// Unable to see to the specified location
+			PX4_ERR("seek fail");
+			return kErrFailErrno;
+		}
+
+		bytes_written = ::write(session->fd, &payload->data[0], payload->size);
+
+		if (bytes_written < 0) {
+			// Negative return indicates error other than eof
+			PX4_ERR("write fail %d", bytes_written);
+			return kErrFailErrno;
+		}
 	}
 
+	_update_crc32(*session, payload->offset, &payload->data[0], bytes_written);
+
 	payload->size = sizeof(uint32_t);
 	std::memcpy(payload->data, &bytes_written, payload->size);
 
@@ -640,6 +706,8 @@ MavlinkFTP::_workRemoveFile(PayloadHeader *payload)
 	// ensure termination
 	_work_buffer1[_work_buffer1_len - 1] = '\0';
 
+	_invalidate_crc32_cache();
+
 	if (unlink(_work_buffer1) == 0) {
 		payload->size = 0;
 		return kErrNone;
@@ -659,6 +727,8 @@ MavlinkFTP::_workTruncateFile(PayloadHeader *payload)
 	_work_buffer1[_work_buffer1_len - 1] = '\0';
 	payload->size = 0;
 
+	_invalidate_crc32_cache();
+
 #ifdef __PX4_NUTTX
 
 	// emulate truncate(_work_buffer1, payload->offset) by
@@ -747,16 +817,19 @@ MavlinkFTP::_workTruncateFile(PayloadHeader *payload)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workTerminate(PayloadHeader *payload)
 {
-	if (payload->session != 0 || _session_info.fd < 0) {
+	SessionInfo *session = _get_session(payload->session);
+
+	if (!session) {
 		return kErrInvalidSession;
 	}
 
-	::close(_session_info.fd);
-	_session_info.fd = -1;
-	_session_info.stream_download = false;
-
 	payload->size = 0;
 
+	// the last write is only on the file once the session is flushed
+	if (_close_session(*session) != 0) {
+		return kErrFailErrno;
+	}
+
 	return kErrNone;
 }
 
@@ -764,10 +837,8 @@ MavlinkFTP::_workTerminate(PayloadHeader *payload)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workReset(PayloadHeader *payload)
 {
-	if (_session_info.fd != -1) {
-		::close(_session_info.fd);
-		_session_info.fd = -1;
-		_session_info.stream_download = false;
+	for (uint8_t i = 0; i < kMaxSessions; i++) {
+		_close_session(_session_info[i]);
 	}
 
 	payload->size = 0;
@@ -775,6 +846,165 @@ MavlinkFTP::_workReset(PayloadHeader *payload)
 	return kErrNone;
 }
 
+/// @brief Returns the open session with the given id, or nullptr
+MavlinkFTP::SessionInfo *
+MavlinkFTP::_get_session(uint8_t session)
+{
+	if (session >= kMaxSessions || _session_info[session].fd < 0) {
+		return nullptr;
+	}
+
+	return &_session_info[session];
+}
+
+/// @brief Writes buffered data, caches the CRC32 if the whole file was uploaded and closes the session
+///	@return 0 on success, -1 with errno set if the buffered data could not be written
+int
+MavlinkFTP::_close_session(SessionInfo &session)
+{
+	if (session.fd < 0) {
+		return 0;
+	}
+
+	int ret = _session_flush(session);
+	int flush_errno = errno;
+
+	if (ret != 0) {
+		PX4_ERR("FTP: write fail on close");
+		session.crc32_valid = false;
+	}
+
+	::close(session.fd);
+	session.fd = -1;
+	session.stream_download = false;
+
+	struct stat st;
+
+	if (session.crc32_valid && stat(session.path, &st) == 0 && (uint32_t)st.st_size == session.crc32_length) {
+		_invalidate_crc32_cache();
+		_crc32_cache.path = session.path;
+		_crc32_cache.size = st.st_size;
+		_crc32_cache.mtime = st.st_mtime;
+		_crc32_cache.crc32 = session.crc32;
+		session.path = nullptr;
+	}
+
+	free(session.path);
+	session.path = nullptr;
+
+	delete[] session.buffer;
+	session.buffer = nullptr;
+	session.buffer_length = 0;
+
+	errno = flush_errno;
+	return ret;
+}
+
+bool
+MavlinkFTP::_ensure_session_buffer(SessionInfo &session)
+{
+	if (!session.buffer) {
+		session.buffer = new uint8_t[kSessionBufferSize];
+		session.buffer_length = 0;
+	}
+
+	return session.buffer != nullptr;
+}
+
+/// @brief Reads from the session file through the read-ahead block
+///	@return number of bytes read, or -1 with errno set
+int
+MavlinkFTP::_session_read(SessionInfo &session, uint32_t offset, uint8_t *data, uint8_t length)
+{
+	if (session.writing || !_ensure_session_buffer(session)) {
+		// no read-ahead (reading back a file being written is not a use case worth buffering)
+		if (_session_flush(session) != 0 || lseek(session.fd, offset, SEEK_SET) < 0) {
+			return -1;
+		}
+
+		return ::read(session.fd, data, length);
+	}
+
+	if (offset < session.buffer_offset || offset + length > session.buffer_offset + session.buffer_length) {
+		session.buffer_length = 0;
+
+		if (lseek(session.fd, offset, SEEK_SET) < 0) {
+			PX4_ERR("seek fail");
+			return -1;
+		}
+
+		int bytes_read = ::read(session.fd, session.buffer, kSessionBufferSize);
+
+		if (bytes_read < 0) {
+			return -1;
+		}
+
+		session.buffer_offset = offset;
+		session.buffer_length = bytes_read;
+	}
+
+	if (offset >= session.buffer_offset + session.buffer_length) {
+		return 0;
+	}
+
+	uint32_t available = session.buffer_offset + session.buffer_length - offset;
+	uint32_t bytes_read = length < available ? length : available;
+	memcpy(data, &session.buffer[offset - session.buffer_offset], bytes_read);
+	return bytes_read;
+}
+
+/// @brief Writes the buffered data of a write session to the file
+///	@return 0 on success, -1 with errno set otherwise
+int
+MavlinkFTP::_session_flush(SessionInfo &session)
+{
+	if (!session.writing || session.buffer_length == 0) {
+		return 0;
+	}
+
+	const uint32_t length = session.buffer_length;
+	session.buffer_length = 0;
+
+	if (lseek(session.fd, session.buffer_offset, SEEK_SET) < 0) {
+		PX4_ERR("seek fail");
+		return -1;
+	}
+
+	if (::write(session.fd, session.buffer, length) != (ssize_t)length) {
+		PX4_ERR("write fail");
+		return -1;
+	}
+
+	return 0;
+}
+
+/// @brief Extends the session CRC32 with transferred data. The CRC32 is only kept while the transferred data is
+/// contiguous from the start of the file, a gap invalidates it.
+void
+MavlinkFTP::_update_crc32(SessionInfo &session, uint32_t offset, const uint8_t *data, uint32_t length)
+{
+	if (!session.crc32_valid || offset + length <= session.crc32_length) {
+		// repeated data (e.g. a resent packet) does not change the CRC32
+		return;
+	}
+
+	if (offset > session.crc32_length) {
+		session.crc32_valid = false;
+		return;
+	}
+
+	const uint32_t skip = session.crc32_length - offset;
+	session.crc32 = crc32part(data + skip, length - skip, session.crc32);
+	session.crc32_length = offset + length;
+}
+
+void
+MavlinkFTP::_invalidate_crc32_cache()
+{
+	free(_crc32_cache.path);
+	_crc32_cache.path = nullptr;
+}
+
 /// @brief Responds to a Rename command
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workRename(PayloadHeader *payload)
@@ -796,6 +1026,8 @@ MavlinkFTP::_workRename(PayloadHeader *payload)
 	strncpy(_work_buffer2 + _root_dir_len, ptr + oldpath_sz + 1, _work_buffer2_len - _root_dir_len);
 	_work_buffer2[_work_buffer2_len - 1] = '\0'; // ensure termination
 
+	_invalidate_crc32_cache();
+
 	if (rename(_work_buffer1, _work_buffer2) == 0) {
 		payload->size = 0;
 		return kErrNone;
@@ -852,27 +1084,48 @@ MavlinkFTP::_workCalcFileCRC32(PayloadHeader *payload)
 	// ensure termination
 	_work_buffer2[_work_buffer2_len - 1] = '\0';
 
-	int fd = ::open(_work_buffer2, O_RDONLY);
+	// the CRC32 is usually requested right after an upload, which computed it already
+	struct stat st;
 
-	if (fd < 0) {
-		return kErrFailErrno;
+	if (stat(_work_buffer2, &st) == 0) {
+		if (_crc32_cache.path && _crc32_cache.size == (uint32_t)st.st_size && _crc32_cache.mtime == st.st_mtime
+		    && strcmp(_crc32_cache.path, _work_buffer2) == 0) {
+			checksum = _crc32_cache.crc32;
+			goto out;
+		}
 	}
 
-	do {
-		bytes_read = ::read(fd, _work_buffer2, _work_buffer2_len);
+	{
+		int fd = ::open(_work_buffer2, O_RDONLY);
 
-		if (bytes_read < 0) {
-			int r_errno = errno;
-			::close(fd);
-			errno = r_errno;
+		if (fd < 0) {
 			return kErrFailErrno;
 		}
 
-		checksum = crc32part((uint8_t *)_work_buffer2, bytes_read, checksum);
-	} while (bytes_read == _work_buffer2_len);
+		// read in large blocks if the memory is available
+		uint8_t *block = new uint8_t[kSessionBufferSize];
+		uint8_t *buffer = block ? block : (uint8_t *)_work_buffer2;
+		const ssize_t buffer_len = block ? kSessionBufferSize : _work_buffer2_len;
+
+		do {
+			bytes_read = ::read(fd, buffer, buffer_len);
 
-	::close(fd);
+			if (bytes_read < 0) {
+				int r_errno = errno;
+				::close(fd);
+				delete[] block;
+				errno = r_errno;
+				return kErrFailErrno;
+			}
 
+			checksum = crc32part(buffer, bytes_read, checksum);
+		} while (bytes_read == buffer_len);
+
+		::close(fd);
+		delete[] block;
+	}
+
+out:
 	payload->size = sizeof(uint32_t);
 	std::memcpy(payload->data, &checksum, payload->size);
 	return kErrNone;
@@ -975,119 +1228,114 @@ void MavlinkFTP::send(const hrt_abstime t)
 	}
 
 	// Anything to stream?
-	if (!_session_info.stream_download) {
+	if (get_size() == 0) {
 		return;
 	}
 
-#ifndef MAVLINK_FTP_UNIT_TEST
 	// Skip send if not enough room
-	unsigned max_bytes_to_send = _mavlink->get_free_tx_buf();
+	unsigned max_bytes_to_send = _get_free_tx_buf();
 #ifdef MAVLINK_FTP_DEBUG
-	PX4_INFO("MavlinkFTP::send max_bytes_to_send(%d) get_free_tx_buf(%d)", max_bytes_to_send, _mavlink->get_free_tx_buf());
+	PX4_INFO("MavlinkFTP::send max_bytes_to_send(%d) get_free_tx_buf(%d)", max_bytes_to_send, _get_free_tx_buf());
 #endif
 
-	if (max_bytes_to_send < get_size()) {
-		return;
-	}
+	// Send stream packets until buffer is full, alternating between the sessions with an active burst
+	while (max_bytes_to_send >= get_size()) {
+		SessionInfo *session = nullptr;
 
-#endif
+		for (uint8_t i = 0; i < kMaxSessions && !session; i++) {
+			SessionInfo &candidate = _session_info[(_next_stream_session + i) % kMaxSessions];
 
-	// Send stream packets until buffer is full
+			if (candidate.fd >= 0 && candidate.stream_download) {
+				session = &candidate;
+				_next_stream_session = (_next_stream_session + i + 1) % kMaxSessions;
+			}
+		}
 
-	bool more_data;
+		if (!session) {
+			break;
+		}
 
-	do {
-		more_data = false;
+		max_bytes_to_send -= get_size();
 
-		ErrorCode error_code = kErrNone;
+		if (!_send_burst_packet(*session, max_bytes_to_send < get_size())) {
+			break;
+		}
+	}
+}
 
-		mavlink_file_transfer_protocol_t ftp_msg;
-		PayloadHeader *payload = reinterpret_cast<PayloadHeader *>(&ftp_msg.payload[0]);
+/// @brief Sends the next packet of a burst download
+///	@param last_in_burst no more packets can be sent in this send() call
+///	@return false if a reply was sent that might have ended the transfer of this session
+bool
+MavlinkFTP::_send_burst_packet(SessionInfo &session, bool last_in_burst)
+{
+	ErrorCode error_code = kErrNone;
 
-		payload->seq_number = _session_info.stream_seq_number;
-		payload->session = 0;
-		payload->opcode = kRspAck;
-		payload->req_opcode = kCmdBurstReadFile;
-		payload->offset = _session_info.stream_offset;
-		_session_info.stream_seq_number++;
+	mavlink_file_transfer_protocol_t ftp_msg;
+	PayloadHeader *payload = reinterpret_cast<PayloadHeader *>(&ftp_msg.payload[0]);
 
-#ifdef MAVLINK_FTP_DEBUG
-		PX4_INFO("stream send: offset %d", _session_info.stream_offset);
-#endif
+	payload->seq_number = session.stream_seq_number;
+	payload->session = &session - _session_info;
+	payload->opcode = kRspAck;
+	payload->req_opcode = kCmdBurstReadFile;
+	payload->offset = session.stream_offset;
+	payload->burst_complete = false;
+	session.stream_seq_number++;
 
-		// We have to test seek past EOF ourselves, lseek will allow seek past EOF
-		if (_session_info.stream_offset >= _session_info.file_size) {
-			error_code = kErrEOF;
 #ifdef MAVLINK_FTP_DEBUG
-			PX4_INFO("stream download: sending Nak EOF");
+	PX4_INFO("stream send: session %d offset %d", payload->session, session.stream_offset);
 #endif
-		}
 
-		if (error_code == kErrNone) {
-			if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-				error_code = kErrFailErrno;
+	// We have to test seek past EOF ourselves, lseek will allow seek past EOF
+	if (session.stream_offset >= session.file_size) {
+		error_code = kErrEOF;
 #ifdef MAVLINK_FTP_DEBUG
-				PX4_WARN("stream download: seek fail");
+		PX4_INFO("stream download: sending Nak EOF");
 #endif
-			}
-		}
+	}
 
-		if (error_code == kErrNone) {
-			int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+	if (error_code == kErrNone) {
+		int bytes_read = _session_read(session, payload->offset, &payload->data[0], kMaxDataLength);
 
-			if (bytes_read < 0) {
-				// Negative return indicates error other than eof
-				error_code = kErrFailErrno;
+		if (bytes_read < 0) {
+			// Negative return indicates error other than eof
+			error_code = kErrFailErrno;
 #ifdef MAVLINK_FTP_DEBUG
-				PX4_WARN("stream download: read fail");
+			PX4_WARN("stream download: read fail");
 #endif
 
-			} else {
-				payload->size = bytes_read;
-				_session_info.stream_offset += bytes_read;
-				_session_info.stream_chunk_transmitted += bytes_read;
-			}
-		}
-
-		if (error_code != kErrNone) {
-			payload->opcode = kRspNak;
-			payload->size = 1;
-			uint8_t *pData = &payload->data[0];
-			*pData = error_code; // Straight reference to data[0] is causing bogus gcc array subscript error
-
-			if (error_code == kErrFailErrno) {
-				int r_errno = errno;
-				payload->size = 2;
-				payload->data[1] = r_errno;
-			}
-
-			_session_info.stream_download = false;
-
 		} else {
-#ifndef MAVLINK_FTP_UNIT_TEST
+			payload->size = bytes_read;
+			session.stream_offset += bytes_read;
+			session.stream_chunk_transmitted += bytes_read;
+		}
+	}
 
-			if (max_bytes_to_send < (get_size() * 2)) {
-				more_data = false;
+	if (error_code != kErrNone) {
+		payload->opcode = kRspNak;
+		payload->size = 1;
+		uint8_t *pData = &payload->data[0];
+		*pData = error_code; // Straight reference to data[0] is causing bogus gcc array subscript error
 
-				/* perform transfers in 35K chunks - this is determined empirical */
-				if (_session_info.stream_chunk_transmitted > 35000) {
-					payload->burst_complete = true;
-					_session_info.stream_download = false;
-					_session_info.stream_chunk_transmitted = 0;
-				}
+		if (error_code == kErrFailErrno) {
+			int r_errno = errno;
+			payload->size = 2;
+			payload->data[1] = r_errno;
+		}
 
-			} else {
-#endif
-				more_data = true;
-				payload->burst_complete = false;
-#ifndef MAVLINK_FTP_UNIT_TEST
-				max_bytes_to_send -= get_size();
-			}
+		session.stream_download = false;
 
-#endif
+	} else if (last_in_burst) {
+		/* perform transfers in 35K chunks - this is determined empirical */
+		if (session.stream_chunk_transmitted > 35000) {
+			payload->burst_complete = true;
+			session.stream_download = false;
+			session.stream_chunk_transmitted = 0;
 		}
+	}
+
+	ftp_msg.target_system = session.stream_target_system_id;
+	_reply(&ftp_msg);
 
-		ftp_msg.target_system = _session_info.stream_target_system_id;
-		_reply(&ftp_msg);
-	} while (more_data);
+	return error_code == kErrNone;
 }
@@ -38,6 +38,7 @@
 
 #include <dirent.h>
 #include <queue.h>
+#include <time.h>
 
 #include <px4_defines.h>
 #include <systemlib/err.h>
@@ -71,6 +72,9 @@ public:
 	///	@param worker_data Data to pass to worker
 	void set_unittest_worker(ReceiveMessageFunc_t rcvMsgFunc, void *worker_data);
 
+	/// @brief Sets the number of bytes the unit test link can take on the next send() call (unlimited by default)
+	void set_unittest_free_tx_buf(unsigned free_tx_buf) { _ut_free_tx_buf = free_tx_buf; }
+
 	/// @brief This is the payload which is in mavlink_file_transfer_protocol_t.payload.
 	/// This needs to be packed, because it's typecasted from mavlink_file_transfer_protocol_t.payload, which starts
 	/// at a 3 byte offset, causing an unaligned access to seq_number and offset
@@ -131,6 +135,7 @@ private:
 	void		_process_request(mavlink_file_transfer_protocol_t *ftp_req, uint8_t target_system_id);
 	void		_reply(mavlink_file_transfer_protocol_t *ftp_req);
 	int		_copy_file(const char *src_path, const char *dst_path, size_t length);
+	unsigned	_get_free_tx_buf();
 
 	ErrorCode	_workList(PayloadHeader *payload, bool list_hidden = false);
 	ErrorCode	_workOpen(PayloadHeader *payload, int oflag);
@@ -146,6 +151,17 @@ private:
 	ErrorCode	_workRename(PayloadHeader *payload);
 	ErrorCode	_workCalcFileCRC32(PayloadHeader *payload);
 
+	struct SessionInfo;
+
+	SessionInfo	*_get_session(uint8_t session);
+	int		_close_session(SessionInfo &session);
+	bool		_ensure_session_buffer(SessionInfo &session);
+	int		_session_read(SessionInfo &session, uint32_t offset, uint8_t *data, uint8_t length);
+	int		_session_flush(SessionInfo &session);
+	void		_update_crc32(SessionInfo &session, uint32_t offset, const uint8_t *data, uint32_t length);
+	void		_invalidate_crc32_cache();
+	bool		_send_burst_packet(SessionInfo &session, bool last_in_burst);
+
 	uint8_t _getServerSystemId(void);
 	uint8_t _getServerComponentId(void);
 	uint8_t _getServerChannel(void);
@@ -163,19 +179,48 @@ private:
 	/// @brief Maximum data size in RequestHeader::data
 	static const uint8_t	kMaxDataLength = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(PayloadHeader);
 
+	/// @brief Maximum number of concurrently open sessions
+	static const uint8_t	kMaxSessions = 4;
+
+	/// @brief Size of the per session read-ahead (or write-behind) block
+#ifdef __PX4_NUTTX
+	static const uint32_t	kSessionBufferSize = 2048;
+#else
+	static const uint32_t	kSessionBufferSize = 16384;
+#endif
+
 	struct SessionInfo {
 		int		fd;
+		bool		writing;		///< opened for writing, the buffer holds data not yet written to the file
 		uint32_t	file_size;
+		char		*path;			///< file path, to cache the CRC32 when a write session is closed
+		uint8_t		*buffer;		///< block of the file starting at buffer_offset, allocated on first use
+		uint32_t	buffer_offset;
+		uint32_t	buffer_length;
+		uint32_t	crc32;			///< CRC32 of the file data uploaded contiguously from the start
+		uint32_t	crc32_length;		///< number of bytes covered by crc32
+		bool		crc32_valid;
 		bool		stream_download;
 		uint32_t	stream_offset;
 		uint16_t	stream_seq_number;
 		uint8_t		stream_target_system_id;
 		unsigned	stream_chunk_transmitted;
 	};
-	struct SessionInfo _session_info {};	///< Session info, fd=-1 for no active session
+	struct SessionInfo _session_info[kMaxSessions] {};	///< Session info, fd=-1 for no active session
+	uint8_t _next_stream_session{0};	///< session to send the next burst packet for (round-robin)
+
+	/// @brief CRC32 of the last file completely uploaded through FTP, returned by kCmdCalcFileCRC32 while the file is unchanged
+	struct CRC32Cache {
+		char		*path;
+		uint32_t	size;
+		time_t		mtime;
+		uint32_t	crc32;
+	};
+	struct CRC32Cache _crc32_cache {};
 
 	ReceiveMessageFunc_t	_utRcvMsgFunc{};	///< Unit test override for mavlink message sending
 	void			*_worker_data{nullptr};	///< Additional parameter to _utRcvMsgFunc;
+	unsigned		_ut_free_tx_buf{UINT32_MAX / 2};	///< Unit test link capacity for send()
 
 	Mavlink *_mavlink;
 
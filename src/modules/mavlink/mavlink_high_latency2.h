@@ -82,6 +82,11 @@ public:
 		return true;
 	}
 
+	bool collects_data()
+	{
+		return true;
+	}
+
 private:
 	MavlinkOrbSubscription *_actuator_sub_0;
 	uint64_t _actuator_time_0;
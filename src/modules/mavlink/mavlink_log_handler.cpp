@@ -36,14 +36,20 @@
 
 #include "mavlink_log_handler.h"
 #include "mavlink_main.h"
+#include <mathlib/mathlib.h>
 #include <sys/stat.h>
 #include <time.h>
 
 #define MOUNTPOINT PX4_STORAGEDIR
 
 static const char *kLogRoot    = MOUNTPOINT "/log";
-static const char *kLogData    = MOUNTPOINT "/logdata.txt";
-static const char *kTmpData    = MOUNTPOINT "/$log$.txt";
+
+//-- Log data is read from the file in blocks of this size and sent from memory
+#ifdef __PX4_NUTTX
+static constexpr uint32_t kReadBufferSize = 2048;
+#else
+static constexpr uint32_t kReadBufferSize = 16384;
+#endif
 
 #ifdef __PX4_NUTTX
 #define PX4LOG_REGULAR_FILE DTYPE_FILE
@@ -81,7 +87,9 @@ stat_file(const char *file, time_t *date = nullptr, uint32_t *size = nullptr)
 //-------------------------------------------------------------------
 MavlinkLogHandler::MavlinkLogHandler(Mavlink *mavlink)
 	: _pLogHandlerHelper(nullptr),
-	  _mavlink(mavlink)
+	  _mavlink(mavlink),
+	  _last_send(0),
+	  _send_budget(0)
 {
 
 }
@@ -129,7 +137,7 @@ MavlinkLogHandler::get_size()
 
 //-------------------------------------------------------------------
 void
-MavlinkLogHandler::send(const hrt_abstime /*t*/)
+MavlinkLogHandler::send(const hrt_abstime t)
 {
 	//-- An arbitrary count of max bytes in one go (one of the two below but never both)
 #define MAX_BYTES_SEND 256 * 1024
@@ -141,10 +149,17 @@ MavlinkLogHandler::send(const hrt_abstime /*t*/)
 		count += _log_send_listing();
 	}
 
-	//-- Log Data
+	//-- Log Data: refill the budget at the link data rate, holding at most 100ms worth of data so
+	//   that a burst after an idle period does not overrun the link
+	const uint32_t data_rate = _mavlink->get_data_rate() > 0 ? _mavlink->get_data_rate() : MAX_BYTES_SEND;
+	const uint32_t max_budget = math::constrain(data_rate / 10, get_size(), (unsigned)MAX_BYTES_SEND);
+	const uint64_t refill = (uint64_t)data_rate * (t - _last_send) / 1000000;
+	_send_budget = math::min((uint64_t)max_budget, _send_budget + refill);
+	_last_send = t;
+
 	while (_pLogHandlerHelper && _pLogHandlerHelper->current_status == LogListHelper::LOG_HANDLER_SENDING_DATA
-	       && _mavlink->get_free_tx_buf() > get_size() && count < MAX_BYTES_SEND) {
-		count += _log_send_data();
+	       && _mavlink->get_free_tx_buf() > get_size() && _send_budget >= get_size()) {
+		_send_budget -= _log_send_data();
 	}
 }
 
@@ -211,6 +226,8 @@ MavlinkLogHandler::_log_request_data(const mavlink_message_t *msg)
 	_pLogHandlerHelper->current_status = LogListHelper::LOG_HANDLER_IDLE;
 
 	if (_pLogHandlerHelper->current_log_index != request.id) {
+		_report_throughput();
+
 		//-- Init send log dataset
 		_pLogHandlerHelper->current_log_filename[0] = 0;
 		_pLogHandlerHelper->current_log_index = request.id;
@@ -224,6 +241,8 @@ MavlinkLogHandler::_log_request_data(const mavlink_message_t *msg)
 		}
 
 		_pLogHandlerHelper->open_for_transmit();
+		_pLogHandlerHelper->transfer_start = hrt_absolute_time();
+		_pLogHandlerHelper->transfer_bytes = 0;
 	}
 
 	_pLogHandlerHelper->current_log_data_offset = request.ofs;
@@ -267,6 +286,7 @@ MavlinkLogHandler::_log_request_end(const mavlink_message_t * /*msg*/)
 	PX4LOG_WARN("MavlinkLogHandler::_log_request_end\n");
 
 	if (_pLogHandlerHelper) {
+		_report_throughput();
 		delete _pLogHandlerHelper;
 		_pLogHandlerHelper = nullptr;
 	}
@@ -323,12 +343,30 @@ MavlinkLogHandler::_log_send_data()
 	mavlink_msg_log_data_send_struct(_mavlink->get_channel(), &response);
 	_pLogHandlerHelper->current_log_data_offset    += read_size;
 	_pLogHandlerHelper->current_log_data_remaining -= read_size;
+	_pLogHandlerHelper->transfer_bytes             += read_size;
 
 	if (read_size < sizeof(response.data) || _pLogHandlerHelper->current_log_data_remaining == 0) {
 		_pLogHandlerHelper->current_status = LogListHelper::LOG_HANDLER_IDLE;
 	}
 
-	return sizeof(response);
+	return get_size();
+}
+
+//-------------------------------------------------------------------
+void
+MavlinkLogHandler::_report_throughput()
+{
+	if (!_pLogHandlerHelper || _pLogHandlerHelper->transfer_bytes == 0) {
+		return;
+	}
+
+	const float elapsed = hrt_elapsed_time(&_pLogHandlerHelper->transfer_start) * 1e-6f;
+
+	PX4_INFO("log %u: sent %u bytes in %.1f s (%.1f kB/s)", _pLogHandlerHelper->current_log_index,
+		 _pLogHandlerHelper->transfer_bytes, (double)elapsed,
+		 (double)(elapsed > 0.f ? _pLogHandlerHelper->transfer_bytes / elapsed / 1024.f : 0.f));
+
+	_pLogHandlerHelper->transfer_bytes = 0;
 }
 
 //-------------------------------------------------------------------
@@ -342,6 +380,16 @@ LogListHelper::LogListHelper()
 	, current_log_data_offset(0)
 	, current_log_data_remaining(0)
 	, current_log_filep(nullptr)
+	, transfer_start(0)
+	, transfer_bytes(0)
+	, _entries(nullptr)
+	, _entries_capacity(0)
+	, _names(nullptr)
+	, _names_length(0)
+	, _names_capacity(0)
+	, _read_buffer(nullptr)
+	, _read_buffer_offset(0)
+	, _read_buffer_length(0)
 {
 	_init();
 }
@@ -349,48 +397,41 @@ LogListHelper::LogListHelper()
 //-------------------------------------------------------------------
 LogListHelper::~LogListHelper()
 {
-	// Remove log data files (if any)
-	unlink(kLogData);
-	unlink(kTmpData);
+	if (current_log_filep) {
+		::fclose(current_log_filep);
+	}
+
+	free(_entries);
+	free(_names);
+	delete[] _read_buffer;
 }
 
 //-------------------------------------------------------------------
 bool
 LogListHelper::get_entry(int idx, uint32_t &size, uint32_t &date, char *filename, int filename_len)
 {
-	//-- Find log file in log list file created during init()
-	size = 0;
-	date = 0;
-	bool result = false;
-	//-- Open list of log files
-	FILE *f = ::fopen(kLogData, "r");
-
-	if (f) {
-		//--- Find requested entry
-		char line[160];
-		int count = 0;
-
-		while (fgets(line, sizeof(line), f)) {
-			//-- Found our "index"
-			if (count++ == idx) {
-				char file[160];
-
-				if (sscanf(line, "%u %u %s", &date, &size, file) == 3) {
-					if (filename && filename_len > 0) {
-						strncpy(filename, file, filename_len);
-						filename[filename_len - 1] = 0; // ensure null-termination
-					}
+	//-- Find log file in the index created during init()
+	if (idx < 0 || idx >= log_count) {
+		size = 0;
+		date = 0;
+		return false;
+	}
 
-					result = true;
-					break;
-				}
-			}
-		}
+	const LogEntry &entry = _entries[idx];
+	size = entry.size;
+	date = entry.date;
+
+	if (filename && filename_len > 0) {
+		int ret = snprintf(filename, filename_len, "%s/%s/%s", kLogRoot, &_names[entry.dir_offset],
+				   &_names[entry.file_offset]);
 
-		fclose(f);
+		if (ret < 0 || ret >= filename_len) {
+			filename[0] = 0;
+			return false;
+		}
 	}
 
-	return result;
+	return true;
 }
 
 //-------------------------------------------------------------------
@@ -403,6 +444,7 @@ LogListHelper::open_for_transmit()
 	}
 
 	current_log_filep = ::fopen(current_log_filename, "rb");
+	_read_buffer_length = 0;
 
 	if (!current_log_filep) {
 		PX4LOG_WARN("MavlinkLogHandler::open_for_transmit Could not open %s\n", current_log_filename);
@@ -425,16 +467,38 @@ LogListHelper::get_log_data(uint8_t len, uint8_t *buffer)
 		return 0;
 	}
 
-	long int offset = current_log_data_offset - ftell(current_log_filep);
+	if (!_read_buffer) {
+		_read_buffer = new uint8_t[kReadBufferSize];
 
-	if (offset && fseek(current_log_filep, offset, SEEK_CUR)) {
-		fclose(current_log_filep);
-		current_log_filep = nullptr;
-		PX4LOG_WARN("MavlinkLogHandler::get_log_data Seek error in %s\n", current_log_filename);
+		if (!_read_buffer) {
+			PX4LOG_WARN("MavlinkLogHandler::get_log_data Could not allocate read buffer\n");
+			return 0;
+		}
+	}
+
+	//-- Read the next block if the requested range is not (completely) buffered
+	if (current_log_data_offset < _read_buffer_offset ||
+	    current_log_data_offset + len > _read_buffer_offset + _read_buffer_length) {
+
+		_read_buffer_length = 0;
+
+		if (fseek(current_log_filep, current_log_data_offset, SEEK_SET)) {
+			fclose(current_log_filep);
+			current_log_filep = nullptr;
+			PX4LOG_WARN("MavlinkLogHandler::get_log_data Seek error in %s\n", current_log_filename);
+			return 0;
+		}
+
+		_read_buffer_offset = current_log_data_offset;
+		_read_buffer_length = fread(_read_buffer, 1, kReadBufferSize, current_log_filep);
+	}
+
+	if (current_log_data_offset >= _read_buffer_offset + _read_buffer_length) {
 		return 0;
 	}
 
-	size_t result = fread(buffer, 1, len, current_log_filep);
+	size_t result = math::min((uint32_t)len, _read_buffer_offset + _read_buffer_length - current_log_data_offset);
+	memcpy(buffer, &_read_buffer[current_log_data_offset - _read_buffer_offset], result);
 	return result;
 }
 
@@ -445,13 +509,11 @@ LogListHelper::_init()
 	/*
 
 		When this helper is created, it scans the log directory
-		and collects all log files found into one file for easy,
-		subsequent access.
+		and collects all log files found into an in-memory index
+		for easy, subsequent access.
 	*/
 
 	current_log_filename[0] = 0;
-	// Remove old log data file (if any)
-	unlink(kLogData);
 	// Open log directory
 	DIR *dp = opendir(kLogRoot);
 
@@ -460,15 +522,6 @@ LogListHelper::_init()
 		return;
 	}
 
-	// Create work file
-	FILE *f = ::fopen(kTmpData, "w");
-
-	if (!f) {
-		PX4LOG_WARN("MavlinkLogHandler::init Error creating %s\n", kTmpData);
-		closedir(dp);
-		return;
-	}
-
 	// Scan directory and collect log files
 	struct dirent *result = nullptr;
 
@@ -480,21 +533,62 @@ LogListHelper::_init()
 			bool path_is_ok = (ret > 0) && (ret < (int)sizeof(log_path));
 
 			if (path_is_ok) {
-				if (_get_session_date(log_path, result->d_name, tt)) {
-					_scan_logs(f, log_path, tt);
+				uint32_t dir_offset;
+
+				if (_get_session_date(log_path, result->d_name, tt) && _add_name(result->d_name, dir_offset)) {
+					_scan_logs(log_path, dir_offset, tt);
 				}
 			}
 		}
 	}
 
 	closedir(dp);
-	fclose(f);
+}
+
+//-------------------------------------------------------------------
+bool
+LogListHelper::_add_name(const char *name, uint32_t &offset)
+{
+	const uint32_t length = strlen(name) + 1;
+
+	if (_names_length + length > _names_capacity) {
+		uint32_t capacity = math::max(_names_capacity * 2, _names_length + length + 256);
+		char *names = (char *)realloc(_names, capacity);
 
-	// Rename temp file to data file
-	if (rename(kTmpData, kLogData)) {
-		PX4LOG_WARN("MavlinkLogHandler::init Error renaming %s\n", kTmpData);
-		log_count = 0;
+		if (!names) {
+			PX4LOG_WARN("MavlinkLogHandler::init Out of memory for log names\n");
+			return false;
+		}
+
+		_names = names;
+		_names_capacity = capacity;
 	}
+
+	memcpy(&_names[_names_length], name, length);
+	offset = _names_length;
+	_names_length += length;
+	return true;
+}
+
+//-------------------------------------------------------------------
+bool
+LogListHelper::_add_entry(const LogEntry &entry)
+{
+	if (log_count >= _entries_capacity) {
+		int capacity = math::max(_entries_capacity * 2, 16);
+		LogEntry *entries = (LogEntry *)realloc(_entries, capacity * sizeof(LogEntry));
+
+		if (!entries) {
+			PX4LOG_WARN("MavlinkLogHandler::init Out of memory for log entries\n");
+			return false;
+		}
+
+		_entries = entries;
+		_entries_capacity = capacity;
+	}
+
+	_entries[log_count++] = entry;
+	return true;
 }
 
 //-------------------------------------------------------------------
@@ -526,7 +620,7 @@ LogListHelper::_get_session_date(const char *path, const char *dir, time_t &date
 
 //-------------------------------------------------------------------
 void
-LogListHelper::_scan_logs(FILE *f, const char *dir, time_t &date)
+LogListHelper::_scan_logs(const char *dir, uint32_t dir_offset, time_t &date)
 {
 	DIR *dp = opendir(dir);
 
@@ -542,10 +636,18 @@ LogListHelper::_scan_logs(FILE *f, const char *dir, time_t &date)
 				bool path_is_ok = (ret > 0) && (ret < (int)sizeof(log_file_path));
 
 				if (path_is_ok) {
-					if (_get_log_time_size(log_file_path, result->d_name, ldate, size)) {
-						//-- Write result->out to list file
-						fprintf(f, "%u %u %s\n", (unsigned)ldate, (unsigned)size, log_file_path);
-						log_count++;
+					LogEntry entry;
+
+					if (_get_log_time_size(log_file_path, result->d_name, ldate, size)
+					    && _add_name(result->d_name, entry.file_offset)) {
+						//-- Add to the index
+						entry.date = ldate;
+						entry.size = size;
+						entry.dir_offset = dir_offset;
+
+						if (!_add_entry(entry)) {
+							break;
+						}
 					}
 				}
 			}
@@ -80,11 +80,34 @@ public:
 	FILE       *current_log_filep;
 	char        current_log_filename[128];
 
+	hrt_abstime transfer_start;
+	uint32_t    transfer_bytes;
+
 private:
+	/** one log file, the names are offsets into _names (session directory and file name) */
+	struct LogEntry {
+		uint32_t date;
+		uint32_t size;
+		uint32_t dir_offset;
+		uint32_t file_offset;
+	};
+
 	void        _init();
 	bool        _get_session_date(const char *path, const char *dir, time_t &date);
-	void        _scan_logs(FILE *f, const char *dir, time_t &date);
+	void        _scan_logs(const char *path, uint32_t dir_offset, time_t &date);
 	bool        _get_log_time_size(const char *path, const char *file, time_t &date, uint32_t &size);
+	bool        _add_name(const char *name, uint32_t &offset);
+	bool        _add_entry(const LogEntry &entry);
+
+	LogEntry   *_entries;
+	int         _entries_capacity;
+	char       *_names;
+	uint32_t    _names_length;
+	uint32_t    _names_capacity;
+
+	uint8_t    *_read_buffer;
+	uint32_t    _read_buffer_offset;
+	uint32_t    _read_buffer_length;
 };
 
 // MAVLink LOG_* Message Handler
@@ -113,7 +136,11 @@ private:
 
 	size_t _log_send_listing();
 	size_t _log_send_data();
+	void _report_throughput();
 
 	LogListHelper    *_pLogHandlerHelper;
 	Mavlink *_mavlink;
+
+	hrt_abstime _last_send;
+	uint32_t _send_budget;	///< bytes the data burst may still use, refilled at the link data rate
 };
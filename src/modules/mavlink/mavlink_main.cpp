@@ -1386,6 +1386,8 @@ Mavlink::configure_stream(const char *stream_name, const float rate)
 				delete stream;
 			}
 
+			_stream_scheduler.invalidate();
+
 			return OK;
 		}
 	}
@@ -1402,6 +1404,7 @@ Mavlink::configure_stream(const char *stream_name, const float rate)
 	if (stream != nullptr) {
 		stream->set_interval(interval);
 		LL_APPEND(_streams, stream);
+		_stream_scheduler.invalidate();
 
 		return OK;
 	}
@@ -2230,8 +2233,8 @@ Mavlink::task_main(int argc, char *argv[])
 	MavlinkReceiver::receive_start(&_receive_thread, this);
 
 	while (!_task_should_exit) {
-		/* main loop */
-		px4_usleep(_main_loop_delay);
+		/* main loop, returns early if a stream waiting for data can send */
+		_stream_scheduler.wait(_main_loop_delay);
 
 		perf_count(_loop_interval_perf);
 		perf_begin(_loop_perf);
@@ -2432,12 +2435,12 @@ Mavlink::task_main(int argc, char *argv[])
 			_subscribe_to_stream = nullptr;
 		}
 
-		/* update streams */
-		MavlinkStream *stream;
-		LL_FOREACH(_streams, stream) {
-			stream->update(t);
+		/* update the streams that are due */
+		_stream_scheduler.update(t);
 
-			if (!_first_heartbeat_sent) {
+		if (!_first_heartbeat_sent) {
+			MavlinkStream *stream;
+			LL_FOREACH(_streams, stream) {
 				if (_mode == MAVLINK_MODE_IRIDIUM) {
 					if (stream->get_id() == MAVLINK_MSG_ID_HIGH_LATENCY2) {
 						_first_heartbeat_sent = stream->first_message_sent();
@@ -2836,7 +2839,8 @@ Mavlink::display_status()
 void
 Mavlink::display_status_streams()
 {
-	printf("\t%-20s%-16s %s\n", "Name", "Rate Config (current) [Hz]", "Message Size (if active) [B]");
+	printf("\t%-30s%-28s%-14s%-10s%s\n", "Name", "Rate Config (current) [Hz]", "Achieved [Hz]", "Cost [us]",
+	       "Message Size (if active) [B]");
 
 	const float rate_mult = _rate_mult;
 	MavlinkStream *stream;
@@ -2856,7 +2860,12 @@ Mavlink::display_status_streams()
 			snprintf(rate_str, sizeof(rate_str), "%6.2f (%.3f)", (double)rate, (double)rate_current);
 		}
 
-		printf("\t%-30s%-16s", stream->get_name(), rate_str);
+		// achieved rate and average update cost since the previous status output
+		float rate_achieved;
+		float cost;
+		stream->sample_stats(rate_achieved, cost);
+
+		printf("\t%-30s%-28s%-14.2f%-10.1f", stream->get_name(), rate_str, (double)rate_achieved, (double)cost);
 
 		if (size > 0) {
 			printf(" %3i\n", size);
@@ -2865,6 +2874,8 @@ Mavlink::display_status_streams()
 			printf("\n");
 		}
 	}
+
+	printf("\tstreams waiting for topic updates: %u\n", _stream_scheduler.num_parked());
 }
 
 int
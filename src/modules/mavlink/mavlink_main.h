@@ -74,6 +74,7 @@
 #include "mavlink_bridge_header.h"
 #include "mavlink_orb_subscription.h"
 #include "mavlink_stream.h"
+#include "mavlink_stream_scheduler.h"
 #include "mavlink_messages.h"
 #include "mavlink_shell.h"
 #include "mavlink_ulog.h"
@@ -411,6 +412,11 @@ public:
 	 */
 	void			count_txbytes(unsigned n) { _bytes_tx += n; };
 
+	/**
+	 * Get the bytes transmitted since the last telemetry status update
+	 */
+	unsigned		get_bytes_tx() const { return _bytes_tx; }
+
 	/**
 	 * Count bytes not transmitted because of errors
 	 */
@@ -544,6 +550,7 @@ private:
 
 	MavlinkOrbSubscription	*_subscriptions;
 	MavlinkStream		*_streams;
+	MavlinkStreamScheduler	_stream_scheduler{this};
 
 	MavlinkShell			*_mavlink_shell;
 	MavlinkULog			*_mavlink_ulog;
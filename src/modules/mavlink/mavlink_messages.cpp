@@ -1625,6 +1625,11 @@ public:
 		return true;
 	}
 
+	MavlinkOrbSubscription *get_wakeup_subscription()
+	{
+		return _pos_sub;
+	}
+
 	unsigned get_size()
 	{
 		return (_pos_time > 0) ? MAVLINK_MSG_ID_ADSB_VEHICLE_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
@@ -1640,7 +1645,7 @@ private:
 
 protected:
 	explicit MavlinkStreamADSBVehicle(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_pos_sub(_mavlink->add_orb_subscription(ORB_ID(transponder_report))),
+		_pos_sub(_mavlink->add_orb_subscription(ORB_ID(transponder_report), 0, true)),
 		_pos_time(0)
 	{}
 
@@ -1906,6 +1911,11 @@ public:
 		return new MavlinkStreamCollision(mavlink);
 	}
 
+	MavlinkOrbSubscription *get_wakeup_subscription()
+	{
+		return _collision_sub;
+	}
+
 	unsigned get_size()
 	{
 		return (_collision_time > 0) ? MAVLINK_MSG_ID_COLLISION_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
@@ -1921,7 +1931,7 @@ private:
 
 protected:
 	explicit MavlinkStreamCollision(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_collision_sub(_mavlink->add_orb_subscription(ORB_ID(collision_report))),
+		_collision_sub(_mavlink->add_orb_subscription(ORB_ID(collision_report), 0, true)),
 		_collision_time(0)
 	{}
 
@@ -1982,6 +1992,11 @@ public:
 		return true;
 	}
 
+	MavlinkOrbSubscription *get_wakeup_subscription()
+	{
+		return _trigger_sub;
+	}
+
 	unsigned get_size()
 	{
 		return (_trigger_time > 0) ? MAVLINK_MSG_ID_CAMERA_TRIGGER_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
@@ -1997,7 +2012,7 @@ private:
 
 protected:
 	explicit MavlinkStreamCameraTrigger(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_trigger_sub(_mavlink->add_orb_subscription(ORB_ID(camera_trigger))),
+		_trigger_sub(_mavlink->add_orb_subscription(ORB_ID(camera_trigger), 0, true)),
 		_trigger_time(0)
 	{}
 
@@ -2090,6 +2105,11 @@ public:
 		return new MavlinkStreamCameraImageCaptured(mavlink);
 	}
 
+	MavlinkOrbSubscription *get_wakeup_subscription()
+	{
+		return _capture_sub;
+	}
+
 	unsigned get_size()
 	{
 		return (_capture_time > 0) ? MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
@@ -2105,7 +2125,7 @@ private:
 
 protected:
 	explicit MavlinkStreamCameraImageCaptured(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_capture_sub(_mavlink->add_orb_subscription(ORB_ID(camera_capture))),
+		_capture_sub(_mavlink->add_orb_subscription(ORB_ID(camera_capture), 0, true)),
 		_capture_time(0)
 	{}
 
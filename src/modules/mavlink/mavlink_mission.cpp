@@ -1409,6 +1409,16 @@ MavlinkMissionManager::parse_mavlink_mission_item(const mavlink_mission_item_t *
 			mission_item->nav_cmd = (NAV_CMD)mavlink_mission_item->command;
 			break;
 
+		case MAV_CMD_WAYPOINT_USER_1:
+			// survey polygon vertex, the lanes are generated on board by the navigator
+			mission_item->nav_cmd = NAV_CMD_SURVEY;
+			mission_item->vertex_count = (uint16_t)(mavlink_mission_item->param1 + 0.5f);
+			mission_item->survey_spacing = mavlink_mission_item->param2;
+			mission_item->survey_direction = wrap_2pi(math::radians(mavlink_mission_item->param3));
+			mission_item->acceptance_radius = mavlink_mission_item->param4;
+			mission_item->yaw = NAN;
+			break;
+
 		default:
 			mission_item->nav_cmd = NAV_CMD_INVALID;
 
@@ -1643,6 +1653,12 @@ MavlinkMissionManager::format_mavlink_mission_item(const struct mission_item_s *
 		case MAV_CMD_NAV_RALLY_POINT:
 			break;
 
+		case NAV_CMD_SURVEY:
+			mavlink_mission_item->param1 = (float)mission_item->vertex_count;
+			mavlink_mission_item->param2 = mission_item->survey_spacing;
+			mavlink_mission_item->param3 = math::degrees(mission_item->survey_direction);
+			mavlink_mission_item->param4 = mission_item->acceptance_radius;
+			break;
 
 		default:
 			return PX4_ERROR;
@@ -78,6 +78,7 @@
 #include <stdlib.h>
 #include <poll.h>
 
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #ifdef __PX4_DARWIN
 #include <sys/param.h>
@@ -112,6 +113,19 @@
 
 using matrix::wrap_2pi;
 
+/**
+ * Check if the serial driver has more received bytes buffered.
+ */
+static bool serial_bytes_available(int fd)
+{
+#if defined(FIONREAD)
+	int available = 0;
+	return ::ioctl(fd, FIONREAD, (unsigned long)&available) == 0 && available > 0;
+#else
+	return false;
+#endif
+}
+
 MavlinkReceiver::MavlinkReceiver(Mavlink *parent) :
 	_mavlink(parent),
 	_mission_manager(parent),
@@ -119,7 +133,6 @@ MavlinkReceiver::MavlinkReceiver(Mavlink *parent) :
 	_mavlink_ftp(parent),
 	_mavlink_log_handler(parent),
 	_mavlink_timesync(parent),
-	_status{},
 	_hil_local_pos{},
 	_hil_land_detector{},
 	_control_mode{},
@@ -212,186 +225,102 @@ void MavlinkReceiver::acknowledge(uint8_t sysid, uint8_t compid, uint16_t comman
 	}
 }
 
-void
-MavlinkReceiver::handle_message(mavlink_message_t *msg)
+constexpr MavlinkReceiver::MessageHandler MavlinkReceiver::_message_handlers[] = {
+	{MAVLINK_MSG_ID_HEARTBEAT,				&MavlinkReceiver::handle_message_heartbeat,			0},
+	{MAVLINK_MSG_ID_PING,					&MavlinkReceiver::handle_message_ping,				0},
+	{MAVLINK_MSG_ID_SET_MODE,				&MavlinkReceiver::handle_message_set_mode,			0},
+	{MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,			&MavlinkReceiver::handle_message_gps_global_origin,		0},
+	{MAVLINK_MSG_ID_MANUAL_CONTROL,				&MavlinkReceiver::handle_message_manual_control,		0},
+	{MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE,			&MavlinkReceiver::handle_message_rc_channels_override,		0},
+	{MAVLINK_MSG_ID_COMMAND_INT,				&MavlinkReceiver::handle_message_command_int,			0},
+	{MAVLINK_MSG_ID_COMMAND_LONG,				&MavlinkReceiver::handle_message_command_long,			0},
+	{MAVLINK_MSG_ID_COMMAND_ACK,				&MavlinkReceiver::handle_message_command_ack,			0},
+	{MAVLINK_MSG_ID_SET_ATTITUDE_TARGET,			&MavlinkReceiver::handle_message_set_attitude_target,		0},
+	{MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED,		&MavlinkReceiver::handle_message_set_position_target_local_ned,	0},
+	{MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE,		&MavlinkReceiver::handle_message_vision_position_estimate,	0},
+	{MAVLINK_MSG_ID_OPTICAL_FLOW_RAD,			&MavlinkReceiver::handle_message_optical_flow_rad,		0},
+	{MAVLINK_MSG_ID_HIL_SENSOR,				&MavlinkReceiver::handle_message_hil_sensor,			HANDLER_FLAG_HIL},
+	{MAVLINK_MSG_ID_RADIO_STATUS,				&MavlinkReceiver::handle_message_radio_status,			0},
+	{MAVLINK_MSG_ID_HIL_GPS,				&MavlinkReceiver::handle_message_hil_gps,			HANDLER_FLAG_HIL_GPS},
+	{MAVLINK_MSG_ID_HIL_OPTICAL_FLOW,			&MavlinkReceiver::handle_message_hil_optical_flow,		HANDLER_FLAG_HIL},
+	{MAVLINK_MSG_ID_HIL_STATE_QUATERNION,			&MavlinkReceiver::handle_message_hil_state_quaternion,		HANDLER_FLAG_HIL},
+	{MAVLINK_MSG_ID_SERIAL_CONTROL,				&MavlinkReceiver::handle_message_serial_control,		0},
+	{MAVLINK_MSG_ID_DISTANCE_SENSOR,			&MavlinkReceiver::handle_message_distance_sensor,		0},
+	{MAVLINK_MSG_ID_ATT_POS_MOCAP,				&MavlinkReceiver::handle_message_att_pos_mocap,			0},
+	{MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET,		&MavlinkReceiver::handle_message_set_actuator_control_target,	0},
+	{MAVLINK_MSG_ID_FOLLOW_TARGET,				&MavlinkReceiver::handle_message_follow_target,			0},
+	{MAVLINK_MSG_ID_BATTERY_STATUS,				&MavlinkReceiver::handle_message_battery_status,		0},
+	{MAVLINK_MSG_ID_LANDING_TARGET,				&MavlinkReceiver::handle_message_landing_target,		0},
+	{MAVLINK_MSG_ID_GPS_RTCM_DATA,				&MavlinkReceiver::handle_message_gps_rtcm_data,			0},
+	{MAVLINK_MSG_ID_ADSB_VEHICLE,				&MavlinkReceiver::handle_message_adsb_vehicle,			0},
+	{MAVLINK_MSG_ID_COLLISION,				&MavlinkReceiver::handle_message_collision,			0},
+	{MAVLINK_MSG_ID_DEBUG_VECT,				&MavlinkReceiver::handle_message_debug_vect,			0},
+	{MAVLINK_MSG_ID_NAMED_VALUE_FLOAT,			&MavlinkReceiver::handle_message_named_value_float,		0},
+	{MAVLINK_MSG_ID_DEBUG,					&MavlinkReceiver::handle_message_debug,				0},
+	{MAVLINK_MSG_ID_PLAY_TUNE,				&MavlinkReceiver::handle_message_play_tune,			0},
+	{MAVLINK_MSG_ID_LOGGING_ACK,				&MavlinkReceiver::handle_message_logging_ack,			0},
+	{MAVLINK_MSG_ID_OBSTACLE_DISTANCE,			&MavlinkReceiver::handle_message_obstacle_distance,		0},
+	{MAVLINK_MSG_ID_ODOMETRY,				&MavlinkReceiver::handle_message_odometry,			0},
+	{MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_WAYPOINTS,	&MavlinkReceiver::handle_message_trajectory_representation_waypoints, 0},
+	{MAVLINK_MSG_ID_DEBUG_FLOAT_ARRAY,			&MavlinkReceiver::handle_message_debug_float_array,		0},
+};
+
+const MavlinkReceiver::MessageHandler *
+MavlinkReceiver::find_message_handler(uint32_t msgid)
 {
-	switch (msg->msgid) {
-	case MAVLINK_MSG_ID_COMMAND_LONG:
-		handle_message_command_long(msg);
-		break;
-
-	case MAVLINK_MSG_ID_COMMAND_INT:
-		handle_message_command_int(msg);
-		break;
-
-	case MAVLINK_MSG_ID_COMMAND_ACK:
-		handle_message_command_ack(msg);
-		break;
-
-	case MAVLINK_MSG_ID_OPTICAL_FLOW_RAD:
-		handle_message_optical_flow_rad(msg);
-		break;
-
-	case MAVLINK_MSG_ID_PING:
-		handle_message_ping(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_MODE:
-		handle_message_set_mode(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ATT_POS_MOCAP:
-		handle_message_att_pos_mocap(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
-		handle_message_set_position_target_local_ned(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
-		handle_message_set_attitude_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET:
-		handle_message_set_actuator_control_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE:
-		handle_message_vision_position_estimate(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ODOMETRY:
-		handle_message_odometry(msg);
-		break;
-
-	case MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN:
-		handle_message_gps_global_origin(msg);
-		break;
-
-	case MAVLINK_MSG_ID_RADIO_STATUS:
-		handle_message_radio_status(msg);
-		break;
+	static constexpr size_t count = sizeof(_message_handlers) / sizeof(_message_handlers[0]);
+	static_assert(message_handlers_sorted(_message_handlers, count), "message handler table must be sorted by msgid");
 
-	case MAVLINK_MSG_ID_MANUAL_CONTROL:
-		handle_message_manual_control(msg);
-		break;
-
-	case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
-		handle_message_rc_channels_override(msg);
-		break;
-
-	case MAVLINK_MSG_ID_HEARTBEAT:
-		handle_message_heartbeat(msg);
-		break;
-
-	case MAVLINK_MSG_ID_DISTANCE_SENSOR:
-		handle_message_distance_sensor(msg);
-		break;
-
-	case MAVLINK_MSG_ID_FOLLOW_TARGET:
-		handle_message_follow_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_LANDING_TARGET:
-		handle_message_landing_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ADSB_VEHICLE:
-		handle_message_adsb_vehicle(msg);
-		break;
-
-	case MAVLINK_MSG_ID_COLLISION:
-		handle_message_collision(msg);
-		break;
-
-	case MAVLINK_MSG_ID_GPS_RTCM_DATA:
-		handle_message_gps_rtcm_data(msg);
-		break;
-
-	case MAVLINK_MSG_ID_BATTERY_STATUS:
-		handle_message_battery_status(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SERIAL_CONTROL:
-		handle_message_serial_control(msg);
-		break;
-
-	case MAVLINK_MSG_ID_LOGGING_ACK:
-		handle_message_logging_ack(msg);
-		break;
-
-	case MAVLINK_MSG_ID_PLAY_TUNE:
-		handle_message_play_tune(msg);
-		break;
-
-	case MAVLINK_MSG_ID_OBSTACLE_DISTANCE:
-		handle_message_obstacle_distance(msg);
-		break;
+	/* binary search over the sorted table */
+	size_t low = 0;
+	size_t high = count;
 
-	case MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_WAYPOINTS:
-		handle_message_trajectory_representation_waypoints(msg);
-		break;
+	while (low < high) {
+		const size_t mid = (low + high) / 2;
 
-	case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
-		handle_message_named_value_float(msg);
-		break;
+		if (_message_handlers[mid].msgid < msgid) {
+			low = mid + 1;
 
-	case MAVLINK_MSG_ID_DEBUG:
-		handle_message_debug(msg);
-		break;
-
-	case MAVLINK_MSG_ID_DEBUG_VECT:
-		handle_message_debug_vect(msg);
-		break;
-
-	case MAVLINK_MSG_ID_DEBUG_FLOAT_ARRAY:
-		handle_message_debug_float_array(msg);
-		break;
-
-	default:
-		break;
+		} else {
+			high = mid;
+		}
 	}
 
-	/*
-	 * Only decode hil messages in HIL mode.
-	 *
-	 * The HIL mode is enabled by the HIL bit flag
-	 * in the system mode. Either send a set mode
-	 * COMMAND_LONG message or a SET_MODE message
-	 *
-	 * Accept HIL GPS messages if use_hil_gps flag is true.
-	 * This allows to provide fake gps measurements to the system.
-	 */
-	if (_mavlink->get_hil_enabled()) {
-		switch (msg->msgid) {
-		case MAVLINK_MSG_ID_HIL_SENSOR:
-			handle_message_hil_sensor(msg);
-			break;
-
-		case MAVLINK_MSG_ID_HIL_STATE_QUATERNION:
-			handle_message_hil_state_quaternion(msg);
-			break;
+	if (low < count && _message_handlers[low].msgid == msgid) {
+		return &_message_handlers[low];
+	}
 
-		case MAVLINK_MSG_ID_HIL_OPTICAL_FLOW:
-			handle_message_hil_optical_flow(msg);
-			break;
+	return nullptr;
+}
 
-		default:
-			break;
-		}
-	}
+void
+MavlinkReceiver::handle_message(mavlink_message_t *msg)
+{
+	const MessageHandler *entry = find_message_handler(msg->msgid);
 
+	if (entry != nullptr) {
+		/*
+		 * Only decode hil messages in HIL mode.
+		 *
+		 * The HIL mode is enabled by the HIL bit flag
+		 * in the system mode. Either send a set mode
+		 * COMMAND_LONG message or a SET_MODE message
+		 *
+		 * Accept HIL GPS messages if use_hil_gps flag is true.
+		 * This allows to provide fake gps measurements to the system.
+		 */
+		bool accept = true;
 
-	if (_mavlink->get_hil_enabled() || (_mavlink->get_use_hil_gps() && msg->sysid == mavlink_system.sysid)) {
-		switch (msg->msgid) {
-		case MAVLINK_MSG_ID_HIL_GPS:
-			handle_message_hil_gps(msg);
-			break;
+		if (entry->flags & HANDLER_FLAG_HIL) {
+			accept = _mavlink->get_hil_enabled();
 
-		default:
-			break;
+		} else if (entry->flags & HANDLER_FLAG_HIL_GPS) {
+			accept = _mavlink->get_hil_enabled() || (_mavlink->get_use_hil_gps() && msg->sysid == mavlink_system.sysid);
 		}
 
+		if (accept) {
+			(this->*entry->handler)(msg);
+		}
 	}
 
 	/* If we've received a valid message, mark the flag indicating so.
@@ -2369,6 +2298,7 @@ MavlinkReceiver::handle_message_hil_state_quaternion(mavlink_message_t *msg)
 	{
 		hil_attitude = {};
 		hil_attitude.timestamp = timestamp;
+		hil_attitude.timestamp_sample = timestamp;
 
 		matrix::Quatf q(hil_state.attitude_quaternion);
 		q.copyTo(hil_attitude.q);
@@ -2595,6 +2525,50 @@ void MavlinkReceiver::handle_message_debug_float_array(mavlink_message_t *msg)
 	}
 }
 
+void
+MavlinkReceiver::parse_buffer(const uint8_t *buf, size_t len)
+{
+	mavlink_message_t msg;
+
+	while (len > 0) {
+		const size_t pushed = _frame_parser.push(buf, len);
+		buf += pushed;
+		len -= pushed;
+
+		while (_frame_parser.parse(&msg, _mavlink->get_status())) {
+
+			/* check if we received version 2 and request a switch. */
+			if (!(_mavlink->get_status()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
+				/* this will only switch to proto version 2 if allowed in settings */
+				_mavlink->set_proto_version(2);
+			}
+
+			/* handle generic messages and commands */
+			handle_message(&msg);
+
+			/* handle packet with mission manager */
+			_mission_manager.handle_message(&msg);
+
+			/* handle packet with parameter component */
+			_parameters_manager.handle_message(&msg);
+
+			if (_mavlink->ftp_enabled()) {
+				/* handle packet with ftp component */
+				_mavlink_ftp.handle_message(&msg);
+			}
+
+			/* handle packet with log component */
+			_mavlink_log_handler.handle_message(&msg);
+
+			/* handle packet with timesync component */
+			_mavlink_timesync.handle_message(&msg);
+
+			/* handle packet with parent object */
+			_mavlink->handle_message(&msg);
+		}
+	}
+}
+
 /**
  * Receive data from UART/UDP
  */
@@ -2612,6 +2586,9 @@ MavlinkReceiver::receive_thread(void *arg)
 	// poll timeout in ms. Also defines the max update frequency of the mission & param manager, etc.
 	const int timeout = 10;
 
+	// upper bound of consecutive serial reads before the mission & param manager, etc. are serviced
+	const int max_burst_reads = 16;
+
 #if defined(__PX4_POSIX)
 	/* 1500 is the Wifi MTU, so we make sure to fit a full packet */
 	uint8_t buf[1600 * 5];
@@ -2622,7 +2599,6 @@ MavlinkReceiver::receive_thread(void *arg)
 	/* the serial port buffers internally as well, we just need to fit a small chunk */
 	uint8_t buf[64];
 #endif
-	mavlink_message_t msg;
 
 	struct pollfd fds[1] = {};
 
@@ -2651,17 +2627,42 @@ MavlinkReceiver::receive_thread(void *arg)
 
 	while (!_mavlink->_task_should_exit) {
 		if (poll(&fds[0], 1, timeout) > 0) {
+			nread = 0;
+
 			if (_mavlink->get_protocol() == SERIAL) {
 
+				/*
+				 * Burst read: drain everything the driver has buffered, parsing
+				 * chunk by chunk, instead of returning to poll() after every read.
+				 */
+				ssize_t ret = 0;
+				int reads = 0;
+
+				do {
+					/* non-blocking read. read may return negative values */
+					ret = ::read(fds[0].fd, buf, sizeof(buf));
+
+					if (ret > 0) {
+						nread += ret;
+
+						if (_mavlink->get_client_source_initialized()) {
+							parse_buffer(buf, ret);
+						}
+					}
+
+				} while (ret == (ssize_t)sizeof(buf) && ++reads < max_burst_reads && serial_bytes_available(fds[0].fd));
+
 				/*
 				 * to avoid reading very small chunks wait for data before reading
-				 * this is designed to target one message, so >20 bytes at a time
+				 * this is designed to target one message, so >20 bytes at a time.
+				 * If a frame is partially received only wait for its remainder.
 				 */
 				const unsigned character_count = 20;
 
-				/* non-blocking read. read may return negative values */
-				if ((nread = ::read(fds[0].fd, buf, sizeof(buf))) < (ssize_t)character_count) {
-					const unsigned sleeptime = character_count * 1000000 / (_mavlink->get_baudrate() / 10);
+				if (nread < (ssize_t)character_count) {
+					const unsigned missing = _frame_parser.bytes_missing();
+					const unsigned wait_count = (missing > 0 && missing < character_count) ? missing : character_count;
+					const unsigned sleeptime = wait_count * 1000000 / (_mavlink->get_baudrate() / 10);
 					px4_usleep(sleeptime);
 				}
 			}
@@ -2671,6 +2672,22 @@ MavlinkReceiver::receive_thread(void *arg)
 			if (_mavlink->get_protocol() == UDP) {
 				if (fds[0].revents & POLLIN) {
 					nread = recvfrom(_mavlink->get_socket_fd(), buf, sizeof(buf), 0, (struct sockaddr *)&srcaddr, &addrlen);
+
+#if defined(MSG_DONTWAIT)
+
+					/* burst read: collect all queued datagrams while one of Wifi MTU size still fits */
+					while (nread > 0 && sizeof(buf) - (size_t)nread >= 1500) {
+						const ssize_t ret = recvfrom(_mavlink->get_socket_fd(), buf + nread, sizeof(buf) - nread, MSG_DONTWAIT,
+									     (struct sockaddr *)&srcaddr, &addrlen);
+
+						if (ret <= 0) {
+							break;
+						}
+
+						nread += ret;
+					}
+
+#endif
 				}
 
 			} else {
@@ -2701,40 +2718,9 @@ MavlinkReceiver::receive_thread(void *arg)
 			// only start accepting messages once we're sure who we talk to
 
 			if (_mavlink->get_client_source_initialized()) {
-				/* if read failed, this loop won't execute */
-				for (ssize_t i = 0; i < nread; i++) {
-					if (mavlink_parse_char(_mavlink->get_channel(), buf[i], &msg, &_status)) {
-
-						/* check if we received version 2 and request a switch. */
-						if (!(_mavlink->get_status()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
-							/* this will only switch to proto version 2 if allowed in settings */
-							_mavlink->set_proto_version(2);
-						}
-
-						/* handle generic messages and commands */
-						handle_message(&msg);
-
-						/* handle packet with mission manager */
-						_mission_manager.handle_message(&msg);
-
-
-						/* handle packet with parameter component */
-						_parameters_manager.handle_message(&msg);
-
-						if (_mavlink->ftp_enabled()) {
-							/* handle packet with ftp component */
-							_mavlink_ftp.handle_message(&msg);
-						}
-
-						/* handle packet with log component */
-						_mavlink_log_handler.handle_message(&msg);
-
-						/* handle packet with timesync component */
-						_mavlink_timesync.handle_message(&msg);
-
-						/* handle packet with parent object */
-						_mavlink->handle_message(&msg);
-					}
+				/* serial data has already been parsed chunk by chunk during the burst read */
+				if (_mavlink->get_protocol() != SERIAL && nread > 0) {
+					parse_buffer(buf, nread);
 				}
 
 				/* count received bytes (nread will be -1 on read error) */
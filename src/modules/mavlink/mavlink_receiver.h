@@ -83,6 +83,7 @@
 #include <uORB/topics/vehicle_rates_setpoint.h>
 #include <uORB/topics/vehicle_status.h>
 
+#include "mavlink_frame_parser.h"
 #include "mavlink_ftp.h"
 #include "mavlink_log_handler.h"
 #include "mavlink_mission.h"
@@ -118,7 +119,36 @@ public:
 
 private:
 
+	/**
+	 * Entry of the message handler table, sorted by msgid.
+	 */
+	struct MessageHandler {
+		uint32_t msgid;
+		void (MavlinkReceiver::*handler)(mavlink_message_t *msg);
+		uint8_t flags;	///< HANDLER_FLAG_* gating the message
+	};
+
+	enum MessageHandlerFlags : uint8_t {
+		HANDLER_FLAG_HIL	= (1 << 0),	///< only handled in HIL mode
+		HANDLER_FLAG_HIL_GPS	= (1 << 1),	///< handled in HIL mode or if HIL GPS is used
+	};
+
+	static const MessageHandler _message_handlers[];
+
+	static constexpr bool message_handlers_sorted(const MessageHandler *handlers, size_t count)
+	{
+		return count < 2 || (handlers[0].msgid < handlers[1].msgid && message_handlers_sorted(handlers + 1, count - 1));
+	}
+
+	static const MessageHandler *find_message_handler(uint32_t msgid);
+
 	void acknowledge(uint8_t sysid, uint8_t compid, uint16_t command, uint8_t result);
+
+	/**
+	 * Parse a received buffer and pass all complete messages on to the handlers
+	 */
+	void parse_buffer(const uint8_t *buf, size_t len);
+
 	void handle_message(mavlink_message_t *msg);
 	void handle_message_command_long(mavlink_message_t *msg);
 	void handle_message_command_int(mavlink_message_t *msg);
@@ -203,7 +233,7 @@ private:
 	MavlinkLogHandler		_mavlink_log_handler;
 	MavlinkTimesync		_mavlink_timesync;
 
-	mavlink_status_t _status; ///< receiver status, used for mavlink_parse_char()
+	MavlinkFrameParser _frame_parser;
 	struct vehicle_attitude_s _att;
 	struct vehicle_local_position_s _hil_local_pos;
 	struct vehicle_land_detected_s _hil_land_detector;
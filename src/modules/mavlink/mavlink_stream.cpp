@@ -49,6 +49,7 @@ MavlinkStream::MavlinkStream(Mavlink *mavlink) :
 	_mavlink(mavlink)
 {
 	_last_sent = hrt_absolute_time();
+	_stats_sample_time = _last_sent;
 }
 
 /**
@@ -122,3 +123,45 @@ MavlinkStream::update(const hrt_abstime &t)
 
 	return -1;
 }
+
+hrt_abstime
+MavlinkStream::get_next_due()
+{
+	if (_last_sent == 0 || collects_data()) {
+		return 0;
+	}
+
+	int interval = (_interval > 0) ? _interval : 0;
+
+	if (!const_rate()) {
+		interval /= _mavlink->get_rate_mult();
+	}
+
+	if (interval == 0) {
+		return 0;
+	}
+
+	// same condition as in update(), including the 30% main loop delay slack
+	const int64_t wait = interval - (_mavlink->get_main_loop_delay() / 10) * 3 + 1;
+
+	return (wait > 0) ? _last_sent + wait : _last_sent;
+}
+
+void
+MavlinkStream::sample_stats(float &rate, float &cost)
+{
+	const hrt_abstime now = hrt_absolute_time();
+	const float dt = (now - _stats_sample_time) * 1e-6f;
+
+	const uint32_t updates = _stats_updates - _stats_updates_last;
+	const uint32_t sent = _stats_sent - _stats_sent_last;
+	const uint64_t elapsed = _stats_elapsed - _stats_elapsed_last;
+
+	rate = (dt > 0.f) ? sent / dt : 0.f;
+	cost = (updates > 0) ? (float)elapsed / updates : 0.f;
+
+	_stats_updates_last += updates;
+	_stats_sent_last += sent;
+	_stats_elapsed_last += elapsed;
+	_stats_sample_time = now;
+}
@@ -45,6 +45,7 @@
 #include <px4_module_params.h>
 
 class Mavlink;
+class MavlinkOrbSubscription;
 
 class MavlinkStream : public ModuleParams
 {
@@ -113,6 +114,47 @@ public:
 	 */
 	void reset_last_sent() { _last_sent = 0; }
 
+	/**
+	 * Get the earliest time at which update() will try to send the next message.
+	 *
+	 * @return absolute time, 0 if the stream needs to be updated at every iteration
+	 */
+	hrt_abstime get_next_due();
+
+	/**
+	 * @return true if update_data() has to be called at every iteration
+	 */
+	virtual bool collects_data() { return false; }
+
+	/**
+	 * Get the subscription of the topic this stream sends on change.
+	 *
+	 * Streams that only send when a single topic is updated can return the subscription
+	 * so that the scheduler waits for the topic instead of checking the stream at every iteration.
+	 */
+	virtual MavlinkOrbSubscription *get_wakeup_subscription() { return nullptr; }
+
+	/**
+	 * Account an update of the stream.
+	 *
+	 * @param sent true if a message was sent
+	 * @param elapsed time spent in update() in microseconds
+	 */
+	void count_update(bool sent, hrt_abstime elapsed)
+	{
+		_stats_updates++;
+		_stats_sent += sent ? 1 : 0;
+		_stats_elapsed += elapsed;
+	}
+
+	/**
+	 * Get the achieved message rate and the average update cost since the previous call.
+	 *
+	 * @param rate messages sent per second
+	 * @param cost average time per update() in microseconds
+	 */
+	void sample_stats(float &rate, float &cost);
+
 protected:
 	Mavlink      *const _mavlink;
 	int _interval{1000000};		///< if set to negative value = unlimited rate
@@ -130,6 +172,15 @@ protected:
 private:
 	hrt_abstime _last_sent{0};
 	bool _first_message_sent{false};
+
+	uint32_t _stats_updates{0};
+	uint32_t _stats_sent{0};
+	uint64_t _stats_elapsed{0};
+
+	uint32_t _stats_updates_last{0};
+	uint32_t _stats_sent_last{0};
+	uint64_t _stats_elapsed_last{0};
+	hrt_abstime _stats_sample_time{0};
 };
 
 
@@ -0,0 +1,313 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_stream_scheduler.cpp
+ * Deadline based scheduling of the MAVLink streams of an instance.
+ */
+
+#include "mavlink_stream_scheduler.h"
+#include "mavlink_main.h"
+
+#include <mathlib/mathlib.h>
+
+MavlinkStreamScheduler::~MavlinkStreamScheduler()
+{
+	delete[] _heap;
+}
+
+bool
+MavlinkStreamScheduler::rebuild()
+{
+	unsigned num_streams = 0;
+	MavlinkStream *stream;
+	LL_FOREACH(_mavlink->get_streams(), stream) {
+		num_streams++;
+	}
+
+	if (num_streams > _heap_capacity) {
+		Entry *heap = new Entry[num_streams];
+
+		if (heap == nullptr) {
+			return false;
+		}
+
+		delete[] _heap;
+		_heap = heap;
+		_heap_capacity = num_streams;
+	}
+
+	_heap_size = 0;
+	_num_parked = 0;
+
+	LL_FOREACH(_mavlink->get_streams(), stream) {
+		_heap[_heap_size++] = Entry{stream->get_next_due(), stream, false, false, false};
+	}
+
+	for (unsigned i = _heap_size / 2; i > 0; i--) {
+		sift_down(i - 1);
+	}
+
+	_rate_mult = _mavlink->get_rate_mult();
+	_rebuild = false;
+
+	return true;
+}
+
+void
+MavlinkStreamScheduler::refill_tokens(const hrt_abstime &t)
+{
+	const float data_rate = _mavlink->get_data_rate();
+	const float depth = math::max(data_rate * TOKEN_BUCKET_DEPTH * 1e-6f, 2.0f * MAVLINK_MAX_PACKET_LEN);
+
+	if (_tokens_time == 0) {
+		_tokens = depth;
+
+	} else {
+		_tokens = math::min(_tokens + data_rate * (t - _tokens_time) * 1e-6f, depth);
+	}
+
+	_tokens_time = t;
+}
+
+void
+MavlinkStreamScheduler::update(const hrt_abstime &t)
+{
+	// deadlines computed with a lower rate multiplier are too late once it increases,
+	// while too early deadlines are corrected by the stream itself
+	if (_rebuild || _mavlink->get_rate_mult() > _rate_mult * 1.01f) {
+		if (!rebuild()) {
+			// out of memory, fall back to checking every stream
+			MavlinkStream *stream;
+			LL_FOREACH(_mavlink->get_streams(), stream) {
+				stream->update(t);
+			}
+
+			return;
+		}
+
+	} else {
+		_rate_mult = math::min(_rate_mult, _mavlink->get_rate_mult());
+	}
+
+	refill_tokens(t);
+
+	while (_heap_size > 0 && _heap[0].due <= t) {
+		Entry entry = pop();
+		MavlinkStream *stream = entry.stream;
+
+		if (entry.parked) {
+			unpark(stream);
+			entry.parked = false;
+		}
+
+		const unsigned size = stream->get_size_avg();
+
+		if (!stream->const_rate() && size > 0 && _tokens < size) {
+			// link saturated, retry once the bucket holds enough bytes for the message
+			const float data_rate = math::max(_mavlink->get_data_rate(), 1);
+			entry.due = t + 1 + (hrt_abstime)((size - _tokens) / data_rate * 1e6f);
+			push(entry);
+			continue;
+		}
+
+		const unsigned bytes_tx = _mavlink->get_bytes_tx();
+		const hrt_abstime start = hrt_absolute_time();
+
+		const bool sent = (stream->update(t) == 0);
+
+		stream->count_update(sent, hrt_elapsed_time(&start));
+		_tokens -= _mavlink->get_bytes_tx() - bytes_tx;
+
+		if (sent) {
+			entry.no_wakeup = false;
+
+		} else if (entry.woken) {
+			// the topic update did not produce a message, don't rely on wakeups for this stream
+			entry.no_wakeup = true;
+		}
+
+		entry.woken = false;
+		entry.due = stream->get_next_due();
+
+		if (entry.due <= t) {
+			// due but nothing to send: wait for the topic if possible, otherwise check again next iteration
+			if (!entry.no_wakeup && park(stream)) {
+				entry.parked = true;
+				entry.due = t + PARKED_TIMEOUT;
+
+			} else {
+				entry.due = t + 1;
+			}
+		}
+
+		push(entry);
+	}
+}
+
+void
+MavlinkStreamScheduler::wait(unsigned timeout)
+{
+	if (_num_parked == 0) {
+		px4_usleep(timeout);
+		return;
+	}
+
+	for (unsigned i = 0; i < _num_parked; i++) {
+		_fds[i].revents = 0;
+	}
+
+	const int ret = px4_poll(_fds, _num_parked, (timeout + 999) / 1000);
+
+	if (ret > 0) {
+		const hrt_abstime now = hrt_absolute_time();
+		unsigned i = 0;
+
+		while (i < _num_parked) {
+			if (_fds[i].revents & POLLIN) {
+				// removes the stream from the parked list
+				wake(_parked[i], now);
+
+			} else {
+				i++;
+			}
+		}
+	}
+}
+
+bool
+MavlinkStreamScheduler::park(MavlinkStream *stream)
+{
+	MavlinkOrbSubscription *sub = stream->get_wakeup_subscription();
+
+	if (sub == nullptr || sub->get_fd() < 0 || _num_parked >= MAX_PARKED) {
+		return false;
+	}
+
+	_parked[_num_parked] = stream;
+	_fds[_num_parked].fd = sub->get_fd();
+	_fds[_num_parked].events = POLLIN;
+	_num_parked++;
+
+	return true;
+}
+
+void
+MavlinkStreamScheduler::unpark(MavlinkStream *stream)
+{
+	for (unsigned i = 0; i < _num_parked; i++) {
+		if (_parked[i] == stream) {
+			_num_parked--;
+			_parked[i] = _parked[_num_parked];
+			_fds[i] = _fds[_num_parked];
+			return;
+		}
+	}
+}
+
+void
+MavlinkStreamScheduler::wake(MavlinkStream *stream, const hrt_abstime &t)
+{
+	unpark(stream);
+
+	for (unsigned i = 0; i < _heap_size; i++) {
+		if (_heap[i].stream == stream) {
+			_heap[i].due = t;
+			_heap[i].parked = false;
+			_heap[i].woken = true;
+			sift_up(i);
+			return;
+		}
+	}
+}
+
+void
+MavlinkStreamScheduler::push(const Entry &entry)
+{
+	// the heap holds every stream at most once, so there is always room for a popped entry
+	_heap[_heap_size] = entry;
+	sift_up(_heap_size++);
+}
+
+MavlinkStreamScheduler::Entry
+MavlinkStreamScheduler::pop()
+{
+	Entry top = _heap[0];
+	_heap[0] = _heap[--_heap_size];
+	sift_down(0);
+	return top;
+}
+
+void
+MavlinkStreamScheduler::sift_up(unsigned index)
+{
+	while (index > 0) {
+		const unsigned parent = (index - 1) / 2;
+
+		if (_heap[parent].due <= _heap[index].due) {
+			break;
+		}
+
+		const Entry tmp = _heap[parent];
+		_heap[parent] = _heap[index];
+		_heap[index] = tmp;
+		index = parent;
+	}
+}
+
+void
+MavlinkStreamScheduler::sift_down(unsigned index)
+{
+	for (;;) {
+		const unsigned left = 2 * index + 1;
+		const unsigned right = left + 1;
+		unsigned smallest = index;
+
+		if (left < _heap_size && _heap[left].due < _heap[smallest].due) {
+			smallest = left;
+		}
+
+		if (right < _heap_size && _heap[right].due < _heap[smallest].due) {
+			smallest = right;
+		}
+
+		if (smallest == index) {
+			break;
+		}
+
+		const Entry tmp = _heap[smallest];
+		_heap[smallest] = _heap[index];
+		_heap[index] = tmp;
+		index = smallest;
+	}
+}
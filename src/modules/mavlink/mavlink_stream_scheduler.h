@@ -0,0 +1,135 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_stream_scheduler.h
+ * Deadline based scheduling of the MAVLink streams of an instance.
+ */
+
+#pragma once
+
+#include <drivers/drv_hrt.h>
+#include <px4_posix.h>
+
+class Mavlink;
+class MavlinkStream;
+
+/**
+ * Keeps the streams of a MAVLink instance in a min-heap ordered by the time they are due next,
+ * so that an iteration of the main loop only updates the streams that can actually send.
+ *
+ * Streams that are due but have nothing to send and provide a wakeup subscription are parked
+ * and woken by an update of their topic. Rate adjusted streams are additionally paced by a
+ * token bucket filled at the configured data rate of the instance.
+ */
+class MavlinkStreamScheduler
+{
+public:
+	explicit MavlinkStreamScheduler(Mavlink *mavlink) : _mavlink(mavlink) {}
+	~MavlinkStreamScheduler();
+
+	// no copy, assignment, move, move assignment
+	MavlinkStreamScheduler(const MavlinkStreamScheduler &) = delete;
+	MavlinkStreamScheduler &operator=(const MavlinkStreamScheduler &) = delete;
+	MavlinkStreamScheduler(MavlinkStreamScheduler &&) = delete;
+	MavlinkStreamScheduler &operator=(MavlinkStreamScheduler &&) = delete;
+
+	/**
+	 * Rebuild the schedule from the stream list on the next update.
+	 * Has to be called whenever streams are added, removed or reconfigured.
+	 */
+	void invalidate() { _rebuild = true; }
+
+	/**
+	 * Update all streams that are due at time t.
+	 */
+	void update(const hrt_abstime &t);
+
+	/**
+	 * Sleep until the next iteration of the main loop. Returns earlier if the
+	 * topic of a parked stream was updated.
+	 *
+	 * @param timeout sleep time in microseconds
+	 */
+	void wait(unsigned timeout);
+
+	/**
+	 * @return number of streams currently waiting for a topic update
+	 */
+	unsigned num_parked() const { return _num_parked; }
+
+private:
+	struct Entry {
+		hrt_abstime due;
+		MavlinkStream *stream;
+		bool parked;		///< waiting for a topic update
+		bool woken;		///< due because of a topic update
+		bool no_wakeup;		///< a wakeup did not lead to a message, check at every iteration until the next one is sent
+	};
+
+	static constexpr unsigned MAX_PARKED = 8;
+
+	/* parked streams are still checked at this interval in case a wakeup got lost */
+	static constexpr hrt_abstime PARKED_TIMEOUT = 100000;
+
+	/* bucket size of the token bucket in time at the configured data rate */
+	static constexpr hrt_abstime TOKEN_BUCKET_DEPTH = 50000;
+
+	bool rebuild();
+	void refill_tokens(const hrt_abstime &t);
+
+	bool park(MavlinkStream *stream);
+	void unpark(MavlinkStream *stream);
+	void wake(MavlinkStream *stream, const hrt_abstime &t);
+
+	void push(const Entry &entry);
+	Entry pop();
+	void sift_up(unsigned index);
+	void sift_down(unsigned index);
+
+	Mavlink *const _mavlink;
+
+	Entry *_heap{nullptr};
+	unsigned _heap_size{0};
+	unsigned _heap_capacity{0};
+
+	bool _rebuild{true};
+	float _rate_mult{0.0f};		///< lowest rate multiplier used for the deadlines in the heap
+
+	MavlinkStream *_parked[MAX_PARKED] {};
+	px4_pollfd_struct_t _fds[MAX_PARKED] {};
+	unsigned _num_parked{0};
+
+	float _tokens{0.0f};		///< bytes rate adjusted streams may send right now
+	hrt_abstime _tokens_time{0};
+};
@@ -0,0 +1,366 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/// @file mavlink_frame_parser_test.cpp
+///	Tests and receive throughput benchmark for the frame level MAVLink parser
+
+#include <drivers/drv_hrt.h>
+#include <mathlib/mathlib.h>
+#include <px4_defines.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(CONFIG_NET) || defined(__PX4_POSIX)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+#include "mavlink_frame_parser_test.h"
+
+static constexpr uint8_t test_system_id = 1;
+static constexpr uint8_t test_component_id = 1;
+
+void MavlinkFrameParserTest::_init()
+{
+	_message_count = 0;
+	_stream_len = 0;
+	_tx_status = {};
+}
+
+void MavlinkFrameParserTest::_append_message(unsigned index, bool mavlink1)
+{
+	mavlink_message_t *msg = &_messages[_message_count++];
+
+	if (mavlink1) {
+		_tx_status.flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+
+	} else {
+		_tx_status.flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+	}
+
+	switch (index % 3) {
+	case 0: {
+			mavlink_heartbeat_t heartbeat{};
+			heartbeat.custom_mode = index;
+			heartbeat.type = MAV_TYPE_GCS;
+			heartbeat.autopilot = MAV_AUTOPILOT_INVALID;
+			heartbeat.mavlink_version = 3;
+
+			memcpy(_MAV_PAYLOAD_NON_CONST(msg), &heartbeat, MAVLINK_MSG_ID_HEARTBEAT_LEN);
+			msg->msgid = MAVLINK_MSG_ID_HEARTBEAT;
+			mavlink_finalize_message_buffer(msg, test_system_id, test_component_id, &_tx_status,
+							MAVLINK_MSG_ID_HEARTBEAT_MIN_LEN, MAVLINK_MSG_ID_HEARTBEAT_LEN, MAVLINK_MSG_ID_HEARTBEAT_CRC);
+		}
+		break;
+
+	case 1: {
+			mavlink_attitude_t attitude{};
+			attitude.time_boot_ms = index * 4;
+			attitude.roll = 0.1f * index;
+			attitude.pitch = -0.05f * index;
+			attitude.yaw = 1.f;
+
+			memcpy(_MAV_PAYLOAD_NON_CONST(msg), &attitude, MAVLINK_MSG_ID_ATTITUDE_LEN);
+			msg->msgid = MAVLINK_MSG_ID_ATTITUDE;
+			mavlink_finalize_message_buffer(msg, test_system_id, test_component_id, &_tx_status,
+							MAVLINK_MSG_ID_ATTITUDE_MIN_LEN, MAVLINK_MSG_ID_ATTITUDE_LEN, MAVLINK_MSG_ID_ATTITUDE_CRC);
+		}
+		break;
+
+	default: {
+			mavlink_file_transfer_protocol_t ftp{};
+			ftp.target_system = test_system_id;
+
+			for (unsigned i = 0; i < sizeof(ftp.payload); i++) {
+				/* includes both start markers, which must not confuse the parser */
+				ftp.payload[i] = (uint8_t)(i + index);
+			}
+
+			memcpy(_MAV_PAYLOAD_NON_CONST(msg), &ftp, MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN);
+			msg->msgid = MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL;
+			mavlink_finalize_message_buffer(msg, test_system_id, test_component_id, &_tx_status,
+							MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_MIN_LEN, MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN,
+							MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_CRC);
+		}
+		break;
+	}
+
+	_stream_len += mavlink_msg_to_send_buffer(&_stream[_stream_len], msg);
+}
+
+int MavlinkFrameParserTest::_parse_stream(MavlinkFrameParser &parser, size_t chunk_size, bool compare)
+{
+	mavlink_status_t status{};
+	mavlink_message_t msg;
+	unsigned decoded = 0;
+	size_t offset = 0;
+
+	while (offset < _stream_len) {
+		const size_t len = math::min(chunk_size, _stream_len - offset);
+		size_t pushed = 0;
+
+		while (pushed < len) {
+			pushed += parser.push(&_stream[offset + pushed], len - pushed);
+
+			while (parser.parse(&msg, &status)) {
+				if (compare) {
+					if (decoded >= _message_count) {
+						return -1;
+					}
+
+					const mavlink_message_t &expected = _messages[decoded];
+
+					if (msg.msgid != expected.msgid || msg.seq != expected.seq || msg.sysid != expected.sysid
+					    || msg.compid != expected.compid || msg.len != expected.len
+					    || memcmp(_MAV_PAYLOAD(&msg), _MAV_PAYLOAD(&expected), expected.len) != 0) {
+						PX4_ERR("message %u does not match", decoded);
+						return -1;
+					}
+
+					if (((status.flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) != 0) != (expected.magic == MAVLINK_STX_MAVLINK1)) {
+						PX4_ERR("message %u: wrong protocol version flag", decoded);
+						return -1;
+					}
+				}
+
+				decoded++;
+			}
+		}
+
+		offset += len;
+	}
+
+	return decoded;
+}
+
+/// @brief Frames split at arbitrary read boundaries and separated by noise are all decoded
+bool MavlinkFrameParserTest::_frame_split_test()
+{
+	for (unsigned i = 0; i < max_messages; i++) {
+		/* noise between frames, without start markers */
+		for (unsigned k = 0; k < i % 5; k++) {
+			uint8_t noise = (uint8_t)(i * 37 + k);
+
+			if (noise == MAVLINK_STX || noise == MAVLINK_STX_MAVLINK1) {
+				noise = 0x55;
+			}
+
+			_stream[_stream_len++] = noise;
+		}
+
+		_append_message(i, i % 4 == 3);
+	}
+
+	const size_t chunk_sizes[] = {1, 7, 64, 280, 1500, stream_size};
+
+	for (size_t chunk_size : chunk_sizes) {
+		MavlinkFrameParser parser;
+		ut_compare("messages lost", _parse_stream(parser, chunk_size, true), (int)_message_count);
+		ut_compare("unexpected crc errors", parser.crc_errors(), 0);
+		ut_compare("partial frame left over", parser.bytes_missing(), 0);
+	}
+
+	return true;
+}
+
+/// @brief A corrupted frame is dropped and the parser resynchronizes on the next one
+bool MavlinkFrameParserTest::_crc_error_test()
+{
+	size_t corrupt_offset = 0;
+
+	for (unsigned i = 0; i < max_messages; i++) {
+		if (i == max_messages / 2) {
+			corrupt_offset = _stream_len + MavlinkFrameParser::HEADER_LEN_V2;
+		}
+
+		_append_message(i, false);
+	}
+
+	_stream[corrupt_offset] ^= 0x01;
+
+	MavlinkFrameParser parser;
+	ut_compare("wrong number of messages", _parse_stream(parser, 64, false), (int)_message_count - 1);
+	ut_assert("crc error not counted", parser.crc_errors() > 0);
+
+	return true;
+}
+
+/// @brief Trimmed MAVLink 2 payloads are zero-filled to the full message length
+bool MavlinkFrameParserTest::_truncated_payload_test()
+{
+	/* attitude rates are zero and get trimmed from the payload */
+	_append_message(1, false);
+	ut_assert("payload not trimmed", _messages[0].len < MAVLINK_MSG_ID_ATTITUDE_LEN);
+
+	MavlinkFrameParser parser;
+	mavlink_status_t status{};
+	mavlink_message_t msg;
+	memset(&msg, 0xAA, sizeof(msg));
+
+	ut_compare("push failed", parser.push(_stream, _stream_len), _stream_len);
+	ut_assert("no message", parser.parse(&msg, &status));
+
+	const uint8_t *payload = (const uint8_t *)_MAV_PAYLOAD(&msg);
+
+	for (unsigned i = msg.len; i < MAVLINK_MSG_ID_ATTITUDE_LEN; i++) {
+		ut_compare("payload not zero-filled", payload[i], 0);
+	}
+
+	mavlink_attitude_t attitude;
+	mavlink_msg_attitude_decode(&msg, &attitude);
+	ut_compare("wrong yaw", (int)attitude.yaw, 1);
+	ut_compare("wrong yawspeed", (int)attitude.yawspeed, 0);
+
+	return true;
+}
+
+/// @brief Receive throughput over UDP loopback, frame parser vs. mavlink_parse_char() state machine
+bool MavlinkFrameParserTest::_udp_loopback_benchmark()
+{
+#if defined(CONFIG_NET) || defined(__PX4_POSIX)
+	/* a datagram with several frames, as a companion computer sends them */
+	for (unsigned i = 0; i < 8; i++) {
+		_append_message(i, false);
+	}
+
+	const int rx_fd = socket(AF_INET, SOCK_DGRAM, 0);
+	const int tx_fd = socket(AF_INET, SOCK_DGRAM, 0);
+	ut_assert("socket failed", rx_fd >= 0 && tx_fd >= 0);
+
+	struct sockaddr_in addr {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t addr_len = sizeof(addr);
+
+	bool ok = bind(rx_fd, (struct sockaddr *)&addr, sizeof(addr)) == 0
+		  && getsockname(rx_fd, (struct sockaddr *)&addr, &addr_len) == 0;
+
+	const int batches = 200;
+	const int datagrams_per_batch = 16;
+
+	uint8_t buf[1500];
+	MavlinkFrameParser parser;
+	mavlink_status_t status{};
+	mavlink_message_t msg;
+	mavlink_message_t char_rx_buffer{};
+	mavlink_status_t char_status{};
+	mavlink_status_t char_r_status{};
+
+	unsigned frame_messages = 0;
+	unsigned char_messages = 0;
+	unsigned datagrams = 0;
+	uint64_t bytes = 0;
+	hrt_abstime frame_time = 0;
+	hrt_abstime char_time = 0;
+
+	for (int batch = 0; ok && batch < batches; batch++) {
+		for (int i = 0; i < datagrams_per_batch; i++) {
+			if (sendto(tx_fd, _stream, _stream_len, 0, (struct sockaddr *)&addr, sizeof(addr)) != (ssize_t)_stream_len) {
+				ok = false;
+			}
+		}
+
+		for (int i = 0; ok && i < datagrams_per_batch; i++) {
+			struct pollfd fds {};
+			fds.fd = rx_fd;
+			fds.events = POLLIN;
+
+			if (poll(&fds, 1, 100) <= 0) {
+				/* loopback dropped the datagram */
+				break;
+			}
+
+			const ssize_t nread = recv(rx_fd, buf, sizeof(buf), 0);
+
+			if (nread <= 0) {
+				ok = false;
+				break;
+			}
+
+			datagrams++;
+			bytes += nread;
+
+			hrt_abstime t0 = hrt_absolute_time();
+			parser.push(buf, nread);
+
+			while (parser.parse(&msg, &status)) {
+				frame_messages++;
+			}
+
+			frame_time += hrt_elapsed_time(&t0);
+
+			t0 = hrt_absolute_time();
+
+			for (ssize_t k = 0; k < nread; k++) {
+				if (mavlink_frame_char_buffer(&char_rx_buffer, &char_status, buf[k], &msg, &char_r_status) == MAVLINK_FRAMING_OK) {
+					char_messages++;
+				}
+			}
+
+			char_time += hrt_elapsed_time(&t0);
+		}
+	}
+
+	close(rx_fd);
+	close(tx_fd);
+
+	ut_assert("loopback send/receive failed", ok);
+	ut_assert("no datagrams received", datagrams > 0);
+	ut_compare("frame parser lost messages", frame_messages, datagrams * _message_count);
+	ut_compare("parsers disagree", frame_messages, char_messages);
+
+	PX4_INFO("received %u datagrams, %u messages, %llu bytes", datagrams, frame_messages, (unsigned long long)bytes);
+	PX4_INFO("frame parser: %llu us, %.1f MB/s", (unsigned long long)frame_time,
+		 (double)bytes / math::max(frame_time, (hrt_abstime)1));
+	PX4_INFO("mavlink_parse_char: %llu us, %.1f MB/s", (unsigned long long)char_time,
+		 (double)bytes / math::max(char_time, (hrt_abstime)1));
+#endif
+
+	return true;
+}
+
+bool MavlinkFrameParserTest::run_tests()
+{
+	ut_run_test(_frame_split_test);
+	ut_run_test(_crc_error_test);
+	ut_run_test(_truncated_payload_test);
+	ut_run_test(_udp_loopback_benchmark);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test(mavlink_frame_parser_test, MavlinkFrameParserTest)
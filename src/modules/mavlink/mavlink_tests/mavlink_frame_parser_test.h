@@ -0,0 +1,77 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/// @file mavlink_frame_parser_test.h
+///	Tests and receive throughput benchmark for the frame level MAVLink parser
+
+#pragma once
+
+#include <unit_test.h>
+#include "../mavlink_bridge_header.h"
+#include "../mavlink_frame_parser.h"
+
+class MavlinkFrameParserTest : public UnitTest
+{
+public:
+	MavlinkFrameParserTest() = default;
+	virtual ~MavlinkFrameParserTest() = default;
+
+	virtual bool run_tests(void);
+
+private:
+	virtual void _init(void);
+
+	bool _frame_split_test(void);
+	bool _crc_error_test(void);
+	bool _truncated_payload_test(void);
+	bool _udp_loopback_benchmark(void);
+
+	/// Encodes a test message into _stream, MAVLink 1 or 2 depending on the index
+	void _append_message(unsigned index, bool mavlink1);
+
+	/// Pushes _stream to the parser in chunks of chunk_size and checks every decoded message
+	int _parse_stream(MavlinkFrameParser &parser, size_t chunk_size, bool compare);
+
+	static constexpr unsigned max_messages = 32;
+	static constexpr size_t stream_size = max_messages * (MAVLINK_MAX_PACKET_LEN + 8);
+
+	mavlink_message_t	_messages[max_messages];	///< messages encoded into _stream
+	unsigned		_message_count{0};
+
+	uint8_t			_stream[stream_size];
+	size_t			_stream_len{0};
+
+	mavlink_status_t	_tx_status{};
+};
+
+bool mavlink_frame_parser_test(void);
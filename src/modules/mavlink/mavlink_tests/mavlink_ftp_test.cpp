@@ -38,6 +38,7 @@
 #include <crc32.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <mathlib/mathlib.h>
 
 #include "mavlink_ftp_test.h"
 #include "../mavlink_ftp.h"
@@ -798,6 +799,369 @@ bool MavlinkFtpTest::_removefile_test()
 	return true;
 }
 
+/// @brief Tests that several files can be read at the same time in different sessions.
+bool MavlinkFtpTest::_multi_session_test()
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+	const size_t				test_count = sizeof(_rgDownloadTestCases) / sizeof(_rgDownloadTestCases[0]);
+	uint8_t					sessions[test_count];
+
+	for (size_t i = 0; i < test_count; i++) {
+		const char *file = _rgDownloadTestCases[i].file;
+
+		payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+		payload.offset = 0;
+
+		bool success = _send_receive_msg(&payload,		// FTP payload header
+						 strlen(file) + 1,	// size in bytes of data
+						 (uint8_t *)file,	// Data to start into FTP message payload
+						 &reply);		// Payload inside FTP message response
+
+		if (!success) {
+			return false;
+		}
+
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+		sessions[i] = reply->session;
+
+		for (size_t j = 0; j < i; j++) {
+			ut_assert("Session id used twice", sessions[j] != sessions[i]);
+		}
+	}
+
+	// read the files in reverse order of opening
+	for (size_t i = test_count; i-- > 0;) {
+		const DownloadTestCase *test = &_rgDownloadTestCases[i];
+		uint8_t bytes[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
+		int fd = ::open(test->file, O_RDONLY);
+		ut_assert("open failed", fd != -1);
+		int bytes_read = ::read(fd, bytes, sizeof(bytes));
+		::close(fd);
+
+		payload.opcode = MavlinkFTP::kCmdReadFile;
+		payload.session = sessions[i];
+		payload.offset = 0;
+
+		bool success = _send_receive_msg(&payload,	// FTP payload header
+						 0,		// size in bytes of data
+						 nullptr,	// Data to start into FTP message payload
+						 &reply);	// Payload inside FTP message response
+
+		if (!success) {
+			return false;
+		}
+
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+		ut_compare("Incorrect session", reply->session, sessions[i]);
+		ut_assert("Payload size incorrect", reply->size > 0 && reply->size <= bytes_read);
+		ut_compare("File contents differ", memcmp(reply->data, bytes, reply->size), 0);
+	}
+
+	for (size_t i = 0; i < test_count; i++) {
+		payload.opcode = MavlinkFTP::kCmdTerminateSession;
+		payload.session = sessions[i];
+
+		bool success = _send_receive_msg(&payload,	// FTP payload header
+						 0,		// size in bytes of data
+						 nullptr,	// Data to start into FTP message payload
+						 &reply);	// Payload inside FTP message response
+
+		if (!success) {
+			return false;
+		}
+
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	}
+
+	return true;
+}
+
+/// @brief Uploads data to _unittest_microsd_file over a simulated link. Up to window writes are in flight, writes
+/// which are not acked in time are resent individually. Verifies the file and its CRC32 afterwards.
+bool MavlinkFtpTest::_upload(const SimulatedLink &link, unsigned window, const uint8_t *data, uint32_t size,
+			     hrt_abstime &duration)
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+
+	const uint32_t full_packet_bytes = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(MavlinkFTP::PayloadHeader);
+	const uint32_t packet_size = MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+	const hrt_abstime dt = 10000; // send interval of the mavlink receiver thread
+	const uint32_t budget_per_step = link.rate * dt / 1000000;
+	const hrt_abstime timeout = 2 * link.latency + 2 * dt;
+
+	::unlink(_unittest_microsd_file);
+
+	payload.opcode = MavlinkFTP::kCmdCreateFile;
+	payload.offset = 0;
+
+	bool success = _send_receive_msg(&payload,				// FTP payload header
+					 strlen(_unittest_microsd_file) + 1,	// size in bytes of data
+					 (uint8_t *)_unittest_microsd_file,	// Data to start into FTP message payload
+					 &reply);				// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	const uint8_t session = reply->session;
+
+	struct Chunk {
+		hrt_abstime	sent;		///< time of the last transmission, 0 if it needs to be sent
+		hrt_abstime	arrival;	///< time the write reaches the server, 0 if lost or delivered
+		hrt_abstime	ack;		///< time the ack reaches the client
+		bool		acked;
+	};
+
+	const unsigned chunk_count = (size + full_packet_bytes - 1) / full_packet_bytes;
+	Chunk *chunks = new Chunk[chunk_count] {};
+	ut_assert("new failed", chunks != nullptr);
+
+	unsigned acked = 0;
+	unsigned in_flight = 0;
+	unsigned transmissions = 0;
+	uint32_t budget = 0;
+	hrt_abstime t = dt;
+
+	while (acked < chunk_count) {
+		for (unsigned i = 0; i < chunk_count; i++) {
+			Chunk &chunk = chunks[i];
+
+			if (chunk.arrival != 0 && chunk.arrival <= t) {
+				// the write reaches the server, which acks it right away
+				chunk.arrival = 0;
+
+				payload.opcode = MavlinkFTP::kCmdWriteFile;
+				payload.session = session;
+				payload.offset = i * full_packet_bytes;
+				const uint32_t length = math::min(full_packet_bytes, size - payload.offset);
+
+				mavlink_message_t msg;
+				_setup_ftp_msg(&payload, length, &data[payload.offset], &msg);
+				_ftp_server->handle_message(&msg);
+
+				reply = reinterpret_cast<const MavlinkFTP::PayloadHeader *>(_reply_msg.payload);
+				ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+				chunk.ack = t + link.latency;
+			}
+
+			if (!chunk.acked && chunk.ack != 0 && chunk.ack <= t) {
+				chunk.acked = true;
+				acked++;
+				in_flight--;
+
+			} else if (!chunk.acked && chunk.sent != 0 && chunk.ack == 0 && t >= chunk.sent + timeout) {
+				// lost: only this write is sent again
+				chunk.sent = 0;
+				in_flight--;
+			}
+		}
+
+		budget = math::min(budget + budget_per_step, budget_per_step + packet_size);
+
+		for (unsigned i = 0; i < chunk_count && in_flight < window && budget >= packet_size; i++) {
+			Chunk &chunk = chunks[i];
+
+			if (!chunk.acked && chunk.sent == 0) {
+				transmissions++;
+				const bool lost = link.loss_interval > 0 && transmissions % link.loss_interval == 0;
+				chunk.sent = t;
+				chunk.arrival = lost ? 0 : t + link.latency;
+				in_flight++;
+				budget -= packet_size;
+			}
+		}
+
+		t += dt;
+	}
+
+	delete[] chunks;
+	duration = t;
+
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.session = session;
+
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    0,		// size in bytes of data
+				    nullptr,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	// compare the written file
+	struct stat st;
+	ut_compare("stat failed", stat(_unittest_microsd_file, &st), 0);
+	ut_compare("File size incorrect", (uint32_t)st.st_size, size);
+
+	uint8_t *bytes = new uint8_t[size];
+	ut_assert("new failed", bytes != nullptr);
+	int fd = ::open(_unittest_microsd_file, O_RDONLY);
+	ut_assert("open failed", fd != -1);
+	int bytes_read = ::read(fd, bytes, size);
+	::close(fd);
+	ut_compare("read failed", (uint32_t)bytes_read, size);
+	int compare = memcmp(bytes, data, size);
+	delete[] bytes;
+	ut_compare("File contents differ", compare, 0);
+
+	payload.opcode = MavlinkFTP::kCmdCalcFileCRC32;
+	payload.offset = 0;
+
+	success = _send_receive_msg(&payload,				// FTP payload header
+				    strlen(_unittest_microsd_file) + 1,	// size in bytes of data
+				    (uint8_t *)_unittest_microsd_file,	// Data to start into FTP message payload
+				    &reply);				// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	uint32_t checksum;
+	memcpy(&checksum, reply->data, sizeof(checksum));
+	ut_compare("CRC32 incorrect", checksum, crc32part(data, size, 0));
+
+	return true;
+}
+
+/// @brief Downloads _unittest_microsd_file with burst reads over a simulated link
+bool MavlinkFtpTest::_download(const SimulatedLink &link, const uint8_t *data, uint32_t size, hrt_abstime &duration)
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+
+	const uint32_t packet_size = MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+	const hrt_abstime dt = 10000; // send interval of the mavlink receiver thread
+	const uint32_t budget_per_step = link.rate * dt / 1000000;
+
+	payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+	payload.offset = 0;
+
+	bool success = _send_receive_msg(&payload,				// FTP payload header
+					 strlen(_unittest_microsd_file) + 1,	// size in bytes of data
+					 (uint8_t *)_unittest_microsd_file,	// Data to start into FTP message payload
+					 &reply);				// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	const uint8_t session = reply->session;
+
+	DownloadInfo download_info{};
+	download_info.file_bytes = new uint8_t[size];
+	ut_assert("new failed", download_info.file_bytes != nullptr);
+	_ftp_server->set_unittest_worker(MavlinkFtpTest::receive_message_handler_download, &download_info);
+
+	uint32_t budget = 0;
+	hrt_abstime t = dt;
+	hrt_abstime request_time = t + link.latency;
+
+	while (!download_info.eof) {
+		if (request_time != 0 && t >= request_time) {
+			// (re)start the burst where the last one ended
+			request_time = 0;
+			payload.opcode = MavlinkFTP::kCmdBurstReadFile;
+			payload.session = session;
+			payload.offset = download_info.received;
+
+			mavlink_message_t msg;
+			_setup_ftp_msg(&payload, 0, nullptr, &msg);
+			_ftp_server->handle_message(&msg);
+		}
+
+		budget = math::min(budget + budget_per_step, budget_per_step + packet_size);
+		download_info.packets = 0;
+		_ftp_server->set_unittest_free_tx_buf(budget);
+		_ftp_server->send(t);
+		budget -= download_info.packets * packet_size;
+
+		if (download_info.burst_complete) {
+			download_info.burst_complete = false;
+			request_time = t + 2 * link.latency;
+		}
+
+		t += dt;
+	}
+
+	duration = t + link.latency;
+
+	_ftp_server->set_unittest_free_tx_buf(UINT32_MAX / 2);
+	_ftp_server->set_unittest_worker(MavlinkFtpTest::receive_message_handler_generic, this);
+
+	int compare = memcmp(download_info.file_bytes, data, size);
+	delete[] download_info.file_bytes;
+	ut_assert("Download failed", !download_info.error);
+	ut_compare("Download size incorrect", download_info.received, size);
+	ut_compare("File contents differ", compare, 0);
+
+	// continue after the sequence number of the last burst reply, as a client would
+	_expected_seq_number = download_info.seq_number;
+
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.session = session;
+
+	mavlink_message_t msg;
+	_setup_ftp_msg(&payload, 0, nullptr, &msg);
+	_ftp_server->handle_message(&msg);
+	reply = reinterpret_cast<const MavlinkFTP::PayloadHeader *>(_reply_msg.payload);
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	return true;
+}
+
+/// @brief Benchmarks uploads and downloads over rate limited links with latency and packet loss
+bool MavlinkFtpTest::_throughput_test()
+{
+	static const SimulatedLink links[] = {
+		{ "telemetry radio",	5760,	100000,	20 },
+		{ "wifi",		200000,	10000,	50 },
+	};
+
+	const uint32_t size = 16 * 1024;
+	uint8_t *data = new uint8_t[size];
+	ut_assert("new failed", data != nullptr);
+
+	for (uint32_t i = 0; i < size; i++) {
+		data[i] = (i * 7) ^ (i >> 8);
+	}
+
+	ut_compare("mkdir failed", ::mkdir(_unittest_microsd_dir, S_IRWXU | S_IRWXG | S_IRWXO), 0);
+
+	for (size_t i = 0; i < sizeof(links) / sizeof(links[0]); i++) {
+		const SimulatedLink &link = links[i];
+		hrt_abstime upload_single = 0;
+		hrt_abstime upload_windowed = 0;
+		hrt_abstime download = 0;
+
+		bool success = _upload(link, 1, data, size, upload_single)
+			       && _upload(link, 8, data, size, upload_windowed)
+			       && _download(link, data, size, download);
+
+		if (!success) {
+			delete[] data;
+			return false;
+		}
+
+		PX4_INFO("%s (%u B/s, %u ms): upload %.0f B/s (1 in flight), %.0f B/s (8 in flight), download %.0f B/s",
+			 link.name, link.rate, link.latency / 1000, (double)(size * 1e6f / upload_single),
+			 (double)(size * 1e6f / upload_windowed), (double)(size * 1e6f / download));
+
+		ut_assert("Windowed upload not faster", upload_windowed < upload_single);
+		ut_assert("Download does not use the link", size * 1e6f / download > link.rate / 2);
+	}
+
+	delete[] data;
+	return true;
+}
+
 /// Static method used as callback from MavlinkFTP for generic use. This method will be called by MavlinkFTP when
 /// it needs to send a message out on Mavlink.
 void MavlinkFtpTest::receive_message_handler_generic(const mavlink_file_transfer_protocol_t *ftp_req, void *worker_data)
@@ -873,6 +1237,26 @@ bool MavlinkFtpTest::_receive_message_handler_burst(const mavlink_file_transfer_
 	return true;
 }
 
+void MavlinkFtpTest::receive_message_handler_download(const mavlink_file_transfer_protocol_t *ftp_req,
+		void *worker_data)
+{
+	DownloadInfo *download_info = (DownloadInfo *)worker_data;
+	const MavlinkFTP::PayloadHeader *reply = reinterpret_cast<const MavlinkFTP::PayloadHeader *>(ftp_req->payload);
+
+	download_info->packets++;
+	download_info->seq_number = reply->seq_number;
+
+	if (reply->opcode == MavlinkFTP::kRspAck) {
+		memcpy(&download_info->file_bytes[reply->offset], reply->data, reply->size);
+		download_info->received = reply->offset + reply->size;
+		download_info->burst_complete = reply->burst_complete;
+
+	} else {
+		download_info->error = reply->data[0] != MavlinkFTP::kErrEOF;
+		download_info->eof = true;
+	}
+}
+
 /// @brief Decode and validate the incoming message
 bool MavlinkFtpTest::_decode_message(const mavlink_file_transfer_protocol_t	*ftp_msg,	///< Incoming FTP message
 				     const MavlinkFTP::PayloadHeader		**payload)	///< Payload inside FTP message response
@@ -968,6 +1352,8 @@ bool MavlinkFtpTest::run_tests()
 	// TODO FIX: Didn't get Nak back - (reply->opcode:128) (MavlinkFTP::kRspNak:129) (../../src/modules/mavlink/mavlink_tests/mavlink_ftp_test.cpp:730)
 	//ut_run_test(_createdirectory_test);
 	ut_run_test(_removefile_test);
+	ut_run_test(_multi_session_test);
+	ut_run_test(_throughput_test);
 
 	return (_tests_failed == 0);
 
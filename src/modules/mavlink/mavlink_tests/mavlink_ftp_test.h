@@ -90,6 +90,8 @@ private:
 	bool _removedirectory_test(void);
 	bool _createdirectory_test(void);
 	bool _removefile_test(void);
+	bool _multi_session_test(void);
+	bool _throughput_test(void);
 
 	void _receive_message_handler_generic(const mavlink_file_transfer_protocol_t *ftp_req);
 	void _setup_ftp_msg(const MavlinkFTP::PayloadHeader *payload_header, uint8_t size, const uint8_t *data,
@@ -101,6 +103,30 @@ private:
 			       const MavlinkFTP::PayloadHeader	**payload_reply);
 	void _cleanup_microsd(void);
 
+	/// A simulated full duplex link with limited rate and latency, used to benchmark transfers
+	struct SimulatedLink {
+		const char	*name;
+		uint32_t	rate;		///< bytes per second in each direction
+		uint32_t	latency;	///< one way latency in us
+		unsigned	loss_interval;	///< drop every n-th uploaded packet, 0 for no loss
+	};
+
+	/// Worker data for the simulated download
+	struct DownloadInfo {
+		uint8_t		*file_bytes;	///< received data
+		uint32_t	received;	///< end offset of the last received packet
+		unsigned	packets;	///< packets sent in the current send() call
+		uint16_t	seq_number;	///< sequence number of the last reply
+		bool		burst_complete;
+		bool		eof;
+		bool		error;
+	};
+
+	static void receive_message_handler_download(const mavlink_file_transfer_protocol_t *ftp_req, void *worker_data);
+
+	bool _upload(const SimulatedLink &link, unsigned window, const uint8_t *data, uint32_t size, hrt_abstime &duration);
+	bool _download(const SimulatedLink &link, const uint8_t *data, uint32_t size, hrt_abstime &duration);
+
 	/// A single download test case
 	struct DownloadTestCase {
 		const char	*file;
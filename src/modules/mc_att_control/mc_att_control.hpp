@@ -34,6 +34,7 @@
 #include <lib/mixer/mixer.h>
 #include <mathlib/math/filter/LowPassFilter2pVector3f.hpp>
 #include <matrix/matrix/math.hpp>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <px4_config.h>
 #include <px4_defines.h>
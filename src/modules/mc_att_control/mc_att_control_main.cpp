@@ -786,6 +786,7 @@ MulticopterAttitudeControl::publish_actuator_controls()
 
 	if (!_actuators_0_circuit_breaker_enabled) {
 		orb_publish_auto(_actuators_id, &_actuators_0_pub, &_actuators, nullptr, ORB_PRIO_DEFAULT);
+		latency_trace_record(LATENCY_TRACE_ACTUATOR_CONTROLS, _actuators.timestamp_sample);
 	}
 }
 
@@ -67,6 +67,16 @@
 
 void *send(void *data);
 void micrortps_start_topics(struct timespec &begin, int &total_read, uint32_t &received, int &loop);
+void micrortps_print_status();
+
+/** Per topic bandwidth and latency statistics */
+struct topic_stats {
+	const char *name;
+	uint64_t msgs;
+	uint64_t bytes;
+	uint64_t latency_sum_us;	///< sum of the delays from publication to transmission
+	uint32_t latency_max_us;
+};
 
 struct baudtype {
 	speed_t code;
@@ -0,0 +1,509 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file muorb_shm_main.cpp
+ *
+ * Command to share uORB topics with other PX4 processes over shared memory,
+ * and to benchmark the channel between two processes.
+ */
+
+#include <px4_config.h>
+#include <px4_getopt.h>
+#include <px4_log.h>
+#include <px4_module.h>
+
+#include <errno.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <modules/uORB/uORBManager.hpp>
+
+#include "uORBShmChannel.hpp"
+
+extern "C" __EXPORT int muorb_shm_main(int argc, char *argv[]);
+
+namespace muorb_shm
+{
+
+static constexpr uint32_t BENCH_PING = 0;
+static constexpr uint32_t BENCH_REPORT = 1;	///< reply with the number of data messages received
+static constexpr uint32_t BENCH_EXIT = 2;
+
+static const int bench_data_sizes[] = {64, 1024, 8192};
+static const char *const bench_data_topics[] = {"bench_data_64", "bench_data_1024", "bench_data_8192"};
+
+struct BenchMessage {
+	uint64_t timestamp_ns;
+	uint32_t sequence;
+	uint32_t command;
+	uint32_t count;
+	uint32_t reserved;
+};
+
+static uint64_t time_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void sleep_ms(int ms)
+{
+	struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+	nanosleep(&ts, nullptr);
+}
+
+/**
+ * Handler of the benchmark processes. The echo process returns every ping as
+ * pong and counts the data messages, the measuring process records the round
+ * trip times.
+ */
+class BenchHandler : public uORBCommunicator::IChannelRxHandler
+{
+public:
+	BenchHandler(uORB::ShmChannel &channel, bool echo) : _channel(channel), _echo(echo)
+	{
+		sem_init(&_pong, 0, 0);
+	}
+
+	~BenchHandler()
+	{
+		sem_destroy(&_pong);
+	}
+
+	int16_t process_remote_topic(const char *topic_name, bool isAdvertisement) override { return 0; }
+	int16_t process_add_subscription(const char *messageName, int32_t msgRateInHz) override { return 0; }
+	int16_t process_remove_subscription(const char *messageName) override { return 0; }
+
+	int16_t process_received_message(const char *messageName, int32_t length, uint8_t *data) override
+	{
+		if (_echo && strncmp(messageName, "bench_data", 10) == 0) {
+			++_data_count;
+
+		} else if (_echo && strcmp(messageName, "bench_ping") == 0) {
+			BenchMessage *message = (BenchMessage *)data;
+
+			if (message->command == BENCH_REPORT) {
+				message->count = _data_count;
+				_data_count = 0;
+
+			} else if (message->command == BENCH_EXIT) {
+				__atomic_store_n(&_exit, true, __ATOMIC_RELEASE);
+			}
+
+			_channel.send_message("bench_pong", length, data);
+
+		} else if (!_echo && strcmp(messageName, "bench_pong") == 0) {
+			memcpy(&_reply, data, sizeof(_reply));
+			_reply_received_ns = time_ns();
+			sem_post(&_pong);
+		}
+
+		return 0;
+	}
+
+	bool should_exit() const { return __atomic_load_n(&_exit, __ATOMIC_ACQUIRE); }
+
+	/**
+	 * Wait for the pong of a ping.
+	 * @return round trip time [ns] or 0 on timeout
+	 */
+	uint64_t wait_for_pong(uint32_t sequence, int timeout_ms)
+	{
+		struct timespec abstime;
+		clock_gettime(CLOCK_REALTIME, &abstime);
+		abstime.tv_sec += timeout_ms / 1000;
+		abstime.tv_nsec += (timeout_ms % 1000) * 1000000L;
+
+		if (abstime.tv_nsec >= 1000000000L) {
+			abstime.tv_sec++;
+			abstime.tv_nsec -= 1000000000L;
+		}
+
+		while (sem_timedwait(&_pong, &abstime) == 0) {
+			if (_reply.sequence == sequence) {
+				return _reply_received_ns - _reply.timestamp_ns;
+			}
+		}
+
+		return 0;
+	}
+
+	const BenchMessage &reply() const { return _reply; }
+
+private:
+	uORB::ShmChannel &_channel;
+	const bool _echo;
+	bool _exit{false};
+	uint32_t _data_count{0};
+
+	sem_t _pong;
+	BenchMessage _reply{};
+	uint64_t _reply_received_ns{0};
+};
+
+static void bench_echo(unsigned bus)
+{
+	// forked from a multi-threaded process: keep it simple and leave with _exit()
+	uORB::ShmChannel *channel = new uORB::ShmChannel();
+	BenchHandler handler(*channel, true);
+	channel->register_handler(&handler);
+
+	if (channel->start(bus) == 0) {
+		channel->topic_advertised("bench_pong");
+
+		for (const char *topic : bench_data_topics) {
+			channel->add_subscription(topic, 0);
+		}
+
+		channel->add_subscription("bench_ping", 0);
+
+		const uint64_t deadline = time_ns() + 60000000000ull;
+
+		// stop if the measuring process dies
+		while (!handler.should_exit() && getppid() != 1 && time_ns() < deadline) {
+			sleep_ms(10);
+		}
+
+		channel->stop();
+	}
+
+	delete channel;
+}
+
+static bool wait_for_subscriber(uORB::ShmChannel &channel, const char *topic)
+{
+	for (int i = 0; i < 2000; ++i) {
+		if (channel.remote_subscribers(topic) > 0) {
+			return true;
+		}
+
+		sleep_ms(1);
+	}
+
+	PX4_ERR("no subscriber for %s", topic);
+	return false;
+}
+
+static int compare_uint64(const void *a, const void *b)
+{
+	const uint64_t x = *(const uint64_t *)a;
+	const uint64_t y = *(const uint64_t *)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static int bench_measure(uORB::ShmChannel &channel, BenchHandler &handler, int count, int size)
+{
+	uint8_t *buffer = (uint8_t *)calloc(1, size > 8192 ? size : 8192);
+	uint64_t *rtt = (uint64_t *)calloc(count, sizeof(uint64_t));
+
+	if (buffer == nullptr || rtt == nullptr) {
+		free(buffer);
+		free(rtt);
+		return -ENOMEM;
+	}
+
+	BenchMessage *message = (BenchMessage *)buffer;
+	uint32_t sequence = 0;
+
+	// latency: one ping in flight
+	int received = 0;
+	uint64_t sum = 0;
+
+	for (int i = 0; i < count; ++i) {
+		message->sequence = ++sequence;
+		message->command = BENCH_PING;
+		message->timestamp_ns = time_ns();
+		channel.send_message("bench_ping", size, buffer);
+
+		const uint64_t t = handler.wait_for_pong(sequence, 100);
+
+		if (t > 0) {
+			rtt[received++] = t;
+			sum += t;
+		}
+	}
+
+	int ret = 0;
+
+	if (received > 0) {
+		qsort(rtt, received, sizeof(uint64_t), compare_uint64);
+		PX4_INFO("round trip, %i bytes, %i of %i: min %.1f us, mean %.1f us, p99 %.1f us, max %.1f us",
+			 size, received, count, rtt[0] / 1e3, sum / (double)received / 1e3,
+			 rtt[(received * 99) / 100] / 1e3, rtt[received - 1] / 1e3);
+
+	} else {
+		PX4_ERR("no reply");
+		ret = -ETIMEDOUT;
+	}
+
+	// throughput: publish back to back. uORB keeps the latest sample, so the receiver
+	// may skip samples that it did not read before the ring wrapped around.
+	for (unsigned i = 0; i < sizeof(bench_data_sizes) / sizeof(bench_data_sizes[0]) && ret == 0; ++i) {
+		const int data_size = bench_data_sizes[i];
+		const int messages = 100000;
+
+		const uint64_t start = time_ns();
+
+		for (int n = 0; n < messages; ++n) {
+			message->sequence = n;
+			channel.send_message(bench_data_topics[i], data_size, buffer);
+		}
+
+		const uint64_t sent = time_ns();
+
+		message->sequence = ++sequence;
+		message->command = BENCH_REPORT;
+		message->timestamp_ns = sent;
+		channel.send_message("bench_ping", size, buffer);
+
+		if (handler.wait_for_pong(sequence, 1000) == 0) {
+			PX4_ERR("no report");
+			ret = -ETIMEDOUT;
+			break;
+		}
+
+		const double publish_s = (sent - start) / 1e9;
+		const double total_s = (time_ns() - start) / 1e9;
+		const uint32_t delivered = handler.reply().count;
+
+		PX4_INFO("%5i bytes: %.0f msg/s published (%.1f MB/s), %u delivered (%.1f%%, %.1f MB/s)",
+			 data_size, messages / publish_s, messages * (double)data_size / publish_s / 1e6,
+			 delivered, 100.0 * delivered / messages, delivered * (double)data_size / total_s / 1e6);
+	}
+
+	message->sequence = ++sequence;
+	message->command = BENCH_EXIT;
+	channel.send_message("bench_ping", size, buffer);
+	handler.wait_for_pong(sequence, 1000);
+
+	free(buffer);
+	free(rtt);
+	return ret;
+}
+
+static int bench(unsigned bus, int count, int size)
+{
+	// start from a fresh bus, a previous run might have been interrupted
+	uORB::ShmChannel::unlink(bus);
+
+	uORB::ShmChannel *channel = new uORB::ShmChannel();
+	BenchHandler handler(*channel, false);
+	channel->register_handler(&handler);
+
+	int ret = channel->start(bus);
+
+	if (ret != 0) {
+		delete channel;
+		return ret;
+	}
+
+	channel->topic_advertised("bench_ping");
+	channel->add_subscription("bench_pong", 0);
+
+	const pid_t pid = fork();
+
+	if (pid == 0) {
+		bench_echo(bus);
+		_exit(0);
+	}
+
+	if (pid < 0) {
+		PX4_ERR("fork failed (%i)", errno);
+		ret = -errno;
+
+	} else {
+		bool ready = wait_for_subscriber(*channel, "bench_ping");
+
+		for (const char *topic : bench_data_topics) {
+			ready = ready && wait_for_subscriber(*channel, topic);
+		}
+
+		if (ready) {
+			ret = bench_measure(*channel, handler, count, size);
+
+		} else {
+			kill(pid, SIGTERM);
+			ret = -ETIMEDOUT;
+		}
+
+		waitpid(pid, nullptr, 0);
+	}
+
+	channel->stop();
+	delete channel;
+	uORB::ShmChannel::unlink(bus);
+	return ret;
+}
+
+static void usage()
+{
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+Shares uORB topics with other PX4 processes on the same machine over POSIX shared memory
+(uORB communicator channel). This allows to run modules in separate processes, for example
+to isolate or profile them.
+
+Processes that are started with the same bus id exchange all topics that are advertised in one
+and subscribed in another one. Only the first instance of multi-instance topics is shared.
+The channel must be started right after uORB, before any module advertises or subscribes:
+topics advertised before are not shared. In the multiprocess SITL build, rcS does this and
+starts ekf2, mavlink and logger in processes of their own.
+
+Up to 4 publishers of a topic can write at the same time. More publishers wait for each
+other, and drop the sample if that takes too long (counted as not shared).
+
+### Examples
+Attach a process to the topics of vehicle instance 0 (first command after 'uorb start'):
+$ muorb_shm start -b 0
+
+Measure latency and throughput between two processes:
+$ muorb_shm bench -n 10000 -s 64
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME("muorb_shm", "communication");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("start", "Attach to a bus");
+	PRINT_MODULE_USAGE_PARAM_INT('b', 0, 0, 65535, "Bus id", true);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("stop", "Detach from the bus");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print processes, shared topics and statistics");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("bench", "Round trip and throughput to a forked process, on a private bus");
+	PRINT_MODULE_USAGE_PARAM_INT('n', 10000, 1, 1000000, "Number of round trips", true);
+	PRINT_MODULE_USAGE_PARAM_INT('s', 64, 24, 8192, "Message size", true);
+}
+
+} // namespace muorb_shm
+
+int muorb_shm_main(int argc, char *argv[])
+{
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+	unsigned bus = 0;
+	int count = 10000;
+	int size = 64;
+
+	while ((ch = px4_getopt(argc, argv, "b:n:s:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'b':
+			bus = strtoul(myoptarg, nullptr, 0);
+			break;
+
+		case 'n':
+			count = strtol(myoptarg, nullptr, 0);
+			break;
+
+		case 's':
+			size = strtol(myoptarg, nullptr, 0);
+			break;
+
+		default:
+			muorb_shm::usage();
+			return 1;
+		}
+	}
+
+	if (myoptind >= argc) {
+		muorb_shm::usage();
+		return 1;
+	}
+
+	const char *command = argv[myoptind];
+
+	if (!strcmp(command, "start")) {
+		if (uORB::ShmChannel::instance() && uORB::ShmChannel::instance()->is_running()) {
+			PX4_WARN("already running");
+			return 1;
+		}
+
+		// a stopped channel is reused, publishers may still hold a pointer to it
+		uORB::ShmChannel *channel = uORB::ShmChannel::create_instance();
+
+		if (channel == nullptr) {
+			return 1;
+		}
+
+		// registers the handler, so before the receive thread starts
+		uORB::Manager::get_instance()->set_uorb_communicator(channel);
+
+		if (channel->start(bus) != 0) {
+			uORB::Manager::get_instance()->set_uorb_communicator(nullptr);
+			return 1;
+		}
+
+		return 0;
+	}
+
+	if (!strcmp(command, "stop")) {
+		if (!uORB::ShmChannel::instance() || !uORB::ShmChannel::instance()->is_running()) {
+			PX4_WARN("not running");
+			return 1;
+		}
+
+		// publishers that fetched the channel before keep calling it: stop() waits for the calls in
+		// progress, later ones return without effect. The instance stays allocated.
+		uORB::Manager::get_instance()->set_uorb_communicator(nullptr);
+		uORB::ShmChannel::instance()->stop();
+		return 0;
+	}
+
+	if (!strcmp(command, "status")) {
+		if (uORB::ShmChannel::instance()) {
+			uORB::ShmChannel::instance()->print_status();
+
+		} else {
+			PX4_INFO("not running");
+		}
+
+		return 0;
+	}
+
+	if (!strcmp(command, "bench")) {
+		if (count < 1 || size < (int)sizeof(muorb_shm::BenchMessage) || size > 8192) {
+			muorb_shm::usage();
+			return 1;
+		}
+
+		// private bus, so that the benchmark does not interfere with running processes
+		return muorb_shm::bench(0x10000 + getpid(), count, size) == 0 ? 0 : 1;
+	}
+
+	muorb_shm::usage();
+	return 1;
+}
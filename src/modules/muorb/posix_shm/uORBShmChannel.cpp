@@ -0,0 +1,822 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file uORBShmChannel.cpp
+ *
+ * uORB communicator channel over POSIX shared memory.
+ */
+
+#include "uORBShmChannel.hpp"
+
+#include <px4_log.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__PX4_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+static constexpr uint32_t SHM_MAGIC = 0x42524f55u;	///< "UORB"
+static constexpr uint32_t SHM_VERSION = 1u;
+static constexpr int ATTACH_TIMEOUT_MS = 1000;		///< wait for the creator to initialize the bus
+static constexpr int RECEIVE_TIMEOUT_MS = 100;		///< receive thread checks _should_exit
+static constexpr int SLOT_WAIT_YIELDS = 1000;		///< wait for a publisher still writing the ring slot
+
+uORB::ShmChannel *uORB::ShmChannel::_instance = nullptr;
+
+static void sleep_ms(int ms)
+{
+	// not px4_usleep: the bus is shared with processes which may have a different (lockstep) clock
+	struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+	nanosleep(&ts, nullptr);
+}
+
+static uint32_t hash_name(const char *name)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+
+	while (*name) {
+		hash ^= (uint8_t) * name++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static inline uint32_t sample_stride(uint32_t size)
+{
+	// sequence and publisher, then the sample, 8 byte aligned
+	return (sizeof(uint64_t) + size + 7u) & ~7u;
+}
+
+uORB::ShmChannel *uORB::ShmChannel::create_instance()
+{
+	if (_instance == nullptr) {
+		_instance = new ShmChannel();
+	}
+
+	return _instance;
+}
+
+uORB::ShmChannel::~ShmChannel()
+{
+	stop();
+}
+
+int uORB::ShmChannel::attach(unsigned bus)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "/px4_uorb_%u", bus);
+
+	const size_t map_size = sizeof(Header) + DATA_SIZE;
+	bool created = true;
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+
+	if (fd < 0 && errno == EEXIST) {
+		created = false;
+		fd = shm_open(name, O_RDWR, 0666);
+	}
+
+	if (fd < 0) {
+		PX4_ERR("shm_open %s failed (%i)", name, errno);
+		return -errno;
+	}
+
+	if (created) {
+		if (ftruncate(fd, map_size) != 0) {
+			const int ret = -errno;
+			PX4_ERR("ftruncate %s failed (%i)", name, errno);
+			close(fd);
+			shm_unlink(name);
+			return ret;
+		}
+
+	} else {
+		// the creator may not have set the size yet
+		struct stat st {};
+
+		for (int i = 0; i < ATTACH_TIMEOUT_MS && fstat(fd, &st) == 0 && (size_t)st.st_size < map_size; ++i) {
+			sleep_ms(1);
+		}
+
+		if ((size_t)st.st_size != map_size) {
+			PX4_ERR("%s has size %lu instead of %lu (different build?)", name, (unsigned long)st.st_size,
+				(unsigned long)map_size);
+			close(fd);
+			return -EINVAL;
+		}
+	}
+
+	void *map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED) {
+		PX4_ERR("mmap %s failed (%i)", name, errno);
+		return -errno;
+	}
+
+	Header *header = (Header *)map;
+
+	if (created) {
+		// ftruncate zeroed the memory
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+#if defined(__PX4_LINUX)
+		// a process can die while it holds the lock
+		pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+#endif
+		pthread_mutex_init(&header->lock, &attr);
+		pthread_mutexattr_destroy(&attr);
+
+		header->version = SHM_VERSION;
+		header->generation = 1;
+		__atomic_store_n(&header->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+
+	} else {
+		for (int i = 0; i < ATTACH_TIMEOUT_MS && __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_MAGIC; ++i) {
+			sleep_ms(1);
+		}
+
+		if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_MAGIC || header->version != SHM_VERSION) {
+			PX4_ERR("%s: invalid magic or version", name);
+			munmap(map, map_size);
+			return -EINVAL;
+		}
+	}
+
+	_header = header;
+	_data = (uint8_t *)map + sizeof(Header);
+	_map_size = map_size;
+	_bus = bus;
+	return 0;
+}
+
+void uORB::ShmChannel::detach()
+{
+	if (_header) {
+		munmap(_header, _map_size);
+		_header = nullptr;
+		_data = nullptr;
+	}
+}
+
+bool uORB::ShmChannel::enter()
+{
+	// pairs with stop(): either stop() sees the user, or the user sees that the channel stopped
+	__atomic_fetch_add(&_users, 1, __ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&_running, __ATOMIC_SEQ_CST)) {
+		return true;
+	}
+
+	__atomic_fetch_sub(&_users, 1, __ATOMIC_RELEASE);
+	return false;
+}
+
+void uORB::ShmChannel::leave()
+{
+	__atomic_fetch_sub(&_users, 1, __ATOMIC_RELEASE);
+}
+
+void uORB::ShmChannel::unlink(unsigned bus)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "/px4_uorb_%u", bus);
+	shm_unlink(name);
+}
+
+bool uORB::ShmChannel::lock()
+{
+	int ret = pthread_mutex_lock(&_header->lock);
+
+#if defined(__PX4_LINUX)
+
+	if (ret == EOWNERDEAD) {
+		// the table is only modified with single atomic operations, so it is consistent
+		pthread_mutex_consistent(&_header->lock);
+		ret = 0;
+	}
+
+#endif
+
+	return ret == 0;
+}
+
+void uORB::ShmChannel::unlock()
+{
+	pthread_mutex_unlock(&_header->lock);
+}
+
+int uORB::ShmChannel::start(unsigned bus)
+{
+	if (_header) {
+		return -EBUSY;
+	}
+
+	int ret = attach(bus);
+
+	if (ret != 0) {
+		return ret;
+	}
+
+	// reclaim the slots of processes that died without stopping the channel
+	if (lock()) {
+		for (int i = 0; i < MAX_PROCESSES; ++i) {
+			const int32_t pid = __atomic_load_n(&_header->processes[i].pid, __ATOMIC_ACQUIRE);
+
+			if (pid != 0 && kill(pid, 0) != 0 && errno == ESRCH) {
+				PX4_INFO("releasing process %i (pid %i)", i, (int)pid);
+				release_process(i);
+				__atomic_store_n(&_header->processes[i].pid, 0, __ATOMIC_RELEASE);
+			}
+		}
+
+		unlock();
+	}
+
+	const int32_t pid = getpid();
+
+	for (int i = 0; i < MAX_PROCESSES && _process < 0; ++i) {
+		Process &process = _header->processes[i];
+		int32_t expected = 0;
+
+		if (__atomic_compare_exchange_n(&process.pid, &expected, pid, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+			for (int w = 0; w < MAX_TOPICS / 64; ++w) {
+				__atomic_store_n(&process.pending[w], 0, __ATOMIC_RELAXED);
+			}
+
+			_process = i;
+		}
+	}
+
+	if (_process < 0) {
+		PX4_ERR("bus %u: too many processes", bus);
+		detach();
+		return -ENOSPC;
+	}
+
+	memset(_local, 0, sizeof(_local));
+	_generation = 0;
+	_should_exit = false;
+
+	ret = pthread_create(&_thread, nullptr, receive_trampoline, this);
+
+	if (ret != 0) {
+		PX4_ERR("pthread_create failed (%i)", ret);
+		__atomic_store_n(&_header->processes[_process].pid, 0, __ATOMIC_RELEASE);
+		_process = -1;
+		detach();
+		return -ret;
+	}
+
+	_thread_running = true;
+	__atomic_store_n(&_running, true, __ATOMIC_SEQ_CST);
+	return 0;
+}
+
+void uORB::ShmChannel::stop()
+{
+	if (!_header) {
+		return;
+	}
+
+	// publishers keep calling until they see the channel stopped, wait for those in progress
+	__atomic_store_n(&_running, false, __ATOMIC_SEQ_CST);
+
+	while (__atomic_load_n(&_users, __ATOMIC_ACQUIRE) != 0) {
+		sleep_ms(1);
+	}
+
+	if (_thread_running) {
+		_should_exit = true;
+		ring(_process);
+		pthread_join(_thread, nullptr);
+		_thread_running = false;
+	}
+
+	if (lock()) {
+		release_process(_process);
+		__atomic_store_n(&_header->processes[_process].pid, 0, __ATOMIC_RELEASE);
+		unlock();
+	}
+
+	_process = -1;
+	detach();
+
+	free(_rx_buffer);
+	_rx_buffer = nullptr;
+	_rx_buffer_size = 0;
+}
+
+void uORB::ShmChannel::release_process(int process)
+{
+	const uint32_t bit = 1u << process;
+
+	for (int t = 0; t < MAX_TOPICS; ++t) {
+		Topic &topic = _header->topics[t];
+
+		if (__atomic_load_n(&topic.used, __ATOMIC_ACQUIRE)) {
+			__atomic_fetch_and(&topic.advertisers, ~bit, __ATOMIC_RELAXED);
+			__atomic_fetch_and(&topic.subscribers, ~bit, __ATOMIC_RELAXED);
+		}
+	}
+
+	__atomic_fetch_add(&_header->generation, 1, __ATOMIC_RELEASE);
+
+	for (int p = 0; p < MAX_PROCESSES; ++p) {
+		if (p != process && __atomic_load_n(&_header->processes[p].pid, __ATOMIC_RELAXED) != 0) {
+			ring(p);
+		}
+	}
+}
+
+int uORB::ShmChannel::find_topic(const char *name, bool create)
+{
+	if (strlen(name) >= TOPIC_NAME_LENGTH) {
+		return -1;
+	}
+
+	const uint32_t hash = hash_name(name);
+
+	// open addressing: topics are only added (under the lock), never removed,
+	// so a free slot ends the search
+	for (int probe = 0; probe < MAX_TOPICS; ++probe) {
+		const int index = (hash + probe) & (MAX_TOPICS - 1);
+		Topic &topic = _header->topics[index];
+
+		if (!__atomic_load_n(&topic.used, __ATOMIC_ACQUIRE)) {
+			if (!create || !lock()) {
+				return -1;
+			}
+
+			if (!__atomic_load_n(&topic.used, __ATOMIC_ACQUIRE)) {
+				strncpy(topic.name, name, TOPIC_NAME_LENGTH - 1);
+				__atomic_store_n(&topic.used, 1, __ATOMIC_RELEASE);
+				unlock();
+				return index;
+			}
+
+			// another process added a topic to this slot meanwhile
+			unlock();
+		}
+
+		if (strcmp(topic.name, name) == 0) {
+			return index;
+		}
+	}
+
+	return -1;
+}
+
+int uORB::ShmChannel::allocate_ring(Topic &topic, uint32_t size)
+{
+	if (!lock()) {
+		return -EINVAL;
+	}
+
+	int ret = 0;
+
+	if (topic.size == 0) {
+		const uint32_t ring_size = sample_stride(size) * RING_LENGTH;
+
+		if (_header->data_used + ring_size > DATA_SIZE) {
+			ret = -ENOMEM;
+
+		} else {
+			topic.data_offset = _header->data_used;
+			_header->data_used += ring_size;
+			__atomic_store_n(&topic.size, size, __ATOMIC_RELEASE);
+		}
+
+	} else if (topic.size != size) {
+		ret = -EINVAL;
+	}
+
+	unlock();
+	return ret;
+}
+
+uORB::ShmChannel::Sample *uORB::ShmChannel::sample(const Topic &topic, uint32_t index)
+{
+	return (Sample *)(_data + topic.data_offset + (index % RING_LENGTH) * sample_stride(topic.size));
+}
+
+void uORB::ShmChannel::ring(int process)
+{
+	Process &p = _header->processes[process];
+	__atomic_fetch_add(&p.doorbell, 1, __ATOMIC_SEQ_CST);
+
+#if defined(__PX4_LINUX)
+
+	// only make a system call if the receive thread is sleeping
+	if (__atomic_load_n(&p.waiting, __ATOMIC_SEQ_CST)) {
+		syscall(SYS_futex, &p.doorbell, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+	}
+
+#endif
+}
+
+int16_t uORB::ShmChannel::update_mask(const char *name, bool advertisers, bool set)
+{
+	if (!enter()) {
+		return -1;
+	}
+
+	const int index = find_topic(name, set);
+
+	if (index < 0) {
+		leave();
+		return set ? -1 : 0;
+	}
+
+	Topic &topic = _header->topics[index];
+	uint32_t *mask = advertisers ? &topic.advertisers : &topic.subscribers;
+	const uint32_t bit = 1u << _process;
+
+	if (set) {
+		if (!advertisers) {
+			__atomic_store_n(&_local[index].resync, true, __ATOMIC_RELEASE);
+		}
+
+		__atomic_fetch_or(mask, bit, __ATOMIC_ACQ_REL);
+
+	} else {
+		__atomic_fetch_and(mask, ~bit, __ATOMIC_ACQ_REL);
+	}
+
+	__atomic_fetch_add(&_header->generation, 1, __ATOMIC_RELEASE);
+
+	for (int p = 0; p < MAX_PROCESSES; ++p) {
+		if (p != _process && __atomic_load_n(&_header->processes[p].pid, __ATOMIC_RELAXED) != 0) {
+			ring(p);
+		}
+	}
+
+	leave();
+	return 0;
+}
+
+int16_t uORB::ShmChannel::topic_advertised(const char *messageName)
+{
+	return update_mask(messageName, true, true);
+}
+
+int16_t uORB::ShmChannel::add_subscription(const char *messageName, int32_t msgRateInHz)
+{
+	return update_mask(messageName, false, true);
+}
+
+int16_t uORB::ShmChannel::remove_subscription(const char *messageName)
+{
+	return update_mask(messageName, false, false);
+}
+
+int16_t uORB::ShmChannel::register_handler(uORBCommunicator::IChannelRxHandler *handler)
+{
+	_handler = handler;
+	return 0;
+}
+
+int uORB::ShmChannel::remote_subscribers(const char *messageName)
+{
+	if (!enter()) {
+		return 0;
+	}
+
+	const int index = find_topic(messageName, false);
+	int count = 0;
+
+	if (index >= 0) {
+		const uint32_t subscribers = __atomic_load_n(&_header->topics[index].subscribers, __ATOMIC_ACQUIRE);
+		count = __builtin_popcount(subscribers & ~(1u << _process));
+	}
+
+	leave();
+	return count;
+}
+
+int16_t uORB::ShmChannel::send_message(const char *messageName, int32_t length, uint8_t *data)
+{
+	if (length <= 0 || !enter()) {
+		return -1;
+	}
+
+	const int index = find_topic(messageName, false);
+
+	if (index < 0) {
+		// nobody ever subscribed
+		leave();
+		return 0;
+	}
+
+	Topic &topic = _header->topics[index];
+	const uint32_t subscribers = __atomic_load_n(&topic.subscribers, __ATOMIC_ACQUIRE) & ~(1u << _process);
+
+	if (subscribers == 0) {
+		leave();
+		return 0;
+	}
+
+	if (__atomic_load_n(&topic.size, __ATOMIC_ACQUIRE) != (uint32_t)length) {
+		const int ret = allocate_ring(topic, length);
+
+		if (ret != 0) {
+			// local publication still succeeds
+			if (__atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED) == 0) {
+				PX4_ERR("%s: cannot share topic (%i)", messageName, ret);
+			}
+
+			leave();
+			return 0;
+		}
+	}
+
+	if (!write_sample(topic, data, length)) {
+		__atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED);
+		leave();
+		return 0;
+	}
+
+	__atomic_fetch_add(&_sent, 1, __ATOMIC_RELAXED);
+
+	for (int p = 0; p < MAX_PROCESSES; ++p) {
+		if (subscribers & (1u << p)) {
+			__atomic_fetch_or(&_header->processes[p].pending[index / 64], 1ull << (index % 64), __ATOMIC_RELEASE);
+			ring(p);
+		}
+	}
+
+	leave();
+	return 0;
+}
+
+bool uORB::ShmChannel::write_sample(Topic &topic, const uint8_t *data, uint32_t length)
+{
+	const uint32_t write_index = __atomic_fetch_add(&topic.write_index, 1, __ATOMIC_RELAXED);
+	const uint32_t writing = 2 * write_index + 1;
+	Sample *s = sample(topic, write_index);
+
+	// seqlock write: claim the slot by setting the odd sequence of this sample. The slot may
+	// still be written by a publisher of an older sample if more than RING_LENGTH publish at once.
+	uint32_t sequence = __atomic_load_n(&s->sequence, __ATOMIC_RELAXED);
+
+	for (int i = 0;;) {
+		if ((int32_t)(sequence - writing) > 0) {
+			// a newer sample took the slot, readers count this one as lost
+			return true;
+		}
+
+		if ((sequence & 1u) == 0) {
+			if (__atomic_compare_exchange_n(&s->sequence, &sequence, writing, false, __ATOMIC_ACQ_REL,
+							__ATOMIC_RELAXED)) {
+				break;
+			}
+
+		} else if (++i > SLOT_WAIT_YIELDS) {
+			// the other publisher does not finish (or died)
+			return false;
+
+		} else {
+			sched_yield();
+			sequence = __atomic_load_n(&s->sequence, __ATOMIC_RELAXED);
+		}
+	}
+
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	s->publisher = _process;
+	memcpy(s + 1, data, length);
+	__atomic_store_n(&s->sequence, writing + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+void *uORB::ShmChannel::receive_trampoline(void *arg)
+{
+	((ShmChannel *)arg)->receive();
+	return nullptr;
+}
+
+void uORB::ShmChannel::receive()
+{
+	Process &self = _header->processes[_process];
+
+	while (!_should_exit) {
+		// read the doorbell before the work, so that a notification during the work is not missed
+		const uint32_t doorbell = __atomic_load_n(&self.doorbell, __ATOMIC_SEQ_CST);
+
+		if (__atomic_load_n(&_header->generation, __ATOMIC_ACQUIRE) != _generation) {
+			process_control();
+		}
+
+		for (int w = 0; w < MAX_TOPICS / 64; ++w) {
+			uint64_t pending = __atomic_exchange_n(&self.pending[w], 0, __ATOMIC_ACQ_REL);
+
+			while (pending) {
+				const int bit = __builtin_ctzll(pending);
+				pending &= pending - 1;
+				deliver(w * 64 + bit);
+			}
+		}
+
+		__atomic_store_n(&self.waiting, 1, __ATOMIC_SEQ_CST);
+
+		if (__atomic_load_n(&self.doorbell, __ATOMIC_SEQ_CST) == doorbell && !_should_exit) {
+#if defined(__PX4_LINUX)
+			struct timespec timeout = {0, RECEIVE_TIMEOUT_MS * 1000000L};
+			syscall(SYS_futex, &self.doorbell, FUTEX_WAIT, doorbell, &timeout, nullptr, 0);
+#else
+			sleep_ms(1);
+#endif
+		}
+
+		__atomic_store_n(&self.waiting, 0, __ATOMIC_RELAXED);
+		_wakeups++;
+	}
+}
+
+void uORB::ShmChannel::process_control()
+{
+	// a change during the scan triggers another one
+	_generation = __atomic_load_n(&_header->generation, __ATOMIC_ACQUIRE);
+
+	const uint32_t others = ~(1u << _process);
+
+	for (int t = 0; t < MAX_TOPICS; ++t) {
+		Topic &topic = _header->topics[t];
+
+		if (!__atomic_load_n(&topic.used, __ATOMIC_ACQUIRE)) {
+			continue;
+		}
+
+		LocalTopic &local = _local[t];
+
+		const bool advertised = (__atomic_load_n(&topic.advertisers, __ATOMIC_ACQUIRE) & others) != 0;
+
+		if (advertised != local.remote_advertised) {
+			local.remote_advertised = advertised;
+
+			if (_handler) {
+				_handler->process_remote_topic(topic.name, advertised);
+			}
+		}
+
+		const uint32_t subscribers = __atomic_load_n(&topic.subscribers, __ATOMIC_ACQUIRE) & others;
+
+		if (_handler) {
+			if (subscribers & ~local.remote_subscribers) {
+				// a new subscriber: uORB sends it the current sample
+				_handler->process_add_subscription(topic.name, 1);
+
+			} else if (subscribers == 0 && local.remote_subscribers != 0) {
+				_handler->process_remove_subscription(topic.name);
+			}
+		}
+
+		local.remote_subscribers = subscribers;
+	}
+}
+
+void uORB::ShmChannel::deliver(int index)
+{
+	Topic &topic = _header->topics[index];
+	LocalTopic &local = _local[index];
+	const uint32_t size = __atomic_load_n(&topic.size, __ATOMIC_ACQUIRE);
+
+	if (size == 0) {
+		return;
+	}
+
+	if (size > _rx_buffer_size) {
+		uint8_t *buffer = (uint8_t *)realloc(_rx_buffer, size);
+
+		if (buffer == nullptr) {
+			return;
+		}
+
+		_rx_buffer = buffer;
+		_rx_buffer_size = size;
+	}
+
+	const uint32_t write_index = __atomic_load_n(&topic.write_index, __ATOMIC_ACQUIRE);
+
+	if (__atomic_exchange_n(&local.resync, false, __ATOMIC_ACQ_REL)) {
+		// just subscribed: start with the latest sample
+		local.read_index = write_index > 0 ? write_index - 1 : 0;
+	}
+
+	if (write_index - local.read_index > (uint32_t)RING_LENGTH) {
+		_lost += write_index - local.read_index - RING_LENGTH;
+		local.read_index = write_index - RING_LENGTH;
+	}
+
+	while (local.read_index != write_index) {
+		const uint32_t expected = 2 * (local.read_index + 1);
+		Sample *s = sample(topic, local.read_index);
+		const uint32_t sequence = __atomic_load_n(&s->sequence, __ATOMIC_ACQUIRE);
+
+		if ((int32_t)(sequence - expected) < 0) {
+			// still being written, the publisher notifies us again when it is done. If it dropped
+			// the sample instead, the ring moves on once RING_LENGTH newer ones are written.
+			break;
+		}
+
+		uint32_t publisher = 0;
+		bool valid = false;
+
+		if (sequence == expected) {
+			publisher = s->publisher;
+			memcpy(_rx_buffer, s + 1, size);
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			valid = __atomic_load_n(&s->sequence, __ATOMIC_RELAXED) == expected;
+		}
+
+		++local.read_index;
+
+		if (!valid) {
+			// overwritten by a newer sample
+			++_lost;
+
+		} else if (publisher != (uint32_t)_process && _handler) {
+			_handler->process_received_message(topic.name, size, _rx_buffer);
+			++_received;
+		}
+	}
+}
+
+void uORB::ShmChannel::print_status()
+{
+	if (!enter()) {
+		PX4_INFO("not running");
+		return;
+	}
+
+	PX4_INFO("bus %u, process %i, %u kB of %u kB sample storage used", _bus, _process,
+		 (unsigned)(__atomic_load_n(&_header->data_used, __ATOMIC_RELAXED) / 1024), (unsigned)(DATA_SIZE / 1024));
+
+	for (int p = 0; p < MAX_PROCESSES; ++p) {
+		const int32_t pid = __atomic_load_n(&_header->processes[p].pid, __ATOMIC_RELAXED);
+
+		if (pid != 0) {
+			PX4_INFO_RAW("  process %2i: pid %i%s\n", p, (int)pid, p == _process ? " (this)" : "");
+		}
+	}
+
+	PX4_INFO_RAW("  %-40s %5s %4s %4s %10s\n", "topic", "size", "adv", "sub", "samples");
+
+	for (int t = 0; t < MAX_TOPICS; ++t) {
+		const Topic &topic = _header->topics[t];
+
+		if (__atomic_load_n(&topic.used, __ATOMIC_ACQUIRE)) {
+			PX4_INFO_RAW("  %-40s %5u %4i %4i %10u\n", topic.name, (unsigned)topic.size,
+				     __builtin_popcount(topic.advertisers), __builtin_popcount(topic.subscribers),
+				     (unsigned)topic.write_index);
+		}
+	}
+
+	PX4_INFO("sent: %u, received: %u, lost: %u, not shared: %u, wakeups: %u",
+		 (unsigned)_sent, (unsigned)_received, (unsigned)_lost, (unsigned)_dropped, (unsigned)_wakeups);
+	leave();
+}
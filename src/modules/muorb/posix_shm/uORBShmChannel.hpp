@@ -0,0 +1,263 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file uORBShmChannel.hpp
+ *
+ * uORB communicator channel between PX4 processes on the same machine,
+ * over POSIX shared memory.
+ *
+ * All processes attached to a bus map the shared memory object
+ * /px4_uorb_<bus>, which holds a table of topics and one ring of samples per
+ * topic. Publishing does not take a lock: the publisher claims a ring slot
+ * with an atomic increment and brackets the copy with a sequence number, so
+ * that a reader can tell a complete sample from one that is being written or
+ * was overwritten while it copied it (seqlock). The slot is claimed with a
+ * compare and swap of its sequence number: if more publishers than
+ * RING_LENGTH write a topic at the same time, a publisher waits a bounded
+ * time for the one still copying into its slot and otherwise drops its
+ * sample, instead of writing into the same slot.
+ *
+ * A sample is only copied if another process subscribed the topic. The
+ * publisher then marks the topic pending for each of these processes and
+ * rings their doorbell. The receive thread of a process sleeps on its
+ * doorbell (a futex on Linux) and hands the pending samples to uORB.
+ *
+ * Advertisements and subscriptions are bits in the topic table. A change
+ * increments a generation counter and rings all doorbells; the receive
+ * threads compare the table with what they reported to uORB before.
+ *
+ * uORB keeps a pointer to the channel and calls it from the publishing
+ * threads, so the object is never deleted: stop() waits for these calls and
+ * later ones return without effect until the channel is started again.
+ *
+ * Topics are identified by name, so as with the other uORB communicators
+ * only the first instance of a multi-instance topic is shared.
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <uORB/uORBCommunicator.hpp>
+
+namespace uORB
+{
+class ShmChannel;
+}
+
+class uORB::ShmChannel : public uORBCommunicator::IChannel
+{
+public:
+	static constexpr int MAX_PROCESSES = 16;
+	static constexpr int MAX_TOPICS = 512;		///< power of 2
+	static constexpr int RING_LENGTH = 4;		///< samples per topic
+	static constexpr int TOPIC_NAME_LENGTH = 48;
+	static constexpr size_t DATA_SIZE = 4 * 1024 * 1024; ///< sample storage of all topics
+
+	ShmChannel() = default;
+	virtual ~ShmChannel();
+
+	// no copy, assignment, move, move assignment
+	ShmChannel(const ShmChannel &) = delete;
+	ShmChannel &operator=(const ShmChannel &) = delete;
+	ShmChannel(ShmChannel &&) = delete;
+	ShmChannel &operator=(ShmChannel &&) = delete;
+
+	/**
+	 * Singleton used by the muorb_shm command. It is never deleted, uORB
+	 * may still hold a pointer to it.
+	 */
+	static ShmChannel *instance() { return _instance; }
+	static ShmChannel *create_instance();
+
+	/**
+	 * Attach to a bus, creating it if it does not exist yet, and start the
+	 * receive thread. register_handler() should be called before.
+	 * @param bus processes on the same bus exchange topics
+	 * @return 0 on success, -errno otherwise
+	 */
+	int start(unsigned bus);
+
+	/**
+	 * Withdraw all advertisements and subscriptions of this process, stop
+	 * the receive thread and detach from the bus. Waits for the calls that
+	 * are in progress in other threads.
+	 */
+	void stop();
+
+	bool is_running() const { return __atomic_load_n(&_running, __ATOMIC_ACQUIRE); }
+
+	void print_status();
+
+	/**
+	 * Remove the shared memory object of a bus. Attached processes keep
+	 * their mapping, the next process to start creates a new bus.
+	 */
+	static void unlink(unsigned bus);
+
+	/**
+	 * Number of other processes subscribed to a topic.
+	 */
+	int remote_subscribers(const char *messageName);
+
+	int16_t topic_advertised(const char *messageName) override;
+	int16_t add_subscription(const char *messageName, int32_t msgRateInHz) override;
+	int16_t remove_subscription(const char *messageName) override;
+	int16_t register_handler(uORBCommunicator::IChannelRxHandler *handler) override;
+	int16_t send_message(const char *messageName, int32_t length, uint8_t *data) override;
+
+private:
+	/** ring slot, followed by the sample */
+	struct Sample {
+		uint32_t sequence;		///< 2 * (index + 1) when complete, odd while it is written
+		uint32_t publisher;		///< process slot of the publisher
+	};
+
+	struct Topic {
+		uint32_t used;			///< set after the name is written, slots are never freed
+		uint32_t size;			///< sample size, 0 until the ring is allocated
+		uint32_t data_offset;		///< offset of the ring in the data area
+		uint32_t write_index;		///< number of samples published
+		uint32_t advertisers;		///< bit per process
+		uint32_t subscribers;		///< bit per process
+		char name[TOPIC_NAME_LENGTH];
+	};
+
+	struct Process {
+		int32_t pid;			///< 0: free slot
+		uint32_t doorbell;		///< incremented on every notification (futex word)
+		uint32_t waiting;		///< receive thread is sleeping on the doorbell
+		uint32_t reserved;
+		uint64_t pending[MAX_TOPICS / 64]; ///< topics with new samples
+	};
+
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t generation;		///< incremented when advertisers or subscribers change
+		uint32_t data_used;		///< bytes allocated in the data area
+		pthread_mutex_t lock;		///< topic table and data allocation, not used to publish
+		Process processes[MAX_PROCESSES];
+		Topic topics[MAX_TOPICS];
+	};
+
+	/** state of a topic in this process, owned by the receive thread */
+	struct LocalTopic {
+		uint32_t read_index;		///< next sample to deliver
+		uint32_t remote_subscribers;	///< subscribers reported to uORB
+		bool remote_advertised;		///< advertisement reported to uORB
+		bool resync;			///< deliver the latest sample first (set on subscription)
+	};
+
+	int attach(unsigned bus);
+	void detach();
+
+	/**
+	 * Bracket a call that accesses the bus, so that stop() does not unmap it meanwhile.
+	 * @return false if the channel is not running, leave() must not be called then
+	 */
+	bool enter();
+	void leave();
+
+	bool lock();
+	void unlock();
+
+	/**
+	 * Find a topic in the table.
+	 * @param create add the topic if it is not found
+	 * @return topic index or -1
+	 */
+	int find_topic(const char *name, bool create);
+
+	/**
+	 * Allocate the ring of a topic on its first sample.
+	 * @return 0 on success, -errno otherwise
+	 */
+	int allocate_ring(Topic &topic, uint32_t size);
+
+	Sample *sample(const Topic &topic, uint32_t index);
+
+	/**
+	 * Write a sample to the next ring slot.
+	 * @return false if the slot stayed busy and the sample was dropped
+	 */
+	bool write_sample(Topic &topic, const uint8_t *data, uint32_t length);
+
+	/**
+	 * Set or clear the bit of this process in a mask of a topic and notify
+	 * all processes.
+	 */
+	int16_t update_mask(const char *name, bool advertisers, bool set);
+
+	/** ring the doorbell of a process */
+	void ring(int process);
+
+	/** remove a process from all topics (on stop or if it died) */
+	void release_process(int process);
+
+	static void *receive_trampoline(void *arg);
+	void receive();
+	void process_control();
+	void deliver(int topic);
+
+	static ShmChannel *_instance;
+
+	Header *_header{nullptr};
+	uint8_t *_data{nullptr};		///< sample storage, follows the header
+	size_t _map_size{0};
+	unsigned _bus{0};
+	int _process{-1};			///< our process slot
+
+	bool _running{false};			///< started, calls may enter
+	uint32_t _users{0};			///< calls in progress
+
+	uORBCommunicator::IChannelRxHandler *_handler{nullptr};
+
+	pthread_t _thread{};
+	bool _thread_running{false};
+	volatile bool _should_exit{false};
+
+	uint32_t _generation{0};		///< last generation processed by the receive thread
+	LocalTopic _local[MAX_TOPICS] {};
+	uint8_t *_rx_buffer{nullptr};		///< copy of the sample being delivered
+	uint32_t _rx_buffer_size{0};
+
+	uint32_t _sent{0};			///< samples written to the rings
+	uint32_t _received{0};			///< samples delivered to uORB
+	uint32_t _lost{0};			///< samples overwritten before they were delivered
+	uint32_t _dropped{0};			///< samples not shared (no space for the ring, slot busy)
+	uint32_t _wakeups{0};
+};
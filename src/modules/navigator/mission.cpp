@@ -63,7 +63,8 @@ using matrix::wrap_pi;
 
 Mission::Mission(Navigator *navigator) :
 	MissionBlock(navigator),
-	ModuleParams(navigator)
+	ModuleParams(navigator),
+	_feasibility_checker(navigator)
 {
 }
 
@@ -288,6 +289,7 @@ Mission::set_current_offboard_mission_index(uint16_t index)
 	    (index != _current_offboard_mission_index) && (index < _offboard_mission.count)) {
 
 		_current_offboard_mission_index = index;
+		_survey.reset();
 
 		// a mission offboard index is set manually which has the higher priority than the closest mission item
 		// as it is set by the user
@@ -452,6 +454,10 @@ Mission::update_offboard_mission()
 
 	struct mission_s old_offboard_mission = _offboard_mission;
 
+	/* the stored survey polygons might have changed */
+	_survey.reset();
+	_survey_read_ahead.reset();
+
 	if (orb_copy(ORB_ID(mission), _navigator->get_offboard_mission_sub(), &_offboard_mission) == OK) {
 		/* determine current index */
 		if (_offboard_mission.current_seq >= 0 && _offboard_mission.current_seq < (int)_offboard_mission.count) {
@@ -527,7 +533,7 @@ Mission::advance_mission()
 		switch (_mission_execution_mode) {
 		case mission_result_s::MISSION_EXECUTION_MODE_NORMAL:
 		case mission_result_s::MISSION_EXECUTION_MODE_FAST_FORWARD: {
-				_current_offboard_mission_index++;
+				advance_offboard_mission_index();
 				break;
 			}
 
@@ -557,7 +563,7 @@ Mission::advance_mission()
 			}
 
 		default:
-			_current_offboard_mission_index++;
+			advance_offboard_mission_index();
 		}
 
 		break;
@@ -568,6 +574,24 @@ Mission::advance_mission()
 	}
 }
 
+void
+Mission::advance_offboard_mission_index()
+{
+	if (_survey.contains(_current_offboard_mission_index)) {
+		if (_survey_waypoint_index + 1 < _survey.waypointCount()) {
+			_survey_waypoint_index++;
+
+		} else {
+			// survey completed, continue after the polygon
+			_current_offboard_mission_index = _survey.nextIndex();
+			_survey.reset();
+		}
+
+	} else {
+		_current_offboard_mission_index++;
+	}
+}
+
 void
 Mission::set_mission_items()
 {
@@ -1439,6 +1463,19 @@ Mission::read_mission_item(int offset, struct mission_item_s *mission_item)
 		return false;
 	}
 
+	const bool reverse = _mission_execution_mode == mission_result_s::MISSION_EXECUTION_MODE_REVERSE;
+
+	/* inside a survey the offset counts the remaining generated waypoints first */
+	if (!reverse && offset >= 0 && _survey.contains(current_index)) {
+		const int remaining = _survey.waypointCount() - 1 - _survey_waypoint_index;
+
+		if (offset <= remaining) {
+			return _survey.waypoint(_survey_waypoint_index + offset, *mission_item);
+		}
+
+		index_to_read = _survey.nextIndex() + offset - remaining - 1;
+	}
+
 	/* Repeat this several times in case there are several DO JUMPS that we need to follow along, however, after
 	 * 10 iterations we have to assume that the DO JUMPS are probably cycling and give up. */
 	for (int i = 0; i < 10; i++) {
@@ -1504,6 +1541,40 @@ Mission::read_mission_item(int offset, struct mission_item_s *mission_item)
 				}
 			}
 
+		} else if (mission_item_tmp.nav_cmd == NAV_CMD_SURVEY) {
+			/* expand the survey polygon, keep the last read ahead one to not read it again on every update */
+			if (!_survey_read_ahead.contains(*mission_index_ptr)
+			    && !_survey_read_ahead.load(dm_item, *mission_index_ptr, _offboard_mission.count)) {
+				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Survey at item %d invalid.", *mission_index_ptr);
+				return false;
+			}
+
+			if (reverse) {
+				/* surveys are not flown backwards, continue before the polygon */
+				*mission_index_ptr = _survey_read_ahead.firstIndex() - 1;
+
+			} else if (offset == 0) {
+				/* entering a survey, always start at its first lane */
+				_survey = _survey_read_ahead;
+				_survey_waypoint_index = 0;
+				*mission_index_ptr = _survey.firstIndex();
+				return _survey.waypoint(_survey_waypoint_index, *mission_item);
+
+			} else {
+				/* reading ahead counts the vertex items like the generated waypoints: an index
+				 * past the first vertex is the corresponding waypoint or, if the pattern is
+				 * shorter, an item after the polygon. prepare_mission_items() stops at the
+				 * first position item, so it only ever gets waypoint 0. */
+				const int waypoint_index = *mission_index_ptr - _survey_read_ahead.firstIndex();
+				const int waypoint_count = _survey_read_ahead.waypointCount();
+
+				if (waypoint_index < waypoint_count) {
+					return _survey_read_ahead.waypoint(waypoint_index, *mission_item);
+				}
+
+				*mission_index_ptr = _survey_read_ahead.nextIndex() + waypoint_index - waypoint_count;
+			}
+
 		} else {
 			/* if it's not a DO_JUMP, then we were successful */
 			memcpy(mission_item, &mission_item_tmp, sizeof(struct mission_item_s));
@@ -1605,10 +1676,8 @@ Mission::check_mission_valid(bool force)
 {
 	if ((!_home_inited && _navigator->home_position_valid()) || force) {
 
-		MissionFeasibilityChecker _missionFeasibilityChecker(_navigator);
-
 		_navigator->get_mission_result()->valid =
-			_missionFeasibilityChecker.checkMissionFeasible(_offboard_mission,
+			_feasibility_checker.checkMissionFeasible(_offboard_mission,
 					_param_dist_1wp.get(),
 					_param_dist_between_wps.get(),
 					_navigator->mission_landing_required());
@@ -1623,6 +1692,26 @@ Mission::check_mission_valid(bool force)
 	}
 }
 
+void
+Mission::benchmark_feasibility_check(unsigned count)
+{
+	// separate instance, this runs in the shell and reads the navigator state unsynchronized
+	MissionFeasibilityChecker checker(_navigator);
+	checker.benchmark(count, _param_dist_1wp.get(), _param_dist_between_wps.get());
+}
+
+void
+Mission::print_status() const
+{
+	PX4_INFO("Mission feasibility check:");
+	_feasibility_checker.printDiagnostics();
+
+	if (_survey.valid()) {
+		PX4_INFO("survey at item %d: waypoint %d of %d", _survey.firstIndex(), _survey_waypoint_index + 1,
+			 _survey.waypointCount());
+	}
+}
+
 void
 Mission::reset_offboard_mission(struct mission_s &mission)
 {
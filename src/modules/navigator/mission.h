@@ -47,6 +47,7 @@
 #include "mission_block.h"
 #include "mission_feasibility_checker.h"
 #include "navigator_mode.h"
+#include "survey_pattern.h"
 
 #include <float.h>
 
@@ -107,6 +108,14 @@ public:
 	 * For a list of the different modes refer to mission_result.msg
 	 */
 	void set_execution_mode(const uint8_t mode);
+
+	/**
+	 * Time the feasibility checks on a synthetic mission
+	 * @param count number of mission items
+	 */
+	void benchmark_feasibility_check(unsigned count);
+
+	void print_status() const;
 private:
 
 	/**
@@ -119,6 +128,11 @@ private:
 	 */
 	void advance_mission();
 
+	/**
+	 * Move on to the next generated survey waypoint or the next mission item
+	 */
+	void advance_offboard_mission_index();
+
 	/**
 	 * Set new mission items
 	 */
@@ -185,7 +199,8 @@ private:
 
 	/**
 	 * Read current (offset == 0) or a specific (offset > 0) mission item
-	 * from the dataman and watch out for DO_JUMPS
+	 * from the dataman and watch out for DO_JUMPS. Survey polygons are
+	 * expanded on the fly, the offset counts the generated waypoints.
 	 *
 	 * @return true if successful
 	 */
@@ -252,8 +267,14 @@ private:
 
 	struct mission_s _offboard_mission {};
 
+	MissionFeasibilityChecker _feasibility_checker;
+
 	int32_t _current_offboard_mission_index{-1};
 
+	SurveyPattern _survey;				/**< survey containing the current mission item */
+	SurveyPattern _survey_read_ahead;		/**< cached survey for the read ahead items */
+	int _survey_waypoint_index{0};			/**< current generated waypoint of _survey */
+
 	// track location of planned mission landing
 	bool	_land_start_available{false};
 	uint16_t _land_start_index{UINT16_MAX};		/**< index of DO_LAND_START, INVALID_DO_LAND_START if no planned landing */
@@ -39,536 +39,733 @@
  * @author Sander Smeets <sander@droneslab.com>
  */
 
+
 #include "mission_feasibility_checker.h"
 
 #include "mission_block.h"
 #include "navigator.h"
 
+#include <drivers/drv_hrt.h>
 #include <drivers/drv_pwm_output.h>
 #include <lib/ecl/geo/geo.h>
 #include <lib/mathlib/mathlib.h>
 #include <lib/landing_slope/Landingslope.hpp>
 #include <systemlib/mavlink_log.h>
 #include <uORB/Subscription.hpp>
-#include <uORB/topics/position_controller_landing_status.h>
+
+MissionFeasibilityChecker::MissionFeasibilityChecker(Navigator *navigator) :
+	_navigator(navigator),
+	_check_perf(perf_alloc(PC_ELAPSED, "navigator: mission check"))
+{
+}
+
+MissionFeasibilityChecker::~MissionFeasibilityChecker()
+{
+	perf_free(_check_perf);
+}
 
 bool
 MissionFeasibilityChecker::checkMissionFeasible(const mission_s &mission,
 		float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
 		bool land_start_req)
 {
-	bool failed = false;
-	bool warned = false;
+	_diagnostics_count = 0;
+	_errors_count = 0;
 
 	// first check if we have a valid position
-	const bool home_valid = _navigator->home_position_valid();
-	const bool home_alt_valid = _navigator->home_alt_valid();
-
-	if (!home_alt_valid) {
-		failed = true;
-		warned = true;
+	if (!_navigator->home_alt_valid()) {
 		mavlink_log_info(_navigator->get_mavlink_log_pub(), "Not yet ready for mission, no position lock.");
-
-	} else {
-		failed = failed || !checkDistanceToFirstWaypoint(mission, max_distance_to_1st_waypoint);
+		return false;
 	}
 
-	const float home_alt = _navigator->get_home_position()->alt;
-
-	// check if all mission item commands are supported
-	failed = failed || !checkMissionItemValidity(mission);
-	failed = failed || !checkDistancesBetweenWaypoints(mission, max_distance_between_waypoints);
-	failed = failed || !checkGeofence(mission, home_alt, home_valid);
-	failed = failed || !checkHomePositionAltitude(mission, home_alt, home_alt_valid, warned);
+	perf_begin(_check_perf);
 
-	// VTOL always respects rotary wing feasibility
-	if (_navigator->get_vstatus()->is_rotary_wing || _navigator->get_vstatus()->is_vtol) {
-		failed = failed || !checkRotarywing(mission, home_alt, home_alt_valid);
+	bool failed = false;
 
-	} else {
-		failed = failed || !checkFixedwing(mission, home_alt, home_alt_valid, land_start_req);
+	if (_navigator->get_geofence().isHomeRequired() && !_navigator->home_position_valid()) {
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence requires valid home position");
+		failed = true;
 	}
 
-	return !failed;
-}
+	// read every item only once and run all the checks on it
+	beginPass(max_distance_to_1st_waypoint, max_distance_between_waypoints, land_start_req);
+	bool read_failed = false;
 
-bool
-MissionFeasibilityChecker::checkRotarywing(const mission_s &mission, float home_alt, bool home_alt_valid)
-{
 	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
+		mission_item_s missionitem;
+		const ssize_t len = sizeof(missionitem);
 
 		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
 			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			return false;
+			addDiagnostic(i, Diagnostic::READ_FAILED);
+			read_failed = true;
+			break;
 		}
 
-		// look for a takeoff waypoint
-		if (missionitem.nav_cmd == NAV_CMD_TAKEOFF) {
-			// make sure that the altitude of the waypoint is at least one meter larger than the altitude acceptance radius
-			// this makes sure that the takeoff waypoint is not reached before we are at least one meter in the air
-			const float takeoff_alt = missionitem.altitude_is_relative ? missionitem.altitude : missionitem.altitude - home_alt;
+		checkItem(missionitem, i);
+	}
+
+	if (!read_failed) {
+		endPass(mission.count);
+	}
 
-			// check if we should use default acceptance radius
-			float acceptance_radius = _navigator->get_altitude_acceptance_radius();
+	perf_end(_check_perf);
 
-			// if a specific acceptance radius has been defined, use that one instead
-			if (missionitem.acceptance_radius > NAV_EPSILON_POSITION) {
-				acceptance_radius = missionitem.acceptance_radius;
-			}
+	// report the warnings and the first error, the full list is available in the status output
+	bool error_reported = false;
 
-			if (takeoff_alt - 1.0f < acceptance_radius) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Takeoff altitude too low!");
-				return false;
-			}
+	for (int i = 0; i < math::min(_diagnostics_count, MAX_DIAGNOSTICS); i++) {
+		if (_diagnostics[i].warning || !error_reported) {
+			reportDiagnostic(_diagnostics[i]);
+			error_reported = error_reported || !_diagnostics[i].warning;
 		}
 	}
 
-	// all checks have passed
-	return true;
-}
+	if (_errors_count > 1) {
+		mavlink_log_info(_navigator->get_mavlink_log_pub(), "%d more mission errors", _errors_count - 1);
+	}
 
-bool
-MissionFeasibilityChecker::checkFixedwing(const mission_s &mission, float home_alt, bool home_alt_valid,
-		bool land_start_req)
-{
-	/* Perform checks and issue feedback to the user for all checks */
-	bool resTakeoff = checkFixedWingTakeoff(mission, home_alt, home_alt_valid);
-	bool resLanding = checkFixedWingLanding(mission, land_start_req);
+	if (_pass.mission_warning) {
+		_navigator->get_mission_result()->warning = true;
+	}
 
-	/* Mission is only marked as feasible if all checks return true */
-	return (resTakeoff && resLanding);
+	return !failed && _errors_count == 0;
 }
 
-bool
-MissionFeasibilityChecker::checkGeofence(const mission_s &mission, float home_alt, bool home_valid)
+void
+MissionFeasibilityChecker::benchmark(unsigned count, float max_distance_to_1st_waypoint,
+				     float max_distance_between_waypoints)
 {
-	if (_navigator->get_geofence().isHomeRequired() && !home_valid) {
-		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence requires valid home position");
-		return false;
+	if (!_navigator->home_alt_valid()) {
+		PX4_ERR("no home position");
+		return;
 	}
 
-	/* Check if all mission items are inside the geofence (if we have a valid geofence) */
-	if (_navigator->get_geofence().valid()) {
-		for (size_t i = 0; i < mission.count; i++) {
-			struct mission_item_s missionitem = {};
-			const ssize_t len = sizeof(missionitem);
+	if (count > (unsigned)DM_KEY_WAYPOINTS_ONBOARD_MAX) {
+		PX4_WARN("dataman holds %d items, checking these", DM_KEY_WAYPOINTS_ONBOARD_MAX);
+		count = DM_KEY_WAYPOINTS_ONBOARD_MAX;
+	}
+
+	const home_position_s &home = *_navigator->get_home_position();
+	map_projection_reference_s home_ref;
+	map_projection_init(&home_ref, home.lat, home.lon);
 
-			if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-				/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-				return false;
-			}
+	// survey: takeoff, camera trigger distance, lanes of 20 waypoints spaced by 30m and return.
+	// Written to the onboard mission storage, which navigator does not use, to check it like an uploaded mission.
+	for (unsigned i = 0; i < count; i++) {
+		mission_item_s item{};
+		item.altitude_is_relative = true;
+		item.altitude = 50.f;
+		item.lat = home.lat;
+		item.lon = home.lon;
 
-			if (missionitem.altitude_is_relative && !home_valid) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence requires valid home position");
-				return false;
-			}
+		if (i == 0) {
+			item.nav_cmd = NAV_CMD_TAKEOFF;
+			item.altitude = 20.f;
 
-			// Geofence function checks against home altitude amsl
-			missionitem.altitude = missionitem.altitude_is_relative ? missionitem.altitude + home_alt : missionitem.altitude;
+		} else if (i == 1) {
+			item.nav_cmd = NAV_CMD_DO_SET_CAM_TRIGG_DIST;
+			item.params[0] = 10.f;
 
-			if (MissionBlock::item_contains_position(missionitem) && !_navigator->get_geofence().check(missionitem)) {
+		} else if (i == count - 1) {
+			item.nav_cmd = NAV_CMD_RETURN_TO_LAUNCH;
 
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence violation for waypoint %zu", i + 1);
-				return false;
-			}
+		} else {
+			const unsigned lane = (i - 2) / 20;
+			const unsigned waypoint = (lane % 2 == 0) ? (i - 2) % 20 : 19 - (i - 2) % 20;
+
+			item.nav_cmd = NAV_CMD_WAYPOINT;
+			map_projection_reproject(&home_ref, waypoint * 30.f, lane * 30.f, &item.lat, &item.lon);
+		}
+
+		if (dm_write(DM_KEY_WAYPOINTS_ONBOARD, i, DM_PERSIST_IN_FLIGHT_RESET, &item, sizeof(item)) != sizeof(item)) {
+			PX4_ERR("dataman write failed at item %u", i);
+			return;
 		}
 	}
 
-	return true;
+	mission_s mission{};
+	mission.dataman_id = DM_KEY_WAYPOINTS_ONBOARD;
+	mission.count = count;
+
+	const hrt_abstime start = hrt_absolute_time();
+	const bool feasible = checkMissionFeasible(mission, max_distance_to_1st_waypoint, max_distance_between_waypoints,
+			      false);
+	const hrt_abstime elapsed = hrt_elapsed_time(&start);
+
+	PX4_INFO("%u items checked in %llu us (%.2f us/item), %s, %d errors, %d diagnostics", count,
+		 (unsigned long long)elapsed, (double)elapsed / math::max(count, 1u), feasible ? "feasible" : "not feasible",
+		 _errors_count, _diagnostics_count);
+	printDiagnostics();
 }
 
-bool
-MissionFeasibilityChecker::checkHomePositionAltitude(const mission_s &mission, float home_alt, bool home_alt_valid,
-		bool throw_error)
+void
+MissionFeasibilityChecker::beginPass(float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
+				     bool land_start_req)
 {
-	/* Check if all waypoints are above the home altitude */
-	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
+	_pass = {};
+	_pass.home_alt = _navigator->get_home_position()->alt;
+	_pass.home_valid = _navigator->home_position_valid();
 
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-			_navigator->get_mission_result()->warning = true;
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			return false;
-		}
+	// VTOL always respects rotary wing feasibility
+	_pass.rotary_wing = _navigator->get_vstatus()->is_rotary_wing || _navigator->get_vstatus()->is_vtol;
+
+	// the mission is already rejected if the geofence requires home and it is not valid
+	_pass.geofence_valid = _navigator->get_geofence().valid() &&
+			       (!_navigator->get_geofence().isHomeRequired() || _pass.home_valid);
+
+	_pass.max_distance_to_1st_waypoint = max_distance_to_1st_waypoint;
+	_pass.max_distance_between_waypoints = max_distance_between_waypoints;
+	_pass.land_start_req = land_start_req;
+	_pass.last_lat = (double)NAN;
+	_pass.last_lon = (double)NAN;
+
+	if (!_pass.rotary_wing) {
+		uORB::Subscription<position_controller_landing_status_s> landing_status{ORB_ID(position_controller_landing_status)};
+		landing_status.forcedUpdate();
+		_pass.landing_status = landing_status.get();
+	}
+}
 
-		/* reject relative alt without home set */
-		if (missionitem.altitude_is_relative && !home_alt_valid && MissionBlock::item_contains_position(missionitem)) {
+void
+MissionFeasibilityChecker::checkItem(const mission_item_s &item, size_t index)
+{
+	checkMissionItemValidity(item, index);
+	checkSurvey(item, index);
+	checkDistanceToFirstWaypoint(item, index);
+	checkDistancesBetweenWaypoints(item, index);
+	checkGeofence(item, index);
+	checkHomePositionAltitude(item, index);
+	checkTakeoff(item, index);
+
+	if (!_pass.rotary_wing) {
+		checkFixedWingLanding(item, index);
+	}
 
-			_navigator->get_mission_result()->warning = true;
+	_pass.previous_item = item;
+}
 
-			if (throw_error) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: No home pos, WP %zu uses rel alt", i + 1);
-				return false;
+void
+MissionFeasibilityChecker::endPass(size_t count)
+{
+	if (_pass.survey_vertices_left > 0) {
+		addDiagnostic(count - 1, Diagnostic::INVALID_SURVEY, false, _pass.survey_vertex_count);
+	}
 
-			} else	{
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Warning: No home pos, WP %zu uses rel alt", i + 1);
-				return true;
-			}
-		}
+	if (!_pass.rotary_wing) {
+		checkFixedWingLandStart(count);
+	}
+}
 
-		/* calculate the global waypoint altitude */
-		float wp_alt = (missionitem.altitude_is_relative) ? missionitem.altitude + home_alt : missionitem.altitude;
+void
+MissionFeasibilityChecker::addDiagnostic(size_t index, Diagnostic diagnostic, bool warning, int32_t value,
+		int32_t limit)
+{
+	if (_diagnostics_count < MAX_DIAGNOSTICS) {
+		ItemDiagnostic &entry = _diagnostics[_diagnostics_count];
+		entry.index = index;
+		entry.diagnostic = diagnostic;
+		entry.warning = warning;
+		entry.value = value;
+		entry.limit = limit;
+	}
 
-		if ((home_alt > wp_alt) && MissionBlock::item_contains_position(missionitem)) {
+	_diagnostics_count++;
 
-			_navigator->get_mission_result()->warning = true;
+	if (!warning) {
+		_errors_count++;
+	}
+}
 
-			if (throw_error) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Waypoint %zu below home", i + 1);
-				return false;
+void
+MissionFeasibilityChecker::checkGeofence(const mission_item_s &item, size_t index)
+{
+	/* Check if all mission items are inside the geofence (if we have a valid geofence) */
+	if (!_pass.geofence_valid) {
+		return;
+	}
 
-			} else	{
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Warning: Waypoint %zu below home", i + 1);
-				return true;
-			}
-		}
+	if (item.altitude_is_relative && !_pass.home_valid) {
+		addDiagnostic(index, Diagnostic::GEOFENCE_HOME_REQUIRED);
+		return;
 	}
 
-	return true;
+	// Geofence function checks against home altitude amsl
+	mission_item_s missionitem = item;
+	missionitem.altitude = item.altitude_is_relative ? item.altitude + _pass.home_alt : item.altitude;
+
+	if (MissionBlock::item_contains_position(missionitem) && !_navigator->get_geofence().check(missionitem)) {
+		addDiagnostic(index, Diagnostic::GEOFENCE_VIOLATION);
+	}
 }
 
-bool
-MissionFeasibilityChecker::checkMissionItemValidity(const mission_s &mission)
+void
+MissionFeasibilityChecker::checkHomePositionAltitude(const mission_item_s &item, size_t index)
 {
-	// do not allow mission if we find unsupported item
-	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem;
-		const ssize_t len = sizeof(struct mission_item_s);
+	/* Check if all waypoints are above the home altitude, warn only once */
+	if (_pass.home_alt_checked) {
+		return;
+	}
 
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-			// not supposed to happen unless the datamanager can't access the SD card, etc.
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Cannot access SD card");
-			return false;
-		}
+	/* calculate the global waypoint altitude */
+	const float wp_alt = item.altitude_is_relative ? item.altitude + _pass.home_alt : item.altitude;
 
-		// check if we find unsupported items and reject mission if so
-		if (missionitem.nav_cmd != NAV_CMD_IDLE &&
-		    missionitem.nav_cmd != NAV_CMD_WAYPOINT &&
-		    missionitem.nav_cmd != NAV_CMD_LOITER_UNLIMITED &&
-		    missionitem.nav_cmd != NAV_CMD_LOITER_TIME_LIMIT &&
-		    missionitem.nav_cmd != NAV_CMD_RETURN_TO_LAUNCH &&
-		    missionitem.nav_cmd != NAV_CMD_LAND &&
-		    missionitem.nav_cmd != NAV_CMD_TAKEOFF &&
-		    missionitem.nav_cmd != NAV_CMD_LOITER_TO_ALT &&
-		    missionitem.nav_cmd != NAV_CMD_VTOL_TAKEOFF &&
-		    missionitem.nav_cmd != NAV_CMD_VTOL_LAND &&
-		    missionitem.nav_cmd != NAV_CMD_DELAY &&
-		    missionitem.nav_cmd != NAV_CMD_DO_JUMP &&
-		    missionitem.nav_cmd != NAV_CMD_DO_CHANGE_SPEED &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_HOME &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_SERVO &&
-		    missionitem.nav_cmd != NAV_CMD_DO_LAND_START &&
-		    missionitem.nav_cmd != NAV_CMD_DO_TRIGGER_CONTROL &&
-		    missionitem.nav_cmd != NAV_CMD_DO_DIGICAM_CONTROL &&
-		    missionitem.nav_cmd != NAV_CMD_IMAGE_START_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_IMAGE_STOP_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_VIDEO_START_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_VIDEO_STOP_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONFIGURE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONTROL &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_LOCATION &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_WPNEXT_OFFSET &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_NONE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_DIST &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_INTERVAL &&
-		    missionitem.nav_cmd != NAV_CMD_SET_CAMERA_MODE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_VTOL_TRANSITION) {
-
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: item %i: unsupported cmd: %d", (int)(i + 1),
-					     (int)missionitem.nav_cmd);
-			return false;
-		}
+	if ((_pass.home_alt > wp_alt)
+	    && (MissionBlock::item_contains_position(item) || item.nav_cmd == NAV_CMD_SURVEY)) {
+		_pass.mission_warning = true;
+		_pass.home_alt_checked = true;
+		addDiagnostic(index, Diagnostic::BELOW_HOME, true);
+	}
+}
 
-		/* Check non navigation item */
-		if (missionitem.nav_cmd == NAV_CMD_DO_SET_SERVO) {
-
-			/* check actuator number */
-			if (missionitem.params[0] < 0 || missionitem.params[0] > 5) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Actuator number %d is out of bounds 0..5",
-						     (int)missionitem.params[0]);
-				return false;
-			}
-
-			/* check actuator value */
-			if (missionitem.params[1] < -PWM_DEFAULT_MAX || missionitem.params[1] > PWM_DEFAULT_MAX) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "Actuator value %d is out of bounds -PWM_DEFAULT_MAX..PWM_DEFAULT_MAX", (int)missionitem.params[1]);
-				return false;
-			}
-		}
+void
+MissionFeasibilityChecker::checkMissionItemValidity(const mission_item_s &item, size_t index)
+{
+	// check if we find unsupported items and reject mission if so
+	if (item.nav_cmd != NAV_CMD_IDLE &&
+	    item.nav_cmd != NAV_CMD_WAYPOINT &&
+	    item.nav_cmd != NAV_CMD_LOITER_UNLIMITED &&
+	    item.nav_cmd != NAV_CMD_LOITER_TIME_LIMIT &&
+	    item.nav_cmd != NAV_CMD_RETURN_TO_LAUNCH &&
+	    item.nav_cmd != NAV_CMD_LAND &&
+	    item.nav_cmd != NAV_CMD_TAKEOFF &&
+	    item.nav_cmd != NAV_CMD_LOITER_TO_ALT &&
+	    item.nav_cmd != NAV_CMD_VTOL_TAKEOFF &&
+	    item.nav_cmd != NAV_CMD_VTOL_LAND &&
+	    item.nav_cmd != NAV_CMD_DELAY &&
+	    item.nav_cmd != NAV_CMD_DO_JUMP &&
+	    item.nav_cmd != NAV_CMD_DO_CHANGE_SPEED &&
+	    item.nav_cmd != NAV_CMD_DO_SET_HOME &&
+	    item.nav_cmd != NAV_CMD_DO_SET_SERVO &&
+	    item.nav_cmd != NAV_CMD_DO_LAND_START &&
+	    item.nav_cmd != NAV_CMD_DO_TRIGGER_CONTROL &&
+	    item.nav_cmd != NAV_CMD_DO_DIGICAM_CONTROL &&
+	    item.nav_cmd != NAV_CMD_IMAGE_START_CAPTURE &&
+	    item.nav_cmd != NAV_CMD_IMAGE_STOP_CAPTURE &&
+	    item.nav_cmd != NAV_CMD_VIDEO_START_CAPTURE &&
+	    item.nav_cmd != NAV_CMD_VIDEO_STOP_CAPTURE &&
+	    item.nav_cmd != NAV_CMD_DO_MOUNT_CONFIGURE &&
+	    item.nav_cmd != NAV_CMD_DO_MOUNT_CONTROL &&
+	    item.nav_cmd != NAV_CMD_DO_SET_ROI &&
+	    item.nav_cmd != NAV_CMD_DO_SET_ROI_LOCATION &&
+	    item.nav_cmd != NAV_CMD_DO_SET_ROI_WPNEXT_OFFSET &&
+	    item.nav_cmd != NAV_CMD_DO_SET_ROI_NONE &&
+	    item.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_DIST &&
+	    item.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_INTERVAL &&
+	    item.nav_cmd != NAV_CMD_SET_CAMERA_MODE &&
+	    item.nav_cmd != NAV_CMD_DO_VTOL_TRANSITION &&
+	    item.nav_cmd != NAV_CMD_SURVEY) {
+
+		addDiagnostic(index, Diagnostic::UNSUPPORTED_COMMAND, false, item.nav_cmd);
+		return;
+	}
 
-		// check if the mission starts with a land command while the vehicle is landed
-		if ((i == 0) && missionitem.nav_cmd == NAV_CMD_LAND && _navigator->get_land_detected()->landed) {
+	/* Check non navigation item */
+	if (item.nav_cmd == NAV_CMD_DO_SET_SERVO) {
 
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with landing");
-			return false;
+		/* check actuator number */
+		if (item.params[0] < 0 || item.params[0] > 5) {
+			addDiagnostic(index, Diagnostic::ACTUATOR_NUMBER, false, (int32_t)item.params[0]);
+		}
+
+		/* check actuator value */
+		if (item.params[1] < -PWM_DEFAULT_MAX || item.params[1] > PWM_DEFAULT_MAX) {
+			addDiagnostic(index, Diagnostic::ACTUATOR_VALUE, false, (int32_t)item.params[1]);
 		}
 	}
 
-	return true;
+	// check if the mission starts with a land command while the vehicle is landed
+	if ((index == 0) && item.nav_cmd == NAV_CMD_LAND && _navigator->get_land_detected()->landed) {
+		addDiagnostic(index, Diagnostic::STARTS_WITH_LANDING);
+	}
 }
 
-bool
-MissionFeasibilityChecker::checkFixedWingTakeoff(const mission_s &mission, float home_alt, bool home_alt_valid)
+void
+MissionFeasibilityChecker::checkSurvey(const mission_item_s &item, size_t index)
 {
-	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
-
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			return false;
+	if (item.nav_cmd != NAV_CMD_SURVEY) {
+		if (_pass.survey_vertices_left > 0) {
+			// polygon ended early
+			addDiagnostic(index - 1, Diagnostic::INVALID_SURVEY, false, _pass.survey_vertex_count);
+			_pass.survey_vertices_left = 0;
 		}
 
-		// look for a takeoff waypoint
-		if (missionitem.nav_cmd == NAV_CMD_TAKEOFF) {
-			// make sure that the altitude of the waypoint is at least one meter larger than the acceptance radius
-			// this makes sure that the takeoff waypoint is not reached before we are at least one meter in the air
+		return;
+	}
 
-			float takeoff_alt = missionitem.altitude_is_relative
-					    ? missionitem.altitude
-					    : missionitem.altitude - home_alt;
+	if (_pass.survey_vertices_left == 0) {
+		// first vertex of a polygon, it holds the survey parameters
+		_pass.survey_vertex_count = item.vertex_count;
+		_pass.survey_vertices_left = math::max((int)item.vertex_count - 1, 0);
 
-			// check if we should use default acceptance radius
-			float acceptance_radius = _navigator->get_default_acceptance_radius();
+		if (!_pass.survey.begin(item, index)) {
+			addDiagnostic(index, Diagnostic::INVALID_SURVEY, false, item.vertex_count);
+			return;
+		}
 
-			if (missionitem.acceptance_radius > NAV_EPSILON_POSITION) {
-				acceptance_radius = missionitem.acceptance_radius;
-			}
+	} else {
+		_pass.survey_vertices_left--;
 
-			if (takeoff_alt - 1.0f < acceptance_radius) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Takeoff altitude too low!");
-				return false;
-			}
+		if (item.vertex_count != _pass.survey_vertex_count) {
+			addDiagnostic(index, Diagnostic::INVALID_SURVEY, false, item.vertex_count);
+			_pass.survey.reset();
+			return;
 		}
 	}
 
-	// all checks have passed
-	return true;
+	if (!_pass.survey.addVertex(item) || _pass.survey_vertices_left > 0) {
+		return;
+	}
+
+	if (!_pass.survey.complete()) {
+		addDiagnostic(index, Diagnostic::INVALID_SURVEY, false, item.vertex_count);
+		return;
+	}
+
+	// the vertices are not flown, check the generated waypoints like the mission waypoints instead
+	const size_t first_index = _pass.survey.firstIndex();
+
+	for (int i = 0; i < _pass.survey.waypointCount(); i++) {
+		mission_item_s waypoint;
+
+		if (!_pass.survey.waypoint(i, waypoint)) {
+			addDiagnostic(index, Diagnostic::INVALID_SURVEY, false, item.vertex_count);
+			return;
+		}
+
+		checkDistanceToFirstWaypoint(waypoint, first_index);
+		checkDistancesBetweenWaypoints(waypoint, first_index);
+		checkGeofence(waypoint, first_index);
+	}
 }
 
-bool
-MissionFeasibilityChecker::checkFixedWingLanding(const mission_s &mission, bool land_start_req)
+void
+MissionFeasibilityChecker::checkTakeoff(const mission_item_s &item, size_t index)
 {
-	/* Go through all mission items and search for a landing waypoint
-	 * if landing waypoint is found: the previous waypoint is checked to be at a feasible distance and altitude given the landing slope */
+	// look for a takeoff waypoint
+	if (item.nav_cmd != NAV_CMD_TAKEOFF) {
+		return;
+	}
 
-	bool landing_valid = false;
+	// make sure that the altitude of the waypoint is at least one meter larger than the acceptance radius
+	// this makes sure that the takeoff waypoint is not reached before we are at least one meter in the air
+	const float takeoff_alt = item.altitude_is_relative ? item.altitude : item.altitude - _pass.home_alt;
 
-	bool land_start_found = false;
-	size_t do_land_start_index = 0;
-	size_t landing_approach_index = 0;
+	// check if we should use default acceptance radius
+	float acceptance_radius = _pass.rotary_wing ? _navigator->get_altitude_acceptance_radius()
+				  : _navigator->get_default_acceptance_radius();
 
-	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem;
-		const ssize_t len = sizeof(missionitem);
+	// if a specific acceptance radius has been defined, use that one instead
+	if (item.acceptance_radius > NAV_EPSILON_POSITION) {
+		acceptance_radius = item.acceptance_radius;
+	}
 
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			return false;
-		}
+	if (takeoff_alt - 1.0f < acceptance_radius) {
+		addDiagnostic(index, Diagnostic::TAKEOFF_TOO_LOW);
+	}
+}
+
+void
+MissionFeasibilityChecker::checkFixedWingLanding(const mission_item_s &item, size_t index)
+{
+	/* if landing waypoint is found: the previous waypoint is checked to be at a feasible distance and altitude given the landing slope */
 
-		// if DO_LAND_START found then require valid landing AFTER
-		if (missionitem.nav_cmd == NAV_CMD_DO_LAND_START) {
-			if (land_start_found) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: more than one land start.");
-				return false;
+	// if DO_LAND_START found then require valid landing AFTER
+	if (item.nav_cmd == NAV_CMD_DO_LAND_START) {
+		if (_pass.land_start_found) {
+			addDiagnostic(index, Diagnostic::MULTIPLE_LAND_START);
 
-			} else {
-				land_start_found = true;
-				do_land_start_index = i;
-			}
+		} else {
+			_pass.land_start_found = true;
+			_pass.do_land_start_index = index;
 		}
+	}
 
-		if (missionitem.nav_cmd == NAV_CMD_LAND) {
-			mission_item_s missionitem_previous {};
+	if (item.nav_cmd != NAV_CMD_LAND) {
+		return;
+	}
 
-			if (i > 0) {
-				landing_approach_index = i - 1;
+	if (index == 0) {
+		addDiagnostic(index, Diagnostic::STARTS_WITH_LAND);
+		return;
+	}
 
-				if (dm_read((dm_item_t)mission.dataman_id, landing_approach_index, &missionitem_previous, len) != len) {
-					/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-					return false;
-				}
+	_pass.landing_approach_index = index - 1;
+	const mission_item_s &missionitem_previous = _pass.previous_item;
 
-				if (MissionBlock::item_contains_position(missionitem_previous)) {
+	if (!MissionBlock::item_contains_position(missionitem_previous)) {
+		// mission item before land doesn't have a position
+		addDiagnostic(index, Diagnostic::LANDING_NO_APPROACH);
+		return;
+	}
 
-					uORB::Subscription<position_controller_landing_status_s> landing_status{ORB_ID(position_controller_landing_status)};
-					landing_status.forcedUpdate();
+	const position_controller_landing_status_s &landing_status = _pass.landing_status;
+	const bool landing_status_valid = (landing_status.timestamp > 0);
+	const float wp_distance = get_distance_to_next_waypoint(missionitem_previous.lat, missionitem_previous.lon,
+				  item.lat, item.lon);
 
-					const bool landing_status_valid = (landing_status.get().timestamp > 0);
-					const float wp_distance = get_distance_to_next_waypoint(missionitem_previous.lat, missionitem_previous.lon,
-								  missionitem.lat, missionitem.lon);
+	if (!landing_status_valid || (wp_distance <= landing_status.flare_length)) {
+		/* Last wp is in flare region */
+		addDiagnostic(index, Diagnostic::LANDING_IN_FLARE);
+		return;
+	}
 
-					if (landing_status_valid && (wp_distance > landing_status.get().flare_length)) {
-						/* Last wp is before flare region */
+	/* Last wp is before flare region */
+	const float delta_altitude = item.altitude - missionitem_previous.altitude;
 
-						const float delta_altitude = missionitem.altitude - missionitem_previous.altitude;
+	if (delta_altitude >= 0) {
+		/* Landing waypoint is above last waypoint */
+		addDiagnostic(index, Diagnostic::LANDING_ABOVE_APPROACH);
+		return;
+	}
 
-						if (delta_altitude < 0) {
+	const float horizontal_slope_displacement = landing_status.horizontal_slope_displacement;
+	const float slope_angle_rad = landing_status.slope_angle_rad;
+	const float slope_alt_req = Landingslope::getLandingSlopeAbsoluteAltitude(wp_distance, item.altitude,
+				    horizontal_slope_displacement, slope_angle_rad);
 
-							const float horizontal_slope_displacement = landing_status.get().horizontal_slope_displacement;
-							const float slope_angle_rad = landing_status.get().slope_angle_rad;
-							const float slope_alt_req = Landingslope::getLandingSlopeAbsoluteAltitude(wp_distance, missionitem.altitude,
-										    horizontal_slope_displacement, slope_angle_rad);
+	if (missionitem_previous.altitude > slope_alt_req + 1.0f) {
+		/* Landing waypoint is above altitude of slope at the given waypoint distance (with small tolerance for floating point discrepancies) */
+		const float wp_distance_req = Landingslope::getLandingSlopeWPDistance(missionitem_previous.altitude,
+					      item.altitude, horizontal_slope_displacement, slope_angle_rad);
 
-							if (missionitem_previous.altitude > slope_alt_req + 1.0f) {
-								/* Landing waypoint is above altitude of slope at the given waypoint distance (with small tolerance for floating point discrepancies) */
-								mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: adjust landing approach.");
+		addDiagnostic(index, Diagnostic::LANDING_SLOPE, false,
+			      (int32_t)ceilf(slope_alt_req - missionitem_previous.altitude),
+			      (int32_t)ceilf(wp_distance_req - wp_distance));
+		return;
+	}
 
-								const float wp_distance_req = Landingslope::getLandingSlopeWPDistance(missionitem_previous.altitude,
-											      missionitem.altitude, horizontal_slope_displacement, slope_angle_rad);
+	_pass.landing_valid = true;
+}
 
-								mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Move down %d m or move further away by %d m.",
-										     (int)ceilf(slope_alt_req - missionitem_previous.altitude),
-										     (int)ceilf(wp_distance_req - wp_distance));
+void
+MissionFeasibilityChecker::checkFixedWingLandStart(size_t count)
+{
+	if (_pass.land_start_req && !_pass.land_start_found) {
+		addDiagnostic(count > 0 ? count - 1 : 0, Diagnostic::LAND_START_REQUIRED);
 
-								return false;
-							}
+	} else if (_pass.land_start_found && (!_pass.landing_valid
+					      || (_pass.do_land_start_index > _pass.landing_approach_index))) {
+		addDiagnostic(_pass.do_land_start_index, Diagnostic::LAND_START_INVALID);
+	}
+}
 
-						} else {
-							/* Landing waypoint is above last waypoint */
-							mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: landing above last waypoint.");
-							return false;
-						}
+void
+MissionFeasibilityChecker::checkDistanceToFirstWaypoint(const mission_item_s &item, size_t index)
+{
+	/* param not set, check is ok */
+	if (_pass.max_distance_to_1st_waypoint <= 0.0f || _pass.first_waypoint_checked) {
+		return;
+	}
 
-					} else {
-						/* Last wp is in flare region */
-						mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: waypoint within landing flare.");
-						return false;
-					}
+	/* check only the first item with valid lat/lon */
+	if (!MissionBlock::item_contains_position(item)) {
+		return;
+	}
 
-					landing_valid = true;
+	_pass.first_waypoint_checked = true;
 
-				} else {
-					// mission item before land doesn't have a position
-					mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: need landing approach.");
-					return false;
-				}
+	/* check distance from current position to item */
+	const float dist_to_1wp = get_distance_to_next_waypoint(
+					  item.lat, item.lon,
+					  _navigator->get_home_position()->lat, _navigator->get_home_position()->lon);
 
-			} else {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with land waypoint.");
-				return false;
-			}
-		}
+	if (dist_to_1wp >= _pass.max_distance_to_1st_waypoint) {
+		/* item is too far from home */
+		_pass.mission_warning = true;
+		addDiagnostic(index, Diagnostic::FIRST_WAYPOINT_TOO_FAR, false, (int32_t)dist_to_1wp,
+			      (int32_t)_pass.max_distance_to_1st_waypoint);
 	}
+}
 
-	if (land_start_req && !land_start_found) {
-		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: land start required.");
-		return false;
+void
+MissionFeasibilityChecker::checkDistancesBetweenWaypoints(const mission_item_s &item, size_t index)
+{
+	/* param not set, check is ok */
+	if (_pass.max_distance_between_waypoints <= 0.0f) {
+		return;
 	}
 
-	if (land_start_found && (!landing_valid || (do_land_start_index > landing_approach_index))) {
-		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: invalid land start.");
-		return false;
+	/* check only items with valid lat/lon */
+	if (!MissionBlock::item_contains_position(item)) {
+		return;
+	}
+
+	/* Compare it to last waypoint if already available. */
+	if (PX4_ISFINITE(_pass.last_lat) && PX4_ISFINITE(_pass.last_lon)) {
+
+		/* check distance from current position to item */
+		const float dist_between_waypoints = get_distance_to_next_waypoint(
+				item.lat, item.lon,
+				_pass.last_lat, _pass.last_lon);
+
+		if (dist_between_waypoints > _pass.max_distance_between_waypoints) {
+			_pass.mission_warning = true;
+			addDiagnostic(index, Diagnostic::WAYPOINTS_TOO_FAR_APART, false, (int32_t)dist_between_waypoints,
+				      (int32_t)_pass.max_distance_between_waypoints);
+		}
 	}
 
-	/* No landing waypoints or no waypoints */
-	return true;
+	_pass.last_lat = item.lat;
+	_pass.last_lon = item.lon;
 }
 
-bool
-MissionFeasibilityChecker::checkDistanceToFirstWaypoint(const mission_s &mission, float max_distance)
+void
+MissionFeasibilityChecker::reportDiagnostic(const ItemDiagnostic &diagnostic)
 {
-	if (max_distance <= 0.0f) {
-		/* param not set, check is ok */
-		return true;
+	orb_advert_t *mavlink_log_pub = _navigator->get_mavlink_log_pub();
+	const int item = diagnostic.index + 1;
+
+	switch (diagnostic.diagnostic) {
+	case Diagnostic::READ_FAILED:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: Cannot access SD card");
+		break;
+
+	case Diagnostic::UNSUPPORTED_COMMAND:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: item %i: unsupported cmd: %d", item,
+				     (int)diagnostic.value);
+		break;
+
+	case Diagnostic::ACTUATOR_NUMBER:
+		mavlink_log_critical(mavlink_log_pub, "Actuator number %d is out of bounds 0..5", (int)diagnostic.value);
+		break;
+
+	case Diagnostic::ACTUATOR_VALUE:
+		mavlink_log_critical(mavlink_log_pub, "Actuator value %d is out of bounds -PWM_DEFAULT_MAX..PWM_DEFAULT_MAX",
+				     (int)diagnostic.value);
+		break;
+
+	case Diagnostic::STARTS_WITH_LANDING:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: starts with landing");
+		break;
+
+	case Diagnostic::FIRST_WAYPOINT_TOO_FAR:
+		mavlink_log_critical(mavlink_log_pub, "First waypoint too far away: %d meters, %d max.",
+				     (int)diagnostic.value, (int)diagnostic.limit);
+		break;
+
+	case Diagnostic::WAYPOINTS_TOO_FAR_APART:
+		mavlink_log_critical(mavlink_log_pub, "Distance between waypoints too far: %d meters, %d max.",
+				     (int)diagnostic.value, (int)diagnostic.limit);
+		break;
+
+	case Diagnostic::GEOFENCE_HOME_REQUIRED:
+		mavlink_log_critical(mavlink_log_pub, "Geofence requires valid home position");
+		break;
+
+	case Diagnostic::GEOFENCE_VIOLATION:
+		mavlink_log_critical(mavlink_log_pub, "Geofence violation for waypoint %d", item);
+		break;
+
+	case Diagnostic::BELOW_HOME:
+		mavlink_log_critical(mavlink_log_pub, "Warning: Waypoint %d below home", item);
+		break;
+
+	case Diagnostic::TAKEOFF_TOO_LOW:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: Takeoff altitude too low!");
+		break;
+
+	case Diagnostic::MULTIPLE_LAND_START:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: more than one land start.");
+		break;
+
+	case Diagnostic::LANDING_SLOPE:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: adjust landing approach.");
+		mavlink_log_critical(mavlink_log_pub, "Move down %d m or move further away by %d m.",
+				     (int)diagnostic.value, (int)diagnostic.limit);
+		break;
+
+	case Diagnostic::LANDING_ABOVE_APPROACH:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: landing above last waypoint.");
+		break;
+
+	case Diagnostic::LANDING_IN_FLARE:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: waypoint within landing flare.");
+		break;
+
+	case Diagnostic::LANDING_NO_APPROACH:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: need landing approach.");
+		break;
+
+	case Diagnostic::STARTS_WITH_LAND:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: starts with land waypoint.");
+		break;
+
+	case Diagnostic::LAND_START_REQUIRED:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: land start required.");
+		break;
+
+	case Diagnostic::LAND_START_INVALID:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: invalid land start.");
+		break;
+
+	case Diagnostic::INVALID_SURVEY:
+		mavlink_log_critical(mavlink_log_pub, "Mission rejected: item %i: invalid survey, %d vertices.", item,
+				     (int)diagnostic.value);
+		break;
 	}
+}
 
-	/* find first waypoint (with lat/lon) item in datamanager */
-	for (size_t i = 0; i < mission.count; i++) {
+const char *
+MissionFeasibilityChecker::diagnosticString(Diagnostic diagnostic)
+{
+	switch (diagnostic) {
+	case Diagnostic::READ_FAILED: return "read failed";
 
-		struct mission_item_s mission_item {};
+	case Diagnostic::UNSUPPORTED_COMMAND: return "unsupported command";
 
-		if (!(dm_read((dm_item_t)mission.dataman_id, i, &mission_item, sizeof(mission_item_s)) == sizeof(mission_item_s))) {
-			/* error reading, mission is invalid */
-			mavlink_log_info(_navigator->get_mavlink_log_pub(), "Error reading offboard mission.");
-			return false;
-		}
+	case Diagnostic::ACTUATOR_NUMBER: return "actuator number out of bounds";
 
-		/* check only items with valid lat/lon */
-		if (!MissionBlock::item_contains_position(mission_item)) {
-			continue;
-		}
+	case Diagnostic::ACTUATOR_VALUE: return "actuator value out of bounds";
 
-		/* check distance from current position to item */
-		float dist_to_1wp = get_distance_to_next_waypoint(
-					    mission_item.lat, mission_item.lon,
-					    _navigator->get_home_position()->lat, _navigator->get_home_position()->lon);
+	case Diagnostic::STARTS_WITH_LANDING: return "starts with landing";
 
-		if (dist_to_1wp < max_distance) {
+	case Diagnostic::FIRST_WAYPOINT_TOO_FAR: return "first waypoint too far";
 
-			return true;
+	case Diagnostic::WAYPOINTS_TOO_FAR_APART: return "waypoints too far apart";
 
-		} else {
-			/* item is too far from home */
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-					     "First waypoint too far away: %d meters, %d max.",
-					     (int)dist_to_1wp, (int)max_distance);
+	case Diagnostic::GEOFENCE_HOME_REQUIRED: return "geofence requires home";
 
-			_navigator->get_mission_result()->warning = true;
-			return false;
-		}
-	}
+	case Diagnostic::GEOFENCE_VIOLATION: return "geofence violation";
 
-	/* no waypoints found in mission, then we will not fly far away */
-	return true;
-}
+	case Diagnostic::BELOW_HOME: return "below home";
 
-bool
-MissionFeasibilityChecker::checkDistancesBetweenWaypoints(const mission_s &mission, float max_distance)
-{
-	if (max_distance <= 0.0f) {
-		/* param not set, check is ok */
-		return true;
-	}
+	case Diagnostic::TAKEOFF_TOO_LOW: return "takeoff too low";
 
-	double last_lat = (double)NAN;
-	double last_lon = (double)NAN;
+	case Diagnostic::MULTIPLE_LAND_START: return "more than one land start";
 
-	/* Go through all waypoints */
-	for (size_t i = 0; i < mission.count; i++) {
+	case Diagnostic::LANDING_SLOPE: return "landing approach too steep";
 
-		struct mission_item_s mission_item {};
+	case Diagnostic::LANDING_ABOVE_APPROACH: return "landing above approach";
 
-		if (!(dm_read((dm_item_t)mission.dataman_id, i, &mission_item, sizeof(mission_item_s)) == sizeof(mission_item_s))) {
-			/* error reading, mission is invalid */
-			mavlink_log_info(_navigator->get_mavlink_log_pub(), "Error reading offboard mission.");
-			return false;
-		}
+	case Diagnostic::LANDING_IN_FLARE: return "approach within landing flare";
 
-		/* check only items with valid lat/lon */
-		if (!MissionBlock::item_contains_position(mission_item)) {
-			continue;
-		}
+	case Diagnostic::LANDING_NO_APPROACH: return "no landing approach";
 
-		/* Compare it to last waypoint if already available. */
-		if (PX4_ISFINITE(last_lat) && PX4_ISFINITE(last_lon)) {
+	case Diagnostic::STARTS_WITH_LAND: return "starts with land";
 
-			/* check distance from current position to item */
-			const float dist_between_waypoints = get_distance_to_next_waypoint(
-					mission_item.lat, mission_item.lon,
-					last_lat, last_lon);
+	case Diagnostic::LAND_START_REQUIRED: return "land start required";
 
-			if (dist_between_waypoints > max_distance) {
-				/* item is too far from home */
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "Distance between waypoints too far: %d meters, %d max.",
-						     (int)dist_between_waypoints, (int)max_distance);
+	case Diagnostic::LAND_START_INVALID: return "invalid land start";
 
-				_navigator->get_mission_result()->warning = true;
-				return false;
-			}
-		}
+	case Diagnostic::INVALID_SURVEY: return "invalid survey";
+	}
 
-		last_lat = mission_item.lat;
-		last_lon = mission_item.lon;
+	return "unknown";
+}
+
+void
+MissionFeasibilityChecker::printDiagnostics() const
+{
+	perf_print_counter(_check_perf);
+
+	for (int i = 0; i < math::min(_diagnostics_count, MAX_DIAGNOSTICS); i++) {
+		const ItemDiagnostic &diagnostic = _diagnostics[i];
+		PX4_INFO("item %d: %s: %s (%d, %d)", diagnostic.index + 1, diagnostic.warning ? "warning" : "error",
+			 diagnosticString(diagnostic.diagnostic), (int)diagnostic.value, (int)diagnostic.limit);
 	}
 
-	/* We ran through all waypoints and have not found any distances between waypoints that are too far. */
-	return true;
+	if (_diagnostics_count > MAX_DIAGNOSTICS) {
+		PX4_INFO("%d more", _diagnostics_count - MAX_DIAGNOSTICS);
+	}
 }
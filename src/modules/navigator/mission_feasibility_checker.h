@@ -41,38 +41,55 @@
 
 #pragma once
 
+#include "survey_pattern.h"
+
 #include <dataman/dataman.h>
+#include <lib/perf/perf_counter.h>
 #include <uORB/topics/mission.h>
+#include <uORB/topics/position_controller_landing_status.h>
 
 class Geofence;
 class Navigator;
 
 class MissionFeasibilityChecker
 {
-private:
-	Navigator *_navigator{nullptr};
-
-	/* Checks for all airframes */
-	bool checkGeofence(const mission_s &mission, float home_alt, bool home_valid);
-
-	bool checkHomePositionAltitude(const mission_s &mission, float home_alt, bool home_alt_valid, bool throw_error);
-
-	bool checkMissionItemValidity(const mission_s &mission);
-
-	bool checkDistanceToFirstWaypoint(const mission_s &mission, float max_distance);
-	bool checkDistancesBetweenWaypoints(const mission_s &mission, float max_distance);
+public:
+	/** Reason for rejecting a mission item, or warning about it */
+	enum class Diagnostic : uint8_t {
+		READ_FAILED,			///< dataman read failed
+		UNSUPPORTED_COMMAND,		///< value: nav_cmd
+		ACTUATOR_NUMBER,		///< value: actuator number
+		ACTUATOR_VALUE,			///< value: actuator value
+		STARTS_WITH_LANDING,		///< mission starts with a landing while landed
+		FIRST_WAYPOINT_TOO_FAR,		///< value: distance [m], limit: max distance [m]
+		WAYPOINTS_TOO_FAR_APART,	///< value: distance [m], limit: max distance [m]
+		GEOFENCE_HOME_REQUIRED,		///< relative altitude and geofence without valid home
+		GEOFENCE_VIOLATION,
+		BELOW_HOME,
+		TAKEOFF_TOO_LOW,
+		MULTIPLE_LAND_START,
+		LANDING_SLOPE,			///< value: altitude to descend [m], limit: distance to add [m]
+		LANDING_ABOVE_APPROACH,
+		LANDING_IN_FLARE,
+		LANDING_NO_APPROACH,
+		STARTS_WITH_LAND,
+		LAND_START_REQUIRED,		///< reported for the last item
+		LAND_START_INVALID,		///< reported for the land start item
+		INVALID_SURVEY,			///< value: vertex count
+	};
 
-	/* Checks specific to fixedwing airframes */
-	bool checkFixedwing(const mission_s &mission, float home_alt, bool home_alt_valid, bool land_start_req);
-	bool checkFixedWingTakeoff(const mission_s &mission, float home_alt, bool home_alt_valid);
-	bool checkFixedWingLanding(const mission_s &mission, bool land_start_req);
+	struct ItemDiagnostic {
+		uint16_t index;			///< mission item index, starting at 0
+		Diagnostic diagnostic;
+		bool warning;			///< true if the item is accepted, but potentially problematic
+		int32_t value;
+		int32_t limit;
+	};
 
-	/* Checks specific to rotarywing airframes */
-	bool checkRotarywing(const mission_s &mission, float home_alt, bool home_alt_valid);
+	static constexpr int MAX_DIAGNOSTICS = 8;
 
-public:
-	MissionFeasibilityChecker(Navigator *navigator) : _navigator(navigator) {}
-	~MissionFeasibilityChecker() = default;
+	MissionFeasibilityChecker(Navigator *navigator);
+	~MissionFeasibilityChecker();
 
 	MissionFeasibilityChecker(const MissionFeasibilityChecker &) = delete;
 	MissionFeasibilityChecker &operator=(const MissionFeasibilityChecker &) = delete;
@@ -84,5 +101,84 @@ public:
 				  float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
 				  bool land_start_req);
 
-};
+	/**
+	 * Time checkMissionFeasible() on a synthetic survey mission around home, written to the
+	 * onboard mission storage of dataman first. The result is reported like for an uploaded mission.
+	 * @param count number of mission items, at most DM_KEY_WAYPOINTS_ONBOARD_MAX
+	 */
+	void benchmark(unsigned count, float max_distance_to_1st_waypoint, float max_distance_between_waypoints);
+
+	/** diagnostics of the last check, the first MAX_DIAGNOSTICS are stored */
+	int diagnosticsCount() const { return _diagnostics_count; }
+	const ItemDiagnostic &diagnostic(int i) const { return _diagnostics[i]; }
+
+	void printDiagnostics() const;
+
+private:
+	Navigator *_navigator{nullptr};
 
+	perf_counter_t _check_perf;
+
+	/* settings and state of the checks during a pass through the mission items */
+	struct Pass {
+		float home_alt;
+		bool home_valid;
+		bool rotary_wing;
+		bool geofence_valid;
+		float max_distance_to_1st_waypoint;
+		float max_distance_between_waypoints;
+		bool land_start_req;
+		position_controller_landing_status_s landing_status;
+
+		bool mission_warning;
+		bool first_waypoint_checked;
+		bool home_alt_checked;
+		double last_lat;
+		double last_lon;
+		mission_item_s previous_item;
+
+		bool land_start_found;
+		size_t do_land_start_index;
+		size_t landing_approach_index;
+		bool landing_valid;
+
+		uint16_t survey_vertex_count;
+		int survey_vertices_left;
+		SurveyPattern survey;		///< polygon being read, its waypoints are checked once complete
+	};
+
+	Pass _pass{};
+
+	ItemDiagnostic _diagnostics[MAX_DIAGNOSTICS] {};
+	int _diagnostics_count{0};
+	int _errors_count{0};
+
+	void beginPass(float max_distance_to_1st_waypoint, float max_distance_between_waypoints, bool land_start_req);
+
+	/* run all checks on one item, items need to be passed in mission order */
+	void checkItem(const mission_item_s &item, size_t index);
+
+	/* checks that need the whole mission */
+	void endPass(size_t count);
+
+	void addDiagnostic(size_t index, Diagnostic diagnostic, bool warning = false, int32_t value = 0, int32_t limit = 0);
+
+	void reportDiagnostic(const ItemDiagnostic &diagnostic);
+
+	static const char *diagnosticString(Diagnostic diagnostic);
+
+	/* Checks for all airframes */
+	void checkGeofence(const mission_item_s &item, size_t index);
+	void checkHomePositionAltitude(const mission_item_s &item, size_t index);
+	void checkMissionItemValidity(const mission_item_s &item, size_t index);
+	void checkDistanceToFirstWaypoint(const mission_item_s &item, size_t index);
+	void checkDistancesBetweenWaypoints(const mission_item_s &item, size_t index);
+	void checkSurvey(const mission_item_s &item, size_t index);
+
+	/* Check of the takeoff altitude, with the acceptance radius depending on the airframe */
+	void checkTakeoff(const mission_item_s &item, size_t index);
+
+	/* Checks specific to fixedwing airframes */
+	void checkFixedWingLanding(const mission_item_s &item, size_t index);
+	void checkFixedWingLandStart(size_t count);
+};
@@ -94,6 +94,7 @@ enum NAV_CMD {
 	NAV_CMD_FENCE_POLYGON_VERTEX_EXCLUSION = 5002,
 	NAV_CMD_FENCE_CIRCLE_INCLUSION = 5003,
 	NAV_CMD_FENCE_CIRCLE_EXCLUSION = 5004,
+	NAV_CMD_SURVEY = 31000, /* survey polygon vertex, expanded on board (MAV_CMD_WAYPOINT_USER_1) */
 	NAV_CMD_INVALID = UINT16_MAX /* ensure that casting a large number results in a specific error */
 };
 
@@ -141,9 +142,13 @@ struct mission_item_s {
 				float time_inside;		/**< time that the MAV should stay inside the radius before advancing in seconds */
 				float pitch_min;		/**< minimal pitch angle for fixed wing takeoff waypoints */
 				float circle_radius;		/**< geofence circle radius in meters (only used for NAV_CMD_NAV_FENCE_CIRCLE*) */
+				float survey_spacing;		/**< distance between survey lanes in meters (only used for NAV_CMD_SURVEY) */
 			};
 			float acceptance_radius;	/**< default radius in which the mission is accepted as reached in meters */
-			float loiter_radius;		/**< loiter radius in meters, 0 for a VTOL to hover, negative for counter-clockwise */
+			union {
+				float loiter_radius;		/**< loiter radius in meters, 0 for a VTOL to hover, negative for counter-clockwise */
+				float survey_direction;		/**< survey lane direction in radians from north 0..2PI (only used for NAV_CMD_SURVEY) */
+			};
 			float yaw;					/**< in radians NED -PI..+PI, NAN means don't change yaw		*/
 			float ___lat_float;			/**< padding */
 			float ___lon_float;			/**< padding */
@@ -156,7 +161,7 @@ struct mission_item_s {
 	uint16_t do_jump_repeat_count;		/**< how many times do jump needs to be done            */
 	union {
 		uint16_t do_jump_current_count;		/**< count how many times the jump has been done	*/
-		uint16_t vertex_count;			/**< Polygon vertex count (geofence)	*/
+		uint16_t vertex_count;			/**< Polygon vertex count (geofence and survey)	*/
 		uint16_t land_precision;		/**< Defines if landing should be precise: 0 = normal landing, 1 = opportunistic precision landing, 2 = required precision landing (with search)	*/
 	};
 	struct {
@@ -824,6 +824,7 @@ Navigator::print_status()
 	PX4_INFO("Running");
 
 	_geofence.printStatus();
+	_mission.print_status();
 	return 0;
 }
 
@@ -1200,12 +1201,20 @@ The member `_navigation_mode` contains the current active mode.
 Navigator publishes position setpoint triplets (`position_setpoint_triplet_s`), which are then used by the position
 controller.
 
+`navigator status` and `navigator mission_bench` run in the shell and read the navigator state (home position,
+vehicle status, geofence, mission diagnostics) without synchronization with the navigator task, so they may show a
+mix of old and new values while navigator updates them. mission_bench writes its mission to the onboard mission
+storage of dataman and reports the result to the GCS like for an uploaded mission: it is meant for the ground.
+
 )DESCR_STR");
 
 	PRINT_MODULE_USAGE_NAME("navigator", "controller");
 	PRINT_MODULE_USAGE_COMMAND("start");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("fencefile", "load a geofence file from SD card, stored at etc/geofence.txt");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("fake_traffic", "publishes 3 fake transponder_report_s uORB messages");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("mission_bench",
+					 "time the mission feasibility check on a synthetic survey mission in dataman");
+	PRINT_MODULE_USAGE_ARG("<count>", "number of mission items (default 2000)", true);
 	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
 
 	return 0;
@@ -1227,6 +1236,17 @@ int Navigator::custom_command(int argc, char *argv[])
 		get_instance()->fake_traffic("LX55", 1000, 0, 0, 100.0f, 90.0f, 0.001f);
 		get_instance()->fake_traffic("LX20", 15000, 1.0f, -1.0f, 280.0f, 90.0f, 0.001f);
 		return 0;
+
+	} else if (!strcmp(argv[0], "mission_bench")) {
+		const int count = (argc > 1) ? atoi(argv[1]) : 2000;
+
+		if (count < 3) {
+			print_usage("count needs to be at least 3");
+			return 1;
+		}
+
+		get_instance()->_mission.benchmark_feasibility_check(count);
+		return 0;
 	}
 
 	return print_usage("unknown command");
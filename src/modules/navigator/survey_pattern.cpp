@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file survey_pattern.cpp
+ *
+ * Survey pattern generation. The lanes run along the survey direction and are spread
+ * evenly across the polygon, so the actual lane distance is at most the requested
+ * spacing. Consecutive lanes are flown in opposite directions. For concave polygons
+ * each lane spans the outermost polygon edges it crosses.
+ */
+
+#include "survey_pattern.h"
+
+#include <mathlib/mathlib.h>
+#include <px4_defines.h>
+
+#include <float.h>
+#include <math.h>
+
+static bool read_item(dm_item_t dm_item, int index, mission_item_s &item)
+{
+	const ssize_t len = sizeof(mission_item_s);
+	return dm_read(dm_item, index, &item, len) == len;
+}
+
+bool
+SurveyPattern::itemValid(const mission_item_s &item)
+{
+	return item.nav_cmd == NAV_CMD_SURVEY &&
+	       item.vertex_count >= 3 && item.vertex_count <= MAX_VERTICES &&
+	       PX4_ISFINITE(item.survey_spacing) && item.survey_spacing > FLT_EPSILON &&
+	       PX4_ISFINITE(item.survey_direction);
+}
+
+bool
+SurveyPattern::load(dm_item_t dm_item, int index, int mission_count)
+{
+	reset();
+
+	if (index < 0 || index >= mission_count) {
+		return false;
+	}
+
+	mission_item_s item{};
+
+	// walk back to the start of the run of survey items, it can contain several polygons
+	int first = index;
+
+	while (first > 0 && read_item(dm_item, first - 1, item) && item.nav_cmd == NAV_CMD_SURVEY) {
+		first--;
+	}
+
+	// find the polygon that contains index
+	for (;;) {
+		if (!read_item(dm_item, first, item) || !itemValid(item)) {
+			return false;
+		}
+
+		if (index < first + item.vertex_count) {
+			break;
+		}
+
+		first += item.vertex_count;
+	}
+
+	if (!begin(item, first) || nextIndex() > mission_count) {
+		return false;
+	}
+
+	for (int i = 0; i < _vertex_count; i++) {
+		if ((i > 0 && !read_item(dm_item, first + i, item)) || !addVertex(item)) {
+			return false;
+		}
+	}
+
+	return complete();
+}
+
+bool
+SurveyPattern::begin(const mission_item_s &first_vertex, int first_index)
+{
+	reset();
+
+	if (!itemValid(first_vertex)) {
+		return false;
+	}
+
+	_header = first_vertex;
+	_first_index = first_index;
+	_vertex_count = first_vertex.vertex_count;
+
+	map_projection_init(&_ref, _header.lat, _header.lon);
+	_cos_dir = cosf(_header.survey_direction);
+	_sin_dir = sinf(_header.survey_direction);
+
+	return true;
+}
+
+bool
+SurveyPattern::addVertex(const mission_item_s &item)
+{
+	if (_vertices_added >= _vertex_count || item.nav_cmd != NAV_CMD_SURVEY || item.vertex_count != _vertex_count) {
+		return false;
+	}
+
+	float north;
+	float east;
+	map_projection_project(&_ref, item.lat, item.lon, &north, &east);
+	toLaneFrame(north, east, _u[_vertices_added], _v[_vertices_added]);
+	_vertices_added++;
+
+	return true;
+}
+
+bool
+SurveyPattern::complete()
+{
+	if (_vertex_count == 0 || _vertices_added != _vertex_count) {
+		return false;
+	}
+
+	float v_max = -FLT_MAX;
+	_v_min = FLT_MAX;
+
+	for (int i = 0; i < _vertex_count; i++) {
+		_v_min = fminf(_v_min, _v[i]);
+		v_max = fmaxf(v_max, _v[i]);
+	}
+
+	const float width = v_max - _v_min;
+
+	if (!(width > FLT_EPSILON)) {
+		// all vertices on one line
+		return false;
+	}
+
+	// a polygon a multiple of the spacing wide must not get an extra lane from projection rounding
+	_lane_count = math::max((int)ceilf(width / _header.survey_spacing - 0.01f), 1);
+	_lane_spacing = width / _lane_count;
+	_valid = true;
+
+	return true;
+}
+
+void
+SurveyPattern::toLaneFrame(float north, float east, float &u, float &v) const
+{
+	u = north * _cos_dir + east * _sin_dir;
+	v = -north * _sin_dir + east * _cos_dir;
+}
+
+bool
+SurveyPattern::laneExtent(float v, float &u_min, float &u_max) const
+{
+	u_min = FLT_MAX;
+	u_max = -FLT_MAX;
+
+	for (int i = 0; i < _vertex_count; i++) {
+		const int j = (i + 1) % _vertex_count;
+
+		// the edge crosses the lane (half open so a vertex on the lane counts once)
+		if ((_v[i] <= v) != (_v[j] <= v)) {
+			const float u = _u[i] + (v - _v[i]) * (_u[j] - _u[i]) / (_v[j] - _v[i]);
+			u_min = fminf(u_min, u);
+			u_max = fmaxf(u_max, u);
+		}
+	}
+
+	return u_min <= u_max;
+}
+
+bool
+SurveyPattern::waypoint(int i, mission_item_s &item) const
+{
+	if (!_valid || i < 0 || i >= waypointCount()) {
+		return false;
+	}
+
+	const int lane = i / 2;
+	const float v = _v_min + (lane + 0.5f) * _lane_spacing;
+
+	float u_min;
+	float u_max;
+
+	if (!laneExtent(v, u_min, u_max)) {
+		return false;
+	}
+
+	// serpentine: even lanes are flown forward, odd lanes backward
+	const bool lane_start = (i % 2 == 0);
+	const float u = (lane_start == (lane % 2 == 0)) ? u_min : u_max;
+
+	const float north = u * _cos_dir - v * _sin_dir;
+	const float east = u * _sin_dir + v * _cos_dir;
+
+	item = _header;
+	map_projection_reproject(&_ref, north, east, &item.lat, &item.lon);
+	item.nav_cmd = NAV_CMD_WAYPOINT;
+	item.time_inside = 0.f;
+	item.loiter_radius = 0.f;
+	item.yaw = NAN;
+	item.do_jump_current_count = 0;
+	item.origin = ORIGIN_ONBOARD;
+	item.autocontinue = true;
+
+	return true;
+}
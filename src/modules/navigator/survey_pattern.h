@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file survey_pattern.h
+ *
+ * Survey (lawnmower) pattern generated on board from a polygon stored in the mission.
+ *
+ * A survey is stored as a run of NAV_CMD_SURVEY items, one per polygon vertex, in the
+ * same way as the geofence polygons: every vertex carries the vertex count. The first
+ * vertex additionally holds the lane spacing, the lane direction, the altitude and the
+ * acceptance radius for the whole survey. The waypoints are never written to dataman,
+ * they are computed on the fly from the polygon while the mission is flown.
+ */
+
+#pragma once
+
+#include <dataman/dataman.h>
+#include <lib/ecl/geo/geo.h>
+
+class SurveyPattern
+{
+public:
+	static constexpr int MAX_VERTICES = 16;
+
+	SurveyPattern() = default;
+	~SurveyPattern() = default;
+
+	/**
+	 * Load the survey polygon that contains the mission item at index.
+	 * @param dm_item dataman item of the mission
+	 * @param index index of a NAV_CMD_SURVEY item of the mission
+	 * @param mission_count number of items in the mission
+	 * @return true if the polygon is valid and lanes could be generated
+	 */
+	bool load(dm_item_t dm_item, int index, int mission_count);
+
+	/**
+	 * Start a polygon without dataman, the vertices are then passed in order to addVertex().
+	 * @param first_vertex first vertex item, holds the survey parameters
+	 * @param first_index mission index of the first vertex item
+	 * @return false if the survey parameters are invalid
+	 */
+	bool begin(const mission_item_s &first_vertex, int first_index);
+
+	/**
+	 * Add the next vertex of the polygon started with begin(), starting with the first vertex.
+	 * @return false if the item does not belong to the polygon
+	 */
+	bool addVertex(const mission_item_s &item);
+
+	/**
+	 * Generate the lanes once all vertices are added.
+	 * @return true if the polygon is valid and lanes could be generated
+	 */
+	bool complete();
+
+	void reset() { _valid = false; _first_index = -1; _vertex_count = 0; _vertices_added = 0; }
+
+	bool valid() const { return _valid; }
+
+	/** index of the first vertex item of the loaded survey */
+	int firstIndex() const { return _first_index; }
+
+	/** index of the first mission item after the loaded survey */
+	int nextIndex() const { return _first_index + _vertex_count; }
+
+	bool contains(int index) const { return _valid && index >= _first_index && index < nextIndex(); }
+
+	/** number of generated waypoints, two per lane */
+	int waypointCount() const { return 2 * _lane_count; }
+
+	/**
+	 * Compute a waypoint of the pattern.
+	 * @param i waypoint index, 0..waypointCount()-1
+	 * @param item filled with a NAV_CMD_WAYPOINT mission item
+	 * @return false if i is out of range
+	 */
+	bool waypoint(int i, mission_item_s &item) const;
+
+	/** validate the parameters of a survey vertex item (shared with the feasibility checker) */
+	static bool itemValid(const mission_item_s &item);
+
+private:
+	/** rotate from the local north/east frame into the lane frame, u along and v across the lanes */
+	void toLaneFrame(float north, float east, float &u, float &v) const;
+
+	/** intersect the lane at cross offset v with the polygon, returns the extent along the lane */
+	bool laneExtent(float v, float &u_min, float &u_max) const;
+
+	mission_item_s _header{};		///< first vertex, holds the survey parameters
+
+	struct map_projection_reference_s _ref{};
+
+	float _u[MAX_VERTICES] {};		///< vertices in the lane frame [m]
+	float _v[MAX_VERTICES] {};
+
+	float _cos_dir{1.f};
+	float _sin_dir{0.f};
+	float _v_min{0.f};
+	float _lane_spacing{0.f};		///< actual spacing, spreads the lanes evenly over the polygon
+
+	int _first_index{-1};
+	int _vertex_count{0};
+	int _vertices_added{0};
+	int _lane_count{0};
+	bool _valid{false};
+};
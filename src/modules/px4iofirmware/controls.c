@@ -110,17 +110,13 @@ bool dsm_port_input(uint16_t *rssi, bool *dsm_updated, bool *st24_updated, bool
 	perf_end(c_gather_dsm);
 
 	/* get data from FD and attempt to parse with DSM and ST24 libs */
-	uint8_t st24_rssi, lost_count;
+	uint8_t st24_rssi = RC_INPUT_RSSI_MAX;
+	uint8_t lost_count;
 	uint16_t st24_channel_count = 0;
 
-	*st24_updated = false;
-
-	for (unsigned i = 0; i < n_bytes; i++) {
-		/* set updated flag if one complete packet was parsed */
-		st24_rssi = RC_INPUT_RSSI_MAX;
-		*st24_updated |= (OK == st24_decode(bytes[i], &st24_rssi, &lost_count,
-						    &st24_channel_count, r_raw_rc_values, PX4IO_RC_INPUT_CHANNELS));
-	}
+	/* set updated flag if one complete packet was parsed */
+	*st24_updated = st24_parse(bytes, n_bytes, &st24_rssi, &lost_count,
+				   &st24_channel_count, r_raw_rc_values, PX4IO_RC_INPUT_CHANNELS);
 
 	if (*st24_updated && lost_count == 0) {
 
@@ -137,18 +133,14 @@ bool dsm_port_input(uint16_t *rssi, bool *dsm_updated, bool *st24_updated, bool
 
 
 	/* get data from FD and attempt to parse with SUMD libs */
-	uint8_t sumd_rssi, sumd_rx_count;
+	uint8_t sumd_rssi = RC_INPUT_RSSI_MAX;
+	uint8_t sumd_rx_count;
 	uint16_t sumd_channel_count = 0;
 	bool sumd_failsafe_state;
 
-	*sumd_updated = false;
-
-	for (unsigned i = 0; i < n_bytes; i++) {
-		/* set updated flag if one complete packet was parsed */
-		sumd_rssi = RC_INPUT_RSSI_MAX;
-		*sumd_updated |= (OK == sumd_decode(bytes[i], &sumd_rssi, &sumd_rx_count,
-						    &sumd_channel_count, r_raw_rc_values, PX4IO_RC_INPUT_CHANNELS, &sumd_failsafe_state));
-	}
+	/* set updated flag if one complete packet was parsed */
+	*sumd_updated = sumd_parse(bytes, n_bytes, &sumd_rssi, &sumd_rx_count,
+				   &sumd_channel_count, r_raw_rc_values, PX4IO_RC_INPUT_CHANNELS, &sumd_failsafe_state);
 
 	if (*sumd_updated) {
 
@@ -171,6 +171,28 @@
 #define PX4IO_PAGE_PWM_INFO		7
 #define PX4IO_RATE_MAP_BASE			0	/* 0..CONFIG_ACTUATOR_COUNT bitmaps of PWM rate groups */
 
+/*
+ * Per-cycle snapshot, assembled at read time from the status, servo and
+ * raw RC pages so the FMU can poll everything it needs in one transaction.
+ * Older IO firmware rejects reads of this page, the FMU then falls back to
+ * reading the individual pages.
+ */
+#define PX4IO_PAGE_CYCLE		8
+#define PX4IO_P_CYCLE_FLAGS			0	/* PX4IO_P_STATUS_FLAGS */
+#define PX4IO_P_CYCLE_ALARMS			1	/* PX4IO_P_STATUS_ALARMS */
+#define PX4IO_P_CYCLE_VSERVO			2	/* PX4IO_P_STATUS_VSERVO */
+#define PX4IO_P_CYCLE_VRSSI			3	/* PX4IO_P_STATUS_VRSSI */
+#define PX4IO_P_CYCLE_MIXER			4	/* PX4IO_P_STATUS_MIXER */
+#define PX4IO_P_CYCLE_SERVOS			5	/* PX4IO_P_CYCLE_SERVO_COUNT servo outputs from here */
+#define PX4IO_P_CYCLE_SERVO_COUNT		8
+#define PX4IO_P_CYCLE_RAW_RC			(PX4IO_P_CYCLE_SERVOS + PX4IO_P_CYCLE_SERVO_COUNT) /* PX4IO_PAGE_RAW_RC_INPUT from here */
+#define PX4IO_P_CYCLE_RAW_RC_CHANNELS		9	/* number of raw RC channels included */
+#define PX4IO_P_CYCLE_COUNT			(PX4IO_P_CYCLE_RAW_RC + PX4IO_P_RAW_RC_BASE + PX4IO_P_CYCLE_RAW_RC_CHANNELS)
+
+#if (PX4IO_P_CYCLE_COUNT > (PX4IO_MAX_TRANSFER_LEN / 2) - 1)
+#error The cycle page must fit into a single transfer
+#endif
+
 /* setup page */
 #define PX4IO_PAGE_SETUP		50
 #define PX4IO_P_SETUP_FEATURES			0
@@ -400,3 +422,37 @@ crc_packet(struct IOPacket *pkt)
 
 	return c;
 }
+
+/**
+ * Assemble the PX4IO_PAGE_CYCLE snapshot.
+ *
+ * Shared between the IO firmware, which serves the page, and host-side
+ * tests, which check it against the individual page layouts.
+ *
+ * @param cycle		Destination, PX4IO_P_CYCLE_COUNT registers.
+ * @param status	PX4IO_PAGE_STATUS registers.
+ * @param servos	PX4IO_PAGE_SERVOS registers.
+ * @param servo_count	Number of valid registers in servos.
+ * @param raw_rc	PX4IO_PAGE_RAW_RC_INPUT registers, at least
+ *			PX4IO_P_RAW_RC_BASE + PX4IO_P_CYCLE_RAW_RC_CHANNELS.
+ */
+static void px4io_cycle_pack(uint16_t *cycle, const uint16_t *status, const uint16_t *servos, unsigned servo_count,
+			     const uint16_t *raw_rc) __attribute__((unused));
+static void
+px4io_cycle_pack(uint16_t *cycle, const uint16_t *status, const uint16_t *servos, unsigned servo_count,
+		 const uint16_t *raw_rc)
+{
+	cycle[PX4IO_P_CYCLE_FLAGS] = status[PX4IO_P_STATUS_FLAGS];
+	cycle[PX4IO_P_CYCLE_ALARMS] = status[PX4IO_P_STATUS_ALARMS];
+	cycle[PX4IO_P_CYCLE_VSERVO] = status[PX4IO_P_STATUS_VSERVO];
+	cycle[PX4IO_P_CYCLE_VRSSI] = status[PX4IO_P_STATUS_VRSSI];
+	cycle[PX4IO_P_CYCLE_MIXER] = status[PX4IO_P_STATUS_MIXER];
+
+	for (unsigned i = 0; i < PX4IO_P_CYCLE_SERVO_COUNT; i++) {
+		cycle[PX4IO_P_CYCLE_SERVOS + i] = (i < servo_count) ? servos[i] : 0;
+	}
+
+	for (unsigned i = 0; i < PX4IO_P_RAW_RC_BASE + PX4IO_P_CYCLE_RAW_RC_CHANNELS; i++) {
+		cycle[PX4IO_P_CYCLE_RAW_RC + i] = raw_rc[i];
+	}
+}
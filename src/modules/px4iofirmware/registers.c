@@ -137,6 +137,7 @@ uint16_t		r_page_rc_input[] = {
  *
  * PAGE 6 Raw ADC input.
  * PAGE 7 PWM rate maps.
+ * PAGE 8 Per-cycle snapshot.
  */
 uint16_t		r_page_scratch[32];
 
@@ -835,101 +836,116 @@ registers_set_one(uint8_t page, uint8_t offset, uint16_t value)
 uint8_t last_page;
 uint8_t last_offset;
 
-int
-registers_get(uint8_t page, uint8_t offset, uint16_t **values, unsigned *num_values)
+/**
+ * Refresh the ADC derived registers of the status page.
+ */
+static void
+registers_update_status(void)
 {
-#define SELECT_PAGE(_page_name)							\
-	do {									\
-		*values = (uint16_t *)&_page_name[0];				\
-		*num_values = sizeof(_page_name) / sizeof(_page_name[0]);	\
-	} while(0)
+	/* PX4IO_P_STATUS_FREEMEM */
 
-	switch (page) {
+	/* XXX PX4IO_P_STATUS_CPULOAD */
 
-	/*
-	 * Handle pages that are updated dynamically at read time.
-	 */
-	case PX4IO_PAGE_STATUS:
-		/* PX4IO_P_STATUS_FREEMEM */
-
-		/* XXX PX4IO_P_STATUS_CPULOAD */
+	/* PX4IO_P_STATUS_FLAGS maintained externally */
 
-		/* PX4IO_P_STATUS_FLAGS maintained externally */
-
-		/* PX4IO_P_STATUS_ALARMS maintained externally */
+	/* PX4IO_P_STATUS_ALARMS maintained externally */
 
 #ifdef ADC_VBATT
-		/* PX4IO_P_STATUS_VBATT */
-		{
-			/*
-			 * Coefficients here derived by measurement of the 5-16V
-			 * range on one unit, validated on sample points of another unit
-			 *
-			 * Data in Tools/tests-host/data folder.
-			 *
-			 * measured slope = 0.004585267878277 (int: 4585)
-			 * nominal theoretic slope: 0.00459340659 (int: 4593)
-			 * intercept = 0.016646394188076 (int: 16646)
-			 * nominal theoretic intercept: 0.00 (int: 0)
-			 *
-			 */
-			unsigned counts = adc_measure(ADC_VBATT);
+	/* PX4IO_P_STATUS_VBATT */
+	{
+		/*
+		 * Coefficients here derived by measurement of the 5-16V
+		 * range on one unit, validated on sample points of another unit
+		 *
+		 * Data in Tools/tests-host/data folder.
+		 *
+		 * measured slope = 0.004585267878277 (int: 4585)
+		 * nominal theoretic slope: 0.00459340659 (int: 4593)
+		 * intercept = 0.016646394188076 (int: 16646)
+		 * nominal theoretic intercept: 0.00 (int: 0)
+		 *
+		 */
+		unsigned counts = adc_measure(ADC_VBATT);
 
-			if (counts != 0xffff) {
-				unsigned mV = (166460 + (counts * 45934)) / 10000;
-				unsigned corrected = (mV * r_page_setup[PX4IO_P_SETUP_VBATT_SCALE]) / 10000;
+		if (counts != 0xffff) {
+			unsigned mV = (166460 + (counts * 45934)) / 10000;
+			unsigned corrected = (mV * r_page_setup[PX4IO_P_SETUP_VBATT_SCALE]) / 10000;
 
-				r_page_status[PX4IO_P_STATUS_VBATT] = corrected;
-			}
+			r_page_status[PX4IO_P_STATUS_VBATT] = corrected;
 		}
+	}
 
 #endif
 #ifdef ADC_IBATT
-		/* PX4IO_P_STATUS_IBATT */
-		{
-			/*
-			  note that we have no idea what sort of
-			  current sensor is attached, so we just
-			  return the raw 12 bit ADC value and let the
-			  FMU sort it out, with user selectable
-			  configuration for their sensor
-			 */
-			unsigned counts = adc_measure(ADC_IBATT);
+	/* PX4IO_P_STATUS_IBATT */
+	{
+		/*
+		  note that we have no idea what sort of
+		  current sensor is attached, so we just
+		  return the raw 12 bit ADC value and let the
+		  FMU sort it out, with user selectable
+		  configuration for their sensor
+		 */
+		unsigned counts = adc_measure(ADC_IBATT);
 
-			if (counts != 0xffff) {
-				r_page_status[PX4IO_P_STATUS_IBATT] = counts;
-			}
+		if (counts != 0xffff) {
+			r_page_status[PX4IO_P_STATUS_IBATT] = counts;
 		}
+	}
 #endif
 #ifdef ADC_VSERVO
-		/* PX4IO_P_STATUS_VSERVO */
-		{
-			unsigned counts = adc_measure(ADC_VSERVO);
-
-			if (counts != 0xffff) {
-				// use 3:1 scaling on 3.3V ADC input
-				unsigned mV = counts * 9900 / 4096;
-				r_page_status[PX4IO_P_STATUS_VSERVO] = mV;
-			}
+	/* PX4IO_P_STATUS_VSERVO */
+	{
+		unsigned counts = adc_measure(ADC_VSERVO);
+
+		if (counts != 0xffff) {
+			// use 3:1 scaling on 3.3V ADC input
+			unsigned mV = counts * 9900 / 4096;
+			r_page_status[PX4IO_P_STATUS_VSERVO] = mV;
 		}
+	}
 #endif
 #ifdef ADC_RSSI
-		/* PX4IO_P_STATUS_VRSSI */
-		{
-			unsigned counts = adc_measure(ADC_RSSI);
-
-			if (counts != 0xffff) {
-				// use 1:1 scaling on 3.3V ADC input
-				unsigned mV = counts * 3300 / 4096;
-				r_page_status[PX4IO_P_STATUS_VRSSI] = mV;
-			}
+	/* PX4IO_P_STATUS_VRSSI */
+	{
+		unsigned counts = adc_measure(ADC_RSSI);
+
+		if (counts != 0xffff) {
+			// use 1:1 scaling on 3.3V ADC input
+			unsigned mV = counts * 3300 / 4096;
+			r_page_status[PX4IO_P_STATUS_VRSSI] = mV;
 		}
+	}
 #endif
-		/* XXX PX4IO_P_STATUS_PRSSI */
+	/* XXX PX4IO_P_STATUS_PRSSI */
+}
+
+int
+registers_get(uint8_t page, uint8_t offset, uint16_t **values, unsigned *num_values)
+{
+#define SELECT_PAGE(_page_name)							\
+	do {									\
+		*values = (uint16_t *)&_page_name[0];				\
+		*num_values = sizeof(_page_name) / sizeof(_page_name[0]);	\
+	} while(0)
+
+	switch (page) {
 
+	/*
+	 * Handle pages that are updated dynamically at read time.
+	 */
+	case PX4IO_PAGE_STATUS:
+		registers_update_status();
 		SELECT_PAGE(r_page_status);
 		break;
 
+	case PX4IO_PAGE_CYCLE:
+		registers_update_status();
+		px4io_cycle_pack(r_page_scratch, (const uint16_t *)r_page_status, r_page_servos, PX4IO_SERVO_COUNT, r_page_raw_rc_input);
+		*values = &r_page_scratch[0];
+		*num_values = PX4IO_P_CYCLE_COUNT;
+		break;
+
 	case PX4IO_PAGE_RAW_ADC_INPUT:
 		memset(r_page_scratch, 0, sizeof(r_page_scratch));
 #ifdef ADC_VBATT
@@ -139,6 +139,9 @@ protected:
 
 		CompatBase *compat = nullptr;
 
+		std::vector<uint8_t> sample; ///< latest sample (only used if the log contains compact data)
+		bool sample_valid = false; ///< false until an uncompressed sample is read
+
 		// statistics
 		int error_counter = 0;
 		int publication_counter = 0;
@@ -221,6 +224,8 @@ private:
 
 	int64_t _read_until_file_position = 1ULL << 60; ///< read limit if log contains appended data
 
+	bool _compact_data = false; ///< log contains compact data messages, which are decoded into Subscription::sample
+
 	bool readFileHeader(std::ifstream &file);
 
 	/**
@@ -45,6 +45,7 @@
 #include <px4_posix.h>
 #include <px4_tasks.h>
 #include <px4_time.h>
+#include <ulog_compact/ulog_compact.h>
 
 #include <cstring>
 #include <float.h>
@@ -270,9 +271,10 @@ bool Replay::readFlagBits(std::ifstream &file, uint16_t msg_size)
 
 	// handle & validate the flags
 	bool contains_appended_data = incompat_flags[0] & ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK;
+	_compact_data = incompat_flags[0] & ULOG_INCOMPAT_FLAG0_DATA_COMPACT_MASK;
 	bool has_unknown_incompat_bits = false;
 
-	if (incompat_flags[0] & ~0x1) {
+	if (incompat_flags[0] & ~(ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK | ULOG_INCOMPAT_FLAG0_DATA_COMPACT_MASK)) {
 		has_unknown_incompat_bits = true;
 	}
 
@@ -593,8 +595,20 @@ bool Replay::nextDataMessage(std::ifstream &file, Subscription &subscription, in
 				if (msg_id == file_msg_id) {
 					if (message_header.msg_size == subscription.orb_meta->o_size_no_padding + 2) {
 						subscription.next_read_pos = cur_pos;
-						file.seekg(subscription.timestamp_offset, ios::cur);
-						file.read((char *)&subscription.next_timestamp, sizeof(subscription.next_timestamp));
+
+						if (_compact_data) {
+							// keep the sample as reference for the following compact messages
+							subscription.sample.resize(subscription.orb_meta->o_size);
+							file.read((char *)subscription.sample.data(), subscription.orb_meta->o_size_no_padding);
+							memcpy(&subscription.next_timestamp, subscription.sample.data() + subscription.timestamp_offset,
+							       sizeof(subscription.next_timestamp));
+							subscription.sample_valid = true;
+
+						} else {
+							file.seekg(subscription.timestamp_offset, ios::cur);
+							file.read((char *)&subscription.next_timestamp, sizeof(subscription.next_timestamp));
+						}
+
 						done = true;
 
 					} else { //sanity check failed!
@@ -611,6 +625,38 @@ bool Replay::nextDataMessage(std::ifstream &file, Subscription &subscription, in
 
 			break;
 
+		case (int)ULogMessageType::DATA_COMPACT:
+			file.read((char *)&file_msg_id, sizeof(file_msg_id));
+
+			if (file) {
+				const size_t length = message_header.msg_size - sizeof(file_msg_id);
+
+				if (msg_id == file_msg_id && subscription.sample_valid) {
+					_read_buffer.reserve(length);
+					file.read((char *)_read_buffer.data(), length);
+
+					// the layout is the one of the file, since the formats match (compat conversions are not supported)
+					if (file && !subscription.compat && subscription.orb_meta->o_layout &&
+					    ulog_compact::decode(subscription.orb_meta->o_layout, _read_buffer.data(), length,
+								 subscription.sample.data(), subscription.orb_meta->o_size_no_padding)) {
+						subscription.next_read_pos = cur_pos;
+						memcpy(&subscription.next_timestamp, subscription.sample.data() + subscription.timestamp_offset,
+						       sizeof(subscription.next_timestamp));
+						done = true;
+
+					} else if (file) {
+						PX4_ERR("failed to decode compact data message %s. Skipping until the next full sample",
+							subscription.orb_meta->o_name);
+						subscription.sample_valid = false;
+					}
+
+				} else {
+					file.seekg(length, ios::cur);
+				}
+			}
+
+			break;
+
 		case (int)ULogMessageType::REMOVE_LOGGED_MSG: //skip these
 		case (int)ULogMessageType::PARAMETER:
 		case (int)ULogMessageType::DROPOUT:
@@ -856,6 +902,13 @@ void Replay::readTopicDataToBuffer(const Subscription &sub, std::ifstream &repla
 	const size_t msg_read_size = sub.orb_meta->o_size_no_padding;
 	const size_t msg_write_size = sub.orb_meta->o_size;
 	_read_buffer.reserve(msg_write_size);
+
+	if (_compact_data) {
+		// already read (and decoded) by nextDataMessage()
+		memcpy(_read_buffer.data(), sub.sample.data(), msg_read_size);
+		return;
+	}
+
 	replay_file.seekg(sub.next_read_pos + (streamoff)(ULOG_MSG_HEADER_LEN + 2)); //skip header & msg id
 	replay_file.read((char *)_read_buffer.data(), msg_read_size);
 }
@@ -70,6 +70,7 @@
 #include <airspeed/airspeed.h>
 #include <parameters/param.h>
 #include <systemlib/err.h>
+#include <perf/latency_trace.h>
 #include <perf/perf_counter.h>
 #include <battery/battery.h>
 
@@ -669,6 +670,7 @@ Sensors::run()
 
 			int instance;
 			orb_publish_auto(ORB_ID(sensor_combined), &_sensor_pub, &raw, &instance, ORB_PRIO_DEFAULT);
+			latency_trace_record(LATENCY_TRACE_SENSOR_COMBINED, raw.timestamp);
 
 			if (airdata.timestamp != airdata_prev_timestamp) {
 				orb_publish_auto(ORB_ID(vehicle_air_data), &_airdata_pub, &airdata, &instance, ORB_PRIO_DEFAULT);
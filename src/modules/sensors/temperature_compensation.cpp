@@ -47,11 +47,28 @@
 namespace sensors
 {
 
+TemperatureCompensation::~TemperatureCompensation()
+{
+	for (int i = 0; i < GYRO_COUNT_MAX; ++i) {
+		delete _gyro_offset_table[i];
+	}
+
+	for (int i = 0; i < ACCEL_COUNT_MAX; ++i) {
+		delete _accel_offset_table[i];
+	}
+
+	for (int i = 0; i < BARO_COUNT_MAX; ++i) {
+		delete _baro_offset_table[i];
+	}
+}
+
 int TemperatureCompensation::initialize_parameter_handles(ParameterHandles &parameter_handles)
 {
 	char nbuf[16];
 	int ret = PX4_ERROR;
 
+	parameter_handles.lut_enable = param_find("TC_LUT_EN");
+
 	/* rate gyro calibration parameters */
 	parameter_handles.gyro_tc_enable = param_find("TC_G_ENABLE");
 	int32_t gyro_tc_enabled = 0;
@@ -162,6 +179,8 @@ int TemperatureCompensation::parameters_update(bool hil_enabled)
 		return ret;
 	}
 
+	param_get(parameter_handles.lut_enable, &_parameters.lut_enable);
+
 	/* rate gyro calibration parameters */
 	if (!hil_enabled) {
 		param_get(parameter_handles.gyro_tc_enable, &_parameters.gyro_tc_enable);
@@ -273,6 +292,23 @@ int TemperatureCompensation::parameters_update(bool hil_enabled)
 		}
 	}
 
+	const bool lut_enabled = (_parameters.lut_enable == 1);
+
+	for (unsigned j = 0; j < GYRO_COUNT_MAX; j++) {
+		update_offset_table(_gyro_offset_table[j], _parameters.gyro_cal_data[j],
+				    lut_enabled && _parameters.gyro_tc_enable == 1);
+	}
+
+	for (unsigned j = 0; j < ACCEL_COUNT_MAX; j++) {
+		update_offset_table(_accel_offset_table[j], _parameters.accel_cal_data[j],
+				    lut_enabled && _parameters.accel_tc_enable == 1);
+	}
+
+	for (unsigned j = 0; j < BARO_COUNT_MAX; j++) {
+		update_offset_table(_baro_offset_table[j], _parameters.baro_cal_data[j],
+				    lut_enabled && _parameters.baro_tc_enable == 1);
+	}
+
 	/* the offsets & scales might have changed, so make sure to report that change later when applying the
 	 * next corrections
 	 */
@@ -351,6 +387,72 @@ bool TemperatureCompensation::calc_thermal_offsets_3D(const SensorCalData3D &coe
 
 }
 
+template<int Dim, typename T>
+void TemperatureCompensation::update_offset_table(OffsetTable<Dim> *&table, T &coef, bool enabled)
+{
+	if (!enabled || coef.ID == 0 || !(coef.max_temp > coef.min_temp)) {
+		delete table;
+		table = nullptr;
+		return;
+	}
+
+	if (table == nullptr) {
+		table = new OffsetTable<Dim>;
+
+		if (table == nullptr) {
+			PX4_ERR("alloc failed");
+			return;
+		}
+	}
+
+	table->min_temp = coef.min_temp;
+	table->max_temp = coef.max_temp;
+	table->inv_step = (LUT_SIZE - 1) / (coef.max_temp - coef.min_temp);
+
+	for (int i = 0; i < LUT_SIZE; ++i) {
+		const float temperature = coef.min_temp + (coef.max_temp - coef.min_temp) * i / (LUT_SIZE - 1);
+		calc_thermal_offsets(coef, temperature, table->offset[i]);
+	}
+}
+
+template<int Dim>
+bool TemperatureCompensation::lookup_thermal_offsets(const OffsetTable<Dim> &table, float measured_temp,
+		float offset[])
+{
+	bool ret = true;
+
+	// clip the measured temperature to remain within the calibration range
+	float index;
+
+	if (measured_temp > table.max_temp) {
+		index = LUT_SIZE - 1;
+		ret = false;
+
+	} else if (!(measured_temp >= table.min_temp)) {
+		index = 0.f;
+		ret = false;
+
+	} else {
+		index = (measured_temp - table.min_temp) * table.inv_step;
+	}
+
+	// interpolate between the two closest entries
+	const int i = math::min((int)index, LUT_SIZE - 2);
+	const float fraction = index - i;
+
+	for (int axis = 0; axis < Dim; axis++) {
+		offset[axis] = table.offset[i][axis] + fraction * (table.offset[i + 1][axis] - table.offset[i][axis]);
+	}
+
+	return ret;
+}
+
+// instantiated for the unit tests as well, which are in another translation unit
+template void TemperatureCompensation::update_offset_table(OffsetTable<1> *&, SensorCalData1D &, bool);
+template void TemperatureCompensation::update_offset_table(OffsetTable<3> *&, SensorCalData3D &, bool);
+template bool TemperatureCompensation::lookup_thermal_offsets(const OffsetTable<1> &, float, float[]);
+template bool TemperatureCompensation::lookup_thermal_offsets(const OffsetTable<3> &, float, float[]);
+
 int TemperatureCompensation::set_sensor_id_gyro(uint32_t device_id, int topic_instance)
 {
 	if (_parameters.gyro_tc_enable != 1) {
@@ -405,7 +507,12 @@ int TemperatureCompensation::apply_corrections_gyro(int topic_instance, matrix::
 		return -1;
 	}
 
-	calc_thermal_offsets_3D(_parameters.gyro_cal_data[mapping], temperature, offsets);
+	if (_gyro_offset_table[mapping] != nullptr) {
+		lookup_thermal_offsets(*_gyro_offset_table[mapping], temperature, offsets);
+
+	} else {
+		calc_thermal_offsets_3D(_parameters.gyro_cal_data[mapping], temperature, offsets);
+	}
 
 	// get the sensor scale factors and correct the data
 	for (unsigned axis_index = 0; axis_index < 3; axis_index++) {
@@ -434,7 +541,12 @@ int TemperatureCompensation::apply_corrections_accel(int topic_instance, matrix:
 		return -1;
 	}
 
-	calc_thermal_offsets_3D(_parameters.accel_cal_data[mapping], temperature, offsets);
+	if (_accel_offset_table[mapping] != nullptr) {
+		lookup_thermal_offsets(*_accel_offset_table[mapping], temperature, offsets);
+
+	} else {
+		calc_thermal_offsets_3D(_parameters.accel_cal_data[mapping], temperature, offsets);
+	}
 
 	// get the sensor scale factors and correct the data
 	for (unsigned axis_index = 0; axis_index < 3; axis_index++) {
@@ -463,7 +575,12 @@ int TemperatureCompensation::apply_corrections_baro(int topic_instance, float &s
 		return -1;
 	}
 
-	calc_thermal_offsets_1D(_parameters.baro_cal_data[mapping], temperature, *offsets);
+	if (_baro_offset_table[mapping] != nullptr) {
+		lookup_thermal_offsets(*_baro_offset_table[mapping], temperature, offsets);
+
+	} else {
+		calc_thermal_offsets_1D(_parameters.baro_cal_data[mapping], temperature, *offsets);
+	}
 
 	// get the sensor scale factors and correct the data
 	*scales = _parameters.baro_cal_data[mapping].scale;
@@ -480,6 +597,7 @@ int TemperatureCompensation::apply_corrections_baro(int topic_instance, float &s
 void TemperatureCompensation::print_status()
 {
 	PX4_INFO("Temperature Compensation:");
+	PX4_INFO(" lookup table: %i", _parameters.lut_enable);
 	PX4_INFO(" gyro: enabled: %i", _parameters.gyro_tc_enable);
 
 	if (_parameters.gyro_tc_enable == 1) {
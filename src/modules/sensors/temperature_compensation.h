@@ -67,6 +67,8 @@ class TemperatureCompensation
 {
 public:
 
+	~TemperatureCompensation();
+
 	/** (re)load the parameters. Make sure to call this on startup as well */
 	int parameters_update(bool hil_enabled = false);
 
@@ -101,6 +103,7 @@ public:
 	/** output current configuration status to console */
 	void print_status();
 private:
+	friend class OffsetTableTest;
 
 	/* Struct containing parameters used by the single axis 5th order temperature compensation algorithm
 
@@ -187,6 +190,7 @@ private:
 
 	// create a struct containing all thermal calibration parameters
 	struct Parameters {
+		int32_t lut_enable;
 		int32_t gyro_tc_enable;
 		SensorCalData3D gyro_cal_data[GYRO_COUNT_MAX];
 		int32_t accel_tc_enable;
@@ -197,6 +201,7 @@ private:
 
 	// create a struct containing the handles required to access all calibration parameters
 	struct ParameterHandles {
+		param_t lut_enable;
 		param_t gyro_tc_enable;
 		SensorCalHandles3D gyro_cal_handles[GYRO_COUNT_MAX];
 		param_t accel_tc_enable;
@@ -251,9 +256,56 @@ private:
 	*/
 	bool calc_thermal_offsets_3D(const SensorCalData3D &coef, float measured_temp, float offset[]);
 
+	bool calc_thermal_offsets(SensorCalData1D &coef, float measured_temp, float offset[])
+	{
+		return calc_thermal_offsets_1D(coef, measured_temp, offset[0]);
+	}
+
+	bool calc_thermal_offsets(SensorCalData3D &coef, float measured_temp, float offset[])
+	{
+		return calc_thermal_offsets_3D(coef, measured_temp, offset);
+	}
+
+	/* Offsets precomputed from the calibration polynomial (TC_LUT_EN)
+
+	The offsets are sampled at LUT_SIZE equally spaced temperatures from min_temp to max_temp and linearly
+	interpolated in between, which replaces the polynomial evaluation per sample by a table lookup.
+	Temperatures outside of the calibration range are clipped the same way as for the polynomial.
+
+	 */
+	static constexpr int LUT_SIZE = 32;
+
+	template<int Dim>
+	struct OffsetTable {
+		float min_temp;			/**< temperature of the first entry (deg C) */
+		float max_temp;			/**< temperature of the last entry (deg C) */
+		float inv_step;			/**< inverse of the temperature step between two entries (1/deg C) */
+		float offset[LUT_SIZE][Dim];	/**< offsets at each temperature step */
+	};
+
+	/**
+	 * (re)compute the offset table of a sensor, or free it if it is not used.
+	 * @param table table to update, allocated if needed
+	 * @param coef calibration coefficients to sample
+	 * @param enabled true if the table is used for the sensor
+	 */
+	template<int Dim, typename T>
+	void update_offset_table(OffsetTable<Dim> *&table, T &coef, bool enabled);
+
+	/**
+	 * Interpolate the offsets from the table, same interface as calc_thermal_offsets_3D()
+	 * @return true if the measured temperature is inside the valid range for the compensation
+	 */
+	template<int Dim>
+	static bool lookup_thermal_offsets(const OffsetTable<Dim> &table, float measured_temp, float offset[]);
+
 
 	Parameters _parameters;
 
+	OffsetTable<3> *_gyro_offset_table[GYRO_COUNT_MAX] {}; ///< nullptr if the polynomial is evaluated
+	OffsetTable<3> *_accel_offset_table[ACCEL_COUNT_MAX] {};
+	OffsetTable<1> *_baro_offset_table[BARO_COUNT_MAX] {};
+
 
 	struct PerSensorData {
 		PerSensorData()
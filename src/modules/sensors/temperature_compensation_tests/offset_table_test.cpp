@@ -0,0 +1,250 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file offset_table_test.cpp
+ * Offset lookup table of the temperature compensation (TC_LUT_EN).
+ *
+ * The interpolated offsets are compared against the polynomial over the calibrated
+ * range, where the error of the linear interpolation is bounded by h^2/8 * max|f''|
+ * (h: temperature step of the table), and beyond both ends, where both clip.
+ */
+
+#include "offset_table_test.h"
+
+#include "../temperature_compensation.h"
+
+#include <unit_test.h>
+
+#include <float.h>
+#include <math.h>
+
+namespace sensors
+{
+
+class OffsetTableTest : public UnitTest
+{
+public:
+	OffsetTableTest() = default;
+	virtual ~OffsetTableTest() = default;
+
+	virtual bool run_tests();
+
+private:
+	static constexpr int check_points = 1000;
+
+	bool interpolation3DTest();
+	bool interpolation1DTest();
+	bool allocationTest();
+
+	/**
+	 * compare the table of coef against the polynomial
+	 * @param coefs polynomial coefficients per axis, highest order first (for the curvature bound)
+	 */
+	template<int Dim, typename T>
+	bool checkTable(T &coef, const float coefs[Dim][6], int count);
+
+	TemperatureCompensation _temperature_compensation;
+};
+
+template<int Dim, typename T>
+bool OffsetTableTest::checkTable(T &coef, const float coefs[Dim][6], int count)
+{
+	TemperatureCompensation::OffsetTable<Dim> *table = nullptr;
+	_temperature_compensation.update_offset_table(table, coef, true);
+	ut_assert("table allocated", table != nullptr);
+
+	// max|f''| over the calibrated range, with |delta_temp| <= delta_max for each term
+	const float delta_max = fmaxf(fabsf(coef.min_temp - coef.ref_temp), fabsf(coef.max_temp - coef.ref_temp));
+	const float step = (coef.max_temp - coef.min_temp) / (TemperatureCompensation::LUT_SIZE - 1);
+	float bound[Dim];
+
+	for (int axis = 0; axis < Dim; axis++) {
+		float curvature = 0.f;
+
+		for (int i = 0; i < count - 2; i++) {
+			const int power = count - 1 - i;
+			curvature += power * (power - 1) * fabsf(coefs[axis][i]) * powf(delta_max, power - 2);
+		}
+
+		bound[axis] = step * step / 8.f * curvature;
+	}
+
+	bool success = true;
+
+	// calibrated range, including both ends
+	for (int i = 0; i <= check_points && success; i++) {
+		const float temperature = coef.min_temp + (coef.max_temp - coef.min_temp) * i / check_points;
+		float expected[Dim];
+		float offset[Dim];
+		_temperature_compensation.calc_thermal_offsets(coef, temperature, expected);
+		success = TemperatureCompensation::lookup_thermal_offsets(*table, temperature, offset);
+
+		for (int axis = 0; axis < Dim && success; axis++) {
+			// float rounding of the table entries and of the interpolation
+			const float tolerance = bound[axis] + 8.f * FLT_EPSILON * (fabsf(expected[axis]) + 1.f);
+			success = fabsf(offset[axis] - expected[axis]) <= tolerance;
+
+			if (!success) {
+				PX4_ERR("%.3f deg C axis %d: %.9g, expected %.9g +- %.3g", (double)temperature, axis,
+					(double)offset[axis], (double)expected[axis], (double)tolerance);
+			}
+		}
+	}
+
+	// clipped beyond both ends
+	const float outside[] = {coef.min_temp - 0.01f, coef.min_temp - 20.f, coef.max_temp + 0.01f, coef.max_temp + 20.f};
+
+	for (unsigned i = 0; i < sizeof(outside) / sizeof(outside[0]) && success; i++) {
+		float expected[Dim];
+		float offset[Dim];
+		const bool expected_valid = _temperature_compensation.calc_thermal_offsets(coef, outside[i], expected);
+		const bool valid = TemperatureCompensation::lookup_thermal_offsets(*table, outside[i], offset);
+		success = !valid && !expected_valid;
+
+		for (int axis = 0; axis < Dim && success; axis++) {
+			success = fabsf(offset[axis] - expected[axis]) <= 8.f * FLT_EPSILON * (fabsf(expected[axis]) + 1.f);
+
+			if (!success) {
+				PX4_ERR("%.3f deg C axis %d: %.9g, expected %.9g", (double)outside[i], axis,
+					(double)offset[axis], (double)expected[axis]);
+			}
+		}
+	}
+
+	delete table;
+
+	ut_assert("table matches the polynomial", success);
+	return true;
+}
+
+bool OffsetTableTest::interpolation3DTest()
+{
+	// typical gyro coefficients [rad/s], 3rd order
+	static const float coefs[3][6] = {
+		{2e-7f, -1.5e-5f, 8e-4f, 0.012f},
+		{-1e-7f, 3e-5f, -5e-4f, -0.004f},
+		{5e-8f, 1e-6f, 2e-4f, 0.f},
+	};
+
+	TemperatureCompensation::SensorCalData3D coef{};
+	coef.ID = 1;
+	coef.ref_temp = 25.f;
+	coef.min_temp = -10.f;
+	coef.max_temp = 60.f;
+
+	for (int axis = 0; axis < 3; axis++) {
+		coef.x3[axis] = coefs[axis][0];
+		coef.x2[axis] = coefs[axis][1];
+		coef.x1[axis] = coefs[axis][2];
+		coef.x0[axis] = coefs[axis][3];
+		coef.scale[axis] = 1.f;
+	}
+
+	return checkTable<3>(coef, coefs, 4);
+}
+
+bool OffsetTableTest::interpolation1DTest()
+{
+	// typical barometer coefficients [Pa], 5th order
+	static const float coefs[1][6] = {{1e-8f, -2e-7f, 1e-5f, -1e-3f, 2.5f, -12.f}};
+
+	TemperatureCompensation::SensorCalData1D coef{};
+	coef.ID = 1;
+	coef.x5 = coefs[0][0];
+	coef.x4 = coefs[0][1];
+	coef.x3 = coefs[0][2];
+	coef.x2 = coefs[0][3];
+	coef.x1 = coefs[0][4];
+	coef.x0 = coefs[0][5];
+	coef.scale = 1.f;
+	coef.ref_temp = 25.f;
+	coef.min_temp = 0.f;
+	coef.max_temp = 50.f;
+
+	return checkTable<1>(coef, coefs, 6);
+}
+
+bool OffsetTableTest::allocationTest()
+{
+	TemperatureCompensation::SensorCalData1D coef{};
+	coef.ID = 1;
+	coef.x1 = 1.f;
+	coef.scale = 1.f;
+	coef.ref_temp = 25.f;
+	coef.min_temp = 0.f;
+	coef.max_temp = 50.f;
+
+	TemperatureCompensation::OffsetTable<1> *table = nullptr;
+
+	// not used
+	_temperature_compensation.update_offset_table(table, coef, false);
+	ut_assert_true(table == nullptr);
+
+	_temperature_compensation.update_offset_table(table, coef, true);
+	ut_assert_true(table != nullptr);
+
+	// freed again when disabled
+	_temperature_compensation.update_offset_table(table, coef, false);
+	ut_assert_true(table == nullptr);
+
+	// no calibration for the sensor
+	coef.ID = 0;
+	_temperature_compensation.update_offset_table(table, coef, true);
+	ut_assert_true(table == nullptr);
+
+	// empty or invalid calibration range
+	coef.ID = 1;
+	coef.max_temp = coef.min_temp;
+	_temperature_compensation.update_offset_table(table, coef, true);
+	ut_assert_true(table == nullptr);
+
+	coef.max_temp = NAN;
+	_temperature_compensation.update_offset_table(table, coef, true);
+	ut_assert_true(table == nullptr);
+
+	return true;
+}
+
+bool OffsetTableTest::run_tests()
+{
+	ut_run_test(interpolation3DTest);
+	ut_run_test(interpolation1DTest);
+	ut_run_test(allocationTest);
+
+	return (_tests_failed == 0);
+}
+
+} // namespace sensors
+
+ut_declare_test(offsetTableTest, sensors::OffsetTableTest)
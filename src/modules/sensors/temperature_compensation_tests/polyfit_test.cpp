@@ -0,0 +1,267 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file polyfit_test.cpp
+ * Least squares fit of the thermal calibration (events/temperature_calibration/polyfit.hpp).
+ *
+ * Fits noisy samples of known polynomials over a synthetic temperature sweep and checks
+ * the recovered coefficients, and that sweeps which cannot determine the polynomial are
+ * rejected.
+ */
+
+#include "polyfit_test.h"
+
+#include "../../events/temperature_calibration/polyfit.hpp"
+
+#include <unit_test.h>
+
+#include <math.h>
+#include <stdint.h>
+
+class PolyfitTest : public UnitTest
+{
+public:
+	PolyfitTest() = default;
+	virtual ~PolyfitTest() = default;
+
+	virtual bool run_tests();
+
+private:
+	static constexpr int sample_count = 3000;
+
+	/** relative temperature range of the sweep [deg C] */
+	static constexpr double sweep_min = -15.0;
+	static constexpr double sweep_max = 40.0;
+
+	bool thirdOrderFitTest();
+	bool fifthOrderFitTest();
+	bool degenerateSweepTest();
+
+	/** sweep temperature of sample i, rising with some jitter like a heated sensor */
+	double temperature(int i);
+
+	double random(double min, double max);
+
+	/** coefficients highest order first, like the fit results */
+	static double evaluate(const double coef[], int count, double x);
+
+	/**
+	 * The error of each fitted term at the end of the sweep has to stay below the tolerance,
+	 * e.g. the noise amplitude so the fit is not worse than a single sample.
+	 */
+	static bool coefficientsMatch(const double fit[], const double truth[], int count, double tolerance);
+
+	/** the fitted polynomial stays within the tolerance of the true one over the sweep */
+	static bool curveMatches(const double fit[], const double truth[], int count, double tolerance);
+
+	uint32_t _seed{1};
+};
+
+double PolyfitTest::random(double min, double max)
+{
+	// deterministic LCG, the samples have to be the same on every run
+	_seed = _seed * 1664525u + 1013904223u;
+	return min + (max - min) * (double)(_seed >> 8) / (double)(1u << 24);
+}
+
+double PolyfitTest::temperature(int i)
+{
+	return sweep_min + (sweep_max - sweep_min) * i / (sample_count - 1) + random(-0.05, 0.05);
+}
+
+double PolyfitTest::evaluate(const double coef[], int count, double x)
+{
+	double y = 0.0;
+
+	for (int i = 0; i < count; i++) {
+		y = y * x + coef[i];
+	}
+
+	return y;
+}
+
+bool PolyfitTest::coefficientsMatch(const double fit[], const double truth[], int count, double tolerance)
+{
+	const double x_max = fmax(fabs(sweep_min), fabs(sweep_max));
+
+	for (int i = 0; i < count; i++) {
+		const int power = count - 1 - i;
+
+		if (!(fabs(fit[i] - truth[i]) * pow(x_max, power) < tolerance)) {
+			PX4_ERR("x%d: fit %.9g, expected %.9g", power, fit[i], truth[i]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool PolyfitTest::curveMatches(const double fit[], const double truth[], int count, double tolerance)
+{
+	for (int i = 0; i <= 100; i++) {
+		const double x = sweep_min + (sweep_max - sweep_min) * i / 100;
+		const double error = evaluate(fit, count, x) - evaluate(truth, count, x);
+
+		if (!(fabs(error) < tolerance)) {
+			PX4_ERR("x = %.2f: error %.9g", x, error);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool PolyfitTest::thirdOrderFitTest()
+{
+	// gyro offsets [rad/s] of 3 axes against the temperature, as fitted by the calibration
+	static constexpr double truth[3][4] = {
+		{2e-7, -1.5e-5, 8e-4, 0.012},
+		{-1e-7, 3e-5, -5e-4, -0.004},
+		{5e-8, 1e-6, 2e-4, 0.0},
+	};
+	static constexpr double noise = 2e-3;
+
+	polyfitter<4, 3> P;
+
+	for (int i = 0; i < sample_count; i++) {
+		const double x = temperature(i);
+		double y[3];
+
+		for (int axis = 0; axis < 3; axis++) {
+			y[axis] = evaluate(truth[axis], 4, x) + random(-noise, noise);
+		}
+
+		P.update(x, y);
+	}
+
+	for (int axis = 0; axis < 3; axis++) {
+		double res[4];
+		ut_assert_true(P.fit(axis, res));
+		ut_assert("coefficients recovered", coefficientsMatch(res, truth[axis], 4, noise));
+	}
+
+	return true;
+}
+
+bool PolyfitTest::fifthOrderFitTest()
+{
+	// barometer offset [Pa], the high powers are where an unscaled fit loses its precision
+	static constexpr double truth[6] = {1e-8, -2e-7, 1e-5, -1e-3, 2.5, -12.0};
+	static constexpr double noise = 1.0;
+
+	polyfitter<6> exact;
+	polyfitter<6> noisy;
+
+	for (int i = 0; i < sample_count; i++) {
+		const double x = temperature(i);
+		const double y = evaluate(truth, 6, x);
+		const double y_noisy = y + random(-noise, noise);
+		exact.update(x, &y);
+		noisy.update(x, &y_noisy);
+	}
+
+	double res[6];
+
+	// without noise only the numerical error of the solve remains
+	ut_assert_true(exact.fit(0, res));
+	ut_assert("coefficients recovered", coefficientsMatch(res, truth, 6, 1e-6));
+
+	// with noise the single terms of a 5th order fit are too correlated to compare them to the noise,
+	// the polynomial as a whole has to be better than the samples
+	ut_assert_true(noisy.fit(0, res));
+	ut_assert("polynomial recovered", curveMatches(res, truth, 6, noise / 4));
+
+	return true;
+}
+
+bool PolyfitTest::degenerateSweepTest()
+{
+	double res[4];
+
+	// temperature did not change
+	polyfitter<4> constant;
+
+	for (int i = 0; i < sample_count; i++) {
+		const double y = 0.01 + random(-1e-3, 1e-3);
+		constant.update(12.5, &y);
+	}
+
+	ut_assert_false(constant.fit(0, res));
+
+	// only two temperatures, not enough for a 3rd order polynomial
+	polyfitter<4> two_steps;
+
+	for (int i = 0; i < sample_count; i++) {
+		const double y = 0.01 + random(-1e-3, 1e-3);
+		two_steps.update(i < sample_count / 2 ? 10.0 : 20.0, &y);
+	}
+
+	ut_assert_false(two_steps.fit(0, res));
+
+	// all at the reference temperature
+	polyfitter<4> zero;
+
+	for (int i = 0; i < sample_count; i++) {
+		const double y = 0.01;
+		zero.update(0.0, &y);
+	}
+
+	ut_assert_false(zero.fit(0, res));
+
+	// fewer samples than coefficients
+	polyfitter<4> few;
+
+	for (int i = 0; i < 3; i++) {
+		const double y = 0.01;
+		few.update(i, &y);
+	}
+
+	ut_assert_false(few.fit(0, res));
+
+	// invalid axis
+	ut_assert_false(few.fit(1, res));
+
+	return true;
+}
+
+bool PolyfitTest::run_tests()
+{
+	ut_run_test(thirdOrderFitTest);
+	ut_run_test(fifthOrderFitTest);
+	ut_run_test(degenerateSweepTest);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test(polyfitTest, PolyfitTest)
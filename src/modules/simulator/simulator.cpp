@@ -159,6 +159,11 @@ int Simulator::start(int argc, char *argv[])
 			_instance->set_port(atoi(argv[4]));
 		}
 
+		if (argc == 5 && strcmp(argv[3], "-m") == 0) {
+			_instance->set_ip(InternetProtocol::SHM);
+			_instance->set_port(atoi(argv[4]));
+		}
+
 		if (argv[2][1] == 's') {
 			_instance->initializeSensorData();
 #ifndef __PX4_QURT
@@ -195,11 +200,13 @@ void Simulator::set_port(unsigned port)
 
 static void usage()
 {
-	PX4_WARN("Usage: simulator {start -[spt] [-u udp_port / -c tcp_port] |stop}");
+	PX4_WARN("Usage: simulator {start -[spt] [-u udp_port / -c tcp_port / -m shm_id] |stop|loopback}");
 	PX4_WARN("Simulate raw sensors:     simulator start -s");
 	PX4_WARN("Publish sensors combined: simulator start -p");
 	PX4_WARN("Connect using UDP: simulator start -u udp_port");
 	PX4_WARN("Connect using TCP: simulator start -c tcp_port");
+	PX4_WARN("Connect using shared memory: simulator start -m shm_id");
+	PX4_WARN("Shared memory stand-in simulator: simulator loopback [-m shm_id] [-r rate_hz] [-t duration_s]");
 	PX4_WARN("Dummy unit test data:     simulator start -t");
 }
 
@@ -242,11 +249,24 @@ extern "C" {
 				return 1;
 			}
 
+#ifndef __PX4_QURT
+
+		} else if (argc >= 2 && strcmp(argv[1], "loopback") == 0) {
+			return Simulator::loopback(argc - 1, argv + 1);
+#endif
+
 		} else if (argc == 2 && strcmp(argv[1], "stop") == 0) {
 			if (g_sim_task < 0) {
 				PX4_WARN("Simulator not running");
 
 			} else {
+#ifndef __PX4_QURT
+
+				if (Simulator::getInstance()) {
+					Simulator::getInstance()->stop_shm();
+				}
+
+#endif
 				px4_task_delete(g_sim_task);
 				g_sim_task = -1;
 			}
@@ -69,6 +69,10 @@
 #include <v2.0/common/mavlink.h>
 #include <lib/ecl/geo/geo.h>
 
+#ifndef __PX4_QURT
+#include "simulator_shm.h"
+#endif
+
 namespace simulator
 {
 
@@ -214,11 +218,25 @@ public:
 
 	enum class InternetProtocol {
 		TCP,
-		UDP
+		UDP,
+		SHM	///< not an internet protocol, local shared memory (see simulator_shm.h)
 	};
 
 	static int start(int argc, char *argv[]);
 
+#ifndef __PX4_QURT
+	/**
+	 * Stand-in simulator on the shared memory transport, for testing and benchmarking.
+	 */
+	static int loopback(int argc, char *argv[]);
+
+	/**
+	 * Stop the shared memory transport: the receiving task returns, and the
+	 * shared memory object is unmapped and removed. Blocks until done.
+	 */
+	void stop_shm();
+#endif
+
 	bool getRawAccelReport(uint8_t *buf, int len);
 	bool getMagReport(uint8_t *buf, int len);
 	bool getMPUReport(uint8_t *buf, int len);
@@ -390,6 +408,11 @@ private:
 	struct manual_control_setpoint_s _manual;
 	struct vehicle_status_s _vehicle_status;
 
+	struct px4_sim_shm *_shm{nullptr};
+	pthread_mutex_t _shm_mutex = PTHREAD_MUTEX_INITIALIZER;	///< guards _shm against the sending thread
+	bool _shm_should_exit{false};
+	bool _shm_closed{false};
+
 	DEFINE_PARAMETERS(
 		(ParamFloat<px4::params::SIM_BAT_DRAIN>) _battery_drain_interval_s, ///< battery drain interval
 		(ParamInt<px4::params::MAV_TYPE>) _param_system_type
@@ -402,9 +425,16 @@ private:
 	void send_heartbeat();
 	void request_hil_state_quaternion();
 	void pollForMAVLinkMessages(bool publish);
+	void pollForShmMessages(bool publish);
+	void close_shm();
+	void start_sending();
+
+	void handle_hil_sensor(mavlink_hil_sensor_t *imu, bool publish);
+	void handle_hil_gps(mavlink_hil_gps_t *gps_sim, bool publish);
 
 	void pack_actuator_message(mavlink_hil_actuator_controls_t &actuator_msg, unsigned index);
 	void send_mavlink_message(const mavlink_message_t &aMsg);
+	void send_shm_actuator_controls(const mavlink_hil_actuator_controls_t &msg, unsigned index);
 	void update_sensors(mavlink_hil_sensor_t *imu);
 	void update_gps(mavlink_hil_gps_t *gps_sim);
 	void parameters_update(bool force);
@@ -176,8 +176,14 @@ void Simulator::send_controls()
 		mavlink_hil_actuator_controls_t hil_act_control = {};
 		hil_act_control.time_usec = _actuators[i].timestamp + hrt_absolute_time_offset();
 
-		mavlink_message_t message = {};
 		pack_actuator_message(hil_act_control, i);
+
+		if (_ip == InternetProtocol::SHM) {
+			send_shm_actuator_controls(hil_act_control, i);
+			continue;
+		}
+
+		mavlink_message_t message = {};
 		mavlink_msg_hil_actuator_controls_encode(0, 200, &message, &hil_act_control);
 
 		send_mavlink_message(message);
@@ -280,70 +286,83 @@ void Simulator::update_gps(mavlink_hil_gps_t *gps_sim)
 	write_gps_data((void *)&gps);
 }
 
-void Simulator::handle_message(mavlink_message_t *msg, bool publish)
+void Simulator::handle_hil_sensor(mavlink_hil_sensor_t *imu, bool publish)
 {
-	switch (msg->msgid) {
-	case MAVLINK_MSG_ID_HIL_SENSOR: {
-			mavlink_hil_sensor_t imu;
-			mavlink_msg_hil_sensor_decode(msg, &imu);
+	// set temperature to a decent value
+	imu->temperature = 32.0f;
 
-			// set temperature to a decent value
-			imu.temperature = 32.0f;
+	struct timespec ts;
+	abstime_to_ts(&ts, imu->time_usec);
+	px4_clock_settime(CLOCK_MONOTONIC, &ts);
 
-			struct timespec ts;
-			abstime_to_ts(&ts, imu.time_usec);
-			px4_clock_settime(CLOCK_MONOTONIC, &ts);
-
-			hrt_abstime now_us = hrt_absolute_time();
+	hrt_abstime now_us = hrt_absolute_time();
 
 #if 0
-			// This is just for to debug missing HIL_SENSOR messages.
-			static hrt_abstime last_time = 0;
-			hrt_abstime diff = now_us - last_time;
-			float step = diff / 4000.0f;
+	// This is just for to debug missing HIL_SENSOR messages.
+	static hrt_abstime last_time = 0;
+	hrt_abstime diff = now_us - last_time;
+	float step = diff / 4000.0f;
 
-			if (step > 1.1f || step < 0.9f) {
-				PX4_INFO("time_usec: %lu, diff: %lu, step: %.2f", now_us, diff, step);
-			}
+	if (step > 1.1f || step < 0.9f) {
+		PX4_INFO("time_usec: %lu, diff: %lu, step: %.2f", now_us, diff, step);
+	}
 
-			last_time = now_us;
+	last_time = now_us;
 #endif
 
-			if (publish) {
-				publish_sensor_topics(&imu);
-			}
+	if (publish) {
+		publish_sensor_topics(imu);
+	}
 
-			update_sensors(&imu);
+	update_sensors(imu);
 
-			// battery simulation (limit update to 100Hz)
-			if (hrt_elapsed_time(&_battery_status.timestamp) >= 10000) {
+	// battery simulation (limit update to 100Hz)
+	if (hrt_elapsed_time(&_battery_status.timestamp) >= 10000) {
 
-				const float discharge_interval_us = _battery_drain_interval_s.get() * 1000 * 1000;
+		const float discharge_interval_us = _battery_drain_interval_s.get() * 1000 * 1000;
 
-				bool armed = (_vehicle_status.arming_state == vehicle_status_s::ARMING_STATE_ARMED);
+		bool armed = (_vehicle_status.arming_state == vehicle_status_s::ARMING_STATE_ARMED);
 
-				if (!armed || batt_sim_start == 0 || batt_sim_start > now_us) {
-					batt_sim_start = now_us;
-				}
+		if (!armed || batt_sim_start == 0 || batt_sim_start > now_us) {
+			batt_sim_start = now_us;
+		}
 
-				float ibatt = -1.0f; // no current sensor in simulation
-				const float minimum_percentage = 0.499f; // change this value if you want to simulate low battery reaction
+		float ibatt = -1.0f; // no current sensor in simulation
+		const float minimum_percentage = 0.499f; // change this value if you want to simulate low battery reaction
 
-				/* Simulate the voltage of a linearly draining battery but stop at the minimum percentage */
-				float battery_percentage = 1.0f - (now_us - batt_sim_start) / discharge_interval_us;
+		/* Simulate the voltage of a linearly draining battery but stop at the minimum percentage */
+		float battery_percentage = 1.0f - (now_us - batt_sim_start) / discharge_interval_us;
 
-				battery_percentage = math::max(battery_percentage, minimum_percentage);
-				float vbatt = math::gradual(battery_percentage, 0.f, 1.f, _battery.empty_cell_voltage(), _battery.full_cell_voltage());
-				vbatt *= _battery.cell_count();
+		battery_percentage = math::max(battery_percentage, minimum_percentage);
+		float vbatt = math::gradual(battery_percentage, 0.f, 1.f, _battery.empty_cell_voltage(), _battery.full_cell_voltage());
+		vbatt *= _battery.cell_count();
 
-				const float throttle = 0.0f; // simulate no throttle compensation to make the estimate predictable
-				_battery.updateBatteryStatus(now_us, vbatt, ibatt, true, true, 0, throttle, armed, &_battery_status);
+		const float throttle = 0.0f; // simulate no throttle compensation to make the estimate predictable
+		_battery.updateBatteryStatus(now_us, vbatt, ibatt, true, true, 0, throttle, armed, &_battery_status);
 
 
-				// publish the battery voltage
-				int batt_multi;
-				orb_publish_auto(ORB_ID(battery_status), &_battery_pub, &_battery_status, &batt_multi, ORB_PRIO_HIGH);
-			}
+		// publish the battery voltage
+		int batt_multi;
+		orb_publish_auto(ORB_ID(battery_status), &_battery_pub, &_battery_status, &batt_multi, ORB_PRIO_HIGH);
+	}
+}
+
+void Simulator::handle_hil_gps(mavlink_hil_gps_t *gps_sim, bool publish)
+{
+	if (publish) {
+		//PX4_WARN("FIXME:  Need to publish GPS topic.  Not done yet.");
+	}
+
+	update_gps(gps_sim);
+}
+
+void Simulator::handle_message(mavlink_message_t *msg, bool publish)
+{
+	switch (msg->msgid) {
+	case MAVLINK_MSG_ID_HIL_SENSOR: {
+			mavlink_hil_sensor_t imu;
+			mavlink_msg_hil_sensor_decode(msg, &imu);
+			handle_hil_sensor(&imu, publish);
 		}
 		break;
 
@@ -367,12 +386,7 @@ void Simulator::handle_message(mavlink_message_t *msg, bool publish)
 	case MAVLINK_MSG_ID_HIL_GPS:
 		mavlink_hil_gps_t gps_sim;
 		mavlink_msg_hil_gps_decode(msg, &gps_sim);
-
-		if (publish) {
-			//PX4_WARN("FIXME:  Need to publish GPS topic.  Not done yet.");
-		}
-
-		update_gps(&gps_sim);
+		handle_hil_gps(&gps_sim, publish);
 		break;
 
 	case MAVLINK_MSG_ID_RC_CHANNELS:
@@ -417,6 +431,7 @@ void Simulator::handle_message(mavlink_message_t *msg, bool publish)
 		struct vehicle_attitude_s hil_attitude = {};
 		{
 			hil_attitude.timestamp = timestamp;
+			hil_attitude.timestamp_sample = timestamp;
 
 			matrix::Quatf q(hil_state.attitude_quaternion);
 			q.copyTo(hil_attitude.q);
@@ -506,6 +521,11 @@ void Simulator::handle_message(mavlink_message_t *msg, bool publish)
 
 void Simulator::send_mavlink_message(const mavlink_message_t &aMsg)
 {
+	if (_ip == InternetProtocol::SHM) {
+		// only the HIL data is exchanged over shared memory
+		return;
+	}
+
 	uint8_t  buf[MAVLINK_MAX_PACKET_LEN];
 	uint16_t bufLen = 0;
 
@@ -650,8 +670,39 @@ void Simulator::initializeSensorData()
 	write_airspeed_data(&airspeed);
 }
 
+void Simulator::start_sending()
+{
+	// subscribe to topics
+	for (unsigned i = 0; i < (sizeof(_actuator_outputs_sub) / sizeof(_actuator_outputs_sub[0])); i++) {
+		_actuator_outputs_sub[i] = orb_subscribe_multi(ORB_ID(actuator_outputs), i);
+	}
+
+	_vehicle_status_sub = orb_subscribe(ORB_ID(vehicle_status));
+
+	// Create a thread for sending data to the simulator.
+	pthread_t sender_thread;
+
+	pthread_attr_t sender_thread_attr;
+	pthread_attr_init(&sender_thread_attr);
+	pthread_attr_setstacksize(&sender_thread_attr, PX4_STACK_ADJUSTED(4000));
+
+	struct sched_param param;
+	(void)pthread_attr_getschedparam(&sender_thread_attr, &param);
+
+	param.sched_priority = SCHED_PRIORITY_DEFAULT;
+	(void)pthread_attr_setschedparam(&sender_thread_attr, &param);
+
+	pthread_create(&sender_thread, &sender_thread_attr, Simulator::sending_trampoline, nullptr);
+	pthread_attr_destroy(&sender_thread_attr);
+}
+
 void Simulator::pollForMAVLinkMessages(bool publish)
 {
+	if (_ip == InternetProtocol::SHM) {
+		pollForShmMessages(publish);
+		return;
+	}
+
 #ifdef __PX4_DARWIN
 	pthread_setname_np("sim_rcv");
 #else
@@ -725,19 +776,6 @@ void Simulator::pollForMAVLinkMessages(bool publish)
 
 	}
 
-	// Create a thread for sending data to the simulator.
-	pthread_t sender_thread;
-
-	pthread_attr_t sender_thread_attr;
-	pthread_attr_init(&sender_thread_attr);
-	pthread_attr_setstacksize(&sender_thread_attr, PX4_STACK_ADJUSTED(4000));
-
-	struct sched_param param;
-	(void)pthread_attr_getschedparam(&sender_thread_attr, &param);
-
-	param.sched_priority = SCHED_PRIORITY_DEFAULT;
-	(void)pthread_attr_setschedparam(&sender_thread_attr, &param);
-
 	struct pollfd fds[2];
 	memset(fds, 0, sizeof(fds));
 	unsigned fd_count = 1;
@@ -763,16 +801,8 @@ void Simulator::pollForMAVLinkMessages(bool publish)
 
 #endif
 
-	// subscribe to topics
-	for (unsigned i = 0; i < (sizeof(_actuator_outputs_sub) / sizeof(_actuator_outputs_sub[0])); i++) {
-		_actuator_outputs_sub[i] = orb_subscribe_multi(ORB_ID(actuator_outputs), i);
-	}
-
-	_vehicle_status_sub = orb_subscribe(ORB_ID(vehicle_status));
-
 	// got data from simulator, now activate the sending thread
-	pthread_create(&sender_thread, &sender_thread_attr, Simulator::sending_trampoline, nullptr);
-	pthread_attr_destroy(&sender_thread_attr);
+	start_sending();
 
 	mavlink_status_t mavlink_status = {};
 
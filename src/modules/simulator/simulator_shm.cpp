@@ -0,0 +1,434 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file simulator_shm.cpp
+ *
+ * Shared memory transport to the simulator (see simulator_shm.h) and a
+ * stand-in simulator to test and benchmark it.
+ */
+
+#include <px4_log.h>
+#include <px4_getopt.h>
+#include <px4_tasks.h>
+#include <px4_time.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <lib/ecl/geo/geo.h>
+#include <mathlib/mathlib.h>
+
+#include "simulator.h"
+
+using namespace simulator;
+
+static int open_shm(unsigned id, bool create, struct px4_sim_shm **shm)
+{
+	char name[32];
+	snprintf(name, sizeof(name), PX4_SIM_SHM_NAME_FORMAT, id);
+
+	if (create) {
+		// remove a leftover from a previous run, nobody could connect to it anymore
+		shm_unlink(name);
+	}
+
+	int fd = shm_open(name, create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0666);
+
+	if (fd < 0) {
+		return -errno;
+	}
+
+	if (create && ftruncate(fd, sizeof(struct px4_sim_shm)) != 0) {
+		int ret = -errno;
+		close(fd);
+		return ret;
+	}
+
+	void *mem = mmap(nullptr, sizeof(struct px4_sim_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mem == MAP_FAILED) {
+		return -errno;
+	}
+
+	*shm = (struct px4_sim_shm *)mem;
+	return 0;
+}
+
+void Simulator::close_shm()
+{
+	char name[32];
+	snprintf(name, sizeof(name), PX4_SIM_SHM_NAME_FORMAT, _port);
+
+	pthread_mutex_lock(&_shm_mutex);
+	munmap(_shm, sizeof(*_shm));
+	_shm = nullptr;
+	pthread_mutex_unlock(&_shm_mutex);
+
+	// a simulator attaching later must not find the old rings
+	shm_unlink(name);
+
+	__atomic_store_n(&_shm_closed, true, __ATOMIC_SEQ_CST);
+}
+
+void Simulator::stop_shm()
+{
+	if (_ip != InternetProtocol::SHM) {
+		return;
+	}
+
+	__atomic_store_n(&_shm_should_exit, true, __ATOMIC_SEQ_CST);
+
+	// the receiving task checks at least once per second (system_usleep is not in lockstep)
+	for (int i = 0; i < 300 && !__atomic_load_n(&_shm_closed, __ATOMIC_SEQ_CST); i++) {
+		system_usleep(10000);
+	}
+
+	if (!__atomic_load_n(&_shm_closed, __ATOMIC_SEQ_CST)) {
+		PX4_WARN("shared memory %u not released", _port);
+	}
+}
+
+void Simulator::pollForShmMessages(bool publish)
+{
+#ifdef __PX4_DARWIN
+	pthread_setname_np("sim_rcv");
+#else
+	pthread_setname_np(pthread_self(), "sim_rcv");
+#endif
+
+	int ret = open_shm(_port, true, &_shm);
+
+	if (ret != 0) {
+		PX4_ERR("Creating shared memory %u failed: %s", _port, strerror(-ret));
+		return;
+	}
+
+	px4_sim_shm_init(_shm);
+
+	PX4_INFO("Waiting for simulator to connect on shared memory %u", _port);
+
+	while (!__atomic_load_n(&_shm->connected, __ATOMIC_SEQ_CST)) {
+		if (__atomic_load_n(&_shm_should_exit, __ATOMIC_SEQ_CST)) {
+			close_shm();
+			return;
+		}
+
+		system_usleep(10000);
+	}
+
+	PX4_INFO("Simulator connected on shared memory %u.", _port);
+
+	start_sending();
+
+	_initialized = true;
+
+	struct px4_sim_shm_record record;
+
+	while (!__atomic_load_n(&_shm_should_exit, __ATOMIC_SEQ_CST)) {
+
+		// a real futex wait: in lockstep the time only advances with the sensor data
+		if (!px4_sim_shm_wait(&_shm->to_px4, 1000000)) {
+			continue;
+		}
+
+		while (px4_sim_shm_pop(&_shm->to_px4, &record)) {
+			switch (record.type) {
+			case PX4_SIM_SHM_SENSOR: {
+					const px4_sim_shm_sensor &sensor = record.sensor;
+					mavlink_hil_sensor_t imu{};
+					imu.time_usec = sensor.time_usec;
+					imu.xacc = sensor.xacc;
+					imu.yacc = sensor.yacc;
+					imu.zacc = sensor.zacc;
+					imu.xgyro = sensor.xgyro;
+					imu.ygyro = sensor.ygyro;
+					imu.zgyro = sensor.zgyro;
+					imu.xmag = sensor.xmag;
+					imu.ymag = sensor.ymag;
+					imu.zmag = sensor.zmag;
+					imu.abs_pressure = sensor.abs_pressure;
+					imu.diff_pressure = sensor.diff_pressure;
+					imu.pressure_alt = sensor.pressure_alt;
+					imu.temperature = sensor.temperature;
+					imu.fields_updated = sensor.fields_updated;
+
+					handle_hil_sensor(&imu, publish);
+				}
+				break;
+
+			case PX4_SIM_SHM_GPS: {
+					const px4_sim_shm_gps &gps = record.gps;
+					mavlink_hil_gps_t gps_sim{};
+					gps_sim.time_usec = gps.time_usec;
+					gps_sim.lat = gps.lat;
+					gps_sim.lon = gps.lon;
+					gps_sim.alt = gps.alt;
+					gps_sim.eph = gps.eph;
+					gps_sim.epv = gps.epv;
+					gps_sim.vel = gps.vel;
+					gps_sim.vn = gps.vn;
+					gps_sim.ve = gps.ve;
+					gps_sim.vd = gps.vd;
+					gps_sim.cog = gps.cog;
+					gps_sim.fix_type = gps.fix_type;
+					gps_sim.satellites_visible = gps.satellites_visible;
+
+					handle_hil_gps(&gps_sim, publish);
+				}
+				break;
+
+			default:
+				PX4_DEBUG("unknown shared memory record %u", record.type);
+				break;
+			}
+		}
+	}
+
+	close_shm();
+}
+
+void Simulator::send_shm_actuator_controls(const mavlink_hil_actuator_controls_t &msg, unsigned index)
+{
+	struct px4_sim_shm_record record {};
+	record.type = PX4_SIM_SHM_ACTUATOR;
+	record.actuator.time_usec = msg.time_usec;
+	record.actuator.flags = msg.flags;
+	record.actuator.mode = msg.mode;
+	record.actuator.index = index;
+
+	for (unsigned i = 0; i < 16; i++) {
+		record.actuator.controls[i] = msg.controls[i];
+	}
+
+	pthread_mutex_lock(&_shm_mutex);
+
+	// a full ring means the simulator is not reading, the record is counted in dropped
+	if (_shm != nullptr) {
+		px4_sim_shm_push(&_shm->to_sim, &record);
+	}
+
+	pthread_mutex_unlock(&_shm_mutex);
+}
+
+/**
+ * Stand-in simulator: a vehicle standing still, driven in lockstep with PX4.
+ * It only uses simulator_shm.h, like a simulator plugin would.
+ */
+static int loopback_task(int argc, char *argv[])
+{
+	unsigned id = 4560;
+	float rate = 250.f;
+	float duration = 10.f;
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "m:r:t:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'm':
+			id = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		case 'r':
+			rate = strtof(myoptarg, nullptr);
+			break;
+
+		case 't':
+			duration = strtof(myoptarg, nullptr);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (rate < 1.f || duration <= 0.f) {
+		PX4_ERR("invalid rate or duration");
+		return 1;
+	}
+
+	struct px4_sim_shm *shm = nullptr;
+
+	// wait for PX4 to create the shared memory
+	while (open_shm(id, false, &shm) != 0 || !px4_sim_shm_valid(shm)) {
+		if (shm) {
+			munmap(shm, sizeof(*shm));
+			shm = nullptr;
+		}
+
+		system_usleep(100000);
+	}
+
+	__atomic_store_n(&shm->connected, 1, __ATOMIC_SEQ_CST);
+
+	const uint64_t step_us = 1e6f / rate;
+	const uint64_t steps = duration * rate;
+	const uint64_t gps_interval = math::max((uint64_t)1, (uint64_t)(rate / 10.f));
+
+	uint64_t time_usec = step_us;
+	uint64_t lockstep_steps = 0;
+	uint64_t round_trip_sum_us = 0;
+	uint64_t round_trip_max_us = 0;
+	unsigned timeouts = 0;
+	bool lockstep = false;
+	uint32_t noise = 1;
+
+	struct timespec start;
+	struct timespec lockstep_start {};
+	uint64_t lockstep_start_usec = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (uint64_t step = 0; step < steps; step++, time_usec += step_us) {
+		struct px4_sim_shm_record record {};
+		record.type = PX4_SIM_SHM_SENSOR;
+
+		px4_sim_shm_sensor &sensor = record.sensor;
+		sensor.time_usec = time_usec;
+
+		// a bit of noise, the preflight checks reject a perfectly constant signal
+		noise = noise * 1103515245 + 12345;
+		const float n = ((noise >> 16) & 0xff) / 255.f - 0.5f;
+
+		sensor.xacc = 0.02f * n;
+		sensor.yacc = -0.02f * n;
+		sensor.zacc = -CONSTANTS_ONE_G + 0.02f * n;
+		sensor.xgyro = 0.001f * n;
+		sensor.ygyro = -0.001f * n;
+		sensor.zgyro = 0.001f * n;
+		sensor.xmag = 0.21523f;
+		sensor.ymag = 0.00771f;
+		sensor.zmag = 0.42741f;
+		sensor.abs_pressure = 955.f + 0.01f * n;
+		sensor.pressure_alt = 488.f;
+		sensor.temperature = 25.f;
+		sensor.fields_updated = 0x1fff;
+
+		struct timespec sent;
+		clock_gettime(CLOCK_MONOTONIC, &sent);
+
+		px4_sim_shm_push(&shm->to_px4, &record);
+
+		if (step % gps_interval == 0) {
+			record = {};
+			record.type = PX4_SIM_SHM_GPS;
+			record.gps.time_usec = time_usec;
+			record.gps.lat = 473977420;
+			record.gps.lon = 85455940;
+			record.gps.alt = 488000;
+			record.gps.eph = 100;
+			record.gps.epv = 100;
+			record.gps.cog = UINT16_MAX;
+			record.gps.fix_type = 3;
+			record.gps.satellites_visible = 10;
+			px4_sim_shm_push(&shm->to_px4, &record);
+		}
+
+		if (!lockstep) {
+			// until PX4 outputs anything, run in real time like a simulator would
+			system_usleep(step_us);
+
+			if (px4_sim_shm_pop(&shm->to_sim, &record)) {
+				lockstep = true;
+				lockstep_start = sent;
+				lockstep_start_usec = time_usec;
+			}
+
+			continue;
+		}
+
+		// lockstep: the physics only step once the controls for this sample are in
+		if (!px4_sim_shm_wait(&shm->to_sim, 100000)) {
+			timeouts++;
+			continue;
+		}
+
+		while (px4_sim_shm_pop(&shm->to_sim, &record)) {}
+
+		struct timespec received;
+		clock_gettime(CLOCK_MONOTONIC, &received);
+
+		const uint64_t round_trip_us = (received.tv_sec - sent.tv_sec) * 1000000ull +
+					       (received.tv_nsec - sent.tv_nsec) / 1000;
+
+		round_trip_sum_us += round_trip_us;
+		round_trip_max_us = math::max(round_trip_max_us, round_trip_us);
+		lockstep_steps++;
+	}
+
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	const double wall = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+	const double simulated = (double)steps * step_us * 1e-6;
+
+	PX4_INFO("loopback: %llu steps at %.0f Hz, %.2f s simulated in %.2f s (real-time factor %.2f)",
+		 (unsigned long long)steps, (double)rate, simulated, wall, simulated / wall);
+
+	if (lockstep_steps > 0) {
+		const double lockstep_wall = (end.tv_sec - lockstep_start.tv_sec) + (end.tv_nsec - lockstep_start.tv_nsec) * 1e-9;
+		const double lockstep_simulated = (time_usec - lockstep_start_usec) * 1e-6;
+
+		PX4_INFO("lockstep: %llu steps, real-time factor %.2f, round trip mean %llu us, max %llu us",
+			 (unsigned long long)lockstep_steps, lockstep_simulated / lockstep_wall,
+			 (unsigned long long)(round_trip_sum_us / lockstep_steps), (unsigned long long)round_trip_max_us);
+
+	} else {
+		PX4_WARN("no actuator controls received, lockstep never started");
+	}
+
+	PX4_INFO("timeouts: %u, dropped to PX4: %u, dropped to simulator: %u", timeouts,
+		 (unsigned)__atomic_load_n(&shm->to_px4.dropped, __ATOMIC_RELAXED),
+		 (unsigned)__atomic_load_n(&shm->to_sim.dropped, __ATOMIC_RELAXED));
+
+	munmap(shm, sizeof(*shm));
+	return 0;
+}
+
+int Simulator::loopback(int /*argc*/, char *argv[])
+{
+	px4_task_t task = px4_task_spawn_cmd("sim_loopback",
+					     SCHED_DEFAULT,
+					     SCHED_PRIORITY_DEFAULT,
+					     2000,
+					     loopback_task,
+					     argv);
+
+	if (task < 0) {
+		PX4_ERR("task start failed");
+		return 1;
+	}
+
+	return 0;
+}
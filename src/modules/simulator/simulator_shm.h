@@ -0,0 +1,279 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file simulator_shm.h
+ *
+ * Shared memory transport between PX4 SITL and a simulator running on the
+ * same machine, as an alternative to HIL_SENSOR / HIL_GPS /
+ * HIL_ACTUATOR_CONTROLS MAVLink messages over UDP or TCP.
+ *
+ * This header is self-contained C (C11 with GCC/Clang atomic builtins) so
+ * that simulator plugins can include it without any other PX4 header.
+ *
+ * Connection:
+ *  - PX4 is started with 'simulator start -s -m <id>'. It creates the POSIX
+ *    shared memory object PX4_SIM_SHM_NAME_FORMAT (e.g. "/px4_sim_4560" for
+ *    id 4560), of size sizeof(struct px4_sim_shm), initializes it and then
+ *    waits for the simulator.
+ *  - The simulator opens the object with shm_open() and mmap(), checks
+ *    magic, version and size, and sets 'connected' to 1.
+ *  - On 'simulator stop' PX4 unmaps and removes (shm_unlink) the object. A
+ *    simulator still attached keeps its mapping, but receives no more
+ *    actuator records, and has to reconnect to the next PX4 instance.
+ *
+ * Data flow:
+ *  - The simulator pushes sensor (and GPS) records into 'to_px4'. The
+ *    time_usec of a sensor record sets the PX4 clock (lockstep), exactly as
+ *    HIL_SENSOR does.
+ *  - PX4 pushes an actuator record into 'to_sim' whenever actuator_outputs
+ *    are updated. In lockstep the simulator waits for it before it steps
+ *    the physics and sends the next sensor record.
+ *
+ * Each ring has exactly one producer and one consumer. The producer writes
+ * the record, then advances 'head'. The consumer reads the record, then
+ * advances 'tail'. A consumer that wants to block announces it in 'waiters'
+ * and sleeps on 'head' (a futex on Linux), so the producer only makes a
+ * system call when someone is actually waiting.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define PX4_SIM_SHM_MAGIC		0x4d485350u	///< "PSHM"
+#define PX4_SIM_SHM_VERSION		1u
+#define PX4_SIM_SHM_RING_LENGTH		64u		///< records per ring, power of 2
+#define PX4_SIM_SHM_NAME_FORMAT		"/px4_sim_%u"
+
+/** record types */
+#define PX4_SIM_SHM_SENSOR		1u		///< struct px4_sim_shm_sensor, simulator -> PX4
+#define PX4_SIM_SHM_GPS			2u		///< struct px4_sim_shm_gps, simulator -> PX4
+#define PX4_SIM_SHM_ACTUATOR		3u		///< struct px4_sim_shm_actuator, PX4 -> simulator
+
+/** same fields and units as the MAVLink HIL_SENSOR message */
+struct px4_sim_shm_sensor {
+	uint64_t time_usec;		///< simulation time [us]
+	float xacc;			///< [m/s^2]
+	float yacc;
+	float zacc;
+	float xgyro;			///< [rad/s]
+	float ygyro;
+	float zgyro;
+	float xmag;			///< [gauss]
+	float ymag;
+	float zmag;
+	float abs_pressure;		///< [hPa]
+	float diff_pressure;		///< [hPa]
+	float pressure_alt;		///< [m]
+	float temperature;		///< [degC]
+	uint32_t fields_updated;	///< bitmask as in HIL_SENSOR
+};
+
+/** same fields and units as the MAVLink HIL_GPS message */
+struct px4_sim_shm_gps {
+	uint64_t time_usec;
+	int32_t lat;			///< [degE7]
+	int32_t lon;			///< [degE7]
+	int32_t alt;			///< [mm]
+	uint16_t eph;			///< [cm]
+	uint16_t epv;			///< [cm]
+	uint16_t vel;			///< [cm/s]
+	int16_t vn;			///< [cm/s]
+	int16_t ve;
+	int16_t vd;
+	uint16_t cog;			///< [cdeg]
+	uint8_t fix_type;
+	uint8_t satellites_visible;
+};
+
+/** same fields and units as the MAVLink HIL_ACTUATOR_CONTROLS message */
+struct px4_sim_shm_actuator {
+	uint64_t time_usec;
+	uint64_t flags;
+	float controls[16];		///< -1..1 (0..1 for throttle/rotors)
+	uint8_t mode;			///< MAV_MODE_FLAG bits, 128: armed
+	uint8_t index;			///< actuator_outputs instance
+};
+
+struct px4_sim_shm_record {
+	uint32_t type;
+	uint32_t reserved;
+
+	union {
+		struct px4_sim_shm_sensor sensor;
+		struct px4_sim_shm_gps gps;
+		struct px4_sim_shm_actuator actuator;
+	};
+};
+
+struct px4_sim_shm_ring {
+	uint32_t head;			///< next record to write, written by the producer only
+	uint32_t tail;			///< next record to read, written by the consumer only
+	uint32_t waiters;		///< the consumer is (about to be) sleeping on head
+	uint32_t dropped;		///< records dropped because the ring was full
+	struct px4_sim_shm_record records[PX4_SIM_SHM_RING_LENGTH];
+};
+
+struct px4_sim_shm {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;			///< sizeof(struct px4_sim_shm)
+	uint32_t connected;		///< set to 1 by the simulator after attaching
+	struct px4_sim_shm_ring to_px4;
+	struct px4_sim_shm_ring to_sim;
+};
+
+static inline void px4_sim_shm_init(struct px4_sim_shm *shm)
+{
+	memset(shm, 0, sizeof(*shm));
+	shm->version = PX4_SIM_SHM_VERSION;
+	shm->size = sizeof(*shm);
+	// magic last, the simulator must not attach to a half initialized object
+	__atomic_store_n(&shm->magic, PX4_SIM_SHM_MAGIC, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @return 1 if shm is a compatible, initialized object, 0 otherwise
+ */
+static inline int px4_sim_shm_valid(const struct px4_sim_shm *shm)
+{
+	return __atomic_load_n(&shm->magic, __ATOMIC_SEQ_CST) == PX4_SIM_SHM_MAGIC &&
+	       shm->version == PX4_SIM_SHM_VERSION && shm->size == sizeof(*shm);
+}
+
+/**
+ * Append a record (producer side) and wake up the consumer if it is waiting.
+ * @return 0 on success, -1 if the ring is full (the record is dropped)
+ */
+static inline int px4_sim_shm_push(struct px4_sim_shm_ring *ring, const struct px4_sim_shm_record *record)
+{
+	const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+	const uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	if (head - tail >= PX4_SIM_SHM_RING_LENGTH) {
+		__atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+		return -1;
+	}
+
+	ring->records[head & (PX4_SIM_SHM_RING_LENGTH - 1)] = *record;
+
+	// seq_cst pairs with the waiters store in px4_sim_shm_wait()
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&ring->waiters, __ATOMIC_SEQ_CST)) {
+#if defined(__linux__)
+		syscall(SYS_futex, &ring->head, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+	}
+
+	return 0;
+}
+
+/**
+ * Take the oldest record (consumer side).
+ * @return 1 if a record was copied to record, 0 if the ring is empty
+ */
+static inline int px4_sim_shm_pop(struct px4_sim_shm_ring *ring, struct px4_sim_shm_record *record)
+{
+	const uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+	const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	if (head == tail) {
+		return 0;
+	}
+
+	*record = ring->records[tail & (PX4_SIM_SHM_RING_LENGTH - 1)];
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/**
+ * Block until the ring has data (consumer side).
+ * @param timeout_us maximum (real) time to wait
+ * @return 1 if data is available, 0 on timeout
+ */
+static inline int px4_sim_shm_wait(struct px4_sim_shm_ring *ring, uint32_t timeout_us)
+{
+	const uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+
+	if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != tail) {
+		return 1;
+	}
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	__atomic_store_n(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+
+	int ret = 0;
+
+	while (1) {
+		if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != tail) {
+			ret = 1;
+			break;
+		}
+
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		const int64_t elapsed_us = (int64_t)(now.tv_sec - start.tv_sec) * 1000000 + (now.tv_nsec - start.tv_nsec) / 1000;
+
+		if (elapsed_us >= (int64_t)timeout_us) {
+			break;
+		}
+
+		const int64_t remaining_us = (int64_t)timeout_us - elapsed_us;
+
+#if defined(__linux__)
+		// returns immediately if head is not tail anymore
+		struct timespec timeout = { (time_t)(remaining_us / 1000000), (long)(remaining_us % 1000000) * 1000 };
+		syscall(SYS_futex, &ring->head, FUTEX_WAIT, tail, &timeout, NULL, 0);
+#else
+		// no futex, poll
+		struct timespec timeout = { 0, (long)(remaining_us < 50 ? remaining_us : 50) * 1000 };
+		nanosleep(&timeout, NULL);
+#endif
+	}
+
+	__atomic_store_n(&ring->waiters, 0, __ATOMIC_SEQ_CST);
+	return ret;
+}
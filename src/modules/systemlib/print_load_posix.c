@@ -42,6 +42,7 @@
 #include <px4_posix.h>
 
 #include <unistd.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -79,8 +80,171 @@ void init_print_load_s(uint64_t t, struct print_load_s *s)
 	}
 
 	s->interval_time_ms_inv = 0.f;
+
+#ifdef __PX4_LINUX
+	s->last_thread_count = 0;
+	memset(&s->last_cpu_time, 0, sizeof(s->last_cpu_time));
+#endif
+}
+
+#ifdef __PX4_LINUX
+
+static const struct thread_load_s *find_last_thread(const struct print_load_s *print_state, int tid)
+{
+	for (int i = 0; i < print_state->last_thread_count; i++) {
+		if (print_state->last_threads[i].tid == tid) {
+			return &print_state->last_threads[i];
+		}
+	}
+
+	return NULL;
+}
+
+void print_load_buffer(uint64_t t, char *buffer, int buffer_length, print_load_callback_f cb, void *user,
+		       struct print_load_s *print_state)
+{
+	print_state->new_time = t;
+
+	struct system_cpu_time_s cpu_time;
+
+	// the thread list does not fit on the stack of every caller
+	struct thread_load_s *threads = (struct thread_load_s *)malloc(THREAD_LOAD_MAX_THREADS * sizeof(struct thread_load_s));
+
+	if (threads == NULL || thread_load_sample_system(&cpu_time) != 0) {
+		free(threads);
+		return;
+	}
+
+	const int thread_count = thread_load_sample(threads, THREAD_LOAD_MAX_THREADS);
+
+	// procfs times are in real time, so don't use hrt (which might be in lockstep)
+	const bool have_interval = print_state->last_cpu_time.timestamp > 0 && cpu_time.timestamp > print_state->last_cpu_time.timestamp;
+	const float interval_us_inv = have_interval ? 1.f / (float)(cpu_time.timestamp - print_state->last_cpu_time.timestamp) : 0.f;
+
+	print_state->running_count = 0;
+	print_state->blocked_count = 0;
+	print_state->total_user_time = 0;
+
+	if (have_interval) {
+		/* header for thread list */
+		snprintf(buffer, buffer_length, "%6s %-16s %8s %6s %6s %11s %3s %4s %-5s",
+			 "TID",
+			 "COMMAND",
+			 "CPU(ms)",
+			 "CPU(%)",
+			 "WAIT(%)",
+			 "CSW(V/I)",
+			 "CPU",
+			 "PRIO",
+			 "STATE");
+		cb(user);
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+		const struct thread_load_s *thread = &threads[i];
+
+		if (thread->state == 'R') {
+			print_state->running_count++;
+
+		} else {
+			print_state->blocked_count++;
+		}
+
+		const struct thread_load_s *last = find_last_thread(print_state, thread->tid);
+
+		if (!have_interval || last == NULL) {
+			continue; // not enough data yet
+		}
+
+		const uint64_t interval_runtime = thread->run_time_us - last->run_time_us;
+		print_state->total_user_time += interval_runtime;
+
+		const float current_load = interval_runtime * interval_us_inv;
+		const float wait_load = (thread->wait_time_us - last->wait_time_us) * interval_us_inv;
+
+		snprintf(buffer, buffer_length, "%6d %-16s %8llu %2d.%03d %6.2f %5llu/%5llu %3d %4d %-5c",
+			 thread->tid,
+			 thread->name,
+			 (unsigned long long)(thread->run_time_us / 1000),
+			 (int)(current_load * 100.0f),
+			 (int)((current_load * 100.0f - (int)(current_load * 100.0f)) * 1000),
+			 (double)(wait_load * 100.f),
+			 (unsigned long long)(thread->ctx_switches_voluntary - last->ctx_switches_voluntary),
+			 (unsigned long long)(thread->ctx_switches_involuntary - last->ctx_switches_involuntary),
+			 thread->last_cpu,
+			 thread->priority,
+			 thread->state);
+		cb(user);
+	}
+
+	if (have_interval) {
+		// Print footer
+		buffer[0] = 0;
+		cb(user);
+
+		const uint64_t total_ticks = cpu_time.total - print_state->last_cpu_time.total;
+		const uint64_t idle_ticks = cpu_time.idle - print_state->last_cpu_time.idle;
+		const float idle_load = total_ticks > 0 ? (float)idle_ticks / (float)total_ticks : 0.f;
+
+		// load of the process, relative to all CPUs
+		const float process_load = print_state->total_user_time * interval_us_inv / (float)cpu_time.num_cpus;
+
+		snprintf(buffer, buffer_length, "Threads: %d total, %d running, %d sleeping",
+			 thread_count,
+			 print_state->running_count,
+			 print_state->blocked_count);
+		cb(user);
+		snprintf(buffer, buffer_length, "CPU usage: %.2f%% px4, %.2f%% other, %.2f%% idle (%d CPUs)",
+			 (double)(process_load * 100.f),
+			 (double)((1.f - idle_load - process_load) * 100.f),
+			 (double)(idle_load * 100.f),
+			 cpu_time.num_cpus);
+		cb(user);
+		snprintf(buffer, buffer_length, "Uptime: %.3fs total", (double)t / 1000000.0);
+		cb(user);
+	}
+
+	memcpy(print_state->last_threads, threads, thread_count * sizeof(struct thread_load_s));
+	print_state->last_thread_count = thread_count;
+	print_state->last_cpu_time = cpu_time;
+	print_state->interval_start_time = print_state->new_time;
+
+	free(threads);
+}
+
+struct print_load_callback_data_s {
+	int fd;
+	char buffer[140];
+};
+
+static void print_load_callback(void *user)
+{
+	char *clear_line = "";
+	struct print_load_callback_data_s *data = (struct print_load_callback_data_s *)user;
+
+	if (data->fd == 1) {
+		clear_line = CL;
+	}
+
+	dprintf(data->fd, "%s%s\n", clear_line, data->buffer);
+}
+
+void print_load(uint64_t t, int fd, struct print_load_s *print_state)
+{
+	/* print system information */
+	if (fd == 1) {
+		dprintf(fd, "\033[H"); /* move cursor home and clear screen */
+	}
+
+	struct print_load_callback_data_s data;
+
+	data.fd = fd;
+
+	print_load_buffer(t, data.buffer, sizeof(data.buffer), print_load_callback, &data, print_state);
 }
 
+#else
+
 void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 {
 	char *clear_line = "";
@@ -91,8 +255,8 @@ void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 		clear_line = CL;
 	}
 
-#if defined(__PX4_LINUX) || defined(__PX4_CYGWIN) || defined(__PX4_QURT)
-	dprintf(fd, "%sTOP NOT IMPLEMENTED ON LINUX, QURT, WINDOWS (ONLY ON NUTTX, APPLE)\n", clear_line);
+#if defined(__PX4_CYGWIN) || defined(__PX4_QURT)
+	dprintf(fd, "%sTOP NOT IMPLEMENTED ON QURT, WINDOWS (ONLY ON NUTTX, LINUX, APPLE)\n", clear_line);
 
 #elif defined(__PX4_DARWIN)
 	pid_t pid = getpid();   //-- this is the process id you need info for
@@ -181,3 +345,5 @@ void print_load_buffer(uint64_t t, char *buffer, int buffer_length, print_load_c
 
 }
 
+#endif /* __PX4_LINUX */
+
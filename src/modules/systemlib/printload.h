@@ -45,6 +45,10 @@
 
 #include <stdint.h>
 
+#ifdef __PX4_LINUX
+#include <systemlib/thread_load_linux.h>
+#endif
+
 #ifndef CONFIG_MAX_TASKS
 #define CONFIG_MAX_TASKS 64
 #endif
@@ -59,6 +63,12 @@ struct print_load_s {
 	uint64_t interval_start_time;
 	uint32_t last_times[CONFIG_MAX_TASKS]; // in [ms]. This wraps if a process needs more than 49 days of CPU
 	float interval_time_ms_inv;
+
+#ifdef __PX4_LINUX
+	struct thread_load_s last_threads[THREAD_LOAD_MAX_THREADS]; // thread statistics of the previous interval
+	int last_thread_count;
+	struct system_cpu_time_s last_cpu_time;
+#endif
 };
 
 __BEGIN_DECLS
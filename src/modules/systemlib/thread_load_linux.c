@@ -0,0 +1,292 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file thread_load_linux.c
+ *
+ * Per-thread CPU and scheduling statistics on Linux, read from procfs.
+ */
+
+#include "thread_load_linux.h"
+
+#ifdef __PX4_LINUX
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Read a (small) procfs file into a 0-terminated buffer.
+ * @return number of bytes read, or <0 on error
+ */
+static int read_proc_file(const char *path, char *buffer, int buffer_length)
+{
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	int len = read(fd, buffer, buffer_length - 1);
+	close(fd);
+
+	if (len < 0) {
+		return -1;
+	}
+
+	buffer[len] = '\0';
+	return len;
+}
+
+/**
+ * Parse /proc/self/task/<tid>/stat (see proc(5)).
+ */
+static int read_thread_stat(int tid, struct thread_load_s *thread)
+{
+	char path[64];
+	char buffer[512];
+
+	snprintf(path, sizeof(path), "/proc/self/task/%d/stat", tid);
+
+	if (read_proc_file(path, buffer, sizeof(buffer)) <= 0) {
+		return -1;
+	}
+
+	// the name is enclosed in parentheses and may itself contain spaces or parentheses
+	char *name_start = strchr(buffer, '(');
+	char *name_end = strrchr(buffer, ')');
+
+	if (name_start == NULL || name_end == NULL || name_end < name_start) {
+		return -1;
+	}
+
+	int name_len = name_end - name_start - 1;
+
+	if (name_len >= THREAD_LOAD_NAME_LEN) {
+		name_len = THREAD_LOAD_NAME_LEN - 1;
+	}
+
+	memcpy(thread->name, name_start + 1, name_len);
+	thread->name[name_len] = '\0';
+
+	// fields after the name, starting with field 3 (state)
+	char *p = name_end + 1;
+	uint64_t utime = 0;
+	uint64_t stime = 0;
+
+	for (int field = 3; field <= 39 && *p != '\0'; ++field) {
+		while (*p == ' ') {
+			++p;
+		}
+
+		char *next;
+
+		if (field == 3) {
+			thread->state = *p;
+			next = p + 1;
+
+		} else {
+			long long value = strtoll(p, &next, 10);
+
+			switch (field) {
+			case 14:
+				utime = (uint64_t)value;
+				break;
+
+			case 15:
+				stime = (uint64_t)value;
+				break;
+
+			case 18:
+				thread->priority = (int)value;
+				break;
+
+			case 39:
+				thread->last_cpu = (int)value;
+				break;
+			}
+		}
+
+		if (next == p) {
+			break;
+		}
+
+		p = next;
+	}
+
+	// fallback if schedstats are not available: tick-based CPU time
+	thread->run_time_us = (utime + stime) * 1000000ULL / sysconf(_SC_CLK_TCK);
+
+	return 0;
+}
+
+/**
+ * Parse /proc/self/task/<tid>/schedstat: run time [ns], run-queue wait time [ns], # time slices.
+ * Only available if the kernel is built with CONFIG_SCHEDSTATS.
+ */
+static void read_thread_schedstat(int tid, struct thread_load_s *thread)
+{
+	char path[64];
+	char buffer[128];
+
+	snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat", tid);
+
+	if (read_proc_file(path, buffer, sizeof(buffer)) <= 0) {
+		return;
+	}
+
+	unsigned long long run_time_ns, wait_time_ns;
+
+	if (sscanf(buffer, "%llu %llu", &run_time_ns, &wait_time_ns) == 2) {
+		thread->run_time_us = run_time_ns / 1000;
+		thread->wait_time_us = wait_time_ns / 1000;
+	}
+}
+
+/**
+ * Parse the context switch counters from /proc/self/task/<tid>/status.
+ */
+static void read_thread_status(int tid, struct thread_load_s *thread)
+{
+	char path[64];
+	char buffer[2048];
+
+	snprintf(path, sizeof(path), "/proc/self/task/%d/status", tid);
+
+	if (read_proc_file(path, buffer, sizeof(buffer)) <= 0) {
+		return;
+	}
+
+	const char *voluntary = strstr(buffer, "\nvoluntary_ctxt_switches:");
+	const char *involuntary = strstr(buffer, "\nnonvoluntary_ctxt_switches:");
+
+	if (voluntary) {
+		thread->ctx_switches_voluntary = strtoull(voluntary + strlen("\nvoluntary_ctxt_switches:"), NULL, 10);
+	}
+
+	if (involuntary) {
+		thread->ctx_switches_involuntary = strtoull(involuntary + strlen("\nnonvoluntary_ctxt_switches:"), NULL, 10);
+	}
+}
+
+int thread_load_sample(struct thread_load_s *threads, int max_threads)
+{
+	DIR *dir = opendir("/proc/self/task");
+
+	if (dir == NULL) {
+		return -1;
+	}
+
+	int num_threads = 0;
+	struct dirent *entry;
+
+	while (num_threads < max_threads && (entry = readdir(dir)) != NULL) {
+		if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+			continue; // skip '.' and '..'
+		}
+
+		struct thread_load_s *thread = &threads[num_threads];
+		memset(thread, 0, sizeof(*thread));
+		thread->tid = atoi(entry->d_name);
+
+		// the thread might have exited in the meantime
+		if (read_thread_stat(thread->tid, thread) != 0) {
+			continue;
+		}
+
+		read_thread_schedstat(thread->tid, thread);
+		read_thread_status(thread->tid, thread);
+		++num_threads;
+	}
+
+	closedir(dir);
+	return num_threads;
+}
+
+int thread_load_sample_system(struct system_cpu_time_s *cpu_time)
+{
+	char buffer[256];
+
+	if (read_proc_file("/proc/stat", buffer, sizeof(buffer)) <= 0) {
+		return -1;
+	}
+
+	unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
+
+	if (sscanf(buffer, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+		   &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal) != 8) {
+		return -1;
+	}
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	cpu_time->timestamp = (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+	cpu_time->total = user + nice + system + idle + iowait + irq + softirq + steal;
+	cpu_time->idle = idle + iowait;
+	cpu_time->num_cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+	return 0;
+}
+
+float thread_load_ram_usage(void)
+{
+	char buffer[512];
+
+	if (read_proc_file("/proc/meminfo", buffer, sizeof(buffer)) <= 0) {
+		return -1.f;
+	}
+
+	const char *total_str = strstr(buffer, "MemTotal:");
+	const char *available_str = strstr(buffer, "MemAvailable:");
+
+	if (total_str == NULL || available_str == NULL) {
+		return -1.f;
+	}
+
+	unsigned long long total = strtoull(total_str + strlen("MemTotal:"), NULL, 10);
+	unsigned long long available = strtoull(available_str + strlen("MemAvailable:"), NULL, 10);
+
+	if (total == 0 || available > total) {
+		return -1.f;
+	}
+
+	return (float)(total - available) / (float)total;
+}
+
+#endif /* __PX4_LINUX */
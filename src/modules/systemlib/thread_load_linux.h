@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file thread_load_linux.h
+ *
+ * Per-thread CPU and scheduling statistics on Linux, read from procfs.
+ */
+
+#pragma once
+
+#include <px4_config.h>
+
+#include <stdint.h>
+
+#ifdef __PX4_LINUX
+
+#define THREAD_LOAD_MAX_THREADS 64
+#define THREAD_LOAD_NAME_LEN 16
+
+/**
+ * Accumulated statistics of a single thread (since the thread was started).
+ */
+struct thread_load_s {
+	int tid;					///< kernel thread id
+	char name[THREAD_LOAD_NAME_LEN];		///< thread name (as set by px4_task_spawn_cmd)
+	char state;					///< scheduling state (R, S, D, ...)
+	int priority;					///< kernel priority (negative for real-time threads)
+	int last_cpu;					///< CPU the thread was last executed on
+	uint64_t run_time_us;				///< time spent on the CPU
+	uint64_t wait_time_us;				///< time spent waiting on a run-queue (0 without CONFIG_SCHEDSTATS)
+	uint64_t ctx_switches_voluntary;		///< number of voluntary context switches
+	uint64_t ctx_switches_involuntary;		///< number of involuntary context switches (preemptions)
+};
+
+/**
+ * Accumulated statistics of the whole system.
+ */
+struct system_cpu_time_s {
+	uint64_t timestamp;				///< CLOCK_MONOTONIC time of the sample [us] (not affected by lockstep)
+	uint64_t total;					///< total time of all CPUs [clock ticks]
+	uint64_t idle;					///< idle and iowait time of all CPUs [clock ticks]
+	int num_cpus;					///< number of online CPUs
+};
+
+__BEGIN_DECLS
+
+/**
+ * Sample the statistics of all threads of the current process.
+ * @param threads array to fill in
+ * @param max_threads size of threads
+ * @return number of threads written, or <0 on error
+ */
+__EXPORT int thread_load_sample(struct thread_load_s *threads, int max_threads);
+
+/**
+ * Sample the accumulated CPU time of the system.
+ * @return 0 on success, <0 on error
+ */
+__EXPORT int thread_load_sample_system(struct system_cpu_time_s *cpu_time);
+
+/**
+ * Get the RAM usage of the system.
+ * @return used fraction of the RAM in [0, 1], or <0 on error
+ */
+__EXPORT float thread_load_ram_usage(void);
+
+__END_DECLS
+
+#endif /* __PX4_LINUX */
@@ -35,6 +35,7 @@
 #include "uORBDeviceNode.hpp"
 #include "uORBManager.hpp"
 #include "uORBUtils.hpp"
+#include "uORBTap.hpp"
 
 #ifdef ORB_COMMUNICATOR
 #include "uORBCommunicator.hpp"
@@ -43,6 +44,8 @@
 #include <px4_sem.hpp>
 #include <systemlib/px4_macros.h>
 
+#include <math.h>
+
 uORB::DeviceMaster::DeviceMaster()
 {
 	px4_sem_init(&_lock, 0, 1);
@@ -176,6 +179,64 @@ void uORB::DeviceMaster::printStatistics(bool reset)
 	}
 }
 
+int uORB::DeviceMaster::sampleStatistics(TopicStatistics *statistics, int max_statistics)
+{
+	int num_statistics = 0;
+
+	lock();
+
+	const hrt_abstime now = hrt_absolute_time();
+
+	for (DeviceNode *node = _node_list.getHead(); node != nullptr; node = node->getSibling()) {
+		DeviceNode::Statistics node_statistics;
+		node->sample_statistics(node_statistics);
+
+		if ((node_statistics.publications == 0 && node_statistics.copies == 0) || now <= node_statistics.start) {
+			continue;
+		}
+
+		const float interval_s = (now - node_statistics.start) * 1e-6f;
+		const uint32_t bytes_per_second = (uint64_t)(node_statistics.publications + node_statistics.copies) *
+						  node->get_meta()->o_size / interval_s;
+
+		// insertion into the sorted output, dropping the topic with the lowest bandwidth if full
+		int index = num_statistics;
+
+		while (index > 0 && statistics[index - 1].bytes_per_second < bytes_per_second) {
+			if (index < max_statistics) {
+				statistics[index] = statistics[index - 1];
+			}
+
+			--index;
+		}
+
+		if (index >= max_statistics) {
+			continue;
+		}
+
+		if (num_statistics < max_statistics) {
+			++num_statistics;
+		}
+
+		TopicStatistics &s = statistics[index];
+		s.meta = node->get_meta();
+		s.instance = node->get_instance();
+		s.queue_size = node->get_queue_size();
+		s.subscribers = node->subscriber_count();
+		s.publish_rate = node_statistics.publications / interval_s;
+		s.copy_rate = node_statistics.copies / interval_s;
+		s.bytes_per_second = bytes_per_second;
+		s.reader_lag_mean = node_statistics.copies > 0 ? (float)node_statistics.lag_sum / node_statistics.copies : 0.f;
+		s.reader_lag_max = node_statistics.lag_max;
+		s.copy_time_ns = node_statistics.copy_time_samples > 0 ?
+				 (float)node_statistics.copy_time_sum / node_statistics.copy_time_samples : NAN;
+	}
+
+	unlock();
+
+	return num_statistics;
+}
+
 void uORB::DeviceMaster::addNewDeviceNodes(DeviceNodeStatisticsData **first_node, int &num_topics,
 		size_t &max_topic_name_length, char **topic_filter, int num_filters)
 {
@@ -376,6 +437,179 @@ void uORB::DeviceMaster::showTop(char **topic_filter, int num_filters)
 
 #undef CLEAR_LINE
 
+uORB::Tap **uORB::DeviceMaster::attachTaps(char **topic_filter, int num_filters, unsigned queue_length, int &num_taps,
+		size_t &max_topic_name_length)
+{
+	num_taps = 0;
+	max_topic_name_length = 0;
+
+	lock();
+
+	int num_nodes = 0;
+
+	for (DeviceNode *node = _node_list.getHead(); node != nullptr; node = node->getSibling()) {
+		++num_nodes;
+	}
+
+	Tap **taps = new Tap *[num_nodes];
+
+	if (!taps) {
+		unlock();
+		return nullptr;
+	}
+
+	for (DeviceNode *node = _node_list.getHead(); node != nullptr; node = node->getSibling()) {
+
+		if (num_filters > 0 && topic_filter) {
+			bool matched = false;
+
+			for (int i = 0; i < num_filters; ++i) {
+				if (strstr(node->get_meta()->o_name, topic_filter[i])) {
+					matched = true;
+				}
+			}
+
+			if (!matched) {
+				continue;
+			}
+		}
+
+		Tap *tap = new Tap(node, queue_length);
+
+		if (!tap || !tap->init()) {
+			PX4_ERR("mem alloc failed");
+			delete tap;
+			break;
+		}
+
+		if (!node->set_tap(tap)) {
+			PX4_WARN("%s is already observed", node->get_meta()->o_name);
+			delete tap;
+			continue;
+		}
+
+		taps[num_taps++] = tap;
+
+		size_t name_length = strlen(node->get_meta()->o_name);
+
+		if (name_length > max_topic_name_length) {
+			max_topic_name_length = name_length;
+		}
+	}
+
+	unlock();
+
+	return taps;
+}
+
+void uORB::DeviceMaster::detachTaps(Tap **taps, int num_taps)
+{
+	for (int i = 0; i < num_taps; ++i) {
+		taps[i]->node()->set_tap(nullptr);
+		delete taps[i];
+	}
+
+	delete[] taps;
+}
+
+void uORB::DeviceMaster::showStats(char **topic_filter, int num_filters, float duration_s)
+{
+	int num_taps = 0;
+	size_t max_topic_name_length = 0;
+	Tap **taps = attachTaps(topic_filter, num_filters, 0, num_taps, max_topic_name_length);
+
+	if (!taps) {
+		return;
+	}
+
+	if (num_taps == 0) {
+		PX4_INFO("no matching topics");
+		detachTaps(taps, num_taps);
+		return;
+	}
+
+	PX4_INFO("observing %i topics for %.1f s", num_taps, (double)duration_s);
+
+	px4_usleep(duration_s * 1e6f);
+
+	// detach first, a tap that is not attached anymore does not change
+	for (int i = 0; i < num_taps; ++i) {
+		taps[i]->node()->set_tap(nullptr);
+	}
+
+	PX4_INFO_RAW("%-*s INST   COUNT RATE[Hz] MEAN[ms] JITR[ms]  MIN[ms]  MAX[ms]\n", (int)max_topic_name_length,
+		     "TOPIC NAME");
+
+	for (int i = 0; i < num_taps; ++i) {
+		taps[i]->print_statistics(max_topic_name_length);
+	}
+
+	detachTaps(taps, num_taps);
+}
+
+int uORB::DeviceMaster::record(char **topic_filter, int num_filters, float duration_s, unsigned queue_length,
+			       const char *filename)
+{
+	int num_taps = 0;
+	size_t max_topic_name_length = 0;
+	Tap **taps = attachTaps(topic_filter, num_filters, queue_length, num_taps, max_topic_name_length);
+
+	if (!taps) {
+		return -ENOMEM;
+	}
+
+	if (num_taps == 0) {
+		PX4_INFO("no matching topics");
+		detachTaps(taps, num_taps);
+		return -ENOENT;
+	}
+
+	TapRecorder recorder(taps, num_taps);
+	int ret = recorder.open(filename);
+
+	if (ret != 0) {
+		PX4_ERR("failed to open %s (%i)", filename, ret);
+		detachTaps(taps, num_taps);
+		return ret;
+	}
+
+	PX4_INFO("recording %i topics for %.1f s to %s", num_taps, (double)duration_s, filename);
+
+	const hrt_abstime start_time = hrt_absolute_time();
+
+	while (ret >= 0 && hrt_elapsed_time(&start_time) < duration_s * 1e6f) {
+		px4_usleep(10000);
+		ret = recorder.write_queued();
+	}
+
+	for (int i = 0; i < num_taps; ++i) {
+		taps[i]->node()->set_tap(nullptr);
+	}
+
+	if (ret >= 0) {
+		ret = recorder.write_queued();
+	}
+
+	if (ret < 0) {
+		PX4_ERR("write failed (%i)", ret);
+
+	} else {
+		PX4_INFO_RAW("%-*s INST   COUNT DROPPED\n", (int)max_topic_name_length, "TOPIC NAME");
+
+		for (int i = 0; i < num_taps; ++i) {
+			PX4_INFO_RAW("%-*s %4i %7u %7u\n", (int)max_topic_name_length, taps[i]->meta()->o_name,
+				     (int)taps[i]->node()->get_instance(), (unsigned)taps[i]->count(), (unsigned)taps[i]->dropped());
+		}
+
+		PX4_INFO("wrote %u bytes", (unsigned)recorder.bytes_written());
+		ret = 0;
+	}
+
+	detachTaps(taps, num_taps);
+
+	return ret;
+}
+
 uORB::DeviceNode *uORB::DeviceMaster::getDeviceNode(const char *nodepath)
 {
 	lock();
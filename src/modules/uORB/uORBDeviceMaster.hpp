@@ -43,6 +43,7 @@ namespace uORB
 class DeviceNode;
 class DeviceMaster;
 class Manager;
+class Tap;
 }
 
 #include <string.h>
@@ -84,6 +85,48 @@ public:
 	 */
 	void showTop(char **topic_filter, int num_filters);
 
+	/**
+	 * Observe the publications of the topics for a while, then print their rate, interval jitter
+	 * and interval histogram.
+	 * @param topic_filter list of topic filters: if set, each string can be a substring for topics to match.
+	 * @param num_filters
+	 * @param duration_s observation duration [s]
+	 */
+	void showStats(char **topic_filter, int num_filters, float duration_s);
+
+	/**
+	 * Record every publication of the topics, together with its publication time, into a ULog file.
+	 * @param topic_filter list of topic filters: if set, each string can be a substring for topics to match.
+	 * @param num_filters
+	 * @param duration_s recording duration [s]
+	 * @param queue_length number of samples buffered per topic between writes to the file
+	 * @param filename output file
+	 * @return 0 on success, <0 error otherwise
+	 */
+	int record(char **topic_filter, int num_filters, float duration_s, unsigned queue_length, const char *filename);
+
+	struct TopicStatistics {
+		const orb_metadata *meta;
+		uint8_t instance;
+		uint8_t queue_size;
+		int8_t subscribers;
+		float publish_rate;		///< [Hz]
+		float copy_rate;		///< [Hz]
+		uint32_t bytes_per_second;	///< publications and copies
+		float reader_lag_mean;		///< [generations]
+		uint16_t reader_lag_max;	///< [generations]
+		float copy_time_ns;		///< mean publication copy time, NAN if not measured
+	};
+
+	/**
+	 * Sample the publication and copy statistics of all topics since the previous call,
+	 * and return the ones with the highest memory bandwidth.
+	 * @param statistics output, sorted by decreasing bytes_per_second
+	 * @param max_statistics maximum number of topics to return
+	 * @return number of returned topics (only topics with publications or copies are returned)
+	 */
+	int sampleStatistics(TopicStatistics *statistics, int max_statistics);
+
 private:
 	// Private constructor, uORB::Manager takes care of its creation
 	DeviceMaster();
@@ -101,6 +144,14 @@ private:
 	void addNewDeviceNodes(DeviceNodeStatisticsData **first_node, int &num_topics, size_t &max_topic_name_length,
 			       char **topic_filter, int num_filters);
 
+	/**
+	 * Attach a tap to each existing topic matching the filter.
+	 * @return array of num_taps taps (to be released with detachTaps()), nullptr on failure
+	 */
+	Tap **attachTaps(char **topic_filter, int num_filters, unsigned queue_length, int &num_taps,
+			 size_t &max_topic_name_length);
+	void detachTaps(Tap **taps, int num_taps);
+
 	friend class uORB::Manager;
 
 	/**
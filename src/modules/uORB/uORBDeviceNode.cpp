@@ -36,11 +36,26 @@
 #include "uORBDeviceNode.hpp"
 #include "uORBUtils.hpp"
 #include "uORBManager.hpp"
+#include "uORBTap.hpp"
 
 #ifdef ORB_COMMUNICATOR
 #include "uORBCommunicator.hpp"
 #endif /* ORB_COMMUNICATOR */
 
+#ifndef __PX4_NUTTX
+/**
+ * Real time clock for the copy time statistics [ns]. A copy takes well below
+ * the microsecond resolution of hrt_absolute_time(), and is not in lockstep.
+ * NuttX has no such clock, the copy time is not measured there.
+ */
+static inline uint64_t copy_time_ns()
+{
+	struct timespec ts;
+	system_clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif /* __PX4_NUTTX */
+
 uORB::DeviceNode::SubscriberData *uORB::DeviceNode::filp_to_sd(cdev::file_t *filp)
 {
 #ifndef __PX4_NUTTX
@@ -61,6 +76,7 @@ uORB::DeviceNode::DeviceNode(const struct orb_metadata *meta, const uint8_t inst
 	_priority(priority),
 	_queue_size(queue_size)
 {
+	_statistics.start = hrt_absolute_time();
 }
 
 uORB::DeviceNode::~DeviceNode()
@@ -184,6 +200,17 @@ uORB::DeviceNode::read(cdev::file_t *filp, char *buffer, size_t buflen)
 	 */
 	ATOMIC_ENTER;
 
+	{
+		const unsigned lag = _generation - sd->generation;
+		_statistics.lag_sum += lag;
+
+		if (lag > _statistics.lag_max) {
+			_statistics.lag_max = lag > UINT16_MAX ? UINT16_MAX : lag;
+		}
+
+		++_statistics.copies;
+	}
+
 	if (_generation > sd->generation + _queue_size) {
 		/* Reader is too far behind: some messages are lost */
 		_lost_messages += _generation - (sd->generation + _queue_size);
@@ -268,15 +295,37 @@ uORB::DeviceNode::write(cdev::file_t *filp, const char *buffer, size_t buflen)
 
 	/* Perform an atomic copy. */
 	ATOMIC_ENTER;
+
+#ifndef __PX4_NUTTX
+	/* the copy time is only sampled, to keep the cost of the time measurement off most publications */
+	const bool sample_copy_time = (_generation % 8) == 0;
+	const uint64_t copy_start = sample_copy_time ? copy_time_ns() : 0;
+#endif /* __PX4_NUTTX */
+
 	memcpy(_data + (_meta->o_size * (_generation % _queue_size)), buffer, _meta->o_size);
 
+#ifndef __PX4_NUTTX
+
+	if (sample_copy_time) {
+		_statistics.copy_time_sum += copy_time_ns() - copy_start;
+		++_statistics.copy_time_samples;
+	}
+
+#endif /* __PX4_NUTTX */
+
 	/* update the timestamp and generation count */
 	_last_update = hrt_absolute_time();
+
+	++_statistics.publications;
 	/* wrap-around happens after ~49 days, assuming a publisher rate of 1 kHz */
 	_generation++;
 
 	_published = true;
 
+	if (_tap) {
+		_tap->published(_last_update, buffer);
+	}
+
 	ATOMIC_LEAVE;
 
 	/* notify any poll waiters */
@@ -413,10 +462,11 @@ uORB::DeviceNode::publish(const orb_metadata *meta, orb_advert_t handle, const v
 #ifdef ORB_COMMUNICATOR
 	/*
 	 * if the write is successful, send the data over the Multi-ORB link
+	 * (topics are identified by name, so only the first instance is shared)
 	 */
 	uORBCommunicator::IChannel *ch = uORB::Manager::get_instance()->get_uorb_communicator();
 
-	if (ch != nullptr) {
+	if (ch != nullptr && devnode->_instance == 0) {
 		if (ch->send_message(meta->o_name, meta->o_size, (uint8_t *)data) != 0) {
 			PX4_ERR("Error Sending [%s] topic data over comm_channel", meta->o_name);
 			return PX4_ERROR;
@@ -768,6 +818,35 @@ int16_t uORB::DeviceNode::process_received_message(int32_t length, uint8_t *data
 }
 #endif /* ORB_COMMUNICATOR */
 
+bool uORB::DeviceNode::set_tap(Tap *tap)
+{
+	bool ret = true;
+
+	ATOMIC_ENTER;
+
+	if (tap && _tap) {
+		ret = false;
+
+	} else {
+		_tap = tap;
+	}
+
+	ATOMIC_LEAVE;
+
+	return ret;
+}
+
+void uORB::DeviceNode::sample_statistics(Statistics &statistics)
+{
+	const hrt_abstime now = hrt_absolute_time();
+
+	ATOMIC_ENTER;
+	statistics = _statistics;
+	_statistics = Statistics{};
+	_statistics.start = now;
+	ATOMIC_LEAVE;
+}
+
 int uORB::DeviceNode::update_queue_size(unsigned int queue_size)
 {
 	if (_queue_size == queue_size) {
@@ -45,6 +45,7 @@ namespace uORB
 class DeviceNode;
 class DeviceMaster;
 class Manager;
+class Tap;
 }
 
 /**
@@ -195,6 +196,32 @@ public:
 	int get_priority() const { return _priority; }
 	void set_priority(uint8_t priority) { _priority = priority; }
 
+	/**
+	 * Attach a tap that observes every publication, or detach it with nullptr.
+	 * Once this returns, a detached tap is not accessed anymore and can be deleted.
+	 * @return false if another tap is already attached
+	 */
+	bool set_tap(Tap *tap);
+
+	/**
+	 * Publication and copy counters, accumulated since the last call to sample_statistics().
+	 */
+	struct Statistics {
+		hrt_abstime start{0};		///< start of the interval
+		uint32_t publications{0};
+		uint32_t copies{0};
+		uint32_t lag_sum{0};		///< sum over all copies of the generations the subscriber was behind
+		uint16_t lag_max{0};
+		uint16_t copy_time_samples{0};
+		uint32_t copy_time_sum{0};	///< [ns] sum of the sampled publication copy times
+	};
+
+	/**
+	 * Get the counters of the current interval and start a new one.
+	 * There is only a single consumer (load_mon via DeviceMaster::sampleStatistics()).
+	 */
+	void sample_statistics(Statistics &statistics);
+
 protected:
 
 	pollevent_t poll_state(cdev::file_t *filp) override;
@@ -232,12 +259,15 @@ private:
 	uint8_t _queue_size; /**< maximum number of elements in the queue */
 	int8_t _subscriber_count{0};
 
+	Tap *_tap{nullptr}; /**< observer for 'uorb stats' and 'uorb record', only set while they run */
+
 	px4_task_t _publisher{0}; /**< if nonzero, current publisher. Only used inside the advertise call.
 						We allow one publisher to have an open file descriptor at the same time. */
 
 	// statistics
 	uint32_t _lost_messages = 0; /**< nr of lost messages for all subscribers. If two subscribers lose the same
 					message, it is counted as two. */
+	Statistics _statistics{};
 
 	inline static SubscriberData    *filp_to_sd(cdev::file_t *filp);
 
@@ -37,6 +37,7 @@
 #include "uORB.h"
 #include "uORBCommon.hpp"
 
+#include <px4_getopt.h>
 #include <px4_log.h>
 #include <px4_module.h>
 
@@ -71,6 +72,13 @@ modules are allowed to publish which topics. This is used for system-wide replay
 ### Examples
 Monitor topic publication rates. Besides `top`, this is an important command for general system inspection:
 $ uorb top
+
+Measure the rate, interval jitter and interval histogram of the sensor topics over 5 seconds:
+$ uorb stats -t 5 sensor_
+
+Record every publication of the attitude topics for 10 seconds, e.g. for latency debugging without the logger.
+The ULog file contains '<topic>_tap' messages with the publication time as timestamp and the sample as nested field:
+$ uorb record -t 10 -f att.ulg vehicle_attitude
 )DESCR_STR");
 
 	PRINT_MODULE_USAGE_NAME("uorb", "communication");
@@ -79,6 +87,72 @@ $ uorb top
 	PRINT_MODULE_USAGE_COMMAND_DESCR("top", "Monitor topic publication rates");
 	PRINT_MODULE_USAGE_PARAM_FLAG('a', "print all instead of only currently publishing topics", true);
 	PRINT_MODULE_USAGE_ARG("<filter1> [<filter2>]", "topic(s) to match (implies -a)", true);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("stats", "Measure publication rate, interval jitter and interval histogram");
+	PRINT_MODULE_USAGE_PARAM_FLOAT('t', 5.f, 0.1f, 3600.f, "Duration in seconds", true);
+	PRINT_MODULE_USAGE_ARG("<filter1> [<filter2>]", "topic(s) to match (default: all)", true);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("record", "Record all publications with their publication time to a ULog file");
+	PRINT_MODULE_USAGE_PARAM_FLOAT('t', 10.f, 0.1f, 3600.f, "Duration in seconds", true);
+	PRINT_MODULE_USAGE_PARAM_INT('q', 64, 1, 10000, "Samples buffered per topic", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('f', PX4_STORAGEDIR "/uorb_record.ulg", "<file>", "Output file", true);
+	PRINT_MODULE_USAGE_ARG("<filter1> [<filter2>]", "topic(s) to match (default: all)", true);
+}
+
+/**
+ * 'uorb stats' and 'uorb record'
+ */
+static int tap_command(int argc, char *argv[])
+{
+	float duration_s = -1.f;
+	unsigned queue_length = 64;
+	const char *filename = PX4_STORAGEDIR "/uorb_record.ulg";
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "t:q:f:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 't':
+			duration_s = strtof(myoptarg, nullptr);
+			break;
+
+		case 'q':
+			queue_length = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		case 'f':
+			filename = myoptarg;
+			break;
+
+		default:
+			usage();
+			return -EINVAL;
+		}
+	}
+
+	// options are moved in front, argv[myoptind] is the command, followed by the topic filters
+	if (myoptind >= argc || queue_length == 0) {
+		usage();
+		return -EINVAL;
+	}
+
+	const bool record = !strcmp(argv[myoptind], "record");
+
+	if (duration_s <= 0.f) {
+		duration_s = record ? 10.f : 5.f;
+	}
+
+	if (g_dev == nullptr) {
+		PX4_INFO("uorb is not running");
+		return OK;
+	}
+
+	if (record) {
+		return g_dev->record(argv + myoptind + 1, argc - myoptind - 1, duration_s, queue_length, filename);
+	}
+
+	g_dev->showStats(argv + myoptind + 1, argc - myoptind - 1, duration_s);
+	return OK;
 }
 
 int
@@ -147,6 +221,10 @@ uorb_main(int argc, char *argv[])
 		return OK;
 	}
 
+	if (!strcmp(argv[1], "stats") || !strcmp(argv[1], "record")) {
+		return tap_command(argc, argv);
+	}
+
 	usage();
 	return -EINVAL;
 }
@@ -0,0 +1,380 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "uORBTap.hpp"
+#include "uORBDeviceNode.hpp"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+#include <px4_log.h>
+#include <modules/logger/messages.h>
+
+#include "uORBTopics.h"
+
+uORB::Tap::Tap(DeviceNode *node, unsigned queue_length) :
+	_node(node),
+	_meta(node->get_meta()),
+	_queue_length(queue_length),
+	_entry_size(sizeof(hrt_abstime) + node->get_meta()->o_size)
+{
+}
+
+uORB::Tap::~Tap()
+{
+	delete[] _queue;
+}
+
+bool uORB::Tap::init()
+{
+	if (_queue_length == 0) {
+		return true;
+	}
+
+	_queue = new uint8_t[_queue_length * _entry_size];
+	return _queue != nullptr;
+}
+
+void uORB::Tap::published(hrt_abstime timestamp, const void *data)
+{
+	if (_count > 0) {
+		const uint32_t interval = (timestamp - _last) > UINT32_MAX ? UINT32_MAX : (uint32_t)(timestamp - _last);
+
+		_interval_sum += interval;
+		_interval_sum_sq += (uint64_t)interval * interval;
+
+		if (interval < _interval_min) {
+			_interval_min = interval;
+		}
+
+		if (interval > _interval_max) {
+			_interval_max = interval;
+		}
+
+		int bucket = 0;
+
+		for (uint32_t i = interval / HISTOGRAM_FIRST_US; i > 0 && bucket < HISTOGRAM_BUCKETS - 1; i >>= 1) {
+			++bucket;
+		}
+
+		++_histogram[bucket];
+
+	} else {
+		_first = timestamp;
+	}
+
+	_last = timestamp;
+	++_count;
+
+	if (_queue) {
+		const uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+
+		if (_head - tail >= _queue_length) {
+			++_dropped;
+			return;
+		}
+
+		uint8_t *entry = _queue + (_head % _queue_length) * _entry_size;
+		memcpy(entry, &timestamp, sizeof(timestamp));
+		memcpy(entry + sizeof(timestamp), data, _meta->o_size);
+
+		__atomic_store_n(&_head, _head + 1, __ATOMIC_RELEASE);
+	}
+}
+
+const uint8_t *uORB::Tap::front(hrt_abstime &timestamp) const
+{
+	if (!_queue || __atomic_load_n(&_head, __ATOMIC_ACQUIRE) == _tail) {
+		return nullptr;
+	}
+
+	const uint8_t *entry = _queue + (_tail % _queue_length) * _entry_size;
+	memcpy(&timestamp, entry, sizeof(timestamp));
+	return entry + sizeof(timestamp);
+}
+
+void uORB::Tap::pop()
+{
+	__atomic_store_n(&_tail, _tail + 1, __ATOMIC_RELEASE);
+}
+
+float uORB::Tap::rate() const
+{
+	if (_count < 2 || _last == _first) {
+		return 0.f;
+	}
+
+	return (_count - 1) * 1e6f / (float)(_last - _first);
+}
+
+float uORB::Tap::interval_mean() const
+{
+	return _count > 1 ? (float)((double)_interval_sum / (_count - 1)) : 0.f;
+}
+
+float uORB::Tap::interval_jitter() const
+{
+	if (_count < 3) {
+		return 0.f;
+	}
+
+	const double n = _count - 1;
+	const double mean = _interval_sum / n;
+	const double variance = _interval_sum_sq / n - mean * mean;
+
+	return variance > 0. ? (float)sqrt(variance) : 0.f;
+}
+
+void uORB::Tap::print_statistics(int name_width) const
+{
+	PX4_INFO_RAW("%-*s %4i %7u %8.1f %8.3f %8.3f %8.3f %8.3f\n", name_width, _meta->o_name, (int)_node->get_instance(),
+		     (unsigned)_count, (double)rate(), (double)interval_mean() / 1e3, (double)interval_jitter() / 1e3,
+		     interval_min() / 1e3, interval_max() / 1e3);
+
+	if (_count < 2) {
+		return;
+	}
+
+	PX4_INFO_RAW("  intervals:");
+
+	for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+		if (_histogram[i] == 0) {
+			continue;
+		}
+
+		const float lower_ms = i == 0 ? 0.f : (HISTOGRAM_FIRST_US << (i - 1)) / 1e3f;
+
+		if (i == HISTOGRAM_BUCKETS - 1) {
+			PX4_INFO_RAW(" >=%g: %u", (double)lower_ms, (unsigned)_histogram[i]);
+
+		} else {
+			PX4_INFO_RAW(" %g-%g: %u", (double)lower_ms, (HISTOGRAM_FIRST_US << i) / 1e3, (unsigned)_histogram[i]);
+		}
+	}
+
+	PX4_INFO_RAW(" ms\n");
+}
+
+
+uORB::TapRecorder::TapRecorder(Tap **taps, int num_taps) :
+	_taps(taps),
+	_num_taps(num_taps)
+{
+}
+
+uORB::TapRecorder::~TapRecorder()
+{
+	if (_file) {
+		fclose(_file);
+	}
+}
+
+bool uORB::TapRecorder::write(const void *data, size_t size)
+{
+	if (fwrite(data, 1, size, _file) != size) {
+		return false;
+	}
+
+	_bytes_written += size;
+	return true;
+}
+
+int uORB::TapRecorder::open(const char *filename)
+{
+	_file = fopen(filename, "wb");
+
+	if (!_file) {
+		return -errno;
+	}
+
+	ulog_file_header_s header = {};
+	header.magic[0] = 'U';
+	header.magic[1] = 'L';
+	header.magic[2] = 'o';
+	header.magic[3] = 'g';
+	header.magic[4] = 0x01;
+	header.magic[5] = 0x12;
+	header.magic[6] = 0x35;
+	header.magic[7] = 0x01; //file version 1
+	header.timestamp = hrt_absolute_time();
+
+	// the Flags message must be written right after the header
+	ulog_message_flag_bits_s flag_bits{};
+	flag_bits.msg_size = sizeof(flag_bits) - ULOG_MSG_HEADER_LEN;
+	flag_bits.msg_type = static_cast<uint8_t>(ULogMessageType::FLAG_BITS);
+
+	if (!write(&header, sizeof(header)) || !write(&flag_bits, sizeof(flag_bits))) {
+		return -EIO;
+	}
+
+	const orb_metadata **written = new const orb_metadata *[orb_topics_count()];
+
+	if (!written) {
+		return -ENOMEM;
+	}
+
+	int num_written = 0;
+	bool ok = true;
+
+	for (int i = 0; i < _num_taps && ok; ++i) {
+		const orb_metadata *meta = _taps[i]->meta();
+		bool wrapper_written = false;
+
+		for (int j = 0; j < i; ++j) {
+			wrapper_written |= _taps[j]->meta() == meta;
+		}
+
+		if (wrapper_written) {
+			continue;
+		}
+
+		// the topic itself might already be written as nested type of another one
+		bool already_written = false;
+
+		for (int j = 0; j < num_written; ++j) {
+			already_written |= written[j] == meta;
+		}
+
+		if (!already_written) {
+			ok = write_format(meta, written, num_written, 0);
+		}
+
+		// the wrapper with the publication time, one per topic (instances share it)
+		ulog_message_format_s format;
+		int format_len = snprintf(format.format, sizeof(format.format), "%s_tap:uint64_t timestamp;%s sample;",
+					  meta->o_name, meta->o_name);
+		format.msg_size = sizeof(format) - sizeof(format.format) + format_len - ULOG_MSG_HEADER_LEN;
+		ok = ok && write(&format, format.msg_size + ULOG_MSG_HEADER_LEN);
+	}
+
+	delete[] written;
+
+	for (int i = 0; i < _num_taps && ok; ++i) {
+		ulog_message_add_logged_s msg;
+		int name_len = snprintf(msg.message_name, sizeof(msg.message_name), "%s_tap", _taps[i]->meta()->o_name);
+		msg.msg_id = i;
+		msg.multi_id = _taps[i]->node()->get_instance();
+		msg.msg_size = sizeof(msg) - sizeof(msg.message_name) - ULOG_MSG_HEADER_LEN + name_len;
+		ok = write(&msg, msg.msg_size + ULOG_MSG_HEADER_LEN);
+	}
+
+	return ok ? 0 : -EIO;
+}
+
+bool uORB::TapRecorder::write_format(const orb_metadata *meta, const orb_metadata **written, int &num_written,
+				     int level)
+{
+	if (level > 3) {
+		// nested topic definitions are not deeper than that
+		PX4_ERR("max recursion level reached (%i)", level);
+		return false;
+	}
+
+	ulog_message_format_s format;
+	int format_len = snprintf(format.format, sizeof(format.format), "%s:%s", meta->o_name, meta->o_fields);
+	format.msg_size = sizeof(format) - sizeof(format.format) + format_len - ULOG_MSG_HEADER_LEN;
+
+	if (!write(&format, format.msg_size + ULOG_MSG_HEADER_LEN)) {
+		return false;
+	}
+
+	written[num_written++] = meta;
+
+	// nested types, o_fields looks like this for example: "uint64_t timestamp;position_setpoint current;"
+	const char *fmt = meta->o_fields;
+
+	while (fmt && *fmt) {
+		const char *space = strchr(fmt, ' ');
+
+		if (!space) {
+			break;
+		}
+
+		const char *array_start = strchr(fmt, '[');
+		const size_t type_length = (array_start && array_start < space) ? array_start - fmt : space - fmt;
+
+		const orb_metadata *const *topics = orb_get_topics();
+
+		for (size_t i = 0; i < orb_topics_count(); i++) {
+			if (strlen(topics[i]->o_name) != type_length || strncmp(topics[i]->o_name, fmt, type_length) != 0) {
+				continue;
+			}
+
+			bool already_written = false;
+
+			for (int j = 0; j < num_written; ++j) {
+				already_written |= written[j] == topics[i];
+			}
+
+			if (!already_written && !write_format(topics[i], written, num_written, level + 1)) {
+				return false;
+			}
+
+			break;
+		}
+
+		fmt = strchr(fmt, ';');
+
+		if (fmt) { ++fmt; }
+	}
+
+	return true;
+}
+
+int uORB::TapRecorder::write_queued()
+{
+	int count = 0;
+	ulog_message_data_header_s header;
+
+	for (int i = 0; i < _num_taps; ++i) {
+		Tap *tap = _taps[i];
+		hrt_abstime timestamp;
+		const uint8_t *sample;
+
+		header.msg_id = i;
+		header.msg_size = sizeof(header) - ULOG_MSG_HEADER_LEN + sizeof(timestamp) + tap->meta()->o_size_no_padding;
+
+		while ((sample = tap->front(timestamp)) != nullptr) {
+			if (!write(&header, sizeof(header)) || !write(&timestamp, sizeof(timestamp)) ||
+			    !write(sample, tap->meta()->o_size_no_padding)) {
+				return -EIO;
+			}
+
+			tap->pop();
+			++count;
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,187 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "uORBCommon.hpp"
+
+namespace uORB
+{
+class DeviceNode;
+class Tap;
+class TapRecorder;
+}
+
+/**
+ * Passive observer of a topic instance, used by 'uorb stats' and 'uorb record'.
+ *
+ * A tap is called by the DeviceNode on every publication while the node is locked,
+ * so it only does constant, allocation-free work: update the interval statistics
+ * and, if a queue is configured, copy the sample into it. The queue has a single
+ * consumer (the recorder), which reads it without taking the node lock. Samples are
+ * dropped (and counted) when the queue is full.
+ */
+class uORB::Tap
+{
+public:
+	/// publication intervals are counted in buckets [0, 125us), [125us, 250us), ... with the last one open
+	static constexpr int HISTOGRAM_BUCKETS = 12;
+	static constexpr uint32_t HISTOGRAM_FIRST_US = 125;
+
+	/**
+	 * @param queue_length number of samples to queue for recording, 0 for statistics only
+	 */
+	Tap(DeviceNode *node, unsigned queue_length);
+	~Tap();
+
+	// no copy, assignment, move, move assignment
+	Tap(const Tap &) = delete;
+	Tap &operator=(const Tap &) = delete;
+	Tap(Tap &&) = delete;
+	Tap &operator=(Tap &&) = delete;
+
+	/**
+	 * Allocate the queue.
+	 * @return true on success
+	 */
+	bool init();
+
+	/**
+	 * Called by the DeviceNode for every publication, with the node locked.
+	 * @param timestamp publication time
+	 * @param data sample, of size o_size
+	 */
+	void published(hrt_abstime timestamp, const void *data);
+
+	/**
+	 * Oldest queued sample (consumer side).
+	 * @param timestamp publication time of the sample
+	 * @return the sample (valid until pop()), nullptr if the queue is empty
+	 */
+	const uint8_t *front(hrt_abstime &timestamp) const;
+
+	/**
+	 * Remove the oldest queued sample (consumer side).
+	 */
+	void pop();
+
+	DeviceNode *node() const { return _node; }
+	const orb_metadata *meta() const { return _meta; }
+
+	uint32_t count() const { return _count; }
+	uint32_t dropped() const { return _dropped; }
+
+	/** publication rate over the observed period [Hz] */
+	float rate() const;
+
+	/** mean, standard deviation (jitter), minimum and maximum publication interval [us] */
+	float interval_mean() const;
+	float interval_jitter() const;
+	uint32_t interval_min() const { return _count > 1 ? _interval_min : 0; }
+	uint32_t interval_max() const { return _interval_max; }
+
+	uint32_t histogram(int bucket) const { return _histogram[bucket]; }
+
+	/**
+	 * Print the statistics as one line (name, instance, count, rate and interval statistics)
+	 * followed by the interval histogram.
+	 */
+	void print_statistics(int name_width) const;
+
+private:
+	DeviceNode *_node;
+	const orb_metadata *_meta;
+	const unsigned _queue_length;
+	const size_t _entry_size;
+
+	uint8_t *_queue{nullptr};	///< queue_length entries of [hrt_abstime timestamp, o_size data]
+	uint32_t _head{0};		///< written by the publisher only
+	uint32_t _tail{0};		///< written by the consumer only
+
+	// statistics, written by the publisher only
+	uint32_t _count{0};
+	uint32_t _dropped{0};
+	hrt_abstime _first{0};
+	hrt_abstime _last{0};
+	uint64_t _interval_sum{0};
+	uint64_t _interval_sum_sq{0};
+	uint32_t _interval_min{UINT32_MAX};
+	uint32_t _interval_max{0};
+	uint32_t _histogram[HISTOGRAM_BUCKETS] {};
+};
+
+/**
+ * Writes the samples queued by a set of taps to a ULog file.
+ *
+ * Each topic is logged as '<topic>_tap', a message with the publication time as
+ * timestamp and the original sample as nested 'sample' field, so that the
+ * publication latency is the difference of 'timestamp' and 'sample.timestamp'.
+ */
+class uORB::TapRecorder
+{
+public:
+	TapRecorder(Tap **taps, int num_taps);
+	~TapRecorder();
+
+	// no copy, assignment, move, move assignment
+	TapRecorder(const TapRecorder &) = delete;
+	TapRecorder &operator=(const TapRecorder &) = delete;
+	TapRecorder(TapRecorder &&) = delete;
+	TapRecorder &operator=(TapRecorder &&) = delete;
+
+	/**
+	 * Create the file and write the ULog header and message definitions.
+	 * @return 0 on success, <0 error otherwise
+	 */
+	int open(const char *filename);
+
+	/**
+	 * Write all queued samples.
+	 * @return number of samples written, <0 on error
+	 */
+	int write_queued();
+
+	size_t bytes_written() const { return _bytes_written; }
+
+private:
+	bool write(const void *data, size_t size);
+	bool write_format(const orb_metadata *meta, const orb_metadata **written, int &num_written, int level);
+
+	Tap **_taps;
+	const int _num_taps;
+	FILE *_file{nullptr};
+	size_t _bytes_written{0};
+};
@@ -40,6 +40,7 @@
 #include <string.h>
 
 #include <perf/perf_counter.h>
+#include <perf/latency_trace.h>
 
 __EXPORT int perf_main(int argc, char *argv[]);
 
@@ -51,6 +52,7 @@ static void print_usage(void)
 	PRINT_MODULE_USAGE_NAME_SIMPLE("perf", "command");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("reset", "Reset all counters");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("latency", "Print HRT timer latency histogram");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("trace", "Print sensor to actuator output latency histograms");
 
 	PRINT_MODULE_USAGE_PARAM_COMMENT("Prints all performance counters if no arguments given");
 }
@@ -67,6 +69,11 @@ int perf_main(int argc, char *argv[])
 			perf_print_latency(1 /* stdout */);
 			fflush(stdout);
 			return 0;
+
+		} else if (strcmp(argv[1], "trace") == 0) {
+			latency_trace_print(1 /* stdout */);
+			fflush(stdout);
+			return 0;
 		}
 
 		print_usage();
@@ -0,0 +1,373 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_obstacle_map.cpp
+ *
+ * Obstacle map for collision prevention: fusion of the range sources, movement of the
+ * vehicle and a benchmark with 1 kHz range streams.
+ */
+
+#include <lib/CollisionPrevention/ObstacleMap.hpp>
+
+#include "tests_main.h"
+
+#include <float.h>
+#include <mathlib/mathlib.h>
+#include <perf/perf_counter.h>
+#include <unit_test.h>
+
+using matrix::Vector2f;
+
+class ObstacleMapTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool _obstacle_distance();
+	bool _distance_sensor();
+	bool _movement();
+	bool _fusion();
+	bool _velocity_reduction();
+	bool _benchmark();
+
+	static obstacle_distance_s emptyObstacleDistance(hrt_abstime timestamp, uint8_t increment);
+	static distance_sensor_s distanceSensor(hrt_abstime timestamp, uint8_t orientation, float distance);
+};
+
+bool ObstacleMapTest::run_tests()
+{
+	ut_run_test(_obstacle_distance);
+	ut_run_test(_distance_sensor);
+	ut_run_test(_movement);
+	ut_run_test(_fusion);
+	ut_run_test(_velocity_reduction);
+	ut_run_test(_benchmark);
+
+	return (_tests_failed == 0);
+}
+
+obstacle_distance_s ObstacleMapTest::emptyObstacleDistance(hrt_abstime timestamp, uint8_t increment)
+{
+	obstacle_distance_s obstacle_distance{};
+	obstacle_distance.timestamp = timestamp;
+	obstacle_distance.increment = increment;
+	obstacle_distance.min_distance = 20;
+	obstacle_distance.max_distance = 2000;
+
+	for (int i = 0; i < 72; i++) {
+		obstacle_distance.distances[i] = UINT16_MAX;
+	}
+
+	return obstacle_distance;
+}
+
+distance_sensor_s ObstacleMapTest::distanceSensor(hrt_abstime timestamp, uint8_t orientation, float distance)
+{
+	distance_sensor_s distance_sensor{};
+	distance_sensor.timestamp = timestamp;
+	distance_sensor.min_distance = 0.2f;
+	distance_sensor.max_distance = 5.f;
+	distance_sensor.current_distance = distance;
+	distance_sensor.signal_quality = -1;
+	distance_sensor.orientation = orientation;
+	return distance_sensor;
+}
+
+bool ObstacleMapTest::_obstacle_distance()
+{
+	ObstacleMap map;
+	map.setPosition(Vector2f(0.f, 0.f));
+
+	// obstacle north, free east, unknown elsewhere
+	obstacle_distance_s obstacle_distance = emptyObstacleDistance(1000, 5);
+	obstacle_distance.distances[0] = 300;
+	obstacle_distance.distances[18] = 2001;
+	obstacle_distance.distances[36] = 10;
+	map.addObstacleDistance(obstacle_distance);
+
+	ut_assert_true(map.isObstacle(0));
+	ut_compare_float("north", map.distance(0), 3.f, 3);
+	ut_compare_float("max distance", map.maxDistance(0), 20.f, 3);
+	ut_assert_false(map.isObstacle(18));
+	ut_assert_false(map.isObstacle(36));
+	ut_assert_false(map.isObstacle(1));
+	ut_compare("last update", map.lastUpdate(), 1000);
+
+	// 10 degree elements cover two bins each
+	map.reset();
+	map.setPosition(Vector2f(0.f, 0.f));
+	obstacle_distance = emptyObstacleDistance(1000, 10);
+	obstacle_distance.distances[9] = 500;
+	map.addObstacleDistance(obstacle_distance);
+
+	ut_assert_false(map.isObstacle(16));
+	ut_assert_true(map.isObstacle(17));
+	ut_assert_true(map.isObstacle(18));
+	ut_assert_false(map.isObstacle(19));
+
+	ut_compare("bin of east", ObstacleMap::bin(M_PI_2_F), 18);
+	ut_compare("bin of north west", ObstacleMap::bin(-M_PI_4_F), 63);
+	ut_compare("bin just below north", ObstacleMap::bin(-0.01f), 0);
+	return true;
+}
+
+bool ObstacleMapTest::_distance_sensor()
+{
+	ObstacleMap map;
+	map.setPosition(Vector2f(0.f, 0.f));
+
+	// forward facing while heading east
+	map.addDistanceSensor(distanceSensor(1000, distance_sensor_s::ROTATION_FORWARD_FACING, 2.f), M_PI_2_F);
+	ut_assert_true(map.isObstacle(18));
+	ut_compare_float("east", map.distance(18), 2.f, 3);
+
+	// left facing while heading east points north
+	map.addDistanceSensor(distanceSensor(1000, distance_sensor_s::ROTATION_LEFT_FACING, 4.f), M_PI_2_F);
+	ut_assert_true(map.isObstacle(0));
+
+	// backward facing while heading north points south
+	map.addDistanceSensor(distanceSensor(1000, distance_sensor_s::ROTATION_BACKWARD_FACING, 1.f), 0.f);
+	ut_assert_true(map.isObstacle(36));
+
+	// a downward facing sensor is not an obstacle
+	map.reset();
+	map.setPosition(Vector2f(0.f, 0.f));
+	map.addDistanceSensor(distanceSensor(1000, distance_sensor_s::ROTATION_DOWNWARD_FACING, 1.f), 0.f);
+
+	for (int i = 0; i < ObstacleMap::BIN_COUNT; i++) {
+		ut_assert_false(map.isObstacle(i));
+	}
+
+	ut_compare("no update", map.lastUpdate(), 0);
+
+	// out of range
+	map.addDistanceSensor(distanceSensor(1000, distance_sensor_s::ROTATION_FORWARD_FACING, 0.1f), 0.f);
+	ut_assert_false(map.isObstacle(0));
+	return true;
+}
+
+bool ObstacleMapTest::_movement()
+{
+	ObstacleMap map;
+	map.setPosition(Vector2f(0.f, 0.f));
+
+	obstacle_distance_s obstacle_distance = emptyObstacleDistance(1000, 5);
+	obstacle_distance.distances[0] = 400;
+	obstacle_distance.distances[1] = 1000;
+	map.addObstacleDistance(obstacle_distance);
+
+	// 2m east the first obstacle is north north west
+	map.setPosition(Vector2f(0.f, 2.f));
+	const int bin = ObstacleMap::bin(atan2f(-2.f, 4.f));
+	ut_compare("moved bin", bin, 67);
+	ut_assert_true(map.isObstacle(bin));
+	ut_compare_float("moved distance", map.distance(bin), sqrtf(20.f), 3);
+	ut_assert_false(map.isObstacle(0));
+
+	// the second obstacle moves with the distance seen from the new position
+	const float bearing = math::radians(5.f);
+	const Vector2f second = Vector2f(cosf(bearing), sinf(bearing)) * 10.f - Vector2f(0.f, 2.f);
+	const int second_bin = ObstacleMap::bin(atan2f(second(1), second(0)));
+	ut_compare("second bin", second_bin, 71);
+	ut_compare_float("second distance", map.distance(second_bin), second.norm(), 3);
+
+	int obstacles = 0;
+
+	for (int i = 0; i < ObstacleMap::BIN_COUNT; i++) {
+		obstacles += map.isObstacle(i) ? 1 : 0;
+	}
+
+	ut_compare("no obstacle lost", obstacles, 2);
+
+	// back to the start puts them back
+	map.setPosition(Vector2f(0.f, 0.f));
+	ut_compare_float("back north", map.distance(0), 4.f, 3);
+	ut_compare_float("back", map.distance(1), 10.f, 3);
+
+	// small movements do not shift the bins
+	map.setPosition(Vector2f(0.01f, 0.f));
+	ut_compare_float("not shifted", map.distance(0), 4.f, 3);
+	return true;
+}
+
+bool ObstacleMapTest::_fusion()
+{
+	ObstacleMap map;
+	map.setPosition(Vector2f(0.f, 0.f));
+
+	// a close obstacle from one source is kept when another one sees a farther one right after
+	map.addDistanceSensor(distanceSensor(1000, distance_sensor_s::ROTATION_FORWARD_FACING, 2.f), 0.f);
+	obstacle_distance_s obstacle_distance = emptyObstacleDistance(11000, 5);
+	obstacle_distance.distances[0] = 400;
+	map.addObstacleDistance(obstacle_distance);
+	ut_compare_float("closer kept", map.distance(0), 2.f, 3);
+
+	// and when the other source sees no obstacle
+	obstacle_distance.timestamp = 21000;
+	obstacle_distance.distances[0] = 2001;
+	map.addObstacleDistance(obstacle_distance);
+	ut_assert_true(map.isObstacle(0));
+
+	// after the fusion window the newer measurement replaces it
+	obstacle_distance.timestamp = 201000;
+	obstacle_distance.distances[0] = 400;
+	map.addObstacleDistance(obstacle_distance);
+	ut_compare_float("replaced", map.distance(0), 4.f, 3);
+
+	// a closer obstacle always replaces
+	map.addDistanceSensor(distanceSensor(202000, distance_sensor_s::ROTATION_FORWARD_FACING, 3.f), 0.f);
+	ut_compare_float("closer", map.distance(0), 3.f, 3);
+
+	// bins which are not measured again expire
+	map.expire(500000, 500000);
+	ut_assert_true(map.isObstacle(0));
+	map.expire(800000, 500000);
+	ut_assert_false(map.isObstacle(0));
+	return true;
+}
+
+bool ObstacleMapTest::_velocity_reduction()
+{
+	ObstacleMap map;
+	map.setPosition(Vector2f(0.f, 0.f));
+
+	// no obstacle, no reduction
+	ut_compare_float("free", map.velocityReduction(0, 1.f), 0.f, 3);
+
+	// linear from the 5m sensor range down to the 1m minimum distance
+	map.addDistanceSensor(distanceSensor(1000, distance_sensor_s::ROTATION_FORWARD_FACING, 3.f), 0.f);
+	ut_compare_float("braking", map.velocityReduction(0, 1.f), 0.5f, 3);
+
+	// inside the minimum distance the vehicle stops, but is never pushed back
+	map.addDistanceSensor(distanceSensor(2000, distance_sensor_s::ROTATION_FORWARD_FACING, 0.5f), 0.f);
+	ut_compare_float("stop", map.velocityReduction(0, 1.f), 1.f, 3);
+
+	// a sensor range not beyond the minimum distance leaves no room to brake
+	ObstacleMap short_range;
+	short_range.setPosition(Vector2f(0.f, 0.f));
+	short_range.addDistanceSensor(distanceSensor(1000, distance_sensor_s::ROTATION_FORWARD_FACING, 4.9f), 0.f);
+
+	const float min_distances[] = {5.f, 6.f};
+
+	for (const float min_distance : min_distances) {
+		const float reduction = short_range.velocityReduction(0, min_distance);
+		ut_assert_true(PX4_ISFINITE(reduction));
+		ut_compare_float("no braking range", reduction, 1.f, 3);
+	}
+
+	return true;
+}
+
+bool ObstacleMapTest::_benchmark()
+{
+	// a wall 10m north, a 360 degree sensor and four single beam sensors at 1 kHz while flying east at 2m/s
+	const float wall = 10.f;
+	const int steps = 2000;
+	const hrt_abstime dt = 1000;
+
+	perf_counter_t add_obstacle_distance = perf_alloc(PC_ELAPSED, "obstacle_map: add obstacle_distance");
+	perf_counter_t add_distance_sensor = perf_alloc(PC_ELAPSED, "obstacle_map: add distance_sensor");
+	perf_counter_t set_position = perf_alloc(PC_ELAPSED, "obstacle_map: set position");
+	perf_counter_t constraints = perf_alloc(PC_ELAPSED, "obstacle_map: constraints");
+
+	ObstacleMap map;
+	obstacle_distance_s obstacle_distance = emptyObstacleDistance(0, 5);
+	const uint8_t orientations[4] = {
+		distance_sensor_s::ROTATION_FORWARD_FACING,
+		distance_sensor_s::ROTATION_RIGHT_FACING,
+		distance_sensor_s::ROTATION_BACKWARD_FACING,
+		distance_sensor_s::ROTATION_LEFT_FACING
+	};
+
+	float constraint_north = 0.f;
+
+	for (int k = 0; k < steps; k++) {
+		const hrt_abstime now = (k + 1) * dt;
+		const Vector2f position(0.f, 2.f * k * dt * 1e-6f);
+
+		perf_begin(set_position);
+		map.setPosition(position);
+		perf_end(set_position);
+
+		for (int i = 0; i < 72; i++) {
+			const float bearing = math::radians(i * 5.f);
+			const float distance = (cosf(bearing) > FLT_EPSILON) ? wall / cosf(bearing) : FLT_MAX;
+			obstacle_distance.distances[i] = (distance < 20.f) ? (uint16_t)(distance * 100.f) : 2001;
+		}
+
+		obstacle_distance.timestamp = now;
+
+		perf_begin(add_obstacle_distance);
+		map.addObstacleDistance(obstacle_distance);
+		perf_end(add_obstacle_distance);
+
+		for (int i = 0; i < 4; i++) {
+			// heading north: only the forward facing sensor sees the wall, out of its range
+			perf_begin(add_distance_sensor);
+			map.addDistanceSensor(distanceSensor(now, orientations[i], (i == 0) ? wall : 6.f), 0.f);
+			perf_end(add_distance_sensor);
+		}
+
+		perf_begin(constraints);
+		map.expire(now, 500000);
+		constraint_north = 0.f;
+
+		for (int i = 0; i < ObstacleMap::BIN_COUNT; i++) {
+			if (map.isObstacle(i)) {
+				const float reduction = map.velocityReduction(i, 1.f);
+				constraint_north = math::max(constraint_north, reduction * map.binNorth(i));
+			}
+		}
+
+		perf_end(constraints);
+	}
+
+	perf_print_counter(set_position);
+	perf_print_counter(add_obstacle_distance);
+	perf_print_counter(add_distance_sensor);
+	perf_print_counter(constraints);
+
+	perf_free(set_position);
+	perf_free(add_obstacle_distance);
+	perf_free(add_distance_sensor);
+	perf_free(constraints);
+
+	// the wall straight ahead limits the motion north
+	ut_compare_float("wall north", map.distance(0), wall, 2);
+	ut_compare_float("constraint", constraint_north, (20.f - wall) / (20.f - 1.f), 2);
+	return true;
+}
+
+ut_declare_test_c(test_obstacle_map, ObstacleMapTest)
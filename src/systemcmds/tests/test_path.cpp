@@ -0,0 +1,168 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_path.cpp
+ *
+ * Lateral path with rounded corners: geometry, projection and arc length lookup.
+ */
+
+#include <lib/path/Path.hpp>
+
+#include "tests_main.h"
+
+#include <unit_test.h>
+
+using matrix::Vector2f;
+using path::Path;
+
+class PathTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool _corner();
+	bool _projection();
+	bool _short_legs();
+	bool _invalid();
+};
+
+bool PathTest::run_tests()
+{
+	ut_run_test(_corner);
+	ut_run_test(_projection);
+	ut_run_test(_short_legs);
+	ut_run_test(_invalid);
+
+	return (_tests_failed == 0);
+}
+
+bool PathTest::_corner()
+{
+	// square, right turns of 90 degrees
+	const Vector2f waypoints[] = {{0.f, 0.f}, {100.f, 0.f}, {100.f, 100.f}, {0.f, 100.f}};
+	Path path;
+	ut_assert_true(path.build(waypoints, 4, 20.f));
+
+	// line, arc, line, arc, line
+	ut_compare("segments", path.segmentCount(), 5);
+	ut_compare_float("turn distance", path.turnDistance(1), 20.f, 3);
+	ut_compare_float("no turn at the start", path.turnDistance(0), 0.f, 3);
+	const float length = 3 * 100.f - 4 * 20.f + 2 * 20.f * M_PI_2_F;
+	ut_compare_float("length", path.length(), length, 2);
+
+	const Path::Segment &arc = path.segment(1);
+	ut_compare_float("radius", arc.radius, 20.f, 3);
+	ut_compare_float("right turn", arc.direction, 1.f, 3);
+	ut_compare_float("center north", arc.center(0), 80.f, 3);
+	ut_compare_float("center east", arc.center(1), 20.f, 3);
+
+	// the middle of the corner arc
+	const Vector2f middle = path.position(arc.s_start + 0.5f * arc.length);
+	const float middle_north = 80.f + 20.f * M_SQRT1_2_F;
+	const float middle_east = 20.f - 20.f * M_SQRT1_2_F;
+	ut_compare_float("arc middle north", middle(0), middle_north, 2);
+	ut_compare_float("arc middle east", middle(1), middle_east, 2);
+
+	// clipped to the ends
+	ut_compare_float("before start", path.position(-10.f)(0), 0.f, 3);
+	ut_compare_float("after end", path.position(path.length() + 10.f)(0), 0.f, 3);
+	ut_compare_float("after end", path.position(path.length() + 10.f)(1), 100.f, 3);
+	return true;
+}
+
+bool PathTest::_projection()
+{
+	const Vector2f waypoints[] = {{0.f, 0.f}, {100.f, 0.f}, {100.f, -100.f}};
+	Path path;
+	ut_assert_true(path.build(waypoints, 3, 20.f));
+
+	// points on the path project onto themselves, walking forward along it
+	for (float s = 0.f; s <= path.length(); s += 5.f) {
+		const Path::Projection projection = path.project(path.position(s));
+		ut_compare_float("arc length", projection.s, s, 2);
+		ut_compare_float("on the path", projection.crosstrack, 0.f, 2);
+	}
+
+	Path path2;
+	ut_assert_true(path2.build(waypoints, 3, 20.f));
+
+	// right of the first leg
+	Path::Projection projection = path2.project(Vector2f(50.f, 5.f));
+	ut_compare("first leg", projection.segment, 0);
+	ut_compare_float("right", projection.crosstrack, 5.f, 3);
+	ut_compare_float("tangent", projection.tangent(0), 1.f, 3);
+
+	// inside the left turn is left of the path
+	projection = path2.project(Vector2f(90.f, -5.f));
+	ut_compare("arc", projection.segment, 1);
+	ut_assert_true(projection.crosstrack < 0.f);
+
+	// does not go back to the first leg
+	projection = path2.project(Vector2f(50.f, 0.f));
+	ut_compare("stays on the arc", projection.segment, 1);
+	return true;
+}
+
+bool PathTest::_short_legs()
+{
+	// the arc cannot start before the middle of the legs
+	const Vector2f waypoints[] = {{0.f, 0.f}, {10.f, 0.f}, {10.f, 10.f}};
+	Path path;
+	ut_assert_true(path.build(waypoints, 3, 100.f));
+	ut_compare_float("turn distance", path.turnDistance(1), 5.f, 3);
+	ut_compare_float("reduced radius", path.segment(1).radius, 5.f, 3);
+
+	// straight on: no arc
+	const Vector2f straight[] = {{0.f, 0.f}, {10.f, 0.f}, {20.f, 0.f}};
+	ut_assert_true(path.build(straight, 3, 20.f));
+	ut_compare("two lines", path.segmentCount(), 2);
+	ut_compare_float("length", path.length(), 20.f, 3);
+	return true;
+}
+
+bool PathTest::_invalid()
+{
+	Path path;
+	const Vector2f duplicate[] = {{0.f, 0.f}, {0.f, 0.f}, {0.f, 10.f}};
+	ut_assert_false(path.build(duplicate, 3, 20.f));
+	ut_assert_false(path.valid());
+
+	const Vector2f single[] = {{0.f, 0.f}};
+	ut_assert_false(path.build(single, 1, 20.f));
+	ut_compare_float("empty length", path.length(), 0.f, 3);
+	return true;
+}
+
+ut_declare_test_c(test_path, PathTest)
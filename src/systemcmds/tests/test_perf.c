@@ -65,5 +65,48 @@ test_perf(int argc, char *argv[])
 	perf_free(cc);
 	perf_free(ec);
 
+	perf_counter_t hc = perf_alloc(PC_HISTOGRAM, "test_histogram");
+
+	if (hc == NULL) {
+		printf("perf: histogram counter alloc failed\n");
+		return 1;
+	}
+
+	// 990 events of 10us and 10 events of 1000us
+	for (int i = 0; i < 1000; i++) {
+		perf_set_elapsed(hc, (i % 100 == 0) ? 1000 : 10);
+	}
+
+	if (perf_event_count(hc) != 1000) {
+		printf("perf: histogram expected 1000 events, got %llu\n", (unsigned long long)perf_event_count(hc));
+		perf_free(hc);
+		return 1;
+	}
+
+	const uint32_t p50 = perf_histogram_percentile(hc, 0.5f);
+	const uint32_t p999 = perf_histogram_percentile(hc, 0.999f);
+
+	// log2 buckets: 10us is in [8, 16), 1000us in [512, 1024)
+	if (p50 < 8 || p50 >= 16 || p999 < 512 || p999 > 1000) {
+		printf("perf: histogram percentiles out of range (p50 %u, p99.9 %u)\n", (unsigned)p50, (unsigned)p999);
+		perf_free(hc);
+		return 1;
+	}
+
+	perf_begin(hc);
+	perf_end(hc);
+	printf("perf: expect count of 1001\n");
+	perf_print_counter(hc);
+
+	perf_reset(hc);
+
+	if (perf_event_count(hc) != 0 || perf_histogram_percentile(hc, 0.5f) != 0) {
+		printf("perf: histogram reset failed\n");
+		perf_free(hc);
+		return 1;
+	}
+
+	perf_free(hc);
+
 	return OK;
 }
@@ -0,0 +1,235 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_px4io_protocol.cpp
+ *
+ * PX4IO serial protocol tests: cycle page layout and packet framing.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include <px4iofirmware/protocol.h>
+
+#include "tests_main.h"
+
+#include <unit_test.h>
+
+class PX4IOProtocolTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool _cycle_fits_transfer();
+	bool _cycle_layout();
+	bool _cycle_servo_padding();
+	bool _packet_roundtrip();
+	bool _packet_corruption();
+
+	void _fill_pages();
+	void _build_reply(IOPacket &pkt);
+
+	uint16_t _status[PX4IO_P_STATUS_MIXER + 1] {};
+	uint16_t _servos[PX4IO_P_CYCLE_SERVO_COUNT] {};
+	uint16_t _raw_rc[PX4IO_P_RAW_RC_BASE + 18] {};
+};
+
+bool PX4IOProtocolTest::run_tests()
+{
+	ut_run_test(_cycle_fits_transfer);
+	ut_run_test(_cycle_layout);
+	ut_run_test(_cycle_servo_padding);
+	ut_run_test(_packet_roundtrip);
+	ut_run_test(_packet_corruption);
+
+	return (_tests_failed == 0);
+}
+
+void PX4IOProtocolTest::_fill_pages()
+{
+	for (unsigned i = 0; i < sizeof(_status) / sizeof(_status[0]); i++) {
+		_status[i] = 0x1000 + i;
+	}
+
+	for (unsigned i = 0; i < sizeof(_servos) / sizeof(_servos[0]); i++) {
+		_servos[i] = 1000 + 100 * i;
+	}
+
+	for (unsigned i = 0; i < sizeof(_raw_rc) / sizeof(_raw_rc[0]); i++) {
+		_raw_rc[i] = 0x2000 + i;
+	}
+
+	_raw_rc[PX4IO_P_RAW_RC_COUNT] = 12;
+}
+
+void PX4IOProtocolTest::_build_reply(IOPacket &pkt)
+{
+	/* what the IO serial handler sends back for a read of the cycle page */
+	memset(&pkt, 0, sizeof(pkt));
+	pkt.count_code = PX4IO_P_CYCLE_COUNT | PKT_CODE_SUCCESS;
+	pkt.page = PX4IO_PAGE_CYCLE;
+	pkt.offset = 0;
+	px4io_cycle_pack(pkt.regs, _status, _servos, PX4IO_P_CYCLE_SERVO_COUNT, _raw_rc);
+	pkt.crc = 0;
+	pkt.crc = crc_packet(&pkt);
+}
+
+bool PX4IOProtocolTest::_cycle_fits_transfer()
+{
+	/* the FMU keeps two bytes of the IO transfer size in reserve */
+	ut_assert_true(PX4IO_P_CYCLE_COUNT * sizeof(uint16_t) <= PX4IO_MAX_TRANSFER_LEN - 2);
+	ut_assert_true(PX4IO_P_CYCLE_COUNT <= PKT_COUNT_MASK);
+	ut_assert_true(PX4IO_P_CYCLE_COUNT <= PKT_MAX_REGS);
+
+	/* the FMU reads 9 channels with the prolog in the common case */
+	ut_compare("raw rc channels", PX4IO_P_CYCLE_RAW_RC_CHANNELS, 9);
+	ut_compare("cycle end", PX4IO_P_CYCLE_RAW_RC + PX4IO_P_RAW_RC_BASE + PX4IO_P_CYCLE_RAW_RC_CHANNELS,
+		   PX4IO_P_CYCLE_COUNT);
+
+	return true;
+}
+
+bool PX4IOProtocolTest::_cycle_layout()
+{
+	_fill_pages();
+
+	uint16_t cycle[PX4IO_P_CYCLE_COUNT];
+	memset(cycle, 0xff, sizeof(cycle));
+	px4io_cycle_pack(cycle, _status, _servos, PX4IO_P_CYCLE_SERVO_COUNT, _raw_rc);
+
+	ut_compare("flags", cycle[PX4IO_P_CYCLE_FLAGS], _status[PX4IO_P_STATUS_FLAGS]);
+	ut_compare("alarms", cycle[PX4IO_P_CYCLE_ALARMS], _status[PX4IO_P_STATUS_ALARMS]);
+	ut_compare("vservo", cycle[PX4IO_P_CYCLE_VSERVO], _status[PX4IO_P_STATUS_VSERVO]);
+	ut_compare("vrssi", cycle[PX4IO_P_CYCLE_VRSSI], _status[PX4IO_P_STATUS_VRSSI]);
+	ut_compare("mixer", cycle[PX4IO_P_CYCLE_MIXER], _status[PX4IO_P_STATUS_MIXER]);
+
+	for (unsigned i = 0; i < PX4IO_P_CYCLE_SERVO_COUNT; i++) {
+		ut_compare("servo", cycle[PX4IO_P_CYCLE_SERVOS + i], _servos[i]);
+	}
+
+	/* the raw R/C section must read exactly like the start of PX4IO_PAGE_RAW_RC_INPUT */
+	ut_assert_true(memcmp(&cycle[PX4IO_P_CYCLE_RAW_RC], _raw_rc,
+			      (PX4IO_P_RAW_RC_BASE + PX4IO_P_CYCLE_RAW_RC_CHANNELS) * sizeof(uint16_t)) == 0);
+	ut_compare("rc count", cycle[PX4IO_P_CYCLE_RAW_RC + PX4IO_P_RAW_RC_COUNT], 12);
+
+	return true;
+}
+
+bool PX4IOProtocolTest::_cycle_servo_padding()
+{
+	_fill_pages();
+
+	uint16_t cycle[PX4IO_P_CYCLE_COUNT];
+	memset(cycle, 0xff, sizeof(cycle));
+	px4io_cycle_pack(cycle, _status, _servos, 4, _raw_rc);
+
+	for (unsigned i = 0; i < 4; i++) {
+		ut_compare("servo", cycle[PX4IO_P_CYCLE_SERVOS + i], _servos[i]);
+	}
+
+	for (unsigned i = 4; i < PX4IO_P_CYCLE_SERVO_COUNT; i++) {
+		ut_compare("padding", cycle[PX4IO_P_CYCLE_SERVOS + i], 0);
+	}
+
+	/* padding must not shift the R/C section */
+	ut_compare("rc flags", cycle[PX4IO_P_CYCLE_RAW_RC + PX4IO_P_RAW_RC_FLAGS], _raw_rc[PX4IO_P_RAW_RC_FLAGS]);
+
+	return true;
+}
+
+bool PX4IOProtocolTest::_packet_roundtrip()
+{
+	_fill_pages();
+
+	IOPacket pkt;
+	_build_reply(pkt);
+
+	ut_compare("size", PKT_SIZE(pkt), 4 + PX4IO_P_CYCLE_COUNT * sizeof(uint16_t));
+	ut_compare("count", PKT_COUNT(pkt), PX4IO_P_CYCLE_COUNT);
+	ut_compare("code", PKT_CODE(pkt), PKT_CODE_SUCCESS);
+
+	/* receiver side check, as done on both ends of the link */
+	IOPacket rx;
+	memcpy(&rx, &pkt, PKT_SIZE(pkt));
+	uint8_t crc = rx.crc;
+	rx.crc = 0;
+	ut_compare("crc", crc_packet(&rx), crc);
+
+	ut_compare("flags", rx.regs[PX4IO_P_CYCLE_FLAGS], _status[PX4IO_P_STATUS_FLAGS]);
+	ut_compare("last rc channel", rx.regs[PX4IO_P_CYCLE_COUNT - 1],
+		   _raw_rc[PX4IO_P_RAW_RC_BASE + PX4IO_P_CYCLE_RAW_RC_CHANNELS - 1]);
+
+	return true;
+}
+
+bool PX4IOProtocolTest::_packet_corruption()
+{
+	_fill_pages();
+
+	IOPacket pkt;
+	_build_reply(pkt);
+
+	const unsigned size = PKT_SIZE(pkt);
+	const uint8_t crc = pkt.crc;
+
+	/* CRC-8 catches every single bit error in the frame */
+	for (unsigned byte = 0; byte < size; byte++) {
+		if (byte == offsetof(IOPacket, crc)) {
+			continue;
+		}
+
+		for (unsigned bit = 0; bit < 8; bit++) {
+			IOPacket rx;
+			memcpy(&rx, &pkt, sizeof(pkt));
+			((uint8_t *)&rx)[byte] ^= (1 << bit);
+
+			/* a flipped count changes the frame length, keep it within the packet */
+			if (PKT_COUNT(rx) > PKT_MAX_REGS) {
+				continue;
+			}
+
+			rx.crc = 0;
+
+			if (crc_packet(&rx) == crc && PKT_COUNT(rx) == PKT_COUNT(pkt)) {
+				PX4_ERR("undetected bit error at byte %u bit %u", byte, bit);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+ut_declare_test_c(test_px4io_protocol, PX4IOProtocolTest)
@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_startup_script.cpp
+ *
+ * In-process startup script executor: runs the shell constructs used by rcS,
+ * rc.replay and rc.interface and compares the result with /bin/sh.
+ */
+
+#include <px4_daemon/startup_script.h>
+
+#include "tests_main.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <unit_test.h>
+
+class StartupScriptTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool _constructs();
+	bool _unsupported();
+
+	static void write_file(const std::string &path, const std::string &content);
+	static std::string read_file(const std::string &path);
+	static std::string replace(std::string text, const std::string &from, const std::string &to);
+	static int run_shell(const std::string &script);
+};
+
+/* rcS, rc.replay and rc.interface style commands, all results end up in @OUT@ */
+static const char *constructs_script =
+	"out=@OUT@\n"
+	"rules=\"$out.rules\"\n"
+	"LOG_FILE=$out\n"
+	"VEHICLE_TYPE=mc\n"
+	"MIXER=quad_x\n"
+	"\n"
+	"echo \"start $VEHICLE_TYPE\" > \"$out\"\n"
+	"\n"
+	"if [ \"$VEHICLE_TYPE\" = fw ]; then\n"
+	"	echo \"fixed wing\" >> $LOG_FILE\n"
+	"elif [ \"$VEHICLE_TYPE\" = mc ]; then\n"
+	"	echo \"multicopter $MIXER\" >> $LOG_FILE\n"
+	"else\n"
+	"	echo \"unknown\" >> $LOG_FILE\n"
+	"fi\n"
+	"\n"
+	"case $MIXER in\n"
+	"	quad*) echo \"case quad\" >> $LOG_FILE ;;\n"
+	"	*) echo \"case other\" >> $LOG_FILE ;;\n"
+	"esac\n"
+	"\n"
+	"autostart=$(echo \"10016_iris\" | sed 's/_.*//')\n"
+	"echo \"autostart $autostart $((autostart + 1))\" >> \"$out\"\n"
+	"\n"
+	"for rotor in 1 2 3 4; do\n"
+	"	echo \"rotor $rotor\" 2>&1 >> \"$out\"\n"
+	"done\n"
+	"\n"
+	"cat <<EOF > \"$rules\"\n"
+	"restrict_topics: sensor_combined, vehicle_gps_position, vehicle_land_detected\n"
+	"module: $VEHICLE_TYPE\n"
+	"ignore_others: false\n"
+	"EOF\n"
+	"[ -f \"$rules\" ] && cat \"$rules\" >> \"$out\"\n"
+	"\n"
+	"echo \"background\" >> \"$out\" &\n"
+	"wait\n"
+	"\n"
+	"sh @SUB@\n"
+	"echo \"sourced $?\" >> \"$out\"\n";
+
+/* sourced script with syntax the executor does not support */
+static const char *sourced_script =
+	"n=0\n"
+	"while [ $n -lt 2 ]; do\n"
+	"	echo \"while $n\" >> @OUT@\n"
+	"	n=$((n + 1))\n"
+	"done\n"
+	"exit 3\n";
+
+bool StartupScriptTest::run_tests()
+{
+	ut_run_test(_constructs);
+	ut_run_test(_unsupported);
+
+	return (_tests_failed == 0);
+}
+
+void StartupScriptTest::write_file(const std::string &path, const std::string &content)
+{
+	std::ofstream file(path);
+	file << content;
+}
+
+std::string StartupScriptTest::read_file(const std::string &path)
+{
+	std::ifstream file(path);
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	return buffer.str();
+}
+
+std::string StartupScriptTest::replace(std::string text, const std::string &from, const std::string &to)
+{
+	size_t pos;
+
+	while ((pos = text.find(from)) != std::string::npos) {
+		text.replace(pos, from.size(), to);
+	}
+
+	return text;
+}
+
+int StartupScriptTest::run_shell(const std::string &script)
+{
+	const int ret = system(("/bin/sh " + script + " 0").c_str());
+	return (ret != -1 && WIFEXITED(ret)) ? WEXITSTATUS(ret) : -1;
+}
+
+bool StartupScriptTest::_constructs()
+{
+	// paths are relative, like the scripts sourced from the rootfs
+	const char *runs[] = {"startup_script_px4", "startup_script_sh"};
+
+	for (const char *run : runs) {
+		const std::string name = run;
+		const std::string script = replace(constructs_script, "@SUB@", name + "_sub.sh");
+		write_file(name + ".sh", replace(script, "@OUT@", name + ".out"));
+		write_file(name + "_sub.sh", replace(sourced_script, "@OUT@", name + ".out"));
+	}
+
+	px4_daemon::StartupScript script("startup_script_px4.sh", 0);
+	const bool loaded = script.load();
+	const int status_px4 = loaded ? script.run() : -1;
+	const int status_sh = run_shell("startup_script_sh.sh");
+
+	const std::string px4 = read_file("startup_script_px4.out");
+	const std::string sh = read_file("startup_script_sh.out");
+
+	for (const char *run : runs) {
+		const std::string name = run;
+		unlink((name + ".sh").c_str());
+		unlink((name + "_sub.sh").c_str());
+		unlink((name + ".out").c_str());
+		unlink((name + ".out.rules").c_str());
+	}
+
+	if (px4 != sh) {
+		printf("in-process:\n%s/bin/sh:\n%s", px4.c_str(), sh.c_str());
+	}
+
+	ut_assert_true(loaded);
+	ut_compare("status", status_px4, status_sh);
+	ut_assert_true(px4 == sh);
+
+	// every construct made it to the output, not just the same way in both
+	ut_assert_true(px4.find("multicopter quad_x\ncase quad\nautostart 10016 10017\n") != std::string::npos);
+	ut_assert_true(px4.find("rotor 4\nrestrict_topics") != std::string::npos);
+	ut_assert_true(px4.find("module: mc\n") != std::string::npos);
+	ut_assert_true(px4.find("background\nwhile 0\nwhile 1\nsourced 3\n") != std::string::npos);
+	return true;
+}
+
+bool StartupScriptTest::_unsupported()
+{
+	// a top-level script like this is left to /bin/sh by the caller
+	write_file("startup_script_pipe.sh", "ls | wc -l\n");
+	write_file("startup_script_here.sh", "cat <<EOF\nno end\n");
+
+	px4_daemon::StartupScript pipe("startup_script_pipe.sh", 0);
+	px4_daemon::StartupScript here("startup_script_here.sh", 0);
+	const bool pipe_loaded = pipe.load();
+	const bool here_loaded = here.load();
+
+	unlink("startup_script_pipe.sh");
+	unlink("startup_script_here.sh");
+
+	ut_assert_false(pipe_loaded);
+	ut_assert_false(here_loaded);
+	return true;
+}
+
+ut_declare_test_c(test_startup_script, StartupScriptTest)
@@ -0,0 +1,305 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_survey_pattern.cpp
+ *
+ * Survey lane generation from a polygon: lane count and spacing, lane direction,
+ * serpentine order and concave polygons.
+ */
+
+#include <modules/navigator/survey_pattern.h>
+
+#include "tests_main.h"
+
+#include <mathlib/mathlib.h>
+#include <unit_test.h>
+
+class SurveyPatternTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool _rectangle();
+	bool _rotated();
+	bool _concave();
+	bool _lane_count();
+	bool _invalid();
+
+	/** polygon from north/east vertices [m], the first one at the reference */
+	bool build(SurveyPattern &survey, const float vertices[][2], int count, float spacing, float direction);
+
+	/** north/east position [m] of a generated waypoint */
+	bool position(const SurveyPattern &survey, int i, float &north, float &east);
+
+	map_projection_reference_s _ref{};
+};
+
+bool SurveyPatternTest::run_tests()
+{
+	map_projection_init(&_ref, 47.397742, 8.545594);
+
+	ut_run_test(_rectangle);
+	ut_run_test(_rotated);
+	ut_run_test(_concave);
+	ut_run_test(_lane_count);
+	ut_run_test(_invalid);
+
+	return (_tests_failed == 0);
+}
+
+bool SurveyPatternTest::build(SurveyPattern &survey, const float vertices[][2], int count, float spacing,
+			      float direction)
+{
+	mission_item_s item{};
+	item.nav_cmd = NAV_CMD_SURVEY;
+	item.vertex_count = count;
+	item.survey_spacing = spacing;
+	item.survey_direction = direction;
+	item.altitude = 30.f;
+	item.altitude_is_relative = true;
+	item.acceptance_radius = 5.f;
+
+	for (int i = 0; i < count; i++) {
+		map_projection_reproject(&_ref, vertices[i][0], vertices[i][1], &item.lat, &item.lon);
+
+		if ((i == 0 && !survey.begin(item, 10)) || !survey.addVertex(item)) {
+			return false;
+		}
+	}
+
+	return survey.complete();
+}
+
+bool SurveyPatternTest::position(const SurveyPattern &survey, int i, float &north, float &east)
+{
+	mission_item_s item{};
+
+	if (!survey.waypoint(i, item) || item.nav_cmd != NAV_CMD_WAYPOINT) {
+		return false;
+	}
+
+	map_projection_project(&_ref, item.lat, item.lon, &north, &east);
+	return true;
+}
+
+bool SurveyPatternTest::_rectangle()
+{
+	const float rectangle[][2] = {{0.f, 0.f}, {100.f, 0.f}, {100.f, 60.f}, {0.f, 60.f}};
+	SurveyPattern survey;
+	ut_assert_true(build(survey, rectangle, 4, 20.f, 0.f));
+
+	ut_compare("first index", survey.firstIndex(), 10);
+	ut_compare("next index", survey.nextIndex(), 14);
+	ut_assert_true(survey.contains(13));
+	ut_assert_false(survey.contains(14));
+
+	// lanes north along the rectangle, centered in 20m wide stripes, flown back and forth
+	const float expected[][2] = {{0.f, 10.f}, {100.f, 10.f}, {100.f, 30.f}, {0.f, 30.f},
+		{0.f, 50.f}, {100.f, 50.f}
+	};
+	ut_compare("waypoints", survey.waypointCount(), 6);
+
+	for (int i = 0; i < 6; i++) {
+		float north;
+		float east;
+		ut_assert_true(position(survey, i, north, east));
+		ut_compare_float("north", north, expected[i][0], 1);
+		ut_compare_float("east", east, expected[i][1], 1);
+	}
+
+	// the waypoints keep the survey altitude and acceptance radius
+	mission_item_s item{};
+	ut_assert_true(survey.waypoint(3, item));
+	ut_compare_float("altitude", item.altitude, 30.f, 3);
+	ut_assert_true(item.altitude_is_relative);
+	ut_compare_float("acceptance radius", item.acceptance_radius, 5.f, 3);
+	ut_assert_true(item.autocontinue);
+	return true;
+}
+
+bool SurveyPatternTest::_rotated()
+{
+	// lanes to the east are spread across the 100m in north direction
+	const float rectangle[][2] = {{0.f, 0.f}, {100.f, 0.f}, {100.f, 60.f}, {0.f, 60.f}};
+	SurveyPattern survey;
+	ut_assert_true(build(survey, rectangle, 4, 30.f, M_PI_2_F));
+
+	const float expected[][2] = {{87.5f, 0.f}, {87.5f, 60.f}, {62.5f, 60.f}, {62.5f, 0.f},
+		{37.5f, 0.f}, {37.5f, 60.f}, {12.5f, 60.f}, {12.5f, 0.f}
+	};
+	ut_compare("waypoints", survey.waypointCount(), 8);
+
+	for (int i = 0; i < 8; i++) {
+		float north;
+		float east;
+		ut_assert_true(position(survey, i, north, east));
+		ut_compare_float("north", north, expected[i][0], 1);
+		ut_compare_float("east", east, expected[i][1], 1);
+	}
+
+	// any direction: every lane is parallel to it
+	const float direction = math::radians(30.f);
+	SurveyPattern survey2;
+	ut_assert_true(build(survey2, rectangle, 4, 15.f, direction));
+
+	for (int i = 0; i + 1 < survey2.waypointCount(); i++) {
+		float north0;
+		float east0;
+		float north1;
+		float east1;
+		ut_assert_true(position(survey2, i, north0, east0));
+		ut_assert_true(position(survey2, i + 1, north1, east1));
+
+		const float along = (north1 - north0) * cosf(direction) + (east1 - east0) * sinf(direction);
+		const float across = -(north1 - north0) * sinf(direction) + (east1 - east0) * cosf(direction);
+
+		if (i % 2 == 0) {
+			// lane, alternating direction
+			ut_compare_float("lane parallel", across, 0.f, 1);
+			ut_assert_true((i % 4 == 0) ? along > 0.f : along < 0.f);
+
+		} else {
+			// next lane, toward the far side of the polygon
+			ut_assert_true(across > 0.f && across <= 15.f + 0.01f);
+		}
+	}
+
+	return true;
+}
+
+bool SurveyPatternTest::_concave()
+{
+	// U shape open to the north, the lanes to the east cross the notch
+	const float u_shape[][2] = {{0.f, 0.f}, {0.f, 90.f}, {100.f, 90.f}, {100.f, 60.f}, {30.f, 60.f},
+		{30.f, 30.f}, {100.f, 30.f}, {100.f, 0.f}
+	};
+	SurveyPattern survey;
+	ut_assert_true(build(survey, u_shape, 8, 50.f, M_PI_2_F));
+
+	// a lane spans the outermost edges it crosses, the notch is flown over
+	const float expected[][2] = {{75.f, 0.f}, {75.f, 90.f}, {25.f, 90.f}, {25.f, 0.f}};
+	ut_compare("waypoints", survey.waypointCount(), 4);
+
+	for (int i = 0; i < 4; i++) {
+		float north;
+		float east;
+		ut_assert_true(position(survey, i, north, east));
+		ut_compare_float("north", north, expected[i][0], 1);
+		ut_compare_float("east", east, expected[i][1], 1);
+	}
+
+	// L shape, the lanes end at the inner corner edges
+	const float l_shape[][2] = {{0.f, 0.f}, {100.f, 0.f}, {100.f, 40.f}, {40.f, 40.f}, {40.f, 100.f}, {0.f, 100.f}};
+	SurveyPattern survey2;
+	ut_assert_true(build(survey2, l_shape, 6, 20.f, 0.f));
+
+	const float expected2[][2] = {{0.f, 10.f}, {100.f, 10.f}, {100.f, 30.f}, {0.f, 30.f}, {0.f, 50.f}, {40.f, 50.f},
+		{40.f, 70.f}, {0.f, 70.f}, {0.f, 90.f}, {40.f, 90.f}
+	};
+	ut_compare("waypoints", survey2.waypointCount(), 10);
+
+	for (int i = 0; i < 10; i++) {
+		float north;
+		float east;
+		ut_assert_true(position(survey2, i, north, east));
+		ut_compare_float("north", north, expected2[i][0], 1);
+		ut_compare_float("east", east, expected2[i][1], 1);
+	}
+
+	return true;
+}
+
+bool SurveyPatternTest::_lane_count()
+{
+	const float rectangle[][2] = {{0.f, 0.f}, {100.f, 0.f}, {100.f, 60.f}, {0.f, 60.f}};
+	const struct {
+		float spacing;
+		int lanes;
+	} cases[] = {{20.f, 3}, {25.f, 3}, {19.f, 4}, {60.f, 1}, {100.f, 1}, {1.f, 60}};
+
+	for (const auto &c : cases) {
+		SurveyPattern survey;
+		ut_assert_true(build(survey, rectangle, 4, c.spacing, 0.f));
+		ut_compare("lanes", survey.waypointCount(), 2 * c.lanes);
+
+		// the lanes are spread evenly, never wider apart than requested
+		const float actual_spacing = 60.f / c.lanes;
+		const float first_lane = 0.5f * actual_spacing;
+		const float last_lane = 60.f - first_lane;
+		float north;
+		float east;
+		ut_assert_true(position(survey, 0, north, east));
+		ut_compare_float("first lane", east, first_lane, 1);
+		ut_assert_true(position(survey, survey.waypointCount() - 1, north, east));
+		ut_compare_float("last lane", east, last_lane, 1);
+		ut_assert_true(actual_spacing <= c.spacing);
+	}
+
+	return true;
+}
+
+bool SurveyPatternTest::_invalid()
+{
+	const float rectangle[][2] = {{0.f, 0.f}, {100.f, 0.f}, {100.f, 60.f}, {0.f, 60.f}};
+	const float line[][2] = {{0.f, 0.f}, {50.f, 0.f}, {100.f, 0.f}};
+	SurveyPattern survey;
+
+	ut_assert_false(build(survey, rectangle, 2, 20.f, 0.f));
+	ut_assert_false(build(survey, rectangle, 4, 0.f, 0.f));
+	ut_assert_false(build(survey, rectangle, 4, NAN, 0.f));
+	ut_assert_false(build(survey, line, 3, 20.f, 0.f));
+	ut_assert_false(survey.valid());
+
+	mission_item_s item{};
+	ut_assert_false(survey.waypoint(0, item));
+
+	// vertices of another polygon, or missing ones
+	mission_item_s vertex{};
+	vertex.nav_cmd = NAV_CMD_SURVEY;
+	vertex.vertex_count = 4;
+	vertex.survey_spacing = 20.f;
+	ut_assert_true(survey.begin(vertex, 0));
+	ut_assert_true(survey.addVertex(vertex));
+	vertex.vertex_count = 3;
+	ut_assert_false(survey.addVertex(vertex));
+	ut_assert_false(survey.complete());
+
+	ut_assert_true(build(survey, rectangle, 4, 20.f, 0.f));
+	ut_assert_false(survey.waypoint(-1, item));
+	ut_assert_false(survey.waypoint(survey.waypointCount(), item));
+	return true;
+}
+
+ut_declare_test_c(test_survey_pattern, SurveyPatternTest)
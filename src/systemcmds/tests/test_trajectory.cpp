@@ -0,0 +1,362 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_trajectory.cpp
+ *
+ * Jerk limited waypoint trajectory: limits, axis synchronization, heading and
+ * a timing comparison with the per axis VelocitySmoothing used by the flight tasks.
+ */
+
+#include <lib/trajectory/JerkLimitedTrajectory.hpp>
+#include <lib/FlightTasks/tasks/Utility/VelocitySmoothing.hpp>
+
+#include "tests_main.h"
+
+#include <float.h>
+#include <mathlib/mathlib.h>
+#include <unit_test.h>
+#include <perf/perf_counter.h>
+#include <px4_defines.h>
+
+using matrix::Vector2f;
+using matrix::Vector3f;
+using trajectory::JerkLimitedTrajectory;
+
+class TrajectoryTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool _single_axis();
+	bool _synchronized();
+	bool _heading();
+	bool _sequence();
+	bool _invalid();
+	bool _benchmark();
+
+	void setLimits(JerkLimitedTrajectory &trajectory);
+
+	static constexpr float dt = 0.004f;
+};
+
+bool TrajectoryTest::run_tests()
+{
+	ut_run_test(_single_axis);
+	ut_run_test(_synchronized);
+	ut_run_test(_heading);
+	ut_run_test(_sequence);
+	ut_run_test(_invalid);
+	ut_run_test(_benchmark);
+
+	return (_tests_failed == 0);
+}
+
+void TrajectoryTest::setLimits(JerkLimitedTrajectory &trajectory)
+{
+	trajectory.setHorizontalLimits({5.f, 3.f, 5.f});
+	trajectory.setVerticalLimits({4.f, 2.f, 3.f}, {4.f, 1.f, 1.f});
+	trajectory.setYawLimits({10.f, 2.f, 0.5f});
+}
+
+bool TrajectoryTest::_single_axis()
+{
+	JerkLimitedTrajectory trajectory;
+	setLimits(trajectory);
+	const JerkLimitedTrajectory::Waypoint waypoints[] = {
+		{Vector3f(0.f, 0.f, -10.f), NAN},
+		{Vector3f(100.f, 0.f, -10.f), NAN}
+	};
+	ut_assert_true(trajectory.plan(waypoints, 2));
+
+	// jerk phases of a / j = 0.6s, acceleration phases of v / a - a / j, cruise for the remaining distance
+	const float t_jerk = 0.6f;
+	const float t_accel = 5.f / 3.f - t_jerk;
+	const float t_cruise = (100.f - 5.f * (2.f * t_jerk + t_accel)) / 5.f;
+	const float duration = 4.f * t_jerk + 2.f * t_accel + t_cruise;
+	ut_compare_float("duration", trajectory.duration(), duration, 3);
+
+	JerkLimitedTrajectory::State state;
+	float vel_prev = 0.f;
+	float vel_max = 0.f;
+
+	for (float t = 0.f; t < trajectory.duration(); t += dt) {
+		trajectory.sample(t, state);
+		ut_assert_true(fabsf(state.velocity(0)) <= 5.f + 0.001f);
+		ut_assert_true(fabsf(state.acceleration(0)) <= 3.f + 0.001f);
+		ut_assert_true(fabsf(state.jerk(0)) <= 5.f + 0.001f);
+		ut_assert_true(state.velocity(0) >= -0.001f);
+
+		// continuous velocity
+		ut_assert_true(fabsf(state.velocity(0) - vel_prev) <= 3.f * dt + 0.001f);
+		vel_prev = state.velocity(0);
+		vel_max = math::max(vel_max, state.velocity(0));
+	}
+
+	ut_compare_float("cruise speed", vel_max, 5.f, 3);
+
+	trajectory.sample(trajectory.duration(), state);
+	ut_compare_float("end", state.position(0), 100.f, 3);
+	ut_compare_float("at rest", state.velocity(0), 0.f, 3);
+	ut_compare_float("altitude", state.position(2), -10.f, 3);
+	ut_assert_false(PX4_ISFINITE(state.yaw));
+
+	// too short to reach the acceleration limit: 2 * j * t_jerk^3 = distance
+	const JerkLimitedTrajectory::Waypoint short_leg[] = {
+		{Vector3f(0.f, 0.f, 0.f), NAN},
+		{Vector3f(0.f, 0.5f, 0.f), NAN}
+	};
+	ut_assert_true(trajectory.plan(short_leg, 2));
+	ut_compare_float("short duration", trajectory.duration(), 4.f * cbrtf(0.5f * 0.5f / 5.f), 3);
+	trajectory.sample(0.5f * trajectory.duration(), state);
+	ut_compare_float("half way", state.position(1), 0.25f, 3);
+	return true;
+}
+
+bool TrajectoryTest::_synchronized()
+{
+	JerkLimitedTrajectory trajectory;
+	setLimits(trajectory);
+	const Vector3f start(0.f, 0.f, 0.f);
+	const Vector3f end(30.f, 40.f, -50.f);
+	const JerkLimitedTrajectory::Waypoint waypoints[] = {{start, NAN}, {end, NAN}};
+	ut_assert_true(trajectory.plan(waypoints, 2));
+
+	const Vector3f direction = (end - start).normalized();
+	JerkLimitedTrajectory::State state;
+
+	for (float t = 0.f; t < trajectory.duration(); t += 10.f * dt) {
+		trajectory.sample(t, state);
+
+		// all axes stay on the straight line
+		const Vector3f offset = state.position - start;
+		ut_compare_float("on the line", (offset - direction * (offset * direction)).norm(), 0.f, 3);
+
+		// each axis respects its own limits
+		ut_assert_true(Vector2f(state.velocity(0), state.velocity(1)).norm() <= 5.f + 0.001f);
+		ut_assert_true(-state.velocity(2) <= 3.f + 0.001f);
+		ut_assert_true(-state.acceleration(2) <= 2.f + 0.001f);
+		ut_assert_true(state.acceleration(2) <= 2.f + 0.001f);
+	}
+
+	// the climb rate limit of 3m/s constrains the 45 degree line, horizontally 3m/s < 5m/s
+	float vel_z_max = 0.f;
+
+	for (float t = 0.f; t < trajectory.duration(); t += dt) {
+		trajectory.sample(t, state);
+		vel_z_max = math::max(vel_z_max, -state.velocity(2));
+	}
+
+	ut_compare_float("climb rate", vel_z_max, 3.f, 3);
+
+	// all axes arrive at the same time
+	trajectory.sample(trajectory.duration() - 0.1f, state);
+	ut_assert_true(fabsf(state.velocity(0)) > FLT_EPSILON);
+	ut_assert_true(fabsf(state.velocity(1)) > FLT_EPSILON);
+	ut_assert_true(fabsf(state.velocity(2)) > FLT_EPSILON);
+	trajectory.sample(trajectory.duration(), state);
+	ut_compare_float("end", (state.position - end).norm(), 0.f, 3);
+	return true;
+}
+
+bool TrajectoryTest::_heading()
+{
+	JerkLimitedTrajectory trajectory;
+	setLimits(trajectory);
+
+	// a short leg with a large turn: the turn sets the duration
+	const JerkLimitedTrajectory::Waypoint waypoints[] = {
+		{Vector3f(0.f, 0.f, 0.f), 3.f},
+		{Vector3f(0.1f, 0.f, 0.f), -3.f}
+	};
+	ut_assert_true(trajectory.plan(waypoints, 2));
+
+	// the short way round over +-pi
+	JerkLimitedTrajectory::State state;
+	trajectory.sample(0.5f * trajectory.duration(), state);
+	ut_assert_true(state.yaw_rate > 0.f);
+	ut_assert_true(fabsf(state.yaw) > 3.f);
+
+	for (float t = 0.f; t < trajectory.duration(); t += dt) {
+		trajectory.sample(t, state);
+		ut_assert_true(state.yaw_rate <= 0.5f + 0.001f);
+	}
+
+	// position and heading arrive together
+	trajectory.sample(trajectory.duration() - 0.1f, state);
+	ut_assert_true(state.velocity(0) > FLT_EPSILON);
+	ut_assert_true(state.yaw_rate > FLT_EPSILON);
+	trajectory.sample(trajectory.duration(), state);
+	ut_compare_float("heading", state.yaw, -3.f, 3);
+	ut_compare_float("position", state.position(0), 0.1f, 3);
+
+	// no heading keeps the previous one
+	const JerkLimitedTrajectory::Waypoint hold[] = {
+		{Vector3f(0.f, 0.f, 0.f), 1.f},
+		{Vector3f(10.f, 0.f, 0.f), NAN}
+	};
+	ut_assert_true(trajectory.plan(hold, 2));
+	trajectory.sample(0.5f * trajectory.duration(), state);
+	ut_compare_float("hold heading", state.yaw, 1.f, 3);
+	ut_compare_float("no turn", state.yaw_rate, 0.f, 3);
+	return true;
+}
+
+bool TrajectoryTest::_sequence()
+{
+	JerkLimitedTrajectory trajectory;
+	setLimits(trajectory);
+	const JerkLimitedTrajectory::Waypoint waypoints[] = {
+		{Vector3f(0.f, 0.f, -15.f), 0.f},
+		{Vector3f(20.f, 0.f, -15.f), NAN},
+		{Vector3f(20.f, 20.f, -15.f), 1.5f},
+		{Vector3f(20.f, 20.f, -5.f), NAN}
+	};
+	ut_assert_true(trajectory.plan(waypoints, 4));
+
+	JerkLimitedTrajectory::State state;
+
+	// at rest on every waypoint
+	for (int i = 0; i < 4; i++) {
+		trajectory.sample(trajectory.arrivalTime(i), state);
+		ut_compare_float("waypoint", (state.position - waypoints[i].position).norm(), 0.f, 3);
+		ut_compare_float("at rest", state.velocity.norm(), 0.f, 3);
+	}
+
+	ut_compare_float("last arrival", trajectory.arrivalTime(3), trajectory.duration(), 3);
+	ut_compare_float("turned", state.yaw, 1.5f, 3);
+
+	// the descent is limited to 1m/s
+	trajectory.sample(0.5f * (trajectory.arrivalTime(2) + trajectory.arrivalTime(3)), state);
+	ut_compare_float("descent", state.velocity(2), 1.f, 3);
+
+	// lookahead past the end holds the last waypoint
+	trajectory.sample(trajectory.duration() + 10.f, state);
+	ut_compare_float("hold", state.position(2), -5.f, 3);
+	ut_compare_float("hold heading", state.yaw, 1.5f, 3);
+	return true;
+}
+
+bool TrajectoryTest::_invalid()
+{
+	JerkLimitedTrajectory trajectory;
+	const JerkLimitedTrajectory::Waypoint waypoints[] = {
+		{Vector3f(0.f, 0.f, 0.f), NAN},
+		{Vector3f(10.f, 0.f, 0.f), NAN}
+	};
+	ut_assert_false(trajectory.plan(waypoints, 0));
+	ut_assert_false(trajectory.valid());
+
+	trajectory.setHorizontalLimits({5.f, 0.f, 5.f});
+	ut_assert_false(trajectory.plan(waypoints, 2));
+
+	// a single waypoint holds position
+	setLimits(trajectory);
+	ut_assert_true(trajectory.plan(waypoints, 1));
+	ut_compare_float("no duration", trajectory.duration(), 0.f, 3);
+	return true;
+}
+
+bool TrajectoryTest::_benchmark()
+{
+	// the same 3D leg flown with three synchronized VelocitySmoothing instances as in the flight tasks
+	const Vector3f end(80.f, 60.f, -10.f);
+	const int cycles = 5000;
+	const int lookahead = 10;
+
+	perf_counter_t per_axis = perf_alloc(PC_ELAPSED, "trajectory: per axis smoothing");
+	perf_counter_t plan = perf_alloc(PC_ELAPSED, "trajectory: plan");
+	perf_counter_t sample = perf_alloc(PC_ELAPSED, "trajectory: sample");
+	perf_counter_t sample_lookahead = perf_alloc(PC_ELAPSED, "trajectory: sample with lookahead");
+
+	VelocitySmoothing smoothing[3];
+	float accel, vel, pos;
+
+	for (int i = 0; i < 3; i++) {
+		smoothing[i].setMaxJerk(5.f);
+		smoothing[i].setMaxAccel(3.f);
+		smoothing[i].setMaxVel(5.f);
+	}
+
+	for (int k = 0; k < cycles; k++) {
+		perf_begin(per_axis);
+
+		for (int i = 0; i < 3; i++) {
+			smoothing[i].integrate(accel, vel, pos);
+			smoothing[i].updateDurations(dt, math::constrain(end(i) - pos, -5.f, 5.f));
+		}
+
+		VelocitySmoothing::timeSynchronization(smoothing, 3);
+		perf_end(per_axis);
+	}
+
+	JerkLimitedTrajectory trajectory;
+	setLimits(trajectory);
+	const JerkLimitedTrajectory::Waypoint waypoints[] = {{Vector3f(0.f, 0.f, 0.f), 0.f}, {end, 1.f}};
+	JerkLimitedTrajectory::State state;
+
+	for (int k = 0; k < cycles; k++) {
+		perf_begin(plan);
+		trajectory.plan(waypoints, 2);
+		perf_end(plan);
+
+		const float t = k * dt;
+		perf_begin(sample);
+		trajectory.sample(t, state);
+		perf_end(sample);
+
+		perf_begin(sample_lookahead);
+
+		for (int i = 0; i < lookahead; i++) {
+			trajectory.sample(t + i * 0.1f, state);
+		}
+
+		perf_end(sample_lookahead);
+	}
+
+	perf_print_counter(per_axis);
+	perf_print_counter(plan);
+	perf_print_counter(sample);
+	perf_print_counter(sample_lookahead);
+
+	perf_free(per_axis);
+	perf_free(plan);
+	perf_free(sample);
+	perf_free(sample_lookahead);
+
+	ut_assert_true(trajectory.valid());
+	return true;
+}
+
+ut_declare_test_c(test_trajectory, TrajectoryTest)
@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_ulog_compact.cpp
+ *
+ * Compact (delta) encoding of ULog data: round trips and size reduction.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include <ulog_compact/ulog_compact.h>
+
+#include "tests_main.h"
+
+#include <unit_test.h>
+
+using namespace ulog_compact;
+
+class ULogCompactTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+#pragma pack(push, 1)
+	// same layout as a generated topic without end padding: sorted by size, padding in uint8 arrays
+	struct Sample {
+		uint64_t timestamp;
+		int64_t position;
+		float value[3];
+		uint32_t count;
+		int32_t offset;
+		uint16_t sequence;
+		int16_t temperature;
+		uint8_t state;
+		bool flag;
+		uint8_t _padding0[2];
+	};
+#pragma pack(pop)
+
+	bool _layout();
+	bool _unchanged();
+	bool _roundtrip();
+	bool _integer_wrap();
+	bool _max_length();
+	bool _corrupt();
+
+	bool _encode_decode(const Sample &previous, const Sample &sample, size_t &length);
+
+	static const uint8_t LAYOUT[];
+
+	uint8_t _buffer[64];
+};
+
+const uint8_t ULogCompactTest::LAYOUT[] = {
+	LAYOUT_VARINT | 8, LAYOUT_VARINT | 8, 12, LAYOUT_VARINT | 4, LAYOUT_VARINT | 4,
+	LAYOUT_VARINT | 2, LAYOUT_VARINT | 2, 1, 1, 2, 0
+};
+
+bool ULogCompactTest::run_tests()
+{
+	ut_run_test(_layout);
+	ut_run_test(_unchanged);
+	ut_run_test(_roundtrip);
+	ut_run_test(_integer_wrap);
+	ut_run_test(_max_length);
+	ut_run_test(_corrupt);
+
+	return (_tests_failed == 0);
+}
+
+bool ULogCompactTest::_encode_decode(const Sample &previous, const Sample &sample, size_t &length)
+{
+	length = encode(LAYOUT, (const uint8_t *)&previous, (const uint8_t *)&sample, _buffer, sizeof(_buffer));
+	ut_assert_true(length > 0);
+
+	Sample decoded = previous;
+	ut_assert_true(decode(LAYOUT, _buffer, length, (uint8_t *)&decoded, sizeof(decoded)));
+	ut_assert_true(memcmp(&decoded, &sample, sizeof(sample)) == 0);
+	return true;
+}
+
+bool ULogCompactTest::_layout()
+{
+	ut_compare("layout size", layout_size(LAYOUT), sizeof(Sample));
+	return true;
+}
+
+bool ULogCompactTest::_unchanged()
+{
+	Sample sample{};
+	sample.timestamp = 123456789;
+	sample.value[1] = 1.5f;
+
+	// only the change mask (10 fields)
+	size_t length;
+	ut_assert_true(_encode_decode(sample, sample, length));
+	ut_compare("length", length, 2);
+
+	// a timestamp increment of 1 ms needs 2 bytes instead of 8
+	Sample next = sample;
+	next.timestamp += 1000;
+	ut_assert_true(_encode_decode(sample, next, length));
+	ut_compare("length", length, 4);
+	return true;
+}
+
+bool ULogCompactTest::_roundtrip()
+{
+	Sample previous{};
+	Sample sample{};
+
+	for (int i = 0; i < 100; ++i) {
+		sample.timestamp += 4000 + i;
+		sample.position -= 1000 * i;
+		sample.value[i % 3] = i * 0.1f;
+		sample.count = (i % 7 == 0) ? sample.count + 1 : sample.count;
+		sample.offset = (i % 2) ? -i * 1000000 : i;
+		sample.sequence = i * 1000;
+		sample.temperature = -20 + (i % 60);
+		sample.state = i % 5;
+		sample.flag = i % 10 == 0;
+
+		size_t length;
+		ut_assert_true(_encode_decode(previous, sample, length));
+		ut_assert_true(length < sizeof(Sample));
+		previous = sample;
+	}
+
+	return true;
+}
+
+bool ULogCompactTest::_integer_wrap()
+{
+	Sample previous{};
+	Sample sample{};
+	size_t length;
+
+	// wrap-around and full range jumps are encoded as small/negative deltas of the field type
+	previous.sequence = 65535;
+	sample.sequence = 1;
+	previous.offset = 2147483647;
+	sample.offset = -2147483647 - 1;
+	previous.position = -9223372036854775807LL - 1;
+	sample.position = 9223372036854775807LL;
+	previous.timestamp = 0xffffffffffffffffULL;
+	sample.timestamp = 0;
+	ut_assert_true(_encode_decode(previous, sample, length));
+	// mask + 1 byte per field: all the deltas are 1 or 2
+	ut_compare("length", length, 2 + 4);
+
+	// largest possible deltas
+	previous = Sample{};
+	sample.timestamp = 0x8000000000000000ULL;
+	sample.position = -9223372036854775807LL - 1;
+	sample.count = 0x80000000;
+	ut_assert_true(_encode_decode(previous, sample, length));
+	return true;
+}
+
+bool ULogCompactTest::_max_length()
+{
+	Sample previous{};
+	Sample sample;
+	memset(&sample, 0xa5, sizeof(sample));
+
+	// everything changed: does not fit into less than the sample size
+	ut_compare("too long", encode(LAYOUT, (const uint8_t *)&previous, (const uint8_t *)&sample, _buffer,
+				      sizeof(Sample) - 1), 0);
+	ut_compare("mask only", encode(LAYOUT, (const uint8_t *)&previous, (const uint8_t *)&previous, _buffer, 1), 0);
+	return true;
+}
+
+bool ULogCompactTest::_corrupt()
+{
+	Sample previous{};
+	Sample sample{};
+	sample.timestamp = 1000000;
+	sample.value[0] = 3.f;
+
+	const size_t length = encode(LAYOUT, (const uint8_t *)&previous, (const uint8_t *)&sample, _buffer,
+				     sizeof(_buffer));
+	ut_assert_true(length > 0);
+
+	Sample decoded = previous;
+	ut_assert_false(decode(LAYOUT, _buffer, length - 1, (uint8_t *)&decoded, sizeof(decoded)));
+	ut_assert_false(decode(LAYOUT, _buffer, length + 1, (uint8_t *)&decoded, sizeof(decoded)));
+	ut_assert_false(decode(LAYOUT, _buffer, length, (uint8_t *)&decoded, sizeof(decoded) - 1));
+
+	// varint without end
+	memset(_buffer, 0xff, sizeof(_buffer));
+	ut_assert_false(decode(LAYOUT, _buffer, sizeof(_buffer), (uint8_t *)&decoded, sizeof(decoded)));
+	return true;
+}
+
+ut_declare_test_c(test_ulog_compact, ULogCompactTest)
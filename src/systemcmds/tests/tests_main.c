@@ -97,6 +97,7 @@ const struct {
 	{"mavlink",		mavlink_tests_main,	0},
 #endif
 	{"sf0x",		sf0x_tests_main,	0},
+	{"temperature_compensation",	temperature_compensation_tests_main,	0},
 	{"uorb",		uorb_tests_main,	0},
 	{"hysteresis",		test_hysteresis,	0},
 
@@ -119,18 +120,27 @@ const struct {
 	{"microbench_matrix",		test_microbench_matrix,	0},
 	{"microbench_uorb",		test_microbench_uorb,	0},
 	{"mount",		test_mount,	OPT_NOJIGTEST | OPT_NOALLTEST},
+	{"obstacle_map",		test_obstacle_map,	0},
 	{"param",		test_param,	0},
 	{"parameters",	test_parameters,	0},
+	{"path",		test_path,	0},
 	{"perf",		test_perf,	OPT_NOJIGTEST},
 	{"ppm",			test_ppm,	OPT_NOJIGTEST | OPT_NOALLTEST},
 	{"ppm_loopback",	test_ppm_loopback,	OPT_NOALLTEST},
+	{"px4io_protocol",	test_px4io_protocol,	0},
 	{"rc",			test_rc,	OPT_NOJIGTEST | OPT_NOALLTEST},
 	{"search_min",	test_search_min, 0},
 	{"servo",		test_servo,	OPT_NOJIGTEST | OPT_NOALLTEST},
 	{"sleep",		test_sleep,	OPT_NOJIGTEST},
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+	{"startup_script",	test_startup_script,	OPT_NOJIGTEST},
+#endif
+	{"survey_pattern",	test_survey_pattern,	0},
 	{"tone",		test_tone,	0},
+	{"trajectory",		test_trajectory,	0},
 	{"uart_loopback",	test_uart_loopback,	OPT_NOJIGTEST | OPT_NOALLTEST},
 	{"uart_send",		test_uart_send,	OPT_NOJIGTEST | OPT_NOALLTEST},
+	{"ulog_compact",	test_ulog_compact,	0},
 	{"versioning",		test_versioning,	0},
 	{"ctlmath",		test_controlmath, 0},
 	{"smoothz", 	test_smooth_z, 0},
@@ -75,23 +75,30 @@ extern int	test_microbench_matrix(int argc, char *argv[]);
 extern int	test_microbench_uorb(int argc, char *argv[]);
 extern int	test_mixer(int argc, char *argv[]);
 extern int	test_mount(int argc, char *argv[]);
+extern int	test_obstacle_map(int argc, char *argv[]);
 extern int	test_param(int argc, char *argv[]);
 extern int	test_perf(int argc, char *argv[]);
 extern int	test_ppm(int argc, char *argv[]);
 extern int	test_ppm_loopback(int argc, char *argv[]);
+extern int	test_px4io_protocol(int argc, char *argv[]);
 extern int	test_rc(int argc, char *argv[]);
 extern int	test_search_min(int argc, char *argv[]);
 extern int	test_sensors(int argc, char *argv[]);
 extern int	test_servo(int argc, char *argv[]);
 extern int	test_sleep(int argc, char *argv[]);
+extern int	test_startup_script(int argc, char *argv[]);
+extern int	test_survey_pattern(int argc, char *argv[]);
 extern int	test_time(int argc, char *argv[]);
 extern int	test_tone(int argc, char *argv[]);
+extern int	test_trajectory(int argc, char *argv[]);
 extern int	test_uart_baudchange(int argc, char *argv[]);
 extern int	test_uart_break(int argc, char *argv[]);
 extern int	test_uart_console(int argc, char *argv[]);
 extern int	test_uart_loopback(int argc, char *argv[]);
 extern int	test_uart_send(int argc, char *argv[]);
+extern int	test_ulog_compact(int argc, char *argv[]);
 extern int	test_parameters(int argc, char *argv[]);
+extern int	test_path(int argc, char *argv[]);
 extern int	test_versioning(int argc, char *argv[]);
 extern int  test_smooth_z(int argc, char *argv[]);
 extern int 	test_controlmath(int argc, char *argv[]);
@@ -103,6 +110,7 @@ extern int controllib_test_main(int argc, char *argv[]);
 extern int uorb_tests_main(int argc, char *argv[]);
 extern int rc_tests_main(int argc, char *argv[]);
 extern int sf0x_tests_main(int argc, char *argv[]);
+extern int temperature_compensation_tests_main(int argc, char *argv[]);
 
 __END_DECLS
 